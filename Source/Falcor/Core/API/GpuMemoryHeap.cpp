@@ -35,13 +35,27 @@
 
 namespace Falcor
 {
+namespace
+{
+/// Mega-page sizes are rounded up to the placement alignment of buffer resources.
+const size_t kMegaPageGranularity = 64 * 1024;
+/// Default cap on the size of released mega-pages kept for reuse.
+const size_t kDefaultMaxRetainedMegaPageBytes = 256ull * 1024 * 1024;
+/// Pooled mega-pages that are not reused within this many frames are released.
+const uint64_t kMaxMegaPageIdleFrames = 120;
+} // namespace
+
 GpuMemoryHeap::~GpuMemoryHeap()
 {
     mDeferredReleases = decltype(mDeferredReleases)();
 }
 
 GpuMemoryHeap::GpuMemoryHeap(ref<Device> pDevice, Type type, size_t pageSize, ref<GpuFence> pFence)
-    : mpDevice(pDevice), mType(type), mpFence(pFence), mPageSize(pageSize)
+    : mpDevice(pDevice)
+    , mType(type)
+    , mpFence(pFence)
+    , mPageSize(pageSize)
+    , mMegaPagePool(kMegaPageGranularity, kDefaultMaxRetainedMegaPageBytes, [this](BaseData& page) { mpDevice->releaseResource(page.gfxBufferResource); })
 {
     allocateNewPage();
 }
@@ -80,8 +94,10 @@ GpuMemoryHeap::Allocation GpuMemoryHeap::allocate(size_t size, size_t alignment)
     Allocation data;
     if (size > mPageSize)
     {
+        // Released mega-pages are reused for allocations of similar size. The pooled page keeps its own size.
         data.pageID = GpuMemoryHeap::Allocation::kMegaPageId;
-        initBasePageData(data, size);
+        if (!mMegaPagePool.acquire(size, mpFence->getGpuValue(), data))
+            initBasePageData(data, mMegaPagePool.getPageSize(size));
     }
     else
     {
@@ -97,6 +113,7 @@ GpuMemoryHeap::Allocation GpuMemoryHeap::allocate(size_t size, size_t alignment)
         data.offset = currentOffset;
         data.pData = mpActivePage->pData + currentOffset;
         data.gfxBufferResource = mpActivePage->gfxBufferResource;
+        data.size = mpActivePage->size;
         mpActivePage->currentOffset = currentOffset + size;
         mpActivePage->allocationsCount++;
     }
@@ -108,7 +125,15 @@ GpuMemoryHeap::Allocation GpuMemoryHeap::allocate(size_t size, size_t alignment)
 void GpuMemoryHeap::release(Allocation& data)
 {
     FALCOR_ASSERT(data.gfxBufferResource);
-    mDeferredReleases.push(data);
+    if (data.pageID == Allocation::kMegaPageId)
+    {
+        // The allocation may have been used by the GPU until now, so wait for the current fence value before reusing it.
+        mMegaPagePool.release(data, data.size, mpFence->getCpuValue());
+    }
+    else
+    {
+        mDeferredReleases.push(data);
+    }
 }
 
 void GpuMemoryHeap::executeDeferredReleases()
@@ -127,20 +152,18 @@ void GpuMemoryHeap::executeDeferredReleases()
         }
         else
         {
-            if (data.pageID != Allocation::kMegaPageId)
+            auto& pData = mUsedPages[data.pageID];
+            pData->allocationsCount--;
+            if (pData->allocationsCount == 0)
             {
-                auto& pData = mUsedPages[data.pageID];
-                pData->allocationsCount--;
-                if (pData->allocationsCount == 0)
-                {
-                    mAvailablePages.push(std::move(pData));
-                    mUsedPages.erase(data.pageID);
-                }
+                mAvailablePages.push(std::move(pData));
+                mUsedPages.erase(data.pageID);
             }
-            // else it's a mega-page. Popping it will release the resource
         }
         mDeferredReleases.pop();
     }
+
+    mMegaPagePool.trimIdle(mpFence->getCpuValue(), kMaxMegaPageIdleFrames);
 }
 
 Slang::ComPtr<gfx::IBufferResource> createBuffer(
@@ -193,6 +216,7 @@ void GpuMemoryHeap::initBasePageData(BaseData& data, size_t size)
         getCpuAccess(mType)
     );
     data.offset = 0;
+    data.size = size;
     FALCOR_GFX_CALL(data.gfxBufferResource->map(nullptr, (void**)&data.pData));
 }
 
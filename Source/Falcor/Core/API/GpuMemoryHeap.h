@@ -29,6 +29,7 @@
 #include "fwd.h"
 #include "Handles.h"
 #include "GpuFence.h"
+#include "MegaPagePool.h"
 #include "Core/Macros.h"
 #include "Core/Object.h"
 #include <queue>
@@ -52,6 +53,7 @@ public:
         Slang::ComPtr<gfx::IBufferResource> gfxBufferResource;
         GpuAddress offset = 0;
         uint8_t* pData = nullptr;
+        size_t size = 0; ///< Size of the buffer resource in bytes.
     };
 
     struct Allocation : public BaseData
@@ -79,6 +81,24 @@ public:
     size_t getPageSize() const { return mPageSize; }
     void executeDeferredReleases();
 
+    /**
+     * Set the maximum total size of the released mega-pages (allocations larger than the page size) kept for reuse.
+     * @param[in] byteSize Size in bytes. Zero disables pooling of mega-pages.
+     */
+    void setMaxRetainedMegaPageBytes(size_t byteSize) { mMegaPagePool.setMaxRetainedBytes(byteSize); }
+
+    /**
+     * Release pooled mega-pages until at most the given number of bytes is retained.
+     * Call this when memory is running low.
+     * @param[in] byteSize Size in bytes to trim to.
+     */
+    void trimMegaPages(size_t byteSize = 0) { mMegaPagePool.trim(byteSize); }
+
+    /**
+     * Get statistics on the mega-page pool (hit rate, retained bytes).
+     */
+    const MegaPagePool<BaseData>::Stats& getMegaPageStats() const { return mMegaPagePool.getStats(); }
+
     void breakStrongReferenceToDevice();
 
 private:
@@ -102,6 +122,7 @@ private:
     std::priority_queue<Allocation> mDeferredReleases;
     std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;
     std::queue<PageData::UniquePtr> mAvailablePages;
+    MegaPagePool<BaseData> mMegaPagePool;
 
     void allocateNewPage();
     void initBasePageData(BaseData& data, size_t size);
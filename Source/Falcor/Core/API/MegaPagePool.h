@@ -0,0 +1,251 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Assert.h"
+#include "Utils/Math/Common.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+
+namespace Falcor
+{
+/**
+ * Pool of large memory pages, binned by size.
+ *
+ * GpuMemoryHeap uses this to recycle the dedicated buffers it creates for allocations larger than its page size.
+ * Page sizes are rounded up to a fixed granularity. A request is served by the smallest pooled page that is at most
+ * 25% larger than the request, so neither rounding nor reuse wastes much memory on large pages.
+ * A released page is handed out again only after the GPU has passed the fence value it was released at.
+ * Retained pages are evicted oldest first when the retained size exceeds the cap, when they have been idle
+ * for too long, or when the owner trims the pool (e.g. under memory pressure).
+ *
+ * The pool only does the bookkeeping. The page type is opaque and evicted pages are handed to a callback,
+ * which is responsible for releasing the memory once it is no longer in use. Pages still pooled when the
+ * pool is destroyed are destroyed without the callback, so the owner must make sure the GPU is idle.
+ *
+ * @tparam TPage Page type, e.g. a buffer resource and its mapped pointer.
+ */
+template<typename TPage>
+class MegaPagePool
+{
+public:
+    using EvictCallback = std::function<void(TPage&)>;
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;       ///< Number of acquire() calls that returned a pooled page.
+        uint64_t missCount = 0;      ///< Number of acquire() calls that found no reusable page.
+        uint64_t evictionCount = 0;  ///< Number of pages evicted from the pool.
+        size_t retainedBytes = 0;    ///< Total size of the pages currently in the pool.
+        size_t retainedPageCount = 0; ///< Number of pages currently in the pool.
+
+        double getHitRate() const { return hitCount + missCount > 0 ? double(hitCount) / double(hitCount + missCount) : 0.0; }
+    };
+
+    /**
+     * Constructor.
+     * @param[in] granularity Page size granularity in bytes.
+     * @param[in] maxRetainedBytes Maximum total size of the pages kept in the pool.
+     * @param[in] evictCallback Called for each page that is evicted from the pool.
+     */
+    MegaPagePool(size_t granularity, size_t maxRetainedBytes, EvictCallback evictCallback = {})
+        : mGranularity(granularity), mMaxRetainedBytes(maxRetainedBytes), mEvictCallback(std::move(evictCallback))
+    {
+        FALCOR_ASSERT(mGranularity > 0);
+    }
+
+    MegaPagePool(const MegaPagePool&) = delete;
+    MegaPagePool& operator=(const MegaPagePool&) = delete;
+
+    /**
+     * Get the page size for an allocation, i.e. the size rounded up to the granularity.
+     * New pages should be created with this size.
+     */
+    size_t getPageSize(size_t size) const { return align_to(mGranularity, size); }
+
+    /**
+     * Acquire a pooled page for an allocation.
+     * The smallest completed page of at least the allocation's page size and at most 25% larger is returned.
+     * The caller has to keep track of the size of the returned page.
+     * @param[in] size Allocation size in bytes.
+     * @param[in] completedFenceValue Last fence value the GPU has completed.
+     * @param[out] page The pooled page if one was available.
+     * @return True if a page was returned, false if the caller needs to create a new page.
+     */
+    bool acquire(size_t size, uint64_t completedFenceValue, TPage& page)
+    {
+        const size_t pageSize = getPageSize(size);
+        const size_t maxPageSize = pageSize + pageSize / 4;
+        for (auto bin = mEntries.lower_bound(pageSize); bin != mEntries.end() && bin->first <= maxPageSize; ++bin)
+        {
+            auto& entries = bin->second;
+            // Entries are ordered by release, so the oldest ones are most likely to be completed.
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+            {
+                if (it->fenceValue <= completedFenceValue)
+                {
+                    page = std::move(it->page);
+                    mStats.retainedBytes -= it->size;
+                    mStats.retainedPageCount--;
+                    entries.erase(it);
+                    if (entries.empty())
+                        mEntries.erase(bin);
+                    mStats.hitCount++;
+                    return true;
+                }
+            }
+        }
+        mStats.missCount++;
+        return false;
+    }
+
+    /**
+     * Return a page to the pool. If the pool exceeds its cap, the oldest pages are evicted.
+     * @param[in] page The page.
+     * @param[in] size Size of the page in bytes. Must be a multiple of the granularity (see getPageSize()).
+     * @param[in] fenceValue Fence value the GPU has to complete before the page can be reused.
+     */
+    void release(TPage page, size_t size, uint64_t fenceValue)
+    {
+        FALCOR_ASSERT(size == getPageSize(size));
+        if (size > mMaxRetainedBytes)
+        {
+            evict(page);
+            return;
+        }
+        mEntries[size].push_back(Entry{std::move(page), size, fenceValue, mNextSequence++});
+        mStats.retainedBytes += size;
+        mStats.retainedPageCount++;
+        trim(mMaxRetainedBytes);
+    }
+
+    /**
+     * Evict the oldest pages until the retained size is at most the given number of bytes.
+     * @param[in] maxRetainedBytes Retained size in bytes to trim to.
+     */
+    void trim(size_t maxRetainedBytes)
+    {
+        while (mStats.retainedBytes > maxRetainedBytes)
+        {
+            // Find the bin holding the oldest page.
+            auto oldest = mEntries.end();
+            for (auto bin = mEntries.begin(); bin != mEntries.end(); ++bin)
+            {
+                if (oldest == mEntries.end() || bin->second.front().sequence < oldest->second.front().sequence)
+                    oldest = bin;
+            }
+            FALCOR_ASSERT(oldest != mEntries.end());
+            evictFront(oldest);
+        }
+    }
+
+    /**
+     * Evict pages that have been in the pool for more than the given number of fence values.
+     * @param[in] currentFenceValue Current fence value.
+     * @param[in] maxIdleFenceCount Number of fence values a page is kept without being reused.
+     */
+    void trimIdle(uint64_t currentFenceValue, uint64_t maxIdleFenceCount)
+    {
+        for (auto bin = mEntries.begin(); bin != mEntries.end();)
+        {
+            auto next = std::next(bin);
+            while (bin != mEntries.end() && bin->second.front().fenceValue + maxIdleFenceCount < currentFenceValue)
+                bin = evictFront(bin);
+            bin = next;
+        }
+    }
+
+    /**
+     * Set the maximum total size of the pages kept in the pool. Evicts pages if needed.
+     */
+    void setMaxRetainedBytes(size_t maxRetainedBytes)
+    {
+        mMaxRetainedBytes = maxRetainedBytes;
+        trim(mMaxRetainedBytes);
+    }
+
+    size_t getMaxRetainedBytes() const { return mMaxRetainedBytes; }
+
+    /**
+     * Evict all pages.
+     */
+    void clear() { trim(0); }
+
+    const Stats& getStats() const { return mStats; }
+
+    /**
+     * Reset the hit, miss and eviction counters.
+     */
+    void resetStats()
+    {
+        mStats.hitCount = 0;
+        mStats.missCount = 0;
+        mStats.evictionCount = 0;
+    }
+
+private:
+    struct Entry
+    {
+        TPage page;
+        size_t size;
+        uint64_t fenceValue;
+        uint64_t sequence; ///< Release order, used to evict the oldest page first.
+    };
+
+    using Bins = std::map<size_t, std::deque<Entry>>; ///< Pooled pages by size. Empty bins are removed.
+
+    /// Evict the oldest page of a bin. Returns the bin, or the end iterator if the bin was removed.
+    typename Bins::iterator evictFront(typename Bins::iterator bin)
+    {
+        Entry& entry = bin->second.front();
+        mStats.retainedBytes -= entry.size;
+        mStats.retainedPageCount--;
+        evict(entry.page);
+        bin->second.pop_front();
+        if (!bin->second.empty())
+            return bin;
+        mEntries.erase(bin);
+        return mEntries.end();
+    }
+
+    void evict(TPage& page)
+    {
+        mStats.evictionCount++;
+        if (mEvictCallback)
+            mEvictCallback(page);
+    }
+
+    Bins mEntries;
+    uint64_t mNextSequence = 0;
+    size_t mGranularity;
+    size_t mMaxRetainedBytes;
+    EvictCallback mEvictCallback;
+    Stats mStats;
+};
+} // namespace Falcor
@@ -41,7 +41,7 @@
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Core/Pass/FullScreenPass.h"
 #include "NativeFormats.h"
-#include "Utils/Image/npy.h"
+#include "Utils/NumpyArray.h"
 
 // supress some warnings for gli
 #pragma warning( push )
@@ -513,6 +513,43 @@ ref<ShaderResourceView> Texture::getSRV(uint32_t mostDetailedMip, uint32_t mipCo
     return findViewCommon<ShaderResourceView>(this, mostDetailedMip, mipCount, firstArraySlice, arraySize, mSrvs, createFunc);
 }
 
+ref<Texture> Texture::prepareCaptureSource(
+    RenderContext* pContext,
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    Bitmap::FileFormat format,
+    uint32_t& subresource
+)
+{
+    if (mType != Type::Texture2D)
+        throw RuntimeError("Texture::prepareCaptureSource only supported for 2D textures.");
+
+    FormatType type = getFormatType(mFormat);
+    uint32_t channels = getFormatChannelCount(mFormat);
+
+    // LDR file formats are written from an 8 bit staging texture. HDR textures with less than 3 channels are expanded to RGBA.
+    ResourceFormat stagingFormat = ResourceFormat::Unknown;
+    if (format == Bitmap::FileFormat::BmpFile || format == Bitmap::FileFormat::JpegFile || format == Bitmap::FileFormat::PngFile ||
+        format == Bitmap::FileFormat::TgaFile)
+        stagingFormat = ResourceFormat::BGRA8UnormSrgb;
+    else if (type == FormatType::Float && channels < 3)
+        stagingFormat = ResourceFormat::RGBA32Float;
+
+    if (stagingFormat == ResourceFormat::Unknown)
+    {
+        subresource = getSubresourceIndex(arraySlice, mipLevel);
+        return ref<Texture>(this);
+    }
+
+    ref<Texture> pOther = Texture::create2D(
+        mpDevice, getWidth(mipLevel), getHeight(mipLevel), stagingFormat, 1, 1, nullptr,
+        ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
+    );
+    pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
+    subresource = 0;
+    return pOther;
+}
+
 void Texture::captureToFile(
     uint32_t mipLevel,
     uint32_t arraySlice,
@@ -558,124 +595,33 @@ void Texture::captureToFile(
         throw RuntimeError("Texture::captureToFile only supported for 2D textures.");
 
     // Handle the special case where we have an HDR texture with less then 3 channels.
-    FormatType type = getFormatType(mFormat);
     uint32_t channels = getFormatChannelCount(mFormat);
-    uint32_t bytesPerBlock = getFormatBytesPerBlock(mFormat);
     std::vector<uint8_t> textureData;
     ResourceFormat resourceFormat = mFormat;
 
     if (format == Bitmap::FileFormat::NumpyFile)
     {
-        //bool allSlices = arraySlice == Resource::kMaxPossible;
-        bool allSlices = true;
-        unsigned long shape[] = { allSlices ? mArraySize : 1, mHeight, mWidth, channels };
-        
-        std::vector<unsigned char> data;
-
-        if(allSlices)
-        {
-            for (uint32_t layer = 0; layer < mArraySize; ++layer)
-            {
-                auto subresourceIndex = getSubresourceIndex(layer, mipLevel);
-                auto srcData = pContext->readTextureSubresource(this, subresourceIndex);
-                // append to data
-                data.insert(data.end(), srcData.begin(), srcData.end());
-            }
-        }
-        else
-        {
-            auto subresourceIndex = getSubresourceIndex(arraySlice, mipLevel);
-            data = pContext->readTextureSubresource(this, subresourceIndex);
-        }
-        
+        // Write all array slices into a [slices, height, width, channels] array.
+        NumpyDType dtype;
+        if (!findNumpyDType(mFormat, dtype)) throw RuntimeError("Texture::captureToFile npy format does not support {}.", to_string(mFormat));
 
-        size_t expectedDataSize = size_t(shape[0]) * size_t(shape[1]) * size_t(shape[2]) * size_t(shape[3]);
-
-        uint32_t bytesPerChannel = bytesPerBlock / channels;
-        if(type == FormatType::Float)
+        NumpyArray array(dtype, {mArraySize, getHeight(mipLevel), getWidth(mipLevel), channels});
+        const size_t sliceSize = array.getByteSize() / mArraySize;
+        uint8_t* pDst = static_cast<uint8_t*>(array.getMutableData());
+        for (uint32_t layer = 0; layer < mArraySize; ++layer)
         {
-            // float formats
-            if (bytesPerChannel != 4) throw std::runtime_error("npy format only supports 32-bit floats");
-            assert(data.size() == expectedDataSize * sizeof(float));
-            if (data.size() != expectedDataSize * sizeof(float)) throw std::runtime_error("npy data size mismatch");
-            npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<float*>(data.data()));
-        }
-        else if(type == FormatType::Sint || type == FormatType::Snorm)
-        {
-            // signed integer
-            if (bytesPerChannel == 1)
-            {
-                assert(data.size() == expectedDataSize * sizeof(char));
-                if (data.size() != expectedDataSize * sizeof(char)) throw std::runtime_error("npy data size mismatch");
-                npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<char*>(data.data()));
-            }
-            else if (bytesPerChannel == 2)
-            {
-                assert(data.size() == expectedDataSize * sizeof(short));
-                if (data.size() != expectedDataSize * sizeof(short)) throw std::runtime_error("npy data size mismatch");
-                npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<short*>(data.data()));
-            }
-            else if (bytesPerChannel == 4)
-            {
-                assert(data.size() == expectedDataSize * sizeof(int));
-                if (data.size() != expectedDataSize * sizeof(int)) throw std::runtime_error("npy data size mismatch");
-                npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<int*>(data.data()));
-            }
-            else throw std::runtime_error("npy format only supports 8, 16, and 32-bit integers");
-        }
-        else
-        {
-            // unsigned integer
-            if (bytesPerChannel == 1)
-            {
-                assert(data.size() == expectedDataSize * sizeof(unsigned char));
-                if (data.size() != expectedDataSize * sizeof(unsigned char)) throw std::runtime_error("npy data size mismatch");
-                npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<unsigned char*>(data.data()));
-            }
-            else if(bytesPerChannel == 2)
-            {
-                assert(data.size() == expectedDataSize * sizeof(unsigned short));
-                if (data.size() != expectedDataSize * sizeof(unsigned short)) throw std::runtime_error("npy data size mismatch");
-                npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<unsigned short*>(data.data()));
-            }
-            else if(bytesPerChannel == 4)
-            {
-                assert(data.size() == expectedDataSize * sizeof(unsigned int));
-                if (data.size() != expectedDataSize * sizeof(unsigned int)) throw std::runtime_error("npy data size mismatch");
-                npy::SaveArrayAsNumpy(path.string(), false, 4, shape, reinterpret_cast<unsigned int*>(data.data()));
-            }
-            else throw std::runtime_error("npy format only supports 8, 16, and 32-bit integers");
+            auto srcData = pContext->readTextureSubresource(this, getSubresourceIndex(layer, mipLevel));
+            if (srcData.size() != sliceSize) throw RuntimeError("Texture::captureToFile npy data size mismatch.");
+            std::memcpy(pDst + layer * sliceSize, srcData.data(), sliceSize);
         }
+        array.save(path);
         return;
     }
 
-    if(format == Bitmap::FileFormat::BmpFile || format == Bitmap::FileFormat::JpegFile || format == Bitmap::FileFormat::PngFile || format == Bitmap::FileFormat::TgaFile)
-    {
-        // use 8 bit staging format
-        resourceFormat = ResourceFormat::BGRA8UnormSrgb;
-        ref<Texture> pOther = Texture::create2D(
-            mpDevice, getWidth(mipLevel), getHeight(mipLevel), resourceFormat, 1, 1, nullptr,
-            ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
-        );
-        pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
-        textureData = pContext->readTextureSubresource(pOther.get(), 0);
-
-    }
-    else if (type == FormatType::Float && channels < 3)
-    {
-        ref<Texture> pOther = Texture::create2D(
-            mpDevice, getWidth(mipLevel), getHeight(mipLevel), ResourceFormat::RGBA32Float, 1, 1, nullptr,
-            ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
-        );
-        pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
-        textureData = pContext->readTextureSubresource(pOther.get(), 0);
-        resourceFormat = ResourceFormat::RGBA32Float;
-    }
-    else
-    {
-        uint32_t subresource = getSubresourceIndex(arraySlice, mipLevel);
-        textureData = pContext->readTextureSubresource(this, subresource);
-    }
+    uint32_t subresource = 0;
+    ref<Texture> pSource = prepareCaptureSource(pContext, mipLevel, arraySlice, format, subresource);
+    textureData = pContext->readTextureSubresource(pSource.get(), subresource);
+    resourceFormat = pSource->getFormat();
 
     uint32_t width = getWidth(mipLevel);
     uint32_t height = getHeight(mipLevel);
@@ -356,6 +356,26 @@ public:
         bool async = true
     );
 
+    /**
+     * Get a texture holding the data to read back when capturing a 2D subresource to an image file.
+     * For file formats that need a conversion (8-bit LDR formats, or float textures with less than 3 channels), the subresource is
+     * blitted into a temporary texture. Otherwise this texture itself is returned.
+     * The format of the returned texture is the resource format to pass to Bitmap::saveImage().
+     * @param[in] pContext Render context used for the conversion blit.
+     * @param[in] mipLevel Requested mip-level
+     * @param[in] arraySlice Requested array-slice
+     * @param[in] format Destination image file format.
+     * @param[out] subresource Subresource index to read back from the returned texture.
+     * @return The texture to read back from.
+     */
+    ref<Texture> prepareCaptureSource(
+        RenderContext* pContext,
+        uint32_t mipLevel,
+        uint32_t arraySlice,
+        Bitmap::FileFormat format,
+        uint32_t& subresource
+    );
+
     /**
      * Generates mipmaps for a specified texture object.
      * @param[in] pContext Used render context.
@@ -0,0 +1,113 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CpuFeatures.h"
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CPU_FEATURES_X86 1
+#if FALCOR_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) && FALCOR_LINUX
+#define CPU_FEATURES_ARM64_LINUX 1
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace Falcor
+{
+namespace
+{
+#if CPU_FEATURES_X86
+void cpuid(int leaf, int subleaf, int regs[4])
+{
+#if FALCOR_MSVC
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = (int)a;
+    regs[1] = (int)b;
+    regs[2] = (int)c;
+    regs[3] = (int)d;
+#endif
+}
+
+uint64_t readXCR0()
+{
+#if FALCOR_MSVC
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+#endif
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+#if CPU_FEATURES_X86
+    int regs[4];
+    cpuid(0, 0, regs);
+    const int maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    features.ssse3 = (regs[2] & (1 << 9)) != 0;
+    features.sse41 = (regs[2] & (1 << 19)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    // AVX registers are only usable if the OS saves the XMM and YMM state.
+    const bool ymmEnabled = osxsave && avx && (readXCR0() & 0x6) == 0x6;
+
+    if (maxLeaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        features.avx2 = ymmEnabled && (regs[1] & (1 << 5)) != 0;
+        features.sha = (regs[1] & (1 << 29)) != 0;
+    }
+#elif CPU_FEATURES_ARM64_LINUX
+    const unsigned long hwcaps = getauxval(AT_HWCAP);
+    features.sha = (hwcaps & HWCAP_SHA1) != 0;
+#elif defined(_M_ARM64) || defined(__ARM_FEATURE_CRYPTO)
+    // Crypto extensions are part of the baseline of all supported ARM64 targets.
+    features.sha = true;
+#endif
+    return features;
+}
+} // namespace
+
+const CpuFeatures& getCpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+} // namespace Falcor
@@ -446,6 +446,11 @@ void printToDebugWindow(const std::string& s)
     std::cerr << s;
 }
 
+uint32_t getCurrentProcessId()
+{
+    return (uint32_t)getpid();
+}
+
 std::thread::native_handle_type getCurrentThread()
 {
     return pthread_self();
@@ -426,6 +426,11 @@ FALCOR_API bool hasExtension(const std::filesystem::path& path, const std::strin
  */
 FALCOR_API std::string getExtensionFromPath(const std::filesystem::path& path);
 
+/**
+ * Return the ID of the current process.
+ */
+FALCOR_API uint32_t getCurrentProcessId();
+
 /**
  * Return current thread handle
  */
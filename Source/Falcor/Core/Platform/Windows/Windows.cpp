@@ -819,6 +819,11 @@ void closeSharedFile(const std::filesystem::path& path)
     }
 }
 
+uint32_t getCurrentProcessId()
+{
+    return (uint32_t)::GetCurrentProcessId();
+}
+
 std::thread::native_handle_type getCurrentThread()
 {
     return ::GetCurrentThread();
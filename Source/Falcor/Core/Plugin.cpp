@@ -26,42 +26,58 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Plugin.h"
+#include "Core/Assert.h"
 #include "Utils/Logger.h"
 #include "Utils/Timing/CpuTimer.h"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <set>
+#include <thread>
 
 namespace Falcor
 {
 
-PluginManager& PluginManager::instance()
+namespace
 {
-    static PluginManager sInstance;
-    return sInstance;
+const char kManifestFilename[] = "plugins_manifest.json";
+const uint32_t kManifestVersion = 1;
+const size_t kPrefetchChunkSize = 1 << 20;
+
+using RegisterPluginProc = void (*)(PluginRegistry&);
+
+/// Manifest entry describing the classes registered by a plugin library.
+struct ManifestEntry
+{
+    uint64_t fileSize = 0;
+    int64_t fileTime = 0;
+    std::vector<std::pair<std::string, std::string>> classes; ///< List of (base type, type) pairs.
+};
+
+using Manifest = std::map<std::string, ManifestEntry>;
+
+std::filesystem::path getPluginDirectory()
+{
+    return getRuntimeDirectory() / "plugins";
 }
 
-bool PluginManager::loadPluginByName(std::string_view name)
+std::filesystem::path getPluginPath(const std::filesystem::path& directory, std::string_view name)
 {
-    auto path = getRuntimeDirectory() / "plugins" / std::string(name);
+    auto path = directory / std::string(name);
 #if FALCOR_WINDOWS
     path.replace_extension(".dll");
 #elif FALCOR_LINUX
     path.replace_extension(".so");
 #endif
-    return loadPlugin(path);
+    return path;
 }
 
-bool PluginManager::loadPlugin(const std::filesystem::path& path)
+/// Open a plugin library and check that it exports the registration function. Throws on failure.
+SharedLibraryHandle openPluginLibrary(const std::filesystem::path& path)
 {
-    // Early exit if plugin is already loaded.
-    {
-        std::lock_guard<std::mutex> lock(mLibrariesMutex);
-        if (mLibraries.find(path) != mLibraries.end())
-            return false;
-    }
-
     if (!std::filesystem::exists(path))
         throw RuntimeError("Failed to load plugin library from {}. File not found.", path);
 
@@ -69,25 +85,100 @@ bool PluginManager::loadPlugin(const std::filesystem::path& path)
     if (library == nullptr)
         throw RuntimeError("Failed to load plugin library from {}. Cannot load shared library.", path);
 
-    using RegisterPluginProc = void (*)(PluginRegistry&);
-
-    auto registerPluginProc = (RegisterPluginProc)getProcAddress(library, "registerPlugin");
-    if (registerPluginProc == nullptr)
+    if (getProcAddress(library, "registerPlugin") == nullptr)
+    {
+        releaseSharedLibrary(library);
         throw RuntimeError("Failed to load plugin library from {}. Symbol 'registerPlugin' not found.", path);
+    }
 
-    // Register plugin library.
+    return library;
+}
+
+/// Get the size and modification time of a file, used to detect stale manifest entries.
+bool getFileStamp(const std::filesystem::path& path, uint64_t& fileSize, int64_t& fileTime)
+{
+    std::error_code ec;
+    fileSize = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+    fileTime = time.time_since_epoch().count();
+    return true;
+}
+
+Manifest readManifest(const std::filesystem::path& path)
+{
+    Manifest manifest;
+
+    std::ifstream ifs(path);
+    if (!ifs.good())
+        return manifest;
+
+    try
     {
-        std::lock_guard<std::mutex> lock(mLibrariesMutex);
-        mLibraries[path] = library;
+        auto json = nlohmann::json::parse(ifs);
+        if (json.value("version", 0u) != kManifestVersion)
+            return manifest;
+
+        for (const auto& [name, jsonEntry] : json.at("libraries").items())
+        {
+            ManifestEntry entry;
+            entry.fileSize = jsonEntry.at("size").get<uint64_t>();
+            entry.fileTime = jsonEntry.at("time").get<int64_t>();
+            for (const auto& jsonClass : jsonEntry.at("classes"))
+                entry.classes.emplace_back(jsonClass.at("base").get<std::string>(), jsonClass.at("type").get<std::string>());
+            manifest.emplace(name, std::move(entry));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Ignoring invalid plugin manifest {}: {}", path, e.what());
+        manifest.clear();
     }
 
-    // Call plugin library to register plugin classes.
+    return manifest;
+}
+
+void writeManifest(const std::filesystem::path& path, const Manifest& manifest)
+{
+    nlohmann::json jsonLibraries = nlohmann::json::object();
+    for (const auto& [name, entry] : manifest)
     {
-        PluginRegistry registry(*this, library);
-        registerPluginProc(registry);
+        nlohmann::json jsonClasses = nlohmann::json::array();
+        for (const auto& [baseType, type] : entry.classes)
+            jsonClasses.push_back({{"base", baseType}, {"type", type}});
+        jsonLibraries[name] = {{"size", entry.fileSize}, {"time", entry.fileTime}, {"classes", jsonClasses}};
     }
 
-    return true;
+    nlohmann::json json = {{"version", kManifestVersion}, {"libraries", jsonLibraries}};
+
+    // The plugin directory may be read-only, in which case lazy loading falls back to loading unknown libraries.
+    std::ofstream ofs(path);
+    if (!ofs.good())
+    {
+        logWarning("Failed to write plugin manifest {}.", path);
+        return;
+    }
+    ofs << json.dump(4);
+}
+} // namespace
+
+PluginManager& PluginManager::instance()
+{
+    static PluginManager sInstance;
+    return sInstance;
+}
+
+bool PluginManager::loadPluginByName(std::string_view name)
+{
+    return loadPlugin(getPluginPath(getPluginDirectory(), name));
+}
+
+bool PluginManager::loadPlugin(const std::filesystem::path& path)
+{
+    return loadPlugins({path}, false) > 0;
 }
 
 bool PluginManager::releasePlugin(const std::filesystem::path& path)
@@ -122,27 +213,96 @@ bool PluginManager::releasePlugin(const std::filesystem::path& path)
     return true;
 }
 
-void PluginManager::loadAllPlugins()
+void PluginManager::loadAllPlugins(LoadMode mode, const std::filesystem::path& pluginDirectory)
 {
     CpuTimer timer;
     timer.update();
 
-    std::ifstream ifs(getRuntimeDirectory() / "plugins" / "plugins.json");
+    const std::filesystem::path directory = pluginDirectory.empty() ? getPluginDirectory() : pluginDirectory;
+    std::ifstream ifs(directory / "plugins.json");
     auto json = nlohmann::json::parse(ifs);
-    size_t loadedCount = 0;
+    std::vector<std::string> names;
     for (const auto& name : json)
+        names.push_back(name.get<std::string>());
+
+    if (mode != LoadMode::Lazy)
     {
-        if (loadPluginByName(name.get<std::string>()))
-            loadedCount++;
+        std::vector<std::filesystem::path> paths;
+        for (const auto& name : names)
+            paths.push_back(getPluginPath(directory, name));
+
+        size_t loadedCount = loadPlugins(paths, mode == LoadMode::Parallel);
+
+        timer.update();
+        if (loadedCount > 0)
+            logInfo("Loaded {} plugin(s) in {:.3}s", loadedCount, timer.delta());
+        return;
+    }
+
+    // Defer all libraries with an up-to-date manifest entry. The remaining libraries are loaded to record their classes.
+    const std::filesystem::path manifestPath = directory / kManifestFilename;
+    Manifest manifest = readManifest(manifestPath);
+    std::vector<std::string> unknownNames;
+    std::vector<std::filesystem::path> unknownPaths;
+    size_t deferredCount = 0;
+
+    for (const auto& name : names)
+    {
+        auto path = getPluginPath(directory, name);
+        if (isPluginLoaded(path))
+            continue;
+
+        uint64_t fileSize;
+        int64_t fileTime;
+        auto it = manifest.find(name);
+        if (it != manifest.end() && getFileStamp(path, fileSize, fileTime) && it->second.fileSize == fileSize &&
+            it->second.fileTime == fileTime)
+        {
+            std::lock_guard<std::mutex> lock(mClassDescsMutex);
+            for (const auto& [baseType, type] : it->second.classes)
+                mDeferredClassDescs.emplace(type, DeferredClassDesc{baseType, path});
+            deferredCount++;
+        }
+        else
+        {
+            unknownNames.push_back(name);
+            unknownPaths.push_back(path);
+        }
+    }
+
+    size_t loadedCount = loadPlugins(unknownPaths, true);
+
+    if (!unknownPaths.empty())
+    {
+        for (size_t i = 0; i < unknownPaths.size(); ++i)
+        {
+            ManifestEntry entry;
+            if (!getFileStamp(unknownPaths[i], entry.fileSize, entry.fileTime))
+                continue;
+            entry.classes = getPluginClasses(unknownPaths[i]);
+            manifest[unknownNames[i]] = std::move(entry);
+        }
+
+        // Drop entries of libraries that are no longer built.
+        std::set<std::string> nameSet(names.begin(), names.end());
+        for (auto it = manifest.begin(); it != manifest.end();)
+            it = nameSet.count(it->first) ? std::next(it) : manifest.erase(it);
+
+        writeManifest(manifestPath, manifest);
     }
 
     timer.update();
-    if (loadedCount > 0)
-        logInfo("Loaded {} plugin(s) in {:.3}s", loadedCount, timer.delta());
+    if (loadedCount > 0 || deferredCount > 0)
+        logInfo("Loaded {} plugin(s) and deferred {} plugin(s) in {:.3}s", loadedCount, deferredCount, timer.delta());
 }
 
 void PluginManager::releaseAllPlugins()
 {
+    {
+        std::lock_guard<std::mutex> lock(mClassDescsMutex);
+        mDeferredClassDescs.clear();
+    }
+
     while (true)
     {
         std::filesystem::path path;
@@ -156,4 +316,146 @@ void PluginManager::releaseAllPlugins()
     }
 }
 
+bool PluginManager::isPluginLoaded(const std::filesystem::path& path) const
+{
+    std::lock_guard<std::mutex> lock(mLibrariesMutex);
+    return mLibraries.find(path) != mLibraries.end();
+}
+
+size_t PluginManager::loadPlugins(const std::vector<std::filesystem::path>& paths, bool parallel)
+{
+    // The dynamic loader serializes opening libraries, so libraries are always opened and registered in order on
+    // the calling thread. In parallel mode, worker threads read the library files ahead of the loader so that
+    // the file I/O of a cold start overlaps with relocation and registration.
+    std::atomic<size_t> loadIndex{0};
+    std::atomic<size_t> prefetchIndex{0};
+    std::vector<std::thread> threads;
+    if (parallel && paths.size() > 1)
+    {
+        auto worker = [&]()
+        {
+            std::vector<char> buffer(kPrefetchChunkSize);
+            for (size_t i = prefetchIndex++; i < paths.size(); i = prefetchIndex++)
+            {
+                // Skip libraries the loader has already reached.
+                if (i < loadIndex)
+                    continue;
+                std::ifstream ifs(paths[i], std::ios::binary);
+                while (ifs.read(buffer.data(), buffer.size()))
+                    ;
+            }
+        };
+
+        size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency() / 2), paths.size());
+        for (size_t i = 0; i < threadCount; ++i)
+            threads.emplace_back(worker);
+    }
+
+    size_t loadedCount = 0;
+    try
+    {
+        for (; loadIndex < paths.size(); ++loadIndex)
+        {
+            const auto& path = paths[loadIndex];
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+            if (isPluginLoaded(path))
+                continue;
+            registerPluginLibrary(path, openPluginLibrary(path));
+            loadedCount++;
+        }
+    }
+    catch (...)
+    {
+        loadIndex = paths.size();
+        for (auto& thread : threads)
+            thread.join();
+        throw;
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    removeDeferredClasses(paths);
+
+    return loadedCount;
+}
+
+void PluginManager::registerPluginLibrary(const std::filesystem::path& path, SharedLibraryHandle library)
+{
+    auto registerPluginProc = (RegisterPluginProc)getProcAddress(library, "registerPlugin");
+    FALCOR_ASSERT(registerPluginProc);
+
+    // Register plugin library.
+    {
+        std::lock_guard<std::mutex> lock(mLibrariesMutex);
+        mLibraries[path] = library;
+    }
+
+    // Call plugin library to register plugin classes.
+    {
+        PluginRegistry registry(*this, library);
+        registerPluginProc(registry);
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> PluginManager::getPluginClasses(const std::filesystem::path& path) const
+{
+    std::vector<std::pair<std::string, std::string>> classes;
+
+    SharedLibraryHandle library;
+    {
+        std::lock_guard<std::mutex> lock(mLibrariesMutex);
+        auto it = mLibraries.find(path);
+        if (it == mLibraries.end())
+            return classes;
+        library = it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(mClassDescsMutex);
+    for (const auto& [name, desc] : mClassDescs)
+        if (desc->library == library)
+            classes.emplace_back(desc->getBaseType(), desc->type);
+
+    return classes;
+}
+
+void PluginManager::removeDeferredClasses(const std::vector<std::filesystem::path>& paths)
+{
+    std::lock_guard<std::mutex> lock(mClassDescsMutex);
+    if (mDeferredClassDescs.empty())
+        return;
+
+    std::set<std::filesystem::path> pathSet(paths.begin(), paths.end());
+    for (auto it = mDeferredClassDescs.begin(); it != mDeferredClassDescs.end();)
+        it = pathSet.count(it->second.path) ? mDeferredClassDescs.erase(it) : std::next(it);
+}
+
+void PluginManager::loadDeferredClass(const std::string& baseType, std::string_view type)
+{
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(mClassDescsMutex);
+        const DeferredClassDesc* desc = findDeferredClassDesc(baseType, type);
+        if (!desc)
+            return;
+        path = desc->path;
+    }
+
+    loadPlugins({path}, false);
+}
+
+void PluginManager::loadDeferredClasses(const std::string& baseType)
+{
+    std::vector<std::filesystem::path> paths;
+    {
+        std::lock_guard<std::mutex> lock(mClassDescsMutex);
+        for (const auto& [type, desc] : mDeferredClassDescs)
+            if (desc.baseType == baseType && std::find(paths.begin(), paths.end(), desc.path) == paths.end())
+                paths.push_back(desc.path);
+    }
+
+    if (!paths.empty())
+        loadPlugins(paths, true);
+}
+
 } // namespace Falcor
@@ -103,10 +103,23 @@ namespace Falcor
  * @endcode
  *
  * The `getInfos` function returns a list of plugin infos for all loaded plugin types of a given plugin base class.
+ *
+ * `loadAllPlugins` supports loading plugin libraries lazily. The plugin manager keeps a manifest next to `plugins.json`
+ * that records the classes each plugin library registers. In lazy mode, classes listed in an up-to-date manifest entry
+ * are resolved to their library without loading it, and the library is loaded on the first `createClass` (or `getInfos`
+ * for the class's base class). Libraries that are missing from the manifest are loaded right away and recorded.
  */
 class FALCOR_API PluginManager
 {
 public:
+    /// Plugin library loading modes used by loadAllPlugins().
+    enum class LoadMode
+    {
+        Eager,    ///< Load all plugin libraries sequentially.
+        Parallel, ///< Load all plugin libraries sequentially while worker threads prefetch the library files.
+        Lazy,     ///< Defer loading plugin libraries until one of their classes is requested.
+    };
+
     /// Singleton accessor.
     static PluginManager& instance();
 
@@ -120,8 +133,10 @@ public:
      * @return Returns a new instance of the requested plugin type or nullptr if not registered.
      */
     template<typename BaseT, typename... Args>
-    std::invoke_result_t<typename BaseT::PluginCreate, Args...> createClass(std::string_view type, Args... args) const
+    std::invoke_result_t<typename BaseT::PluginCreate, Args...> createClass(std::string_view type, Args... args)
     {
+        loadDeferredClass(BaseT::getPluginBaseType(), type);
+
         std::lock_guard<std::mutex> lock(mClassDescsMutex);
         const ClassDesc<BaseT>* classDesc = findClassDesc<BaseT>(type);
         return classDesc ? classDesc->create(args...) : std::invoke_result_t<typename BaseT::PluginCreate, Args...>{nullptr};
@@ -129,6 +144,7 @@ public:
 
     /**
      * @brief Check if a given type of a plugin is available.
+     * Classes of deferred plugin libraries are available without loading the library.
      *
      * @tparam BaseT The plugin base class.
      * @param type The plugin type name.
@@ -138,19 +154,21 @@ public:
     bool hasClass(std::string_view type) const
     {
         std::lock_guard<std::mutex> lock(mClassDescsMutex);
-        const ClassDesc<BaseT>* classDesc = findClassDesc<BaseT>(type);
-        return classDesc != nullptr;
+        return findClassDesc<BaseT>(type) != nullptr || findDeferredClassDesc(BaseT::getPluginBaseType(), type) != nullptr;
     }
 
     /**
      * @brief Get infos for all registered plugin types for a given plugin base class.
+     * This loads all deferred plugin libraries providing classes of the given base class.
      *
      * @tparam BaseT The plugin base class.
      * @return A list of infos.
      */
     template<typename BaseT>
-    std::vector<std::pair<std::string, typename BaseT::PluginInfo>> getInfos() const
+    std::vector<std::pair<std::string, typename BaseT::PluginInfo>> getInfos()
     {
+        loadDeferredClasses(BaseT::getPluginBaseType());
+
         std::lock_guard<std::mutex> lock(mClassDescsMutex);
         std::vector<std::pair<std::string, typename BaseT::PluginInfo>> result;
 
@@ -184,9 +202,13 @@ public:
     bool releasePlugin(const std::filesystem::path& path);
 
     /**
-     * Load all plugin libraries.
+     * Load all plugin libraries listed in `plugins.json`.
+     * Note: In lazy mode, script bindings of a plugin library are only registered once the library is loaded.
+     * @param mode Loading mode.
+     * @param pluginDirectory Directory containing `plugins.json` and the plugin libraries.
+     * Defaults to the `plugins` directory in the runtime directory.
      */
-    void loadAllPlugins();
+    void loadAllPlugins(LoadMode mode = LoadMode::Eager, const std::filesystem::path& pluginDirectory = {});
 
     /**
      * Release all loaded plugin libraries.
@@ -199,6 +221,8 @@ private:
         ClassDescBase(SharedLibraryHandle library, std::string_view type) : library(library), type(type) {}
         virtual ~ClassDescBase() {}
 
+        virtual const std::string& getBaseType() const = 0;
+
         SharedLibraryHandle library;
         std::string type;
     };
@@ -212,6 +236,15 @@ private:
         ClassDesc(SharedLibraryHandle library, std::string_view type, typename BaseT::PluginInfo info, typename BaseT::PluginCreate create)
             : ClassDescBase(library, type), info(info), create(create)
         {}
+
+        const std::string& getBaseType() const override { return BaseT::getPluginBaseType(); }
+    };
+
+    /// Class listed in the plugin manifest whose library has not been loaded yet.
+    struct DeferredClassDesc
+    {
+        std::string baseType;
+        std::filesystem::path path;
     };
 
     template<typename BaseT>
@@ -243,9 +276,28 @@ private:
         return nullptr;
     }
 
+    const DeferredClassDesc* findDeferredClassDesc(const std::string& baseType, std::string_view type) const
+    {
+        if (auto it = mDeferredClassDescs.find(std::string(type)); it != mDeferredClassDescs.end())
+            if (it->second.baseType == baseType)
+                return &it->second;
+
+        return nullptr;
+    }
+
+    bool isPluginLoaded(const std::filesystem::path& path) const;
+    size_t loadPlugins(const std::vector<std::filesystem::path>& paths, bool parallel);
+    void registerPluginLibrary(const std::filesystem::path& path, SharedLibraryHandle library);
+    std::vector<std::pair<std::string, std::string>> getPluginClasses(const std::filesystem::path& path) const;
+    void removeDeferredClasses(const std::vector<std::filesystem::path>& paths);
+    void loadDeferredClass(const std::string& baseType, std::string_view type);
+    void loadDeferredClasses(const std::string& baseType);
+
     std::map<std::filesystem::path, SharedLibraryHandle> mLibraries;
     std::map<std::string, std::shared_ptr<ClassDescBase>> mClassDescs;
+    std::map<std::string, DeferredClassDesc> mDeferredClassDescs;
 
+    mutable std::mutex mLoadMutex;
     mutable std::mutex mLibrariesMutex;
     mutable std::mutex mClassDescsMutex;
 
@@ -396,8 +396,16 @@ const ref<const ProgramVersion>& Program::getActiveVersion() const
 {
     if (mLinkRequired)
     {
-        const auto& it = mProgramVersions.find(ProgramVersionKey{mDefineList, mTypeConformanceList});
-        if (it == mProgramVersions.end())
+        ProgramVersionKey key{mDefineList, mTypeConformanceList};
+        ref<const ProgramVersion> pCachedVersion;
+        {
+            std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+            const auto& it = mProgramVersions.find(key);
+            if (it != mProgramVersions.end())
+                pCachedVersion = it->second;
+        }
+
+        if (pCachedVersion == nullptr)
         {
             // Note that link() updates mActiveProgram only if the operation was successful.
             // On error we get false, and mActiveProgram points to the last successfully compiled version.
@@ -407,12 +415,13 @@ const ref<const ProgramVersion>& Program::getActiveVersion() const
             }
             else
             {
-                mProgramVersions[ProgramVersionKey{mDefineList, mTypeConformanceList}] = mpActiveVersion;
+                std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+                mProgramVersions[key] = mpActiveVersion;
             }
         }
         else
         {
-            mpActiveVersion = it->second;
+            mpActiveVersion = pCachedVersion;
         }
         mLinkRequired = false;
     }
@@ -426,7 +435,7 @@ bool Program::link() const
     {
         // Create the program
         std::string log;
-        auto pVersion = mpDevice->getProgramManager()->createProgramVersion(*this, log);
+        auto pVersion = mpDevice->getProgramManager()->createProgramVersion(*this, mDefineList, log);
 
         if (pVersion == nullptr)
         {
@@ -449,10 +458,40 @@ bool Program::link() const
     }
 }
 
+bool Program::precompileVersion(const DefineList& defineList, const TypeConformanceList& typeConformances) const
+{
+    ProgramVersionKey key{defineList, typeConformances};
+    uint32_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+        if (mProgramVersions.find(key) != mProgramVersions.end())
+            return true;
+        generation = mProgramVersionsGeneration;
+    }
+
+    std::string log;
+    auto pVersion = mpDevice->getProgramManager()->createProgramVersion(*this, defineList, log);
+    if (pVersion == nullptr)
+    {
+        logWarning("Failed to precompile program:\n{}\n\n{}", getProgramDescString(), log);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+    // Drop the version if the program was reset (e.g. reloaded) while compiling.
+    if (generation == mProgramVersionsGeneration)
+        mProgramVersions.emplace(std::move(key), pVersion);
+    return true;
+}
+
 void Program::reset()
 {
     mpActiveVersion = nullptr;
-    mProgramVersions.clear();
+    {
+        std::lock_guard<std::mutex> lock(mProgramVersionsMutex);
+        mProgramVersions.clear();
+        mProgramVersionsGeneration++;
+    }
     mFileTimeMap.clear();
     mLinkRequired = true;
 }
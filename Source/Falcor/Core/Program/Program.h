@@ -37,6 +37,7 @@
 #include <string_view>
 #include <string>
 #include <map>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -452,6 +453,24 @@ public:
      */
     const DefineList& getDefineList() const { return mDefineList; }
 
+    /**
+     * Compile the program version for a set of macro definitions without making it the active version.
+     * The version is added to the program's version cache, so a later switch to the same macro definitions and
+     * type conformances doesn't need to compile. Only the front-end compilation is done here; kernels are still
+     * created on first use and their code is looked up in the device's persistent shader cache.
+     * This function may be called from a worker thread. Compilation is serialized with all other program
+     * compilation by the program manager.
+     * @param[in] defineList Full list of macro definitions of the version.
+     * @param[in] typeConformances Type conformances of the version.
+     * @return True if the version was compiled or already cached, false if compilation failed.
+     */
+    bool precompileVersion(const DefineList& defineList, const TypeConformanceList& typeConformances) const;
+
+    /**
+     * Get the type conformance list of the active program version.
+     */
+    const TypeConformanceList& getTypeConformanceList() const { return mTypeConformanceList; }
+
     /**
      * Get the program reflection for the active program.
      * @return Program reflection object, or an exception is thrown on failure.
@@ -499,6 +518,8 @@ protected:
     // We are doing lazy compilation, so these are mutable
     mutable bool mLinkRequired = true;
     mutable std::map<ProgramVersionKey, ref<const ProgramVersion>> mProgramVersions;
+    mutable std::mutex mProgramVersionsMutex; ///< Guards mProgramVersions and mProgramVersionsGeneration against precompilation threads.
+    uint32_t mProgramVersionsGeneration = 0;  ///< Incremented on reset, so versions compiled before a reload are discarded.
     mutable ref<const ProgramVersion> mpActiveVersion;
     void markDirty() { mLinkRequired = true; }
 
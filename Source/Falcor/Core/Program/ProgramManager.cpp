@@ -102,12 +102,14 @@ inline bool doSlangReflection(
 
 ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice) {}
 
-ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& program, std::string& log) const
+ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& program, const DefineList& defineList, std::string& log) const
 {
+    std::lock_guard<std::mutex> lock(mCompileMutex);
+
     CpuTimer timer;
     timer.update();
 
-    auto pSlangRequest = createSlangCompileRequest(program);
+    auto pSlangRequest = createSlangCompileRequest(program, defineList);
     if (pSlangRequest == nullptr)
         return nullptr;
 
@@ -190,7 +192,7 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
     }
 
     auto descStr = program.getProgramDescString();
-    pVersion->init(program.getDefineList(), pReflector, descStr, pSlangEntryPoints);
+    pVersion->init(defineList, pReflector, descStr, pSlangEntryPoints);
 
     timer.update();
     double time = timer.delta();
@@ -209,6 +211,8 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
     std::string& log
 ) const
 {
+    std::lock_guard<std::mutex> lock(mCompileMutex);
+
     CpuTimer timer;
     timer.update();
 
@@ -536,6 +540,8 @@ void ProgramManager::unregisterProgramForReload(Program* program)
 
 bool ProgramManager::reloadAllPrograms(bool forceReload)
 {
+    std::lock_guard<std::mutex> lock(mCompileMutex);
+
     bool hasReloaded = false;
 
     for (auto program : mLoadedPrograms)
@@ -552,13 +558,19 @@ bool ProgramManager::reloadAllPrograms(bool forceReload)
 
 void ProgramManager::addGlobalDefines(const DefineList& defineList)
 {
-    mGlobalDefineList.add(defineList);
+    {
+        std::lock_guard<std::mutex> lock(mCompileMutex);
+        mGlobalDefineList.add(defineList);
+    }
     reloadAllPrograms(true);
 }
 
 void ProgramManager::removeGlobalDefines(const DefineList& defineList)
 {
-    mGlobalDefineList.remove(defineList);
+    {
+        std::lock_guard<std::mutex> lock(mCompileMutex);
+        mGlobalDefineList.remove(defineList);
+    }
     reloadAllPrograms(true);
 }
 
@@ -574,7 +586,10 @@ bool ProgramManager::isGenerateDebugInfoEnabled()
 
 void ProgramManager::setForcedCompilerFlags(ForcedCompilerFlags forcedCompilerFlags)
 {
-    mForcedCompilerFlags = forcedCompilerFlags;
+    {
+        std::lock_guard<std::mutex> lock(mCompileMutex);
+        mForcedCompilerFlags = forcedCompilerFlags;
+    }
     reloadAllPrograms(true);
 }
 
@@ -583,7 +598,7 @@ ProgramManager::ForcedCompilerFlags ProgramManager::getForcedCompilerFlags()
     return mForcedCompilerFlags;
 }
 
-SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program) const
+SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program, const DefineList& defineList) const
 {
     slang::IGlobalSession* pSlangGlobalSession = mpDevice->getSlangGlobalSession();
     FALCOR_ASSERT(pSlangGlobalSession);
@@ -666,7 +681,7 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     // Add global followed by program specific defines.
     for (const auto& shaderDefine : mGlobalDefineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
-    for (const auto& shaderDefine : program.getDefineList())
+    for (const auto& shaderDefine : defineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
 
     // Add a `#define`s based on the target and shader model.
@@ -31,6 +31,7 @@
 #include "Core/API/fwd.h"
 
 #include <memory>
+#include <mutex>
 
 namespace Falcor
 {
@@ -64,7 +65,12 @@ public:
     void registerProgramForReload(Program* program);
     void unregisterProgramForReload(Program* program);
 
-    ref<const ProgramVersion> createProgramVersion(const Program& program, std::string& log) const;
+    /**
+     * Run the Slang front-end for a program with the given macro definitions.
+     * Program compilation is serialized, as the Slang global session is not thread-safe.
+     * This function can therefore be called from worker threads (see Program::precompileVersion()).
+     */
+    ref<const ProgramVersion> createProgramVersion(const Program& program, const DefineList& defineList, std::string& log) const;
 
     ref<const ProgramKernels> createProgramKernels(
         const Program& program,
@@ -127,12 +133,13 @@ public:
     void resetCompilationStats() { mCompilationStats = {}; }
 
 private:
-    SlangCompileRequest* createSlangCompileRequest(const Program& program) const;
+    SlangCompileRequest* createSlangCompileRequest(const Program& program, const DefineList& defineList) const;
 
     Device* mpDevice;
 
     std::vector<Program*> mLoadedPrograms;
     mutable CompilationStats mCompilationStats;
+    mutable std::mutex mCompileMutex; ///< Serializes all use of the Slang global session.
 
     DefineList mGlobalDefineList;
     bool mGenerateDebugInfo = false;
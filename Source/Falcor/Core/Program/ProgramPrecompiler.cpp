@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ProgramPrecompiler.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <functional>
+
+namespace Falcor
+{
+ProgramPrecompiler::~ProgramPrecompiler()
+{
+    cancel();
+    releaseCancelledJobs(true);
+}
+
+void ProgramPrecompiler::start(const ref<Program>& pProgram, std::vector<DefineList> permutations)
+{
+    FALCOR_CHECK_ARG(pProgram != nullptr);
+
+    cancel();
+
+    mpJob = std::make_unique<Job>();
+    mpJob->pProgram = pProgram;
+    mpJob->total = (uint32_t)permutations.size();
+    mpJob->thread = std::thread(&ProgramPrecompiler::run, std::ref(*mpJob), std::move(permutations), pProgram->getTypeConformanceList());
+}
+
+void ProgramPrecompiler::cancel()
+{
+    if (mpJob)
+    {
+        mCancelledProgress = getProgress();
+        mpJob->cancel = true;
+        mCancelledJobs.push_back(std::move(mpJob));
+    }
+    releaseCancelledJobs(false);
+}
+
+ProgramPrecompiler::Progress ProgramPrecompiler::getProgress() const
+{
+    if (!mpJob)
+        return mCancelledProgress;
+
+    Progress progress;
+    progress.completed = mpJob->completed;
+    progress.failed = mpJob->failed;
+    progress.total = mpJob->total;
+    return progress;
+}
+
+void ProgramPrecompiler::releaseCancelledJobs(bool wait)
+{
+    auto it = std::remove_if(
+        mCancelledJobs.begin(),
+        mCancelledJobs.end(),
+        [wait](std::unique_ptr<Job>& pJob)
+        {
+            if (!wait && pJob->running)
+                return false;
+            pJob->thread.join();
+            pJob->pProgram = nullptr;
+            return true;
+        }
+    );
+    mCancelledJobs.erase(it, mCancelledJobs.end());
+}
+
+void ProgramPrecompiler::run(Job& job, std::vector<DefineList> permutations, Program::TypeConformanceList typeConformances)
+{
+    CpuTimer timer;
+    timer.update();
+
+    for (const auto& defineList : permutations)
+    {
+        if (job.cancel)
+            break;
+
+        bool success = false;
+        try
+        {
+            success = job.pProgram->precompileVersion(defineList, typeConformances);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Program precompilation failed: {}", e.what());
+        }
+
+        if (!success)
+            job.failed++;
+        job.completed++;
+    }
+
+    timer.update();
+    logInfo(
+        "Precompiled {} of {} program versions in {:.2f} s ({} failed).", job.completed.load(), job.total, timer.delta(), job.failed.load()
+    );
+    job.running = false;
+}
+} // namespace Falcor
@@ -0,0 +1,113 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Program.h"
+#include "DefineList.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Compiles versions of a program for a list of macro definition sets on a background thread.
+ * Compiled versions are stored in the program's version cache (see Program::precompileVersion()),
+ * so switching the program to one of the definition sets later doesn't stall the render thread.
+ * Kernel code of previously used versions is reused from the device's persistent shader cache.
+ */
+class FALCOR_API ProgramPrecompiler
+{
+public:
+    struct Progress
+    {
+        uint32_t completed = 0; ///< Number of processed permutations, including failed ones.
+        uint32_t failed = 0;    ///< Number of permutations that failed to compile.
+        uint32_t total = 0;     ///< Total number of permutations.
+
+        bool isDone() const { return completed == total; }
+        float getFraction() const { return total > 0 ? float(completed) / float(total) : 1.f; }
+    };
+
+    ProgramPrecompiler() = default;
+    /// Cancels the precompilation and waits for all worker threads to finish.
+    ~ProgramPrecompiler();
+
+    ProgramPrecompiler(const ProgramPrecompiler&) = delete;
+    ProgramPrecompiler& operator=(const ProgramPrecompiler&) = delete;
+
+    /**
+     * Start compiling program versions in the background. A precompilation in progress is cancelled first.
+     * Permutations that are already in the program's version cache are skipped.
+     * The program's type conformances at the time of the call are used for all permutations.
+     * @param[in] pProgram Program to compile.
+     * @param[in] permutations Full macro definition lists, one per program version.
+     */
+    void start(const ref<Program>& pProgram, std::vector<DefineList> permutations);
+
+    /**
+     * Cancel the precompilation. This doesn't block: the worker thread stops after the permutation that is currently
+     * compiling and is joined by a later call to start(), cancel() or the destructor.
+     */
+    void cancel();
+
+    /**
+     * Check if the background thread is still compiling.
+     */
+    bool isRunning() const { return mpJob && mpJob->running; }
+
+    /**
+     * Get the progress of the current (or last) precompilation.
+     */
+    Progress getProgress() const;
+
+private:
+    /// State of one precompilation, shared with its worker thread.
+    struct Job
+    {
+        ref<Program> pProgram; ///< Program being compiled. Only released on the calling thread, as programs unregister from the program manager on destruction.
+        std::thread thread;
+        std::atomic<bool> running{true};
+        std::atomic<bool> cancel{false};
+        std::atomic<uint32_t> completed{0};
+        std::atomic<uint32_t> failed{0};
+        uint32_t total = 0;
+    };
+
+    static void run(Job& job, std::vector<DefineList> permutations, Program::TypeConformanceList typeConformances);
+
+    /// Join and release cancelled jobs whose worker has finished. If wait is true, waits for all of them.
+    void releaseCancelledJobs(bool wait);
+
+    std::unique_ptr<Job> mpJob;                       ///< Current (or last) precompilation.
+    std::vector<std::unique_ptr<Job>> mCancelledJobs; ///< Cancelled precompilations that may still be finishing a permutation.
+    Progress mCancelledProgress;                      ///< Progress of the last precompilation when it was cancelled.
+};
+} // namespace Falcor
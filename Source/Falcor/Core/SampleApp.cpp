@@ -120,7 +120,7 @@ SampleApp::SampleApp(const SampleAppConfig& config)
     initUI();
     mpPixelZoom = std::make_unique<PixelZoom>(mpDevice, mpTargetFBO.get());
 
-    PluginManager::instance().loadAllPlugins();
+    PluginManager::instance().loadAllPlugins(config.pluginLoadMode);
 }
 
 SampleApp::~SampleApp()
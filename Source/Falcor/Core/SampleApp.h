@@ -29,6 +29,7 @@
 #include "Window.h"
 #include "Core/Macros.h"
 #include "Core/HotReloadFlags.h"
+#include "Core/Plugin.h"
 #include "Core/Platform/ProgressBar.h"
 #include "Core/API/Device.h"
 #include "Core/API/Swapchain.h"
@@ -71,6 +72,8 @@ struct SampleAppConfig
 
     bool generateShaderDebugInfo = false;
     bool shaderPreciseFloat = false;
+
+    PluginManager::LoadMode pluginLoadMode = PluginManager::LoadMode::Eager; ///< Mode used to load the plugin libraries.
 };
 
 /**
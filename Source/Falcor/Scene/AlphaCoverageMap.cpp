@@ -0,0 +1,352 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AlphaCoverageMap.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Number of cells the hierarchical rasterization starts from.
+        */
+        const uint64_t kCoarseCellCount = 4;
+
+        /** Footprints beyond this many texels from the origin are not classified.
+        */
+        const double kMaxTexelCoord = double(1ll << 40);
+
+        /** Level-0 texel range [first, last] in one dimension.
+        */
+        struct TexelRange
+        {
+            int64_t first = 0;
+            int64_t last = -1;
+        };
+
+        int64_t floorDiv(int64_t x, int64_t d)
+        {
+            int64_t q = x / d;
+            return (x % d != 0 && x < 0) ? q - 1 : q;
+        }
+
+        int64_t floorShift(int64_t x, uint32_t shift)
+        {
+            return floorDiv(x, int64_t(1) << shift);
+        }
+
+        /** Resolve an unwrapped texel range to texel ranges within the texture.
+            \param[in] first First texel.
+            \param[in] last Last texel.
+            \param[in] size Texture size in texels.
+            \param[in] mode Address mode.
+            \param[out] ranges Resolved ranges.
+            \return Number of resolved ranges, or 0 if the range is not supported by the address mode.
+        */
+        uint32_t resolveRange(int64_t first, int64_t last, int64_t size, Sampler::AddressMode mode, TexelRange ranges[2])
+        {
+            FALCOR_ASSERT(first <= last && size > 0);
+            const bool coversAll = last - first + 1 >= size;
+
+            switch (mode)
+            {
+            case Sampler::AddressMode::Wrap:
+            {
+                if (coversAll)
+                {
+                    ranges[0] = {0, size - 1};
+                    return 1;
+                }
+                int64_t a = first - floorDiv(first, size) * size;
+                int64_t b = last - floorDiv(last, size) * size;
+                if (a <= b)
+                {
+                    ranges[0] = {a, b};
+                    return 1;
+                }
+                ranges[0] = {a, size - 1};
+                ranges[1] = {0, b};
+                return 2;
+            }
+            case Sampler::AddressMode::Mirror:
+            {
+                if (coversAll)
+                {
+                    ranges[0] = {0, size - 1};
+                    return 1;
+                }
+                // Texels are mirrored in every odd period. A range crossing a period boundary folds back at the edge it crosses.
+                auto mirror = [size](int64_t x, int64_t period)
+                {
+                    int64_t offset = x - period * size;
+                    return (period & 1) == 0 ? offset : size - 1 - offset;
+                };
+                int64_t p0 = floorDiv(first, size);
+                int64_t p1 = floorDiv(last, size);
+                int64_t a = mirror(first, p0);
+                int64_t b = mirror(last, p1);
+                if (p0 == p1)
+                    ranges[0] = {std::min(a, b), std::max(a, b)};
+                else if ((p0 & 1) == 0)
+                    ranges[0] = {std::min(a, b), size - 1};
+                else
+                    ranges[0] = {0, std::max(a, b)};
+                return 1;
+            }
+            case Sampler::AddressMode::Clamp:
+                ranges[0] = {std::clamp<int64_t>(first, 0, size - 1), std::clamp<int64_t>(last, 0, size - 1)};
+                return 1;
+            default:
+                // Border and mirror-once addressing are only supported for footprints within the texture.
+                if (first < 0 || last >= size)
+                    return 0;
+                ranges[0] = {first, last};
+                return 1;
+            }
+        }
+
+        bool isRepeatingAddressMode(Sampler::AddressMode mode)
+        {
+            return mode == Sampler::AddressMode::Wrap || mode == Sampler::AddressMode::Mirror || mode == Sampler::AddressMode::Clamp;
+        }
+
+        AlphaCoverage classifyRange(uint32_t minAlpha, uint32_t maxAlpha, float threshold)
+        {
+            if (minAlpha / 255.f >= threshold)
+                return AlphaCoverage::Opaque;
+            if (maxAlpha / 255.f < threshold)
+                return AlphaCoverage::Transparent;
+            return AlphaCoverage::Unknown;
+        }
+    }
+
+    AlphaCoverageMap::AlphaCoverageMap(uint32_t width, uint32_t height, const uint8_t* pAlpha, uint32_t texelStride, const Desc& desc)
+        : mDesc(desc)
+    {
+        if (width == 0 || height == 0)
+            throw ArgumentError("Alpha coverage map size ({}x{}) is invalid.", width, height);
+        FALCOR_ASSERT(pAlpha);
+
+        Level base;
+        base.width = width;
+        base.height = height;
+        base.minAlpha.resize((size_t)width * height);
+        for (size_t i = 0; i < base.minAlpha.size(); i++)
+            base.minAlpha[i] = pAlpha[i * texelStride];
+        base.maxAlpha = base.minAlpha;
+        mLevels.push_back(std::move(base));
+
+        // Each texel of the next level covers up to 2x2 texels of the previous level, so that
+        // texel k of level l covers texels [k * 2^l, (k + 1) * 2^l) of the base level.
+        while (mLevels.back().width > 1 || mLevels.back().height > 1)
+        {
+            const Level& src = mLevels.back();
+            Level dst;
+            dst.width = (src.width + 1) / 2;
+            dst.height = (src.height + 1) / 2;
+            dst.minAlpha.resize((size_t)dst.width * dst.height);
+            dst.maxAlpha.resize((size_t)dst.width * dst.height);
+            for (uint32_t y = 0; y < dst.height; y++)
+            {
+                for (uint32_t x = 0; x < dst.width; x++)
+                {
+                    uint8_t minAlpha = 255;
+                    uint8_t maxAlpha = 0;
+                    for (uint32_t sy = 2 * y; sy <= std::min(2 * y + 1, src.height - 1); sy++)
+                    {
+                        for (uint32_t sx = 2 * x; sx <= std::min(2 * x + 1, src.width - 1); sx++)
+                        {
+                            minAlpha = std::min(minAlpha, src.minAlpha[(size_t)sy * src.width + sx]);
+                            maxAlpha = std::max(maxAlpha, src.maxAlpha[(size_t)sy * src.width + sx]);
+                        }
+                    }
+                    dst.minAlpha[(size_t)y * dst.width + x] = minAlpha;
+                    dst.maxAlpha[(size_t)y * dst.width + x] = maxAlpha;
+                }
+            }
+            mLevels.push_back(std::move(dst));
+        }
+    }
+
+    AlphaCoverage AlphaCoverageMap::classify(const float2& uv0, const float2& uv1, const float2& uv2, float threshold) const
+    {
+        const double width = getWidth();
+        const double height = getHeight();
+        const Point p[3] = {{uv0.x * width, uv0.y * height}, {uv1.x * width, uv1.y * height}, {uv2.x * width, uv2.y * height}};
+        for (const Point& q : p)
+        {
+            if (!(std::abs(q.x) < kMaxTexelCoord && std::abs(q.y) < kMaxTexelCoord))
+                return AlphaCoverage::Unknown;
+        }
+
+        // Bilinear filtering reaches the texels whose centers are within one texel of the sample point, i.e. the texels
+        // within half a texel of the footprint. A box-filtered mip texel averages a block of base texels, so sampling mip
+        // level l reaches base texels within two mip texels of the footprint.
+        const double margin = mDesc.maxMipLevel == 0 ? 0.5 : 2.0 * std::ldexp(1.0, (int)std::min(mDesc.maxMipLevel, 30u));
+
+        const double minX = std::min({p[0].x, p[1].x, p[2].x}) - margin;
+        const double minY = std::min({p[0].y, p[1].y, p[2].y}) - margin;
+        const double maxX = std::max({p[0].x, p[1].x, p[2].x}) + margin;
+        const double maxY = std::max({p[0].y, p[1].y, p[2].y}) + margin;
+        const int64_t x0 = (int64_t)std::floor(minX);
+        const int64_t y0 = (int64_t)std::floor(minY);
+        const int64_t x1 = (int64_t)std::floor(maxX);
+        const int64_t y1 = (int64_t)std::floor(maxY);
+
+        auto cellCount = [&](uint32_t level)
+        { return uint64_t(floorShift(x1, level) - floorShift(x0, level) + 1) * uint64_t(floorShift(y1, level) - floorShift(y0, level) + 1); };
+        const uint32_t topLevel = getLevelCount() - 1;
+        auto findLevel = [&](uint64_t budget)
+        {
+            uint32_t level = 0;
+            while (level < topLevel && cellCount(level) > budget)
+                level++;
+            return level;
+        };
+
+        // Descend from a few cells at a coarse level to the finest level within the cell budget.
+        // Cells whose alpha range is on one side of the threshold are not refined.
+        const uint64_t cellBudget = std::max<uint64_t>(mDesc.maxCellCount, kCoarseCellCount);
+        const uint32_t coarseLevel = findLevel(kCoarseCellCount);
+        const uint32_t fineLevel = findLevel(cellBudget);
+
+        if (cellCount(fineLevel) > cellBudget)
+        {
+            // The footprint repeats the texture too many times. Use the range of the whole texture.
+            FALCOR_ASSERT(fineLevel == topLevel);
+            if (!isRepeatingAddressMode(mDesc.addressModeU) || !isRepeatingAddressMode(mDesc.addressModeV))
+                return AlphaCoverage::Unknown;
+            return classifyRange(mLevels[topLevel].minAlpha[0], mLevels[topLevel].maxAlpha[0], threshold);
+        }
+
+        uint32_t minAlpha = 255;
+        uint32_t maxAlpha = 0;
+
+        for (int64_t cy = floorShift(y0, coarseLevel); cy <= floorShift(y1, coarseLevel); cy++)
+        {
+            for (int64_t cx = floorShift(x0, coarseLevel); cx <= floorShift(x1, coarseLevel); cx++)
+            {
+                if (!accumulate(p, margin, cx, cy, coarseLevel, fineLevel, threshold, minAlpha, maxAlpha))
+                    return AlphaCoverage::Unknown;
+                if (classifyRange(minAlpha, maxAlpha, threshold) == AlphaCoverage::Unknown)
+                    return AlphaCoverage::Unknown;
+            }
+        }
+
+        return classifyRange(minAlpha, maxAlpha, threshold);
+    }
+
+    bool AlphaCoverageMap::accumulate(
+        const Point p[3],
+        double margin,
+        int64_t cx,
+        int64_t cy,
+        uint32_t level,
+        uint32_t fineLevel,
+        float threshold,
+        uint32_t& minAlpha,
+        uint32_t& maxAlpha
+    ) const
+    {
+        const Level& data = mLevels[level];
+        const int64_t cellSize = int64_t(1) << level;
+
+        // Test the cell expanded by the margin against the footprint. For each edge, the box corner furthest towards
+        // the inside of the triangle has to be inside the edge. Degenerate footprints are only tested against their bounds.
+        const double boxMinX = double(cx * cellSize) - margin;
+        const double boxMinY = double(cy * cellSize) - margin;
+        const double boxMaxX = double((cx + 1) * cellSize) + margin;
+        const double boxMaxY = double((cy + 1) * cellSize) + margin;
+        if (boxMaxX < std::min({p[0].x, p[1].x, p[2].x}) || boxMinX > std::max({p[0].x, p[1].x, p[2].x}) ||
+            boxMaxY < std::min({p[0].y, p[1].y, p[2].y}) || boxMinY > std::max({p[0].y, p[1].y, p[2].y}))
+            return true;
+
+        const double area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+        if (area != 0.0)
+        {
+            const double orientation = area > 0.0 ? 1.0 : -1.0;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const Point& a = p[i];
+                const Point& b = p[(i + 1) % 3];
+                const double ex = (b.x - a.x) * orientation;
+                const double ey = (b.y - a.y) * orientation;
+                const double qx = ey > 0.0 ? boxMinX : boxMaxX;
+                const double qy = ex > 0.0 ? boxMaxY : boxMinY;
+                if (ex * (qy - a.y) - ey * (qx - a.x) < 0.0)
+                    return true;
+            }
+        }
+
+        // Gather the alpha range of the cell.
+        TexelRange rangesX[2], rangesY[2];
+        const uint32_t countX = resolveRange(cx * cellSize, (cx + 1) * cellSize - 1, getWidth(), mDesc.addressModeU, rangesX);
+        const uint32_t countY = resolveRange(cy * cellSize, (cy + 1) * cellSize - 1, getHeight(), mDesc.addressModeV, rangesY);
+        if (countX == 0 || countY == 0)
+            return false;
+
+        uint32_t cellMin = 255;
+        uint32_t cellMax = 0;
+        for (uint32_t j = 0; j < countY; j++)
+        {
+            for (int64_t y = rangesY[j].first >> level; y <= rangesY[j].last >> level; y++)
+            {
+                for (uint32_t i = 0; i < countX; i++)
+                {
+                    for (int64_t x = rangesX[i].first >> level; x <= rangesX[i].last >> level; x++)
+                    {
+                        cellMin = std::min<uint32_t>(cellMin, data.minAlpha[(size_t)y * data.width + x]);
+                        cellMax = std::max<uint32_t>(cellMax, data.maxAlpha[(size_t)y * data.width + x]);
+                    }
+                }
+            }
+        }
+
+        // Refine cells that straddle the threshold. Stop as soon as the footprint is known to be mixed.
+        if (level > fineLevel && classifyRange(cellMin, cellMax, threshold) == AlphaCoverage::Unknown)
+        {
+            for (int64_t y = 2 * cy; y <= 2 * cy + 1; y++)
+            {
+                for (int64_t x = 2 * cx; x <= 2 * cx + 1; x++)
+                {
+                    if (!accumulate(p, margin, x, y, level - 1, fineLevel, threshold, minAlpha, maxAlpha))
+                        return false;
+                    if (classifyRange(minAlpha, maxAlpha, threshold) == AlphaCoverage::Unknown)
+                        return true;
+                }
+            }
+            return true;
+        }
+
+        minAlpha = std::min(minAlpha, cellMin);
+        maxAlpha = std::max(maxAlpha, cellMax);
+        return true;
+    }
+}
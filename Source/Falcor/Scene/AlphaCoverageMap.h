@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Sampler.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Alpha coverage of a triangle.
+    */
+    enum class AlphaCoverage : uint8_t
+    {
+        Unknown,        ///< The triangle covers texels on both sides of the alpha threshold. The alpha test is needed.
+        Opaque,         ///< All texels that can be sampled on the triangle pass the alpha test.
+        Transparent,    ///< All texels that can be sampled on the triangle fail the alpha test.
+    };
+
+    /** Conservative min/max pyramid over the alpha channel of a texture.
+
+        Used to classify triangles by the alpha values their UV footprint can sample. The footprint is rasterized
+        conservatively against the pyramid, including the texels reached by bilinear filtering and, optionally, by the
+        box-filtered mips up to a given level. Texture coordinates outside [0,1] are resolved with the sampler address modes.
+
+        The classification assumes basic alpha thresholding, i.e. a hit is discarded if alpha < threshold.
+    */
+    class FALCOR_API AlphaCoverageMap
+    {
+    public:
+        struct Desc
+        {
+            Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap;
+            Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap;
+            uint32_t maxMipLevel = 0;       ///< Highest texture mip level the classification has to be valid for.
+            uint32_t maxCellCount = 1024;   ///< Max number of cells covering the footprint at the finest rasterized level. Larger footprints stop at coarser levels.
+        };
+
+        /** Build the pyramid from 8-bit alpha values.
+            \param[in] width Texture width.
+            \param[in] height Texture height.
+            \param[in] pAlpha Pointer to the alpha value of the first texel. Rows are stored tightly.
+            \param[in] texelStride Number of bytes between the alpha values of consecutive texels, e.g. 4 for RGBA8.
+            \param[in] desc Description.
+        */
+        AlphaCoverageMap(uint32_t width, uint32_t height, const uint8_t* pAlpha, uint32_t texelStride, const Desc& desc);
+
+        uint32_t getWidth() const { return mLevels[0].width; }
+        uint32_t getHeight() const { return mLevels[0].height; }
+        uint32_t getLevelCount() const { return (uint32_t)mLevels.size(); }
+
+        /** Classify a triangle by the alpha values its texture coordinates can sample.
+            \param[in] uv0 Texture coordinate of the first vertex.
+            \param[in] uv1 Texture coordinate of the second vertex.
+            \param[in] uv2 Texture coordinate of the third vertex.
+            \param[in] threshold Alpha threshold of the material.
+            \return Alpha coverage of the triangle.
+        */
+        AlphaCoverage classify(const float2& uv0, const float2& uv1, const float2& uv2, float threshold) const;
+
+    private:
+        struct Level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> minAlpha;
+            std::vector<uint8_t> maxAlpha;
+        };
+
+        struct Point
+        {
+            double x = 0.0;
+            double y = 0.0;
+        };
+
+        bool accumulate(
+            const Point p[3],
+            double margin,
+            int64_t cx,
+            int64_t cy,
+            uint32_t level,
+            uint32_t fineLevel,
+            float threshold,
+            uint32_t& minAlpha,
+            uint32_t& maxAlpha
+        ) const;
+
+        Desc mDesc;
+        std::vector<Level> mLevels;
+    };
+}
@@ -28,7 +28,10 @@
 #include "AnimatedVertexCache.h"
 #include "Animation.h"
 #include "Core/API/RenderContext.h"
+#include "Core/Platform/OS.h"
 #include "Scene/Scene.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Timing/Profiler.h"
 
 namespace Falcor
@@ -94,14 +97,41 @@ namespace Falcor
 
             return InterpolationInfo{ keyframeIndices, t };
         }
+
+        /** Choose the number of keyframe slots per mesh for streaming.
+            Keyframes are mapped to slots modulo the slot count. When the animation wraps around, the last and the first
+            keyframe are interpolated, so they must not map to the same slot.
+        */
+        uint32_t chooseKeyframeSlotCount(uint32_t maxSlotCount, const std::vector<CachedMesh>& cachedMeshes)
+        {
+            auto isValid = [&](uint32_t slotCount)
+            {
+                for (const auto& cache : cachedMeshes)
+                {
+                    uint32_t keyframeCount = (uint32_t)cache.timeSamples.size();
+                    if (keyframeCount > slotCount && (keyframeCount - 1) % slotCount == 0) return false;
+                }
+                return true;
+            };
+
+            for (uint32_t slotCount = maxSlotCount; slotCount >= 2; slotCount--)
+            {
+                if (isValid(slotCount)) return slotCount;
+            }
+            // Fall back to exceeding the budget slightly. Start at two slots if the budget holds fewer.
+            uint32_t slotCount = std::max(maxSlotCount + 1, 2u);
+            while (!isValid(slotCount)) slotCount++;
+            return slotCount;
+        }
     }
 
-    AnimatedVertexCache::AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const VertexCacheStreamingDesc& streamingDesc)
         : mpDevice(pDevice)
         , mpScene(pScene)
         , mpPrevVertexData(pPrevVertexData)
-        , mCachedCurves(cachedCurves)
-        , mCachedMeshes(cachedMeshes)
+        , mCachedCurves(std::move(cachedCurves))
+        , mCachedMeshes(std::move(cachedMeshes))
+        , mStreamingDesc(streamingDesc)
     {
         if (mCachedCurves.empty() && mCachedMeshes.empty()) return;
 
@@ -134,12 +164,20 @@ namespace Falcor
         if (!mCachedMeshes.empty())
         {
             initMeshKeyframes();
-            initMeshBuffers();
+            initMeshKeyframeStreaming();
+            if (isStreaming()) initMeshStreamingBuffers();
+            else initMeshBuffers();
 
             createMeshVertexUpdatePass();
         }
     }
 
+    AnimatedVertexCache::~AnimatedVertexCache()
+    {
+        // Stop the prefetcher before unmapping the store it reads from.
+        mpMeshKeyframePrefetcher.reset();
+    }
+
     bool AnimatedVertexCache::animate(RenderContext* pRenderContext, double time)
     {
         if (!hasAnimations()) return false;
@@ -193,9 +231,27 @@ namespace Falcor
         for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++) m += mpMeshVertexBuffers[i] ? mpMeshVertexBuffers[i]->getSize() : 0;
         m += mpMeshInterpolationBuffer ? mpMeshInterpolationBuffer->getSize() : 0;
         m += mpMeshMetadataBuffer ? mpMeshMetadataBuffer->getSize() : 0;
+        m += mpMeshKeyframePrefetcher ? mpMeshKeyframePrefetcher->getResidentBytes() : 0;
         return m;
     }
 
+    void AnimatedVertexCache::renderUI(Gui::Widgets& widget)
+    {
+        if (!isStreaming()) return;
+
+        const auto& stats = mStreamingStats;
+        uint64_t requested = stats.residentHits + stats.prefetchHits + stats.stalls;
+        double hitRate = requested > 0 ? double(stats.residentHits + stats.prefetchHits) / requested : 1.0;
+
+        std::string text;
+        text += fmt::format("Streamed mesh keyframes: {} ({} on disk)\n", mMeshKeyframeCount, formatByteSize(mpMeshKeyframeStore->getFileSize()));
+        text += fmt::format("Resident keyframes per mesh: {}\n", mMeshKeyframeSlotCount);
+        text += fmt::format("Memory usage: {} (budget {})\n", formatByteSize(getMemoryUsageInBytes()), formatByteSize(mStreamingDesc.memoryBudget));
+        text += fmt::format("Hit rate: {:.1f}% ({} stalls)\n", hitRate * 100.0, stats.stalls);
+        text += fmt::format("Uploaded: {}", formatByteSize(stats.uploadedBytes));
+        widget.text(text);
+    }
+
     // We create a merged list of all timestamps and generate new frames for curves where those timestamps are missing.
     // This can lead to fairly heavy overhead if we have cached curves with vastly different total length.
     // Currently, our assets have cached curves with the same list of timestamps.
@@ -431,7 +487,7 @@ namespace Falcor
         {
             mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, cache.timeSamples.back());
             mMeshKeyframeCount += (uint32_t)cache.timeSamples.size();
-            mMaxMeshVertexCount = std::max((uint32_t)cache.vertexData.front().size(), mMaxMeshVertexCount);
+            mMaxMeshVertexCount = std::max(cache.getVertexCount(), mMaxMeshVertexCount);
         }
     }
 
@@ -442,23 +498,23 @@ namespace Falcor
         meshMetadata.reserve(mCachedMeshes.size());
 
         uint32_t keyframeOffset = 0;
+        std::vector<PackedStaticVertexData> scratch;
         for (auto& cache : mCachedMeshes)
         {
-            FALCOR_ASSERT(cache.vertexData.front().size() == mpScene->getMesh(cache.meshID).vertexCount);
+            FALCOR_ASSERT(cache.getVertexCount() == mpScene->getMesh(cache.meshID).vertexCount);
 
             PerMeshMetadata meta;
             meta.keyframeBufferOffset = keyframeOffset;
-            meta.vertexCount = (uint32_t)cache.vertexData.front().size();
+            meta.vertexCount = cache.getVertexCount();
             meta.sceneVbOffset = mpScene->getMesh(cache.meshID).vbOffset;
             meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
             meshMetadata.push_back(meta);
 
             // Create vertex buffer for each keyframe on this mesh
-            for (size_t i = 0; i < cache.vertexData.size(); i++)
+            for (uint32_t i = 0; i < cache.getKeyframeCount(); i++)
             {
-                auto& data = cache.vertexData[i];
                 size_t index = keyframeOffset + i;
-                mpMeshVertexBuffers[index] = Buffer::createStructured(mpDevice, sizeof(PackedStaticVertexData), (uint32_t)data.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data(), false);
+                mpMeshVertexBuffers[index] = Buffer::createStructured(mpDevice, sizeof(PackedStaticVertexData), meta.vertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, cache.getKeyframe(i, scratch, i > 0), false);
                 mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
             }
 
@@ -473,12 +529,198 @@ namespace Falcor
         mpMeshInterpolationBuffer->setName("AnimatedVertexCache::mpMeshInterpolationbuffer");
     }
 
+    void AnimatedVertexCache::initMeshKeyframeStreaming()
+    {
+        if (!mStreamingDesc.enabled) return;
+
+        uint64_t frameByteSize = 0;
+        uint64_t totalByteSize = 0;
+        uint32_t maxKeyframeCount = 0;
+        for (const auto& cache : mCachedMeshes)
+        {
+            uint64_t byteSize = cache.getVertexCount() * sizeof(PackedStaticVertexData);
+            frameByteSize += byteSize;
+            totalByteSize += byteSize * cache.getKeyframeCount();
+            maxKeyframeCount = std::max(maxKeyframeCount, cache.getKeyframeCount());
+        }
+
+        if (totalByteSize <= mStreamingDesc.memoryBudget)
+        {
+            logInfo("AnimatedVertexCache: All mesh keyframes ({}) fit in the streaming budget, keeping them resident.", formatByteSize(totalByteSize));
+            return;
+        }
+
+        uint64_t maxSlotCount = mStreamingDesc.memoryBudget / frameByteSize;
+        if (maxSlotCount < 2)
+        {
+            logWarning("AnimatedVertexCache: Streaming budget of {} is too small to hold two keyframes ({}).", formatByteSize(mStreamingDesc.memoryBudget), formatByteSize(2 * frameByteSize));
+        }
+        mMeshKeyframeSlotCount = chooseKeyframeSlotCount((uint32_t)std::min<uint64_t>(maxSlotCount, maxKeyframeCount), mCachedMeshes);
+
+        // Stream directly from the store written by the importer if it holds the keyframes of all meshes.
+        // Otherwise move all keyframes into a new on-disk store.
+        std::shared_ptr<const VertexCacheStore> pStore = mCachedMeshes.front().pKeyframeStore;
+        if (!pStore || !std::all_of(mCachedMeshes.begin(), mCachedMeshes.end(), [&](const CachedMesh& cache) { return cache.pKeyframeStore == pStore; }))
+        {
+            std::filesystem::path storePath = mStreamingDesc.storePath;
+            bool deleteOnClose = false;
+            if (storePath.empty())
+            {
+                storePath = getTempFilePath();
+                deleteOnClose = true;
+            }
+
+            {
+                VertexCacheStore::Writer writer(storePath, mStreamingDesc.deltaCompression);
+                std::vector<PackedStaticVertexData> scratch;
+                for (auto& cache : mCachedMeshes)
+                {
+                    uint32_t stream = writer.addStream(cache.getVertexCount() * sizeof(PackedStaticVertexData));
+                    for (uint32_t i = 0; i < cache.getKeyframeCount(); i++) writer.addKeyframe(stream, cache.getKeyframe(i, scratch, i > 0));
+                    cache.keyframeStream = stream;
+
+                    // The keyframes now live in the store, release the host copy.
+                    cache.vertexData.clear();
+                    cache.vertexData.shrink_to_fit();
+                }
+                writer.finalize();
+            }
+
+            pStore = std::make_shared<const VertexCacheStore>(storePath, deleteOnClose);
+            for (auto& cache : mCachedMeshes) cache.pKeyframeStore = pStore;
+        }
+
+        mpMeshKeyframeStore = pStore;
+        mpMeshKeyframePrefetcher = std::make_unique<VertexCachePrefetcher>(*mpMeshKeyframeStore);
+
+        logInfo("AnimatedVertexCache: Streaming {} mesh keyframes ({}, {} on disk) with {} resident keyframes per mesh.",
+            mMeshKeyframeCount, formatByteSize(totalByteSize), formatByteSize(mpMeshKeyframeStore->getFileSize()), mMeshKeyframeSlotCount);
+    }
+
+    void AnimatedVertexCache::initMeshStreamingBuffers()
+    {
+        FALCOR_ASSERT(mMeshKeyframeSlotCount >= 2);
+
+        mpMeshVertexBuffers.resize(mCachedMeshes.size() * mMeshKeyframeSlotCount);
+        mMeshSlotKeyframes.assign(mCachedMeshes.size(), std::vector<uint32_t>(mMeshKeyframeSlotCount, std::numeric_limits<uint32_t>::max()));
+        std::vector<PerMeshMetadata> meshMetadata;
+        meshMetadata.reserve(mCachedMeshes.size());
+
+        std::vector<PackedStaticVertexData> scratch;
+        for (uint32_t meshIndex = 0; meshIndex < (uint32_t)mCachedMeshes.size(); meshIndex++)
+        {
+            const auto& cache = mCachedMeshes[meshIndex];
+            FALCOR_ASSERT(cache.getVertexCount() == mpScene->getMesh(cache.meshID).vertexCount);
+
+            PerMeshMetadata meta;
+            meta.keyframeBufferOffset = meshIndex * mMeshKeyframeSlotCount;
+            meta.vertexCount = cache.getVertexCount();
+            meta.sceneVbOffset = mpScene->getMesh(cache.meshID).vbOffset;
+            meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
+            meshMetadata.push_back(meta);
+
+            // Create the keyframe slots and fill them with the first keyframes.
+            for (uint32_t slot = 0; slot < mMeshKeyframeSlotCount; slot++)
+            {
+                const void* pInitData = nullptr;
+                if (slot < cache.getKeyframeCount())
+                {
+                    pInitData = cache.getKeyframe(slot, scratch, slot > 0);
+                    mMeshSlotKeyframes[meshIndex][slot] = slot;
+                }
+
+                size_t index = meta.keyframeBufferOffset + slot;
+                mpMeshVertexBuffers[index] = Buffer::createStructured(mpDevice, sizeof(PackedStaticVertexData), meta.vertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, pInitData, false);
+                mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
+            }
+        }
+
+        mpMeshMetadataBuffer = Buffer::createStructured(mpDevice, sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
+        mpMeshMetadataBuffer->setName("AnimatedVertexCache::mpMeshMetadataBuffer");
+
+        mMeshInterpolationInfo.resize(mCachedMeshes.size());
+        mpMeshInterpolationBuffer = Buffer::createStructured(mpDevice, sizeof(InterpolationInfo), (uint32_t)mMeshInterpolationInfo.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+        mpMeshInterpolationBuffer->setName("AnimatedVertexCache::mpMeshInterpolationbuffer");
+    }
+
+    void AnimatedVertexCache::updateMeshKeyframeResidency()
+    {
+        FALCOR_ASSERT(mpMeshKeyframePrefetcher);
+
+        const uint32_t slotCount = mMeshKeyframeSlotCount;
+        std::vector<VertexCachePrefetcher::Key> requests;
+        std::vector<uint32_t> requestMeshIndices;
+        std::vector<uint8_t> data;
+
+        for (uint32_t meshIndex = 0; meshIndex < (uint32_t)mCachedMeshes.size(); meshIndex++)
+        {
+            auto& info = mMeshInterpolationInfo[meshIndex];
+            const auto& slots = mMeshSlotKeyframes[meshIndex];
+            const uint32_t stream = mCachedMeshes[meshIndex].keyframeStream;
+            const uint32_t keyframeCount = (uint32_t)mCachedMeshes[meshIndex].timeSamples.size();
+            const uint32_t slotA = info.keyframeIndices.x % slotCount;
+            const uint32_t slotB = info.keyframeIndices.y % slotCount;
+
+            // The keyframes used for interpolation must be resident, decode them synchronously if the prefetcher did not get to them.
+            for (uint32_t keyframe : { info.keyframeIndices.x, info.keyframeIndices.y })
+            {
+                if (slots[keyframe % slotCount] == keyframe)
+                {
+                    mStreamingStats.residentHits++;
+                    continue;
+                }
+                if (mpMeshKeyframePrefetcher->fetch({ stream, keyframe }, data, true)) mStreamingStats.prefetchHits++;
+                else mStreamingStats.stalls++;
+                uploadMeshKeyframe(meshIndex, keyframe, data);
+            }
+
+            // Request the keyframes following the current window for prefetching.
+            uint32_t keyframe = info.keyframeIndices.y;
+            for (uint32_t i = 0; i + 2 < slotCount; i++)
+            {
+                if (++keyframe == keyframeCount)
+                {
+                    if (!mLoopAnimations) break;
+                    keyframe = 0;
+                }
+                uint32_t slot = keyframe % slotCount;
+                if (slot == slotA || slot == slotB) break;
+                if (slots[slot] != keyframe)
+                {
+                    requests.push_back({ stream, keyframe });
+                    requestMeshIndices.push_back(meshIndex);
+                }
+            }
+
+            info.keyframeIndices = uint2(slotA, slotB);
+        }
+
+        mpMeshKeyframePrefetcher->setRequests(requests);
+
+        // Upload the keyframes that have already been decoded so they are resident before they are needed.
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            if (mpMeshKeyframePrefetcher->fetch(requests[i], data, false)) uploadMeshKeyframe(requestMeshIndices[i], requests[i].keyframe, data);
+        }
+    }
+
+    void AnimatedVertexCache::uploadMeshKeyframe(uint32_t meshIndex, uint32_t keyframe, const std::vector<uint8_t>& data)
+    {
+        uint32_t slot = keyframe % mMeshKeyframeSlotCount;
+        const auto& pBuffer = mpMeshVertexBuffers[meshIndex * mMeshKeyframeSlotCount + slot];
+        FALCOR_ASSERT(data.size() == pBuffer->getSize());
+
+        pBuffer->setBlob(data.data(), 0, data.size());
+        mMeshSlotKeyframes[meshIndex][slot] = keyframe;
+        mStreamingStats.uploadedBytes += data.size();
+    }
+
     void AnimatedVertexCache::createMeshVertexUpdatePass()
     {
         FALCOR_ASSERT(!mCachedMeshes.empty());
 
         DefineList defines;
-        defines.add("MESH_KEYFRAME_COUNT", std::to_string(mMeshKeyframeCount));
+        defines.add("MESH_KEYFRAME_COUNT", std::to_string(mpMeshVertexBuffers.size()));
         mpMeshVertexUpdatePass = ComputePass::create(mpDevice, "Scene/Animation/UpdateMeshVertices.slang", "main", defines);
 
         // Bind data
@@ -548,6 +790,19 @@ namespace Falcor
             mMeshInterpolationInfo[i] = calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
         }
 
+        if (isStreaming())
+        {
+            // When copying the previous positions the keyframes are not accessed, so only remap them to valid slots.
+            if (copyPrev)
+            {
+                for (auto& info : mMeshInterpolationInfo) info.keyframeIndices = uint2(0);
+            }
+            else
+            {
+                updateMeshKeyframeResidency();
+            }
+        }
+
         mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
 
         auto block = mpMeshVertexUpdatePass->getRootVar()["gMeshVertexUpdater"];
@@ -28,15 +28,19 @@
 #pragma once
 #include "Animation.h"
 #include "SharedTypes.slang"
+#include "VertexCacheStore.h"
 #include "Core/API/Buffer.h"
 #include "Core/Pass/ComputePass.h"
 #include "Scene/Curves/CurveConfig.h"
 #include "Scene/SceneTypes.slang"
 #include "Scene/SceneIDs.h"
 #include "Utils/Sampling/SampleGenerator.h"
+#include "Utils/UI/Gui.h"
 
 #include <algorithm>
+#include <filesystem>
 #include <limits>
+#include <memory>
 #include <vector>
 
 namespace Falcor
@@ -67,14 +71,58 @@ namespace Falcor
         std::vector<double> timeSamples;
 
         // vertexData[i][j] represents at the i-th keyframe, the cache data of the j-th vertex.
+        // Empty if the keyframes are held in pKeyframeStore instead.
         std::vector<std::vector<PackedStaticVertexData>> vertexData;
+
+        std::shared_ptr<const VertexCacheStore> pKeyframeStore; ///< On-disk store holding the keyframes, or nullptr if they are in vertexData.
+        uint32_t keyframeStream = 0;                            ///< Stream of this mesh in pKeyframeStore.
+
+        uint32_t getKeyframeCount() const
+        {
+            return pKeyframeStore ? pKeyframeStore->getKeyframeCount(keyframeStream) : (uint32_t)vertexData.size();
+        }
+
+        uint32_t getVertexCount() const
+        {
+            if (pKeyframeStore) return (uint32_t)(pKeyframeStore->getFrameByteSize(keyframeStream) / sizeof(PackedStaticVertexData));
+            return vertexData.empty() ? 0 : (uint32_t)vertexData.front().size();
+        }
+
+        /** Get the vertex data of a keyframe. Keyframes held in the store are decoded into a scratch buffer.
+            \param[in] keyframe Keyframe index.
+            \param[in,out] scratch Scratch buffer for decoding.
+            \param[in] scratchHoldsPrev True if scratch holds the decoded preceding keyframe, which speeds up decoding of delta-compressed keyframes.
+            \return Pointer to getVertexCount() vertices, valid until the next call with the same scratch buffer.
+        */
+        const PackedStaticVertexData* getKeyframe(uint32_t keyframe, std::vector<PackedStaticVertexData>& scratch, bool scratchHoldsPrev = false) const
+        {
+            if (!pKeyframeStore) return vertexData[keyframe].data();
+
+            const bool hasPrev = scratchHoldsPrev && scratch.size() == getVertexCount();
+            scratch.resize(getVertexCount());
+            pKeyframeStore->readKeyframe(keyframeStream, keyframe, scratch.data(), hasPrev ? scratch.data() : nullptr);
+            return scratch.data();
+        }
+    };
+
+    /** Settings for streaming cached mesh keyframes from disk.
+        When enabled, the keyframes of all cached meshes are moved into an on-disk VertexCacheStore and only a window of keyframes
+        around the current time is kept resident on the GPU. A background thread decodes the upcoming keyframes of the window.
+        Importers that support it write the keyframes to a store while decoding them, so they are never all held in host memory.
+    */
+    struct VertexCacheStreamingDesc
+    {
+        bool enabled = false;                   ///< Enable keyframe streaming.
+        uint64_t memoryBudget = 512ull << 20;   ///< GPU memory budget in bytes for resident mesh keyframes. At least two keyframes per mesh are always resident.
+        bool deltaCompression = true;           ///< Delta-compress keyframes against the previous keyframe in the on-disk store.
+        std::filesystem::path storePath;        ///< Path of the on-disk store. If empty, a temporary file is used and deleted on exit.
     };
 
     class FALCOR_API AnimatedVertexCache
     {
     public:
-        AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
-        ~AnimatedVertexCache() = default;
+        AnimatedVertexCache(ref<Device> pDevice, Scene* pScene, const ref<Buffer>& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const VertexCacheStreamingDesc& streamingDesc = {});
+        ~AnimatedVertexCache();
 
         void setIsLooped(bool looped) { mLoopAnimations = looped; }
 
@@ -96,9 +144,25 @@ namespace Falcor
 
         ref<Buffer> getPrevCurveVertexData() const { return mpPrevCurveVertexBuffer; }
 
+        /** Get the memory usage in bytes. This includes the GPU buffers and, when streaming, the host memory of prefetched keyframes.
+        */
         uint64_t getMemoryUsageInBytes() const;
 
+        /** Returns true if mesh keyframes are streamed from disk.
+        */
+        bool isStreaming() const { return mpMeshKeyframeStore != nullptr; }
+
+        void renderUI(Gui::Widgets& widget);
+
     private:
+        struct StreamingStats
+        {
+            uint64_t residentHits = 0;      ///< Keyframes that were already resident on the GPU when needed.
+            uint64_t prefetchHits = 0;      ///< Keyframes that were decoded by the prefetcher before they were needed.
+            uint64_t stalls = 0;            ///< Keyframes that had to be decoded synchronously.
+            uint64_t uploadedBytes = 0;     ///< Total bytes uploaded to keyframe slots.
+        };
+
         void initCurveKeyframes();
         void bindCurveLSSBuffers();
         void bindCurvePolyTubeBuffers();
@@ -109,6 +173,13 @@ namespace Falcor
 
         void initMeshKeyframes();
         void initMeshBuffers();
+        void initMeshKeyframeStreaming();
+        void initMeshStreamingBuffers();
+
+        /** Make sure the keyframes referenced by mMeshInterpolationInfo are resident, remap them to keyframe slots and queue prefetching of the following keyframes.
+        */
+        void updateMeshKeyframeResidency();
+        void uploadMeshKeyframe(uint32_t meshIndex, uint32_t keyframe, const std::vector<uint8_t>& data);
 
         void createMeshVertexUpdatePass();
 
@@ -174,5 +245,13 @@ namespace Falcor
         std::vector<ref<Buffer>> mpMeshVertexBuffers;
         ref<Buffer> mpMeshInterpolationBuffer;
         ref<Buffer> mpMeshMetadataBuffer;
+
+        // Streamed mesh keyframes
+        VertexCacheStreamingDesc mStreamingDesc;
+        std::shared_ptr<const VertexCacheStore> mpMeshKeyframeStore;  ///< Store holding the keyframes of all cached meshes, shared with mCachedMeshes.
+        std::unique_ptr<VertexCachePrefetcher> mpMeshKeyframePrefetcher;
+        uint32_t mMeshKeyframeSlotCount = 0; ///< Number of resident keyframe slots per mesh. Keyframe k lives in slot k % mMeshKeyframeSlotCount.
+        std::vector<std::vector<uint32_t>> mMeshSlotKeyframes; ///< Keyframe currently held by each slot, per mesh.
+        StreamingStats mStreamingStats;
     };
 }
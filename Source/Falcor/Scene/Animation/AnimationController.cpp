@@ -92,7 +92,7 @@ namespace Falcor
         }
     }
 
-    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData)
+    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData, const VertexCacheStreamingDesc& streamingDesc)
     {
         size_t totalAnimatedMeshVertexCount = 0;
 
@@ -117,7 +117,7 @@ namespace Falcor
             for (auto& cache : cachedMeshes)
             {
                 uint32_t offset = mpScene->getMesh(cache.meshID).vbOffset;
-                for (size_t i = 0; i < cache.vertexData.front().size(); i++)
+                for (size_t i = 0; i < cache.getVertexCount(); i++)
                 {
                     prevVertexData.push_back({ staticVertexData[offset + i].position });
                 }
@@ -156,7 +156,7 @@ namespace Falcor
             mpPrevVertexData->setBlob(prevVertexData.data(), byteOffset, prevVertexData.size() * sizeof(PrevVertexData));
         }
 
-        mpVertexCache = std::make_unique<AnimatedVertexCache>(mpDevice, mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes));
+        mpVertexCache = std::make_unique<AnimatedVertexCache>(mpDevice, mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), streamingDesc);
 
         // Note: It is a workaround to have two pre-infinity behaviors for the cached animation.
         // We need `Cycle` behavior when the length of cached animation is smaller than the length of mesh animation (e.g., tiger forest).
@@ -477,6 +477,14 @@ namespace Falcor
         }
         widget.tooltip("Enable/disable global animation looping.");
 
+        if (mpVertexCache && mpVertexCache->isStreaming())
+        {
+            if (auto streamingGroup = widget.group("Vertex Cache Streaming"))
+            {
+                mpVertexCache->renderUI(streamingGroup);
+            }
+        }
+
         for (auto& animation : mAnimations)
         {
             if (auto animGroup = widget.group(animation->getName()))
@@ -0,0 +1,433 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheStore.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/StringFormatters.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x53435646; // 'FVCS'
+        const uint32_t kVersion = 1;
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t streamCount;
+            uint32_t reserved;
+            uint64_t indexOffset;
+        };
+
+        struct StreamHeader
+        {
+            uint64_t frameByteSize;
+            uint32_t keyframeCount;
+            uint32_t reserved;
+        };
+
+        struct ChunkHeader
+        {
+            uint64_t offset;
+            uint64_t size;
+            uint32_t delta;
+            uint32_t reserved;
+        };
+
+        /** Delta encode a frame against the previous frame.
+            The encoding is a sequence of runs, each consisting of a count of unchanged 32-bit words,
+            a count of changed words, followed by the changed words XOR'ed with the previous frame.
+        */
+        void encodeDelta(const uint32_t* pCur, const uint32_t* pPrev, size_t wordCount, std::vector<uint8_t>& out)
+        {
+            out.clear();
+            auto append = [&out](uint32_t v)
+            {
+                size_t offset = out.size();
+                out.resize(offset + sizeof(uint32_t));
+                std::memcpy(out.data() + offset, &v, sizeof(uint32_t));
+            };
+
+            size_t i = 0;
+            while (i < wordCount)
+            {
+                uint32_t sameCount = 0;
+                while (i < wordCount && pCur[i] == pPrev[i]) { ++i; ++sameCount; }
+
+                size_t literalStart = i;
+                while (i < wordCount && pCur[i] != pPrev[i]) ++i;
+                uint32_t literalCount = uint32_t(i - literalStart);
+
+                append(sameCount);
+                append(literalCount);
+                for (size_t j = literalStart; j < i; ++j) append(pCur[j] ^ pPrev[j]);
+            }
+        }
+
+        void applyDelta(const uint8_t* pSrc, size_t srcSize, uint32_t* pDst, size_t wordCount)
+        {
+            size_t pos = 0;
+            size_t word = 0;
+            auto read = [&]()
+            {
+                if (pos + sizeof(uint32_t) > srcSize) throw RuntimeError("Vertex cache store: Corrupt delta chunk.");
+                uint32_t v;
+                std::memcpy(&v, pSrc + pos, sizeof(uint32_t));
+                pos += sizeof(uint32_t);
+                return v;
+            };
+
+            while (pos < srcSize)
+            {
+                word += read();
+                uint32_t literalCount = read();
+                if (word + literalCount > wordCount) throw RuntimeError("Vertex cache store: Corrupt delta chunk.");
+                for (uint32_t j = 0; j < literalCount; ++j) pDst[word++] ^= read();
+            }
+        }
+    }
+
+    VertexCacheStore::Writer::Writer(const std::filesystem::path& path, bool deltaCompression)
+        : mDeltaCompression(deltaCompression)
+    {
+        mStream.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!mStream) throw RuntimeError("Failed to create vertex cache store '{}'.", path);
+
+        // Reserve space for the header, it is written in finalize().
+        FileHeader header = {};
+        mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        mOffset = sizeof(header);
+    }
+
+    VertexCacheStore::Writer::~Writer()
+    {
+        if (!mFinalized && mStream.is_open()) finalize();
+    }
+
+    uint32_t VertexCacheStore::Writer::addStream(size_t frameByteSize)
+    {
+        checkArgument(frameByteSize > 0 && frameByteSize % sizeof(uint32_t) == 0, "'frameByteSize' ({}) must be a non-zero multiple of 4.", frameByteSize);
+        FALCOR_ASSERT(!mFinalized);
+
+        StreamState state;
+        state.frameByteSize = frameByteSize;
+        mStreams.push_back(std::move(state));
+        return (uint32_t)mStreams.size() - 1;
+    }
+
+    void VertexCacheStore::Writer::addKeyframe(uint32_t stream, const void* pData)
+    {
+        FALCOR_ASSERT(stream < mStreams.size() && !mFinalized);
+        auto& state = mStreams[stream];
+
+        Chunk chunk;
+        chunk.offset = mOffset;
+
+        const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(pData);
+        const uint8_t* pEncoded = pBytes;
+        size_t encodedSize = state.frameByteSize;
+
+        bool allowDelta = mDeltaCompression && !state.chunks.empty() && (state.chunks.size() % kRawChunkInterval) != 0;
+        if (allowDelta)
+        {
+            size_t wordCount = state.frameByteSize / sizeof(uint32_t);
+            encodeDelta(reinterpret_cast<const uint32_t*>(pBytes), reinterpret_cast<const uint32_t*>(state.prevFrame.data()), wordCount, mScratch);
+
+            // Only keep the delta if it actually saves space.
+            if (mScratch.size() < state.frameByteSize)
+            {
+                pEncoded = mScratch.data();
+                encodedSize = mScratch.size();
+                chunk.delta = true;
+            }
+        }
+
+        chunk.size = encodedSize;
+        mStream.write(reinterpret_cast<const char*>(pEncoded), encodedSize);
+        if (!mStream) throw RuntimeError("Failed to write vertex cache store chunk.");
+        mOffset += encodedSize;
+
+        state.chunks.push_back(chunk);
+        if (mDeltaCompression) state.prevFrame.assign(pBytes, pBytes + state.frameByteSize);
+    }
+
+    void VertexCacheStore::Writer::finalize()
+    {
+        FALCOR_ASSERT(!mFinalized);
+
+        FileHeader header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.streamCount = (uint32_t)mStreams.size();
+        header.indexOffset = mOffset;
+
+        for (const auto& state : mStreams)
+        {
+            StreamHeader streamHeader = {};
+            streamHeader.frameByteSize = state.frameByteSize;
+            streamHeader.keyframeCount = (uint32_t)state.chunks.size();
+            mStream.write(reinterpret_cast<const char*>(&streamHeader), sizeof(streamHeader));
+
+            for (const auto& chunk : state.chunks)
+            {
+                ChunkHeader chunkHeader = {};
+                chunkHeader.offset = chunk.offset;
+                chunkHeader.size = chunk.size;
+                chunkHeader.delta = chunk.delta ? 1 : 0;
+                mStream.write(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
+            }
+        }
+
+        mStream.seekp(0);
+        mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        mStream.close();
+        mStreams.clear();
+        mFinalized = true;
+    }
+
+    VertexCacheStore::VertexCacheStore(const std::filesystem::path& path, bool deleteOnClose)
+        : mPath(path)
+        , mDeleteOnClose(deleteOnClose)
+    {
+        if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        {
+            throw RuntimeError("Failed to open vertex cache store '{}'.", path);
+        }
+
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(mFile.getData());
+        const size_t fileSize = mFile.getMappedSize();
+
+        size_t pos = 0;
+        auto read = [&](void* pDst, size_t size)
+        {
+            if (pos + size > fileSize) throw RuntimeError("Vertex cache store '{}' is truncated.", path);
+            std::memcpy(pDst, pData + pos, size);
+            pos += size;
+        };
+
+        FileHeader header;
+        read(&header, sizeof(header));
+        if (header.magic != kMagic || header.version != kVersion)
+        {
+            throw RuntimeError("Vertex cache store '{}' has an invalid header.", path);
+        }
+
+        pos = header.indexOffset;
+        mStreams.resize(header.streamCount);
+        for (auto& stream : mStreams)
+        {
+            StreamHeader streamHeader;
+            read(&streamHeader, sizeof(streamHeader));
+            stream.frameByteSize = streamHeader.frameByteSize;
+            stream.chunks.resize(streamHeader.keyframeCount);
+            for (auto& chunk : stream.chunks)
+            {
+                ChunkHeader chunkHeader;
+                read(&chunkHeader, sizeof(chunkHeader));
+                if (chunkHeader.offset + chunkHeader.size > header.indexOffset)
+                {
+                    throw RuntimeError("Vertex cache store '{}' has an invalid chunk index.", path);
+                }
+                chunk.offset = chunkHeader.offset;
+                chunk.size = chunkHeader.size;
+                chunk.delta = chunkHeader.delta != 0;
+            }
+        }
+    }
+
+    VertexCacheStore::~VertexCacheStore()
+    {
+        // The file has to be unmapped before it can be deleted.
+        mFile.close();
+        if (mDeleteOnClose)
+        {
+            std::error_code ec;
+            std::filesystem::remove(mPath, ec);
+        }
+    }
+
+    void VertexCacheStore::readKeyframe(uint32_t stream, uint32_t keyframe, void* pDst, const void* pPrev) const
+    {
+        FALCOR_ASSERT(stream < mStreams.size());
+        const auto& desc = mStreams[stream];
+        FALCOR_ASSERT(keyframe < desc.chunks.size());
+
+        const Chunk& chunk = desc.chunks[keyframe];
+        if (!chunk.delta)
+        {
+            decodeChunk(chunk, desc.frameByteSize, pDst);
+            return;
+        }
+
+        if (pPrev)
+        {
+            if (pPrev != pDst) std::memcpy(pDst, pPrev, desc.frameByteSize);
+            decodeChunk(chunk, desc.frameByteSize, pDst);
+            return;
+        }
+
+        // Restart from the closest raw chunk and apply all deltas up to the requested keyframe.
+        uint32_t first = keyframe;
+        while (desc.chunks[first].delta)
+        {
+            FALCOR_ASSERT(first > 0);
+            --first;
+        }
+        for (uint32_t i = first; i <= keyframe; ++i) decodeChunk(desc.chunks[i], desc.frameByteSize, pDst);
+    }
+
+    void VertexCacheStore::decodeChunk(const Chunk& chunk, size_t frameByteSize, void* pDst) const
+    {
+        const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(mFile.getData()) + chunk.offset;
+        if (chunk.delta)
+        {
+            applyDelta(pSrc, chunk.size, reinterpret_cast<uint32_t*>(pDst), frameByteSize / sizeof(uint32_t));
+        }
+        else
+        {
+            FALCOR_ASSERT(chunk.size == frameByteSize);
+            std::memcpy(pDst, pSrc, frameByteSize);
+        }
+    }
+
+    VertexCachePrefetcher::VertexCachePrefetcher(const VertexCacheStore& store)
+        : mStore(store)
+        , mLastDecoded(store.getStreamCount(), { std::numeric_limits<uint32_t>::max(), {} })
+    {
+        mThread = std::thread(&VertexCachePrefetcher::workerMain, this);
+    }
+
+    VertexCachePrefetcher::~VertexCachePrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+
+    void VertexCachePrefetcher::setRequests(const std::vector<Key>& requests)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRequested = std::set<Key>(requests.begin(), requests.end());
+
+            // Evict decoded keyframes that are no longer needed.
+            for (auto it = mReady.begin(); it != mReady.end();)
+            {
+                if (mRequested.count(it->first) == 0)
+                {
+                    mReadyBytes -= it->second.size();
+                    it = mReady.erase(it);
+                }
+                else ++it;
+            }
+
+            mPending.clear();
+            for (const auto& key : requests)
+            {
+                if (mReady.count(key) == 0) mPending.push_back(key);
+            }
+        }
+        mCondition.notify_one();
+    }
+
+    bool VertexCachePrefetcher::fetch(const Key& key, std::vector<uint8_t>& data, bool wait)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mReady.find(key);
+            if (it != mReady.end())
+            {
+                data = std::move(it->second);
+                mReadyBytes -= data.size();
+                mReady.erase(it);
+                return true;
+            }
+
+            if (!wait) return false;
+
+            // The keyframe is decoded below, so drop it from the queue.
+            mPending.erase(std::remove(mPending.begin(), mPending.end(), key), mPending.end());
+            mRequested.erase(key);
+        }
+
+        data.resize(mStore.getFrameByteSize(key.stream));
+        mStore.readKeyframe(key.stream, key.keyframe, data.data());
+        return false;
+    }
+
+    size_t VertexCachePrefetcher::getResidentBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mReadyBytes;
+    }
+
+    void VertexCachePrefetcher::workerMain()
+    {
+        while (true)
+        {
+            Key key;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mTerminate || !mPending.empty(); });
+                if (mTerminate) return;
+                key = mPending.front();
+                mPending.pop_front();
+                if (mReady.count(key) > 0) continue;
+            }
+
+            // Decode outside the lock. Reuse the previously decoded keyframe of the stream when possible,
+            // which turns sequential playback of delta-encoded streams into a single delta application.
+            auto& last = mLastDecoded[key.stream];
+            std::vector<uint8_t> data(mStore.getFrameByteSize(key.stream));
+            bool sequential = last.first != std::numeric_limits<uint32_t>::max() && last.first + 1 == key.keyframe;
+            const void* pPrev = sequential ? last.second.data() : nullptr;
+            mStore.readKeyframe(key.stream, key.keyframe, data.data(), pPrev);
+            last.first = key.keyframe;
+            last.second = data;
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                // Only publish the keyframe if it is still wanted. It may have been dropped by setRequests() or fetched synchronously.
+                if (mRequested.count(key) > 0 && mReady.count(key) == 0)
+                {
+                    mReadyBytes += data.size();
+                    mReady.emplace(key, std::move(data));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,208 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Falcor
+{
+    /** On-disk store for vertex animation keyframes.
+
+        The store holds a number of streams (typically one per animated mesh). Each stream is a
+        sequence of keyframes of identical byte size. Every keyframe is stored as its own chunk,
+        either raw or delta-compressed against the previous keyframe of the same stream.
+        A raw chunk is forced every kRawChunkInterval keyframes to bound the cost of random access.
+
+        The file is read through a memory mapping, so only the chunks that are actually decoded
+        are paged in.
+    */
+    class FALCOR_API VertexCacheStore
+    {
+        struct Chunk
+        {
+            uint64_t offset = 0; ///< Byte offset of the encoded chunk in the file.
+            uint64_t size = 0;   ///< Encoded size in bytes.
+            bool delta = false;  ///< True if the chunk is delta encoded against the previous keyframe.
+        };
+
+    public:
+        static constexpr uint32_t kRawChunkInterval = 16;
+
+        /** Writes a new store file.
+            Keyframes of a stream must be added in order, but streams can be interleaved.
+        */
+        class FALCOR_API Writer
+        {
+        public:
+            /** Create a new store file. Throws an exception if the file cannot be created.
+                \param[in] path File path.
+                \param[in] deltaCompression Encode keyframes as delta against the previous keyframe of the stream.
+            */
+            Writer(const std::filesystem::path& path, bool deltaCompression);
+            ~Writer();
+
+            /** Add a new stream.
+                \param[in] frameByteSize Size of each keyframe in bytes. Must be a multiple of 4.
+                \return Stream index.
+            */
+            uint32_t addStream(size_t frameByteSize);
+
+            /** Append the next keyframe to a stream.
+                \param[in] stream Stream index.
+                \param[in] pData Keyframe data of frameByteSize bytes.
+            */
+            void addKeyframe(uint32_t stream, const void* pData);
+
+            /** Write the chunk index and close the file.
+            */
+            void finalize();
+
+        private:
+            struct StreamState
+            {
+                size_t frameByteSize = 0;
+                std::vector<uint8_t> prevFrame;
+                std::vector<Chunk> chunks;
+            };
+
+            std::ofstream mStream;
+            bool mDeltaCompression;
+            bool mFinalized = false;
+            uint64_t mOffset = 0;
+            std::vector<StreamState> mStreams;
+            std::vector<uint8_t> mScratch;
+        };
+
+        /** Open an existing store file. Throws an exception if the file is invalid.
+            \param[in] path File path.
+            \param[in] deleteOnClose Delete the file when the store is destroyed. Use this for temporary stores.
+        */
+        VertexCacheStore(const std::filesystem::path& path, bool deleteOnClose = false);
+        ~VertexCacheStore();
+
+        uint32_t getStreamCount() const { return (uint32_t)mStreams.size(); }
+        uint32_t getKeyframeCount(uint32_t stream) const { return (uint32_t)mStreams[stream].chunks.size(); }
+        size_t getFrameByteSize(uint32_t stream) const { return mStreams[stream].frameByteSize; }
+
+        /** Get the size of the store file in bytes.
+        */
+        size_t getFileSize() const { return mFile.getSize(); }
+
+        /** Decode a keyframe.
+            \param[in] stream Stream index.
+            \param[in] keyframe Keyframe index.
+            \param[out] pDst Destination of frameByteSize bytes.
+            \param[in] pPrev Decoded data of the preceding keyframe if available, or nullptr.
+                       If the chunk is delta encoded and pPrev is nullptr, decoding restarts from the closest raw chunk.
+        */
+        void readKeyframe(uint32_t stream, uint32_t keyframe, void* pDst, const void* pPrev = nullptr) const;
+
+    private:
+        struct StreamDesc
+        {
+            size_t frameByteSize = 0;
+            std::vector<Chunk> chunks;
+        };
+
+        void decodeChunk(const Chunk& chunk, size_t frameByteSize, void* pDst) const;
+
+        std::filesystem::path mPath;
+        bool mDeleteOnClose = false;
+        MemoryMappedFile mFile;
+        std::vector<StreamDesc> mStreams;
+    };
+
+    /** Asynchronous keyframe decoder for a VertexCacheStore.
+
+        The owner submits the list of keyframes it expects to need soon with setRequests().
+        A worker thread decodes them in order into host memory, where they can be picked up with fetch().
+        Decoded keyframes that are no longer requested are evicted, so host memory stays bounded by the request window.
+    */
+    class FALCOR_API VertexCachePrefetcher
+    {
+    public:
+        struct Key
+        {
+            uint32_t stream;
+            uint32_t keyframe;
+            bool operator<(const Key& other) const { return stream != other.stream ? stream < other.stream : keyframe < other.keyframe; }
+            bool operator==(const Key& other) const { return stream == other.stream && keyframe == other.keyframe; }
+        };
+
+        VertexCachePrefetcher(const VertexCacheStore& store);
+        ~VertexCachePrefetcher();
+
+        /** Replace the set of keyframes to prefetch. Pending requests not in the list are dropped, and so are decoded
+            keyframes that have not been fetched yet.
+        */
+        void setRequests(const std::vector<Key>& requests);
+
+        /** Fetch a decoded keyframe.
+            \param[in] key Keyframe to fetch.
+            \param[out] data Decoded keyframe data.
+            \param[in] wait If the keyframe is not ready, decode it synchronously on the calling thread.
+            \return True if the keyframe was already decoded by the prefetcher. If false, data is only valid if wait was set.
+        */
+        bool fetch(const Key& key, std::vector<uint8_t>& data, bool wait);
+
+        /** Get the number of bytes currently held by decoded keyframes.
+        */
+        size_t getResidentBytes() const;
+
+    private:
+        void workerMain();
+
+        const VertexCacheStore& mStore;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::deque<Key> mPending;
+        std::set<Key> mRequested;
+        std::map<Key, std::vector<uint8_t>> mReady;
+        size_t mReadyBytes = 0;
+        bool mTerminate = false;
+
+        /// Last keyframe decoded by the worker per stream. Allows sequential delta decoding without restarting from a raw chunk.
+        std::vector<std::pair<uint32_t, std::vector<uint8_t>>> mLastDecoded;
+
+        std::thread mThread;
+    };
+}
@@ -30,7 +30,7 @@
 
 namespace Falcor
 {
-    std::unique_ptr<Importer> Importer::create(std::string_view extension, const PluginManager& pm)
+    std::unique_ptr<Importer> Importer::create(std::string_view extension, PluginManager& pm)
     {
         for (const auto& [type, info] : pm.getInfos<Importer>())
             if (std::find(info.extensions.begin(), info.extensions.end(), extension) != info.extensions.end())
@@ -38,7 +38,7 @@ namespace Falcor
         return nullptr;
     }
 
-    std::vector<std::string> Importer::getSupportedExtensions(const PluginManager& pm)
+    std::vector<std::string> Importer::getSupportedExtensions(PluginManager& pm)
     {
         std::vector<std::string> extensions;
         for (const auto& [type, info] : pm.getInfos<Importer>())
@@ -122,10 +122,10 @@ namespace Falcor
             \param pm Plugin manager.
             \return Returns an instance of the importer or nullptr if no compatible importer was found.
          */
-        static std::unique_ptr<Importer> create(std::string_view extension, const PluginManager& pm = PluginManager::instance());
+        static std::unique_ptr<Importer> create(std::string_view extension, PluginManager& pm = PluginManager::instance());
 
         /** Return a list of supported file extensions by the current set of loaded importer plugins.
         */
-        static std::vector<std::string> getSupportedExtensions(const PluginManager& pm = PluginManager::instance());
+        static std::vector<std::string> getSupportedExtensions(PluginManager& pm = PluginManager::instance());
     };
 }
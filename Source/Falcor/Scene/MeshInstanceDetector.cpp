@@ -0,0 +1,454 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshInstanceDetector.h"
+#include "Core/Assert.h"
+#include "Utils/FastHash.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        using double3 = math::vector<double, 3>;
+
+        /** Number of vertices whose canonical coordinates are included in the mesh hash.
+        */
+        const uint32_t kHashedVertexCount = 16;
+
+        /** Quantization steps per unit of the hashed Mahalanobis distances and texture coordinates.
+            The steps are coarse compared to the verification tolerances, so that rounding differences rarely split instances.
+        */
+        const double kDistanceQuantization = 16.0;
+        const double kTexCrdQuantization = 4096.0;
+
+        /** Variance relative to the largest variance below which an axis is considered degenerate (e.g. for planar meshes).
+        */
+        const double kRankEpsilon = 1e-10;
+
+        /** Max deviation of A^T * A from the identity for a rigid transform.
+        */
+        const double kRigidTolerance = 1e-3;
+
+        /** Max number of distinct meshes each mesh with the same hash is compared against.
+            Bounds the cost of large groups of different meshes with the same topology, e.g. quads with different texture coordinates.
+        */
+        const size_t kMaxBasesPerHash = 64;
+
+        /** Row-major 3x3 matrix in double precision.
+        */
+        using double3x3 = std::array<double3, 3>;
+
+        double3 mul(const double3x3& m, const double3& v) { return double3(dot(m[0], v), dot(m[1], v), dot(m[2], v)); }
+
+        double3x3 transpose(const double3x3& m)
+        {
+            double3x3 t;
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    t[r][c] = m[c][r];
+            return t;
+        }
+
+        double determinant(const double3x3& m) { return dot(m[0], cross(m[1], m[2])); }
+
+        /** Returns the inverse transpose of a matrix, assuming it is invertible.
+        */
+        double3x3 inverseTranspose(const double3x3& m)
+        {
+            // The rows of the inverse transpose are the cofactor rows divided by the determinant.
+            const double invDet = 1.0 / determinant(m);
+            return { cross(m[1], m[2]) * invDet, cross(m[2], m[0]) * invDet, cross(m[0], m[1]) * invDet };
+        }
+
+        /** Principal axes of the vertex positions of a mesh.
+        */
+        struct MeshFrame
+        {
+            double3 centroid = double3(0.0);
+            std::array<double3, 3> axes;        ///< Unit eigenvectors of the covariance matrix, ordered by decreasing variance.
+            std::array<double, 3> variances{};  ///< Variance of the positions along each axis.
+            uint32_t rank = 0;                  ///< Number of non-degenerate axes.
+            double diagonal = 0.0;              ///< Diagonal of the bounding box.
+        };
+
+        /** Eigen decomposition of a symmetric 3x3 matrix with the cyclic Jacobi method.
+            \param[in,out] a Matrix. On return the diagonal holds the eigenvalues.
+            \param[out] v Eigenvectors, stored in the columns.
+        */
+        void jacobiEigen(double a[3][3], double v[3][3])
+        {
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    v[r][c] = r == c ? 1.0 : 0.0;
+
+            for (int sweep = 0; sweep < 32; sweep++)
+            {
+                const double offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+                const double diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+                if (offDiagonal <= 1e-30 * diagonal)
+                    break;
+
+                for (int p = 0; p < 2; p++)
+                {
+                    for (int q = p + 1; q < 3; q++)
+                    {
+                        if (a[p][q] == 0.0)
+                            continue;
+
+                        // Rotate by the angle that zeroes a[p][q].
+                        const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                        const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                        const double c = 1.0 / std::sqrt(t * t + 1.0);
+                        const double s = t * c;
+
+                        for (int k = 0; k < 3; k++)
+                        {
+                            const double akp = a[k][p], akq = a[k][q];
+                            a[k][p] = c * akp - s * akq;
+                            a[k][q] = s * akp + c * akq;
+                        }
+                        for (int k = 0; k < 3; k++)
+                        {
+                            const double apk = a[p][k], aqk = a[q][k];
+                            a[p][k] = c * apk - s * aqk;
+                            a[q][k] = s * apk + c * aqk;
+                        }
+                        for (int k = 0; k < 3; k++)
+                        {
+                            const double vkp = v[k][p], vkq = v[k][q];
+                            v[k][p] = c * vkp - s * vkq;
+                            v[k][q] = s * vkp + c * vkq;
+                        }
+                    }
+                }
+            }
+        }
+
+        MeshFrame computeFrame(const MeshInstanceDetector::MeshData& mesh)
+        {
+            MeshFrame frame;
+            if (mesh.vertexCount == 0)
+                return frame;
+
+            double3 minPos(std::numeric_limits<double>::infinity());
+            double3 maxPos(-std::numeric_limits<double>::infinity());
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const double3 p(mesh.pVertices[i].position);
+                frame.centroid += p;
+                minPos = min(minPos, p);
+                maxPos = max(maxPos, p);
+            }
+            frame.centroid /= (double)mesh.vertexCount;
+            frame.diagonal = length(maxPos - minPos);
+
+            double covariance[3][3] = {};
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const double3 d = double3(mesh.pVertices[i].position) - frame.centroid;
+                for (int r = 0; r < 3; r++)
+                    for (int c = 0; c < 3; c++)
+                        covariance[r][c] += d[r] * d[c];
+            }
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    covariance[r][c] /= (double)mesh.vertexCount;
+
+            double eigenvectors[3][3];
+            jacobiEigen(covariance, eigenvectors);
+
+            std::array<int, 3> order = { 0, 1, 2 };
+            std::sort(order.begin(), order.end(), [&](int a, int b) { return covariance[a][a] > covariance[b][b]; });
+            for (int k = 0; k < 3; k++)
+            {
+                const int j = order[k];
+                frame.variances[k] = std::max(covariance[j][j], 0.0);
+                frame.axes[k] = normalize(double3(eigenvectors[0][j], eigenvectors[1][j], eigenvectors[2][j]));
+                if (frame.variances[k] > kRankEpsilon * frame.variances[0])
+                    frame.rank++;
+            }
+            return frame;
+        }
+
+        uint64_t hashMesh(const MeshInstanceDetector::MeshData& mesh, const MeshFrame& frame)
+        {
+            FastHash hash;
+            hash.update(mesh.key);
+            hash.update(mesh.vertexCount);
+            hash.update(frame.rank);
+            if (mesh.pIndexData)
+                hash.update(mesh.pIndexData, mesh.indexDataSize * sizeof(uint32_t));
+
+            // The squared Mahalanobis distance of a vertex from the centroid is invariant under invertible affine transforms.
+            // For degenerate meshes only the non-degenerate axes are used, which keeps the distance invariant.
+            const uint32_t count = std::min(mesh.vertexCount, kHashedVertexCount);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const double3 d = double3(mesh.pVertices[i].position) - frame.centroid;
+                double distance = 0.0;
+                for (uint32_t k = 0; k < frame.rank; k++)
+                    distance += dot(d, frame.axes[k]) * dot(d, frame.axes[k]) / frame.variances[k];
+
+                const float2 texCrd = mesh.pVertices[i].texCrd;
+                const int64_t quantized[3] = {
+                    std::llround(distance * kDistanceQuantization),
+                    std::llround(texCrd.x * kTexCrdQuantization),
+                    std::llround(texCrd.y * kTexCrdQuantization),
+                };
+                hash.update(quantized, sizeof(quantized));
+            }
+            return hash.digest64();
+        }
+
+        bool isDirectionMatching(const double3& expected, const float3& actual, double tolerance)
+        {
+            const double expectedLength = length(expected);
+            const double actualLength = length(double3(actual));
+            if (expectedLength == 0.0 || actualLength == 0.0)
+                return expectedLength == actualLength;
+            return length(expected / expectedLength - double3(actual) / actualLength) <= tolerance;
+        }
+
+        /** Verify that an affine transform maps the vertices of the base mesh to the vertices of the other mesh.
+        */
+        bool verifyTransform(
+            const MeshInstanceDetector::MeshData& base,
+            const MeshInstanceDetector::MeshData& mesh,
+            const double3x3& A,
+            const double3& t,
+            double positionTolerance,
+            double directionTolerance
+        )
+        {
+            const double det = determinant(A);
+            if (!std::isfinite(det) || det == 0.0)
+                return false;
+
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const double3 p = mul(A, double3(base.pVertices[i].position)) + t;
+                if (length(p - double3(mesh.pVertices[i].position)) > positionTolerance)
+                    return false;
+            }
+
+            const double3x3 N = inverseTranspose(A);
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const StaticVertexData& vb = base.pVertices[i];
+                const StaticVertexData& vm = mesh.pVertices[i];
+                if (!isDirectionMatching(mul(N, double3(vb.normal)), vm.normal, directionTolerance))
+                    return false;
+                if (vb.tangent.w != vm.tangent.w)
+                    return false;
+                if (vb.tangent.w != 0.f && !isDirectionMatching(mul(A, double3(vb.tangent.xyz())), vm.tangent.xyz(), directionTolerance))
+                    return false;
+            }
+            return true;
+        }
+
+        std::optional<float4x4> solveTransform(
+            const MeshInstanceDetector::MeshData& base,
+            const MeshFrame& baseFrame,
+            const MeshInstanceDetector::MeshData& mesh,
+            const MeshFrame& meshFrame,
+            const MeshInstanceDetector::Options& options
+        )
+        {
+            // Compare the properties that don't depend on the transform first, as they are cheap to reject on.
+            if (base.key != mesh.key || base.vertexCount != mesh.vertexCount || base.indexDataSize != mesh.indexDataSize)
+                return {};
+            if ((base.pIndexData == nullptr) != (mesh.pIndexData == nullptr))
+                return {};
+            if (baseFrame.rank != meshFrame.rank || baseFrame.rank < 2)
+                return {};
+            if (base.pIndexData && std::memcmp(base.pIndexData, mesh.pIndexData, base.indexDataSize * sizeof(uint32_t)) != 0)
+                return {};
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const float2 d = abs(base.pVertices[i].texCrd - mesh.pVertices[i].texCrd);
+                if (std::max(d.x, d.y) > options.texCrdTolerance)
+                    return {};
+            }
+
+            // Solve the linear part of the transform in the least squares sense: A = Q * P^+,
+            // where Q is the cross-covariance of the positions and P^+ the pseudo-inverse of the covariance of the base positions.
+            std::array<double3, 3> crossCovariance = { double3(0.0), double3(0.0), double3(0.0) };
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const double3 q = double3(mesh.pVertices[i].position) - meshFrame.centroid;
+                const double3 p = double3(base.pVertices[i].position) - baseFrame.centroid;
+                for (int r = 0; r < 3; r++)
+                    crossCovariance[r] += q[r] * p;
+            }
+
+            double3x3 A = { double3(0.0), double3(0.0), double3(0.0) };
+            for (uint32_t k = 0; k < baseFrame.rank; k++)
+            {
+                const double3& axis = baseFrame.axes[k];
+                const double3 image = mul(crossCovariance, axis) / ((double)mesh.vertexCount * baseFrame.variances[k]);
+                for (int r = 0; r < 3; r++)
+                    A[r] += image[r] * axis;
+            }
+
+            // For planar meshes the transform of the normal axis is undetermined by the positions.
+            // Map it to the normal of the transformed plane, scaled like the in-plane axes. The side is chosen by the vertex normals.
+            std::array<double3x3, 2> candidates = { A, A };
+            size_t candidateCount = 1;
+            if (baseFrame.rank == 2)
+            {
+                const double3 planeNormal = cross(mul(A, baseFrame.axes[0]), mul(A, baseFrame.axes[1]));
+                const double area = length(planeNormal);
+                if (area == 0.0)
+                    return {};
+                const double3 normalImage = planeNormal / area * std::sqrt(area);
+                for (int r = 0; r < 3; r++)
+                {
+                    candidates[0][r] += normalImage[r] * baseFrame.axes[2];
+                    candidates[1][r] -= normalImage[r] * baseFrame.axes[2];
+                }
+                candidateCount = 2;
+            }
+
+            const double positionTolerance = options.positionTolerance * meshFrame.diagonal;
+            for (size_t c = 0; c < candidateCount; c++)
+            {
+                const double3x3& M = candidates[c];
+                if (options.rigidOnly)
+                {
+                    const double3x3 Mt = transpose(M);
+                    bool isRigid = true;
+                    for (int r = 0; r < 3; r++)
+                        for (int k = 0; k < 3; k++)
+                            isRigid &= std::abs(dot(Mt[r], Mt[k]) - (r == k ? 1.0 : 0.0)) <= kRigidTolerance;
+                    if (!isRigid)
+                        continue;
+                }
+
+                const double3 t = meshFrame.centroid - mul(M, baseFrame.centroid);
+                if (!verifyTransform(base, mesh, M, t, positionTolerance, options.directionTolerance))
+                    continue;
+
+                float4x4 transform = float4x4::identity();
+                for (int r = 0; r < 3; r++)
+                    transform[r] = float4(float3(M[r]), (float)t[r]);
+                return transform;
+            }
+            return {};
+        }
+    }
+
+    std::vector<MeshInstanceDetector::Match> MeshInstanceDetector::detect(const std::vector<MeshData>& meshes, const Options& options)
+    {
+        // Compute the frame and hash of each mesh in parallel.
+        std::vector<MeshFrame> frames(meshes.size());
+        std::vector<uint64_t> hashes(meshes.size());
+        NumericRange<size_t> meshRange(0, meshes.size());
+        std::for_each(
+            std::execution::par,
+            meshRange.begin(),
+            meshRange.end(),
+            [&](size_t i)
+            {
+                frames[i] = computeFrame(meshes[i]);
+                hashes[i] = hashMesh(meshes[i], frames[i]);
+            }
+        );
+
+        // Group the candidate meshes by hash. Meshes with fewer than two non-degenerate axes are skipped.
+        std::vector<uint32_t> order;
+        order.reserve(meshes.size());
+        for (uint32_t i = 0; i < (uint32_t)meshes.size(); i++)
+        {
+            if (frames[i].rank >= 2)
+                order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return hashes[a] != hashes[b] ? hashes[a] < hashes[b] : a < b; });
+
+        std::vector<std::pair<size_t, size_t>> groups;
+        for (size_t begin = 0; begin < order.size();)
+        {
+            size_t end = begin + 1;
+            while (end < order.size() && hashes[order[end]] == hashes[order[begin]])
+                end++;
+            if (end - begin > 1)
+                groups.emplace_back(begin, end);
+            begin = end;
+        }
+
+        // Verify the candidates of each group in parallel. Every mesh is compared against the distinct meshes found so far in its group.
+        std::vector<std::vector<Match>> groupMatches(groups.size());
+        NumericRange<size_t> groupRange(0, groups.size());
+        std::for_each(
+            std::execution::par,
+            groupRange.begin(),
+            groupRange.end(),
+            [&](size_t g)
+            {
+                std::vector<uint32_t> bases;
+                for (size_t j = groups[g].first; j < groups[g].second; j++)
+                {
+                    const uint32_t meshIndex = order[j];
+                    bool matched = false;
+                    for (uint32_t baseIndex : bases)
+                    {
+                        if (auto transform = solveTransform(meshes[baseIndex], frames[baseIndex], meshes[meshIndex], frames[meshIndex], options))
+                        {
+                            groupMatches[g].push_back({ meshIndex, baseIndex, *transform });
+                            matched = true;
+                            break;
+                        }
+                    }
+                    if (!matched && bases.size() < kMaxBasesPerHash)
+                        bases.push_back(meshIndex);
+                }
+            }
+        );
+
+        std::vector<Match> matches;
+        for (auto& m : groupMatches)
+            matches.insert(matches.end(), m.begin(), m.end());
+        std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) { return a.meshIndex < b.meshIndex; });
+        return matches;
+    }
+
+    uint64_t MeshInstanceDetector::computeHash(const MeshData& mesh)
+    {
+        return hashMesh(mesh, computeFrame(mesh));
+    }
+
+    std::optional<float4x4> MeshInstanceDetector::findTransform(const MeshData& base, const MeshData& mesh, const Options& options)
+    {
+        return solveTransform(base, computeFrame(base), mesh, computeFrame(mesh), options);
+    }
+}
@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SceneTypes.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/Matrix.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Falcor
+{
+    /** Detects meshes that are identical up to a rigid or affine transform of their vertices.
+
+        Two meshes are instances of each other if they have the same vertex order, index data and texture coordinates,
+        and there is an invertible affine transform that maps the positions, normals and tangents of one mesh to the
+        other. This is the common case for duplicated objects in exported scenes, where the exporter bakes the object
+        transform into the vertices.
+
+        Candidate meshes are found by hashing a canonical form of each mesh. Besides the topology, the hash includes the
+        Mahalanobis distances of the first vertices from the centroid, which are invariant under affine transforms.
+        The transform between candidates is then solved in the least squares sense and verified on all vertices.
+    */
+    class FALCOR_API MeshInstanceDetector
+    {
+    public:
+        struct Options
+        {
+            float positionTolerance = 1e-4f;   ///< Max position error relative to the diagonal of the mesh bounds.
+            float directionTolerance = 1e-3f;  ///< Max distance between transformed and actual unit normals and tangents.
+            float texCrdTolerance = 1e-5f;     ///< Max difference of texture coordinates.
+            bool rigidOnly = false;            ///< Only accept rigid transforms (rotations, reflections and translations).
+        };
+
+        /** Vertex and index data of a mesh. The data is referenced, not copied.
+        */
+        struct MeshData
+        {
+            const StaticVertexData* pVertices = nullptr;    ///< Static vertices.
+            uint32_t vertexCount = 0;                       ///< Number of vertices.
+            const uint32_t* pIndexData = nullptr;           ///< Packed index data, or nullptr if non-indexed.
+            uint32_t indexDataSize = 0;                     ///< Size of the index data in 32-bit words.
+            uint64_t key = 0;                               ///< Hash of other properties that must match, e.g. the material and index format.
+        };
+
+        /** Mesh that is an instance of another mesh.
+        */
+        struct Match
+        {
+            uint32_t meshIndex = 0;     ///< Index of the duplicate mesh.
+            uint32_t baseIndex = 0;     ///< Index of the mesh it is an instance of. Base meshes are never duplicates themselves.
+            float4x4 transform;         ///< Transform from the base mesh to the duplicate mesh.
+        };
+
+        /** Find all meshes that are instances of another mesh in the list.
+            \param[in] meshes Meshes.
+            \param[in] options Options.
+            \return Matches ordered by mesh index. The base of a match has a lower index than the duplicate.
+        */
+        static std::vector<Match> detect(const std::vector<MeshData>& meshes, const Options& options);
+
+        /** Compute the transform invariant hash of a mesh.
+            \param[in] mesh Mesh.
+            \return Hash. Meshes that are instances of each other have the same hash.
+        */
+        static uint64_t computeHash(const MeshData& mesh);
+
+        /** Find the transform between two meshes.
+            \param[in] base Base mesh.
+            \param[in] mesh Mesh to compare with.
+            \param[in] options Options.
+            \return Transform from the base mesh to the other mesh, or an empty optional if the meshes are not instances of each other.
+        */
+        static std::optional<float4x4> findTransform(const MeshData& base, const MeshData& mesh, const Options& options);
+    };
+}
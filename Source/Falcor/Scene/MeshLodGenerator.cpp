@@ -0,0 +1,412 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshLodGenerator.h"
+#include "Core/Assert.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        /** Min cosine of the angle a triangle normal may rotate by in a collapse.
+        */
+        const float kMinNormalCos = 0.25f;
+
+        /** Error quadric of a set of weighted planes.
+            Stores the upper triangle of the symmetric 4x4 matrix and the total weight.
+        */
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+            double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+            double a22 = 0.0, a23 = 0.0;
+            double a33 = 0.0;
+            double weight = 0.0;
+
+            void addPlane(const float3& n, float d, float w)
+            {
+                const double x = n.x, y = n.y, z = n.z, dd = d;
+                a00 += w * x * x; a01 += w * x * y; a02 += w * x * z; a03 += w * x * dd;
+                a11 += w * y * y; a12 += w * y * z; a13 += w * y * dd;
+                a22 += w * z * z; a23 += w * z * dd;
+                a33 += w * dd * dd;
+                weight += w;
+            }
+
+            Quadric& operator+=(const Quadric& q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+                a11 += q.a11; a12 += q.a12; a13 += q.a13;
+                a22 += q.a22; a23 += q.a23;
+                a33 += q.a33;
+                weight += q.weight;
+                return *this;
+            }
+
+            /** Returns the weighted mean squared distance of a point to the planes.
+            */
+            double evaluate(const float3& p) const
+            {
+                const double x = p.x, y = p.y, z = p.z;
+                double r = a00 * x * x + a11 * y * y + a22 * z * z + a33;
+                r += 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z + a03 * x + a13 * y + a23 * z);
+                return weight > 0.0 ? std::max(r, 0.0) / weight : 0.0;
+            }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const std::array<uint32_t, 3>& key) const
+            {
+                return ((size_t)key[0] * 73856093u) ^ ((size_t)key[1] * 19349663u) ^ ((size_t)key[2] * 83492791u);
+            }
+        };
+
+        /** Incremental half-edge collapse simplifier.
+            Vertices with the same position are welded. Welded vertices are identified by the lowest vertex index with
+            their position.
+        */
+        class Simplifier
+        {
+        public:
+            Simplifier(const float3* positions, uint32_t vertexCount, const std::vector<uint32_t>& indices)
+                : mpPositions(positions), mIndices(indices)
+            {
+                weldPositions(vertexCount);
+                classifyVertices();
+                computeQuadrics();
+            }
+
+            /** Collapse edges until the mesh has at most the target triangle count or no collapse within the max error is left.
+            */
+            void simplify(uint32_t targetTriangleCount, double maxError)
+            {
+                while (getTriangleCount() > targetTriangleCount)
+                {
+                    if (runPass(targetTriangleCount, maxError * maxError) == 0) break;
+                }
+            }
+
+            uint32_t getTriangleCount() const { return (uint32_t)mIndices.size() / 3; }
+
+            const std::vector<uint32_t>& getIndices() const { return mIndices; }
+
+            float getError() const { return (float)std::sqrt(mMaxCost); }
+
+        private:
+            struct Collapse
+            {
+                uint32_t from;      ///< Welded vertex that is removed.
+                uint32_t to;        ///< Welded vertex it is merged into.
+                uint32_t toVertex;  ///< Vertex index replacing the removed vertex in the triangles.
+                double cost;
+            };
+
+            void weldPositions(uint32_t vertexCount)
+            {
+                std::unordered_map<std::array<uint32_t, 3>, uint32_t, PositionHash> positionMap;
+                mWeld.resize(vertexCount);
+                for (uint32_t v = 0; v < vertexCount; v++)
+                {
+                    // Adding zero turns -0 into +0, so both weld together.
+                    const float3 p = mpPositions[v] + float3(0.f);
+                    std::array<uint32_t, 3> key;
+                    std::memcpy(key.data(), &p, sizeof(key));
+                    mWeld[v] = positionMap.try_emplace(key, v).first->second;
+                }
+
+                // Remove triangles that are degenerate after welding.
+                size_t count = 0;
+                for (size_t i = 0; i < mIndices.size(); i += 3)
+                {
+                    const uint32_t w0 = mWeld[mIndices[i]], w1 = mWeld[mIndices[i + 1]], w2 = mWeld[mIndices[i + 2]];
+                    if (w0 == w1 || w1 == w2 || w2 == w0) continue;
+                    for (size_t j = 0; j < 3; j++) mIndices[count++] = mIndices[i + j];
+                }
+                mIndices.resize(count);
+            }
+
+            void classifyVertices()
+            {
+                mLocked.assign(mWeld.size(), false);
+
+                // Positions referenced through several vertices lie on an attribute seam.
+                std::vector<uint32_t> usedVertex(mWeld.size(), kInvalidIndex);
+                for (uint32_t index : mIndices)
+                {
+                    const uint32_t w = mWeld[index];
+                    if (usedVertex[w] == kInvalidIndex) usedVertex[w] = index;
+                    else if (usedVertex[w] != index) mLocked[w] = true;
+                }
+
+                // Edges not shared by exactly two triangles are on a border or non-manifold.
+                std::unordered_map<uint64_t, uint32_t> edgeCounts;
+                for (size_t i = 0; i < mIndices.size(); i += 3)
+                {
+                    for (size_t e = 0; e < 3; e++)
+                    {
+                        const uint32_t w0 = mWeld[mIndices[i + e]], w1 = mWeld[mIndices[i + (e + 1) % 3]];
+                        edgeCounts[((uint64_t)std::min(w0, w1) << 32) | std::max(w0, w1)]++;
+                    }
+                }
+                for (const auto& [edge, count] : edgeCounts)
+                {
+                    if (count == 2) continue;
+                    mLocked[(uint32_t)(edge >> 32)] = true;
+                    mLocked[(uint32_t)edge] = true;
+                }
+            }
+
+            void computeQuadrics()
+            {
+                mQuadrics.assign(mWeld.size(), Quadric());
+                for (size_t i = 0; i < mIndices.size(); i += 3)
+                {
+                    const float3 p0 = mpPositions[mIndices[i]], p1 = mpPositions[mIndices[i + 1]], p2 = mpPositions[mIndices[i + 2]];
+                    float3 n = cross(p1 - p0, p2 - p0);
+                    const float len = length(n);
+                    if (len == 0.f) continue;
+                    n /= len;
+
+                    // Area-weighted plane, so the error is the mean squared distance over the surface.
+                    for (size_t j = 0; j < 3; j++) mQuadrics[mWeld[mIndices[i + j]]].addPlane(n, -dot(n, p0), 0.5f * len);
+                }
+            }
+
+            void buildAdjacency()
+            {
+                mTriangleOffsets.assign(mWeld.size() + 1, 0);
+                for (uint32_t index : mIndices) mTriangleOffsets[mWeld[index] + 1]++;
+                for (size_t i = 1; i < mTriangleOffsets.size(); i++) mTriangleOffsets[i] += mTriangleOffsets[i - 1];
+
+                mTriangles.resize(mIndices.size());
+                std::vector<uint32_t> fill(mTriangleOffsets.begin(), mTriangleOffsets.end() - 1);
+                for (uint32_t i = 0; i < (uint32_t)mIndices.size(); i++) mTriangles[fill[mWeld[mIndices[i]]]++] = i / 3;
+            }
+
+            /** Check that a collapse keeps the mesh manifold, keeps the attributes of the merged vertex consistent and doesn't flip triangles.
+            */
+            bool canCollapse(const Collapse& c) const
+            {
+                // Both triangles on the edge must reference the same vertex for 'to', else the edge is on a seam of 'to'.
+                uint32_t sharedCount = 0;
+                uint32_t opposite[2] = {};
+                for (uint32_t k = mTriangleOffsets[c.from]; k < mTriangleOffsets[c.from + 1]; k++)
+                {
+                    const uint32_t t = mTriangles[k];
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        if (mWeld[mIndices[3 * t + j]] != c.to) continue;
+                        if (mIndices[3 * t + j] != c.toVertex || sharedCount == 2) return false;
+                        for (uint32_t m = 0; m < 3; m++)
+                        {
+                            const uint32_t w = mWeld[mIndices[3 * t + m]];
+                            if (w != c.from && w != c.to) opposite[sharedCount] = w;
+                        }
+                        sharedCount++;
+                    }
+                }
+                if (sharedCount != 2) return false;
+
+                // Link condition: the only common neighbors are the vertices opposite the edge. Otherwise the collapse creates a fold.
+                for (uint32_t k = mTriangleOffsets[c.from]; k < mTriangleOffsets[c.from + 1]; k++)
+                {
+                    const uint32_t t = mTriangles[k];
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        const uint32_t w = mWeld[mIndices[3 * t + j]];
+                        if (w == c.from || w == c.to || w == opposite[0] || w == opposite[1]) continue;
+                        if (isNeighbor(c.to, w)) return false;
+                    }
+                }
+
+                // Reject collapses that flip or strongly rotate the remaining triangles around the removed vertex.
+                const float3 newPosition = mpPositions[c.toVertex];
+                for (uint32_t k = mTriangleOffsets[c.from]; k < mTriangleOffsets[c.from + 1]; k++)
+                {
+                    const uint32_t t = mTriangles[k];
+                    float3 p[3];
+                    bool hasTo = false;
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        p[j] = mpPositions[mIndices[3 * t + j]];
+                        hasTo |= mWeld[mIndices[3 * t + j]] == c.to;
+                    }
+                    if (hasTo) continue;
+
+                    const float3 n0 = cross(p[1] - p[0], p[2] - p[0]);
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        if (mWeld[mIndices[3 * t + j]] == c.from) p[j] = newPosition;
+                    }
+                    const float3 n1 = cross(p[1] - p[0], p[2] - p[0]);
+                    if (dot(n0, n1) <= kMinNormalCos * length(n0) * length(n1)) return false;
+                }
+                return true;
+            }
+
+            bool isNeighbor(uint32_t w, uint32_t neighbor) const
+            {
+                for (uint32_t k = mTriangleOffsets[w]; k < mTriangleOffsets[w + 1]; k++)
+                {
+                    const uint32_t t = mTriangles[k];
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        if (mWeld[mIndices[3 * t + j]] == neighbor) return true;
+                    }
+                }
+                return false;
+            }
+
+            /** Run one pass of non-overlapping collapses in order of increasing cost.
+                \return Number of collapses.
+            */
+            uint32_t runPass(uint32_t targetTriangleCount, double maxCost)
+            {
+                buildAdjacency();
+
+                // Every directed edge of a triangle is a candidate for collapsing its start into its end vertex.
+                // In a consistently oriented manifold mesh the opposite direction comes from the neighbor triangle.
+                std::vector<Collapse> collapses;
+                for (size_t i = 0; i < mIndices.size(); i += 3)
+                {
+                    for (size_t e = 0; e < 3; e++)
+                    {
+                        const uint32_t from = mWeld[mIndices[i + e]];
+                        if (mLocked[from]) continue;
+                        const uint32_t toVertex = mIndices[i + (e + 1) % 3];
+                        const uint32_t to = mWeld[toVertex];
+                        Quadric q = mQuadrics[from];
+                        q += mQuadrics[to];
+                        collapses.push_back({ from, to, toVertex, q.evaluate(mpPositions[toVertex]) });
+                    }
+                }
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+                // Each collapse removes two triangles.
+                const uint32_t maxCollapseCount = std::max((getTriangleCount() - targetTriangleCount + 1) / 2, 1u);
+                std::vector<uint32_t> target(mWeld.size(), kInvalidIndex);
+                std::vector<bool> touched(mWeld.size(), false);
+                uint32_t collapseCount = 0;
+                for (const Collapse& c : collapses)
+                {
+                    if (c.cost > maxCost) break;
+                    if (touched[c.from] || touched[c.to] || !canCollapse(c)) continue;
+
+                    target[c.from] = c.toVertex;
+                    mQuadrics[c.to] += mQuadrics[c.from];
+                    mMaxCost = std::max(mMaxCost, c.cost);
+
+                    // Block the one-ring of the removed vertex, as its triangles change in this pass.
+                    for (uint32_t k = mTriangleOffsets[c.from]; k < mTriangleOffsets[c.from + 1]; k++)
+                    {
+                        const uint32_t t = mTriangles[k];
+                        for (uint32_t j = 0; j < 3; j++) touched[mWeld[mIndices[3 * t + j]]] = true;
+                    }
+
+                    if (++collapseCount == maxCollapseCount) break;
+                }
+
+                // Remap the removed vertices and drop the triangles that became degenerate.
+                size_t count = 0;
+                for (size_t i = 0; i < mIndices.size(); i += 3)
+                {
+                    uint32_t tri[3];
+                    for (size_t j = 0; j < 3; j++)
+                    {
+                        const uint32_t index = mIndices[i + j];
+                        tri[j] = target[mWeld[index]] != kInvalidIndex ? target[mWeld[index]] : index;
+                    }
+                    if (mWeld[tri[0]] == mWeld[tri[1]] || mWeld[tri[1]] == mWeld[tri[2]] || mWeld[tri[2]] == mWeld[tri[0]]) continue;
+                    for (size_t j = 0; j < 3; j++) mIndices[count++] = tri[j];
+                }
+                mIndices.resize(count);
+
+                return collapseCount;
+            }
+
+            const float3* mpPositions;
+            std::vector<uint32_t> mIndices;
+            std::vector<uint32_t> mWeld;            ///< Welded vertex per vertex.
+            std::vector<bool> mLocked;              ///< Welded vertices on seams and borders, which are never removed.
+            std::vector<Quadric> mQuadrics;         ///< Quadric per welded vertex.
+            std::vector<uint32_t> mTriangleOffsets; ///< Offsets into mTriangles per welded vertex.
+            std::vector<uint32_t> mTriangles;       ///< Triangles adjacent to each welded vertex.
+            double mMaxCost = 0.0;
+        };
+    }
+
+    std::vector<MeshLod> MeshLodGenerator::generate(const float3* positions, uint32_t vertexCount, const std::vector<uint32_t>& indices, const Options& options)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        const uint32_t triangleCount = (uint32_t)indices.size() / 3;
+        if (triangleCount < options.minTriangleCount || triangleCount == 0) return {};
+
+        float3 minPoint(std::numeric_limits<float>::max()), maxPoint(-std::numeric_limits<float>::max());
+        for (uint32_t index : indices)
+        {
+            FALCOR_ASSERT(index < vertexCount);
+            minPoint = min(minPoint, positions[index]);
+            maxPoint = max(maxPoint, positions[index]);
+        }
+        const float diagonal = length(maxPoint - minPoint);
+        if (!(diagonal > 0.f)) return {};
+
+        Simplifier simplifier(positions, vertexCount, indices);
+        std::vector<MeshLod> lods;
+        uint32_t prevTriangleCount = triangleCount;
+        for (float ratio : options.targetRatios)
+        {
+            const uint32_t targetTriangleCount = (uint32_t)(ratio * triangleCount);
+            simplifier.simplify(targetTriangleCount, (double)options.maxError * diagonal);
+
+            const uint32_t levelTriangleCount = simplifier.getTriangleCount();
+            if (levelTriangleCount == 0 || levelTriangleCount > options.minReduction * prevTriangleCount) break;
+            lods.push_back({ simplifier.getError(), simplifier.getIndices() });
+            prevTriangleCount = levelTriangleCount;
+
+            // The error bound was reached or there is nothing left to collapse.
+            if (levelTriangleCount > targetTriangleCount) break;
+        }
+        return lods;
+    }
+
+    uint32_t MeshLodGenerator::selectLevel(const std::vector<MeshLod>& lods, float errorScale, float maxError)
+    {
+        uint32_t level = 0;
+        while (level < lods.size() && lods[level].error * errorScale <= maxError) level++;
+        return level;
+    }
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Simplified level of detail of a triangle mesh.
+        The levels of a mesh share its vertices and only differ in the triangle indices.
+    */
+    struct MeshLod
+    {
+        float error = 0.f;              ///< Geometric error relative to the original mesh in object space.
+        std::vector<uint32_t> indices;  ///< Triangle list indices into the vertices of the original mesh.
+
+        uint32_t getTriangleCount() const { return (uint32_t)indices.size() / 3; }
+    };
+
+    /** Generates a chain of mesh LODs with quadric error metric (QEM) simplification.
+
+        Edges are collapsed into one of their end vertices (half-edge collapses), so no new vertices are created and the
+        normals, tangents and texture coordinates of the remaining vertices are preserved. Vertices on attribute seams
+        (vertices sharing a position with other vertices, e.g. at UV or normal discontinuities) and on open borders are
+        never moved. Since every mesh has a single material, this also preserves material boundaries. Collapses that
+        flip or strongly rotate triangles are rejected.
+
+        The levels of a chain are produced by one continued simplification, so the quadrics and the reported error of
+        each level are relative to the original mesh.
+    */
+    class FALCOR_API MeshLodGenerator
+    {
+    public:
+        struct Options
+        {
+            std::vector<float> targetRatios = { 0.5f, 0.25f, 0.125f }; ///< Target triangle count of each level relative to the original mesh.
+            float maxError = 0.01f;             ///< Max geometric error relative to the diagonal of the mesh bounds. Levels stop at this error.
+            uint32_t minTriangleCount = 256;    ///< Meshes with fewer triangles don't get any levels.
+            float minReduction = 0.9f;          ///< The chain ends when a level keeps more than this fraction of the triangles of the previous level.
+        };
+
+        /** Generate the LOD chain of a mesh.
+            \param[in] positions Vertex positions.
+            \param[in] vertexCount Number of vertices.
+            \param[in] indices Triangle list indices.
+            \param[in] options Options.
+            \return Levels ordered from fine to coarse, not including the original mesh. Can be empty if the mesh can't be simplified.
+        */
+        static std::vector<MeshLod> generate(const float3* positions, uint32_t vertexCount, const std::vector<uint32_t>& indices, const Options& options);
+
+        /** Select the coarsest level of detail whose scaled error is within a bound.
+            \param[in] lods Levels ordered from fine to coarse.
+            \param[in] errorScale Scale from object-space error to the error metric, e.g. pixels per unit at the instance distance.
+            \param[in] maxError Max scaled error.
+            \return 0 for the original mesh, otherwise i + 1 for level lods[i].
+        */
+        static uint32_t selectLevel(const std::vector<MeshLod>& lods, float errorScale, float maxError);
+    };
+}
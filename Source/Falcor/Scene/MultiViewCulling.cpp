@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MultiViewCulling.h"
+#include "Core/Assert.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <execution>
+#include <limits>
+
+#if FALCOR_MSVC
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MULTI_VIEW_CULLING_SSE 1
+#include <emmintrin.h>
+#else
+#define MULTI_VIEW_CULLING_SSE 0
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Number of items processed per task. Each task writes whole words of the visibility bitsets.
+        */
+        const uint32_t kItemsPerTask = 4096;
+
+        uint32_t countTrailingZeros(uint64_t x)
+        {
+#if FALCOR_MSVC
+            unsigned long index;
+            _BitScanForward64(&index, x);
+            return (uint32_t)index;
+#else
+            return (uint32_t)__builtin_ctzll(x);
+#endif
+        }
+    }
+
+    MultiViewCulling::Planes MultiViewCulling::extractPlanes(const float4x4& viewProj)
+    {
+        const float4 r0 = viewProj.getRow(0), r1 = viewProj.getRow(1), r2 = viewProj.getRow(2), r3 = viewProj.getRow(3);
+        return { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2 };
+    }
+
+    void MultiViewCulling::resize(uint32_t itemCount)
+    {
+        mItemCount = itemCount;
+        const size_t paddedCount = ((size_t)itemCount + 63) & ~size_t(63);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            mCenter[i].resize(paddedCount, 0.f);
+            mExtent[i].resize(paddedCount, -std::numeric_limits<float>::max());
+        }
+    }
+
+    void MultiViewCulling::setBounds(uint32_t item, const AABB& worldBounds)
+    {
+        FALCOR_ASSERT(item < mItemCount);
+        const bool valid = worldBounds.valid();
+        const float3 center = valid ? worldBounds.center() : float3(0.f);
+        const float3 extent = valid ? worldBounds.extent() * 0.5f : float3(-std::numeric_limits<float>::max());
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            mCenter[i][item] = center[i];
+            mExtent[i][item] = extent[i];
+        }
+    }
+
+    void MultiViewCulling::setAlwaysVisible(uint32_t item)
+    {
+        FALCOR_ASSERT(item < mItemCount);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            mCenter[i][item] = 0.f;
+            mExtent[i][item] = std::numeric_limits<float>::max();
+        }
+    }
+
+    AABB MultiViewCulling::getBounds(uint32_t item) const
+    {
+        FALCOR_ASSERT(item < mItemCount);
+        const float3 center(mCenter[0][item], mCenter[1][item], mCenter[2][item]);
+        const float3 extent(mExtent[0][item], mExtent[1][item], mExtent[2][item]);
+        if (extent.x < 0.f) return AABB();
+        return AABB(center - extent, center + extent);
+    }
+
+    void MultiViewCulling::setViews(const std::vector<float4x4>& viewProjs)
+    {
+        mViews.resize(viewProjs.size());
+        for (size_t i = 0; i < viewProjs.size(); i++) mViews[i].planes = extractPlanes(viewProjs[i]);
+    }
+
+    void MultiViewCulling::cull()
+    {
+        const uint32_t wordCount = (mItemCount + 63) / 64;
+        for (auto& view : mViews) view.visibility.assign(wordCount, 0);
+
+        // Test all views per range of items, so that the bounds are read from memory once.
+        const uint32_t taskCount = (mItemCount + kItemsPerTask - 1) / kItemsPerTask;
+        NumericRange<uint32_t> tasks(0, taskCount);
+        std::for_each(
+            std::execution::par, tasks.begin(), tasks.end(),
+            [&](uint32_t task) { cullRange(task * kItemsPerTask, std::min((task + 1) * kItemsPerTask, wordCount * 64)); }
+        );
+
+        // Clear the bits of the padding items and compact.
+        NumericRange<size_t> views(0, mViews.size());
+        std::for_each(
+            std::execution::par, views.begin(), views.end(),
+            [&](size_t viewIndex)
+            {
+                View& view = mViews[viewIndex];
+                if (mItemCount % 64 != 0) view.visibility.back() &= (uint64_t(1) << (mItemCount % 64)) - 1;
+
+                view.visibleItems.clear();
+                for (uint32_t word = 0; word < wordCount; word++)
+                {
+                    for (uint64_t bits = view.visibility[word]; bits != 0; bits &= bits - 1)
+                    {
+                        view.visibleItems.push_back(word * 64 + countTrailingZeros(bits));
+                    }
+                }
+            }
+        );
+    }
+
+    void MultiViewCulling::cullRange(uint32_t begin, uint32_t end)
+    {
+        for (uint32_t base = begin; base < end; base += 64)
+        {
+            for (auto& view : mViews)
+            {
+                uint64_t bits = 0;
+#if MULTI_VIEW_CULLING_SSE
+                __m128 n[6][3], d[6], absN[6][3];
+                const __m128 signMask = _mm_set1_ps(-0.f);
+                for (uint32_t p = 0; p < 6; p++)
+                {
+                    const float4& plane = view.planes[p];
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        n[p][c] = _mm_set1_ps(plane[c]);
+                        absN[p][c] = _mm_andnot_ps(signMask, n[p][c]);
+                    }
+                    d[p] = _mm_set1_ps(plane.w);
+                }
+
+                for (uint32_t i = 0; i < 64; i += 4)
+                {
+                    const __m128 cx = _mm_loadu_ps(&mCenter[0][base + i]), cy = _mm_loadu_ps(&mCenter[1][base + i]), cz = _mm_loadu_ps(&mCenter[2][base + i]);
+                    const __m128 ex = _mm_loadu_ps(&mExtent[0][base + i]), ey = _mm_loadu_ps(&mExtent[1][base + i]), ez = _mm_loadu_ps(&mExtent[2][base + i]);
+
+                    // The box is outside a plane if its center is further outside than the projected half extent.
+                    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                    for (uint32_t p = 0; p < 6; p++)
+                    {
+                        const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[p][0], cx), _mm_mul_ps(n[p][1], cy)), _mm_add_ps(_mm_mul_ps(n[p][2], cz), d[p]));
+                        const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absN[p][0], ex), _mm_mul_ps(absN[p][1], ey)), _mm_mul_ps(absN[p][2], ez));
+                        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+                    }
+                    bits |= (uint64_t)_mm_movemask_ps(inside) << i;
+                }
+#else
+                for (uint32_t i = 0; i < 64; i++)
+                {
+                    const uint32_t item = base + i;
+                    bool inside = true;
+                    for (const float4& plane : view.planes)
+                    {
+                        const float dist = plane.x * mCenter[0][item] + plane.y * mCenter[1][item] + plane.z * mCenter[2][item] + plane.w;
+                        const float radius = std::abs(plane.x) * mExtent[0][item] + std::abs(plane.y) * mExtent[1][item] + std::abs(plane.z) * mExtent[2][item];
+                        inside &= dist + radius >= 0.f;
+                    }
+                    if (inside) bits |= uint64_t(1) << i;
+                }
+#endif
+                view.visibility[base / 64] = bits;
+            }
+        }
+    }
+}
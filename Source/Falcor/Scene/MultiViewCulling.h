@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+#include <array>
+#include <vector>
+
+namespace Falcor
+{
+    /** Frustum culling of a set of bounding boxes against multiple views at once.
+
+        World-space bounds are stored per item as center and half extent in structure-of-arrays layout. They are set by
+        the owner when an item moves, so they are computed once and shared by all views. cull() tests each group of
+        four items against all planes of all views with SSE while the item bounds stay in registers. The result is a
+        visibility bitset and a compacted list of visible items per view.
+    */
+    class FALCOR_API MultiViewCulling
+    {
+    public:
+        using Planes = std::array<float4, 6>;
+
+        /** Extract the frustum planes of a view-projection matrix with [0, 1] clip space depth.
+            A point p is inside plane (n, d) if dot(n, p) + d >= 0. The planes are not normalized.
+        */
+        static Planes extractPlanes(const float4x4& viewProj);
+
+        /** Set the number of items. Newly added items are never visible until their bounds are set.
+        */
+        void resize(uint32_t itemCount);
+
+        uint32_t getItemCount() const { return mItemCount; }
+
+        /** Set the world-space bounds of an item. Items with invalid bounds are never visible.
+        */
+        void setBounds(uint32_t item, const AABB& worldBounds);
+
+        /** Mark an item as visible in all views, e.g. because its bounds are not known.
+        */
+        void setAlwaysVisible(uint32_t item);
+
+        /** Get the world-space bounds of an item.
+        */
+        AABB getBounds(uint32_t item) const;
+
+        /** Set the views to cull against.
+            \param[in] viewProjs View-projection matrices, one per view.
+        */
+        void setViews(const std::vector<float4x4>& viewProjs);
+
+        uint32_t getViewCount() const { return (uint32_t)mViews.size(); }
+
+        /** Cull all items against all views.
+        */
+        void cull();
+
+        /** Get the visibility bitset of a view. Bit i of word i / 64 is set if item i is visible.
+        */
+        const std::vector<uint64_t>& getVisibility(uint32_t view) const { return mViews[view].visibility; }
+
+        bool isVisible(uint32_t view, uint32_t item) const { return (mViews[view].visibility[item / 64] >> (item % 64)) & 1; }
+
+        /** Get the compacted list of visible items of a view in increasing order.
+        */
+        const std::vector<uint32_t>& getVisibleItems(uint32_t view) const { return mViews[view].visibleItems; }
+
+    private:
+        struct View
+        {
+            Planes planes;
+            std::vector<uint64_t> visibility;
+            std::vector<uint32_t> visibleItems;
+        };
+
+        void cullRange(uint32_t begin, uint32_t end);
+
+        uint32_t mItemCount = 0;
+        std::vector<float> mCenter[3];      ///< Bounds center per item, padded to a multiple of 64 items.
+        std::vector<float> mExtent[3];      ///< Bounds half extent per item. Negative for items that are never visible.
+        std::vector<View> mViews;
+    };
+}
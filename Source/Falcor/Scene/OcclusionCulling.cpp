@@ -0,0 +1,411 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "OcclusionCulling.h"
+#include "Core/Assert.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULLING_SSE 1
+#include <emmintrin.h>
+#else
+#define OCCLUSION_CULLING_SSE 0
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        std::array<float3, 8> getCorners(const AABB& b)
+        {
+            std::array<float3, 8> corners;
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                corners[i] = float3(i & 1 ? b.maxPoint.x : b.minPoint.x, i & 2 ? b.maxPoint.y : b.minPoint.y, i & 4 ? b.maxPoint.z : b.minPoint.z);
+            }
+            return corners;
+        }
+    }
+
+    OcclusionCulling::OcclusionCulling(const Options& options)
+        : mOptions(options)
+    {
+        Level level;
+        level.width = std::max((options.width + 3) & ~3u, 4u);
+        level.height = std::max(options.height, 1u);
+        level.depth.resize((size_t)level.width * level.height, 1.f);
+        mLevels.push_back(std::move(level));
+
+        while (mLevels.back().width > 1 || mLevels.back().height > 1)
+        {
+            const Level& prev = mLevels.back();
+            Level next;
+            next.width = (prev.width + 1) / 2;
+            next.height = (prev.height + 1) / 2;
+            next.depth.resize((size_t)next.width * next.height, 1.f);
+            mLevels.push_back(std::move(next));
+        }
+    }
+
+    OcclusionCulling::Hull OcclusionCulling::createHull(const std::vector<float3>& positions, const std::vector<uint32_t>& indices, uint32_t maxTriangles)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        if (indices.empty() || indices.size() / 3 > maxTriangles) return {};
+
+        // Weld vertices with identical positions.
+        std::vector<uint32_t> order(positions.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        auto less = [&](uint32_t a, uint32_t b)
+        {
+            const float3& pa = positions[a];
+            const float3& pb = positions[b];
+            return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+        };
+        std::sort(order.begin(), order.end(), less);
+
+        Hull hull;
+        std::vector<uint32_t> remap(positions.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (i == 0 || less(order[i - 1], order[i]))
+            {
+                hull.positions.push_back(positions[order[i]]);
+                hull.bounds.include(positions[order[i]]);
+            }
+            remap[order[i]] = (uint32_t)hull.positions.size() - 1;
+        }
+
+        // Remove degenerate triangles.
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            uint32_t i0 = remap[indices[i]], i1 = remap[indices[i + 1]], i2 = remap[indices[i + 2]];
+            if (i0 == i1 || i1 == i2 || i2 == i0) continue;
+            const float3& p0 = hull.positions[i0];
+            float3 n = math::cross(hull.positions[i1] - p0, hull.positions[i2] - p0);
+            if (n.x == 0.f && n.y == 0.f && n.z == 0.f) continue;
+            hull.indices.insert(hull.indices.end(), { i0, i1, i2 });
+        }
+
+        if (hull.indices.empty()) return {};
+        return hull;
+    }
+
+    uint32_t OcclusionCulling::addHull(Hull hull)
+    {
+        if (hull.empty()) return kInvalidHullID;
+        mHulls.push_back(std::move(hull));
+        return (uint32_t)mHulls.size() - 1;
+    }
+
+    void OcclusionCulling::update(const float4x4& viewProj, const std::vector<Candidate>& candidates)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        beginUpdate(viewProj);
+
+        // Select the largest occluders on screen.
+        std::vector<std::pair<float, uint32_t>> selected;
+        for (uint32_t i = 0; i < candidates.size(); i++)
+        {
+            const Candidate& candidate = candidates[i];
+            FALCOR_ASSERT(candidate.hullID < mHulls.size());
+            float area = getScreenArea(mHulls[candidate.hullID].bounds.transform(candidate.transform));
+            if (area >= mOptions.minOccluderScreenArea) selected.emplace_back(area, i);
+        }
+        auto larger = [](const auto& a, const auto& b) { return a.first > b.first; };
+        if (selected.size() > mOptions.maxOccluders)
+        {
+            std::nth_element(selected.begin(), selected.begin() + mOptions.maxOccluders, selected.end(), larger);
+            selected.resize(mOptions.maxOccluders);
+        }
+
+        for (const auto& [area, index] : selected)
+        {
+            rasterize(mHulls[candidates[index].hullID], candidates[index].transform);
+        }
+
+        buildHierarchy();
+
+        mStats.updateTimeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    void OcclusionCulling::beginUpdate(const float4x4& viewProj)
+    {
+        mViewProj = viewProj;
+        mHasOccluders = false;
+        mStats = {};
+        std::fill(mLevels[0].depth.begin(), mLevels[0].depth.end(), 1.f);
+    }
+
+    void OcclusionCulling::rasterize(const Hull& hull, const float4x4& transform)
+    {
+        const float4x4 worldViewProj = math::mul(mViewProj, transform);
+
+        std::vector<float4> clip(hull.positions.size());
+        for (size_t i = 0; i < hull.positions.size(); i++) clip[i] = math::mul(worldViewProj, float4(hull.positions[i], 1.f));
+
+        for (size_t i = 0; i < hull.indices.size(); i += 3)
+        {
+            const float4 v[3] = { clip[hull.indices[i]], clip[hull.indices[i + 1]], clip[hull.indices[i + 2]] };
+
+            // Reject triangles fully outside one of the frustum planes.
+            auto outside = [&](auto&& pred) { return pred(v[0]) && pred(v[1]) && pred(v[2]); };
+            if (outside([](const float4& p) { return p.x > p.w; }) || outside([](const float4& p) { return p.x < -p.w; }) ||
+                outside([](const float4& p) { return p.y > p.w; }) || outside([](const float4& p) { return p.y < -p.w; }) ||
+                outside([](const float4& p) { return p.z > p.w; }) || outside([](const float4& p) { return p.z < 0.f; }))
+                continue;
+
+            clipAndRasterize(v);
+            mStats.occluderTriangleCount++;
+        }
+
+        mStats.occluderCount++;
+        mHasOccluders = true;
+    }
+
+    void OcclusionCulling::clipAndRasterize(const float4 v[3])
+    {
+        // Clip against the near plane (z >= 0), which yields a polygon with up to four vertices.
+        float4 polygon[4];
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const float4& a = v[i];
+            const float4& b = v[(i + 1) % 3];
+            if (a.z >= 0.f) polygon[count++] = a;
+            if ((a.z >= 0.f) != (b.z >= 0.f)) polygon[count++] = a + (b - a) * (a.z / (a.z - b.z));
+        }
+        if (count < 3) return;
+
+        const Level& level = mLevels[0];
+        float3 screen[4];
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const float4& p = polygon[i];
+            if (p.w <= 0.f) return;
+            float invW = 1.f / p.w;
+            screen[i] = float3((p.x * invW * 0.5f + 0.5f) * level.width, (0.5f - p.y * invW * 0.5f) * level.height, p.z * invW);
+        }
+
+        for (uint32_t i = 2; i < count; i++)
+        {
+            const float3 triangle[3] = { screen[0], screen[i - 1], screen[i] };
+            rasterizeTriangle(triangle);
+        }
+    }
+
+    void OcclusionCulling::rasterizeTriangle(const float3 triangle[3])
+    {
+        float3 v0 = triangle[0], v1 = triangle[1], v2 = triangle[2];
+
+        // Edge function of edge (a, b) as coefficients of A * x + B * y + C.
+        auto edge = [](const float3& a, const float3& b) { return float3(a.y - b.y, b.x - a.x, (b.y - a.y) * a.x - (b.x - a.x) * a.y); };
+
+        float3 e01 = edge(v0, v1);
+        float area = e01.x * v2.x + e01.y * v2.y + e01.z;
+        if (area < 0.f)
+        {
+            std::swap(v1, v2);
+            area = -area;
+            e01 = edge(v0, v1);
+        }
+        if (!(area > 0.f)) return;
+
+        // The edge function of each edge weights the opposite vertex.
+        const float3 e0 = edge(v1, v2), e1 = edge(v2, v0), e2 = e01;
+
+        // Depth plane. The slack covers the depth variation within the pixel around the sample point.
+        const float invArea = 1.f / area;
+        const float zA = (e0.x * v0.z + e1.x * v1.z + e2.x * v2.z) * invArea;
+        const float zB = (e0.y * v0.z + e1.y * v1.z + e2.y * v2.z) * invArea;
+        const float zC = (e0.z * v0.z + e1.z * v1.z + e2.z * v2.z) * invArea + 0.5f * (std::abs(zA) + std::abs(zB));
+        const float zMax = std::max({ v0.z, v1.z, v2.z });
+
+        Level& level = mLevels[0];
+        const float minX = std::min({ v0.x, v1.x, v2.x }), maxX = std::max({ v0.x, v1.x, v2.x });
+        const float minY = std::min({ v0.y, v1.y, v2.y }), maxY = std::max({ v0.y, v1.y, v2.y });
+        if (maxX < 0.f || maxY < 0.f || minX > (float)level.width || minY > (float)level.height) return;
+        const int x0 = (int)std::max(std::floor(minX), 0.f) & ~3;
+        const int x1 = (int)std::min(std::ceil(maxX), (float)level.width - 1.f);
+        const int y0 = (int)std::max(std::floor(minY), 0.f);
+        const int y1 = (int)std::min(std::ceil(maxY), (float)level.height - 1.f);
+
+#if OCCLUSION_CULLING_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 offset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 a0 = _mm_set1_ps(e0.x), a1 = _mm_set1_ps(e1.x), a2 = _mm_set1_ps(e2.x), az = _mm_set1_ps(zA);
+        const __m128 zMaxV = _mm_set1_ps(zMax);
+#endif
+
+        for (int y = y0; y <= y1; y++)
+        {
+            const float py = (float)y + 0.5f;
+            float* pRow = level.depth.data() + (size_t)y * level.width;
+            const float c0 = e0.y * py + e0.z, c1 = e1.y * py + e1.z, c2 = e2.y * py + e2.z, cz = zB * py + zC;
+
+#if OCCLUSION_CULLING_SSE
+            const __m128 r0 = _mm_set1_ps(c0), r1 = _mm_set1_ps(c1), r2 = _mm_set1_ps(c2), rz = _mm_set1_ps(cz);
+            for (int x = x0; x <= x1; x += 4)
+            {
+                // The row width is a multiple of four, so four pixels starting at x are always in the buffer.
+                const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offset);
+                const __m128 w0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+                const __m128 w1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+                const __m128 w2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                const __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(az, px), rz), zMaxV);
+                const __m128 depth = _mm_loadu_ps(pRow + x);
+                const __m128 result = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(depth, z)), _mm_andnot_ps(inside, depth));
+                _mm_storeu_ps(pRow + x, result);
+            }
+#else
+            for (int x = x0; x <= x1; x++)
+            {
+                const float px = (float)x + 0.5f;
+                if (e0.x * px + c0 < 0.f || e1.x * px + c1 < 0.f || e2.x * px + c2 < 0.f) continue;
+                const float z = std::min(zA * px + cz, zMax);
+                pRow[x] = std::min(pRow[x], z);
+            }
+#endif
+        }
+    }
+
+    void OcclusionCulling::buildHierarchy()
+    {
+        for (size_t i = 1; i < mLevels.size(); i++)
+        {
+            const Level& src = mLevels[i - 1];
+            Level& dst = mLevels[i];
+            for (uint32_t y = 0; y < dst.height; y++)
+            {
+                const float* pRow0 = src.depth.data() + (size_t)(2 * y) * src.width;
+                const float* pRow1 = src.depth.data() + (size_t)std::min(2 * y + 1, src.height - 1) * src.width;
+                for (uint32_t x = 0; x < dst.width; x++)
+                {
+                    const uint32_t sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                    dst.depth[(size_t)y * dst.width + x] = std::max(std::max(pRow0[sx0], pRow0[sx1]), std::max(pRow1[sx0], pRow1[sx1]));
+                }
+            }
+        }
+    }
+
+    bool OcclusionCulling::isVisible(const AABB& worldBounds) const
+    {
+        mStats.testedCount++;
+        if (!mHasOccluders || !worldBounds.valid()) return true;
+
+        const Level& level0 = mLevels[0];
+        float minX = std::numeric_limits<float>::infinity(), maxX = -minX, minY = minX, maxY = -minX, nearZ = minX;
+        for (const float3& corner : getCorners(worldBounds))
+        {
+            const float4 p = math::mul(mViewProj, float4(corner, 1.f));
+            // Boxes crossing the near plane are treated as visible.
+            if (p.z < 0.f || p.w <= 0.f) return true;
+            const float invW = 1.f / p.w;
+            const float x = (p.x * invW * 0.5f + 0.5f) * level0.width;
+            const float y = (0.5f - p.y * invW * 0.5f) * level0.height;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearZ = std::min(nearZ, p.z * invW);
+        }
+
+        // Boxes outside the screen are left to frustum culling.
+        if (maxX < 0.f || maxY < 0.f || minX > (float)level0.width || minY > (float)level0.height) return true;
+
+        // Pixel rectangle dilated by one pixel.
+        const uint32_t x0 = (uint32_t)std::max(std::floor(minX) - 1.f, 0.f);
+        const uint32_t x1 = (uint32_t)std::min(std::floor(maxX) + 1.f, (float)level0.width - 1.f);
+        const uint32_t y0 = (uint32_t)std::max(std::floor(minY) - 1.f, 0.f);
+        const uint32_t y1 = (uint32_t)std::min(std::floor(maxY) + 1.f, (float)level0.height - 1.f);
+
+        // Use the finest level where the rectangle covers at most 2x2 texels.
+        uint32_t l = 0;
+        while (l + 1 < mLevels.size() && ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1)) l++;
+
+        const Level& level = mLevels[l];
+        float maxDepth = 0.f;
+        for (uint32_t y = y0 >> l; y <= (y1 >> l); y++)
+        {
+            for (uint32_t x = x0 >> l; x <= (x1 >> l); x++) maxDepth = std::max(maxDepth, level.depth[(size_t)y * level.width + x]);
+        }
+
+        if (nearZ > maxDepth)
+        {
+            mStats.culledCount++;
+            return false;
+        }
+        return true;
+    }
+
+    float OcclusionCulling::getScreenArea(const AABB& worldBounds) const
+    {
+        if (!worldBounds.valid()) return 0.f;
+
+        std::array<float4, 8> clip;
+        uint32_t outside[6] = {};
+        bool crossesNearPlane = false;
+        const auto corners = getCorners(worldBounds);
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            const float4 p = clip[i] = math::mul(mViewProj, float4(corners[i], 1.f));
+            outside[0] += p.x > p.w;
+            outside[1] += p.x < -p.w;
+            outside[2] += p.y > p.w;
+            outside[3] += p.y < -p.w;
+            outside[4] += p.z > p.w;
+            outside[5] += p.z < 0.f;
+            crossesNearPlane |= p.z < 0.f || p.w <= 0.f;
+        }
+
+        // Boxes outside the frustum are skipped, boxes crossing the near plane are potentially large occluders.
+        for (uint32_t count : outside)
+        {
+            if (count == 8) return 0.f;
+        }
+        if (crossesNearPlane) return 1.f;
+
+        float minX = std::numeric_limits<float>::infinity(), maxX = -minX, minY = minX, maxY = -minX;
+        for (const float4& p : clip)
+        {
+            minX = std::min(minX, p.x / p.w);
+            maxX = std::max(maxX, p.x / p.w);
+            minY = std::min(minY, p.y / p.w);
+            maxY = std::max(maxY, p.y / p.w);
+        }
+
+        const float w = std::min(maxX, 1.f) - std::max(minX, -1.f);
+        const float h = std::min(maxY, 1.f) - std::max(minY, -1.f);
+        return w > 0.f && h > 0.f ? w * h * 0.25f : 0.f;
+    }
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU occlusion culling for rasterization passes.
+
+        A small set of occluders is rasterized into a low-resolution depth buffer on the CPU. Occluders are
+        stored as hulls, i.e. welded triangle lists in object space, and are selected per update by the screen-space
+        size of their bounding boxes. After rasterization a hierarchy of max-depth levels is built, and bounding boxes
+        are tested against the coarsest level that covers them with at most 2x2 texels.
+
+        The depth buffer stores, per pixel, an upper bound of the occluder depth within the pixel, and the bounding box
+        test uses the nearest depth of the box and is dilated by one pixel. Depth follows the [0, 1] convention of the
+        Falcor projection matrices, with 0 at the near plane.
+    */
+    class FALCOR_API OcclusionCulling : public Object
+    {
+        FALCOR_OBJECT(OcclusionCulling)
+    public:
+        static constexpr uint32_t kInvalidHullID = uint32_t(-1);
+
+        struct Options
+        {
+            uint32_t width = 256;                   ///< Depth buffer width in pixels. Rounded up to a multiple of 4.
+            uint32_t height = 128;                  ///< Depth buffer height in pixels.
+            uint32_t maxOccluders = 64;             ///< Maximum number of occluders rasterized per update.
+            float minOccluderScreenArea = 0.005f;   ///< Minimum fraction of the screen covered by the bounding box of an occluder.
+            uint32_t maxHullTriangles = 512;        ///< Meshes with more triangles are not used as occluders.
+        };
+
+        /** Occluder geometry in object space.
+        */
+        struct Hull
+        {
+            std::vector<float3> positions;
+            std::vector<uint32_t> indices;          ///< Three indices per triangle.
+            AABB bounds;
+
+            bool empty() const { return indices.empty(); }
+            uint32_t getTriangleCount() const { return (uint32_t)indices.size() / 3; }
+        };
+
+        /** Occluder candidate for update().
+        */
+        struct Candidate
+        {
+            uint32_t hullID = kInvalidHullID;
+            float4x4 transform = float4x4::identity(); ///< Object to world transform.
+        };
+
+        struct Stats
+        {
+            uint32_t occluderCount = 0;             ///< Number of occluders rasterized in the last update.
+            uint32_t occluderTriangleCount = 0;     ///< Number of occluder triangles rasterized in the last update.
+            uint64_t testedCount = 0;               ///< Number of bounding boxes tested since the last update.
+            uint64_t culledCount = 0;               ///< Number of bounding boxes found occluded since the last update.
+            double updateTimeMs = 0.0;              ///< CPU time of the last update (selection, rasterization and hierarchy).
+
+            float getCullRate() const { return testedCount > 0 ? float(culledCount) / float(testedCount) : 0.f; }
+        };
+
+        OcclusionCulling() : OcclusionCulling(Options()) {}
+        OcclusionCulling(const Options& options);
+
+        /** Create an occluder hull from a triangle list. Vertices with identical positions are welded and degenerate
+            triangles are removed. Lossy simplification is not applied since it could move the silhouette outwards.
+            \param[in] positions Vertex positions.
+            \param[in] indices Triangle indices, three per triangle.
+            \param[in] maxTriangles Maximum number of triangles.
+            \return The hull, or an empty hull if the mesh has more than maxTriangles triangles.
+        */
+        static Hull createHull(const std::vector<float3>& positions, const std::vector<uint32_t>& indices, uint32_t maxTriangles);
+
+        /** Add an occluder hull.
+            \return Hull ID, or kInvalidHullID if the hull is empty.
+        */
+        uint32_t addHull(Hull hull);
+
+        const Hull& getHull(uint32_t hullID) const { return mHulls[hullID]; }
+        uint32_t getHullCount() const { return (uint32_t)mHulls.size(); }
+
+        /** Select occluders among the candidates by their screen-space size, rasterize them and build the depth hierarchy.
+            \param[in] viewProj View-projection matrix.
+            \param[in] candidates Occluder candidates. Only opaque, rigid geometry should be passed.
+        */
+        void update(const float4x4& viewProj, const std::vector<Candidate>& candidates);
+
+        /** Clear the depth buffer and set the view-projection matrix. Use together with rasterize() and buildHierarchy()
+            to specify the occluders explicitly.
+        */
+        void beginUpdate(const float4x4& viewProj);
+
+        /** Rasterize an occluder hull into the depth buffer.
+        */
+        void rasterize(const Hull& hull, const float4x4& transform);
+
+        /** Build the max-depth hierarchy. Must be called after the occluders are rasterized.
+        */
+        void buildHierarchy();
+
+        /** Test if a bounding box may be visible.
+            \param[in] worldBounds Bounding box in world space.
+            \return False if the box is guaranteed to be hidden behind the occluders.
+        */
+        bool isVisible(const AABB& worldBounds) const;
+
+        /** Get the depth stored in the depth buffer. Pixel (0, 0) is the top-left corner of the screen.
+        */
+        float getDepth(uint32_t x, uint32_t y) const { return mLevels[0].depth[y * mLevels[0].width + x]; }
+
+        const Options& getOptions() const { return mOptions; }
+        uint32_t getWidth() const { return mLevels[0].width; }
+        uint32_t getHeight() const { return mLevels[0].height; }
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        struct Level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float> depth;
+        };
+
+        /** Get the fraction of the screen covered by the projected bounding box, clamped to the screen.
+        */
+        float getScreenArea(const AABB& worldBounds) const;
+        void clipAndRasterize(const float4 v[3]);
+        void rasterizeTriangle(const float3 v[3]);
+
+        Options mOptions;
+        std::vector<Hull> mHulls;
+        std::vector<Level> mLevels;                 ///< Level 0 is the depth buffer, each following level stores the max of 2x2 texels.
+        float4x4 mViewProj = float4x4::identity();
+        bool mHasOccluders = false;
+        mutable Stats mStats;
+    };
+}
@@ -26,6 +26,8 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "SDFGrid.h"
+#include "SDFGridFile.h"
+#include "Scene/TriangleMesh.h"
 #include "NormalizedDenseSDFGrid/NDSDFGrid.h"
 #include "SparseVoxelSet/SDFSVS.h"
 #include "SparseBrickSet/SDFSBS.h"
@@ -298,6 +300,30 @@ namespace Falcor
         std::filesystem::path fullPath;
         if (findFileInDataDirectories(path, fullPath))
         {
+            if (SDFGridFile::isChunkedFile(fullPath))
+            {
+                try
+                {
+                    auto pFile = std::make_shared<SDFGridFile>(fullPath);
+                    uint32_t gridWidth = pFile->getGridWidth();
+                    if (getType() != Type::SparseBrickSet)
+                    {
+                        checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2 for SDFGrid type of {}", gridWidth, getTypeName(getType()));
+                    }
+
+                    mGridWidth = gridWidth;
+                    setValuesFromFileInternal(pFile);
+
+                    mInitializedWithPrimitives = false;
+                    return true;
+                }
+                catch (const RuntimeError& e)
+                {
+                    logWarning("SDFGrid::loadValuesFromFile() failed to load '{}': {}", path, e.what());
+                    return false;
+                }
+            }
+
             std::ifstream file(fullPath, std::ios::in | std::ios::binary);
 
             if (file.is_open())
@@ -373,6 +399,30 @@ namespace Falcor
         setValues(cornerValues, gridWidth);
     }
 
+    float4x4 SDFGrid::bakeMesh(const TriangleMesh& mesh, uint32_t gridWidth, SDFMeshBaker::SignMode signMode, float narrowBandWidth)
+    {
+        return bakeMesh(SDFMeshBaker(mesh), gridWidth, signMode, narrowBandWidth);
+    }
+
+    float4x4 SDFGrid::bakeMesh(const std::vector<float3>& positions, const std::vector<uint32_t>& indices, uint32_t gridWidth, SDFMeshBaker::SignMode signMode, float narrowBandWidth)
+    {
+        return bakeMesh(SDFMeshBaker(positions, indices), gridWidth, signMode, narrowBandWidth);
+    }
+
+    float4x4 SDFGrid::bakeMesh(const SDFMeshBaker& baker, uint32_t gridWidth, SDFMeshBaker::SignMode signMode, float narrowBandWidth)
+    {
+        SDFMeshBaker::Options options;
+        options.gridWidth = gridWidth;
+        options.signMode = signMode;
+        options.narrowBandWidth = narrowBandWidth;
+
+        SDFMeshBaker::Result result = baker.bake(options);
+        setValues(result.values, result.gridWidth);
+        mInitializedWithPrimitives = false;
+
+        return result.meshToGrid;
+    }
+
     bool SDFGrid::writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext)
     {
         FALCOR_ASSERT(pRenderContext);
@@ -400,17 +450,38 @@ namespace Falcor
         pFence->syncCpu();
         const float* pValues = reinterpret_cast<const float*>(pValuesStagingBuffer->map(Buffer::MapType::Read));
 
-        std::ofstream file(path, std::ios::out | std::ios::binary);
-
-        if (file.is_open())
+        bool success = true;
+        if (path.extension() == ".sdfc")
+        {
+            try
+            {
+                SDFGridFile::write(path, pValues, mGridWidth);
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("SDFGrid::writeValuesFromPrimitivesToFile() failed: {}", e.what());
+                success = false;
+            }
+        }
+        else
         {
-            file.write(reinterpret_cast<const char*>(&mGridWidth), sizeof(uint32_t));
-            file.write(reinterpret_cast<const char*>(pValues), valueCount * sizeof(float));
-            file.close();
+            std::ofstream file(path, std::ios::out | std::ios::binary);
+
+            if (file.is_open())
+            {
+                file.write(reinterpret_cast<const char*>(&mGridWidth), sizeof(uint32_t));
+                file.write(reinterpret_cast<const char*>(pValues), valueCount * sizeof(float));
+                file.close();
+            }
         }
 
         pValuesStagingBuffer->unmap();
-        return true;
+        return success;
+    }
+
+    void SDFGrid::setValuesFromFileInternal(const std::shared_ptr<SDFGridFile>& pFile)
+    {
+        setValuesInternal(pFile->readValues());
     }
 
     uint32_t SDFGrid::loadPrimitivesFromFile(const std::filesystem::path& path, uint32_t gridWidth, const std::filesystem::path& dir)
@@ -503,6 +574,12 @@ namespace Falcor
     {
         using namespace pybind11::literals;
 
+        FALCOR_SCRIPT_BINDING_DEPENDENCY(TriangleMesh)
+
+        pybind11::enum_<SDFMeshBaker::SignMode> signMode(m, "SDFMeshBakerSignMode");
+        signMode.value("WindingNumber", SDFMeshBaker::SignMode::WindingNumber);
+        signMode.value("RayParity", SDFMeshBaker::SignMode::RayParity);
+
         auto createSBS = [](const pybind11::kwargs& args)
         {
             uint32_t brickWidth = 7;
@@ -540,7 +617,10 @@ namespace Falcor
         sdfGrid.def_static("createSVO", [](){ return static_ref_cast<SDFGrid>(SDFSVO::create(accessActivePythonSceneBuilder().getDevice())); }); // PYTHONDEPRECATED
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "path"_a);
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
+        sdfGrid.def_static("convertValuesFileToChunked", &SDFGridFile::convertFromLegacy, "srcPath"_a, "dstPath"_a, "chunkWidth"_a = SDFGridFile::kDefaultChunkWidth);
+        sdfGrid.def_static("convertValuesFileToLegacy", &SDFGridFile::convertToLegacy, "srcPath"_a, "dstPath"_a);
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
+        sdfGrid.def("bakeMesh", pybind11::overload_cast<const TriangleMesh&, uint32_t, SDFMeshBaker::SignMode, float>(&SDFGrid::bakeMesh), "mesh"_a, "gridWidth"_a, "signMode"_a = SDFMeshBaker::SignMode::WindingNumber, "narrowBandWidth"_a = 4.f);
         sdfGrid.def_property("name", &SDFGrid::getName, &SDFGrid::setName);
     }
 
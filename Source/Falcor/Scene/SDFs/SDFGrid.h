@@ -32,6 +32,7 @@
 #include "Core/API/Texture.h"
 #include "Core/Pass/ComputePass.h"
 #include "Scene/SDFs/SDF3DPrimitiveCommon.slang"
+#include "Scene/SDFs/SDFMeshBaker.h"
 #include <memory>
 #include <vector>
 #include <utility>
@@ -41,6 +42,7 @@
 namespace Falcor
 {
     class RenderContext;
+    class SDFGridFile;
     struct ShaderVar;
 
     /** SDF grid base class, stored by distance values at grid cell/voxel corners.
@@ -124,7 +126,7 @@ namespace Falcor
         void setValues(const std::vector<float>& cornerValues, uint32_t gridWidth);
 
         /** Set the signed distance values of the SDF grid from a file.
-            \param[in] path The path of a .sdfg file.
+            \param[in] path The path of a .sdfg file or a chunked .sdfc file (see SDFGridFile).
             \return true if the values could be set, otherwise false.
         */
         bool loadValuesFromFile(const std::filesystem::path& path);
@@ -135,8 +137,29 @@ namespace Falcor
         */
         void generateCheeseValues(uint32_t gridWidth, uint32_t seed);
 
+        /** Set the signed distance values of the SDF grid by baking a triangle mesh on the CPU, see SDFMeshBaker.
+            The mesh is centered and uniformly scaled to fit into the grid.
+            \param[in] mesh The triangle mesh to bake. Should be closed and consistently oriented for the sign to be well defined.
+            \param[in] gridWidth The grid width, note that this represents the grid width in voxels, not in values.
+            \param[in] signMode Method used to determine whether a grid corner is inside the mesh.
+            \param[in] narrowBandWidth Width of the band around the surface in voxels where exact distances are computed, 0 to compute exact distances everywhere.
+            \return Transform from mesh space to the local space of the grid.
+        */
+        float4x4 bakeMesh(const TriangleMesh& mesh, uint32_t gridWidth, SDFMeshBaker::SignMode signMode = SDFMeshBaker::SignMode::WindingNumber, float narrowBandWidth = 4.f);
+
+        /** Set the signed distance values of the SDF grid by baking a triangle list given as positions and indices, see bakeMesh() above.
+            Use SceneBuilder::bakeMeshSDF() to bake a mesh that has already been added to a scene.
+            \param[in] positions Vertex positions.
+            \param[in] indices Triangle indices, three per triangle.
+            \param[in] gridWidth The grid width, note that this represents the grid width in voxels, not in values.
+            \param[in] signMode Method used to determine whether a grid corner is inside the mesh.
+            \param[in] narrowBandWidth Width of the band around the surface in voxels where exact distances are computed, 0 to compute exact distances everywhere.
+            \return Transform from mesh space to the local space of the grid.
+        */
+        float4x4 bakeMesh(const std::vector<float3>& positions, const std::vector<uint32_t>& indices, uint32_t gridWidth, SDFMeshBaker::SignMode signMode = SDFMeshBaker::SignMode::WindingNumber, float narrowBandWidth = 4.f);
+
         /** Evaluates the SDF grid primitives on to a grid and writes the grid to a file.
-            \param[in] path A path to the file that should store the values.
+            \param[in] path A path to the file that should store the values. Files with the .sdfc extension are written in the chunked format (see SDFGridFile).
             \return true if the values could be written, otherwise false.
         */
         bool writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext);
@@ -237,6 +260,13 @@ namespace Falcor
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Set the values from a chunked SDF file. The default implementation decodes and dequantizes all values.
+            Implementations can keep the file to decode it later.
+        */
+        virtual void setValuesFromFileInternal(const std::shared_ptr<SDFGridFile>& pFile);
+
+        float4x4 bakeMesh(const SDFMeshBaker& baker, uint32_t gridWidth, SDFMeshBaker::SignMode signMode, float narrowBandWidth);
+
         void createEvaluatePrimitivesPass(bool writeToTexture3D, bool mergeWithSDField);
 
         void updatePrimitivesBuffer();
@@ -0,0 +1,447 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFGridFile.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/MathConstants.slangh"
+#include "Utils/StringFormatters.h"
+#include <lz4.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x43464453; // 'SDFC'
+        const uint32_t kVersion = 1;
+        const uint32_t kMaxChunkWidth = 255;
+
+        enum class ChunkEncoding : uint8_t
+        {
+            Constant = 0,   ///< All values are equal to minValue, no payload.
+            Delta = 1,      ///< Values delta encoded along x.
+            DeltaLZ4 = 2,   ///< Values delta encoded along x and LZ4 compressed.
+        };
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t gridWidth;
+            uint32_t chunkWidth;
+            uint32_t chunkCount;
+            uint32_t reserved;
+            uint64_t indexOffset;
+        };
+
+        static_assert(sizeof(SDFGridFile::Chunk) == 16);
+
+        /** Quantize a distance value, identical to SDFSBS::setValuesInternal().
+        */
+        int8_t quantize(float value, float normalizationFactor)
+        {
+            float normalizedValue = std::clamp(value * normalizationFactor, -1.0f, 1.0f);
+            float integerScale = normalizedValue * float(INT8_MAX);
+            return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+        }
+
+        uint3 computeChunkOrigin(uint32_t chunkIndex, uint32_t chunksPerAxis, uint32_t chunkWidth)
+        {
+            return uint3(chunkIndex % chunksPerAxis, (chunkIndex / chunksPerAxis) % chunksPerAxis, chunkIndex / (chunksPerAxis * chunksPerAxis)) * chunkWidth;
+        }
+
+        uint3 computeChunkValueCount(const uint3& origin, uint32_t gridWidth, uint32_t chunkWidth)
+        {
+            return min(uint3(chunkWidth), uint3(gridWidth) - origin) + 1u;
+        }
+
+        /** Encode the values of a chunk.
+            \param[in] pValues All corner values of the grid.
+            \param[out] chunk Chunk description, the offset is not set.
+            \param[out] payload Encoded payload.
+        */
+        void encodeChunk(const float* pValues, uint32_t gridWidth, const uint3& origin, const uint3& valueCount, float normalizationFactor, SDFGridFile::Chunk& chunk, std::vector<uint8_t>& payload)
+        {
+            const size_t gridWidthInValues = gridWidth + 1;
+            std::vector<int8_t> deltas(valueCount.x * valueCount.y * valueCount.z);
+
+            int8_t minValue = INT8_MAX;
+            int8_t maxValue = INT8_MIN;
+            size_t i = 0;
+            for (uint32_t z = 0; z < valueCount.z; ++z)
+            {
+                for (uint32_t y = 0; y < valueCount.y; ++y)
+                {
+                    const float* pRow = pValues + origin.x + gridWidthInValues * ((origin.y + y) + gridWidthInValues * (origin.z + z));
+                    int8_t prev = 0;
+                    for (uint32_t x = 0; x < valueCount.x; ++x)
+                    {
+                        int8_t value = quantize(pRow[x], normalizationFactor);
+                        minValue = std::min(minValue, value);
+                        maxValue = std::max(maxValue, value);
+                        deltas[i++] = int8_t(uint8_t(value) - uint8_t(prev));
+                        prev = value;
+                    }
+                }
+            }
+
+            chunk.minValue = minValue;
+            chunk.maxValue = maxValue;
+            payload.clear();
+
+            if (minValue == maxValue)
+            {
+                chunk.encoding = (uint8_t)ChunkEncoding::Constant;
+                chunk.size = 0;
+                return;
+            }
+
+            payload.resize(LZ4_compressBound((int)deltas.size()));
+            int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(deltas.data()), reinterpret_cast<char*>(payload.data()), (int)deltas.size(), (int)payload.size());
+            if (compressedSize > 0 && (size_t)compressedSize < deltas.size())
+            {
+                chunk.encoding = (uint8_t)ChunkEncoding::DeltaLZ4;
+                payload.resize(compressedSize);
+            }
+            else
+            {
+                chunk.encoding = (uint8_t)ChunkEncoding::Delta;
+                payload.assign(reinterpret_cast<const uint8_t*>(deltas.data()), reinterpret_cast<const uint8_t*>(deltas.data()) + deltas.size());
+            }
+            chunk.size = (uint32_t)payload.size();
+        }
+    }
+
+    SDFGridFile::SDFGridFile(const std::filesystem::path& path)
+    {
+        if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        {
+            throw RuntimeError("Failed to open SDF grid file '{}'.", path);
+        }
+
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(mFile.getData());
+        const size_t fileSize = mFile.getMappedSize();
+
+        FileHeader header;
+        if (fileSize < sizeof(header)) throw RuntimeError("SDF grid file '{}' is truncated.", path);
+        std::memcpy(&header, pData, sizeof(header));
+        if (header.magic != kMagic || header.version != kVersion || header.gridWidth == 0 || header.chunkWidth == 0 || header.chunkWidth > kMaxChunkWidth)
+        {
+            throw RuntimeError("SDF grid file '{}' has an invalid header.", path);
+        }
+
+        mGridWidth = header.gridWidth;
+        mChunkWidth = header.chunkWidth;
+        mChunksPerAxis = (mGridWidth + mChunkWidth - 1) / mChunkWidth;
+        if (header.chunkCount != mChunksPerAxis * mChunksPerAxis * mChunksPerAxis ||
+            header.indexOffset < sizeof(header) || header.indexOffset + (uint64_t)header.chunkCount * sizeof(Chunk) > fileSize)
+        {
+            throw RuntimeError("SDF grid file '{}' has an invalid chunk index.", path);
+        }
+
+        mChunks.resize(header.chunkCount);
+        std::memcpy(mChunks.data(), pData + header.indexOffset, mChunks.size() * sizeof(Chunk));
+
+        for (uint32_t chunkIndex = 0; chunkIndex < header.chunkCount; ++chunkIndex)
+        {
+            const Chunk& chunk = mChunks[chunkIndex];
+            const uint3 valueCount = getChunkValueCount(chunkIndex);
+            const size_t maxSize = (size_t)valueCount.x * valueCount.y * valueCount.z;
+            bool valid = chunk.minValue <= chunk.maxValue && chunk.offset >= sizeof(header) && chunk.offset + chunk.size <= header.indexOffset;
+            switch ((ChunkEncoding)chunk.encoding)
+            {
+            case ChunkEncoding::Constant: valid &= chunk.minValue == chunk.maxValue; break;
+            case ChunkEncoding::Delta: valid &= chunk.size == maxSize; break;
+            case ChunkEncoding::DeltaLZ4: valid &= chunk.size < maxSize; break;
+            default: valid = false;
+            }
+            if (!valid) throw RuntimeError("SDF grid file '{}' has an invalid chunk {}.", path, chunkIndex);
+            if (!isChunkEmpty(chunkIndex)) ++mNonEmptyChunkCount;
+        }
+    }
+
+    bool SDFGridFile::isChunkedFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        uint32_t magic = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        return file.good() && magic == kMagic;
+    }
+
+    void SDFGridFile::write(const std::filesystem::path& path, const float* pCornerValues, uint32_t gridWidth, uint32_t chunkWidth)
+    {
+        checkArgument(gridWidth > 0, "'gridWidth' must be larger than 0.");
+        checkArgument(chunkWidth > 0 && chunkWidth <= kMaxChunkWidth, "'chunkWidth' ({}) must be in the range [1, {}].", chunkWidth, kMaxChunkWidth);
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        if (!file.is_open()) throw RuntimeError("Failed to create SDF grid file '{}'.", path);
+
+        const uint32_t chunksPerAxis = (gridWidth + chunkWidth - 1) / chunkWidth;
+        const uint32_t chunksPerSlab = chunksPerAxis * chunksPerAxis;
+        const float normalizationFactor = 1.f / getMaxDistance(gridWidth);
+
+        FileHeader header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.gridWidth = gridWidth;
+        header.chunkWidth = chunkWidth;
+        header.chunkCount = chunksPerSlab * chunksPerAxis;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t offset = sizeof(header);
+
+        // Encode one slab of chunks along z at a time in parallel, which bounds the memory used for payloads.
+        std::vector<Chunk> chunks(header.chunkCount);
+        std::vector<std::vector<uint8_t>> payloads(chunksPerSlab);
+        for (uint32_t slab = 0; slab < chunksPerAxis; ++slab)
+        {
+            auto range = NumericRange<uint32_t>(0, chunksPerSlab);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i) {
+                const uint32_t chunkIndex = slab * chunksPerSlab + i;
+                const uint3 origin = computeChunkOrigin(chunkIndex, chunksPerAxis, chunkWidth);
+                encodeChunk(pCornerValues, gridWidth, origin, computeChunkValueCount(origin, gridWidth, chunkWidth), normalizationFactor, chunks[chunkIndex], payloads[i]);
+            });
+
+            for (uint32_t i = 0; i < chunksPerSlab; ++i)
+            {
+                Chunk& chunk = chunks[slab * chunksPerSlab + i];
+                chunk.offset = offset;
+                file.write(reinterpret_cast<const char*>(payloads[i].data()), payloads[i].size());
+                offset += payloads[i].size();
+            }
+        }
+
+        header.indexOffset = offset;
+        file.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(Chunk));
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.close();
+
+        if (file.fail()) throw RuntimeError("Failed to write SDF grid file '{}'.", path);
+    }
+
+    void SDFGridFile::convertFromLegacy(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, uint32_t chunkWidth)
+    {
+        MemoryMappedFile src(srcPath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!src.isOpen()) throw RuntimeError("Failed to open SDF grid file '{}'.", srcPath);
+
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(src.getData());
+        uint32_t gridWidth = 0;
+        if (src.getMappedSize() >= sizeof(uint32_t)) std::memcpy(&gridWidth, pData, sizeof(uint32_t));
+        const size_t valueCount = (size_t)(gridWidth + 1) * (gridWidth + 1) * (gridWidth + 1);
+        if (gridWidth == 0 || src.getMappedSize() < sizeof(uint32_t) + valueCount * sizeof(float))
+        {
+            throw RuntimeError("SDF grid file '{}' is truncated or invalid.", srcPath);
+        }
+
+        write(dstPath, reinterpret_cast<const float*>(pData + sizeof(uint32_t)), gridWidth, chunkWidth);
+    }
+
+    void SDFGridFile::convertToLegacy(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath)
+    {
+        SDFGridFile src(srcPath);
+        const uint32_t gridWidth = src.getGridWidth();
+        const uint32_t gridWidthInValues = gridWidth + 1;
+        const float scale = getMaxDistance(gridWidth) / float(INT8_MAX);
+
+        // Decode one slab of chunks and dequantize one z-plane at a time to avoid holding all values.
+        std::vector<float> plane((size_t)gridWidthInValues * gridWidthInValues);
+        std::vector<int8_t> slab;
+
+        std::ofstream file(dstPath, std::ios::out | std::ios::binary);
+        if (!file.is_open()) throw RuntimeError("Failed to create SDF grid file '{}'.", dstPath);
+        file.write(reinterpret_cast<const char*>(&gridWidth), sizeof(uint32_t));
+        for (uint32_t slabIndex = 0; slabIndex < src.getChunksPerAxis(); ++slabIndex)
+        {
+            const uint32_t planeCount = src.getSlabPlaneCount(slabIndex);
+            slab.resize(plane.size() * planeCount);
+            src.readQuantizedSlab(slabIndex, slab.data());
+            for (uint32_t z = 0; z < planeCount; ++z)
+            {
+                const int8_t* pPlane = slab.data() + z * plane.size();
+                for (size_t i = 0; i < plane.size(); ++i) plane[i] = pPlane[i] * scale;
+                file.write(reinterpret_cast<const char*>(plane.data()), plane.size() * sizeof(float));
+            }
+        }
+        file.close();
+
+        if (file.fail()) throw RuntimeError("Failed to write SDF grid file '{}'.", dstPath);
+    }
+
+    float SDFGridFile::getMaxDistance(uint32_t gridWidth)
+    {
+        // Matches the normalization in SDFSBS: the grid spans [-1, 1] and distances are normalized by the diagonal.
+        return float(M_SQRT3) / (2.0f * gridWidth);
+    }
+
+    bool SDFGridFile::isChunkEmpty(uint32_t chunkIndex) const
+    {
+        const Chunk& chunk = mChunks[chunkIndex];
+        return chunk.minValue == chunk.maxValue && (chunk.minValue == INT8_MAX || chunk.minValue == -INT8_MAX);
+    }
+
+    uint3 SDFGridFile::getChunkOrigin(uint32_t chunkIndex) const
+    {
+        return computeChunkOrigin(chunkIndex, mChunksPerAxis, mChunkWidth);
+    }
+
+    uint3 SDFGridFile::getChunkValueCount(uint32_t chunkIndex) const
+    {
+        return computeChunkValueCount(getChunkOrigin(chunkIndex), mGridWidth, mChunkWidth);
+    }
+
+    void SDFGridFile::readChunk(uint32_t chunkIndex, int8_t* pDst) const
+    {
+        FALCOR_ASSERT(chunkIndex < mChunks.size());
+        const Chunk& chunk = mChunks[chunkIndex];
+        const uint3 valueCount = getChunkValueCount(chunkIndex);
+        const size_t totalCount = (size_t)valueCount.x * valueCount.y * valueCount.z;
+        const char* pPayload = reinterpret_cast<const char*>(mFile.getData()) + chunk.offset;
+
+        switch ((ChunkEncoding)chunk.encoding)
+        {
+        case ChunkEncoding::Constant:
+            std::memset(pDst, chunk.minValue, totalCount);
+            return;
+        case ChunkEncoding::Delta:
+            std::memcpy(pDst, pPayload, totalCount);
+            break;
+        case ChunkEncoding::DeltaLZ4:
+            if (LZ4_decompress_safe(pPayload, reinterpret_cast<char*>(pDst), (int)chunk.size, (int)totalCount) != (int)totalCount)
+            {
+                throw RuntimeError("Failed to decompress SDF grid chunk {}.", chunkIndex);
+            }
+            break;
+        default:
+            FALCOR_UNREACHABLE();
+        }
+
+        for (size_t row = 0; row < totalCount; row += valueCount.x)
+        {
+            uint8_t value = 0;
+            for (uint32_t x = 0; x < valueCount.x; ++x)
+            {
+                value += uint8_t(pDst[row + x]);
+                pDst[row + x] = int8_t(value);
+            }
+        }
+    }
+
+    uint32_t SDFGridFile::getSlabPlaneCount(uint32_t slabIndex) const
+    {
+        FALCOR_ASSERT(slabIndex < mChunksPerAxis);
+        return slabIndex + 1 == mChunksPerAxis ? mGridWidth + 1 - slabIndex * mChunkWidth : mChunkWidth;
+    }
+
+    void SDFGridFile::readQuantizedSlab(uint32_t slabIndex, int8_t* pDst) const
+    {
+        FALCOR_ASSERT(slabIndex < mChunksPerAxis);
+        const size_t gridWidthInValues = mGridWidth + 1;
+        const uint32_t chunksPerSlab = mChunksPerAxis * mChunksPerAxis;
+        const uint32_t slabOrigin = slabIndex * mChunkWidth;
+
+        // Exceptions must not escape the parallel loop. The first error is recorded and thrown after it.
+        std::atomic<bool> failed{false};
+        std::string error;
+
+        auto range = NumericRange<uint32_t>(slabIndex * chunksPerSlab, (slabIndex + 1) * chunksPerSlab);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t chunkIndex) {
+            if (failed.load(std::memory_order_relaxed)) return;
+
+            const Chunk& chunk = mChunks[chunkIndex];
+            const uint3 origin = getChunkOrigin(chunkIndex);
+            const uint3 valueCount = getChunkValueCount(chunkIndex);
+
+            // Neighboring chunks share their boundary values, each chunk only writes the values up to its far boundary
+            // unless it is the last chunk along an axis.
+            const uint3 ownedCount = uint3(
+                origin.x + valueCount.x == gridWidthInValues ? valueCount.x : valueCount.x - 1,
+                origin.y + valueCount.y == gridWidthInValues ? valueCount.y : valueCount.y - 1,
+                origin.z + valueCount.z == gridWidthInValues ? valueCount.z : valueCount.z - 1
+            );
+
+            std::vector<int8_t> chunkValues;
+            if ((ChunkEncoding)chunk.encoding != ChunkEncoding::Constant)
+            {
+                chunkValues.resize((size_t)valueCount.x * valueCount.y * valueCount.z);
+                try
+                {
+                    readChunk(chunkIndex, chunkValues.data());
+                }
+                catch (const std::exception& e)
+                {
+                    if (!failed.exchange(true)) error = e.what();
+                    return;
+                }
+            }
+
+            for (uint32_t z = 0; z < ownedCount.z; ++z)
+            {
+                for (uint32_t y = 0; y < ownedCount.y; ++y)
+                {
+                    int8_t* pRow = pDst + origin.x + gridWidthInValues * ((origin.y + y) + gridWidthInValues * (origin.z - slabOrigin + z));
+                    if (chunkValues.empty()) std::memset(pRow, chunk.minValue, ownedCount.x);
+                    else std::memcpy(pRow, chunkValues.data() + valueCount.x * (y + valueCount.y * z), ownedCount.x);
+                }
+            }
+        });
+
+        if (failed) throw RuntimeError("{}", error);
+    }
+
+    std::vector<int8_t> SDFGridFile::readQuantizedValues() const
+    {
+        const size_t gridWidthInValues = mGridWidth + 1;
+        const size_t planeSize = gridWidthInValues * gridWidthInValues;
+        std::vector<int8_t> values(planeSize * gridWidthInValues);
+
+        for (uint32_t slabIndex = 0; slabIndex < mChunksPerAxis; ++slabIndex)
+        {
+            readQuantizedSlab(slabIndex, values.data() + planeSize * slabIndex * mChunkWidth);
+        }
+
+        return values;
+    }
+
+    std::vector<float> SDFGridFile::readValues() const
+    {
+        std::vector<int8_t> quantizedValues = readQuantizedValues();
+        std::vector<float> values(quantizedValues.size());
+
+        const float scale = getMaxDistance(mGridWidth) / float(INT8_MAX);
+        std::transform(std::execution::par, quantizedValues.begin(), quantizedValues.end(), values.begin(), [scale](int8_t value) { return value * scale; });
+
+        return values;
+    }
+}
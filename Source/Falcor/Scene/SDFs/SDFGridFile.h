@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+    /** Chunked, compressed SDF grid value file (.sdfc).
+
+        The grid corner values are quantized to int8, using the same normalization as the SBS grid, and split into
+        chunks of chunkWidth^3 voxels. Each chunk stores the (chunkWidth + 1)^3 corner values it touches, so chunks
+        can be decoded independently. Chunks that are entirely clamped to the same far-field value are stored as
+        constants without payload; all other chunks are delta encoded along x and LZ4 compressed.
+        Per-chunk minimum and maximum values allow empty space to be skipped without decoding.
+
+        The file is read through a memory mapping and chunks are decoded in parallel. Values can be decoded one slab of chunks
+        (one chunk along z) at a time to avoid holding the whole grid in memory.
+
+        The legacy .sdfg format is a uint32_t grid width followed by (gridWidth + 1)^3 floats.
+    */
+    class FALCOR_API SDFGridFile
+    {
+    public:
+        static constexpr uint32_t kDefaultChunkWidth = 16;
+
+        struct Chunk
+        {
+            uint64_t offset = 0;        ///< Byte offset of the payload in the file.
+            uint32_t size = 0;          ///< Payload size in bytes, 0 for constant chunks.
+            uint8_t encoding = 0;       ///< Payload encoding, see ChunkEncoding in the implementation.
+            int8_t minValue = 0;        ///< Minimum quantized value in the chunk.
+            int8_t maxValue = 0;        ///< Maximum quantized value in the chunk.
+            uint8_t reserved = 0;
+        };
+
+        /** Open a chunked SDF file. Throws an exception if the file is invalid.
+        */
+        SDFGridFile(const std::filesystem::path& path);
+
+        /** Check if a file is a chunked SDF file.
+        */
+        static bool isChunkedFile(const std::filesystem::path& path);
+
+        /** Write corner values to a chunked SDF file. Throws an exception if the file cannot be written.
+            \param[in] path File path.
+            \param[in] pCornerValues Corner values, (gridWidth + 1)^3 values ordered x first.
+            \param[in] gridWidth Grid width in voxels.
+            \param[in] chunkWidth Chunk width in voxels.
+        */
+        static void write(const std::filesystem::path& path, const float* pCornerValues, uint32_t gridWidth, uint32_t chunkWidth = kDefaultChunkWidth);
+
+        /** Convert a legacy .sdfg file to a chunked SDF file. The source file is memory mapped and processed one slab of chunks at a time.
+        */
+        static void convertFromLegacy(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, uint32_t chunkWidth = kDefaultChunkWidth);
+
+        /** Convert a chunked SDF file to a legacy .sdfg file. Values are dequantized.
+        */
+        static void convertToLegacy(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath);
+
+        /** Get the largest distance that can be represented for a grid width. Larger distances are clamped.
+        */
+        static float getMaxDistance(uint32_t gridWidth);
+
+        uint32_t getGridWidth() const { return mGridWidth; }
+        uint32_t getChunkWidth() const { return mChunkWidth; }
+        uint32_t getChunksPerAxis() const { return mChunksPerAxis; }
+        uint32_t getChunkCount() const { return (uint32_t)mChunks.size(); }
+        const Chunk& getChunk(uint32_t chunkIndex) const { return mChunks[chunkIndex]; }
+
+        /** Get the number of chunks that are not entirely clamped, i.e., chunks that can contain the surface.
+        */
+        uint32_t getNonEmptyChunkCount() const { return mNonEmptyChunkCount; }
+
+        /** Check if a chunk is entirely clamped to the same far-field value.
+        */
+        bool isChunkEmpty(uint32_t chunkIndex) const;
+
+        /** Get the voxel coordinates of the first corner of a chunk.
+        */
+        uint3 getChunkOrigin(uint32_t chunkIndex) const;
+
+        /** Get the number of corner values per axis stored in a chunk. Chunks at the far grid boundary can be smaller.
+        */
+        uint3 getChunkValueCount(uint32_t chunkIndex) const;
+
+        /** Decode the quantized corner values of a chunk.
+            \param[in] chunkIndex Chunk index.
+            \param[out] pDst Destination for getChunkValueCount() values, ordered x first.
+        */
+        void readChunk(uint32_t chunkIndex, int8_t* pDst) const;
+
+        /** Get the number of z-planes of corner values owned by a slab of chunks. Neighboring slabs share their boundary
+            plane, which is owned by the slab above it, except for the last slab.
+        */
+        uint32_t getSlabPlaneCount(uint32_t slabIndex) const;
+
+        /** Decode the quantized corner values of one slab of chunks in parallel. The quantization matches SDFSBS.
+            Throws an exception if a chunk cannot be decoded.
+            \param[in] slabIndex Chunk index along z.
+            \param[out] pDst Destination for (gridWidth + 1)^2 * getSlabPlaneCount() values, starting at z-plane slabIndex * chunkWidth, ordered x first.
+        */
+        void readQuantizedSlab(uint32_t slabIndex, int8_t* pDst) const;
+
+        /** Decode all quantized corner values in parallel. The quantization matches SDFSBS.
+            \return (gridWidth + 1)^3 values ordered x first.
+        */
+        std::vector<int8_t> readQuantizedValues() const;
+
+        /** Decode all corner values in parallel and dequantize them.
+            \return (gridWidth + 1)^3 values ordered x first.
+        */
+        std::vector<float> readValues() const;
+
+    private:
+        MemoryMappedFile mFile;
+        uint32_t mGridWidth = 0;
+        uint32_t mChunkWidth = 0;
+        uint32_t mChunksPerAxis = 0;
+        uint32_t mNonEmptyChunkCount = 0;
+        std::vector<Chunk> mChunks;
+    };
+}
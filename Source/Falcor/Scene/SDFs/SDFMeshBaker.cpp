@@ -0,0 +1,476 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFMeshBaker.h"
+#include "Core/Errors.h"
+#include "Scene/TriangleMesh.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDF_MESH_BAKER_SSE 1
+#include <emmintrin.h>
+#else
+#define SDF_MESH_BAKER_SSE 0
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kLeafSize = 4;           ///< Maximum number of triangles per leaf, matches the SIMD width.
+        const uint32_t kMaxStackDepth = 64;
+        const float kDipoleAccuracy = 2.f;      ///< Nodes further away than this many times their radius are approximated by a dipole.
+        const float kSkipVoxels = 8.f;          ///< Extra search radius in voxels, used to skip distance queries outside the narrow band.
+        const float kInvFourPi = 0.25f / (float)M_PI;
+
+        std::vector<float3> getPositions(const TriangleMesh& mesh)
+        {
+            std::vector<float3> positions;
+            positions.reserve(mesh.getVertices().size());
+            for (const auto& vertex : mesh.getVertices()) positions.push_back(vertex.position);
+            return positions;
+        }
+
+        float boxDistance2(const float3& p, const float3& boundsMin, const float3& boundsMax)
+        {
+            float3 d = max(max(boundsMin - p, p - boundsMax), float3(0.f));
+            return dot(d, d);
+        }
+
+        /** Signed solid angle of a triangle given relative to the query point (Van Oosterom and Strackee).
+        */
+        float solidAngle(const float3& a, const float3& b, const float3& c)
+        {
+            float la = length(a);
+            float lb = length(b);
+            float lc = length(c);
+            float det = dot(a, cross(b, c));
+            float denom = la * lb * lc + dot(a, b) * lc + dot(b, c) * la + dot(c, a) * lb;
+            return 2.f * std::atan2(det, denom);
+        }
+    }
+
+    SDFMeshBaker::SDFMeshBaker(const std::vector<float3>& positions, const std::vector<uint32_t>& indices)
+    {
+        checkArgument(indices.size() % 3 == 0, "'indices' size ({}) must be a multiple of 3.", indices.size());
+        checkArgument(!indices.empty(), "Mesh has no triangles.");
+
+        std::vector<Triangle> triangles(indices.size() / 3);
+        std::vector<float3> centroids(triangles.size());
+        for (size_t i = 0; i < triangles.size(); ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                checkArgument(indices[i * 3 + j] < positions.size(), "Triangle {} references vertex {} out of range.", i, indices[i * 3 + j]);
+            }
+            auto& triangle = triangles[i];
+            triangle.v0 = positions[indices[i * 3 + 0]];
+            triangle.v1 = positions[indices[i * 3 + 1]];
+            triangle.v2 = positions[indices[i * 3 + 2]];
+            centroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) / 3.f;
+            mBounds.include(triangle.v0).include(triangle.v1).include(triangle.v2);
+        }
+
+        std::vector<uint32_t> order(triangles.size());
+        std::iota(order.begin(), order.end(), 0);
+        mNodes.reserve(2 * (triangles.size() / kLeafSize + 1));
+        mTriangles.reserve(triangles.size());
+        buildNode(order, 0, (uint32_t)order.size(), triangles, centroids);
+    }
+
+    SDFMeshBaker::SDFMeshBaker(const TriangleMesh& mesh)
+        : SDFMeshBaker(getPositions(mesh), mesh.getIndices())
+    {}
+
+    SDFMeshBaker::Result SDFMeshBaker::bake(const Options& options) const
+    {
+        checkArgument(options.gridWidth > 0, "'gridWidth' must be larger than 0.");
+        checkArgument(options.narrowBandWidth >= 0.f, "'narrowBandWidth' ({}) must not be negative.", options.narrowBandWidth);
+
+        // Fit the mesh bounds into the grid, leaving the requested padding.
+        const float usableWidth = 1.f - 2.f * options.padding / options.gridWidth;
+        checkArgument(options.padding >= 0.f && usableWidth > 0.f, "'padding' ({}) is invalid for a grid width of {}.", options.padding, options.gridWidth);
+        const float3 extent = mBounds.extent();
+        const float scale = usableWidth / std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-20f));
+        const float3 center = mBounds.center();
+
+        Result result;
+        result.gridWidth = options.gridWidth;
+        result.meshToGrid = mul(math::matrixFromScaling(float3(scale)), math::matrixFromTranslation(-center));
+
+        const uint32_t valuesPerRow = options.gridWidth + 1;
+        result.values.resize((size_t)valuesPerRow * valuesPerRow * valuesPerRow);
+
+        auto rows = NumericRange<uint32_t>(0, valuesPerRow * valuesPerRow);
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t row) {
+            bakeRow(options, scale, center, row % valuesPerRow, row / valuesPerRow, result.values.data() + (size_t)row * valuesPerRow);
+        });
+
+        return result;
+    }
+
+    float SDFMeshBaker::getDistance(const float3& p, float maxDistance) const
+    {
+        float best2 = maxDistance * maxDistance;
+
+        uint32_t stack[kMaxStackDepth];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            uint32_t nodeIndex = stack[--stackSize];
+            const Node& node = mNodes[nodeIndex];
+            if (boxDistance2(p, node.boundsMin, node.boundsMax) >= best2) continue;
+
+            if (node.triangleCount > 0)
+            {
+                best2 = std::min(best2, getPacketDistance2(mPackets[node.secondChild], p));
+                continue;
+            }
+
+            // Push the closer child last so it is visited first.
+            uint32_t first = nodeIndex + 1;
+            uint32_t second = node.secondChild;
+            float firstDistance2 = boxDistance2(p, mNodes[first].boundsMin, mNodes[first].boundsMax);
+            float secondDistance2 = boxDistance2(p, mNodes[second].boundsMin, mNodes[second].boundsMax);
+            if (firstDistance2 > secondDistance2) std::swap(first, second);
+            FALCOR_ASSERT(stackSize + 2 <= kMaxStackDepth);
+            stack[stackSize++] = second;
+            stack[stackSize++] = first;
+        }
+
+        return std::sqrt(best2);
+    }
+
+    float SDFMeshBaker::getWindingNumber(const float3& p) const
+    {
+        float solidAngleSum = 0.f;
+
+        uint32_t stack[kMaxStackDepth];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            uint32_t nodeIndex = stack[--stackSize];
+            const Node& node = mNodes[nodeIndex];
+
+            float3 d = node.centroid - p;
+            float distance2 = dot(d, d);
+            if (distance2 > kDipoleAccuracy * kDipoleAccuracy * node.radius * node.radius)
+            {
+                solidAngleSum += dot(node.areaNormal, d) / (distance2 * std::sqrt(distance2));
+            }
+            else if (node.triangleCount > 0)
+            {
+                for (uint32_t i = 0; i < node.triangleCount; ++i)
+                {
+                    const Triangle& triangle = mTriangles[node.firstTriangle + i];
+                    solidAngleSum += solidAngle(triangle.v0 - p, triangle.v1 - p, triangle.v2 - p);
+                }
+            }
+            else
+            {
+                FALCOR_ASSERT(stackSize + 2 <= kMaxStackDepth);
+                stack[stackSize++] = node.secondChild;
+                stack[stackSize++] = nodeIndex + 1;
+            }
+        }
+
+        return solidAngleSum * kInvFourPi;
+    }
+
+    uint32_t SDFMeshBaker::buildNode(std::vector<uint32_t>& order, uint32_t begin, uint32_t end, const std::vector<Triangle>& triangles, const std::vector<float3>& centroids)
+    {
+        const uint32_t nodeIndex = (uint32_t)mNodes.size();
+        mNodes.emplace_back();
+
+        AABB bounds;
+        AABB centroidBounds;
+        float3 areaNormal(0.f);
+        float3 weightedCentroid(0.f);
+        float area = 0.f;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const Triangle& triangle = triangles[order[i]];
+            bounds.include(triangle.v0).include(triangle.v1).include(triangle.v2);
+            centroidBounds.include(centroids[order[i]]);
+            float3 normal = 0.5f * cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0);
+            float triangleArea = length(normal);
+            areaNormal += normal;
+            weightedCentroid += triangleArea * centroids[order[i]];
+            area += triangleArea;
+        }
+
+        Node node;
+        node.boundsMin = bounds.minPoint;
+        node.boundsMax = bounds.maxPoint;
+        node.areaNormal = areaNormal;
+        node.centroid = area > 0.f ? weightedCentroid / area : bounds.center();
+        node.radius = length(max(abs(bounds.minPoint - node.centroid), abs(bounds.maxPoint - node.centroid)));
+
+        const uint32_t count = end - begin;
+        if (count <= kLeafSize)
+        {
+            node.firstTriangle = (uint32_t)mTriangles.size();
+            node.triangleCount = count;
+            node.secondChild = (uint32_t)mPackets.size();
+
+            // Unused lanes repeat the last triangle so they never change the minimum.
+            TrianglePacket packet = {};
+            for (uint32_t lane = 0; lane < kLeafSize; ++lane)
+            {
+                const Triangle& triangle = triangles[order[begin + std::min(lane, count - 1)]];
+                if (lane < count) mTriangles.push_back(triangle);
+
+                const float3 ba = triangle.v1 - triangle.v0;
+                const float3 cb = triangle.v2 - triangle.v1;
+                const float3 ac = triangle.v0 - triangle.v2;
+                const float3 nor = cross(ba, ac);
+                const float3 edges[3] = { ba, cb, ac };
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    packet.a[k][lane] = triangle.v0[k];
+                    packet.ba[k][lane] = ba[k];
+                    packet.cb[k][lane] = cb[k];
+                    packet.ac[k][lane] = ac[k];
+                    packet.nor[k][lane] = nor[k];
+                }
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    const float3 edgeNormal = cross(edges[e], nor);
+                    for (uint32_t k = 0; k < 3; ++k) packet.edgeNormal[e][k][lane] = edgeNormal[k];
+                    packet.invEdgeLength2[e][lane] = 1.f / std::max(dot(edges[e], edges[e]), 1e-30f);
+                }
+                packet.invNorLength2[lane] = 1.f / std::max(dot(nor, nor), 1e-30f);
+            }
+            mPackets.push_back(packet);
+            mNodes[nodeIndex] = node;
+            return nodeIndex;
+        }
+
+        // Split at the median centroid along the largest axis.
+        const float3 centroidExtent = centroidBounds.extent();
+        const int axis = centroidExtent.x >= centroidExtent.y ? (centroidExtent.x >= centroidExtent.z ? 0 : 2) : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+        const uint32_t mid = begin + count / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+            [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        mNodes[nodeIndex] = node;
+        buildNode(order, begin, mid, triangles, centroids);
+        const uint32_t secondChild = buildNode(order, mid, end, triangles, centroids);
+        mNodes[nodeIndex].secondChild = secondChild;
+        return nodeIndex;
+    }
+
+    void SDFMeshBaker::bakeRow(const Options& options, float scale, const float3& center, uint32_t y, uint32_t z, float* pValues) const
+    {
+        const float kInf = std::numeric_limits<float>::infinity();
+        const uint32_t gridWidth = options.gridWidth;
+        const float voxelSize = 1.f / (gridWidth * scale);
+        const float band = options.narrowBandWidth > 0.f ? options.narrowBandWidth * voxelSize : kInf;
+        const float searchRadius = band + kSkipVoxels * voxelSize;
+
+        auto toMesh = [&](uint32_t i, uint32_t axis) { return ((float)i / gridWidth - 0.5f) / scale + center[axis]; };
+        const float py = toMesh(y, 1);
+        const float pz = toMesh(z, 2);
+
+        // For ray parity, intersect the whole row once. The ray is offset by a small irrational fraction of a voxel to avoid hitting edges and vertices exactly.
+        std::vector<float> crossings;
+        size_t nextCrossing = 0;
+        if (options.signMode == SignMode::RayParity)
+        {
+            getRowCrossings(py + 0.0012345f * voxelSize, pz + 0.0017320f * voxelSize, crossings);
+            std::sort(crossings.begin(), crossings.end());
+        }
+
+        float lowerBound = 0.f;
+        float prevDistance = 0.f;
+        bool prevInside = false;
+        for (uint32_t x = 0; x <= gridWidth; ++x)
+        {
+            const float3 p(toMesh(x, 0), py, pz);
+
+            // The distance field is 1-Lipschitz, so a query returning no triangle within the search radius
+            // proves that the next corners are outside the band as well.
+            float distance;
+            if (lowerBound >= band)
+            {
+                distance = band;
+            }
+            else
+            {
+                distance = getDistance(p, searchRadius);
+                lowerBound = distance;
+            }
+            lowerBound -= voxelSize;
+
+            bool inside;
+            if (options.signMode == SignMode::RayParity)
+            {
+                while (nextCrossing < crossings.size() && crossings[nextCrossing] <= p.x) ++nextCrossing;
+                inside = ((crossings.size() - nextCrossing) & 1) != 0;
+            }
+            else if (x > 0 && prevDistance > 0.5f * voxelSize && distance > 0.5f * voxelSize)
+            {
+                // The surface cannot lie between two corners that are both more than half a voxel away from it.
+                inside = prevInside;
+            }
+            else
+            {
+                inside = std::abs(getWindingNumber(p)) >= 0.5f;
+            }
+
+            pValues[x] = (inside ? -1.f : 1.f) * std::min(distance, band) * scale;
+            prevDistance = distance;
+            prevInside = inside;
+        }
+    }
+
+    void SDFMeshBaker::getRowCrossings(float y, float z, std::vector<float>& crossings) const
+    {
+        crossings.clear();
+
+        uint32_t stack[kMaxStackDepth];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            uint32_t nodeIndex = stack[--stackSize];
+            const Node& node = mNodes[nodeIndex];
+            if (y < node.boundsMin.y || y > node.boundsMax.y || z < node.boundsMin.z || z > node.boundsMax.z) continue;
+
+            if (node.triangleCount == 0)
+            {
+                FALCOR_ASSERT(stackSize + 2 <= kMaxStackDepth);
+                stack[stackSize++] = node.secondChild;
+                stack[stackSize++] = nodeIndex + 1;
+                continue;
+            }
+
+            for (uint32_t i = 0; i < node.triangleCount; ++i)
+            {
+                // Point in triangle test in the yz-plane. The edge functions are the barycentric weights of the opposite vertices.
+                const Triangle& t = mTriangles[node.firstTriangle + i];
+                auto edge = [&](const float3& a, const float3& b) { return (b.y - a.y) * (z - a.z) - (b.z - a.z) * (y - a.y); };
+                float w0 = edge(t.v1, t.v2);
+                float w1 = edge(t.v2, t.v0);
+                float w2 = edge(t.v0, t.v1);
+                if ((w0 > 0.f && w1 > 0.f && w2 > 0.f) || (w0 < 0.f && w1 < 0.f && w2 < 0.f))
+                {
+                    crossings.push_back((w0 * t.v0.x + w1 * t.v1.x + w2 * t.v2.x) / (w0 + w1 + w2));
+                }
+            }
+        }
+    }
+
+    float SDFMeshBaker::getPacketDistance2(const TrianglePacket& packet, const float3& p)
+    {
+        // Exact point-triangle distance for four triangles at once. The point either projects into the triangle,
+        // in which case the distance to the plane is used, or the closest point lies on one of the edges.
+#if SDF_MESH_BAKER_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        auto load = [](const float* v) { return _mm_load_ps(v); };
+        auto dot3 = [](__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+        };
+        auto sign = [&](__m128 v) { return _mm_sub_ps(_mm_and_ps(_mm_cmpgt_ps(v, zero), one), _mm_and_ps(_mm_cmplt_ps(v, zero), one)); };
+
+        __m128 pa[3], pb[3], pc[3];
+        const float point[3] = { p.x, p.y, p.z };
+        for (int k = 0; k < 3; ++k)
+        {
+            pa[k] = _mm_sub_ps(_mm_set1_ps(point[k]), load(packet.a[k]));
+            pb[k] = _mm_sub_ps(pa[k], load(packet.ba[k]));
+            pc[k] = _mm_sub_ps(pb[k], load(packet.cb[k]));
+        }
+
+        const __m128* relative[3] = { pa, pb, pc };
+        const float (*edges[3])[4] = { packet.ba, packet.cb, packet.ac };
+
+        __m128 signSum = zero;
+        __m128 edgeDistance2 = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        for (int e = 0; e < 3; ++e)
+        {
+            const __m128* q = relative[e];
+            const __m128 ex = load(edges[e][0]), ey = load(edges[e][1]), ez = load(edges[e][2]);
+            signSum = _mm_add_ps(signSum, sign(dot3(load(packet.edgeNormal[e][0]), load(packet.edgeNormal[e][1]), load(packet.edgeNormal[e][2]), q[0], q[1], q[2])));
+
+            __m128 t = _mm_mul_ps(dot3(ex, ey, ez, q[0], q[1], q[2]), load(packet.invEdgeLength2[e]));
+            t = _mm_min_ps(_mm_max_ps(t, zero), one);
+            const __m128 dx = _mm_sub_ps(_mm_mul_ps(ex, t), q[0]);
+            const __m128 dy = _mm_sub_ps(_mm_mul_ps(ey, t), q[1]);
+            const __m128 dz = _mm_sub_ps(_mm_mul_ps(ez, t), q[2]);
+            edgeDistance2 = _mm_min_ps(edgeDistance2, dot3(dx, dy, dz, dx, dy, dz));
+        }
+
+        const __m128 planeDot = dot3(load(packet.nor[0]), load(packet.nor[1]), load(packet.nor[2]), pa[0], pa[1], pa[2]);
+        const __m128 planeDistance2 = _mm_mul_ps(_mm_mul_ps(planeDot, planeDot), load(packet.invNorLength2));
+
+        const __m128 projectsInside = _mm_cmpge_ps(signSum, _mm_set1_ps(2.f));
+        __m128 distance2 = _mm_or_ps(_mm_and_ps(projectsInside, planeDistance2), _mm_andnot_ps(projectsInside, edgeDistance2));
+        distance2 = _mm_min_ps(distance2, _mm_shuffle_ps(distance2, distance2, _MM_SHUFFLE(1, 0, 3, 2)));
+        distance2 = _mm_min_ps(distance2, _mm_shuffle_ps(distance2, distance2, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(distance2);
+#else
+        auto sign = [](float v) { return v > 0.f ? 1.f : (v < 0.f ? -1.f : 0.f); };
+        float result = std::numeric_limits<float>::infinity();
+        for (uint32_t lane = 0; lane < kLeafSize; ++lane)
+        {
+            auto get = [&](const float (&v)[3][4]) { return float3(v[0][lane], v[1][lane], v[2][lane]); };
+            const float3 pa = p - get(packet.a);
+            const float3 pb = pa - get(packet.ba);
+            const float3 pc = pb - get(packet.cb);
+            const float3 relative[3] = { pa, pb, pc };
+            const float3 edges[3] = { get(packet.ba), get(packet.cb), get(packet.ac) };
+
+            float signSum = 0.f;
+            float edgeDistance2 = std::numeric_limits<float>::infinity();
+            for (uint32_t e = 0; e < 3; ++e)
+            {
+                signSum += sign(dot(get(packet.edgeNormal[e]), relative[e]));
+                float t = std::clamp(dot(edges[e], relative[e]) * packet.invEdgeLength2[e][lane], 0.f, 1.f);
+                float3 d = edges[e] * t - relative[e];
+                edgeDistance2 = std::min(edgeDistance2, dot(d, d));
+            }
+
+            const float planeDot = dot(get(packet.nor), pa);
+            const float planeDistance2 = planeDot * planeDot * packet.invNorLength2[lane];
+            result = std::min(result, signSum >= 2.f ? planeDistance2 : edgeDistance2);
+        }
+        return result;
+#endif
+    }
+}
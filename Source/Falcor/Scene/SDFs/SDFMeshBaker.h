@@ -0,0 +1,150 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    class TriangleMesh;
+
+    /** Bakes a triangle mesh into signed distance values at the voxel corners of an SDF grid.
+
+        The mesh is stored in a BVH with up to four triangles per leaf. Point-triangle distances are computed
+        for all triangles of a leaf at once using SSE where available. The grid is evaluated in parallel over rows of
+        corners. Exact distances are only computed in a narrow band around the surface; outside of it the distance is
+        clamped and the 1-Lipschitz property of the distance field is used to skip queries altogether.
+
+        The sign is determined either by the generalized winding number, which is robust to holes and
+        self-intersections, or by counting ray crossings along each row of corners, which is faster but
+        requires a watertight mesh. In both cases the sign is only re-evaluated where the surface can have been crossed.
+    */
+    class FALCOR_API SDFMeshBaker
+    {
+    public:
+        enum class SignMode
+        {
+            WindingNumber,  ///< Inside if the absolute generalized winding number is at least 0.5.
+            RayParity,      ///< Inside if a ray along +x crosses the surface an odd number of times.
+        };
+
+        struct Options
+        {
+            uint32_t gridWidth = 64;                        ///< Grid width in voxels. The grid holds (gridWidth + 1)^3 corner values.
+            SignMode signMode = SignMode::WindingNumber;    ///< Method used to determine the sign.
+            float narrowBandWidth = 4.f;                    ///< Width of the band around the surface in voxels where exact distances are computed. Use 0 to compute exact distances everywhere.
+            float padding = 2.f;                            ///< Padding in voxels between the mesh bounds and the grid boundary.
+        };
+
+        struct Result
+        {
+            std::vector<float> values;                      ///< Corner values in the local space of the grid ([-0.5, 0.5]^3), ordered x first.
+            uint32_t gridWidth = 0;                         ///< Grid width in voxels.
+            float4x4 meshToGrid = float4x4::identity();     ///< Transform from mesh space to grid local space.
+        };
+
+        /** Create a baker for a triangle list.
+            \param[in] positions Vertex positions.
+            \param[in] indices Triangle indices, three per triangle.
+        */
+        SDFMeshBaker(const std::vector<float3>& positions, const std::vector<uint32_t>& indices);
+
+        /** Create a baker for a triangle mesh.
+        */
+        SDFMeshBaker(const TriangleMesh& mesh);
+
+        /** Bake the mesh into SDF grid corner values. The mesh is centered and uniformly scaled to fit into the grid.
+            The values can be passed directly to SDFGrid::setValues().
+        */
+        Result bake(const Options& options) const;
+
+        /** Get the unsigned distance from a point to the mesh.
+            \param[in] p Point in mesh space.
+            \param[in] maxDistance Search radius.
+            \return Distance to the closest triangle, or maxDistance if there is no triangle within the search radius.
+        */
+        float getDistance(const float3& p, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        /** Get the generalized winding number of the mesh at a point.
+            Distant BVH nodes are approximated by their area-weighted normal (dipole), so the result is approximate away from the surface.
+        */
+        float getWindingNumber(const float3& p) const;
+
+        /** Get the mesh bounds.
+        */
+        const AABB& getBounds() const { return mBounds; }
+
+        uint32_t getTriangleCount() const { return (uint32_t)mTriangles.size(); }
+
+    private:
+        struct Triangle
+        {
+            float3 v0, v1, v2;
+        };
+
+        struct Node
+        {
+            float3 boundsMin;
+            uint32_t secondChild = 0;   ///< Index of the second child for internal nodes (the first child follows the node), or of the triangle packet for leaves.
+            float3 boundsMax;
+            uint32_t firstTriangle = 0; ///< Index of the first triangle for leaves.
+            float3 areaNormal;          ///< Sum of area-weighted triangle normals.
+            uint32_t triangleCount = 0; ///< Number of triangles, 0 for internal nodes.
+            float3 centroid;            ///< Area-weighted centroid.
+            float radius = 0.f;         ///< Radius of the bounding sphere around the centroid.
+        };
+
+        /** Triangle data of a leaf, precomputed for the point-triangle distance and stored as structure of arrays.
+        */
+        struct alignas(16) TrianglePacket
+        {
+            float a[3][4];
+            float ba[3][4];
+            float cb[3][4];
+            float ac[3][4];
+            float nor[3][4];
+            float edgeNormal[3][3][4];  ///< cross(edge, nor) for the three edges.
+            float invEdgeLength2[3][4];
+            float invNorLength2[4];
+        };
+
+        uint32_t buildNode(std::vector<uint32_t>& order, uint32_t begin, uint32_t end, const std::vector<Triangle>& triangles, const std::vector<float3>& centroids);
+        void bakeRow(const Options& options, float scale, const float3& center, uint32_t y, uint32_t z, float* pValues) const;
+        void getRowCrossings(float y, float z, std::vector<float>& crossings) const;
+        static float getPacketDistance2(const TrianglePacket& packet, const float3& p);
+
+        AABB mBounds;
+        std::vector<Triangle> mTriangles;       ///< Triangles in BVH leaf order.
+        std::vector<TrianglePacket> mPackets;   ///< One packet per leaf.
+        std::vector<Node> mNodes;
+    };
+}
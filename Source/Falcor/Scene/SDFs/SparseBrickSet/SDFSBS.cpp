@@ -32,6 +32,7 @@
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/Math/MathConstants.slangh"
 #include "Utils/SharedCache.h"
+#include "Scene/SDFs/SDFGridFile.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
 
 namespace Falcor
@@ -104,11 +105,7 @@ namespace Falcor
         if ((!mPrimitivesDirty || (mPrimitives.empty() && !mHasGridRepresentation)) && !isEmpty) return UpdateFlags::None;
 
         // Update grid texture, if user loads an sdf-file.
-        if (!mSDField.empty())
-        {
-            createSDFGridTexture(pRenderContext, mSDField);
-            mSDField.clear();
-        }
+        uploadSDField(pRenderContext);
         return createResourcesFromPrimitivesAndSDField(pRenderContext, false);
     }
 
@@ -117,11 +114,7 @@ namespace Falcor
         FALCOR_ASSERT(pRenderContext);
 
         // Update grid texture, if user loads an sdf-file.
-        if (!mSDField.empty())
-        {
-            createSDFGridTexture(pRenderContext, mSDField);
-            mSDField.clear();
-        }
+        uploadSDField(pRenderContext);
 
         if (!mPrimitives.empty())
         {
@@ -977,6 +970,7 @@ namespace Falcor
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mSDField.resize(valueCount);
+        mpSDFieldFile.reset();
 
         // The grid is in the size [-1, 1] thus the longest distance that can be stored is sqrt(3) (the length from corner to corner)
         float normalizationFactor = 2.0f * mGridWidth / float(M_SQRT3);
@@ -988,6 +982,28 @@ namespace Falcor
         }
     }
 
+    void SDFSBS::setValuesFromFileInternal(const std::shared_ptr<SDFGridFile>& pFile)
+    {
+        // The file stores values with the same int8 quantization as the SD field. It is kept open and its chunks are
+        // decoded into the SD field texture when the resources are created, without building the dense field on the host.
+        mpSDFieldFile = pFile;
+        mSDField = {};
+    }
+
+    void SDFSBS::uploadSDField(RenderContext* pRenderContext)
+    {
+        if (!mSDField.empty())
+        {
+            createSDFGridTexture(pRenderContext, mSDField);
+            mSDField.clear();
+        }
+        else if (mpSDFieldFile)
+        {
+            createSDFGridTexture(pRenderContext, *mpSDFieldFile);
+            mpSDFieldFile.reset();
+        }
+    }
+
     void SDFSBS::createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int8_t>& sdField)
     {
         checkArgument(!sdField.empty(), "Cannot create SDF grid texture from empty values vector");
@@ -1007,6 +1023,34 @@ namespace Falcor
         mHasGridRepresentation = true;
     }
 
+    void SDFSBS::createSDFGridTexture(RenderContext* pRenderContext, const SDFGridFile& file)
+    {
+        FALCOR_ASSERT(file.getGridWidth() == mGridWidth);
+        const uint32_t gridWidthInValues = mGridWidth + 1;
+
+        if (!mpSDFGridTexture || mpSDFGridTexture->getWidth() != gridWidthInValues)
+        {
+            mpSDFGridTexture = Texture::create3D(mpDevice, gridWidthInValues, gridWidthInValues, gridWidthInValues, ResourceFormat::R8Snorm, 1, nullptr);
+        }
+
+        // Decode and upload one slab of chunks at a time. Chunks that are entirely clamped are filled without decoding.
+        std::vector<int8_t> slab;
+        for (uint32_t slabIndex = 0; slabIndex < file.getChunksPerAxis(); ++slabIndex)
+        {
+            const uint32_t planeCount = file.getSlabPlaneCount(slabIndex);
+            slab.resize((size_t)gridWidthInValues * gridWidthInValues * planeCount);
+            file.readQuantizedSlab(slabIndex, slab.data());
+            pRenderContext->updateSubresourceData(
+                mpSDFGridTexture.get(), 0, slab.data(), uint3(0, 0, slabIndex * file.getChunkWidth()), uint3(gridWidthInValues, gridWidthInValues, planeCount)
+            );
+        }
+
+        mSDFieldUpdated = true;
+        mCurrentBakedPrimitiveCount = 0;
+        mBakedPrimitiveCount = 0;
+        mHasGridRepresentation = true;
+    }
+
     uint32_t SDFSBS::fetchCount(RenderContext* pRenderContext, const ref<Buffer>& pBuffer)
     {
         if (!mpCountStagingBuffer)
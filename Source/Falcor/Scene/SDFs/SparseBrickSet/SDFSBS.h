@@ -79,8 +79,13 @@ namespace Falcor
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setValuesFromFileInternal(const std::shared_ptr<SDFGridFile>& pFile) override;
 
+        /** Create the SD field texture from values set by the user or loaded from a file, if any.
+        */
+        void uploadSDField(RenderContext* pRenderContext);
         void createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int8_t>& sdField);
+        void createSDFGridTexture(RenderContext* pRenderContext, const SDFGridFile& file);
 
         uint32_t fetchCount(RenderContext* pRenderContext, const ref<Buffer>& pBuffer);
 
@@ -89,6 +94,7 @@ namespace Falcor
     private:
         // CPU data.
         std::vector<int8_t> mSDField;
+        std::shared_ptr<SDFGridFile> mpSDFieldFile;     ///< Chunked values file that is decoded into the SD field texture, if loaded from a file.
 
         // Specs.
         uint32_t mDefaultGridWidth = 0;                 ///< The grid width used if the grid was not loaded from a file (it is empty).
@@ -30,6 +30,7 @@
 #include "SceneBuilder.h"
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
+#include "Material/BasicMaterial.h"
 #include "SDFs/SDFGrid.h"
 #include "SDFs/NormalizedDenseSDFGrid/NDSDFGrid.h"
 #include "SDFs/SparseBrickSet/SDFSBS.h"
@@ -41,12 +42,14 @@
 #include "Utils/StringUtils.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/Math/Common.h"
+#include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
 
+#include <bitset>
 #include <fstream>
 #include <numeric>
 #include <sstream>
@@ -66,6 +69,7 @@ const size_t kMaxBLASBuildMemory = 1ull << 29;
 const std::string kParameterBlockName = "gScene";
 const std::string kGeometryInstanceBufferName = "geometryInstances";
 const std::string kMeshBufferName = "meshes";
+const std::string kAlphaCoverageBufferName = "alphaCoverage";
 const std::string kIndexBufferName = "indexData";
 const std::string kVertexBufferName = "vertices";
 const std::string kPrevVertexBufferName = "prevVertices";
@@ -175,6 +179,13 @@ Scene::Scene(ref<Device> pDevice, SceneData&& sceneData) : mpDevice(pDevice)
     mMeshBBs = std::move(sceneData.meshBBs);
     mMeshIdToInstanceIds = std::move(sceneData.meshIdToInstanceIds);
     mMeshGroups = std::move(sceneData.meshGroups);
+    mMeshLods = std::move(sceneData.meshLods);
+    mMeshAlphaCoverage = std::move(sceneData.meshAlphaCoverage);
+    if (!mMeshAlphaCoverage.empty())
+    {
+        for (MaterialID materialID{0}; materialID.get() < mpMaterials->getMaterialCount(); ++materialID)
+            mMaterialAlphaCoverageStates.push_back(AlphaCoverageState::get(mpMaterials->getMaterial(materialID)));
+    }
 
     mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
     mHas16BitIndices = sceneData.has16BitIndices;
@@ -219,6 +230,8 @@ Scene::Scene(ref<Device> pDevice, SceneData&& sceneData) : mpDevice(pDevice)
     createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshSkinningData);
     createCurveVao(mCurveIndexData, mCurveStaticData);
     createMeshUVTiles(mMeshDesc, sceneData.meshIndexData, sceneData.meshStaticData);
+    if (sceneData.occlusionCulling)
+        createOccluderHulls(mMeshDesc, sceneData.meshIndexData, sceneData.meshStaticData);
 
     // Create animation controller.
     mpAnimationController = std::make_unique<AnimationController>(
@@ -238,8 +251,10 @@ Scene::Scene(ref<Device> pDevice, SceneData&& sceneData) : mpDevice(pDevice)
     {
         if (!mMeshDesc[mesh.meshID.get()].isAnimated())
             throw RuntimeError("Cached Mesh Animation: Referenced mesh ID is not dynamic");
-        if (mesh.timeSamples.size() != mesh.vertexData.size())
+        if (mesh.timeSamples.size() != mesh.getKeyframeCount())
             throw RuntimeError("Cached Mesh Animation: Time sample count mismatch.");
+        if (mesh.getVertexCount() != mMeshDesc[mesh.meshID.get()].vertexCount)
+            throw RuntimeError("Cached Mesh Animation: Vertex count mismatch.");
         for (const auto& vertices : mesh.vertexData)
         {
             if (vertices.size() != mMeshDesc[mesh.meshID.get()].vertexCount)
@@ -257,7 +272,7 @@ Scene::Scene(ref<Device> pDevice, SceneData&& sceneData) : mpDevice(pDevice)
 
     // Must be placed after curve data/AABB creation.
     mpAnimationController->addAnimatedVertexCaches(
-        std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData
+        std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData, sceneData.vertexCacheStreaming
     );
 
     // Finalize scene.
@@ -284,6 +299,7 @@ void Scene::updateSceneDefines()
     defines.add("SCENE_HAS_16BIT_INDICES", mHas16BitIndices ? "1" : "0");
     defines.add("SCENE_HAS_32BIT_INDICES", mHas32BitIndices ? "1" : "0");
     defines.add("SCENE_USE_LIGHT_PROFILE", mpLightProfile != nullptr ? "1" : "0");
+    defines.add("SCENE_HAS_ALPHA_COVERAGE", mMeshAlphaCoverage.empty() ? "0" : "1");
 
     defines.add(mHitInfo.getDefines());
     defines.add(getSceneSDFGridDefines());
@@ -541,10 +557,18 @@ void Scene::rasterizeFrustumCulling(
         {
             auto cameraChanges = camera->getChanges();
             auto excluded = Camera::Changes::Jitter | Camera::Changes::History;
-            if (((cameraChanges & ~excluded) != Camera::Changes::None) || forceUpdate)
+            bool cameraChanged = ((cameraChanges & ~excluded) != Camera::Changes::None) || forceUpdate;
+            if (cameraChanged)
             {
                 pFrustumCulling->updateFrustum(camera);
             }
+
+            // Re-render the occluders if the view or any instance transform changed
+            if (mOcclusionCullingEnabled && (cameraChanged || !mOcclusionCullingValid || is_set(mUpdates, UpdateFlags::GeometryMoved)))
+            {
+                updateOcclusionCulling(camera);
+                pFrustumCulling->invalidateAllDrawBuffers();
+            }
             updateDynamicGeomFrustum = true;
             mFrustumCullingUpdated = true;
         }
@@ -571,7 +595,10 @@ void Scene::rasterizeFrustumCulling(
     }
 
     // Create an custom draw argument buffer for this frame
-    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+    // The world-space instance bounds are cached in mInstanceCulling and only updated when instances move
+    const bool useOcclusionCulling = mOcclusionCullingEnabled && pFrustumCulling == mpCameraCulling;
+    auto isInstanceVisible = [&](const AABB& worldBB)
+    { return pFrustumCulling->isInFrustum(worldBB) && (!useOcclusionCulling || mpOcclusionCulling->isVisible(worldBB)); };
     auto& pDrawBuffers = pFrustumCulling->getDrawBuffers();
     auto& pDrawBufferCounts = pFrustumCulling->getDrawCounts();
 
@@ -655,14 +682,11 @@ void Scene::rasterizeFrustumCulling(
             for (auto& instanceID : mDrawArgsInstanceIDs[i])
             {
                 const auto& instance = mGeometryInstanceData[instanceID];
-                const auto& worldMat = globalMatrices[instance.globalMatrixID];
-                const AABB& meshBB = mMeshBBs[instance.geometryID];
                 const auto& mesh = mMeshDesc[instance.geometryID];
 
                 // If the mesh passes the culling test, add to draw buffer
                 //  TODO: Add a better/functioning precalculated BB for skinned meshes
-                if (pFrustumCulling->isUserAllowed(mesh) &&
-                    (pFrustumCulling->isInFrustum(meshBB.transform(worldMat)) || mesh.isSkinned()))
+                if (pFrustumCulling->isUserAllowed(mesh) && (mesh.isSkinned() || isInstanceVisible(mInstanceCulling.getBounds(instanceID))))
                 {
                     DrawIndexedArguments drawArg;
                     drawArg.IndexCountPerInstance = mesh.indexCount;
@@ -690,13 +714,10 @@ void Scene::rasterizeFrustumCulling(
             for (auto& instanceID : mDrawArgsInstanceIDs[i])
             {
                 const auto& instance = mGeometryInstanceData[instanceID];
-                const auto& worldMat = globalMatrices[instance.globalMatrixID];
-                const AABB& meshBB = mMeshBBs[instance.geometryID];
                 const auto& mesh = mMeshDesc[instance.geometryID];
                 // If the mesh passes the culling test, add to draw buffer
                 // TODO: Add a better/functioning precalculated BB for skinned meshes
-                if (pFrustumCulling->isUserAllowed(mesh) &&
-                    (pFrustumCulling->isInFrustum(meshBB.transform(worldMat)) || mesh.isSkinned()))
+                if (pFrustumCulling->isUserAllowed(mesh) && (mesh.isSkinned() || isInstanceVisible(mInstanceCulling.getBounds(instanceID))))
                 {
                     DrawArguments drawArg;
                     drawArg.VertexCountPerInstance = mesh.vertexCount;
@@ -1024,6 +1045,89 @@ void Scene::createMeshUVTiles(
     }
 }
 
+void Scene::createOccluderHulls(
+    const std::vector<MeshDesc>& meshDescs,
+    const std::vector<uint32_t>& indexData,
+    const std::vector<PackedStaticVertexData>& staticData
+)
+{
+    auto pOcclusionCulling = make_ref<OcclusionCulling>();
+    const uint32_t maxTriangles = pOcclusionCulling->getOptions().maxHullTriangles;
+    const uint8_t* indexData8 = reinterpret_cast<const uint8_t*>(indexData.data());
+
+    mMeshHullIDs.assign(meshDescs.size(), OcclusionCulling::kInvalidHullID);
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+    for (size_t meshID = 0; meshID < meshDescs.size(); ++meshID)
+    {
+        // Only rigid, non-displaced meshes within the triangle budget are used as occluders.
+        // Displacement moves the surface away from the base triangles, so their hull is not conservative.
+        const MeshDesc& desc = meshDescs[meshID];
+        if (desc.isDynamic() || desc.isDisplaced() || desc.getTriangleCount() > maxTriangles)
+            continue;
+
+        positions.resize(desc.vertexCount);
+        FALCOR_ASSERT((size_t)desc.vbOffset + desc.vertexCount <= staticData.size());
+        for (uint32_t i = 0; i < desc.vertexCount; ++i)
+            positions[i] = staticData[(size_t)desc.vbOffset + i].unpack().position;
+
+        indices.resize(desc.getTriangleCount() * 3);
+        for (uint32_t i = 0; i < indices.size(); ++i)
+        {
+            if (!desc.useVertexIndices())
+                indices[i] = i;
+            else if (desc.use16BitIndices())
+                indices[i] = reinterpret_cast<const uint16_t*>(indexData8 + desc.ibOffset * 4)[i];
+            else
+                indices[i] = reinterpret_cast<const uint32_t*>(indexData8 + desc.ibOffset * 4)[i];
+            FALCOR_ASSERT(indices[i] < desc.vertexCount);
+        }
+
+        mMeshHullIDs[meshID] = pOcclusionCulling->addHull(OcclusionCulling::createHull(positions, indices, maxTriangles));
+    }
+
+    logInfo("Created {} occluder hulls for {} meshes.", pOcclusionCulling->getHullCount(), meshDescs.size());
+    mpOcclusionCulling = pOcclusionCulling;
+    mOcclusionCullingEnabled = true;
+}
+
+void Scene::updateOcclusionCulling(const ref<Camera>& pCamera)
+{
+    FALCOR_ASSERT(mpOcclusionCulling);
+
+    // Occluder candidates are opaque instances of non-displaced meshes with a hull.
+    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+    std::vector<OcclusionCulling::Candidate> candidates;
+    for (const auto& instance : mGeometryInstanceData)
+    {
+        if (instance.getType() != GeometryType::TriangleMesh)
+            continue;
+        uint32_t hullID = mMeshHullIDs[instance.geometryID];
+        if (hullID == OcclusionCulling::kInvalidHullID || !getMaterial(MaterialID::fromSlang(instance.materialID))->isOpaque())
+            continue;
+        candidates.push_back({hullID, globalMatrices[instance.globalMatrixID]});
+    }
+
+    mpOcclusionCulling->update(pCamera->getViewProjMatrixNoJitter(), candidates);
+    mOcclusionCullingValid = true;
+}
+
+void Scene::setOcclusionCullingEnabled(bool enabled)
+{
+    if (enabled && !mpOcclusionCulling)
+    {
+        logWarning("Scene::setOcclusionCullingEnabled() - No occluder hulls. Set the 'OcclusionCulling:enabled' option before loading the scene.");
+        return;
+    }
+    if (enabled == mOcclusionCullingEnabled)
+        return;
+
+    mOcclusionCullingEnabled = enabled;
+    mOcclusionCullingValid = false;
+    if (mpCameraCulling)
+        mpCameraCulling->invalidateAllDrawBuffers();
+}
+
 void Scene::setSDFGridConfig()
 {
     if (mSDFGrids.empty())
@@ -1162,6 +1266,15 @@ void Scene::createParameterBlock()
         mpMeshesBuffer->setName("Scene::mpMeshesBuffer");
     }
 
+    if (!mMeshAlphaCoverage.empty() && !mpAlphaCoverageBuffer)
+    {
+        mpAlphaCoverageBuffer = Buffer::create(
+            mpDevice, mMeshAlphaCoverage.size() * sizeof(uint32_t), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None,
+            mMeshAlphaCoverage.data()
+        );
+        mpAlphaCoverageBuffer->setName("Scene::mpAlphaCoverageBuffer");
+    }
+
     if (!mCurveDesc.empty() && (!mpCurvesBuffer || mpCurvesBuffer->getElementCount() < mCurveDesc.size()))
     {
         mpCurvesBuffer = Buffer::createStructured(
@@ -1192,6 +1305,8 @@ void Scene::createParameterBlock()
     // Bind resources to parameter block.
     var[kGeometryInstanceBufferName] = mpGeometryInstancesBuffer;
     var[kMeshBufferName] = mpMeshesBuffer;
+    if (mpAlphaCoverageBuffer)
+        var[kAlphaCoverageBufferName] = mpAlphaCoverageBuffer;
     var[kCurveBufferName] = mpCurvesBuffer;
     var[kLightsBufferName] = mpLightsBuffer;
     var[kGridVolumesBufferName] = mpGridVolumesBuffer;
@@ -1295,6 +1410,8 @@ void Scene::updateGeometryInstances(bool forceUpdate)
     if (mGeometryInstanceData.empty())
         return;
 
+    updateInstanceBounds(forceUpdate);
+
     bool dataChanged = false;
     const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
@@ -1336,6 +1453,114 @@ void Scene::updateGeometryInstances(bool forceUpdate)
     }
 }
 
+void Scene::updateInstanceBounds(bool forceUpdate)
+{
+    if (mInstanceCulling.getItemCount() != mGeometryInstanceData.size())
+    {
+        mInstanceCulling.resize((uint32_t)mGeometryInstanceData.size());
+        forceUpdate = true;
+    }
+
+    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+    for (uint32_t instanceID = 0; instanceID < mGeometryInstanceData.size(); ++instanceID)
+    {
+        const auto& inst = mGeometryInstanceData[instanceID];
+        if (!forceUpdate && !mpAnimationController->isMatrixChanged(NodeID{inst.globalMatrixID}))
+            continue;
+
+        const float4x4& transform = globalMatrices[inst.globalMatrixID];
+        switch (inst.getType())
+        {
+        case GeometryType::TriangleMesh:
+        case GeometryType::DisplacedTriangleMesh:
+            // Skinned meshes are deformed on the GPU and have no valid precomputed bounds, so they are never culled.
+            if (mMeshDesc[inst.geometryID].isSkinned())
+                mInstanceCulling.setAlwaysVisible(instanceID);
+            else
+                mInstanceCulling.setBounds(instanceID, mMeshBBs[inst.geometryID].transform(transform));
+            break;
+        case GeometryType::Curve:
+            mInstanceCulling.setBounds(instanceID, mCurveBBs[inst.geometryID].transform(transform));
+            break;
+        case GeometryType::SDFGrid:
+            mInstanceCulling.setBounds(instanceID, AABB(float3(-0.5f), float3(0.5f)).transform(transform));
+            break;
+        default:
+            mInstanceCulling.setAlwaysVisible(instanceID);
+            break;
+        }
+    }
+}
+
+const MultiViewCulling& Scene::cullViews(const std::vector<float4x4>& viewProjs)
+{
+    mInstanceCulling.setViews(viewProjs);
+    mInstanceCulling.cull();
+    return mInstanceCulling;
+}
+
+void Scene::getVisibleDrawInstances(uint32_t viewIndex, uint32_t drawGroup, std::vector<uint32_t>& instanceIDs) const
+{
+    if (viewIndex >= mInstanceCulling.getViewCount())
+        throw ArgumentError("'viewIndex' ({}) is out of range.", viewIndex);
+    if (drawGroup >= mDrawArgsInstanceIDs.size())
+        throw ArgumentError("'drawGroup' ({}) is out of range.", drawGroup);
+
+    instanceIDs.clear();
+    for (uint32_t instanceID : mDrawArgsInstanceIDs[drawGroup])
+    {
+        if (mInstanceCulling.isVisible(viewIndex, instanceID))
+            instanceIDs.push_back(instanceID);
+    }
+}
+
+const std::vector<MeshLod>& Scene::getMeshLods(MeshID meshID) const
+{
+    static const std::vector<MeshLod> kNoLods;
+
+    if (meshID.get() >= getMeshCount())
+        throw ArgumentError("'meshID' ({}) is out of range.", meshID);
+    return meshID.get() < mMeshLods.size() ? mMeshLods[meshID.get()] : kNoLods;
+}
+
+void Scene::selectMeshLods(const ref<Camera>& pCamera, uint32_t viewportHeight, float maxPixelError, std::vector<uint32_t>& levels) const
+{
+    FALCOR_ASSERT(pCamera);
+    levels.assign(mGeometryInstanceData.size(), 0);
+    if (mMeshLods.empty())
+        return;
+
+    // Number of pixels covered by a unit length at unit distance along the view direction.
+    const float fovY = focalLengthToFovY(pCamera->getFocalLength(), pCamera->getFrameHeight());
+    const float pixelsPerUnit = (float)viewportHeight / (2.f * std::tan(0.5f * fovY));
+    const float3 cameraPos = pCamera->getPosition();
+    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+    for (uint32_t instanceID = 0; instanceID < mGeometryInstanceData.size(); instanceID++)
+    {
+        const auto& instance = mGeometryInstanceData[instanceID];
+        if (instance.getType() != GeometryType::TriangleMesh || instance.geometryID >= mMeshLods.size())
+            continue;
+        const auto& lods = mMeshLods[instance.geometryID];
+        if (lods.empty())
+            continue;
+
+        // Use the closest point of the world-space bounds. Keep the full resolution mesh when the camera is inside.
+        AABB bounds = mInstanceCulling.getBounds(instanceID);
+        if (!bounds.valid())
+            continue;
+        float distance = length(max(max(bounds.minPoint - cameraPos, cameraPos - bounds.maxPoint), float3(0.f)));
+        if (distance <= 0.f)
+            continue;
+
+        // The object-space error grows with the largest scale of the instance transform.
+        const float4x4& transform = globalMatrices[instance.globalMatrixID];
+        float scale = std::max({length(transform.getCol(0).xyz()), length(transform.getCol(1).xyz()), length(transform.getCol(2).xyz())});
+
+        levels[instanceID] = MeshLodGenerator::selectLevel(lods, scale * pixelsPerUnit / distance, maxPixelError);
+    }
+}
+
 Scene::UpdateFlags Scene::updateRaytracingAABBData(bool forceUpdate)
 {
     // This function updates the global list of AABBs for all procedural primitives.
@@ -1883,6 +2108,19 @@ void Scene::updateGeometryStats()
         s.uniqueTriangleCount += mesh.getTriangleCount();
     }
 
+    s.meshLodCount = 0;
+    s.meshLodTriangleCount = 0;
+    for (const auto& lods : mMeshLods)
+    {
+        s.meshLodCount += lods.size();
+        for (const auto& lod : lods)
+            s.meshLodTriangleCount += lod.getTriangleCount();
+    }
+
+    s.alphaOpaqueTriangleCount = 0;
+    for (size_t i = std::min(mMeshAlphaCoverage.size(), mMeshDesc.size()); i < mMeshAlphaCoverage.size(); i++)
+        s.alphaOpaqueTriangleCount += std::bitset<32>(mMeshAlphaCoverage[i]).count();
+
     for (CurveID curveID{0}; curveID.get() < getCurveCount(); ++curveID)
     {
         const auto& curve = getCurve(curveID);
@@ -1928,6 +2166,7 @@ void Scene::updateGeometryStats()
 
     s.geometryMemoryInBytes += mpGeometryInstancesBuffer ? mpGeometryInstancesBuffer->getSize() : 0;
     s.geometryMemoryInBytes += mpMeshesBuffer ? mpMeshesBuffer->getSize() : 0;
+    s.geometryMemoryInBytes += mpAlphaCoverageBuffer ? mpAlphaCoverageBuffer->getSize() : 0;
     s.geometryMemoryInBytes += mpCurvesBuffer ? mpCurvesBuffer->getSize() : 0;
     s.geometryMemoryInBytes += mpCustomPrimitivesBuffer ? mpCustomPrimitivesBuffer->getSize() : 0;
     s.geometryMemoryInBytes += mpRtAABBBuffer ? mpRtAABBBuffer->getSize() : 0;
@@ -2208,8 +2447,8 @@ Scene::UpdateFlags Scene::updateGridVolumes(bool forceUpdate)
     if (!forceUpdate && combinedUpdates == GridVolume::UpdateFlags::None)
         return UpdateFlags::None;
 
-    // Upload grids.
-    if (forceUpdate)
+    // Upload grids. Streamed grids change their resources when frames are loaded or evicted, so rebind on grid changes too.
+    if (forceUpdate || is_set(combinedUpdates, GridVolume::UpdateFlags::GridsChanged))
     {
         auto var = mpSceneBlock->getRootVar()["grids"];
         for (size_t i = 0; i < mGrids.size(); ++i)
@@ -2322,12 +2561,56 @@ Scene::UpdateFlags Scene::updateMaterials(bool forceUpdate)
             flags |= UpdateFlags::ShaderCodeChanged;
         }
 
+        updateAlphaCoverage();
         updateMaterialStats();
     }
 
     return flags;
 }
 
+Scene::AlphaCoverageState Scene::AlphaCoverageState::get(const ref<Material>& pMaterial)
+{
+    // Mirrors the inputs of SceneBuilder::classifyAlphaCoverage().
+    AlphaCoverageState state;
+    state.alphaMode = pMaterial->getAlphaMode();
+    state.alphaThreshold = pMaterial->getAlphaThreshold();
+    if (auto pBasicMaterial = pMaterial->toBasicMaterial())
+        state.pTexture = pBasicMaterial->getBaseColorTexture();
+    if (auto pSampler = pMaterial->getDefaultTextureSampler())
+    {
+        state.addressModeU = pSampler->getAddressModeU();
+        state.addressModeV = pSampler->getAddressModeV();
+    }
+    return state;
+}
+
+void Scene::updateAlphaCoverage()
+{
+    // The alpha opaque bits are only valid for the material state the triangles were classified with.
+    // Meshes whose material changed the alpha mode, threshold, base color texture or sampler fall back to the alpha test.
+    // Triangles that were removed as transparent at scene build time stay removed.
+    bool changed = false;
+    for (size_t meshID = 0; meshID < mMeshDesc.size() && meshID < mMeshAlphaCoverage.size(); meshID++)
+    {
+        if (mMeshAlphaCoverage[meshID] == 0)
+            continue;
+
+        const MaterialID materialID{mMeshDesc[meshID].materialID};
+        FALCOR_ASSERT(materialID.get() < mMaterialAlphaCoverageStates.size());
+        const auto& pMaterial = mpMaterials->getMaterial(materialID);
+        if (AlphaCoverageState::get(pMaterial) == mMaterialAlphaCoverageStates[materialID.get()])
+            continue;
+
+        logInfo("Alpha test state of material '{}' changed. Disabling the alpha coverage of mesh '{}'.", pMaterial->getName(), mMeshNames[meshID]);
+        mMeshAlphaCoverage[meshID] = 0;
+        changed = true;
+    }
+
+    // The buffer is created from the CPU copy when it is first needed.
+    if (changed && mpAlphaCoverageBuffer)
+        mpAlphaCoverageBuffer->setBlob(mMeshAlphaCoverage.data(), 0, mMeshDesc.size() * sizeof(uint32_t));
+}
+
 Scene::UpdateFlags Scene::updateGeometry(RenderContext* pRenderContext, bool forceUpdate)
 {
     UpdateFlags flags = updateProceduralPrimitives(forceUpdate);
@@ -2414,8 +2697,8 @@ Scene::UpdateFlags Scene::update(RenderContext* pRenderContext, double currentTi
 
     if (is_set(mUpdates, UpdateFlags::GeometryMoved))
     {
-        invalidateTlasCache();
         updateGeometryInstances(false);
+        updateTlasInstances();
     }
 
     // Signal Fence for this frame
@@ -2584,6 +2867,23 @@ void Scene::renderUI(Gui::Widgets& widget)
         renderSettingsGroup.slider("Diffuse albedo multiplier", mRenderSettings.diffuseAlbedoMultiplier);
     }
 
+    if (mpOcclusionCulling)
+    {
+        if (auto occlusionCullingGroup = widget.group("Occlusion Culling"))
+        {
+            bool enabled = mOcclusionCullingEnabled;
+            if (occlusionCullingGroup.checkbox("Enabled", enabled))
+                setOcclusionCullingEnabled(enabled);
+            occlusionCullingGroup.tooltip("Cull instances hidden behind occluders in rasterizeFrustumCulling().", true);
+
+            const auto& stats = mpOcclusionCulling->getStats();
+            occlusionCullingGroup.text(fmt::format(
+                "Occluders: {} ({} triangles)\nCulled: {} / {} ({:.1f}%)\nUpdate time: {:.3f} ms", stats.occluderCount,
+                stats.occluderTriangleCount, stats.culledCount, stats.testedCount, 100.f * stats.getCullRate(), stats.updateTimeMs
+            ));
+        }
+    }
+
     if (mSDFGridConfig.implementation != SDFGrid::Type::None)
     {
         if (auto sdfGridConfigGroup = widget.group("SDF Grid Settings"))
@@ -2687,6 +2987,9 @@ void Scene::renderUI(Gui::Widgets& widget)
             << "  Unique vertex count: " << s.uniqueVertexCount << std::endl
             << "  Instanced triangle count: " << s.instancedTriangleCount << std::endl
             << "  Instanced vertex count: " << s.instancedVertexCount << std::endl
+            << "  Mesh LOD count: " << s.meshLodCount << std::endl
+            << "  Mesh LOD triangle count: " << s.meshLodTriangleCount << std::endl
+            << "  Alpha opaque triangle count: " << s.alphaOpaqueTriangleCount << std::endl
             << "  Index  buffer memory: " << formatByteSize(s.indexMemoryInBytes) << std::endl
             << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
             << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
@@ -4359,9 +4662,10 @@ void Scene::buildBlas(RenderContext* pRenderContext)
     }
 }
 
-void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
+void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& matrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const
 {
     instanceDescs.clear();
+    matrixIDs.clear();
     uint32_t instanceContributionToHitGroupIndex = 0;
     uint32_t instanceID = 0;
 
@@ -4440,12 +4744,14 @@ void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_
             instanceID += (uint32_t)meshList.size();
 
             float4x4 transform4x4 = float4x4::identity();
+            uint32_t descMatrixID = kInvalidMatrixID;
             if (!isStatic)
             {
                 // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
                 // Just pick the matrix from the first mesh.
                 const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
                 transform4x4 = mpAnimationController->getGlobalMatrices()[matrixId];
+                descMatrixID = matrixId;
 
                 // Verify that all meshes have matching tranforms.
                 for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
@@ -4463,6 +4769,7 @@ void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_
             }
 
             instanceDescs.push_back(desc);
+            matrixIDs.push_back(descMatrixID);
         }
     }
 
@@ -4508,6 +4815,7 @@ void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_
         }
 
         instanceDescs.push_back(desc);
+        matrixIDs.push_back(matrixId);
     }
 
     // One instance per SDF grid instance.
@@ -4552,6 +4860,7 @@ void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_
             FALCOR_ASSERT(0 == instance.geometryIndex);
 
             instanceDescs.push_back(desc);
+            matrixIDs.push_back(instance.globalMatrixID);
         }
 
         blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -4579,6 +4888,40 @@ void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_
         float4x4 identityMat = float4x4::identity();
         std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
         instanceDescs.push_back(desc);
+        matrixIDs.push_back(kInvalidMatrixID);
+    }
+}
+
+AABB Scene::getInstanceDescBounds(const std::vector<RtInstanceDesc>& instanceDescs, uint32_t index) const
+{
+    // The geometry instances of a desc are numbered consecutively from its instance ID up to the next desc.
+    const uint32_t firstInstanceID = instanceDescs[index].instanceID;
+    const uint32_t lastInstanceID = index + 1 < instanceDescs.size() ? instanceDescs[index + 1].instanceID : mInstanceCulling.getItemCount();
+
+    AABB bounds;
+    for (uint32_t instanceID = firstInstanceID; instanceID < lastInstanceID; instanceID++)
+        bounds |= mInstanceCulling.getBounds(instanceID);
+    return bounds;
+}
+
+void Scene::updateTlasInstances()
+{
+    const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+    for (auto& [rayTypeCount, tlas] : mTlasCache)
+    {
+        // Invalid TLASes refill all instance descs when they are built.
+        if (!tlas.pTlasObject)
+            continue;
+
+        FALCOR_ASSERT(tlas.instances.getCount() == mInstanceDescMatrixIDs.size());
+        for (uint32_t i = 0; i < (uint32_t)mInstanceDescMatrixIDs.size(); i++)
+        {
+            const uint32_t matrixID = mInstanceDescMatrixIDs[i];
+            if (matrixID == kInvalidMatrixID || !mpAnimationController->isMatrixChanged(NodeID{matrixID}))
+                continue;
+            tlas.instances.setTransform(i, globalMatrices[matrixID], getInstanceDescBounds(tlas.instances.getDescs(), i));
+        }
     }
 }
 
@@ -4594,18 +4937,27 @@ void Scene::buildTlas(RenderContext* pRenderContext, uint32_t rayTypeCount, bool
 {
     FALCOR_PROFILE(pRenderContext, "buildTlas");
 
-    TlasData tlas;
-    auto it = mTlasCache.find(rayTypeCount);
-    if (it != mTlasCache.end())
-        tlas = it->second;
+    TlasData& tlas = mTlasCache[rayTypeCount];
+    tlas.instances.setOptions(mTlasInstanceOptions);
 
     // Prepare instance descs.
+    // On first build or after the TLAS was invalidated all descs are filled. Otherwise only the descs of moved instances
+    // have been patched by updateTlasInstances().
     // Note if there are no instances, we'll build an empty TLAS.
-    fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+    if (tlas.pTlasObject == nullptr)
+    {
+        std::vector<RtInstanceDesc> instanceDescs;
+        fillInstanceDesc(instanceDescs, mInstanceDescMatrixIDs, rayTypeCount, perMeshHitEntry);
+        std::vector<AABB> bounds(instanceDescs.size());
+        for (uint32_t i = 0; i < (uint32_t)instanceDescs.size(); i++)
+            bounds[i] = getInstanceDescBounds(instanceDescs, i);
+        tlas.instances.reset(std::move(instanceDescs), std::move(bounds));
+    }
+    const auto& instanceDescs = tlas.instances.getDescs();
 
     RtAccelerationStructureBuildInputs inputs = {};
     inputs.kind = RtAccelerationStructureKind::TopLevel;
-    inputs.descCount = (uint32_t)mInstanceDescs.size();
+    inputs.descCount = (uint32_t)instanceDescs.size();
     inputs.flags = RtAccelerationStructureBuildFlags::None;
 
     // Add build flags for dynamic scenes if TLAS should be updating instead of rebuilt
@@ -4614,8 +4966,9 @@ void Scene::buildTlas(RenderContext* pRenderContext, uint32_t rayTypeCount, bool
     {
         inputs.flags |= RtAccelerationStructureBuildFlags::AllowUpdate;
 
-        // If TLAS has been built already and it was built with ALLOW_UPDATE
-        if (tlas.pTlasObject != nullptr && tlas.updateMode == UpdateMode::Refit)
+        // If TLAS has been built already and it was built with ALLOW_UPDATE.
+        // Rebuild anyway if the instances moved so far that the refit tree would be of poor quality.
+        if (tlas.pTlasObject != nullptr && tlas.updateMode == UpdateMode::Refit && !tlas.instances.isRebuildRecommended())
             inputs.flags |= RtAccelerationStructureBuildFlags::PerformUpdate;
     }
 
@@ -4653,20 +5006,21 @@ void Scene::buildTlas(RenderContext* pRenderContext, uint32_t rayTypeCount, bool
                 tlas.pTlasBuffer->setName("Scene TLAS buffer");
             }
         }
-        if (!mInstanceDescs.empty())
+        if (!instanceDescs.empty())
         {
             // Allocate a new buffer for the TLAS instance desc input only if the existing buffer isn't big enough.
-            if (!tlas.pInstanceDescs || tlas.pInstanceDescs->getSize() < mInstanceDescs.size() * sizeof(RtInstanceDesc))
+            // The buffer is in GPU memory and is patched in place, so that later updates only need to upload the moved instances.
+            if (!tlas.pInstanceDescs || tlas.pInstanceDescs->getSize() < instanceDescs.size() * sizeof(RtInstanceDesc))
             {
                 tlas.pInstanceDescs = Buffer::create(
-                    mpDevice, (uint32_t)mInstanceDescs.size() * sizeof(RtInstanceDesc), Buffer::BindFlags::None, Buffer::CpuAccess::Write,
-                    mInstanceDescs.data()
+                    mpDevice, (uint32_t)instanceDescs.size() * sizeof(RtInstanceDesc), Buffer::BindFlags::ShaderResource,
+                    Buffer::CpuAccess::None, instanceDescs.data()
                 );
                 tlas.pInstanceDescs->setName("Scene instance descs buffer");
             }
             else
             {
-                tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, mInstanceDescs.size() * sizeof(RtInstanceDesc));
+                tlas.pInstanceDescs->setBlob(instanceDescs.data(), 0, instanceDescs.size() * sizeof(RtInstanceDesc));
             }
         }
 
@@ -4675,19 +5029,23 @@ void Scene::buildTlas(RenderContext* pRenderContext, uint32_t rayTypeCount, bool
         asCreateDesc.setBuffer(tlas.pTlasBuffer, 0, mTlasPrebuildInfo.resultDataMaxSize);
         tlas.pTlasObject = RtAccelerationStructure::create(mpDevice, asCreateDesc);
     }
-    // Else update instance descs and barrier TLAS buffers
+    // Else upload the patched instance descs and barrier TLAS buffers
     else
     {
-        FALCOR_ASSERT(mpAnimationController->hasAnimations() || mpAnimationController->hasAnimatedVertexCaches());
         pRenderContext->uavBarrier(tlas.pTlasBuffer.get());
         pRenderContext->uavBarrier(mpTlasScratch.get());
         if (tlas.pInstanceDescs)
         {
-            FALCOR_ASSERT(!mInstanceDescs.empty());
-            tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, inputs.descCount * sizeof(RtInstanceDesc));
+            FALCOR_ASSERT(!instanceDescs.empty());
+            for (const auto& range : tlas.instances.getDirtyRanges())
+            {
+                tlas.pInstanceDescs->setBlob(
+                    instanceDescs.data() + range.first, range.first * sizeof(RtInstanceDesc), range.count * sizeof(RtInstanceDesc)
+                );
+            }
         }
-        asDesc.source = tlas.pTlasObject.get(); // Perform the update in-place
     }
+    tlas.instances.clearDirty();
 
     FALCOR_ASSERT(tlas.pTlasBuffer && tlas.pTlasBuffer->getGfxResource() && mpTlasScratch->getGfxResource());
     FALCOR_ASSERT(inputs.descCount == 0 || (tlas.pInstanceDescs && tlas.pInstanceDescs->getGfxResource()));
@@ -4696,11 +5054,16 @@ void Scene::buildTlas(RenderContext* pRenderContext, uint32_t rayTypeCount, bool
     asDesc.scratchData = mpTlasScratch->getGpuAddress();
     asDesc.dest = tlas.pTlasObject.get();
 
-    // Set the source buffer to update in place if this is an update
+    // Set the source buffer to update in place if this is an update.
+    // An existing TLAS is otherwise rebuilt into the same buffer, which must not have a source.
     if ((inputs.flags & RtAccelerationStructureBuildFlags::PerformUpdate) != RtAccelerationStructureBuildFlags::None)
     {
         asDesc.source = asDesc.dest;
     }
+    else
+    {
+        tlas.instances.markRebuilt();
+    }
 
     // Create TLAS
     if (tlas.pInstanceDescs)
@@ -4710,7 +5073,6 @@ void Scene::buildTlas(RenderContext* pRenderContext, uint32_t rayTypeCount, bool
     pRenderContext->buildAccelerationStructure(asDesc, 0, nullptr);
     pRenderContext->uavBarrier(tlas.pTlasBuffer.get());
 
-    mTlasCache[rayTypeCount] = tlas;
     updateRaytracingTLASStats();
 }
 
@@ -4730,7 +5092,7 @@ void Scene::setRaytracingShaderData(RenderContext* pRenderContext, const ShaderV
     // set to zero.
     //
     auto tlasIt = mTlasCache.find(rayTypeCount);
-    if (tlasIt == mTlasCache.end() || !tlasIt->second.pTlasObject)
+    if (tlasIt == mTlasCache.end() || !tlasIt->second.pTlasObject || tlasIt->second.instances.isDirty())
     {
         // We need a hit entry per mesh right now to pass GeometryIndex()
         buildTlas(pRenderContext, rayTypeCount, true);
@@ -5017,6 +5379,9 @@ inline pybind11::dict toPython(const Scene::SceneStats& stats)
     d["uniqueVertexCount"] = stats.uniqueVertexCount;
     d["instancedTriangleCount"] = stats.instancedTriangleCount;
     d["instancedVertexCount"] = stats.instancedVertexCount;
+    d["meshLodCount"] = stats.meshLodCount;
+    d["meshLodTriangleCount"] = stats.meshLodTriangleCount;
+    d["alphaOpaqueTriangleCount"] = stats.alphaOpaqueTriangleCount;
     d["indexMemoryInBytes"] = stats.indexMemoryInBytes;
     d["vertexMemoryInBytes"] = stats.vertexMemoryInBytes;
     d["geometryMemoryInBytes"] = stats.geometryMemoryInBytes;
@@ -5153,6 +5518,25 @@ FALCOR_SCRIPT_BINDING(Scene)
     scene.def_property_readonly("volumes", &Scene::getGridVolumes); // PYTHONDEPRECATED
     scene.def_property(kCameraSpeed.c_str(), &Scene::getCameraSpeed, &Scene::setCameraSpeed);
     scene.def_property(kAnimated.c_str(), &Scene::isAnimated, &Scene::setIsAnimated);
+    scene.def_property("occlusionCulling", &Scene::isOcclusionCullingEnabled, &Scene::setOcclusionCullingEnabled);
+    scene.def_property_readonly(
+        "occlusionCullingStats",
+        [](const Scene* pScene)
+        {
+            pybind11::dict d;
+            if (const auto& pOcclusionCulling = pScene->getOcclusionCulling())
+            {
+                const auto& stats = pOcclusionCulling->getStats();
+                d["occluderCount"] = stats.occluderCount;
+                d["occluderTriangleCount"] = stats.occluderTriangleCount;
+                d["testedCount"] = stats.testedCount;
+                d["culledCount"] = stats.culledCount;
+                d["cullRate"] = stats.getCullRate();
+                d["updateTimeMs"] = stats.updateTimeMs;
+            }
+            return d;
+        }
+    );
     scene.def_property(kLoopAnimations.c_str(), &Scene::isLooped, &Scene::setIsLooped);
     scene.def_property(
         kRenderSettings.c_str(), pybind11::overload_cast<>(&Scene::getRenderSettings, pybind11::const_), &Scene::setRenderSettings
@@ -30,6 +30,10 @@
 #include "SceneTypes.slang"
 #include "HitInfo.h"
 #include "FrustumCulling.h"
+#include "MultiViewCulling.h"
+#include "MeshLodGenerator.h"
+#include "TlasInstanceUpdater.h"
+#include "OcclusionCulling.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
 #include "Displacement/DisplacementUpdateTask.slang"
@@ -354,7 +358,11 @@ public:
         std::vector<GeometryInstanceData> meshInstanceData;     ///< List of mesh instances.
         std::vector<std::vector<uint32_t>> meshIdToInstanceIds; ///< Mapping of what instances belong to which mesh.
         std::vector<MeshGroup> meshGroups;                      ///< List of mesh groups. Each group maps to a BLAS for ray tracing.
+        std::vector<std::vector<MeshLod>> meshLods;             ///< Simplified levels of detail per mesh, or empty if not generated.
+        std::vector<uint32_t> meshAlphaCoverage;                ///< Per-mesh word offsets followed by a bit per triangle that is set if the triangle is alpha opaque, or empty if not classified.
         std::vector<CachedMesh> cachedMeshes;                   ///< Cached data for vertex-animated meshes.
+        VertexCacheStreamingDesc vertexCacheStreaming;          ///< Settings for streaming cached mesh keyframes from disk. Not stored in the scene cache.
+        bool occlusionCulling = false;                          ///< Build occluder hulls and enable CPU occlusion culling in rasterizeFrustumCulling(). Not stored in the scene cache.
         uint32_t prevVertexCount = 0; ///< Number of vertices that the AnimationController needs to allocate to store previous frame
                                       ///< vertices.
 
@@ -407,6 +415,9 @@ public:
         uint64_t instancedTriangleCount = 0;  ///< Number of instanced triangles. This is the total number of rendered triangles.
         uint64_t instancedVertexCount = 0;    ///< Number of instanced vertices. This is the total number of vertices in the rendered
                                               ///< triangles.
+        uint64_t meshLodCount = 0;            ///< Number of simplified mesh levels of detail over all meshes.
+        uint64_t meshLodTriangleCount = 0;    ///< Number of triangles in all simplified mesh levels of detail.
+        uint64_t alphaOpaqueTriangleCount = 0; ///< Number of unique triangles of alpha-tested meshes that are classified as alpha opaque.
         uint64_t indexMemoryInBytes = 0;      ///< Total memory in bytes used by the index buffer.
         uint64_t vertexMemoryInBytes = 0;     ///< Total memory in bytes used by the vertex buffer.
         uint64_t geometryMemoryInBytes = 0;   ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives,
@@ -973,6 +984,16 @@ public:
      */
     UpdateMode getTlasUpdateMode() { return mTlasUpdateMode; }
 
+    /** Set the bound growth of the moved instances above which a refit TLAS is rebuilt instead.
+        The bound growth is the surface area the instance bounds grew by since the last rebuild, relative to the
+        total surface area of the instance bounds. Only used with UpdateMode::Refit.
+    */
+    void setTlasRebuildBoundGrowth(float growth) { mTlasInstanceOptions.rebuildBoundGrowth = growth; }
+
+    /** Get the bound growth above which a refit TLAS is rebuilt instead.
+    */
+    float getTlasRebuildBoundGrowth() const { return mTlasInstanceOptions.rebuildBoundGrowth; }
+
     /** Set how the scene's BLASes are updated when raytracing.
         BLASes are REFIT by default.
     */
@@ -1103,6 +1124,57 @@ public:
         ref<FrustumCulling> pFrustumCulling = nullptr
     );
 
+    /** Enable/disable CPU occlusion culling in rasterizeFrustumCulling().
+        Occlusion culling is only applied when culling against the selected camera. It requires occluder hulls, which are
+        built at scene creation when the "OcclusionCulling:enabled" setting is set.
+    */
+    void setOcclusionCullingEnabled(bool enabled);
+
+    /** Returns true if CPU occlusion culling is enabled.
+    */
+    bool isOcclusionCullingEnabled() const { return mOcclusionCullingEnabled; }
+
+    /** Get the occlusion culling object, or nullptr if no occluder hulls were built.
+    */
+    const ref<OcclusionCulling>& getOcclusionCulling() const { return mpOcclusionCulling; }
+
+    /** Cull the geometry instances against multiple views in one pass, e.g. for stereo rendering or shadow cascades.
+        World-space instance bounds are cached and only recomputed when the instance transform changes.
+        Skinned meshes and instances of geometry types without bounds are always visible.
+        \param[in] viewProjs View-projection matrices, one per view.
+        \return Per-view visibility bitsets and compacted lists of visible instances, indexed by geometry instance ID. Valid until the next call.
+    */
+    const MultiViewCulling& cullViews(const std::vector<float4x4>& viewProjs);
+
+    /** Get the visible instances of a draw group for a view from the last call to cullViews().
+        \param[in] viewIndex View index.
+        \param[in] drawGroup Draw group index. There is one draw group per indirect draw issued by rasterize().
+        \param[out] instanceIDs Visible instance IDs, in the order used for the draw arguments of the group.
+    */
+    void getVisibleDrawInstances(uint32_t viewIndex, uint32_t drawGroup, std::vector<uint32_t>& instanceIDs) const;
+
+    /** Get the number of draw groups.
+    */
+    uint32_t getDrawGroupCount() const { return (uint32_t)mDrawArgsInstanceIDs.size(); }
+
+    /** Get the simplified levels of detail of a mesh, ordered from fine to coarse.
+        Levels are generated by the scene builder when the SceneBuilder::Flags::GenerateMeshLods flag is set. They share the vertices of the mesh.
+        \param[in] meshID Mesh ID.
+        \return List of levels, or an empty list if none were generated.
+    */
+    const std::vector<MeshLod>& getMeshLods(MeshID meshID) const;
+
+    /** Select a level of detail per geometry instance by projected screen-space error.
+        For each mesh instance, the coarsest level is chosen whose error, scaled by the instance transform and projected at
+        the closest point of the instance bounds, is at most maxPixelError pixels.
+        \param[in] pCamera Camera used for the projection.
+        \param[in] viewportHeight Viewport height in pixels.
+        \param[in] maxPixelError Max projected error in pixels.
+        \param[out] levels Level per geometry instance. Level 0 is the full resolution mesh and level i > 0 is getMeshLods()[i - 1].
+                    Instances of other geometry types are always at level 0.
+    */
+    void selectMeshLods(const ref<Camera>& pCamera, uint32_t viewportHeight, float maxPixelError, std::vector<uint32_t>& levels) const;
+
     /** Get the required raytracing maximum attribute size for this scene.
         Note: This depends on what types of geometry are used in the scene.
         \return Max attribute size in bytes.
@@ -1272,6 +1344,13 @@ private:
         const std::vector<SkinningVertexData>& skinningData
     );
     void createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData);
+    void createOccluderHulls(
+        const std::vector<MeshDesc>& meshDesc,
+        const std::vector<uint32_t>& indexData,
+        const std::vector<PackedStaticVertexData>& staticData
+    );
+    void updateOcclusionCulling(const ref<Camera>& pCamera);
+    void updateInstanceBounds(bool forceUpdate);
     void createMeshUVTiles(
         const std::vector<MeshDesc>& meshDesc,
         const std::vector<uint32_t>& indexData,
@@ -1339,8 +1418,18 @@ private:
 
     /** Generate data for creating a TLAS.
         #SCENE TODO: Add argument to build descs based off a draw list.
+        \param[out] instanceDescs Instance descs.
+        \param[out] matrixIDs Global matrix ID per instance desc, or kInvalidMatrixID if the transform of the instance is fixed.
     */
-    void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+    void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& matrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+
+    /** Get the world-space bounds of the geometry instances referenced by an instance desc.
+    */
+    AABB getInstanceDescBounds(const std::vector<RtInstanceDesc>& instanceDescs, uint32_t index) const;
+
+    /** Patch the transforms of the moved instances in the instance descs of all valid TLASes.
+    */
+    void updateTlasInstances();
 
     /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
         \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1376,6 +1465,7 @@ private:
     UpdateFlags updateGridVolumes(bool forceUpdate);
     UpdateFlags updateEnvMap(bool forceUpdate);
     UpdateFlags updateMaterials(bool forceUpdate);
+    void updateAlphaCoverage();
     UpdateFlags updateGeometry(RenderContext* pRenderContext, bool forceUpdate);
     UpdateFlags updateProceduralPrimitives(bool forceUpdate);
     UpdateFlags updateParticles(RenderContext* pRenderContext, bool forceUpdate);
@@ -1428,6 +1518,14 @@ private:
     uint mFrustumCullingSelectedCamera = 0;              ///< Selected Camera for Frustum Culling
     bool mFrustumCullingUpdated = false;                 ///< Records if culling was updated this frame
 
+    MultiViewCulling mInstanceCulling;                   ///< Cached world-space bounds of the geometry instances and multi-view culling results.
+
+    // Occlusion Culling
+    ref<OcclusionCulling> mpOcclusionCulling;            ///< CPU occlusion culling, only created if occluder hulls were built.
+    std::vector<uint32_t> mMeshHullIDs;                  ///< Occluder hull ID per mesh, or OcclusionCulling::kInvalidHullID.
+    bool mOcclusionCullingEnabled = false;               ///< Apply occlusion culling in rasterizeFrustumCulling().
+    bool mOcclusionCullingValid = false;                 ///< True if the depth buffer is up to date with the camera and geometry.
+
     // GPU CPU per frame sync
     ref<GpuFence> mpFence;        ///< Fence for GPU/CPU sync. Will record the GPU Counter once per update
     uint mFenceSyncLastFrame = 0; ///< Sync value for last frame
@@ -1436,6 +1534,29 @@ private:
     std::vector<MeshDesc> mMeshDesc;                  ///< Copy of mesh data GPU buffer (mpMeshesBuffer).
     std::vector<std::vector<Rectangle>> mMeshUVTiles; ///< Bounding tiles for the mesh UVs
     std::vector<MeshGroup> mMeshGroups;               ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
+    std::vector<std::vector<MeshLod>> mMeshLods;      ///< Simplified levels of detail per mesh, or empty if not generated.
+    std::vector<uint32_t> mMeshAlphaCoverage;         ///< Per-mesh word offsets followed by per-triangle alpha opaque bits, or empty if not classified.
+
+    /** Material state the alpha coverage classification depends on.
+    */
+    struct AlphaCoverageState
+    {
+        AlphaMode alphaMode = AlphaMode::Opaque;
+        float alphaThreshold = 0.f;
+        ref<Texture> pTexture;
+        Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap;
+        Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap;
+
+        static AlphaCoverageState get(const ref<Material>& pMaterial);
+
+        bool operator==(const AlphaCoverageState& other) const
+        {
+            return alphaMode == other.alphaMode && alphaThreshold == other.alphaThreshold && pTexture == other.pTexture &&
+                   addressModeU == other.addressModeU && addressModeV == other.addressModeV;
+        }
+        bool operator!=(const AlphaCoverageState& other) const { return !(*this == other); }
+    };
+    std::vector<AlphaCoverageState> mMaterialAlphaCoverageStates; ///< Per-material state the alpha coverage was classified with, or empty if not classified.
     std::vector<std::string> mMeshNames;              ///< Mesh names, indxed by mesh ID
     std::vector<Node> mSceneGraph; ///< For each index i, the array element indicates the parent node. Indices are in relation to
                                    ///< mLocalToWorldMatrices.
@@ -1524,6 +1645,7 @@ private:
     // Scene block resources
     ref<Buffer> mpGeometryInstancesBuffer;
     ref<Buffer> mpMeshesBuffer;
+    ref<Buffer> mpAlphaCoverageBuffer;
     ref<Buffer> mpCurvesBuffer;
     ref<Buffer> mpCustomPrimitivesBuffer;
     ref<Buffer> mpLightsBuffer;
@@ -1566,13 +1688,16 @@ private:
     UpdateMode mBlasUpdateMode = UpdateMode::Refit;           ///< How the BLAS should be updated when there are changes to meshes.
     UpdateMode mBlasParticleUpdateMode = UpdateMode::Rebuild; ///< How the particle BLAS should be updated when there are changes to meshes.
 
-    std::vector<RtInstanceDesc> mInstanceDescs; ///< Shared between TLAS builds to avoid reallocating CPU memory.
+    static constexpr uint32_t kInvalidMatrixID = uint32_t(-1);
+    std::vector<uint32_t> mInstanceDescMatrixIDs; ///< Global matrix ID per TLAS instance desc, or kInvalidMatrixID if the transform is fixed.
+    TlasInstanceUpdater::Options mTlasInstanceOptions;
 
     struct TlasData
     {
         ref<RtAccelerationStructure> pTlasObject;
         ref<Buffer> pTlasBuffer;
         ref<Buffer> pInstanceDescs;                  ///< Buffer holding instance descs for the TLAS.
+        TlasInstanceUpdater instances;               ///< CPU copy of the instance descs. Only the moved instances are patched and uploaded.
         UpdateMode updateMode = UpdateMode::Rebuild; ///< Update mode this TLAS was created with.
     };
 
@@ -28,18 +28,30 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "AlphaCoverageMap.h"
+#include "MeshInstanceDetector.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
+#include "Core/API/RenderContext.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/Timing/TraceRecorder.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/FastHash.h"
+#include "Utils/StringUtils.h"
 #include "Utils/ObjectIDPython.h"
 #include <mikktspace.h>
+#include <algorithm>
+#include <execution>
 #include <filesystem>
 #include <cmath>
+#include <map>
+#include <tuple>
 
 namespace Falcor
 {
@@ -204,13 +216,76 @@ std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
     return indexData;
 }
 
-SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
+VertexCacheStreamingDesc getVertexCacheStreamingDesc(const Settings& settings)
+{
+    VertexCacheStreamingDesc desc;
+    desc.enabled = settings.getOption("AnimatedVertexCache:streaming", desc.enabled);
+    desc.memoryBudget = settings.getOption("AnimatedVertexCache:memoryBudgetMB", desc.memoryBudget >> 20) << 20;
+    desc.deltaCompression = settings.getOption("AnimatedVertexCache:deltaCompression", desc.deltaCompression);
+    desc.storePath = settings.getOption("AnimatedVertexCache:storePath", std::string());
+    return desc;
+}
+
+std::optional<MeshLodGenerator::Options> getMeshLodOptions(SceneBuilder::Flags buildFlags, const Settings& settings)
+{
+    if (!is_set(buildFlags, SceneBuilder::Flags::GenerateMeshLods))
+        return {};
+
+    MeshLodGenerator::Options options;
+    uint32_t levelCount = settings.getOption("MeshLod:levelCount", (uint32_t)options.targetRatios.size());
+    float levelRatio = settings.getOption("MeshLod:levelRatio", 0.5f);
+    options.targetRatios.clear();
+    for (uint32_t i = 1; i <= levelCount; i++)
+        options.targetRatios.push_back(std::pow(levelRatio, (float)i));
+    options.maxError = settings.getOption("MeshLod:maxError", options.maxError);
+    options.minTriangleCount = settings.getOption("MeshLod:minTriangleCount", options.minTriangleCount);
+    return options;
+}
+
+std::optional<MeshInstanceDetector::Options> getMeshInstanceDetectorOptions(const Settings& settings)
+{
+    if (!settings.getOption("AutoInstancing:enabled", false))
+        return {};
+
+    MeshInstanceDetector::Options options;
+    options.positionTolerance = settings.getOption("AutoInstancing:positionTolerance", options.positionTolerance);
+    options.directionTolerance = settings.getOption("AutoInstancing:directionTolerance", options.directionTolerance);
+    options.texCrdTolerance = settings.getOption("AutoInstancing:texCrdTolerance", options.texCrdTolerance);
+    options.rigidOnly = settings.getOption("AutoInstancing:rigidOnly", options.rigidOnly);
+    return options;
+}
+
+SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags, const Settings& settings)
 {
     SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
     SHA1 sha1;
     auto pathStr = path.string();
     sha1.update(pathStr.data(), pathStr.size());
     sha1.update(&cacheFlags, sizeof(cacheFlags));
+    // Mesh LODs are stored in the cache, so the options that affect them are part of the key.
+    if (auto lodOptions = getMeshLodOptions(buildFlags, settings))
+    {
+        sha1.update(lodOptions->targetRatios.data(), lodOptions->targetRatios.size() * sizeof(float));
+        sha1.update(&lodOptions->maxError, sizeof(lodOptions->maxError));
+        sha1.update(&lodOptions->minTriangleCount, sizeof(lodOptions->minTriangleCount));
+        sha1.update(&lodOptions->minReduction, sizeof(lodOptions->minReduction));
+    }
+    // The alpha coverage classification modifies the index data and is stored in the cache.
+    if (settings.getOption("AlphaCoverage:enabled", false))
+    {
+        uint32_t maxMipLevel = settings.getOption("AlphaCoverage:maxMipLevel", 0u);
+        bool dropTransparent = settings.getOption("AlphaCoverage:dropTransparent", false);
+        sha1.update(&maxMipLevel, sizeof(maxMipLevel));
+        sha1.update(&dropTransparent, sizeof(dropTransparent));
+    }
+    // Automatic instancing changes the meshes and the scene graph.
+    if (auto instancingOptions = getMeshInstanceDetectorOptions(settings))
+    {
+        sha1.update(&instancingOptions->positionTolerance, sizeof(instancingOptions->positionTolerance));
+        sha1.update(&instancingOptions->directionTolerance, sizeof(instancingOptions->directionTolerance));
+        sha1.update(&instancingOptions->texCrdTolerance, sizeof(instancingOptions->texCrdTolerance));
+        sha1.update(&instancingOptions->rigidOnly, sizeof(instancingOptions->rigidOnly));
+    }
     return sha1.finalize();
 }
 } // namespace
@@ -231,8 +306,8 @@ SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& pat
         throw ImporterError(path, "Can't find scene file '{}'.", path);
     }
 
-    // Compute scene cache key based on absolute scene path and build flags.
-    mSceneCacheKey = computeSceneCacheKey(fullPath, flags);
+    // Compute scene cache key based on absolute scene path, build flags and settings affecting the cached data.
+    mSceneCacheKey = computeSceneCacheKey(fullPath, flags, settings);
 
     // Determine if scene cache should be written after import.
     bool useCache = is_set(flags, Flags::UseCache);
@@ -244,7 +319,10 @@ SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& pat
     {
         try
         {
-            mpScene = Scene::create(pDevice, SceneCache::readCache(pDevice, mSceneCacheKey));
+            Scene::SceneData sceneData = SceneCache::readCache(pDevice, mSceneCacheKey);
+            sceneData.vertexCacheStreaming = getVertexCacheStreamingDesc(mSettings);
+            sceneData.occlusionCulling = mSettings.getOption("OcclusionCulling:enabled", false);
+            mpScene = Scene::create(pDevice, std::move(sceneData));
             return;
         }
         catch (const std::exception& e)
@@ -311,6 +389,8 @@ ref<Scene> SceneBuilder::getScene()
     if (mpScene)
         return mpScene;
 
+    FALCOR_TRACE_SCOPE("SceneBuilder::getScene");
+
     // Finish loading textures. This blocks until all textures are loaded and assigned.
     mpMaterialTextureLoader.reset();
 
@@ -338,6 +418,7 @@ ref<Scene> SceneBuilder::getScene()
     prepareSceneGraph();
     prepareMeshes();
     removeUnusedMeshes();
+    detectMeshInstances();
     flattenStaticMeshInstances();
     pretransformStaticMeshes();
     unifyTriangleWinding();
@@ -346,6 +427,7 @@ ref<Scene> SceneBuilder::getScene()
     createMeshGroups();
     optimizeGeometry();
     sortMeshes();
+    generateMeshLods();
     createGlobalBuffers();
     createCurveGlobalBuffers();
     collectVolumeGrids();
@@ -359,6 +441,10 @@ ref<Scene> SceneBuilder::getScene()
 
     timeReport.measure("Optimizing materials");
 
+    classifyAlphaCoverage();
+
+    timeReport.measure("Classifying alpha coverage");
+
     // Prepare scene resources.
     createSceneGraph();
     createMeshData();
@@ -384,6 +470,8 @@ ref<Scene> SceneBuilder::getScene()
     }
 
     // Create the scene object.
+    mSceneData.vertexCacheStreaming = getVertexCacheStreamingDesc(mSettings);
+    mSceneData.occlusionCulling = mSettings.getOption("OcclusionCulling:enabled", false);
     mpScene = Scene::create(mpDevice, std::move(mSceneData));
     mSceneData = {};
 
@@ -758,6 +846,11 @@ void SceneBuilder::setCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
     mSceneData.cachedMeshes = std::move(cachedMeshes);
 }
 
+VertexCacheStreamingDesc SceneBuilder::getVertexCacheStreaming() const
+{
+    return getVertexCacheStreamingDesc(mSettings);
+}
+
 void SceneBuilder::addParticleSystem(
     const std::string name,
     const ref<Material>& pMaterial,
@@ -1037,6 +1130,25 @@ SdfDescID SceneBuilder::addSDFGrid(const ref<SDFGrid>& pSDFGrid, const ref<Mater
     return SdfDescID(mSceneData.sdfGridDesc.size() - 1);
 }
 
+float4x4 SceneBuilder::bakeMeshSDF(MeshID meshID, const ref<SDFGrid>& pSDFGrid, uint32_t gridWidth, SDFMeshBaker::SignMode signMode, float narrowBandWidth)
+{
+    checkArgument(meshID.get() < mMeshes.size(), "'meshID' ({}) is out of range", meshID);
+    checkArgument(pSDFGrid != nullptr, "'pSDFGrid' is missing");
+
+    const auto& mesh = mMeshes[meshID.get()];
+    checkArgument(mesh.topology == Vao::Topology::TriangleList, "Mesh '{}' is not a triangle list", mesh.name);
+    if (mesh.staticData.size() != mesh.vertexCount)
+        throw RuntimeError("Vertex data of mesh '{}' is no longer available. Meshes must be baked before the scene is built.", mesh.name);
+
+    std::vector<float3> positions(mesh.vertexCount);
+    for (uint32_t i = 0; i < mesh.vertexCount; i++) positions[i] = mesh.staticData[i].position;
+
+    std::vector<uint32_t> indices(mesh.indexCount > 0 ? mesh.indexCount : mesh.vertexCount);
+    for (uint32_t i = 0; i < (uint32_t)indices.size(); i++) indices[i] = mesh.indexCount > 0 ? mesh.getIndex(i) : i;
+
+    return pSDFGrid->bakeMesh(positions, indices, gridWidth, signMode, narrowBandWidth);
+}
+
 // Materials
 
 MaterialID SceneBuilder::addMaterial(const ref<Material>& pMaterial)
@@ -1576,56 +1688,162 @@ void SceneBuilder::removeUnusedMeshes()
     if (unusedCount > 0)
     {
         logWarning("Scene has {} unused meshes that will be removed.", unusedCount);
+        removeMeshesWithoutInstances();
+    }
+}
 
-        const size_t meshCount = mMeshes.size();
-        MeshList meshes;
-        meshes.reserve(meshCount);
+void SceneBuilder::removeMeshesWithoutInstances()
+{
+    // This function removes all meshes that are not referenced by the scene graph
+    // and updates the mesh IDs in the scene graph nodes and the vertex caches.
 
-        for (MeshID meshID{0}; meshID.get() < (uint32_t)meshCount; ++meshID)
-        {
-            auto& mesh = mMeshes[meshID.get()];
-            if (mesh.instances.empty())
-                continue; // Skip unused meshes
+    const size_t meshCount = mMeshes.size();
+    MeshList meshes;
+    meshes.reserve(meshCount);
 
-            // Get new mesh ID.
-            const MeshID newMeshID(meshes.size());
+    for (MeshID meshID{0}; meshID.get() < (uint32_t)meshCount; ++meshID)
+    {
+        auto& mesh = mMeshes[meshID.get()];
+        if (mesh.instances.empty())
+            continue; // Skip unused meshes
 
-            // Update the mesh IDs in the scene graph nodes.
-            for (const auto& nodeID : mesh.instances)
-            {
-                FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
-                auto& node = mSceneGraph[nodeID.get()];
-                std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
-            }
+        // Get new mesh ID.
+        const MeshID newMeshID(meshes.size());
 
-            // Update the mesh IDs of cached meshes.
-            for (auto& cachedMesh : mSceneData.cachedMeshes)
-            {
-                if (cachedMesh.meshID == meshID)
-                    cachedMesh.meshID = newMeshID;
-            }
-            for (auto& cache : mSceneData.cachedCurves)
+        // Update the mesh IDs in the scene graph nodes.
+        for (const auto& nodeID : mesh.instances)
+        {
+            FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
+            auto& node = mSceneGraph[nodeID.get()];
+            std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+        }
+
+        // Update the mesh IDs of cached meshes.
+        for (auto& cachedMesh : mSceneData.cachedMeshes)
+        {
+            if (cachedMesh.meshID == meshID)
+                cachedMesh.meshID = newMeshID;
+        }
+        for (auto& cache : mSceneData.cachedCurves)
+        {
+            if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
             {
-                if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
-                {
-                    if (cache.geometryID == CurveOrMeshID{meshID})
-                        cache.geometryID = CurveOrMeshID{newMeshID};
-                }
+                if (cache.geometryID == CurveOrMeshID{meshID})
+                    cache.geometryID = CurveOrMeshID{newMeshID};
             }
-
-            meshes.push_back(std::move(mesh));
         }
 
-        mMeshes = std::move(meshes);
+        meshes.push_back(std::move(mesh));
+    }
+
+    mMeshes = std::move(meshes);
+
+    // Validate scene graph.
+    for (const auto& node : mSceneGraph)
+    {
+        for (MeshID meshID : node.meshes)
+            FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+    }
+}
+
+void SceneBuilder::detectMeshInstances()
+{
+    // This function optionally detects meshes that are identical up to a rigid or affine transform, which is common in
+    // scenes exported without instancing information. Each duplicate is replaced by an instance of a single mesh, using a
+    // new scene graph node with the transform between the meshes below each node that instantiated the duplicate.
+    // The pass needs to run before static meshes are pre-transformed to world space, as it relies on the instancing.
+
+    auto options = getMeshInstanceDetectorOptions(mSettings);
+    if (!options)
+        return;
+    if (is_set(mFlags, Flags::FlattenStaticMeshInstances))
+    {
+        logWarning("Automatic mesh instancing is ignored as static mesh instances are flattened.");
+        return;
+    }
+
+    CpuTimer timer;
+    timer.update();
 
-        // Validate scene graph.
-        FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
-        for (const auto& node : mSceneGraph)
+    // Collect the meshes that can be instanced. Dynamic, displaced and particle meshes are left empty, so they are never matched.
+    std::vector<MeshInstanceDetector::MeshData> meshData(mMeshes.size());
+    for (size_t i = 0; i < mMeshes.size(); i++)
+    {
+        const MeshSpec& mesh = mMeshes[i];
+        if (mesh.topology != Vao::Topology::TriangleList || mesh.isDynamic() || mesh.isParticle() ||
+            mSceneData.pMaterials->getMaterial(mesh.materialId)->isDisplaced())
+            continue;
+
+        FastHash key;
+        key.update(mesh.materialId.get());
+        key.update(mesh.indexCount);
+        key.update(mesh.use16BitIndices);
+        key.update(mesh.isFrontFaceCW);
+        key.update(mesh.isCastShadow);
+
+        auto& data = meshData[i];
+        data.pVertices = mesh.staticData.data();
+        data.vertexCount = (uint32_t)mesh.staticData.size();
+        data.pIndexData = mesh.indexData.empty() ? nullptr : mesh.indexData.data();
+        data.indexDataSize = (uint32_t)mesh.indexData.size();
+        data.key = key.digest64();
+    }
+
+    auto matches = MeshInstanceDetector::detect(meshData, *options);
+    meshData.clear();
+
+    timer.update();
+
+    if (matches.empty())
+    {
+        logInfo("Detected no mesh instances in {:.2f} s.", timer.delta());
+        return;
+    }
+
+    const size_t prevMeshCount = mMeshes.size();
+    uint64_t prevTriangleCount = 0;
+    for (const auto& mesh : mMeshes)
+        prevTriangleCount += mesh.topology == Vao::Topology::TriangleList ? mesh.getTriangleCount() : 0;
+
+    // Replace each duplicate by instances of its base mesh, transformed relative to the nodes of the duplicate.
+    // The saved memory is counted in the packed GPU vertex format, as stored in the scene's vertex buffer.
+    size_t savedGpuBytes = 0;
+    for (const auto& match : matches)
+    {
+        const MeshID meshID{match.meshIndex};
+        const MeshID baseMeshID{match.baseIndex};
+        auto& mesh = mMeshes[meshID.get()];
+        savedGpuBytes += mesh.staticData.size() * sizeof(PackedStaticVertexData) + mesh.indexData.size() * sizeof(uint32_t);
+
+        for (NodeID nodeID : mesh.instances)
         {
-            for (MeshID meshID : node.meshes)
-                FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+            auto& nodeMeshes = mSceneGraph[nodeID.get()].meshes;
+            auto it = std::find(nodeMeshes.begin(), nodeMeshes.end(), meshID);
+            FALCOR_ASSERT(it != nodeMeshes.end());
+            nodeMeshes.erase(it);
+
+            NodeID instanceNodeID = addNode(Node{mesh.name, match.transform, float4x4::identity(), float4x4::identity(), nodeID});
+            mSceneGraph[instanceNodeID.get()].meshes.push_back(baseMeshID);
+            mMeshes[baseMeshID.get()].instances.insert(instanceNodeID);
         }
+        mesh.instances.clear();
     }
+
+    removeMeshesWithoutInstances();
+
+    uint64_t triangleCount = 0;
+    for (const auto& mesh : mMeshes)
+        triangleCount += mesh.topology == Vao::Topology::TriangleList ? mesh.getTriangleCount() : 0;
+
+    // Every mesh is a geometry in a BLAS, so the BLAS geometry and triangle counts drop by the merged meshes.
+    logInfo(
+        "Detected {} mesh instances in {:.2f} s, saving {} of GPU vertex and index data.",
+        matches.size(),
+        timer.delta(),
+        formatByteSize(savedGpuBytes)
+    );
+    logInfo("  BLAS geometries: {} -> {}", prevMeshCount, mMeshes.size());
+    logInfo("  BLAS triangles: {} -> {}", prevTriangleCount, triangleCount);
 }
 
 void SceneBuilder::flattenStaticMeshInstances()
@@ -2705,6 +2923,75 @@ void SceneBuilder::sortMeshes()
     }
 }
 
+void SceneBuilder::generateMeshLods()
+{
+    // This function generates a chain of simplified levels of detail for the static triangle meshes, if enabled by the build flags.
+    // The levels only contain new index data, the vertices are shared with the full resolution mesh.
+    // Meshes are simplified independently of each other, so we process them in parallel.
+
+    auto options = getMeshLodOptions(mFlags, mSettings);
+    if (!options || options->targetRatios.empty())
+        return;
+
+    CpuTimer timer;
+    timer.update();
+
+    NumericRange<size_t> meshRange(0, mMeshes.size());
+    std::for_each(
+        std::execution::par,
+        meshRange.begin(),
+        meshRange.end(),
+        [&](size_t meshIndex)
+        {
+            MeshSpec& mesh = mMeshes[meshIndex];
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || mesh.isDynamic() || mesh.isParticle() ||
+                mesh.isDisplaced)
+                return;
+
+            std::vector<float3> positions(mesh.staticData.size());
+            for (size_t i = 0; i < positions.size(); i++)
+                positions[i] = mesh.staticData[i].position;
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (size_t i = 0; i < indices.size(); i++)
+                indices[i] = mesh.getIndex(i);
+
+            mesh.lods = MeshLodGenerator::generate(positions.data(), (uint32_t)positions.size(), indices, *options);
+        }
+    );
+
+    timer.update();
+
+    // Report the number of unique triangles per level. Meshes without a level are counted at their coarsest level.
+    size_t lodMeshCount = 0;
+    uint64_t triangleCount = 0;
+    std::vector<uint64_t> levelTriangleCounts(options->targetRatios.size(), 0);
+    for (const auto& mesh : mMeshes)
+    {
+        if (mesh.topology != Vao::Topology::TriangleList)
+            continue;
+        if (!mesh.lods.empty())
+            lodMeshCount++;
+        triangleCount += mesh.getTriangleCount();
+        for (size_t level = 0; level < levelTriangleCounts.size(); level++)
+        {
+            levelTriangleCounts[level] +=
+                mesh.lods.empty() ? mesh.getTriangleCount() : mesh.lods[std::min(level, mesh.lods.size() - 1)].getTriangleCount();
+        }
+    }
+
+    logInfo("Generated mesh LODs for {} of {} meshes in {:.2f} s.", lodMeshCount, mMeshes.size(), timer.delta());
+    logInfo("  Level 0: {} triangles", triangleCount);
+    for (size_t level = 0; level < levelTriangleCounts.size(); level++)
+    {
+        logInfo(
+            "  Level {}: {} triangles ({:.1f}%)",
+            level + 1,
+            levelTriangleCounts[level],
+            triangleCount > 0 ? 100.0 * levelTriangleCounts[level] / triangleCount : 0.0
+        );
+    }
+}
+
 void SceneBuilder::createGlobalBuffers()
 {
     FALCOR_ASSERT(mSceneData.meshIndexData.empty());
@@ -2884,6 +3171,165 @@ void SceneBuilder::removeDuplicateMaterials()
     }
 }
 
+void SceneBuilder::classifyAlphaCoverage()
+{
+    // This function classifies the triangles of alpha-tested meshes by the alpha values their texture coordinates can sample.
+    // Triangles that always pass the alpha test are flagged, so that any-hit shaders can skip it (see Scene::isTriangleAlphaOpaque()).
+    // The scene drops the flags of a mesh when its material's alpha test state changes at runtime.
+    // With "AlphaCoverage:dropTransparent", triangles that never pass are removed by making them degenerate, which keeps the primitive
+    // indices of the other triangles. This is opt-in, as the removed triangles cannot be restored if the material changes later.
+    // The classification is conservative for bilinear sampling of the texture mips up to "AlphaCoverage:maxMipLevel".
+    // It runs after the material optimizations, as these may turn alpha-tested materials into opaque ones.
+
+    if (!mSettings.getOption("AlphaCoverage:enabled", false))
+        return;
+
+    CpuTimer timer;
+    timer.update();
+
+    AlphaCoverageMap::Desc desc;
+    desc.maxMipLevel = mSettings.getOption("AlphaCoverage:maxMipLevel", desc.maxMipLevel);
+    const bool dropTransparent = mSettings.getOption("AlphaCoverage:dropTransparent", false);
+
+    // Build the alpha coverage maps of the alpha-tested materials. Materials sharing a texture and address modes share a map.
+    // The base color texture is converted to RGBA8 on the GPU and read back.
+    const MaterialSystem& materials = *mSceneData.pMaterials;
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    std::vector<int32_t> materialMaps(materials.getMaterialCount(), -1);
+    std::vector<std::unique_ptr<AlphaCoverageMap>> maps;
+    std::map<std::tuple<const Texture*, Sampler::AddressMode, Sampler::AddressMode>, int32_t> mapIndices;
+
+    for (MaterialID materialID{0}; materialID.get() < materials.getMaterialCount(); ++materialID)
+    {
+        auto pMaterial = materials.getMaterial(materialID)->toBasicMaterial();
+        if (!pMaterial || pMaterial->getAlphaMode() != AlphaMode::Mask)
+            continue;
+        ref<Texture> pTexture = pMaterial->getBaseColorTexture();
+        if (!pTexture || !doesFormatHaveAlpha(pTexture->getFormat()))
+            continue;
+
+        ref<Sampler> pSampler = pMaterial->getDefaultTextureSampler();
+        desc.addressModeU = pSampler ? pSampler->getAddressModeU() : Sampler::AddressMode::Wrap;
+        desc.addressModeV = pSampler ? pSampler->getAddressModeV() : Sampler::AddressMode::Wrap;
+
+        auto key = std::make_tuple(pTexture.get(), desc.addressModeU, desc.addressModeV);
+        auto it = mapIndices.find(key);
+        if (it == mapIndices.end())
+        {
+            ref<Texture> pStaging = Texture::create2D(
+                mpDevice, pTexture->getWidth(), pTexture->getHeight(), ResourceFormat::RGBA8Unorm, 1, 1, nullptr,
+                ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
+            );
+            pRenderContext->blit(pTexture->getSRV(0, 1, 0, 1), pStaging->getRTV(0, 0, 1));
+            std::vector<uint8_t> texels = pRenderContext->readTextureSubresource(pStaging.get(), 0);
+            FALCOR_ASSERT(texels.size() == (size_t)pTexture->getWidth() * pTexture->getHeight() * 4);
+
+            it = mapIndices.emplace(key, (int32_t)maps.size()).first;
+            maps.push_back(std::make_unique<AlphaCoverageMap>(pTexture->getWidth(), pTexture->getHeight(), texels.data() + 3, 4, desc));
+        }
+        materialMaps[materialID.get()] = it->second;
+    }
+
+    if (maps.empty())
+        return;
+
+    // Classify the triangles of each mesh in parallel.
+    struct MeshCoverage
+    {
+        std::vector<uint32_t> opaqueBits;
+        uint64_t counts[3] = {};
+    };
+    std::vector<MeshCoverage> coverage(mMeshes.size());
+
+    NumericRange<size_t> meshRange(0, mMeshes.size());
+    std::for_each(
+        std::execution::par,
+        meshRange.begin(),
+        meshRange.end(),
+        [&](size_t meshIndex)
+        {
+            const MeshSpec& mesh = mMeshes[meshIndex];
+            if (mesh.topology != Vao::Topology::TriangleList || materialMaps[mesh.materialId.get()] < 0)
+                return;
+
+            const AlphaCoverageMap& map = *maps[materialMaps[mesh.materialId.get()]];
+            const float threshold = materials.getMaterial(mesh.materialId)->getAlphaThreshold();
+
+            // Indices are packed per mesh in 16 or 32 bits in the global index data.
+            uint32_t* pIndices32 = mesh.indexCount > 0 ? mSceneData.meshIndexData.data() + mesh.indexOffset : nullptr;
+            uint16_t* pIndices16 = reinterpret_cast<uint16_t*>(pIndices32);
+            auto getIndex = [&](uint32_t i) { return !pIndices32 ? i : mesh.use16BitIndices ? pIndices16[i] : pIndices32[i]; };
+            auto getTexCrd = [&](uint32_t i) { return mSceneData.meshStaticData[mesh.staticVertexOffset + getIndex(i)].texCrd; };
+
+            MeshCoverage& result = coverage[meshIndex];
+            const uint32_t triangleCount = mesh.getTriangleCount();
+            result.opaqueBits.assign((triangleCount + 31) / 32, 0);
+
+            for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+            {
+                AlphaCoverage c = map.classify(getTexCrd(3 * triangle), getTexCrd(3 * triangle + 1), getTexCrd(3 * triangle + 2), threshold);
+                result.counts[(uint32_t)c]++;
+
+                if (c == AlphaCoverage::Opaque)
+                {
+                    result.opaqueBits[triangle / 32] |= 1u << (triangle % 32);
+                }
+                else if (c == AlphaCoverage::Transparent && dropTransparent && pIndices32)
+                {
+                    // Degenerate triangles are inactive in acceleration structures and not rasterized.
+                    uint32_t index = getIndex(3 * triangle);
+                    for (uint32_t i = 3 * triangle + 1; i < 3 * triangle + 3; i++)
+                    {
+                        if (mesh.use16BitIndices)
+                            pIndices16[i] = (uint16_t)index;
+                        else
+                            pIndices32[i] = index;
+                    }
+                }
+            }
+        }
+    );
+
+    // Pack the per-mesh opaque bits behind a table of word offsets indexed by mesh ID.
+    auto& data = mSceneData.meshAlphaCoverage;
+    data.assign(mMeshes.size(), 0);
+    uint64_t counts[3] = {};
+    size_t meshCount = 0;
+    for (size_t meshIndex = 0; meshIndex < mMeshes.size(); meshIndex++)
+    {
+        const MeshCoverage& result = coverage[meshIndex];
+        if (result.opaqueBits.empty())
+            continue;
+        data[meshIndex] = (uint32_t)data.size();
+        data.insert(data.end(), result.opaqueBits.begin(), result.opaqueBits.end());
+        for (uint32_t i = 0; i < 3; i++)
+            counts[i] += result.counts[i];
+        meshCount++;
+    }
+    if (meshCount == 0)
+    {
+        data.clear();
+        return;
+    }
+
+    timer.update();
+
+    const uint64_t triangleCount = counts[0] + counts[1] + counts[2];
+    auto percent = [&](AlphaCoverage c) { return triangleCount > 0 ? 100.0 * counts[(uint32_t)c] / triangleCount : 0.0; };
+    logInfo(
+        "Classified alpha coverage of {} triangles in {} meshes using {} textures in {:.2f} s: "
+        "{:.1f}% opaque, {:.1f}% transparent{}, {:.1f}% unknown.",
+        triangleCount,
+        meshCount,
+        maps.size(),
+        timer.delta(),
+        percent(AlphaCoverage::Opaque),
+        percent(AlphaCoverage::Transparent),
+        dropTransparent ? " (removed)" : "",
+        percent(AlphaCoverage::Unknown)
+    );
+}
+
 void SceneBuilder::collectVolumeGrids()
 {
     // Collect grids from volumes.
@@ -2991,6 +3437,14 @@ void SceneBuilder::createMeshData()
     auto& meshData = mSceneData.meshDesc;
     meshData.resize(mMeshes.size());
 
+    // Move the mesh LODs, if any were generated.
+    if (std::any_of(mMeshes.begin(), mMeshes.end(), [](const MeshSpec& mesh) { return !mesh.lods.empty(); }))
+    {
+        mSceneData.meshLods.resize(mMeshes.size());
+        for (uint32_t meshID = 0; meshID < mMeshes.size(); meshID++)
+            mSceneData.meshLods[meshID] = std::move(mMeshes[meshID].lods);
+    }
+
     // Setup all mesh data.
     for (uint32_t meshID = 0; meshID < mMeshes.size(); meshID++)
     {
@@ -3278,6 +3732,7 @@ FALCOR_SCRIPT_BINDING(SceneBuilder)
     flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
     flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
     flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+    flags.value("GenerateMeshLods", SceneBuilder::Flags::GenerateMeshLods);
     flags.value("UseCache", SceneBuilder::Flags::UseCache);
     flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
     ScriptBindings::addEnumBinaryOperators(flags);
@@ -3303,6 +3758,7 @@ FALCOR_SCRIPT_BINDING(SceneBuilder)
         "spawnPosition"_a = float3(0, -10, 0)
     );
     sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
+    sceneBuilder.def("bakeMeshSDF", &SceneBuilder::bakeMeshSDF, "meshID"_a, "sdfGrid"_a, "gridWidth"_a, "signMode"_a = SDFMeshBaker::SignMode::WindingNumber, "narrowBandWidth"_a = 4.f);
     sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
     sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
     sceneBuilder.def("getMaterial", &SceneBuilder::getMaterial, "name"_a);
@@ -86,6 +86,9 @@ public:
         DontUseDisplacement = 0x4000,       ///< Don't use displacement mapping.
         UseCompressedHitInfo = 0x8000,      ///< Use compressed hit info (on scenes with triangle meshes only).
         TessellateCurvesIntoPolyTubes = 0x10000, ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+        GenerateMeshLods = 0x20000,              ///< Generate simplified levels of detail for static triangle meshes, configured by the
+                                                 ///< "MeshLod:" settings. No render path consumes the levels yet; they are only
+                                                 ///< available to custom passes through Scene::getMeshLods() and Scene::selectMeshLods().
 
         UseCache = 0x10000000,     ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
         RebuildCache = 0x20000000, ///< Rebuild scene cache.
@@ -457,6 +460,11 @@ public:
     */
     void setCachedMeshes(std::vector<CachedMesh>&& cachedMeshes);
 
+    /** Get the settings for streaming cached mesh keyframes from disk.
+        Importers use this to write keyframes to a VertexCacheStore while decoding them, see CachedMesh::pKeyframeStore.
+    */
+    VertexCacheStreamingDesc getVertexCacheStreaming() const;
+
     // Particles
 
     /** Adds a particle system. Number of elements cannot be changed later. The sytem is initialized as two meshes with the particle data.
@@ -518,6 +526,18 @@ public:
     */
     SdfDescID addSDFGrid(const ref<SDFGrid>& pSDFGrid, const ref<Material>& pMaterial);
 
+    /** Bake a mesh that has been added to the builder into an SDF grid, see SDFGrid::bakeMesh().
+        The mesh is baked in its own object space, using the positions of the bind pose for skinned meshes.
+        Must be called before the scene is built, as the vertex data is released when the global buffers are created.
+        \param[in] meshID The ID of a triangle list mesh.
+        \param[in] pSDFGrid The SDF grid to set the values of.
+        \param[in] gridWidth The grid width in voxels.
+        \param[in] signMode Method used to determine whether a grid corner is inside the mesh.
+        \param[in] narrowBandWidth Width of the band around the surface in voxels where exact distances are computed.
+        \return Transform from mesh space to the local space of the grid.
+    */
+    float4x4 bakeMeshSDF(MeshID meshID, const ref<SDFGrid>& pSDFGrid, uint32_t gridWidth, SDFMeshBaker::SignMode signMode = SDFMeshBaker::SignMode::WindingNumber, float narrowBandWidth = 4.f);
+
     // Materials
 
     /** Get the list of materials.
@@ -747,6 +767,7 @@ private:
         std::vector<uint32_t> indexData; ///< Vertex indices in either 32-bit or 16-bit format packed tightly, or empty if non-indexed.
         std::vector<StaticVertexData> staticData;
         std::vector<SkinningVertexData> skinningData;
+        std::vector<MeshLod> lods; ///< Simplified levels of detail sharing the vertices of the mesh. Calculated in generateMeshLods().
 
         uint32_t getTriangleCount() const
         {
@@ -819,6 +840,7 @@ private:
     bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
     bool mergeNodes(NodeID dstNodeID, NodeID srcNodeID);
     void flipTriangleWinding(MeshSpec& mesh);
+    void removeMeshesWithoutInstances();
     void updateSDFGridID(SdfGridID oldID, SdfGridID newID);
 
     /** Split a mesh by the given axis-aligned splitting plane.
@@ -842,6 +864,7 @@ private:
     void prepareSceneGraph();
     void prepareMeshes();
     void removeUnusedMeshes();
+    void detectMeshInstances();
     void flattenStaticMeshInstances();
     void optimizeSceneGraph();
     void pretransformStaticMeshes();
@@ -850,12 +873,14 @@ private:
     void createMeshGroups();
     void optimizeGeometry();
     void sortMeshes();
+    void generateMeshLods();
     void createGlobalBuffers();
     void createCurveGlobalBuffers();
     void optimizeMaterials();
     void removeDuplicateMaterials();
     void collectVolumeGrids();
     void quantizeTexCoords();
+    void classifyAlphaCoverage();
     void removeDuplicateSDFGrids();
 
     // Scene setup
@@ -30,6 +30,7 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Utils/AsyncFileReader.h"
 #include "Utils/Logger.h"
 
 #include <lz4_stream/lz4_stream.h>
@@ -43,7 +44,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 28;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -51,6 +52,14 @@ namespace Falcor
 
         const size_t kBlockSize = 1 * 1024 * 1024;
 
+        /** Get the reader used for streaming scene cache files. It is shared by all loads.
+        */
+        AsyncFileReader& getCacheFileReader()
+        {
+            static AsyncFileReader sReader;
+            return sReader;
+        }
+
         const char* kMagic = "FalcorS$";
         struct Header
         {
@@ -239,20 +248,31 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        // Stream the file in large chunks read ahead of the decompressor, instead of many small reads.
+        AsyncFileStreamBuf buf(getCacheFileReader(), cachePath);
+        if (buf.hasError()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        std::istream fs(&buf);
 
         // Read header (uncompressed).
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
+        if (fs.gcount() != sizeof(header) || !header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
+        Scene::SceneData sceneData;
+        try
+        {
+            sceneData = readSceneData(stream, pDevice);
+        }
+        catch (const std::exception&)
+        {
+            // A failed read truncates the stream, report the I/O error rather than the resulting parse error.
+            if (buf.hasError()) throw RuntimeError("Failed to read scene cache file from '{}': {}", cachePath, buf.getError());
+            throw;
+        }
+        if (fs.bad() || buf.hasError()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
         return sceneData;
     }
 
@@ -335,13 +355,32 @@ namespace Falcor
             stream.write(group.isStatic);
             stream.write(group.isDisplaced);
         }
+        stream.write((uint32_t)sceneData.meshLods.size());
+        for (const auto& lods : sceneData.meshLods)
+        {
+            stream.write((uint32_t)lods.size());
+            for (const auto& lod : lods)
+            {
+                stream.write(lod.error);
+                stream.write(lod.indices);
+            }
+        }
+        stream.write(sceneData.meshAlphaCoverage);
         stream.write((uint32_t)sceneData.cachedMeshes.size());
         for (const auto& cachedMesh : sceneData.cachedMeshes)
         {
             stream.write(cachedMesh.meshID);
             stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            const uint32_t keyframeCount = cachedMesh.getKeyframeCount();
+            const uint64_t vertexCount = cachedMesh.getVertexCount();
+            stream.write(keyframeCount);
+            // Written in the same layout as a vector, keyframes held in an on-disk store are decoded one at a time.
+            std::vector<PackedStaticVertexData> scratch;
+            for (uint32_t i = 0; i < keyframeCount; i++)
+            {
+                stream.write(vertexCount);
+                stream.write(cachedMesh.getKeyframe(i, scratch, i > 0), vertexCount * sizeof(PackedStaticVertexData));
+            }
         }
         stream.write(sceneData.useCompressedHitInfo);
         stream.write(sceneData.has16BitIndices);
@@ -456,6 +495,17 @@ namespace Falcor
             stream.read(group.isStatic);
             stream.read(group.isDisplaced);
         }
+        sceneData.meshLods.resize(stream.read<uint32_t>());
+        for (auto& lods : sceneData.meshLods)
+        {
+            lods.resize(stream.read<uint32_t>());
+            for (auto& lod : lods)
+            {
+                stream.read(lod.error);
+                stream.read(lod.indices);
+            }
+        }
+        stream.read(sceneData.meshAlphaCoverage);
         sceneData.cachedMeshes.resize(stream.read<uint32_t>());
         for (auto& cachedMesh : sceneData.cachedMeshes)
         {
@@ -822,6 +872,7 @@ namespace Falcor
         }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
+        stream.write(pGridVolume->mStreamingDesc);
         stream.write(pGridVolume->mBounds);
         stream.write(pGridVolume->mData);
     }
@@ -846,8 +897,10 @@ namespace Falcor
         }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
+        stream.read(pGridVolume->mStreamingDesc);
         stream.read(pGridVolume->mBounds);
         stream.read(pGridVolume->mData);
+        pGridVolume->updateStreaming();
 
         return pGridVolume;
     }
@@ -856,6 +909,15 @@ namespace Falcor
 
     void SceneCache::writeGrid(OutputStream& stream, const ref<Grid>& pGrid)
     {
+        // Streamed grids only store their source, the data is loaded on demand.
+        stream.write(pGrid->isStreamed());
+        if (pGrid->isStreamed())
+        {
+            stream.write(pGrid->mSourcePath);
+            stream.write(pGrid->mSourceGridName);
+            return;
+        }
+
         const nanovdb::HostBuffer& buffer = pGrid->mGridHandle.buffer();
         stream.write((uint64_t)buffer.size());
         stream.write(buffer.data(), buffer.size());
@@ -863,6 +925,13 @@ namespace Falcor
 
     ref<Grid> SceneCache::readGrid(InputStream& stream, ref<Device> pDevice)
     {
+        if (stream.read<bool>())
+        {
+            auto path = stream.read<std::filesystem::path>();
+            auto gridname = stream.read<std::string>();
+            return ref<Grid>(new Grid(pDevice, path, gridname));
+        }
+
         uint64_t size = stream.read<uint64_t>();
         auto buffer = nanovdb::HostBuffer::create(size);
         stream.read(buffer.data(), buffer.size());
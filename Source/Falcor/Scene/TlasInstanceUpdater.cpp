@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TlasInstanceUpdater.h"
+#include "Core/Assert.h"
+#include "Utils/BufferAllocator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Returns the surface area of bounds, or zero if they are invalid or unbounded.
+        */
+        float getArea(const AABB& bounds)
+        {
+            if (!bounds.valid()) return 0.f;
+            float area = bounds.area();
+            return std::isfinite(area) ? area : 0.f;
+        }
+    }
+
+    void TlasInstanceUpdater::reset(std::vector<RtInstanceDesc> descs, std::vector<AABB> bounds)
+    {
+        FALCOR_ASSERT(bounds.size() == descs.size());
+        mDescs = std::move(descs);
+        mBounds = std::move(bounds);
+        markRebuilt();
+
+        mDirty.resize(mDescs.size());
+        std::iota(mDirty.begin(), mDirty.end(), 0);
+        mIsDirty.assign(mDescs.size(), true);
+    }
+
+    bool TlasInstanceUpdater::setTransform(uint32_t index, const float4x4& transform, const AABB& bounds)
+    {
+        FALCOR_ASSERT(index < mDescs.size());
+        RtInstanceDesc& desc = mDescs[index];
+        if (std::memcmp(desc.transform, &transform, sizeof(desc.transform)) == 0) return false;
+        desc.setTransform(transform);
+
+        mBounds[index] = bounds;
+        float growth = getGrowth(index);
+        mGrowthArea += growth - mGrowth[index];
+        mGrowth[index] = growth;
+
+        if (!mIsDirty[index])
+        {
+            mIsDirty[index] = true;
+            mDirty.push_back(index);
+        }
+        return true;
+    }
+
+    std::vector<TlasInstanceUpdater::Range> TlasInstanceUpdater::getDirtyRanges() const
+    {
+        // The descs are coalesced like the dirty bytes of a buffer, with desc indices as offsets.
+        // Adding them in sorted order only ever appends to or extends the last range.
+        std::vector<uint32_t> dirty = mDirty;
+        std::sort(dirty.begin(), dirty.end());
+
+        BufferAllocator::DirtyRanges dirtyRanges(mOptions.maxRangeGap);
+        for (uint32_t index : dirty) dirtyRanges.add(index, index + 1);
+
+        std::vector<Range> ranges;
+        ranges.reserve(dirtyRanges.getRanges().size());
+        for (const auto& range : dirtyRanges.getRanges()) ranges.push_back({ (uint32_t)range.start, (uint32_t)range.size() });
+        return ranges;
+    }
+
+    void TlasInstanceUpdater::clearDirty()
+    {
+        // Clearing the flags one by one is cheaper than reassigning them when only a few descs changed.
+        if (mDirty.size() == mDescs.size()) mIsDirty.assign(mDescs.size(), false);
+        else for (uint32_t index : mDirty) mIsDirty[index] = false;
+        mDirty.clear();
+    }
+
+    void TlasInstanceUpdater::markRebuilt()
+    {
+        mBuildBounds = mBounds;
+        mGrowth.assign(mDescs.size(), 0.f);
+        mGrowthArea = 0.0;
+        mBuildArea = 0.0;
+        for (const AABB& bounds : mBuildBounds) mBuildArea += getArea(bounds);
+    }
+
+    float TlasInstanceUpdater::getGrowth(uint32_t index) const
+    {
+        const AABB& buildBounds = mBuildBounds[index];
+        if (!buildBounds.valid()) return 0.f;
+
+        // A refit node has to enclose both where the instance was at the rebuild and where it is now.
+        return std::max(getArea(buildBounds | mBounds[index]) - getArea(buildBounds), 0.f);
+    }
+}
@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/RtAccelerationStructure.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU copy of the TLAS instance descs with per-instance dirty tracking.
+
+        The owner fills all descs once with reset() and afterwards only patches the transforms of instances that moved.
+        Modified descs are reported as sorted ranges, where nearby dirty descs are coalesced so that they can be uploaded
+        with few copies.
+
+        The class also decides between refitting and rebuilding the TLAS. Refitting keeps the tree topology of the last
+        rebuild, so its quality degrades as instances move away from where they were at that point. This is estimated by
+        the bound growth: the total surface area the instance bounds grew by compared to their bounds at the last
+        rebuild, relative to the total surface area at the last rebuild.
+    */
+    class FALCOR_API TlasInstanceUpdater
+    {
+    public:
+        struct Options
+        {
+            uint32_t maxRangeGap = 8;           ///< Dirty descs with at most this many clean descs between them are merged into one range.
+            float rebuildBoundGrowth = 0.25f;   ///< Bound growth above which a rebuild is recommended.
+        };
+
+        /** Range of descs.
+        */
+        struct Range
+        {
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        TlasInstanceUpdater() : TlasInstanceUpdater(Options()) {}
+        TlasInstanceUpdater(const Options& options) : mOptions(options) {}
+
+        void setOptions(const Options& options) { mOptions = options; }
+        const Options& getOptions() const { return mOptions; }
+
+        /** Replace all instance descs. All descs are marked dirty and the bound growth is reset.
+            \param[in] descs Instance descs.
+            \param[in] bounds World-space bounds per desc. Invalid or unbounded bounds are ignored for the bound growth.
+        */
+        void reset(std::vector<RtInstanceDesc> descs, std::vector<AABB> bounds);
+
+        /** Set the transform of an instance and mark it dirty if the transform changed.
+            \param[in] index Desc index.
+            \param[in] transform Instance transform.
+            \param[in] bounds World-space bounds of the instance with the new transform.
+            \return True if the desc changed.
+        */
+        bool setTransform(uint32_t index, const float4x4& transform, const AABB& bounds);
+
+        bool isDirty() const { return !mDirty.empty(); }
+
+        uint32_t getDirtyCount() const { return (uint32_t)mDirty.size(); }
+
+        /** Get the dirty descs as sorted, non-overlapping ranges.
+        */
+        std::vector<Range> getDirtyRanges() const;
+
+        /** Clear the dirty state after the dirty descs have been uploaded.
+        */
+        void clearDirty();
+
+        /** Get the bound growth accumulated since the last rebuild.
+        */
+        float getBoundGrowth() const { return mBuildArea > 0.0 ? (float)(mGrowthArea / mBuildArea) : 0.f; }
+
+        /** Check if the accumulated bound growth makes a rebuild preferable over a refit.
+        */
+        bool isRebuildRecommended() const { return getBoundGrowth() > mOptions.rebuildBoundGrowth; }
+
+        /** Record that the TLAS was rebuilt from the current descs. Resets the bound growth.
+        */
+        void markRebuilt();
+
+        const std::vector<RtInstanceDesc>& getDescs() const { return mDescs; }
+
+        uint32_t getCount() const { return (uint32_t)mDescs.size(); }
+
+    private:
+        float getGrowth(uint32_t index) const;
+
+        Options mOptions;
+        std::vector<RtInstanceDesc> mDescs;
+        std::vector<AABB> mBounds;          ///< Current world-space bounds per desc.
+        std::vector<AABB> mBuildBounds;     ///< World-space bounds per desc at the last rebuild.
+        std::vector<float> mGrowth;         ///< Surface area growth per desc since the last rebuild.
+        double mBuildArea = 0.0;            ///< Total surface area at the last rebuild.
+        double mGrowthArea = 0.0;           ///< Total surface area growth since the last rebuild.
+        std::vector<uint32_t> mDirty;       ///< Indices of the dirty descs, unsorted.
+        std::vector<bool> mIsDirty;
+    };
+}
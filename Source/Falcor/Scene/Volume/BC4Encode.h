@@ -30,8 +30,16 @@
 #include <cstdint>
 #include <climits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC4_ENCODE_SSE2 1
+#include <emmintrin.h>
+#else
+#define BC4_ENCODE_SSE2 0
+#endif
+
 // this file exposes a single function, CompressAlphaDxt5, which encodes a 4x4 set of uint8 alpha values into a single 64 bit BC4 encoded block
-static void CompressAlphaDxt5(uint8_t* tile, void* block);
+// the codebook search is vectorized with SSE2 where available, and produces bit-identical blocks to the scalar search
+static void CompressAlphaDxt5(uint8_t* tile, void* block, bool useSIMD = true);
 
 // derived from libsquish, alpha.cpp
 /* -----------------------------------------------------------------------------
@@ -62,7 +70,7 @@ static void FixRange(int& min, int& max, int steps)
         min = std::max(0, max - steps);
 }
 
-static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
+static int FitCodesScalar(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
 {
     // fit each alpha value to the codebook
     int err = 0;
@@ -95,6 +103,46 @@ static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
     return err;
 }
 
+#if BC4_ENCODE_SSE2
+static int FitCodesSSE2(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
+{
+    // same search as FitCodesScalar for all 16 values at once
+    // the absolute difference picks the same code as the squared error, and only a strictly smaller
+    // distance replaces the best so far, so ties resolve to the same index as in the scalar loop
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile));
+    __m128i least = _mm_set1_epi8((char)0xff);
+    __m128i index = _mm_setzero_si128();
+    for (int j = 0; j < 8; ++j)
+    {
+        const __m128i code = _mm_set1_epi8((char)codes[j]);
+        const __m128i dist = _mm_or_si128(_mm_subs_epu8(values, code), _mm_subs_epu8(code, values));
+        const __m128i lessEqual = _mm_cmpeq_epi8(_mm_min_epu8(dist, least), dist);
+        const __m128i less = _mm_andnot_si128(_mm_cmpeq_epi8(dist, least), lessEqual);
+        least = _mm_min_epu8(dist, least);
+        index = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi8((char)j)), _mm_andnot_si128(less, index));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+
+    // accumulate the squared error in 32 bit lanes
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_unpacklo_epi8(least, zero);
+    const __m128i hi = _mm_unpackhi_epi8(least, zero);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices, bool useSIMD)
+{
+#if BC4_ENCODE_SSE2
+    if (useSIMD)
+        return FitCodesSSE2(tile, codes, indices);
+#endif
+    return FitCodesScalar(tile, codes, indices);
+}
+
 static void WriteAlphaBlock(int alpha0, int alpha1, uint8_t const* indices, void* block)
 {
     uint8_t* bytes = reinterpret_cast<uint8_t*>(block);
@@ -184,7 +232,7 @@ static void WriteAlphaBlock7(int alpha0, int alpha1, uint8_t const* indices, voi
 }
 
 
-static void CompressAlphaDxt5(uint8_t* tile, void* block)
+static void CompressAlphaDxt5(uint8_t* tile, void* block, bool useSIMD)
 {
     // get the range for 5-alpha and 7-alpha interpolation
     int min5 = 255;
@@ -234,8 +282,8 @@ static void CompressAlphaDxt5(uint8_t* tile, void* block)
     // fit the data to both code books
     uint8_t indices5[16];
     uint8_t indices7[16];
-    int err5 = FitCodes(tile, codes5, indices5);
-    int err7 = FitCodes(tile, codes7, indices7);
+    int err5 = FitCodes(tile, codes5, indices5, useSIMD);
+    int err7 = FitCodes(tile, codes7, indices7, useSIMD);
 
     // save the block with least error
     if (err5 <= err7)
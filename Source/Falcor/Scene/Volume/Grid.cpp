@@ -28,6 +28,7 @@
 #include "Grid.h"
 #include "GridConverter.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
 #include "Core/Program/ShaderVar.h"
 #include "Utils/StringUtils.h"
 #include "Utils/Logger.h"
@@ -37,6 +38,9 @@
 #include "Utils/Math/Matrix.h"
 #include "GlobalState.h"
 #include "Utils/PathResolving.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Settings.h"
+#include "Utils/Timing/TraceRecorder.h"
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -57,6 +61,12 @@
 #pragma warning(pop)
 #endif
 
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <thread>
+#include <tuple>
+
 namespace Falcor
 {
     namespace
@@ -75,6 +85,51 @@ namespace Falcor
         {
             return int3(c[0], c[1], c[2]);
         }
+
+        const std::string kBrickCacheDirectory = "NVIDIA/Falcor/GridBrickCache";
+
+        const uint64_t kDefaultBrickCacheMaxSizeMB = 4096;
+
+        /** Get the brick cache directory, or an empty path if the cache is disabled. The cache is opt-in.
+        */
+        std::filesystem::path getBrickCacheDirectory()
+        {
+            const auto& settings = Settings::getGlobalSettings();
+            if (!settings.getOption("GridVolume:brickCache", false)) return {};
+            auto directory = settings.getOption("GridVolume:brickCacheDirectory", std::string());
+            return directory.empty() ? getAppDataDirectory() / kBrickCacheDirectory : std::filesystem::path(directory);
+        }
+
+        /** Delete the least recently used brick cache files until the cache fits in its size limit.
+            Cache hits refresh the file time, so the file times order the files by last use.
+        */
+        void trimBrickCache(const std::filesystem::path& directory)
+        {
+            const auto& settings = Settings::getGlobalSettings();
+            const uint64_t maxSize = settings.getOption("GridVolume:brickCacheMaxSizeMB", kDefaultBrickCacheMaxSizeMB) << 20;
+
+            // Errors are ignored, as other threads or processes may add or remove files concurrently.
+            std::error_code ec;
+            std::vector<std::tuple<std::filesystem::file_time_type, uint64_t, std::filesystem::path>> files;
+            uint64_t totalSize = 0;
+            for (auto it = std::filesystem::directory_iterator(directory, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+            {
+                if (!it->is_regular_file(ec) || it->path().extension() == ".tmp") continue;
+                uint64_t size = it->file_size(ec);
+                auto time = it->last_write_time(ec);
+                if (ec) continue;
+                files.emplace_back(time, size, it->path());
+                totalSize += size;
+            }
+            if (totalSize <= maxSize) return;
+
+            std::sort(files.begin(), files.end());
+            for (const auto& [time, size, path] : files)
+            {
+                if (totalSize <= maxSize) break;
+                if (std::filesystem::remove(path, ec)) totalSize -= size;
+            }
+        }
     }
 
     ref<Grid> Grid::createSphere(ref<Device> pDevice, float radius, float voxelSize, float blendRange)
@@ -113,8 +168,140 @@ namespace Falcor
         }
     }
 
+    std::vector<ref<Grid>> Grid::createFromFiles(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname)
+    {
+        std::vector<ref<Grid>> grids(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) grids[i] = createStreamed(pDevice, paths[i], gridname);
+
+        // Decode in batches to bound the host memory held by staging data.
+        // GPU resources are created on the calling thread as resource creation is not thread-safe.
+        const size_t batchSize = std::max(std::thread::hardware_concurrency(), 1u);
+        // Exceptions must not escape the parallel algorithm (that would call std::terminate), so they are rethrown afterwards.
+        std::vector<std::shared_ptr<StagingData>> staging;
+        std::vector<std::exception_ptr> errors;
+        for (size_t first = 0; first < grids.size(); first += batchSize)
+        {
+            const size_t count = std::min(batchSize, grids.size() - first);
+            staging.assign(count, nullptr);
+            errors.assign(count, nullptr);
+            auto range = NumericRange<size_t>(0, count);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i) {
+                FALCOR_TRACE_SCOPE("Decode grid");
+                try
+                {
+                    if (grids[first + i]) staging[i] = grids[first + i]->decode();
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+
+            for (const auto& error : errors)
+            {
+                if (error) std::rethrow_exception(error);
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto& pGrid = grids[first + i];
+                if (!pGrid) continue;
+                if (!staging[i])
+                {
+                    pGrid = nullptr;
+                    continue;
+                }
+                pGrid->makeResident(staging[i]);
+                pGrid->mSourcePath.clear();
+                pGrid->mSourceGridName.clear();
+            }
+        }
+
+        return grids;
+    }
+
+    ref<Grid> Grid::createStreamed(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("Error when loading grid. Can't find grid file '{}'.", path);
+            return nullptr;
+        }
+
+        if (!hasExtension(fullPath, "nvdb") && !hasExtension(fullPath, "vdb"))
+        {
+            logWarning("Error when loading grid. Unsupported grid file '{}'.", fullPath);
+            return nullptr;
+        }
+
+        return ref<Grid>(new Grid(pDevice, fullPath, gridname));
+    }
+
+    std::shared_ptr<Grid::StagingData> Grid::decode() const
+    {
+        FALCOR_ASSERT(isStreamed());
+
+        auto handle = hasExtension(mSourcePath, "nvdb") ? readNanoVDBFile(mSourcePath, mSourceGridName) : readOpenVDBFile(mSourcePath, mSourceGridName);
+        if (!handle) return nullptr;
+        return createStagingData(std::move(handle));
+    }
+
+    void Grid::makeResident(const std::shared_ptr<StagingData>& pStagingData)
+    {
+        if (!pStagingData) return;
+
+        mGridHandle = std::move(pStagingData->gridHandle);
+        mpFloatGrid = mGridHandle.grid<float>();
+        mAccessor = mpFloatGrid->getAccessor();
+
+        mMetadata.minIndex = cast(mpFloatGrid->indexBBox().min()) & (~7); // The volume texture path requires the index bounding box to fall on a brick boundary (multiple of 8).
+        mMetadata.maxIndex = (cast(mpFloatGrid->indexBBox().max()) + 7) & (~7);
+        mMetadata.minValue = mpFloatGrid->tree().root().minimum();
+        mMetadata.maxValue = mpFloatGrid->tree().root().maximum();
+        mMetadata.voxelCount = mpFloatGrid->activeVoxelCount();
+        auto bounds = mpFloatGrid->worldBBox();
+        mMetadata.worldBounds = AABB(cast(bounds.min()), cast(bounds.max()));
+
+        const auto& gridMap = mGridHandle.gridMetaData()->map();
+        const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
+        const float3x3 affine = math::matrixFromCoefficients<float, 3, 3>(gridMap.mMatF);
+        const float3x3 invAffine = math::matrixFromCoefficients<float, 3, 3>(gridMap.mInvMatF);
+        mMetadata.transform = math::translate(float4x4(affine), translation);
+        mMetadata.invTransform = math::translate(float4x4(invAffine), -translation);
+
+        // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
+        mpBuffer = Buffer::createStructured(
+            mpDevice,
+            sizeof(uint32_t),
+            uint32_t(div_round_up(mGridHandle.size(), sizeof(uint32_t))),
+            ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource,
+            Buffer::CpuAccess::None,
+            mGridHandle.data()
+        );
+        mBrickedGrid = pStagingData->pConverter->createTextures(mpDevice);
+        pStagingData->pConverter.reset();
+    }
+
+    void Grid::evict()
+    {
+        FALCOR_ASSERT(isStreamed());
+
+        mBrickedGrid = {};
+        mpBuffer = nullptr;
+        mAccessor.reset();
+        mpFloatGrid = nullptr;
+        mGridHandle = {};
+    }
+
     void Grid::renderUI(Gui::Widgets& widget)
     {
+        if (isStreamed() && !isResident())
+        {
+            widget.text("Not resident");
+            return;
+        }
+
         std::ostringstream oss;
         oss << "Voxel count: " << getVoxelCount() << std::endl
             << "Minimum index: " << to_string(getMinIndex()) << std::endl
@@ -139,27 +326,27 @@ namespace Falcor
 
     int3 Grid::getMinIndex() const
     {
-        return cast(mpFloatGrid->indexBBox().min()) & (~7); // The volume texture path requires the index bounding box to fall on a brick boundary (multiple of 8).
+        return mMetadata.minIndex;
     }
 
     int3 Grid::getMaxIndex() const
     {
-        return (cast(mpFloatGrid->indexBBox().max()) + 7) & (~7); // The volume texture path requires the index bounding box to fall on a brick boundary (multiple of 8).
+        return mMetadata.maxIndex;
     }
 
     float Grid::getMinValue() const
     {
-        return mpFloatGrid->tree().root().minimum();
+        return mMetadata.minValue;
     }
 
     float Grid::getMaxValue() const
     {
-        return mpFloatGrid->tree().root().maximum();
+        return mMetadata.maxValue;
     }
 
     uint64_t Grid::getVoxelCount() const
     {
-        return mpFloatGrid->activeVoxelCount();
+        return mMetadata.voxelCount;
     }
 
     uint64_t Grid::getGridSizeInBytes() const
@@ -173,13 +360,13 @@ namespace Falcor
 
     AABB Grid::getWorldBounds() const
     {
-        auto bounds = mpFloatGrid->worldBBox();
-        return AABB(cast(bounds.min()), cast(bounds.max()));
+        return mMetadata.worldBounds;
     }
 
     float Grid::getValue(const int3& ijk) const
     {
-        return mAccessor.getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
+        if (!isResident()) throw RuntimeError("Grid is not resident.");
+        return mAccessor->getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
     }
 
     const nanovdb::GridHandle<nanovdb::HostBuffer>& Grid::getGridHandle() const
@@ -189,76 +376,94 @@ namespace Falcor
 
     float4x4 Grid::getTransform() const
     {
-        const auto& gridMap = mGridHandle.gridMetaData()->map();
-        const float3x3 affine = math::matrixFromCoefficients<float, 3, 3>(gridMap.mMatF);
-        const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
-        return math::translate(float4x4(affine), translation);
+        return mMetadata.transform;
     }
 
     float4x4 Grid::getInvTransform() const
     {
-        const auto& gridMap = mGridHandle.gridMetaData()->map();
-        const float3x3 invAffine = math::matrixFromCoefficients<float, 3, 3>(gridMap.mInvMatF);
-        const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
-        return math::translate(float4x4(invAffine), -translation);
+        return mMetadata.invTransform;
     }
 
+    struct Grid::StagingData
+    {
+        nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle;
+        std::unique_ptr<NanoVDBConverterBC4> pConverter;
+    };
+
     Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
         : mpDevice(pDevice)
-        , mGridHandle(std::move(gridHandle))
-        , mpFloatGrid(mGridHandle.grid<float>())
-        , mAccessor(mpFloatGrid->getAccessor())
     {
-        if (!mpFloatGrid->hasMinMax())
+        makeResident(createStagingData(std::move(gridHandle)));
+    }
+
+    Grid::Grid(ref<Device> pDevice, const std::filesystem::path& sourcePath, const std::string& sourceGridName)
+        : mpDevice(pDevice)
+        , mSourcePath(sourcePath)
+        , mSourceGridName(sourceGridName)
+    {}
+
+    std::shared_ptr<Grid::StagingData> Grid::createStagingData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        auto pStagingData = std::make_shared<StagingData>();
+        pStagingData->gridHandle = std::move(gridHandle);
+
+        auto pFloatGrid = pStagingData->gridHandle.grid<float>();
+        if (!pFloatGrid->hasMinMax())
         {
-            nanovdb::gridStats(*mpFloatGrid);
+            nanovdb::gridStats(*pFloatGrid);
         }
 
-        // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
-        mpBuffer = Buffer::createStructured(
-            mpDevice,
-            sizeof(uint32_t),
-            uint32_t(div_round_up(mGridHandle.size(), sizeof(uint32_t))),
-            ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource,
-            Buffer::CpuAccess::None,
-            mGridHandle.data()
-        );
-        using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
+        pStagingData->pConverter = std::make_unique<NanoVDBConverterBC4>(pFloatGrid);
+        auto cacheDirectory = getBrickCacheDirectory();
+        pStagingData->pConverter->convertBricks(cacheDirectory);
+        if (!cacheDirectory.empty()) trimBrickCache(cacheDirectory);
+        return pStagingData;
     }
 
     ref<Grid> Grid::createFromNanoVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto handle = readNanoVDBFile(path, gridname);
+        return handle ? ref<Grid>(new Grid(pDevice, std::move(handle))) : nullptr;
+    }
+
+    ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto handle = readOpenVDBFile(path, gridname);
+        return handle ? ref<Grid>(new Grid(pDevice, std::move(handle))) : nullptr;
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return handle;
     }
 
-    ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -280,25 +485,23 @@ namespace Falcor
         if (!baseGrid)
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (!baseGrid->isType<openvdb::FloatGrid>())
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (baseGrid->empty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
-        auto handle = nanovdb::openToNanoVDB(floatGrid);
-
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return nanovdb::openToNanoVDB(floatGrid);
     }
 
 
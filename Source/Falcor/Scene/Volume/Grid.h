@@ -48,7 +48,9 @@
 
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace Falcor
 {
@@ -89,6 +91,61 @@ namespace Falcor
         */
         static ref<Grid> createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname);
 
+        /** Create grids from a list of files. Files are read and converted in parallel.
+            \param[in] pDevice GPU device.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return List of grids in the order of the paths, with nullptr for grids that failed to load.
+        */
+        static std::vector<ref<Grid>> createFromFiles(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname);
+
+        /** Create a streamed grid from a file.
+            The grid only records where its data comes from and is initially not resident.
+            Its data is loaded with decode() and makeResident() and can be released again with evict().
+            Until the grid has been made resident once, its bounds and statistics are empty.
+            \param[in] pDevice GPU device.
+            \param[in] path File path of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return A new grid, or nullptr if the file cannot be found.
+        */
+        static ref<Grid> createStreamed(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname);
+
+        /** Host data decoded from a grid file, ready to be uploaded to the GPU.
+        */
+        struct StagingData;
+
+        /** Check if the grid is streamed from a file.
+        */
+        bool isStreamed() const { return !mSourcePath.empty(); }
+
+        /** Check if the grid data is resident in host and GPU memory.
+        */
+        bool isResident() const { return mpFloatGrid != nullptr; }
+
+        /** Get the source file path of a streamed grid.
+        */
+        const std::filesystem::path& getSourcePath() const { return mSourcePath; }
+
+        /** Get the grid name of a streamed grid.
+        */
+        const std::string& getSourceGridName() const { return mSourceGridName; }
+
+        /** Decode the data of a streamed grid from its file.
+            This only reads the file and converts the data in host memory, so it is safe to call from any thread.
+            \return Staging data to pass to makeResident(), or nullptr if the grid failed to load.
+        */
+        std::shared_ptr<StagingData> decode() const;
+
+        /** Make the grid resident by uploading previously decoded data to the GPU.
+            Must be called from the thread owning the device.
+            \param[in] pStagingData Data returned by decode(). If nullptr the grid is left unchanged.
+        */
+        void makeResident(const std::shared_ptr<StagingData>& pStagingData);
+
+        /** Release the host and GPU data of a streamed grid. The cached bounds and statistics stay valid.
+        */
+        void evict();
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -127,12 +184,13 @@ namespace Falcor
         AABB getWorldBounds() const;
 
         /** Get a value stored in the grid.
-            Note: This function is not safe for access from multiple threads.
+            Note: This function is not safe for access from multiple threads. The grid must be resident.
             \param[in] ijk The index-space position to access the data from.
         */
         float getValue(const int3& ijk) const;
 
         /** Get the raw NanoVDB grid handle.
+            Note: The handle is empty if the grid is not resident.
         */
         const nanovdb::GridHandle<nanovdb::HostBuffer>& getGridHandle() const;
 
@@ -146,16 +204,40 @@ namespace Falcor
 
     private:
         Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(ref<Device> pDevice, const std::filesystem::path& sourcePath, const std::string& sourceGridName);
+
+        static std::shared_ptr<StagingData> createStagingData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
 
         static ref<Grid> createFromNanoVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
         static ref<Grid> createFromOpenVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
 
+        /** Grid properties cached when the grid is made resident, so they remain available after eviction.
+        */
+        struct Metadata
+        {
+            int3 minIndex = int3(0);
+            int3 maxIndex = int3(0);
+            float minValue = 0.f;
+            float maxValue = 0.f;
+            uint64_t voxelCount = 0;
+            AABB worldBounds;
+            float4x4 transform = float4x4::identity();
+            float4x4 invTransform = float4x4::identity();
+        };
+
         ref<Device> mpDevice;
 
+        // Source of streamed grids.
+        std::filesystem::path mSourcePath;
+        std::string mSourceGridName;
+        Metadata mMetadata;
+
         // Host data.
         nanovdb::GridHandle<nanovdb::HostBuffer> mGridHandle;
-        nanovdb::FloatGrid* mpFloatGrid;
-        nanovdb::FloatGrid::AccessorType mAccessor;
+        nanovdb::FloatGrid* mpFloatGrid = nullptr;
+        std::optional<nanovdb::FloatGrid::AccessorType> mAccessor;
         // Device data.
         ref<Buffer> mpBuffer;
         BrickedGrid mBrickedGrid;
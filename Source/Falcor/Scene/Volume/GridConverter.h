@@ -29,6 +29,8 @@
 #include "BrickedGrid.h"
 #include "BC4Encode.h"
 #include "Core/API/Formats.h"
+#include "Core/Platform/OS.h"
+#include "Utils/FastHash.h"
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
 #include "Utils/NumericRange.h"
@@ -47,6 +49,9 @@
 #include <algorithm>
 #include <atomic>
 #include <execution>
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <vector>
 
 namespace Falcor
@@ -65,12 +70,25 @@ namespace Falcor
 
         BrickedGrid convert(ref<Device> pDevice);
 
+        /** Convert the NanoVDB grid to bricks in host memory. Does not access the device and can run on any thread.
+            \param[in] cacheDirectory If not empty, converted bricks are looked up in and stored to this directory.
+                       Cache files are keyed by the hash of the grid data and the converter parameters.
+        */
+        void convertBricks(const std::filesystem::path& cacheDirectory = {});
+
+        /** Create the brick textures from the data produced by convertBricks().
+        */
+        BrickedGrid createTextures(ref<Device> pDevice);
+
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
+        const static uint32_t kCacheVersion = 1; // Increment when the brick layout or encoding changes.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
 
         void convertSlice(int z);
-        void computeMip(int mip);
+        void computeMipSlice(int mip, int z);
+        bool readCache(const std::filesystem::path& path);
+        void writeCache(const std::filesystem::path& path) const;
 
         inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
         inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
@@ -85,12 +103,12 @@ namespace Falcor
             }
         }
 
-        inline float2 combineMajMin(float2 a, float2 b)
+        inline float2 combineMajMin(float2 a, float2 b) const
         {
             return float2(std::max(a.x, b.x), std::min(a.y, b.y));
         }
 
-        inline float2 unpackMajMin(const uint32_t* data)
+        inline float2 unpackMajMin(const uint32_t* data) const
         {
             const uint16_t* data16 = (const uint16_t*)data;
             return float2(f16tof32(data16[0]), f16tof32(data16[1]));
@@ -248,10 +266,8 @@ namespace Falcor
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMipSlice(int mip, int z)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -260,43 +276,136 @@ namespace Falcor
         uint32_t rowstride_tgt = leafdim_tgt.x;
         uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        // Each target slice reads two source slices, so slices can be computed independently.
+        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1] + z * slicestride_tgt;
+        const uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0) + 2 * z * slicestride_src;
+
+        for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
         {
-            for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
+            for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
             {
-                for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
-                {
-                    float2 majmin_dst = combineMajMin(
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
-                        ),
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
-                        )
-                    );
-                    *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
-                } // x
-            } // y
-        } // z
+                float2 majmin_dst = combineMajMin(
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
+                    ),
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
+                    )
+                );
+                *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
+            } // x
+        } // y
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
+    {
+        convertBricks();
+        return createTextures(pDevice);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertBricks(const std::filesystem::path& cacheDirectory)
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
+
+        std::filesystem::path cachePath;
+        if (!cacheDirectory.empty())
+        {
+            const uint32_t params[] = { kCacheVersion, kBitsPerTexel, kBrickSize };
+            FastHash hash;
+            hash.update(params, sizeof(params));
+            hash.update(mpFloatGrid, mpFloatGrid->gridSize());
+            cachePath = cacheDirectory / FastHash::toString(hash.digest128());
+            if (readCache(cachePath))
+            {
+                double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+                logDebug("Loaded bricks for '{}' from cache in {:.4}ms", mpFloatGrid->gridName(), dt);
+                return;
+            }
+        }
+
         auto range = NumericRange<int>(0, mLeafDim[0].z);
         std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
-        for (int mip = 1; mip < 4; ++mip) computeMip(mip);
+        for (int mip = 1; mip < 4; ++mip)
+        {
+            auto mipRange = NumericRange<int>(0, mLeafDim[mip].z);
+            std::for_each(std::execution::par, mipRange.begin(), mipRange.end(), [&](int z) { computeMipSlice(mip, z); });
+        }
+
+        if (!cachePath.empty()) writeCache(cachePath);
+
+        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    bool NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::readCache(const std::filesystem::path& path)
+    {
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs.good()) return false;
+
+        // The file holds the brick count followed by the range, indirection and atlas data, whose sizes follow from the grid.
+        uint32_t nonEmptyCount = 0;
+        fs.read(reinterpret_cast<char*>(&nonEmptyCount), sizeof(nonEmptyCount));
+        fs.read(reinterpret_cast<char*>(mRangeData.data()), mRangeData.size() * sizeof(uint32_t));
+        fs.read(reinterpret_cast<char*>(mPtrData.data()), mPtrData.size() * sizeof(uint32_t));
+        fs.read(reinterpret_cast<char*>(mAtlasData.data()), mAtlasData.size() * sizeof(TexelType));
+        if (!fs.good() || fs.peek() != std::char_traits<char>::eof())
+        {
+            logWarning("Ignoring invalid brick cache file '{}'.", path);
+            return false;
+        }
+        mNonEmptyCount.store(nonEmptyCount);
+
+        // Refresh the file time, which the cache size limit uses to evict the least recently used files.
+        fs.close();
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+        return true;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeCache(const std::filesystem::path& path) const
+    {
+        // Write to a unique temporary file first, so concurrent loads of the same grid never see a partial file.
+        // The name includes the process ID and a random suffix, as several processes may share the cache.
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        auto tempPath = path;
+        std::random_device rd;
+        const uint64_t suffix = ((uint64_t)rd() << 32) | rd();
+        tempPath += fmt::format(".{}.{:016x}.tmp", getCurrentProcessId(), suffix);
+
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            uint32_t nonEmptyCount = mNonEmptyCount.load();
+            fs.write(reinterpret_cast<const char*>(&nonEmptyCount), sizeof(nonEmptyCount));
+            fs.write(reinterpret_cast<const char*>(mRangeData.data()), mRangeData.size() * sizeof(uint32_t));
+            fs.write(reinterpret_cast<const char*>(mPtrData.data()), mPtrData.size() * sizeof(uint32_t));
+            fs.write(reinterpret_cast<const char*>(mAtlasData.data()), mAtlasData.size() * sizeof(TexelType));
+            if (!fs.good())
+            {
+                logWarning("Failed to write brick cache file '{}'.", tempPath);
+                fs.close();
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) std::filesystem::remove(tempPath, ec);
+    }
 
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::createTextures(ref<Device> pDevice)
+    {
         BrickedGrid bricks;
         bricks.range = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
         bricks.indirection = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
         bricks.atlas = Texture::create3D(pDevice, getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
-
-        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
         return bricks;
     }
 }
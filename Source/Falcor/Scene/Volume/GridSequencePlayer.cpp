@@ -0,0 +1,329 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridSequencePlayer.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
+namespace Falcor
+{
+    GridSequencePlayer::GridSequencePlayer(std::vector<std::vector<ref<Grid>>> frames, const GridStreamingDesc& desc, uint32_t frame)
+        : mFrames(std::move(frames))
+        , mDesc(desc)
+    {
+        FALCOR_ASSERT(!mFrames.empty());
+
+        // Frames that are already fully resident (e.g. when the player is recreated after loading another slot) are adopted.
+        mResident.resize(mFrames.size());
+        for (size_t i = 0; i < mFrames.size(); ++i)
+        {
+            mResident[i] = std::all_of(mFrames[i].begin(), mFrames[i].end(), [](const ref<Grid>& pGrid) { return !pGrid || pGrid->isResident(); });
+        }
+
+        // Load the initial frame synchronously so the volume is renderable right away.
+        mFrame = std::min(frame, (uint32_t)mFrames.size() - 1);
+        if (!mResident[mFrame]) uploadFrame(mFrame, decodeFrame(mFrame));
+
+        uint32_t threadCount = std::max(mDesc.threadCount, 1u);
+        for (uint32_t i = 0; i < threadCount; ++i) mThreads.emplace_back(&GridSequencePlayer::workerMain, this);
+
+        updateResidency();
+    }
+
+    GridSequencePlayer::~GridSequencePlayer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mWorkCondition.notify_all();
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    bool GridSequencePlayer::setFrame(uint32_t frame)
+    {
+        frame = std::min(frame, (uint32_t)mFrames.size() - 1);
+        if (frame == mFrame) return false;
+
+        mFrame = frame;
+        mStats.frameRequests++;
+
+        if (mResident[frame])
+        {
+            mStats.frameHits++;
+            return updateResidency();
+        }
+
+        StagingFrame staging;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            auto it = mReady.find(frame);
+            if (it != mReady.end())
+            {
+                mStats.frameHits++;
+                staging = std::move(it->second);
+                mReady.erase(it);
+            }
+            else
+            {
+                mStats.stalls++;
+                auto t0 = CpuTimer::getCurrentTimePoint();
+
+                mPending.erase(std::remove(mPending.begin(), mPending.end(), frame), mPending.end());
+                if (mInFlight.count(frame) > 0)
+                {
+                    // A worker is already decoding the frame, wait for it rather than decoding it twice.
+                    mWanted.insert(frame);
+                    mDoneCondition.wait(lock, [&]() { return mInFlight.count(frame) == 0; });
+                    staging = std::move(mReady[frame]);
+                    mReady.erase(frame);
+                }
+                else
+                {
+                    lock.unlock();
+                    staging = decodeFrame(frame);
+                }
+
+                mStats.stallTime += CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint()) * 1e-3;
+            }
+        }
+
+        bool uploaded = uploadFrame(frame, staging);
+        return updateResidency() || uploaded;
+    }
+
+    bool GridSequencePlayer::update()
+    {
+        return updateResidency();
+    }
+
+    void GridSequencePlayer::renderUI(Gui::Widgets& widget)
+    {
+        size_t pendingCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            pendingCount = mPending.size() + mInFlight.size();
+        }
+
+        double hitRate = mStats.frameRequests > 0 ? (double)mStats.frameHits / mStats.frameRequests : 1.0;
+
+        std::ostringstream oss;
+        oss << "Resident frames: " << getResidentFrameCount() << " / " << mFrames.size() << std::endl
+            << "Resident memory: " << formatByteSize(getResidentBytes()) << std::endl
+            << "Pending decodes: " << pendingCount << std::endl
+            << "Hit rate: " << fmt::format("{:.1f}%", hitRate * 100.0) << std::endl
+            << "Stalls: " << mStats.stalls << " (" << fmt::format("{:.1f}", mStats.stallTime * 1e3) << " ms)" << std::endl
+            << "Uploaded frames: " << mStats.uploadedFrames << std::endl
+            << "Evicted frames: " << mStats.evictedFrames << std::endl;
+        widget.text(oss.str());
+
+        if (widget.button("Reset stats")) mStats = {};
+    }
+
+    uint32_t GridSequencePlayer::getResidentFrameCount() const
+    {
+        return (uint32_t)std::count(mResident.begin(), mResident.end(), true);
+    }
+
+    uint64_t GridSequencePlayer::getResidentBytes() const
+    {
+        std::unordered_set<const Grid*> grids;
+        uint64_t bytes = 0;
+        for (const auto& frame : mFrames)
+        {
+            for (const auto& pGrid : frame)
+            {
+                if (pGrid && pGrid->isResident() && grids.insert(pGrid.get()).second) bytes += pGrid->getGridSizeInBytes();
+            }
+        }
+        return bytes;
+    }
+
+    void GridSequencePlayer::workerMain()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mWorkCondition.wait(lock, [&]() { return mTerminate || !mPending.empty(); });
+            if (mTerminate) break;
+
+            uint32_t frame = mPending.front();
+            mPending.pop_front();
+            mInFlight.insert(frame);
+
+            lock.unlock();
+            StagingFrame staging;
+            try
+            {
+                staging = decodeFrame(frame);
+            }
+            catch (...)
+            {
+                // An exception escaping the thread would terminate the process. The frame is left empty, so it stays non-resident.
+                logError("GridSequencePlayer: Failed to decode frame {}.", frame);
+            }
+            lock.lock();
+
+            mInFlight.erase(frame);
+            // Drop the result if the frame left the window while it was being decoded.
+            if (mWanted.count(frame) > 0) mReady[frame] = std::move(staging);
+            mDoneCondition.notify_all();
+        }
+    }
+
+    std::vector<uint32_t> GridSequencePlayer::getWindow(uint32_t frame) const
+    {
+        // Frames ordered by priority. Playback loops, so the window wraps around the end of the sequence.
+        const uint32_t frameCount = (uint32_t)mFrames.size();
+        std::vector<uint32_t> window = { frame };
+        for (uint32_t i = 1; i <= mDesc.framesAhead && i < frameCount; ++i) window.push_back((frame + i) % frameCount);
+        for (uint32_t i = 1; i <= mDesc.framesBehind && i < frameCount; ++i) window.push_back((frame + frameCount - i) % frameCount);
+
+        std::vector<uint32_t> unique;
+        for (uint32_t f : window)
+        {
+            if (std::find(unique.begin(), unique.end(), f) == unique.end()) unique.push_back(f);
+        }
+        return unique;
+    }
+
+    GridSequencePlayer::StagingFrame GridSequencePlayer::decodeFrame(uint32_t frame) const
+    {
+        StagingFrame staging(mFrames[frame].size());
+        for (size_t i = 0; i < staging.size(); ++i)
+        {
+            const auto& pGrid = mFrames[frame][i];
+            if (!pGrid) continue;
+            try
+            {
+                staging[i] = pGrid->decode();
+            }
+            catch (const std::exception& e)
+            {
+                // Leave the entry empty, which keeps the frame non-resident.
+                logError("GridSequencePlayer: Failed to decode grid {} of frame {}: {}", i, frame, e.what());
+            }
+        }
+        return staging;
+    }
+
+    bool GridSequencePlayer::uploadFrame(uint32_t frame, const StagingFrame& staging)
+    {
+        bool complete = true;
+        std::vector<Grid*> uploaded;
+        for (size_t i = 0; i < mFrames[frame].size(); ++i)
+        {
+            // Grids can be shared between frames, in which case they may already be resident.
+            const auto& pGrid = mFrames[frame][i];
+            if (!pGrid || pGrid->isResident()) continue;
+            if (i < staging.size() && staging[i])
+            {
+                pGrid->makeResident(staging[i]);
+                uploaded.push_back(pGrid.get());
+            }
+            else
+            {
+                complete = false;
+            }
+        }
+
+        // Frames with a failed decode stay non-resident and are not requested again.
+        if (!complete)
+        {
+            for (Grid* pGrid : uploaded) pGrid->evict();
+            if (mFailed.insert(frame).second) logWarning("GridSequencePlayer: Frame {} could not be decoded and is skipped.", frame);
+            return false;
+        }
+
+        mResident[frame] = true;
+        mStats.uploadedFrames++;
+        return true;
+    }
+
+    void GridSequencePlayer::evictFrame(uint32_t frame)
+    {
+        mResident[frame] = false;
+        mStats.evictedFrames++;
+    }
+
+    bool GridSequencePlayer::updateResidency()
+    {
+        const auto window = getWindow(mFrame);
+        const std::set<uint32_t> wanted(window.begin(), window.end());
+        bool changed = false;
+
+        // Evict frames outside the window. Grids shared with a frame inside the window stay resident.
+        std::unordered_set<const Grid*> wantedGrids;
+        for (uint32_t frame : window)
+        {
+            for (const auto& pGrid : mFrames[frame]) wantedGrids.insert(pGrid.get());
+        }
+        for (uint32_t frame = 0; frame < (uint32_t)mFrames.size(); ++frame)
+        {
+            if (!mResident[frame] || wanted.count(frame) > 0) continue;
+            for (const auto& pGrid : mFrames[frame])
+            {
+                if (pGrid && pGrid->isResident() && wantedGrids.count(pGrid.get()) == 0) pGrid->evict();
+            }
+            evictFrame(frame);
+            changed = true;
+        }
+
+        // Collect decoded frames and queue the missing ones.
+        std::map<uint32_t, StagingFrame> ready;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mWanted = wanted;
+            for (auto& [frame, staging] : mReady)
+            {
+                if (wanted.count(frame) > 0) ready.emplace(frame, std::move(staging));
+            }
+            mReady.clear();
+
+            mPending.clear();
+            for (uint32_t frame : window)
+            {
+                if (!mResident[frame] && mFailed.count(frame) == 0 && ready.count(frame) == 0 && mInFlight.count(frame) == 0) mPending.push_back(frame);
+            }
+        }
+        mWorkCondition.notify_all();
+
+        // Upload on the calling thread, as resource creation is not thread-safe.
+        for (auto& [frame, staging] : ready)
+        {
+            if (mResident[frame]) continue;
+            changed |= uploadFrame(frame, staging);
+        }
+
+        return changed;
+    }
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include "Core/Macros.h"
+#include "Utils/UI/Gui.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+    /** Settings for streaming grid sequences.
+    */
+    struct GridStreamingDesc
+    {
+        bool enabled = false;       ///< Stream grid sequences from file instead of keeping all frames resident.
+        uint32_t framesAhead = 8;   ///< Number of frames after the current frame to keep resident.
+        uint32_t framesBehind = 1;  ///< Number of frames before the current frame to keep resident.
+        uint32_t threadCount = 4;   ///< Number of background decoding threads.
+    };
+
+    /** Plays back a sequence of streamed grids, keeping only a window of frames around the current frame resident.
+
+        Each frame holds one grid per grid slot (nullptr for empty slots). Frames inside the window
+        [frame - framesBehind, frame + framesAhead] (wrapping around the end of the sequence) are decoded by
+        background threads in order of distance to the current frame and uploaded on the main thread in update().
+        Frames that leave the window are evicted. If the current frame is not resident when it is selected,
+        it is decoded synchronously, which is counted as a stall.
+    */
+    class FALCOR_API GridSequencePlayer
+    {
+    public:
+        struct Stats
+        {
+            uint64_t frameRequests = 0;     ///< Number of times a new current frame was selected.
+            uint64_t frameHits = 0;         ///< Number of requests where the frame was already resident or decoded.
+            uint64_t stalls = 0;            ///< Number of requests that had to wait for the frame to be decoded.
+            double stallTime = 0.0;         ///< Total time spent waiting for frames in seconds.
+            uint64_t uploadedFrames = 0;    ///< Number of frames uploaded to the GPU.
+            uint64_t evictedFrames = 0;     ///< Number of frames evicted.
+        };
+
+        /** Create a player. The given frame is made resident synchronously before returning.
+            \param[in] frames Grids per frame. All non-null grids must be streamed grids.
+            \param[in] desc Streaming settings.
+            \param[in] frame Initial frame.
+        */
+        GridSequencePlayer(std::vector<std::vector<ref<Grid>>> frames, const GridStreamingDesc& desc, uint32_t frame);
+        ~GridSequencePlayer();
+
+        /** Select the current frame. Blocks if the frame is not resident yet.
+            \return True if the set of resident grids changed.
+        */
+        bool setFrame(uint32_t frame);
+
+        /** Upload frames that finished decoding in the background and refresh the prefetch requests.
+            \return True if the set of resident grids changed.
+        */
+        bool update();
+
+        /** Render the streaming statistics.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+        const GridStreamingDesc& getDesc() const { return mDesc; }
+        const Stats& getStats() const { return mStats; }
+
+        /** Get the number of frames currently resident.
+        */
+        uint32_t getResidentFrameCount() const;
+
+        /** Get the GPU memory used by resident grids in bytes.
+        */
+        uint64_t getResidentBytes() const;
+
+    private:
+        using StagingFrame = std::vector<std::shared_ptr<Grid::StagingData>>;
+
+        void workerMain();
+        std::vector<uint32_t> getWindow(uint32_t frame) const;
+        StagingFrame decodeFrame(uint32_t frame) const;
+        bool uploadFrame(uint32_t frame, const StagingFrame& staging);
+        void evictFrame(uint32_t frame);
+        bool updateResidency();
+
+        std::vector<std::vector<ref<Grid>>> mFrames;
+        GridStreamingDesc mDesc;
+        uint32_t mFrame = 0;
+        std::vector<bool> mResident;    ///< Frames uploaded to the GPU. Only accessed on the main thread.
+        std::set<uint32_t> mFailed;     ///< Frames that failed to decode. Only accessed on the main thread.
+        Stats mStats;
+
+        // Shared state with the decoding threads.
+        std::mutex mMutex;
+        std::condition_variable mWorkCondition;
+        std::condition_variable mDoneCondition;
+        std::deque<uint32_t> mPending;              ///< Frames waiting to be decoded, in priority order.
+        std::set<uint32_t> mInFlight;               ///< Frames currently being decoded.
+        std::map<uint32_t, StagingFrame> mReady;    ///< Decoded frames waiting to be uploaded.
+        std::set<uint32_t> mWanted;                 ///< Frames in the current window.
+        bool mTerminate = false;
+
+        std::vector<std::thread> mThreads;
+    };
+}
@@ -49,6 +49,16 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        GridStreamingDesc getGridStreamingDesc(const Settings& settings)
+        {
+            GridStreamingDesc desc;
+            desc.enabled = settings.getOption("GridVolume:streaming", desc.enabled);
+            desc.framesAhead = settings.getOption("GridVolume:framesAhead", desc.framesAhead);
+            desc.framesBehind = settings.getOption("GridVolume:framesBehind", desc.framesBehind);
+            desc.threadCount = settings.getOption("GridVolume:streamingThreads", desc.threadCount);
+            return desc;
+        }
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -61,6 +71,8 @@ namespace Falcor
         mData.invTransform = float4x4::identity();
     }
 
+    GridVolume::~GridVolume() = default;
+
     bool GridVolume::renderUI(Gui::Widgets& widget)
     {
         // We're re-using the volumes's update flags here to track changes.
@@ -78,6 +90,11 @@ namespace Falcor
 
             bool playback = isPlaybackEnabled();
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
+
+            if (mpPlayer)
+            {
+                if (auto group = widget.group("Streaming")) mpPlayer->renderUI(group);
+            }
         }
 
         if (const auto& densityGrid = getDensityGrid())
@@ -128,9 +145,8 @@ namespace Falcor
     GridVolume::GridSequence GridVolume::createGridSequence(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
     {
         GridSequence grids;
-        for (const auto& path : paths)
+        for (auto& grid : Grid::createFromFiles(pDevice, paths, gridname))
         {
-            auto grid = Grid::createFromFile(pDevice, path, gridname);
             if (keepEmpty || grid) grids.push_back(grid);
         }
 
@@ -139,7 +155,20 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
     {
-        GridVolume::GridSequence grids = GridVolume::createGridSequence(mpDevice, paths, gridname, keepEmpty);
+        GridVolume::GridSequence grids;
+        if (mStreamingDesc.enabled)
+        {
+            // Only create the grids here. The player loads the current frame and streams in the others.
+            for (const auto& path : paths)
+            {
+                auto grid = Grid::createStreamed(mpDevice, path, gridname);
+                if (keepEmpty || grid) grids.push_back(grid);
+            }
+        }
+        else
+        {
+            grids = GridVolume::createGridSequence(mpDevice, paths, gridname, keepEmpty);
+        }
         setGridSequence(slot, grids);
         return (uint32_t)grids.size();
     }
@@ -184,7 +213,9 @@ namespace Falcor
         if (mGrids[slotIndex] != grids)
         {
             mGrids[slotIndex] = grids;
+            mpPlayer.reset();
             updateSequence();
+            updateStreaming();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
         }
@@ -230,6 +261,7 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            if (mpPlayer) mpPlayer->setFrame(gridFrame);
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -252,6 +284,9 @@ namespace Falcor
             uint32_t frameIndex = (mStartFrame + (uint32_t)std::floor(std::max(0.0, currentTime) * mFrameRate)) % mGridFrameCount;
             setGridFrame(frameIndex);
         }
+
+        // Upload frames that finished decoding in the background and evict frames outside the window.
+        if (mpPlayer && mpPlayer->update()) markUpdates(UpdateFlags::GridsChanged);
     }
 
     void GridVolume::setDensityScale(float densityScale)
@@ -333,6 +368,29 @@ namespace Falcor
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
+    void GridVolume::updateStreaming()
+    {
+        mpPlayer.reset();
+
+        bool streamed = false;
+        for (const auto& grids : mGrids)
+        {
+            streamed |= std::any_of(grids.begin(), grids.end(), [](const auto& grid) { return grid && grid->isStreamed(); });
+        }
+        if (!streamed) return;
+
+        // Build the list of grids used by each frame, matching the lookup in getGrid().
+        std::vector<std::vector<ref<Grid>>> frames(mGridFrameCount);
+        for (uint32_t frame = 0; frame < mGridFrameCount; ++frame)
+        {
+            for (const auto& grids : mGrids)
+            {
+                frames[frame].push_back(grids.empty() ? nullptr : grids[std::min(frame, (uint32_t)grids.size() - 1)]);
+            }
+        }
+        mpPlayer = std::make_unique<GridSequencePlayer>(std::move(frames), mStreamingDesc, mGridFrame);
+    }
+
     void GridVolume::updateBounds()
     {
         AABB bounds;
@@ -389,6 +447,7 @@ namespace Falcor
         volume.def_property("frameRate", &GridVolume::getFrameRate, &GridVolume::setFrameRate);
         volume.def_property("startFrame", &GridVolume::getStartFrame, &GridVolume::setStartFrame);
         volume.def_property("playbackEnabled", &GridVolume::isPlaybackEnabled, &GridVolume::setPlaybackEnabled);
+        volume.def_property_readonly("streaming", &GridVolume::isStreaming);
         volume.def_property("densityGrid", &GridVolume::getDensityGrid, &GridVolume::setDensityGrid);
         volume.def_property("densityScale", &GridVolume::getDensityScale, &GridVolume::setDensityScale);
         volume.def_property("emissionGrid", &GridVolume::getEmissionGrid, &GridVolume::setEmissionGrid);
@@ -399,7 +458,10 @@ namespace Falcor
         volume.def_property("emissionTemperature", &GridVolume::getEmissionTemperature, &GridVolume::setEmissionTemperature);
         auto create = [] (const std::string& name)
         {
-            return GridVolume::create(accessActivePythonSceneBuilder().getDevice(), name);
+            auto& sceneBuilder = accessActivePythonSceneBuilder();
+            auto pVolume = GridVolume::create(sceneBuilder.getDevice(), name);
+            pVolume->setStreamingDesc(getGridStreamingDesc(sceneBuilder.getSettings()));
+            return pVolume;
         };
         volume.def(pybind11::init(create), "name"_a); // PYTHONDEPRECATED
         volume.def("loadGrid", &GridVolume::loadGrid, "slot"_a, "path"_a, "gridname"_a);
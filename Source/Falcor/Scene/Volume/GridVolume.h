@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequencePlayer.h"
 #include "GridVolumeData.slang"
 #include "Core/Macros.h"
 #include "Utils/Math/AABB.h"
@@ -86,6 +87,7 @@ namespace Falcor
         static ref<GridVolume> create(ref<Device> pDevice, const std::string& name) { return make_ref<GridVolume>(pDevice, name); }
 
         GridVolume(ref<Device> pDevice, const std::string& name);
+        ~GridVolume();
 
         /** Render the UI.
             \return True if the volume was modified.
@@ -126,8 +128,23 @@ namespace Falcor
         */
         static GridSequence createGridSequence(ref<Device> pDevice, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty = true);
 
+        /** Set the streaming settings used for grid sequences loaded after this call.
+            With streaming enabled, only the first frame is loaded when a sequence is loaded. The other frames are
+            decoded in the background and only a window of frames around the current frame is kept resident.
+        */
+        void setStreamingDesc(const GridStreamingDesc& desc) { mStreamingDesc = desc; }
+
+        /** Get the streaming settings.
+        */
+        const GridStreamingDesc& getStreamingDesc() const { return mStreamingDesc; }
+
+        /** Check if the grid sequences of this volume are streamed.
+        */
+        bool isStreaming() const { return mpPlayer != nullptr; }
+
         /** Load a sequence of grids from files to a grid slot.
             Note: This will replace any existing grid sequence for that slot.
+            If streaming is enabled, keepEmpty only applies to missing files, grids that fail to decode are left empty.
             \param[in] slot Grid slot.
             \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
             \param[in] gridname Name of the grid to load.
@@ -284,6 +301,7 @@ namespace Falcor
 
     private:
         void updateSequence();
+        void updateStreaming();
         void updateBounds();
 
         void markUpdates(UpdateFlags updates);
@@ -297,6 +315,8 @@ namespace Falcor
         double mFrameRate = 30.f;
         uint32_t mStartFrame = 0;
         bool mPlaybackEnabled = false;
+        GridStreamingDesc mStreamingDesc;
+        std::unique_ptr<GridSequencePlayer> mpPlayer;
         AABB mBounds;
         GridVolumeData mData;
         mutable UpdateFlags mUpdates = UpdateFlags::None;
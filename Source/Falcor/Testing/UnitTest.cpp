@@ -609,7 +609,8 @@ std::vector<Test> filterTests(
         [](const std::set<std::string>& tags, const std::set<std::string>& includeTags, const std::set<std::string>& excludeTags)
     {
         bool include = includeTags.empty();
-        bool exclude = false;
+        // Benchmarks only run when explicitly requested.
+        bool exclude = tags.count(kBenchmarkTag) == 1 && includeTags.count(kBenchmarkTag) == 0;
 
         for (const auto& tag : tags)
         {
@@ -278,6 +278,9 @@ private:
     std::map<std::string, ref<Buffer>> mStructuredBuffers;
 };
 
+/// Tag for long running benchmark tests. These are excluded unless selected by the tag filter.
+inline constexpr const char kBenchmarkTag[] = "benchmark";
+
 struct Tags
 {
     Tags(std::string tag) { tags.push_back(std::move(tag)); }
@@ -543,6 +546,8 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
  * CPU_TEST(Test4, "Not implemented") {} // Test is skipped (same as above)
  *
  * Note: All CPU tests are implicitly tagged with "cpu".
+ * Note: Tests tagged with "benchmark" are only run when the tag filter explicitly
+ * includes that tag (e.g. `FalcorTest -t benchmark`).
  */
 #define CPU_TEST(name, ...)                                                     \
     static void CPUUnitTest##name(CPUUnitTestContext& ctx);                     \
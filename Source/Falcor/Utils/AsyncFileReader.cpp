@@ -0,0 +1,731 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AsyncFileReader.h"
+#include "Core/Assert.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <thread>
+
+#if FALCOR_LINUX
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Falcor
+{
+namespace
+{
+constexpr uint64_t kMaxPooledBytes = 256ull << 20; ///< Maximum number of bytes kept in the buffer pool.
+}
+
+struct AsyncFileReader::PendingRead
+{
+    Request request;
+    Result result;
+    std::promise<Result> promise;
+};
+
+/**
+ * Pool of read buffers. Buffers handed out hold a reference to the pool and return to it when released.
+ */
+class AsyncFileReader::BufferPool : public std::enable_shared_from_this<BufferPool>
+{
+public:
+    std::shared_ptr<std::vector<uint8_t>> acquire(size_t size)
+    {
+        std::vector<uint8_t> buffer;
+        {
+            // Use the smallest free buffer that is large enough.
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto best = mFreeBuffers.end();
+            for (auto it = mFreeBuffers.begin(); it != mFreeBuffers.end(); ++it)
+                if (it->size() >= size && (best == mFreeBuffers.end() || it->size() < best->size()))
+                    best = it;
+            if (best != mFreeBuffers.end())
+            {
+                buffer = std::move(*best);
+                mFreeBytes -= buffer.size();
+                mFreeBuffers.erase(best);
+            }
+        }
+        if (buffer.size() < size)
+            buffer.resize(size);
+
+        auto pPool = shared_from_this();
+        return std::shared_ptr<std::vector<uint8_t>>(
+            new std::vector<uint8_t>(std::move(buffer)), [pPool](std::vector<uint8_t>* pBuffer) { pPool->release(pBuffer); }
+        );
+    }
+
+private:
+    void release(std::vector<uint8_t>* pBuffer)
+    {
+        std::unique_ptr<std::vector<uint8_t>> buffer(pBuffer);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFreeBytes + buffer->size() <= kMaxPooledBytes)
+        {
+            mFreeBytes += buffer->size();
+            mFreeBuffers.push_back(std::move(*buffer));
+        }
+    }
+
+    std::mutex mMutex;
+    std::vector<std::vector<uint8_t>> mFreeBuffers;
+    uint64_t mFreeBytes = 0;
+};
+
+class AsyncFileReader::BackendImpl
+{
+public:
+    BackendImpl(AsyncFileReader& reader) : mReader(reader) {}
+    virtual ~BackendImpl() = default;
+    virtual void submit(std::vector<std::unique_ptr<PendingRead>> reads) = 0;
+
+protected:
+    /// Clamp the read to the end of the file and set up the destination buffer.
+    void prepare(PendingRead& read, uint64_t fileSize)
+    {
+        const Request& request = read.request;
+        Result& result = read.result;
+        result.size = std::min(request.size, request.offset < fileSize ? fileSize - request.offset : 0);
+        if (request.pDst)
+        {
+            result.pData = static_cast<uint8_t*>(request.pDst);
+        }
+        else
+        {
+            result.pBuffer = mReader.mpBufferPool->acquire(result.size);
+            result.pData = result.pBuffer->data();
+        }
+    }
+
+    void fail(PendingRead& read, std::string error)
+    {
+        read.result.success = false;
+        read.result.size = 0;
+        read.result.pData = nullptr;
+        read.result.pBuffer.reset();
+        read.result.error = std::move(error);
+        mReader.complete(read);
+    }
+
+    AsyncFileReader& mReader;
+};
+
+/**
+ * Backend doing blocking reads on a pool of worker threads.
+ */
+class AsyncFileReader::ThreadPoolBackend : public AsyncFileReader::BackendImpl
+{
+public:
+    ThreadPoolBackend(AsyncFileReader& reader, uint32_t threadCount) : BackendImpl(reader)
+    {
+        for (uint32_t i = 0; i < std::max(threadCount, 1u); ++i)
+            mThreads.emplace_back(&ThreadPoolBackend::runWorker, this);
+    }
+
+    ~ThreadPoolBackend() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mCondition.notify_all();
+        for (auto& thread : mThreads)
+            thread.join();
+    }
+
+    void submit(std::vector<std::unique_ptr<PendingRead>> reads) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto& read : reads)
+                mQueue.push_back(std::move(read));
+        }
+        mCondition.notify_all();
+    }
+
+private:
+    void runWorker()
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mTerminate || !mQueue.empty(); });
+
+            // Terminate thread unless there is more work to do.
+            if (mQueue.empty())
+                break;
+
+            auto read = std::move(mQueue.front());
+            mQueue.pop_front();
+            lock.unlock();
+
+            performRead(*read);
+        }
+    }
+
+    void performRead(PendingRead& read)
+    {
+        const Request& request = read.request;
+
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(request.path, ec);
+        std::ifstream ifs(request.path, std::ios::binary);
+        if (ec || !ifs.good())
+            return fail(read, fmt::format("Failed to open file '{}'.", request.path));
+
+        prepare(read, fileSize);
+        ifs.seekg(request.offset);
+        ifs.read(reinterpret_cast<char*>(read.result.pData), read.result.size);
+        if ((uint64_t)ifs.gcount() != read.result.size)
+            return fail(read, fmt::format("Failed to read {} bytes from file '{}'.", read.result.size, request.path));
+
+        read.result.success = true;
+        mReader.complete(read);
+    }
+
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::unique_ptr<PendingRead>> mQueue;
+    bool mTerminate = false;
+};
+
+#if FALCOR_LINUX
+
+/**
+ * Backend issuing reads through io_uring from a single I/O thread.
+ *
+ * Reads are split into chunks of up to kChunkSize bytes, and up to queueDepth chunks are kept in flight.
+ * Files are only opened once their first chunk can be issued, which bounds the number of open file descriptors.
+ * An outstanding read on an eventfd wakes up the I/O thread when new reads are submitted.
+ */
+class AsyncFileReader::IoUringBackend : public AsyncFileReader::BackendImpl
+{
+public:
+    static constexpr uint32_t kChunkSize = 1u << 20;
+    static constexpr uint64_t kWakeupTag = 0;
+
+    static std::unique_ptr<IoUringBackend> create(AsyncFileReader& reader, uint32_t queueDepth)
+    {
+        std::unique_ptr<IoUringBackend> pBackend(new IoUringBackend(reader));
+        if (!pBackend->init(std::max(queueDepth, 1u)))
+            return nullptr;
+        pBackend->mThread = std::thread(&IoUringBackend::run, pBackend.get());
+        return pBackend;
+    }
+
+    ~IoUringBackend() override
+    {
+        if (mThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mTerminate = true;
+            }
+            wakeup();
+            mThread.join();
+        }
+
+        if (mpSqes)
+            munmap(mpSqes, mSqesSize);
+        if (mpCqRing && mpCqRing != mpSqRing)
+            munmap(mpCqRing, mCqRingSize);
+        if (mpSqRing)
+            munmap(mpSqRing, mSqRingSize);
+        if (mRingFd >= 0)
+            close(mRingFd);
+        if (mEventFd >= 0)
+            close(mEventFd);
+    }
+
+    void submit(std::vector<std::unique_ptr<PendingRead>> reads) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto& read : reads)
+                mSubmitted.push_back(std::move(read));
+        }
+        wakeup();
+    }
+
+private:
+    struct ActiveRead;
+
+    struct Chunk
+    {
+        ActiveRead* pActive;
+        uint64_t offset;
+        uint8_t* pDst;
+        uint32_t size;
+    };
+
+    struct ActiveRead
+    {
+        std::unique_ptr<PendingRead> pRead;
+        int fd = -1;
+        std::vector<Chunk> chunks;
+        size_t pendingChunks = 0;
+        std::string error;
+    };
+
+    IoUringBackend(AsyncFileReader& reader) : BackendImpl(reader) {}
+
+    bool init(uint32_t queueDepth)
+    {
+        io_uring_params params = {};
+        mRingFd = (int)syscall(__NR_io_uring_setup, queueDepth + 1, &params);
+        if (mRingFd < 0)
+            return false;
+
+        // IORING_OP_READ requires Linux 5.6, IORING_FEAT_FAST_POLL was added in 5.7.
+        if (!(params.features & IORING_FEAT_FAST_POLL))
+            return false;
+
+        mEventFd = eventfd(0, EFD_CLOEXEC);
+        if (mEventFd < 0)
+            return false;
+
+        mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap)
+            mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+
+        mpSqRing = mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQ_RING);
+        if (mpSqRing == MAP_FAILED)
+        {
+            mpSqRing = nullptr;
+            return false;
+        }
+        if (singleMmap)
+        {
+            mpCqRing = mpSqRing;
+        }
+        else
+        {
+            mpCqRing = mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_CQ_RING);
+            if (mpCqRing == MAP_FAILED)
+            {
+                mpCqRing = nullptr;
+                return false;
+            }
+        }
+
+        mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* pSqes = mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQES);
+        if (pSqes == MAP_FAILED)
+            return false;
+        mpSqes = static_cast<io_uring_sqe*>(pSqes);
+
+        uint8_t* pSq = static_cast<uint8_t*>(mpSqRing);
+        mpSqTail = reinterpret_cast<uint32_t*>(pSq + params.sq_off.tail);
+        mSqMask = *reinterpret_cast<uint32_t*>(pSq + params.sq_off.ring_mask);
+        mpSqArray = reinterpret_cast<uint32_t*>(pSq + params.sq_off.array);
+
+        uint8_t* pCq = static_cast<uint8_t*>(mpCqRing);
+        mpCqHead = reinterpret_cast<uint32_t*>(pCq + params.cq_off.head);
+        mpCqTail = reinterpret_cast<uint32_t*>(pCq + params.cq_off.tail);
+        mCqMask = *reinterpret_cast<uint32_t*>(pCq + params.cq_off.ring_mask);
+        mpCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+
+        // Keep one submission queue entry for the wake-up read.
+        mQueueDepth = std::min(queueDepth, params.sq_entries - 1);
+        return true;
+    }
+
+    void wakeup()
+    {
+        uint64_t value = 1;
+        [[maybe_unused]] ssize_t written = write(mEventFd, &value, sizeof(value));
+    }
+
+    void pushSqe(int fd, void* pDst, uint32_t size, uint64_t offset, uint64_t userData)
+    {
+        // Only the I/O thread writes the tail, the kernel reads it.
+        uint32_t tail = *mpSqTail;
+        uint32_t index = tail & mSqMask;
+        io_uring_sqe& sqe = mpSqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(pDst);
+        sqe.len = size;
+        sqe.off = offset;
+        sqe.user_data = userData;
+        mpSqArray[index] = index;
+        __atomic_store_n(mpSqTail, tail + 1, __ATOMIC_RELEASE);
+        mPendingSubmits++;
+    }
+
+    void startRead(std::unique_ptr<PendingRead> pRead)
+    {
+        const Request& request = pRead->request;
+
+        int fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0)
+        {
+            if (fd >= 0)
+                close(fd);
+            return fail(*pRead, fmt::format("Failed to open file '{}': {}", request.path, std::strerror(errno)));
+        }
+
+        prepare(*pRead, (uint64_t)st.st_size);
+        if (pRead->result.size == 0)
+        {
+            close(fd);
+            pRead->result.success = true;
+            mReader.complete(*pRead);
+            return;
+        }
+
+        if (pRead->result.size > kChunkSize)
+            posix_fadvise(fd, request.offset, pRead->result.size, POSIX_FADV_SEQUENTIAL);
+
+        auto pActive = new ActiveRead();
+        pActive->pRead = std::move(pRead);
+        pActive->fd = fd;
+        const Result& result = pActive->pRead->result;
+        for (uint64_t offset = 0; offset < result.size; offset += kChunkSize)
+        {
+            uint32_t size = (uint32_t)std::min<uint64_t>(kChunkSize, result.size - offset);
+            pActive->chunks.push_back(Chunk{pActive, pActive->pRead->request.offset + offset, result.pData + offset, size});
+        }
+        pActive->pendingChunks = pActive->chunks.size();
+        for (auto& chunk : pActive->chunks)
+            mChunkQueue.push_back(&chunk);
+    }
+
+    void finishChunk(Chunk* pChunk, int res)
+    {
+        mInFlight--;
+        ActiveRead* pActive = pChunk->pActive;
+
+        if (res == -EINTR || res == -EAGAIN)
+        {
+            mChunkQueue.push_front(pChunk);
+            return;
+        }
+
+        if (res < 0)
+        {
+            pActive->error = std::strerror(-res);
+        }
+        else if ((uint32_t)res < pChunk->size)
+        {
+            if (res == 0)
+            {
+                pActive->error = "Unexpected end of file";
+            }
+            else
+            {
+                // Short read, queue the remainder.
+                pChunk->offset += res;
+                pChunk->pDst += res;
+                pChunk->size -= res;
+                mChunkQueue.push_front(pChunk);
+                return;
+            }
+        }
+
+        if (--pActive->pendingChunks > 0)
+            return;
+
+        std::unique_ptr<ActiveRead> active(pActive);
+        close(active->fd);
+        if (!active->error.empty())
+            return fail(*active->pRead, fmt::format("Failed to read file '{}': {}", active->pRead->request.path, active->error));
+
+        active->pRead->result.success = true;
+        mReader.complete(*active->pRead);
+    }
+
+    void run()
+    {
+        pushSqe(mEventFd, &mEventValue, sizeof(mEventValue), 0, kWakeupTag);
+
+        while (true)
+        {
+            // Pick up newly submitted reads.
+            std::vector<std::unique_ptr<PendingRead>> reads;
+            bool terminate;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                reads.swap(mSubmitted);
+                terminate = mTerminate;
+            }
+            for (auto& read : reads)
+                mReadQueue.push_back(std::move(read));
+
+            // Fill the submission queue up to the queue depth, starting new reads as needed.
+            while (mInFlight < mQueueDepth)
+            {
+                if (mChunkQueue.empty())
+                {
+                    if (mReadQueue.empty())
+                        break;
+                    auto pRead = std::move(mReadQueue.front());
+                    mReadQueue.pop_front();
+                    startRead(std::move(pRead));
+                    continue;
+                }
+                Chunk* pChunk = mChunkQueue.front();
+                mChunkQueue.pop_front();
+                pushSqe(pChunk->pActive->fd, pChunk->pDst, pChunk->size, pChunk->offset, reinterpret_cast<uint64_t>(pChunk));
+                mInFlight++;
+            }
+
+            if (terminate && mInFlight == 0 && mChunkQueue.empty() && mReadQueue.empty())
+                break;
+
+            // Submit and wait for at least one completion (a chunk or a wake-up).
+            int ret = (int)syscall(__NR_io_uring_enter, mRingFd, mPendingSubmits, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (ret >= 0)
+                mPendingSubmits -= ret;
+            else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                logError("AsyncFileReader: io_uring_enter failed: {}", std::strerror(errno));
+
+            // Reap completions.
+            uint32_t head = *mpCqHead;
+            uint32_t tail = __atomic_load_n(mpCqTail, __ATOMIC_ACQUIRE);
+            while (head != tail)
+            {
+                const io_uring_cqe& cqe = mpCqes[head & mCqMask];
+                uint64_t userData = cqe.user_data;
+                int res = cqe.res;
+                head++;
+                __atomic_store_n(mpCqHead, head, __ATOMIC_RELEASE);
+
+                if (userData == kWakeupTag)
+                    pushSqe(mEventFd, &mEventValue, sizeof(mEventValue), 0, kWakeupTag);
+                else
+                    finishChunk(reinterpret_cast<Chunk*>(userData), res);
+            }
+        }
+    }
+
+    int mRingFd = -1;
+    int mEventFd = -1;
+    uint64_t mEventValue = 0;
+
+    void* mpSqRing = nullptr;
+    void* mpCqRing = nullptr;
+    size_t mSqRingSize = 0;
+    size_t mCqRingSize = 0;
+    io_uring_sqe* mpSqes = nullptr;
+    size_t mSqesSize = 0;
+    uint32_t* mpSqTail = nullptr;
+    uint32_t* mpSqArray = nullptr;
+    uint32_t mSqMask = 0;
+    uint32_t* mpCqHead = nullptr;
+    uint32_t* mpCqTail = nullptr;
+    uint32_t mCqMask = 0;
+    io_uring_cqe* mpCqes = nullptr;
+
+    uint32_t mQueueDepth = 0;
+    uint32_t mInFlight = 0;
+    uint32_t mPendingSubmits = 0;
+    std::deque<std::unique_ptr<PendingRead>> mReadQueue;
+    std::deque<Chunk*> mChunkQueue;
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::vector<std::unique_ptr<PendingRead>> mSubmitted;
+    bool mTerminate = false;
+};
+
+#endif // FALCOR_LINUX
+
+AsyncFileReader::AsyncFileReader(Backend backend, uint32_t queueDepth, uint32_t threadCount)
+    : mpBufferPool(std::make_shared<BufferPool>())
+{
+#if FALCOR_LINUX
+    if (backend != Backend::ThreadPool)
+    {
+        mpImpl = IoUringBackend::create(*this, queueDepth);
+        if (mpImpl)
+            mBackend = Backend::IoUring;
+        else if (backend == Backend::IoUring)
+            logWarning("AsyncFileReader: io_uring is not available. Falling back to the thread pool backend.");
+    }
+#else
+    if (backend == Backend::IoUring)
+        logWarning("AsyncFileReader: io_uring is only available on Linux. Falling back to the thread pool backend.");
+#endif
+
+    if (!mpImpl)
+    {
+        mpImpl = std::make_unique<ThreadPoolBackend>(*this, threadCount);
+        mBackend = Backend::ThreadPool;
+    }
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    // Wait for all reads to complete before the statistics are destroyed.
+    mpImpl.reset();
+}
+
+std::future<AsyncFileReader::Result> AsyncFileReader::read(Request request)
+{
+    std::vector<Request> requests;
+    requests.push_back(std::move(request));
+    return std::move(readBatch(std::move(requests))[0]);
+}
+
+std::vector<std::future<AsyncFileReader::Result>> AsyncFileReader::readBatch(std::vector<Request> requests)
+{
+    std::vector<std::future<Result>> futures;
+    std::vector<std::unique_ptr<PendingRead>> reads;
+    futures.reserve(requests.size());
+    reads.reserve(requests.size());
+
+    for (auto& request : requests)
+    {
+        auto pRead = std::make_unique<PendingRead>();
+        pRead->request = std::move(request);
+        futures.push_back(pRead->promise.get_future());
+
+        if (pRead->request.pDst && pRead->request.size == kWholeFile)
+        {
+            pRead->result.error = "Reading into a caller-provided buffer requires an explicit size.";
+            complete(*pRead);
+            continue;
+        }
+        reads.push_back(std::move(pRead));
+    }
+
+    if (!reads.empty())
+        mpImpl->submit(std::move(reads));
+
+    return futures;
+}
+
+void AsyncFileReader::prefetch(const std::vector<std::filesystem::path>& paths)
+{
+#if FALCOR_LINUX
+    for (const auto& path : paths)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#endif
+}
+
+AsyncFileReader::Stats AsyncFileReader::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mStats;
+}
+
+void AsyncFileReader::complete(PendingRead& read)
+{
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mStats.readCount++;
+        if (read.result.success)
+            mStats.bytesRead += read.result.size;
+        else
+            mStats.failedCount++;
+    }
+
+    // Run the callback first so that a ready future implies the callback has returned.
+    if (read.request.callback)
+        read.request.callback(read.result);
+
+    read.promise.set_value(std::move(read.result));
+}
+AsyncFileStreamBuf::AsyncFileStreamBuf(AsyncFileReader& reader, const std::filesystem::path& path, size_t chunkSize, uint32_t readAheadCount)
+    : mReader(reader), mPath(path), mChunkSize(std::max<size_t>(chunkSize, 1)), mReadAheadCount(std::max(readAheadCount, 1u))
+{
+    std::error_code ec;
+    mFileSize = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        mError = fmt::format("Failed to open '{}': {}", path, ec.message());
+        return;
+    }
+    submitReads();
+}
+
+AsyncFileStreamBuf::int_type AsyncFileStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    // Release the consumed chunk before waiting for the next one, so its buffer can be reused.
+    mCurrent = {};
+    setg(nullptr, nullptr, nullptr);
+    if (mPendingReads.empty() || hasError())
+        return traits_type::eof();
+
+    mCurrent = mPendingReads.front().get();
+    mPendingReads.pop_front();
+    if (!mCurrent.success || mCurrent.size == 0)
+    {
+        mError = mCurrent.success ? fmt::format("Unexpected end of file '{}'.", mPath) : mCurrent.error;
+        mCurrent = {};
+        return traits_type::eof();
+    }
+    submitReads();
+
+    char* pBegin = reinterpret_cast<char*>(mCurrent.pData);
+    setg(pBegin, pBegin, pBegin + mCurrent.size);
+    return traits_type::to_int_type(*gptr());
+}
+
+void AsyncFileStreamBuf::submitReads()
+{
+    while (mPendingReads.size() < mReadAheadCount && mNextOffset < mFileSize)
+    {
+        AsyncFileReader::Request request;
+        request.path = mPath;
+        request.offset = mNextOffset;
+        request.size = std::min<uint64_t>(mChunkSize, mFileSize - mNextOffset);
+        mNextOffset += request.size;
+        mPendingReads.push_back(mReader.read(std::move(request)));
+    }
+}
+
+} // namespace Falcor
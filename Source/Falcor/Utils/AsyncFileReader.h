@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Reads files asynchronously, with many reads in flight at the same time.
+ *
+ * Reads are submitted individually or in batches and complete through futures and optional callbacks.
+ * Data is read either into a caller-provided buffer or into a pooled buffer that is returned to the
+ * reader's pool once the last reference to it is released.
+ *
+ * On Linux, reads are issued through io_uring, which keeps a deep queue of requests on the device
+ * from a single I/O thread. Large reads are split into chunks that are serviced in parallel.
+ * Elsewhere, or if io_uring is not available, reads are done with blocking calls on a pool of worker threads.
+ */
+class FALCOR_API AsyncFileReader
+{
+public:
+    enum class Backend
+    {
+        Auto,       ///< Use io_uring if available, otherwise the thread pool.
+        ThreadPool, ///< Blocking reads on a pool of worker threads.
+        IoUring,    ///< Linux io_uring. Falls back to the thread pool if not supported.
+    };
+
+    static constexpr uint64_t kWholeFile = std::numeric_limits<uint64_t>::max();
+
+    struct Result
+    {
+        bool success = false;
+        std::string error;                             ///< Error message if the read failed.
+        uint64_t size = 0;                             ///< Number of bytes read.
+        uint8_t* pData = nullptr;                      ///< Start of the data (in the caller-provided or the pooled buffer).
+        std::shared_ptr<std::vector<uint8_t>> pBuffer; ///< Pooled buffer (can be larger than size), null for caller buffers.
+    };
+
+    using Callback = std::function<void(const Result&)>;
+
+    struct Request
+    {
+        std::filesystem::path path; ///< File to read.
+        uint64_t offset = 0;        ///< Byte offset to start reading at.
+        uint64_t size = kWholeFile; ///< Number of bytes to read. Reads stop at the end of the file.
+        void* pDst = nullptr;       ///< Destination buffer of at least 'size' bytes. If null, a pooled buffer is used.
+        Callback callback;          ///< Called on an I/O thread once the read has completed (optional).
+    };
+
+    struct Stats
+    {
+        uint64_t readCount = 0;   ///< Number of completed reads (including failed reads).
+        uint64_t failedCount = 0; ///< Number of failed reads.
+        uint64_t bytesRead = 0;   ///< Number of bytes read.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] backend Backend to use.
+     * @param[in] queueDepth Maximum number of read operations in flight (io_uring backend).
+     * @param[in] threadCount Number of worker threads (thread pool backend).
+     */
+    AsyncFileReader(Backend backend = Backend::Auto, uint32_t queueDepth = 64, uint32_t threadCount = 4);
+
+    /**
+     * Destructor.
+     * Blocks until all submitted reads have completed.
+     */
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    /// Get the backend in use. This is never Backend::Auto.
+    Backend getBackend() const { return mBackend; }
+
+    /**
+     * Submit a read.
+     * @param[in] request Read request.
+     * @return Future to the result.
+     */
+    std::future<Result> read(Request request);
+
+    /**
+     * Submit a batch of reads.
+     * @param[in] requests Read requests.
+     * @return Futures to the results, in the same order as the requests.
+     */
+    std::vector<std::future<Result>> readBatch(std::vector<Request> requests);
+
+    /**
+     * Hint that the given files will be read soon.
+     * On Linux, this starts reading the files into the page cache in the background. Elsewhere this is a no-op.
+     * @param[in] paths Files to prefetch.
+     */
+    static void prefetch(const std::vector<std::filesystem::path>& paths);
+
+    Stats getStats() const;
+
+private:
+    struct PendingRead;
+    class BufferPool;
+    class BackendImpl;
+    class ThreadPoolBackend;
+    class IoUringBackend;
+
+    void complete(PendingRead& read);
+
+    Backend mBackend;
+    std::shared_ptr<BufferPool> mpBufferPool;
+    std::unique_ptr<BackendImpl> mpImpl;
+
+    mutable std::mutex mStatsMutex;
+    Stats mStats;
+};
+
+/**
+ * Stream buffer reading a file sequentially through an AsyncFileReader.
+ *
+ * The file is read in large chunks, with a number of chunks read ahead of the consumer, so only a few chunks
+ * are held in memory at a time. Read errors end the stream and are reported by getError().
+ */
+class FALCOR_API AsyncFileStreamBuf : public std::streambuf
+{
+public:
+    /**
+     * Constructor. Starts reading the file.
+     * @param[in] reader Reader to use. Must outlive the stream buffer.
+     * @param[in] path File to read.
+     * @param[in] chunkSize Size of the chunks in bytes.
+     * @param[in] readAheadCount Number of chunks read ahead of the consumer.
+     */
+    AsyncFileStreamBuf(AsyncFileReader& reader, const std::filesystem::path& path, size_t chunkSize = 4 << 20, uint32_t readAheadCount = 3);
+
+    AsyncFileStreamBuf(const AsyncFileStreamBuf&) = delete;
+    AsyncFileStreamBuf& operator=(const AsyncFileStreamBuf&) = delete;
+
+    /// Check if a read failed (or the file could not be opened). The stream ends at the failed read.
+    bool hasError() const { return !mError.empty(); }
+
+    /// Get the error message of the failed read.
+    const std::string& getError() const { return mError; }
+
+protected:
+    int_type underflow() override;
+
+private:
+    void submitReads();
+
+    AsyncFileReader& mReader;
+    std::filesystem::path mPath;
+    size_t mChunkSize;
+    uint32_t mReadAheadCount;
+    uint64_t mFileSize = 0;
+    uint64_t mNextOffset = 0;
+    std::deque<std::future<AsyncFileReader::Result>> mPendingReads;
+    AsyncFileReader::Result mCurrent; ///< Chunk in the get area, holds its pooled buffer.
+    std::string mError;
+};
+} // namespace Falcor
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "BufferAllocator.h"
 #include "Utils/Math/Common.h"
+#include <algorithm>
+#include <iterator>
 
 namespace Falcor
 {
@@ -72,7 +74,7 @@ void BufferAllocator::modified(size_t byteOffset, size_t byteSize)
 void BufferAllocator::clear()
 {
     mBuffer.clear();
-    mDirty = {};
+    mDirty.clear();
 }
 
 ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
@@ -103,20 +105,21 @@ ref<Buffer> BufferAllocator::getGPUBuffer(ref<Device> pDevice)
             mpGpuBuffer = Buffer::create(pDevice, bufSize, mBindFlags, Buffer::CpuAccess::None, nullptr);
         }
 
-        mDirty = Range(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
+        // Mark entire buffer as dirty so the data gets uploaded.
+        mDirty.clear();
+        mDirty.add(0, mBuffer.size());
     }
 
-    // If any range is dirty, upload the data from the CPU to the GPU.
-    if (mDirty.start < mDirty.end)
+    // Upload the dirty ranges from the CPU to the GPU.
+    FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
+    for (const auto& range : mDirty.getRanges())
     {
-        size_t byteSize = mDirty.end - mDirty.start;
-        size_t byteOffset = mDirty.start;
-        FALCOR_ASSERT(byteOffset + byteSize <= mBuffer.size());
-        FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
-        mpGpuBuffer->setBlob(mBuffer.data() + byteOffset, byteOffset, byteSize);
-
-        mDirty = {mBuffer.size(), 0}; // Reset dirty range to inverted range. Any min/max operation on it will work.
+        FALCOR_ASSERT(range.end <= mBuffer.size());
+        mpGpuBuffer->setBlob(mBuffer.data() + range.start, range.start, range.size());
+        mUploadStats.uploadCount++;
+        mUploadStats.uploadedBytes += range.size();
     }
+    mDirty.clear();
 
     return mpGpuBuffer;
 }
@@ -159,10 +162,49 @@ size_t BufferAllocator::allocInternal(size_t byteSize)
     return byteOffset;
 }
 
-void BufferAllocator::markAsDirty(const Range& range)
+void BufferAllocator::markAsDirty(size_t byteOffset, size_t byteSize)
+{
+    FALCOR_ASSERT(byteSize > 0);
+    mDirty.add(byteOffset, byteOffset + byteSize);
+}
+
+// DirtyRanges
+
+void BufferAllocator::DirtyRanges::add(size_t start, size_t end)
+{
+    FALCOR_ASSERT(start <= end);
+    if (start >= end)
+        return;
+
+    // Find the first range that ends close enough to the new range to be merged with it.
+    // Ranges are disjoint and sorted, so their end offsets are sorted as well.
+    auto first = std::lower_bound(
+        mRanges.begin(), mRanges.end(), start,
+        [this](const Range& range, size_t offset) { return offset > range.end && offset - range.end > mMergeThreshold; }
+    );
+
+    // Find all following ranges that start close enough to the new range.
+    auto last = first;
+    while (last != mRanges.end() && (last->start <= end || last->start - end <= mMergeThreshold))
+        ++last;
+
+    if (first == last)
+    {
+        mRanges.insert(first, Range{start, end});
+        return;
+    }
+
+    // Replace the merged ranges by their union with the new range.
+    first->start = std::min(first->start, start);
+    first->end = std::max(std::prev(last)->end, end);
+    mRanges.erase(std::next(first), last);
+}
+
+size_t BufferAllocator::DirtyRanges::getByteCount() const
 {
-    FALCOR_ASSERT(range.start < range.end);
-    mDirty.start = std::min(mDirty.start, range.start);
-    mDirty.end = std::max(mDirty.end, range.end);
+    size_t byteCount = 0;
+    for (const auto& range : mRanges)
+        byteCount += range.size();
+    return byteCount;
 }
 } // namespace Falcor
@@ -53,6 +53,68 @@ namespace Falcor
 class FALCOR_API BufferAllocator
 {
 public:
+    /**
+     * Set of disjoint byte ranges that need to be uploaded.
+     * Ranges are kept sorted by offset. Ranges that overlap, touch or are separated by a gap of at most
+     * the merge threshold are coalesced, trading a few redundant bytes for fewer upload operations.
+     */
+    class FALCOR_API DirtyRanges
+    {
+    public:
+        /// Half-open byte range [start, end).
+        struct Range
+        {
+            size_t start = 0;
+            size_t end = 0;
+
+            size_t size() const { return end - start; }
+            bool operator==(const Range& other) const { return start == other.start && end == other.end; }
+        };
+
+        /**
+         * Constructor.
+         * @param[in] mergeThreshold Maximum gap in bytes between two ranges that are merged into one.
+         */
+        explicit DirtyRanges(size_t mergeThreshold = 0) : mMergeThreshold(mergeThreshold) {}
+
+        /**
+         * Add a range. Empty ranges are ignored.
+         * @param[in] start Start offset in bytes.
+         * @param[in] end End offset in bytes (exclusive).
+         */
+        void add(size_t start, size_t end);
+
+        /**
+         * Set the merge threshold. Only affects ranges added afterwards.
+         * @param[in] mergeThreshold Maximum gap in bytes between two ranges that are merged into one.
+         */
+        void setMergeThreshold(size_t mergeThreshold) { mMergeThreshold = mergeThreshold; }
+        size_t getMergeThreshold() const { return mMergeThreshold; }
+
+        void clear() { mRanges.clear(); }
+        bool empty() const { return mRanges.empty(); }
+
+        /// Get the ranges, sorted by start offset.
+        const std::vector<Range>& getRanges() const { return mRanges; }
+
+        /// Get the total number of bytes covered by the ranges.
+        size_t getByteCount() const;
+
+    private:
+        std::vector<Range> mRanges;
+        size_t mMergeThreshold;
+    };
+
+    /// Statistics about the data uploaded to the GPU buffer.
+    struct UploadStats
+    {
+        uint64_t uploadCount = 0;   ///< Number of upload operations (one per dirty range).
+        uint64_t uploadedBytes = 0; ///< Total number of bytes uploaded.
+    };
+
+    /// Default merge threshold for dirty ranges. Below this gap size, an extra copy operation costs more than re-uploading the gap.
+    static constexpr size_t kDefaultMergeThreshold = 4096;
+
     /**
      * Create a buffer allocator.
      * @param[in] alignment Minimum alignment in bytes for any allocation.
@@ -197,20 +259,33 @@ public:
      */
     ref<Buffer> getGPUBuffer(ref<Device> pDevice);
 
+    /**
+     * Set the maximum gap between modified memory regions that are uploaded as one range.
+     * A value of zero only merges overlapping and adjacent regions.
+     * @param[in] byteSize Merge threshold in bytes.
+     */
+    void setMergeThreshold(size_t byteSize) { mDirty.setMergeThreshold(byteSize); }
+
+    /**
+     * Get the ranges that are pending upload to the GPU buffer.
+     */
+    const DirtyRanges& getDirtyRanges() const { return mDirty; }
+
+    /**
+     * Get statistics about the uploads to the GPU buffer.
+     */
+    const UploadStats& getUploadStats() const { return mUploadStats; }
+
+    /**
+     * Reset the upload statistics.
+     */
+    void resetUploadStats() { mUploadStats = {}; }
+
 private:
     void computeAndAllocatePadding(size_t byteSize);
     size_t allocInternal(size_t byteSize);
 
-    struct Range
-    {
-        size_t start = 0;
-        size_t end = 0;
-        Range(){};
-        Range(size_t s, size_t e) : start(s), end(e) {}
-    };
-
-    void markAsDirty(const Range& range);
-    void markAsDirty(size_t byteOffset, size_t byteSize) { markAsDirty(Range(byteOffset, byteOffset + byteSize)); }
+    void markAsDirty(size_t byteOffset, size_t byteSize);
 
     /// Minimum alignment for allocations from base address. A value of zero means no aligment is performed.
     const size_t mAlignment;
@@ -224,9 +299,10 @@ private:
     /// Bind flags for the GPU buffer.
     const ResourceBindFlags mBindFlags;
 
-    /// Range of buffer that is dirty and needs to be updatd on the GPU. We track a single dirty range for now to minimize the number of
-    /// uploads, but this could be changed.
-    Range mDirty;
+    /// Ranges of the buffer that are dirty and need to be updated on the GPU.
+    DirtyRanges mDirty{kDefaultMergeThreshold};
+
+    UploadStats mUploadStats;
 
     std::vector<uint8_t> mBuffer; ///< CPU buffer holding a copy of the data.
     ref<Buffer> mpGpuBuffer;      ///< GPU buffer holding the data.
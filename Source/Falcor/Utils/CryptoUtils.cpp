@@ -26,110 +26,31 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "CryptoUtils.h"
-#include <iomanip>
-#include <sstream>
+#include "Core/Platform/CpuFeatures.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
 
-namespace Falcor
-{
-SHA1::SHA1() : mIndex(0), mBits(0)
-{
-    mState[0] = 0x67452301;
-    mState[1] = 0xefcdab89;
-    mState[2] = 0x98badcfe;
-    mState[3] = 0x10325476;
-    mState[4] = 0xc3d2e1f0;
-}
-
-void SHA1::update(uint8_t byte)
-{
-    addByte(byte);
-    mBits += 8;
-}
-
-void SHA1::update(const void* data, size_t len)
-{
-    if (!data)
-        return;
-
-    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
-
-    // Fill up buffer if not full.
-    while (len > 0 && mIndex != 0)
-    {
-        update(*ptr++);
-        len--;
-    }
-
-    // Process full blocks.
-    while (len >= sizeof(mBuf))
-    {
-        processBlock(ptr);
-        ptr += sizeof(mBuf);
-        len -= sizeof(mBuf);
-        mBits += sizeof(mBuf) * 8;
-    }
-
-    // Process remaining bytes.
-    while (len > 0)
-    {
-        update(*ptr++);
-        len--;
-    }
-}
-
-SHA1::MD SHA1::finalize()
-{
-    // Finalize with 0x80, some zero padding and the length in bits.
-    addByte(0x80);
-    while (mIndex % 64 != 56)
-    {
-        addByte(0);
-    }
-    for (int i = 7; i >= 0; --i)
-    {
-        addByte(mBits >> i * 8);
-    }
-
-    MD md;
-    for (int i = 0; i < 5; i++)
-    {
-        for (int j = 3; j >= 0; j--)
-        {
-            md[i * 4 + j] = (mState[i] >> ((3 - j) * 8)) & 0xff;
-        }
-    }
+#if defined(__x86_64__) || defined(_M_X64)
+#define SHA1_X86_SHA 1
+#include <immintrin.h>
+#if FALCOR_MSVC
+#define SHA1_TARGET_SHA
+#else
+#define SHA1_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#define SHA1_ARM_CRYPTO 1
+#include <arm_neon.h>
+#endif
 
-    return md;
-}
-
-SHA1::MD SHA1::compute(const void* data, size_t len)
-{
-    SHA1 sha1;
-    sha1.update(data, len);
-    return sha1.finalize();
-}
-
-std::string SHA1::toString(const SHA1::MD& sha1)
+namespace Falcor
 {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0') << std::setw(2);
-    for (auto c : sha1)
-        ss << (int)c;
-    return ss.str();
-}
-
-void SHA1::addByte(uint8_t byte)
+namespace
 {
-    mBuf[mIndex++] = byte;
+const size_t kBlockSize = 64;
 
-    if (mIndex >= sizeof(mBuf))
-    {
-        mIndex = 0;
-        processBlock(mBuf);
-    }
-}
-
-void SHA1::processBlock(const uint8_t* ptr)
+void processBlockPortable(uint32_t* state, const uint8_t* ptr)
 {
     auto rol32 = [](uint32_t x, uint32_t n) { return (x << n) | (x >> (32 - n)); };
 
@@ -141,11 +62,11 @@ void SHA1::processBlock(const uint8_t* ptr)
     const uint32_t c2 = 0x8f1bbcdc;
     const uint32_t c3 = 0xca62c1d6;
 
-    uint32_t a = mState[0];
-    uint32_t b = mState[1];
-    uint32_t c = mState[2];
-    uint32_t d = mState[3];
-    uint32_t e = mState[4];
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
 
     uint32_t w[16];
 
@@ -251,10 +172,279 @@ void SHA1::processBlock(const uint8_t* ptr)
 #undef SHA1_ROUND_3
 #undef SHA1_ROUND_4
 
-    mState[0] += a;
-    mState[1] += b;
-    mState[2] += c;
-    mState[3] += d;
-    mState[4] += e;
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void processBlocksPortable(uint32_t* state, const uint8_t* ptr, size_t blockCount)
+{
+    for (size_t i = 0; i < blockCount; i++, ptr += kBlockSize)
+        processBlockPortable(state, ptr);
+}
+
+#if SHA1_X86_SHA
+// SHA-1 using the x86 SHA extensions. Each sha1rnds4 instruction computes four rounds.
+// The message schedule for rounds 16..79 is computed on the fly with sha1msg1/sha1msg2.
+SHA1_TARGET_SHA void processBlocksX86(uint32_t* state, const uint8_t* ptr, size_t blockCount)
+{
+    const __m128i byteSwapMask = _mm_set_epi64x(0x0001020304050607ull, 0x08090a0b0c0d0e0full);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    __m128i e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    for (size_t block = 0; block < blockCount; block++, ptr += kBlockSize)
+    {
+        const __m128i abcdSaved = abcd;
+        const __m128i e0Saved = e0;
+
+        __m128i msg[4];
+        for (int i = 0; i < 4; i++)
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 16 * i)), byteSwapMask);
+
+        __m128i e1;
+        __m128i prev;
+
+// Computes message words 4*g..4*g+3 (g >= 4) in place of words 4*(g-4)..4*(g-4)+3.
+#define SHA1_SCHEDULE(g) \
+    msg[(g)&3] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(msg[(g)&3], msg[((g) + 1) & 3]), msg[((g) + 2) & 3]), msg[((g) + 3) & 3]);
+// Four rounds using message words 4*g..4*g+3 and round function f.
+#define SHA1_ROUNDS(g, f)                        \
+    e1 = _mm_sha1nexte_epu32(prev, msg[(g)&3]); \
+    prev = abcd;                                \
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, f);
+#define SHA1_ROUNDS_SCHEDULE(g, f) \
+    SHA1_SCHEDULE(g)               \
+    SHA1_ROUNDS(g, f)
+
+        // Rounds 0..3 add E directly, there is no previous ABCD to rotate.
+        e1 = _mm_add_epi32(e0, msg[0]);
+        prev = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+
+        SHA1_ROUNDS(1, 0);
+        SHA1_ROUNDS(2, 0);
+        SHA1_ROUNDS(3, 0);
+        SHA1_ROUNDS_SCHEDULE(4, 0);
+        SHA1_ROUNDS_SCHEDULE(5, 1);
+        SHA1_ROUNDS_SCHEDULE(6, 1);
+        SHA1_ROUNDS_SCHEDULE(7, 1);
+        SHA1_ROUNDS_SCHEDULE(8, 1);
+        SHA1_ROUNDS_SCHEDULE(9, 1);
+        SHA1_ROUNDS_SCHEDULE(10, 2);
+        SHA1_ROUNDS_SCHEDULE(11, 2);
+        SHA1_ROUNDS_SCHEDULE(12, 2);
+        SHA1_ROUNDS_SCHEDULE(13, 2);
+        SHA1_ROUNDS_SCHEDULE(14, 2);
+        SHA1_ROUNDS_SCHEDULE(15, 3);
+        SHA1_ROUNDS_SCHEDULE(16, 3);
+        SHA1_ROUNDS_SCHEDULE(17, 3);
+        SHA1_ROUNDS_SCHEDULE(18, 3);
+        SHA1_ROUNDS_SCHEDULE(19, 3);
+
+#undef SHA1_SCHEDULE
+#undef SHA1_ROUNDS
+#undef SHA1_ROUNDS_SCHEDULE
+
+        e0 = _mm_sha1nexte_epu32(prev, e0Saved);
+        abcd = _mm_add_epi32(abcd, abcdSaved);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+#endif // SHA1_X86_SHA
+
+#if SHA1_ARM_CRYPTO
+// SHA-1 using the ARMv8 crypto extensions. Each sha1c/sha1p/sha1m instruction computes four rounds.
+void processBlocksARM(uint32_t* state, const uint8_t* ptr, size_t blockCount)
+{
+    const uint32x4_t k0 = vdupq_n_u32(0x5a827999);
+    const uint32x4_t k1 = vdupq_n_u32(0x6ed9eba1);
+    const uint32x4_t k2 = vdupq_n_u32(0x8f1bbcdc);
+    const uint32x4_t k3 = vdupq_n_u32(0xca62c1d6);
+
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32_t e0 = state[4];
+
+    for (size_t block = 0; block < blockCount; block++, ptr += kBlockSize)
+    {
+        const uint32x4_t abcdSaved = abcd;
+        const uint32_t e0Saved = e0;
+
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; i++)
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(ptr + 16 * i)));
+
+        uint32_t e1;
+        uint32x4_t tmp;
+
+// Computes message words 4*g..4*g+3 (g >= 4) in place of words 4*(g-4)..4*(g-4)+3.
+#define SHA1_SCHEDULE(g) \
+    msg[(g)&3] = vsha1su1q_u32(vsha1su0q_u32(msg[(g)&3], msg[((g) + 1) & 3], msg[((g) + 2) & 3]), msg[((g) + 3) & 3]);
+// Four rounds using message words 4*g..4*g+3, round function op and round constant k.
+#define SHA1_ROUNDS(g, op, k)                     \
+    tmp = vaddq_u32(msg[(g)&3], k);               \
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));     \
+    abcd = op(abcd, e0, tmp);                     \
+    e0 = e1;
+#define SHA1_ROUNDS_SCHEDULE(g, op, k) \
+    SHA1_SCHEDULE(g)                   \
+    SHA1_ROUNDS(g, op, k)
+
+        SHA1_ROUNDS(0, vsha1cq_u32, k0);
+        SHA1_ROUNDS(1, vsha1cq_u32, k0);
+        SHA1_ROUNDS(2, vsha1cq_u32, k0);
+        SHA1_ROUNDS(3, vsha1cq_u32, k0);
+        SHA1_ROUNDS_SCHEDULE(4, vsha1cq_u32, k0);
+        SHA1_ROUNDS_SCHEDULE(5, vsha1pq_u32, k1);
+        SHA1_ROUNDS_SCHEDULE(6, vsha1pq_u32, k1);
+        SHA1_ROUNDS_SCHEDULE(7, vsha1pq_u32, k1);
+        SHA1_ROUNDS_SCHEDULE(8, vsha1pq_u32, k1);
+        SHA1_ROUNDS_SCHEDULE(9, vsha1pq_u32, k1);
+        SHA1_ROUNDS_SCHEDULE(10, vsha1mq_u32, k2);
+        SHA1_ROUNDS_SCHEDULE(11, vsha1mq_u32, k2);
+        SHA1_ROUNDS_SCHEDULE(12, vsha1mq_u32, k2);
+        SHA1_ROUNDS_SCHEDULE(13, vsha1mq_u32, k2);
+        SHA1_ROUNDS_SCHEDULE(14, vsha1mq_u32, k2);
+        SHA1_ROUNDS_SCHEDULE(15, vsha1pq_u32, k3);
+        SHA1_ROUNDS_SCHEDULE(16, vsha1pq_u32, k3);
+        SHA1_ROUNDS_SCHEDULE(17, vsha1pq_u32, k3);
+        SHA1_ROUNDS_SCHEDULE(18, vsha1pq_u32, k3);
+        SHA1_ROUNDS_SCHEDULE(19, vsha1pq_u32, k3);
+
+#undef SHA1_SCHEDULE
+#undef SHA1_ROUNDS
+#undef SHA1_ROUNDS_SCHEDULE
+
+        abcd = vaddq_u32(abcd, abcdSaved);
+        e0 += e0Saved;
+    }
+
+    vst1q_u32(state, abcd);
+    state[4] = e0;
+}
+#endif // SHA1_ARM_CRYPTO
+
+using ProcessBlocksFunc = void (*)(uint32_t* state, const uint8_t* ptr, size_t blockCount);
+
+ProcessBlocksFunc getProcessBlocksFunc()
+{
+    static const ProcessBlocksFunc func = []() -> ProcessBlocksFunc
+    {
+        const CpuFeatures& features = getCpuFeatures();
+#if SHA1_X86_SHA
+        if (features.sha && features.sse41 && features.ssse3)
+            return processBlocksX86;
+#elif SHA1_ARM_CRYPTO
+        if (features.sha)
+            return processBlocksARM;
+#endif
+        (void)features;
+        return processBlocksPortable;
+    }();
+    return func;
+}
+} // namespace
+
+SHA1::SHA1() : mIndex(0), mBits(0)
+{
+    mState[0] = 0x67452301;
+    mState[1] = 0xefcdab89;
+    mState[2] = 0x98badcfe;
+    mState[3] = 0x10325476;
+    mState[4] = 0xc3d2e1f0;
+}
+
+void SHA1::update(uint8_t byte)
+{
+    update(&byte, 1);
+}
+
+void SHA1::update(const void* data, size_t len)
+{
+    if (!data)
+        return;
+
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+    const ProcessBlocksFunc processBlocks = getProcessBlocksFunc();
+    mBits += (uint64_t)len * 8;
+
+    // Fill up buffer if not empty.
+    if (mIndex != 0)
+    {
+        const size_t count = std::min(len, sizeof(mBuf) - mIndex);
+        std::memcpy(mBuf + mIndex, ptr, count);
+        mIndex += (uint32_t)count;
+        ptr += count;
+        len -= count;
+        if (mIndex < sizeof(mBuf))
+            return;
+        processBlocks(mState, mBuf, 1);
+        mIndex = 0;
+    }
+
+    // Process full blocks directly from the input.
+    const size_t blockCount = len / sizeof(mBuf);
+    if (blockCount > 0)
+    {
+        processBlocks(mState, ptr, blockCount);
+        ptr += blockCount * sizeof(mBuf);
+        len -= blockCount * sizeof(mBuf);
+    }
+
+    // Buffer remaining bytes.
+    std::memcpy(mBuf, ptr, len);
+    mIndex = (uint32_t)len;
+}
+
+SHA1::MD SHA1::finalize()
+{
+    const ProcessBlocksFunc processBlocks = getProcessBlocksFunc();
+
+    // Finalize with 0x80, some zero padding and the length in bits.
+    mBuf[mIndex++] = 0x80;
+    if (mIndex > 56)
+    {
+        std::memset(mBuf + mIndex, 0, sizeof(mBuf) - mIndex);
+        processBlocks(mState, mBuf, 1);
+        mIndex = 0;
+    }
+    std::memset(mBuf + mIndex, 0, 56 - mIndex);
+    for (int i = 0; i < 8; ++i)
+    {
+        mBuf[56 + i] = (uint8_t)(mBits >> ((7 - i) * 8));
+    }
+    processBlocks(mState, mBuf, 1);
+    mIndex = 0;
+
+    MD md;
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 3; j >= 0; j--)
+        {
+            md[i * 4 + j] = (mState[i] >> ((3 - j) * 8)) & 0xff;
+        }
+    }
+
+    return md;
+}
+
+SHA1::MD SHA1::compute(const void* data, size_t len)
+{
+    SHA1 sha1;
+    sha1.update(data, len);
+    return sha1.finalize();
+}
+
+std::string SHA1::toString(const SHA1::MD& sha1)
+{
+    std::string str;
+    str.reserve(sha1.size() * 2);
+    for (auto c : sha1)
+        str += fmt::format("{:02x}", c);
+    return str;
 }
 } // namespace Falcor
@@ -52,6 +52,7 @@ public:
 
     /**
      * Update hash by adding the given data.
+     * Full 64-byte blocks are compressed directly from the input, using the SHA CPU extensions if available.
      * @param[in] data Data to hash.
      * @param[in] len Length of data in bytes.
      */
@@ -92,9 +93,6 @@ public:
     static std::string toString(const MD& sha1);
 
 private:
-    void addByte(uint8_t x);
-    void processBlock(const uint8_t* ptr);
-
     uint32_t mIndex;
     uint64_t mBits;
     uint32_t mState[5];
@@ -0,0 +1,748 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FastHash.h"
+#include "Core/Assert.h"
+#include "Core/Platform/CpuFeatures.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FAST_HASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FAST_HASH_AVX2 1
+#include <immintrin.h>
+#if FALCOR_MSVC
+#define FAST_HASH_TARGET_AVX2
+#else
+#define FAST_HASH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// This is an implementation of XXH3 as specified by the reference xxHash implementation (https://github.com/Cyan4973/xxHash).
+// Only the default secret (optionally derived from a seed) is supported.
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kPrime32_1 = 0x9E3779B1u;
+const uint32_t kPrime32_2 = 0x85EBCA77u;
+const uint32_t kPrime32_3 = 0xC2B2AE3Du;
+const uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+const uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+const uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+const uint64_t kPrime64_5 = 0x27D4EB2F165667C5ull;
+const uint64_t kPrimeMx1 = 0x165667919E3779F9ull;
+const uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ull;
+
+const size_t kStripeLen = 64;
+const size_t kSecretConsumeRate = 8;
+const size_t kSecretSize = 192;
+const size_t kSecretSizeMin = 136;
+const size_t kSecretLastAccStart = 7;
+const size_t kSecretMergeAccsStart = 11;
+const size_t kMidSizeMax = 240;
+const size_t kMidSizeStartOffset = 3;
+const size_t kMidSizeLastOffset = 17;
+const size_t kStripesPerBlock = (kSecretSize - kStripeLen) / kSecretConsumeRate;
+const size_t kBlockLen = kStripeLen * kStripesPerBlock;
+
+// clang-format off
+alignas(64) const uint8_t kSecret[kSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+// clang-format on
+
+inline uint32_t readLE32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t readLE64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void writeLE64(uint8_t* p, uint64_t v)
+{
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline uint32_t swap32(uint32_t x)
+{
+    return ((x << 24) & 0xff000000u) | ((x << 8) & 0x00ff0000u) | ((x >> 8) & 0x0000ff00u) | ((x >> 24) & 0x000000ffu);
+}
+
+inline uint64_t swap64(uint64_t x)
+{
+    return ((uint64_t)swap32((uint32_t)x) << 32) | swap32((uint32_t)(x >> 32));
+}
+
+inline uint32_t rotl32(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t xorshift64(uint64_t v, int shift)
+{
+    return v ^ (v >> shift);
+}
+
+inline Hash128 mul64to128(uint64_t lhs, uint64_t rhs)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)lhs * rhs;
+    return {(uint64_t)product, (uint64_t)(product >> 64)};
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(lhs, rhs, &high);
+    return {low, high};
+#else
+    uint64_t loLo = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+    uint64_t hiLo = (lhs >> 32) * (rhs & 0xffffffff);
+    uint64_t loHi = (lhs & 0xffffffff) * (rhs >> 32);
+    uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffff) + loHi;
+    uint64_t upper = (hiLo >> 32) + (cross >> 32) + hiHi;
+    uint64_t lower = (cross << 32) | (loLo & 0xffffffff);
+    return {lower, upper};
+#endif
+}
+
+inline uint64_t mul128Fold64(uint64_t lhs, uint64_t rhs)
+{
+    Hash128 product = mul64to128(lhs, rhs);
+    return product.low ^ product.high;
+}
+
+inline uint64_t xxh64Avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+    h = xorshift64(h, 37);
+    h *= kPrimeMx1;
+    h = xorshift64(h, 32);
+    return h;
+}
+
+inline uint64_t rrmxmx(uint64_t h, uint64_t len)
+{
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= kPrimeMx2;
+    h ^= (h >> 35) + len;
+    h *= kPrimeMx2;
+    return xorshift64(h, 28);
+}
+
+inline uint64_t mix16B(const uint8_t* input, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t inputLo = readLE64(input);
+    uint64_t inputHi = readLE64(input + 8);
+    return mul128Fold64(inputLo ^ (readLE64(secret) + seed), inputHi ^ (readLE64(secret + 8) - seed));
+}
+
+inline Hash128 mix32B(Hash128 acc, const uint8_t* input1, const uint8_t* input2, const uint8_t* secret, uint64_t seed)
+{
+    acc.low += mix16B(input1, secret, seed);
+    acc.low ^= readLE64(input2) + readLE64(input2 + 8);
+    acc.high += mix16B(input2, secret + 16, seed);
+    acc.high ^= readLE64(input1) + readLE64(input1 + 8);
+    return acc;
+}
+
+// Short inputs (64-bit).
+
+uint64_t hashLen0To16_64(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    if (len > 8)
+    {
+        uint64_t bitflip1 = (readLE64(secret + 24) ^ readLE64(secret + 32)) + seed;
+        uint64_t bitflip2 = (readLE64(secret + 40) ^ readLE64(secret + 48)) - seed;
+        uint64_t inputLo = readLE64(input) ^ bitflip1;
+        uint64_t inputHi = readLE64(input + len - 8) ^ bitflip2;
+        uint64_t acc = len + swap64(inputLo) + inputHi + mul128Fold64(inputLo, inputHi);
+        return avalanche(acc);
+    }
+    if (len >= 4)
+    {
+        seed ^= (uint64_t)swap32((uint32_t)seed) << 32;
+        uint32_t input1 = readLE32(input);
+        uint32_t input2 = readLE32(input + len - 4);
+        uint64_t bitflip = (readLE64(secret + 8) ^ readLE64(secret + 16)) - seed;
+        uint64_t input64 = input2 + ((uint64_t)input1 << 32);
+        return rrmxmx(input64 ^ bitflip, len);
+    }
+    if (len > 0)
+    {
+        uint8_t c1 = input[0];
+        uint8_t c2 = input[len >> 1];
+        uint8_t c3 = input[len - 1];
+        uint32_t combined = ((uint32_t)c1 << 16) | ((uint32_t)c2 << 24) | ((uint32_t)c3 << 0) | ((uint32_t)len << 8);
+        uint64_t bitflip = (readLE32(secret) ^ readLE32(secret + 4)) + seed;
+        return xxh64Avalanche((uint64_t)combined ^ bitflip);
+    }
+    return xxh64Avalanche(seed ^ (readLE64(secret + 56) ^ readLE64(secret + 64)));
+}
+
+uint64_t hashLen17To128_64(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t acc = len * kPrime64_1;
+    if (len > 32)
+    {
+        if (len > 64)
+        {
+            if (len > 96)
+            {
+                acc += mix16B(input + 48, secret + 96, seed);
+                acc += mix16B(input + len - 64, secret + 112, seed);
+            }
+            acc += mix16B(input + 32, secret + 64, seed);
+            acc += mix16B(input + len - 48, secret + 80, seed);
+        }
+        acc += mix16B(input + 16, secret + 32, seed);
+        acc += mix16B(input + len - 32, secret + 48, seed);
+    }
+    acc += mix16B(input + 0, secret + 0, seed);
+    acc += mix16B(input + len - 16, secret + 16, seed);
+    return avalanche(acc);
+}
+
+uint64_t hashLen129To240_64(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t acc = len * kPrime64_1;
+    const size_t roundCount = len / 16;
+    for (size_t i = 0; i < 8; i++)
+        acc += mix16B(input + 16 * i, secret + 16 * i, seed);
+    uint64_t accEnd = mix16B(input + len - 16, secret + kSecretSizeMin - kMidSizeLastOffset, seed);
+    acc = avalanche(acc);
+    for (size_t i = 8; i < roundCount; i++)
+        accEnd += mix16B(input + 16 * i, secret + 16 * (i - 8) + kMidSizeStartOffset, seed);
+    return avalanche(acc + accEnd);
+}
+
+// Short inputs (128-bit).
+
+Hash128 finalizeMid128(Hash128 acc, size_t len, uint64_t seed)
+{
+    Hash128 h;
+    h.low = acc.low + acc.high;
+    h.high = (acc.low * kPrime64_1) + (acc.high * kPrime64_4) + ((len - seed) * kPrime64_2);
+    h.low = avalanche(h.low);
+    h.high = (uint64_t)0 - avalanche(h.high);
+    return h;
+}
+
+Hash128 hashLen0To16_128(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    if (len > 8)
+    {
+        uint64_t bitflipLo = (readLE64(secret + 32) ^ readLE64(secret + 40)) - seed;
+        uint64_t bitflipHi = (readLE64(secret + 48) ^ readLE64(secret + 56)) + seed;
+        uint64_t inputLo = readLE64(input);
+        uint64_t inputHi = readLE64(input + len - 8);
+        Hash128 m = mul64to128(inputLo ^ inputHi ^ bitflipLo, kPrime64_1);
+        m.low += (uint64_t)(len - 1) << 54;
+        inputHi ^= bitflipHi;
+        m.high += inputHi + (uint64_t)(uint32_t)inputHi * (kPrime32_2 - 1);
+        m.low ^= swap64(m.high);
+        Hash128 h = mul64to128(m.low, kPrime64_2);
+        h.high += m.high * kPrime64_2;
+        h.low = avalanche(h.low);
+        h.high = avalanche(h.high);
+        return h;
+    }
+    if (len >= 4)
+    {
+        seed ^= (uint64_t)swap32((uint32_t)seed) << 32;
+        uint32_t inputLo = readLE32(input);
+        uint32_t inputHi = readLE32(input + len - 4);
+        uint64_t input64 = inputLo + ((uint64_t)inputHi << 32);
+        uint64_t bitflip = (readLE64(secret + 16) ^ readLE64(secret + 24)) + seed;
+        Hash128 m = mul64to128(input64 ^ bitflip, kPrime64_1 + (len << 2));
+        m.high += (m.low << 1);
+        m.low ^= (m.high >> 3);
+        m.low = xorshift64(m.low, 35);
+        m.low *= kPrimeMx2;
+        m.low = xorshift64(m.low, 28);
+        m.high = avalanche(m.high);
+        return m;
+    }
+    if (len > 0)
+    {
+        uint8_t c1 = input[0];
+        uint8_t c2 = input[len >> 1];
+        uint8_t c3 = input[len - 1];
+        uint32_t combinedLo = ((uint32_t)c1 << 16) | ((uint32_t)c2 << 24) | ((uint32_t)c3 << 0) | ((uint32_t)len << 8);
+        uint32_t combinedHi = rotl32(swap32(combinedLo), 13);
+        uint64_t bitflipLo = (readLE32(secret) ^ readLE32(secret + 4)) + seed;
+        uint64_t bitflipHi = (readLE32(secret + 8) ^ readLE32(secret + 12)) - seed;
+        return {xxh64Avalanche((uint64_t)combinedLo ^ bitflipLo), xxh64Avalanche((uint64_t)combinedHi ^ bitflipHi)};
+    }
+    uint64_t bitflipLo = readLE64(secret + 64) ^ readLE64(secret + 72);
+    uint64_t bitflipHi = readLE64(secret + 80) ^ readLE64(secret + 88);
+    return {xxh64Avalanche(seed ^ bitflipLo), xxh64Avalanche(seed ^ bitflipHi)};
+}
+
+Hash128 hashLen17To128_128(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    Hash128 acc{len * kPrime64_1, 0};
+    if (len > 32)
+    {
+        if (len > 64)
+        {
+            if (len > 96)
+                acc = mix32B(acc, input + 48, input + len - 64, secret + 96, seed);
+            acc = mix32B(acc, input + 32, input + len - 48, secret + 64, seed);
+        }
+        acc = mix32B(acc, input + 16, input + len - 32, secret + 32, seed);
+    }
+    acc = mix32B(acc, input, input + len - 16, secret, seed);
+    return finalizeMid128(acc, len, seed);
+}
+
+Hash128 hashLen129To240_128(const uint8_t* input, size_t len, const uint8_t* secret, uint64_t seed)
+{
+    Hash128 acc{len * kPrime64_1, 0};
+    for (size_t i = 32; i < 160; i += 32)
+        acc = mix32B(acc, input + i - 32, input + i - 16, secret + i - 32, seed);
+    acc.low = avalanche(acc.low);
+    acc.high = avalanche(acc.high);
+    for (size_t i = 160; i <= len; i += 32)
+        acc = mix32B(acc, input + i - 32, input + i - 16, secret + kMidSizeStartOffset + i - 160, seed);
+    acc = mix32B(acc, input + len - 16, input + len - 32, secret + kSecretSizeMin - kMidSizeLastOffset - 16, (uint64_t)0 - seed);
+    return finalizeMid128(acc, len, seed);
+}
+
+// Long inputs.
+
+#if FAST_HASH_SSE2
+inline void accumulate512(uint64_t* acc, const uint8_t* input, const uint8_t* secret)
+{
+    __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+    for (size_t i = 0; i < 4; i++)
+    {
+        __m128i dataVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+        __m128i keyVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+        __m128i dataKeyLo = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i product = _mm_mul_epu32(dataKey, dataKeyLo);
+        __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i sum = _mm_add_epi64(xacc[i], dataSwap);
+        xacc[i] = _mm_add_epi64(product, sum);
+    }
+}
+
+inline void scrambleAcc(uint64_t* acc, const uint8_t* secret)
+{
+    __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+    const __m128i prime32 = _mm_set1_epi32((int)kPrime32_1);
+    for (size_t i = 0; i < 4; i++)
+    {
+        __m128i accVec = xacc[i];
+        __m128i dataVec = _mm_xor_si128(accVec, _mm_srli_epi64(accVec, 47));
+        __m128i keyVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+        __m128i dataKeyHi = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i productLo = _mm_mul_epu32(dataKey, prime32);
+        __m128i productHi = _mm_mul_epu32(dataKeyHi, prime32);
+        xacc[i] = _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32));
+    }
+}
+#else
+inline void accumulate512(uint64_t* acc, const uint8_t* input, const uint8_t* secret)
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        uint64_t dataVal = readLE64(input + i * 8);
+        uint64_t dataKey = dataVal ^ readLE64(secret + i * 8);
+        acc[i ^ 1] += dataVal;
+        acc[i] += (dataKey & 0xffffffff) * (dataKey >> 32);
+    }
+}
+
+inline void scrambleAcc(uint64_t* acc, const uint8_t* secret)
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        uint64_t acc64 = xorshift64(acc[i], 47);
+        acc64 ^= readLE64(secret + i * 8);
+        acc64 *= kPrime32_1;
+        acc[i] = acc64;
+    }
+}
+#endif
+
+void accumulateDefault(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    for (size_t n = 0; n < stripeCount; n++)
+        accumulate512(acc, input + n * kStripeLen, secret + n * kSecretConsumeRate);
+}
+
+void scrambleAccDefault(uint64_t* acc, const uint8_t* secret)
+{
+    scrambleAcc(acc, secret);
+}
+
+#if FAST_HASH_AVX2
+FAST_HASH_TARGET_AVX2 inline __m256i accumulateRoundAVX2(__m256i acc, const uint8_t* input, const uint8_t* secret)
+{
+    __m256i dataVec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+    __m256i keyVec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret));
+    __m256i dataKey = _mm256_xor_si256(dataVec, keyVec);
+    __m256i product = _mm256_mul_epu32(dataKey, _mm256_srli_epi64(dataKey, 32));
+    __m256i dataSwap = _mm256_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(product, _mm256_add_epi64(acc, dataSwap));
+}
+
+FAST_HASH_TARGET_AVX2 void accumulateAVX2(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    __m256i acc0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    __m256i acc1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + 1);
+    for (size_t n = 0; n < stripeCount; n++)
+    {
+        const uint8_t* pInput = input + n * kStripeLen;
+        const uint8_t* pSecret = secret + n * kSecretConsumeRate;
+        acc0 = accumulateRoundAVX2(acc0, pInput, pSecret);
+        acc1 = accumulateRoundAVX2(acc1, pInput + 32, pSecret + 32);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), acc0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + 1, acc1);
+}
+
+FAST_HASH_TARGET_AVX2 void scrambleAccAVX2(uint64_t* acc, const uint8_t* secret)
+{
+    const __m256i prime32 = _mm256_set1_epi32((int)kPrime32_1);
+    for (size_t i = 0; i < 2; i++)
+    {
+        __m256i accVec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+        __m256i dataVec = _mm256_xor_si256(accVec, _mm256_srli_epi64(accVec, 47));
+        __m256i keyVec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+        __m256i dataKey = _mm256_xor_si256(dataVec, keyVec);
+        __m256i productLo = _mm256_mul_epu32(dataKey, prime32);
+        __m256i productHi = _mm256_mul_epu32(_mm256_srli_epi64(dataKey, 32), prime32);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, _mm256_add_epi64(productLo, _mm256_slli_epi64(productHi, 32)));
+    }
+}
+#endif
+
+/**
+ * Stripe accumulation and scrambling functions for the long input loop, selected at runtime.
+ */
+struct LongHashKernels
+{
+    void (*accumulate)(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount) = accumulateDefault;
+    void (*scrambleAcc)(uint64_t* acc, const uint8_t* secret) = scrambleAccDefault;
+};
+
+const LongHashKernels& getLongHashKernels()
+{
+    static const LongHashKernels kernels = []()
+    {
+        LongHashKernels k;
+#if FAST_HASH_AVX2
+        if (getCpuFeatures().avx2)
+        {
+            k.accumulate = accumulateAVX2;
+            k.scrambleAcc = scrambleAccAVX2;
+        }
+#endif
+        return k;
+    }();
+    return kernels;
+}
+
+void initAcc(uint64_t* acc)
+{
+    acc[0] = kPrime32_3;
+    acc[1] = kPrime64_1;
+    acc[2] = kPrime64_2;
+    acc[3] = kPrime64_3;
+    acc[4] = kPrime64_4;
+    acc[5] = kPrime32_2;
+    acc[6] = kPrime64_5;
+    acc[7] = kPrime32_1;
+}
+
+void initSecret(uint8_t* secret, uint64_t seed)
+{
+    for (size_t i = 0; i < kSecretSize / 16; i++)
+    {
+        writeLE64(secret + 16 * i, readLE64(kSecret + 16 * i) + seed);
+        writeLE64(secret + 16 * i + 8, readLE64(kSecret + 16 * i + 8) - seed);
+    }
+}
+
+uint64_t mergeAccs(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+{
+    uint64_t result = start;
+    for (size_t i = 0; i < 4; i++)
+        result += mul128Fold64(acc[2 * i] ^ readLE64(secret + 16 * i), acc[2 * i + 1] ^ readLE64(secret + 16 * i + 8));
+    return avalanche(result);
+}
+
+Hash128 mergeAccs128(const uint64_t* acc, const uint8_t* secret, uint64_t len)
+{
+    return {
+        mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1),
+        mergeAccs(acc, secret + kSecretSize - 64 - kSecretMergeAccsStart, ~(len * kPrime64_2)),
+    };
+}
+
+void hashLongLoop(uint64_t* acc, const uint8_t* input, size_t len, const uint8_t* secret)
+{
+    const LongHashKernels& kernels = getLongHashKernels();
+    const size_t blockCount = (len - 1) / kBlockLen;
+    for (size_t n = 0; n < blockCount; n++)
+    {
+        kernels.accumulate(acc, input + n * kBlockLen, secret, kStripesPerBlock);
+        kernels.scrambleAcc(acc, secret + kSecretSize - kStripeLen);
+    }
+
+    // Last partial block and last stripe.
+    const size_t stripeCount = ((len - 1) - (kBlockLen * blockCount)) / kStripeLen;
+    kernels.accumulate(acc, input + blockCount * kBlockLen, secret, stripeCount);
+    accumulate512(acc, input + len - kStripeLen, secret + kSecretSize - kStripeLen - kSecretLastAccStart);
+}
+
+const uint8_t* getLongSecret(uint64_t seed, uint8_t* customSecret)
+{
+    if (seed == 0)
+        return kSecret;
+    initSecret(customSecret, seed);
+    return customSecret;
+}
+
+/**
+ * Consume full stripes, scrambling the accumulators at block boundaries.
+ * @return Returns the pointer past the consumed input.
+ */
+const uint8_t* consumeStripes(uint64_t* acc, size_t& stripesSoFar, const uint8_t* input, size_t stripeCount, const uint8_t* secret)
+{
+    const LongHashKernels& kernels = getLongHashKernels();
+    const uint8_t* initialSecret = secret + stripesSoFar * kSecretConsumeRate;
+    if (stripeCount >= kStripesPerBlock - stripesSoFar)
+    {
+        size_t stripesThisIteration = kStripesPerBlock - stripesSoFar;
+        do
+        {
+            kernels.accumulate(acc, input, initialSecret, stripesThisIteration);
+            kernels.scrambleAcc(acc, secret + kSecretSize - kStripeLen);
+            input += stripesThisIteration * kStripeLen;
+            stripeCount -= stripesThisIteration;
+            stripesThisIteration = kStripesPerBlock;
+            initialSecret = secret;
+            stripesSoFar = 0;
+        } while (stripeCount >= kStripesPerBlock);
+    }
+    if (stripeCount > 0)
+    {
+        kernels.accumulate(acc, input, initialSecret, stripeCount);
+        input += stripeCount * kStripeLen;
+        stripesSoFar += stripeCount;
+    }
+    return input;
+}
+} // namespace
+
+FastHash::FastHash(uint64_t seed)
+{
+    reset(seed);
+}
+
+void FastHash::reset(uint64_t seed)
+{
+    initAcc(mAcc);
+    initSecret(mSecret, seed);
+    mSeed = seed;
+    mTotalLen = 0;
+    mBufferedSize = 0;
+    mStripesSoFar = 0;
+}
+
+void FastHash::update(const void* data, size_t len)
+{
+    if (!data || len == 0)
+        return;
+
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = input + len;
+    mTotalLen += len;
+
+    // Small updates only fill the buffer.
+    if (len <= kBufferSize - mBufferedSize)
+    {
+        std::memcpy(mBuffer + mBufferedSize, input, len);
+        mBufferedSize += len;
+        return;
+    }
+
+    // Complete and consume the buffer. The buffer is only consumed once more input follows,
+    // as the last stripe is treated differently in digest().
+    if (mBufferedSize > 0)
+    {
+        const size_t loadSize = kBufferSize - mBufferedSize;
+        std::memcpy(mBuffer + mBufferedSize, input, loadSize);
+        input += loadSize;
+        consumeStripes(mAcc, mStripesSoFar, mBuffer, kBufferSize / kStripeLen, mSecret);
+        mBufferedSize = 0;
+    }
+
+    // Consume full stripes directly from the input, keeping at least one byte for the buffer.
+    if ((size_t)(end - input) > kBufferSize)
+    {
+        const size_t stripeCount = (size_t)(end - 1 - input) / kStripeLen;
+        input = consumeStripes(mAcc, mStripesSoFar, input, stripeCount, mSecret);
+        // Keep the last consumed stripe at the end of the buffer, it is needed if digest() has less than one stripe buffered.
+        std::memcpy(mBuffer + kBufferSize - kStripeLen, input - kStripeLen, kStripeLen);
+    }
+
+    FALCOR_ASSERT(input < end && (size_t)(end - input) <= kBufferSize);
+    std::memcpy(mBuffer, input, (size_t)(end - input));
+    mBufferedSize = (size_t)(end - input);
+}
+
+void FastHash::digestLong(uint64_t* acc) const
+{
+    std::copy(mAcc, mAcc + 8, acc);
+    size_t stripesSoFar = mStripesSoFar;
+    uint8_t lastStripe[kStripeLen];
+    const uint8_t* pLastStripe;
+    if (mBufferedSize >= kStripeLen)
+    {
+        consumeStripes(acc, stripesSoFar, mBuffer, (mBufferedSize - 1) / kStripeLen, mSecret);
+        pLastStripe = mBuffer + mBufferedSize - kStripeLen;
+    }
+    else
+    {
+        // Assemble the last stripe from the end of the previously consumed data and the buffered bytes.
+        const size_t catchupSize = kStripeLen - mBufferedSize;
+        std::memcpy(lastStripe, mBuffer + kBufferSize - catchupSize, catchupSize);
+        std::memcpy(lastStripe + catchupSize, mBuffer, mBufferedSize);
+        pLastStripe = lastStripe;
+    }
+    accumulate512(acc, pLastStripe, mSecret + kSecretSize - kStripeLen - kSecretLastAccStart);
+}
+
+uint64_t FastHash::digest64() const
+{
+    if (mTotalLen <= kMidSizeMax)
+        return hash64(mBuffer, (size_t)mTotalLen, mSeed);
+
+    alignas(64) uint64_t acc[8];
+    digestLong(acc);
+    return mergeAccs(acc, mSecret + kSecretMergeAccsStart, mTotalLen * kPrime64_1);
+}
+
+Hash128 FastHash::digest128() const
+{
+    if (mTotalLen <= kMidSizeMax)
+        return hash128(mBuffer, (size_t)mTotalLen, mSeed);
+
+    alignas(64) uint64_t acc[8];
+    digestLong(acc);
+    return mergeAccs128(acc, mSecret, mTotalLen);
+}
+
+uint64_t FastHash::hash64(const void* data, size_t len, uint64_t seed)
+{
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    if (len <= 16)
+        return hashLen0To16_64(input, len, kSecret, seed);
+    if (len <= 128)
+        return hashLen17To128_64(input, len, kSecret, seed);
+    if (len <= kMidSizeMax)
+        return hashLen129To240_64(input, len, kSecret, seed);
+
+    alignas(64) uint8_t customSecret[kSecretSize];
+    const uint8_t* secret = getLongSecret(seed, customSecret);
+    alignas(64) uint64_t acc[8];
+    initAcc(acc);
+    hashLongLoop(acc, input, len, secret);
+    return mergeAccs(acc, secret + kSecretMergeAccsStart, (uint64_t)len * kPrime64_1);
+}
+
+Hash128 FastHash::hash128(const void* data, size_t len, uint64_t seed)
+{
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+    if (len <= 16)
+        return hashLen0To16_128(input, len, kSecret, seed);
+    if (len <= 128)
+        return hashLen17To128_128(input, len, kSecret, seed);
+    if (len <= kMidSizeMax)
+        return hashLen129To240_128(input, len, kSecret, seed);
+
+    alignas(64) uint8_t customSecret[kSecretSize];
+    const uint8_t* secret = getLongSecret(seed, customSecret);
+    alignas(64) uint64_t acc[8];
+    initAcc(acc);
+    hashLongLoop(acc, input, len, secret);
+    return mergeAccs128(acc, secret, len);
+}
+
+std::string FastHash::toString(const Hash128& hash)
+{
+    return fmt::format("{:016x}{:016x}", hash.high, hash.low);
+}
+} // namespace Falcor
@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <cstdint>
+#include <cstdlib>
+
+namespace Falcor
+{
+/**
+ * 128-bit hash value.
+ */
+struct Hash128
+{
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+/**
+ * Fast non-cryptographic hash.
+ *
+ * Implements the XXH3 algorithm (64-bit and 128-bit variants) and produces results that are bit-exact with the
+ * reference xxHash implementation (XXH3_64bits_withSeed / XXH3_128bits_withSeed). Use this for hashing large buffers
+ * where collision resistance against adversarial input is not required (cache keys, content deduplication etc.).
+ * Use SHA1 if a cryptographic hash is needed.
+ *
+ * The streaming interface produces the same result as the one-shot functions regardless of how the input is split.
+ */
+class FALCOR_API FastHash
+{
+public:
+    /**
+     * Constructor.
+     * @param[in] seed Seed value.
+     */
+    explicit FastHash(uint64_t seed = 0);
+
+    /**
+     * Reset the hash state.
+     * @param[in] seed Seed value.
+     */
+    void reset(uint64_t seed = 0);
+
+    /**
+     * Update hash by adding the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     */
+    void update(const void* data, size_t len);
+
+    /**
+     * Update hash by adding one value of fundamental type T.
+     * @param[in] value Value to hash.
+     */
+    template<typename T, std::enable_if_t<std::is_fundamental<T>::value, bool> = true>
+    void update(const T& value)
+    {
+        update(&value, sizeof(value));
+    }
+
+    /**
+     * Update hash by adding the given string view.
+     */
+    void update(const std::string_view str) { update(str.data(), str.size()); }
+
+    /**
+     * Return the 64-bit hash of all data added so far. The state is not modified.
+     */
+    uint64_t digest64() const;
+
+    /**
+     * Return the 128-bit hash of all data added so far. The state is not modified.
+     */
+    Hash128 digest128() const;
+
+    /**
+     * Compute 64-bit hash over the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] seed Seed value.
+     * @return Returns the 64-bit hash.
+     */
+    static uint64_t hash64(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * Compute 128-bit hash over the given data.
+     * @param[in] data Data to hash.
+     * @param[in] len Length of data in bytes.
+     * @param[in] seed Seed value.
+     * @return Returns the 128-bit hash.
+     */
+    static Hash128 hash128(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * Convert 128-bit hash to 32-character string in hexadecimal notation (high word first).
+     */
+    static std::string toString(const Hash128& hash);
+
+private:
+    void digestLong(uint64_t* acc) const;
+
+    static constexpr size_t kSecretSize = 192;
+    static constexpr size_t kBufferSize = 256;
+
+    alignas(64) uint64_t mAcc[8];
+    alignas(64) uint8_t mSecret[kSecretSize];
+    alignas(64) uint8_t mBuffer[kBufferSize];
+    uint64_t mSeed;
+    uint64_t mTotalLen;
+    size_t mBufferedSize;
+    size_t mStripesSoFar;
+};
+} // namespace Falcor
@@ -0,0 +1,162 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AsyncImageWriter.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+
+namespace Falcor
+{
+AsyncImageWriter::AsyncImageWriter(uint32_t workerCount, size_t maxQueuedImages) : mMaxQueuedImages(maxQueuedImages)
+{
+    checkArgument(workerCount > 0, "'workerCount' must be at least 1.");
+    checkArgument(maxQueuedImages > 0, "'maxQueuedImages' must be at least 1.");
+
+    mThreads.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+        mThreads.emplace_back(&AsyncImageWriter::runWorker, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTerminate = true;
+    }
+    mWorkAvailable.notify_all();
+
+    // Workers drain the queue before they exit.
+    for (auto& thread : mThreads)
+        thread.join();
+}
+
+void AsyncImageWriter::write(
+    const std::filesystem::path& path,
+    uint32_t width,
+    uint32_t height,
+    Bitmap::FileFormat fileFormat,
+    Bitmap::ExportFlags exportFlags,
+    ResourceFormat resourceFormat,
+    bool isTopDown,
+    std::vector<uint8_t>&& data
+)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (!mHasFirstWrite)
+    {
+        mFirstWrite = std::chrono::steady_clock::now();
+        mHasFirstWrite = true;
+    }
+
+    if (mQueue.size() >= mMaxQueuedImages)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mSlotAvailable.wait(lock, [this] { return mQueue.size() < mMaxQueuedImages; });
+        mStats.blockedSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    mQueue.push_back(Job{path, width, height, fileFormat, exportFlags, resourceFormat, isTopDown, std::move(data)});
+    mWorkAvailable.notify_one();
+}
+
+void AsyncImageWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSlotAvailable.wait(lock, [this] { return mQueue.empty() && mActiveJobs == 0; });
+}
+
+size_t AsyncImageWriter::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mQueue.size() + mActiveJobs;
+}
+
+AsyncImageWriter::Stats AsyncImageWriter::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void AsyncImageWriter::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats = {};
+    mHasFirstWrite = false;
+}
+
+void AsyncImageWriter::runWorker()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkAvailable.wait(lock, [this] { return mTerminate || !mQueue.empty(); });
+            if (mQueue.empty())
+                return;
+            job = std::move(mQueue.front());
+            mQueue.pop_front();
+            mActiveJobs++;
+        }
+        mSlotAvailable.notify_all();
+
+        auto start = std::chrono::steady_clock::now();
+        bool success = true;
+        try
+        {
+            Bitmap::saveImage(
+                job.path, job.width, job.height, job.fileFormat, job.exportFlags, job.resourceFormat, job.isTopDown, job.data.data()
+            );
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to write image '{}': {}", job.path, e.what());
+            success = false;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mActiveJobs--;
+            mStats.encodeSeconds += std::chrono::duration<double>(end - start).count();
+            if (success)
+            {
+                mStats.imagesWritten++;
+                mStats.bytesWritten += job.data.size();
+            }
+            else
+            {
+                mStats.imagesFailed++;
+            }
+            if (mHasFirstWrite)
+                mStats.wallSeconds = std::chrono::duration<double>(end - mFirstWrite).count();
+        }
+        mSlotAvailable.notify_all();
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,146 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Writes images to disk using a fixed pool of worker threads.
+ *
+ * Image data is handed over by value and encoded with Bitmap::saveImage() on one of the workers.
+ * The number of queued images is bounded: write() blocks the caller while the queue is full,
+ * which keeps host memory bounded when images are produced faster than they can be encoded.
+ */
+class FALCOR_API AsyncImageWriter
+{
+public:
+    struct Stats
+    {
+        uint64_t imagesWritten = 0; ///< Number of images written successfully.
+        uint64_t imagesFailed = 0;  ///< Number of images that failed to encode or write.
+        uint64_t bytesWritten = 0;  ///< Number of uncompressed image bytes handed to the encoder.
+        double encodeSeconds = 0.0; ///< Accumulated encode time over all workers.
+        double blockedSeconds = 0.0; ///< Accumulated time write() spent waiting for a free queue slot.
+        double wallSeconds = 0.0;   ///< Time from the first write() to the last completed image.
+
+        /// Throughput in images per second, measured over wall-clock time.
+        double getImagesPerSecond() const { return wallSeconds > 0.0 ? imagesWritten / wallSeconds : 0.0; }
+    };
+
+    /**
+     * Constructor.
+     * @param[in] workerCount Number of worker threads. Must be at least 1.
+     * @param[in] maxQueuedImages Maximum number of images waiting to be encoded. Must be at least 1.
+     */
+    AsyncImageWriter(uint32_t workerCount = 4, size_t maxQueuedImages = 8);
+
+    /**
+     * Destructor.
+     * Blocks until all queued images have been written.
+     */
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    /**
+     * Queue an image for writing. Blocks while the queue is full.
+     * See Bitmap::saveImage() for a description of the parameters.
+     * @param[in] data Image data. The buffer is taken over by the writer.
+     */
+    void write(
+        const std::filesystem::path& path,
+        uint32_t width,
+        uint32_t height,
+        Bitmap::FileFormat fileFormat,
+        Bitmap::ExportFlags exportFlags,
+        ResourceFormat resourceFormat,
+        bool isTopDown,
+        std::vector<uint8_t>&& data
+    );
+
+    /**
+     * Block until all queued images have been written.
+     */
+    void flush();
+
+    /**
+     * Get the number of images queued or currently being encoded.
+     */
+    size_t getPendingCount() const;
+
+    uint32_t getWorkerCount() const { return (uint32_t)mThreads.size(); }
+    size_t getMaxQueuedImages() const { return mMaxQueuedImages; }
+
+    /**
+     * Get the statistics accumulated since construction or the last call to resetStats().
+     */
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct Job
+    {
+        std::filesystem::path path;
+        uint32_t width;
+        uint32_t height;
+        Bitmap::FileFormat fileFormat;
+        Bitmap::ExportFlags exportFlags;
+        ResourceFormat resourceFormat;
+        bool isTopDown;
+        std::vector<uint8_t> data;
+    };
+
+    void runWorker();
+
+    size_t mMaxQueuedImages;
+    std::vector<std::thread> mThreads;
+
+    // Internal state. Do not access outside of critical section.
+    mutable std::mutex mMutex;
+    std::condition_variable mWorkAvailable; ///< Signaled when a job is queued or on termination.
+    std::condition_variable mSlotAvailable; ///< Signaled when a job is dequeued or completes.
+    std::deque<Job> mQueue;
+    size_t mActiveJobs = 0;
+    bool mTerminate = false;
+    Stats mStats;
+    std::chrono::steady_clock::time_point mFirstWrite;
+    bool mHasFirstWrite = false;
+};
+} // namespace Falcor
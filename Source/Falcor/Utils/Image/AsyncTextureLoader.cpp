@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "AsyncTextureLoader.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Threading.h"
 
 namespace Falcor
@@ -34,7 +35,25 @@ namespace Falcor
 namespace
 {
 constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
+
+/// Estimate the memory cost of a request from the size of its source files.
+uint64_t estimateMemoryCost(const std::vector<std::filesystem::path>& paths)
+{
+    uint64_t cost = 0;
+    for (const auto& path : paths)
+    {
+        std::filesystem::path fullPath;
+        std::error_code ec;
+        if (findFileInDataDirectories(path, fullPath))
+        {
+            uintmax_t size = std::filesystem::file_size(fullPath, ec);
+            if (!ec)
+                cost += size;
+        }
+    }
+    return cost;
 }
+} // namespace
 
 AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount) : mpDevice(pDevice)
 {
@@ -48,31 +67,144 @@ AsyncTextureLoader::~AsyncTextureLoader()
     mpDevice->flushAndSync();
 }
 
-std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
+AsyncTextureLoader::Request AsyncTextureLoader::loadMippedFromFiles(
     fstd::span<const std::filesystem::path> paths,
     bool loadAsSrgb,
     Resource::BindFlags bindFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    const LoadOptions& options
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    LoadRequest request;
+    request.paths = {paths.begin(), paths.end()};
+    request.generateMipLevels = false;
+    request.loadAsSRGB = loadAsSrgb;
+    request.bindFlags = bindFlags;
+    request.callback = callback;
+    return enqueue(std::move(request), options);
 }
 
-std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
+AsyncTextureLoader::Request AsyncTextureLoader::loadFromFile(
     const std::filesystem::path& path,
     bool generateMipLevels,
     bool loadAsSrgb,
     Resource::BindFlags bindFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    const LoadOptions& options
 )
 {
+    LoadRequest request;
+    request.paths = {path};
+    request.generateMipLevels = generateMipLevels;
+    request.loadAsSRGB = loadAsSrgb;
+    request.bindFlags = bindFlags;
+    request.callback = callback;
+    return enqueue(std::move(request), options);
+}
+
+bool AsyncTextureLoader::setPriority(RequestID id, float priority)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mLoadRequests.find(id);
+    if (it == mLoadRequests.end() || mLoadRequestQueue.erase(QueueKey{it->second.priority, id}) == 0)
+        return false;
+
+    it->second.priority = priority;
+    mLoadRequestQueue.insert(QueueKey{priority, id});
+    return true;
+}
+
+bool AsyncTextureLoader::cancel(RequestID id)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    auto it = mLoadRequests.find(id);
+    if (it == mLoadRequests.end())
+        return false;
+
+    // Requests in flight are dropped by the worker once loading finishes.
+    if (mLoadRequestQueue.erase(QueueKey{it->second.priority, id}) == 0)
+    {
+        it->second.cancelled = true;
+        return true;
+    }
+
+    LoadRequest request = std::move(it->second);
+    mLoadRequests.erase(it);
+    mStats.cancelledCount++;
+    lock.unlock();
+
+    finishRequest(request, nullptr);
+    mCondition.notify_all();
+    return true;
+}
+
+void AsyncTextureLoader::setMaxInFlightBytes(uint64_t maxBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxInFlightBytes = maxBytes;
+    }
+    mCondition.notify_all();
+}
+
+uint64_t AsyncTextureLoader::getMaxInFlightBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxInFlightBytes;
+}
+
+AsyncTextureLoader::Stats AsyncTextureLoader::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mStats;
+    stats.queuedCount = mLoadRequestQueue.size();
+    return stats;
+}
+
+AsyncTextureLoader::Request AsyncTextureLoader::enqueue(LoadRequest&& request, const LoadOptions& options)
+{
+    request.priority = options.priority;
+    request.memoryCost = options.memoryCost > 0 ? options.memoryCost : estimateMemoryCost(request.paths);
+    request.pCancellationToken = options.pCancellationToken;
+
+    Request result;
+    result.future = request.promise.get_future();
+
     std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, callback});
+    result.id = mNextRequestID++;
+    mLoadRequestQueue.insert(QueueKey{request.priority, result.id});
+    mLoadRequests.emplace(result.id, std::move(request));
     mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    return result;
+}
+
+bool AsyncTextureLoader::canStartNext() const
+{
+    if (mLoadRequestQueue.empty())
+        return false;
+
+    if (mMaxInFlightBytes == 0 || mStats.inFlightCount == 0)
+        return true;
+
+    // Dropping a cancelled request does not need any memory.
+    const LoadRequest& request = mLoadRequests.at(mLoadRequestQueue.begin()->id);
+    if (request.pCancellationToken && request.pCancellationToken->isCancelled())
+        return true;
+
+    return mStats.inFlightBytes + request.memoryCost <= mMaxInFlightBytes;
+}
+
+void AsyncTextureLoader::finishRequest(LoadRequest& request, ref<Texture> pTexture)
+{
+    // Run the callback first so that a ready future implies the callback has returned.
+    if (request.callback)
+    {
+        request.callback(pTexture);
+    }
+
+    request.promise.set_value(pTexture);
 }
 
 void AsyncTextureLoader::runWorkers(size_t threadCount)
@@ -97,7 +229,7 @@ void AsyncTextureLoader::runWorkers(size_t threadCount)
 void AsyncTextureLoader::runWorker()
 {
     // This function is the entry point for worker threads.
-    // The workers wait on the load request queue and load a texture when woken up.
+    // The workers wait on the load request queue and load the texture with the highest priority when woken up.
     // To avoid the upload heap growing too large, we synchronize the threads and
     // issue a global GPU flush at regular intervals.
 
@@ -105,7 +237,7 @@ void AsyncTextureLoader::runWorker()
     {
         // Wait on condition until more work is ready.
         std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
+        mCondition.wait(lock, [&]() { return mFlushPending || canStartNext() || (mTerminate && mLoadRequestQueue.empty()); });
 
         // Sync thread if a flush is pending.
         if (mFlushPending)
@@ -117,20 +249,35 @@ void AsyncTextureLoader::runWorker()
         }
 
         // Terminate thread unless there is more work to do.
-        if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending)
+        if (mTerminate && mLoadRequestQueue.empty())
             break;
 
-        // Go back waiting if queue is currently empty.
-        if (mLoadRequestQueue.empty())
+        // Pop next load request from queue.
+        const RequestID id = mLoadRequestQueue.begin()->id;
+        mLoadRequestQueue.erase(mLoadRequestQueue.begin());
+        LoadRequest& request = mLoadRequests.at(id);
+
+        // Drop the request without loading it if it was cancelled while queued.
+        if (request.pCancellationToken && request.pCancellationToken->isCancelled())
+        {
+            LoadRequest cancelledRequest = std::move(request);
+            mLoadRequests.erase(id);
+            mStats.cancelledCount++;
+            lock.unlock();
+
+            finishRequest(cancelledRequest, nullptr);
+            mCondition.notify_all();
             continue;
+        }
 
-        // Pop next load request from queue.
-        auto request = std::move(mLoadRequestQueue.front());
-        mLoadRequestQueue.pop();
+        mStats.inFlightCount++;
+        mStats.inFlightBytes += request.memoryCost;
+        mStats.peakInFlightBytes = std::max(mStats.peakInFlightBytes, mStats.inFlightBytes);
 
         lock.unlock();
 
         // Load the textures (this part is running in parallel).
+        // Note: The request stays in the map while in flight. Only its cancelled flag is written concurrently.
         ref<Texture> pTexture;
         if (request.paths.size() == 1)
         {
@@ -142,24 +289,39 @@ void AsyncTextureLoader::runWorker()
             pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags);
         }
 
-        request.promise.set_value(pTexture);
-
-        if (request.callback)
-        {
-            request.callback(pTexture);
-        }
-
         lock.lock();
 
+        mStats.inFlightCount--;
+        mStats.inFlightBytes -= request.memoryCost;
+
         // Issue a global flush if necessary.
         // TODO: It would be better to check the size of the upload heap instead.
         if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
         {
             mFlushPending = true;
-            mCondition.notify_all();
         }
 
-        mCondition.notify_one();
+        // Drop the result if the request was cancelled while in flight.
+        const bool cancelled = request.cancelled || (request.pCancellationToken && request.pCancellationToken->isCancelled());
+        if (cancelled)
+        {
+            mStats.cancelledCount++;
+            pTexture = nullptr;
+        }
+        else
+        {
+            mStats.completedCount++;
+        }
+
+        LoadRequest finishedRequest = std::move(request);
+        mLoadRequests.erase(id);
+
+        lock.unlock();
+
+        finishRequest(finishedRequest, pTexture);
+
+        // Wake up all workers as memory became available or a flush is pending.
+        mCondition.notify_all();
     }
 }
 
@@ -30,12 +30,16 @@
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <set>
 #include <thread>
 #include <vector>
 #include <fstd/span.h>
@@ -46,11 +50,70 @@ class Barrier;
 
 /**
  * Utility class to load textures asynchronously using multiple worker threads.
+ *
+ * Requests are served in order of descending priority (requests of equal priority in submission order).
+ * The priority of a queued request can be changed with setPriority().
+ *
+ * Requests can be cancelled individually with cancel() or in groups by sharing a CancellationToken.
+ * Cancelled requests that are still queued are dropped without being loaded. Cancelled requests that are
+ * being loaded are dropped once loading finishes. In both cases the future resolves to nullptr and the
+ * callback is called with nullptr.
+ *
+ * Each request has a memory cost (by default the size of its source files). Workers do not start a request
+ * while this would exceed the in-flight memory limit set with setMaxInFlightBytes(), unless nothing is in flight.
  */
 class FALCOR_API AsyncTextureLoader
 {
 public:
     using LoadCallback = std::function<void(ref<Texture> pTexture)>;
+    using RequestID = uint64_t;
+
+    static constexpr RequestID kInvalidRequestID = 0;
+
+    /**
+     * Token for cancelling a group of load requests.
+     */
+    class CancellationToken
+    {
+    public:
+        void cancel() { mCancelled = true; }
+        bool isCancelled() const { return mCancelled; }
+
+    private:
+        std::atomic<bool> mCancelled{false};
+    };
+
+    /**
+     * Scheduling options of a load request.
+     */
+    struct LoadOptions
+    {
+        float priority = 0.f;    ///< Requests with higher priority are loaded first.
+        uint64_t memoryCost = 0; ///< Memory cost in bytes. If zero, the size of the source files is used.
+        std::shared_ptr<CancellationToken> pCancellationToken; ///< Optional token for cancelling the request.
+
+        // Note: User-provided constructor to allow use as default argument within the enclosing class.
+        LoadOptions() {}
+    };
+
+    /**
+     * Handle to an issued load request.
+     */
+    struct Request
+    {
+        RequestID id = kInvalidRequestID;
+        std::future<ref<Texture>> future; ///< Future to the loaded texture. Ready after the callback has returned.
+    };
+
+    struct Stats
+    {
+        uint64_t completedCount = 0;    ///< Number of requests that finished loading (including failed loads).
+        uint64_t cancelledCount = 0;    ///< Number of requests that were cancelled.
+        size_t queuedCount = 0;         ///< Number of requests waiting in the queue.
+        size_t inFlightCount = 0;       ///< Number of requests currently being loaded.
+        uint64_t inFlightBytes = 0;     ///< Memory cost of the requests currently being loaded.
+        uint64_t peakInFlightBytes = 0; ///< Peak memory cost of the requests being loaded at the same time.
+    };
 
     /**
      * Constructor.
@@ -70,13 +133,15 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] options Scheduling options.
+     * @return The request handle.
      */
-    std::future<ref<Texture>> loadMippedFromFiles(
+    Request loadMippedFromFiles(
         fstd::span<const std::filesystem::path> paths,
         bool loadAsSRGB,
         Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        const LoadOptions& options = {}
     );
 
     /**
@@ -86,16 +151,43 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] options Scheduling options.
+     * @return The request handle.
      */
-    std::future<ref<Texture>> loadFromFile(
+    Request loadFromFile(
         const std::filesystem::path& path,
         bool generateMipLevels,
         bool loadAsSRGB,
         Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        const LoadOptions& options = {}
     );
 
+    /**
+     * Change the priority of a queued request.
+     * @param[in] id Request ID.
+     * @param[in] priority New priority.
+     * @return True if the request is still queued.
+     */
+    bool setPriority(RequestID id, float priority);
+
+    /**
+     * Cancel a request.
+     * If the request is still queued, its future and callback are resolved on the calling thread.
+     * @param[in] id Request ID.
+     * @return True if the request was queued or in flight.
+     */
+    bool cancel(RequestID id);
+
+    /**
+     * Set the maximum memory cost of the requests being loaded at the same time.
+     * @param[in] maxBytes Maximum number of bytes, or zero for no limit.
+     */
+    void setMaxInFlightBytes(uint64_t maxBytes);
+    uint64_t getMaxInFlightBytes() const;
+
+    Stats getStats() const;
+
 private:
     void runWorkers(size_t threadCount);
     void runWorker();
@@ -109,17 +201,38 @@ private:
         Resource::BindFlags bindFlags;
         LoadCallback callback;
         std::promise<ref<Texture>> promise;
+        float priority;
+        uint64_t memoryCost;
+        std::shared_ptr<CancellationToken> pCancellationToken;
+        bool cancelled = false; ///< Set by cancel() while the request is in flight.
     };
 
+    /// Queue ordering: higher priority first, then lower request ID.
+    struct QueueKey
+    {
+        float priority;
+        RequestID id;
+
+        bool operator<(const QueueKey& other) const { return priority != other.priority ? priority > other.priority : id < other.id; }
+    };
+
+    Request enqueue(LoadRequest&& request, const LoadOptions& options);
+    bool canStartNext() const;
+    static void finishRequest(LoadRequest& request, ref<Texture> pTexture);
+
     ref<Device> mpDevice;
 
-    std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
+    mutable std::mutex mMutex;              ///< Mutex for synchronizing access to shared resources.
     std::condition_variable mCondition;     ///< Condition variable for workers to wait on.
     std::shared_ptr<Barrier> mFlushBarrier; ///< Barrier for flushing the GPU to upload textures.
     std::vector<std::thread> mThreads;      ///< Worker threads.
 
     // Internal state. Do not access outside of critical section.
-    std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
+    std::map<RequestID, LoadRequest> mLoadRequests;   ///< Queued and in-flight load requests.
+    std::set<QueueKey> mLoadRequestQueue;             ///< Texture loading request queue, ordered by priority.
+    RequestID mNextRequestID = kInvalidRequestID + 1; ///< ID of the next load request.
+    uint64_t mMaxInFlightBytes = 0;                   ///< Maximum memory cost of in-flight requests (0 = unlimited).
+    Stats mStats;                                     ///< Request statistics.
 
     bool mTerminate = false;     ///< Flag to terminate worker threads.
     bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
@@ -0,0 +1,730 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ConvolutionInference.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/CpuFeatures.h"
+#include "Utils/NumericRange.h"
+#include "Utils/NumpyArray.h"
+#include "Utils/StringFormatters.h"
+#include "Utils/Math/Float16.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONVOLUTION_INFERENCE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define CONVOLUTION_INFERENCE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CONVOLUTION_INFERENCE_AVX2 1
+#include <immintrin.h>
+#if FALCOR_MSVC
+#define CONVOLUTION_INFERENCE_TARGET_AVX2
+#else
+#define CONVOLUTION_INFERENCE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kVectorWidth = 4;
+
+// Minimal 4-wide float vector abstraction. All variants compute a * b + c as a separate multiply and add,
+// so the results are identical on all platforms.
+#if CONVOLUTION_INFERENCE_SSE2
+using Vec = __m128;
+inline Vec load(const float* p)
+{
+    return _mm_loadu_ps(p);
+}
+inline void store(float* p, Vec v)
+{
+    _mm_storeu_ps(p, v);
+}
+inline Vec broadcast(float v)
+{
+    return _mm_set1_ps(v);
+}
+inline Vec multiplyAdd(Vec a, Vec b, Vec c)
+{
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+#elif CONVOLUTION_INFERENCE_NEON
+using Vec = float32x4_t;
+inline Vec load(const float* p)
+{
+    return vld1q_f32(p);
+}
+inline void store(float* p, Vec v)
+{
+    vst1q_f32(p, v);
+}
+inline Vec broadcast(float v)
+{
+    return vdupq_n_f32(v);
+}
+inline Vec multiplyAdd(Vec a, Vec b, Vec c)
+{
+    return vaddq_f32(vmulq_f32(a, b), c);
+}
+#else
+struct Vec
+{
+    float v[kVectorWidth];
+};
+inline Vec load(const float* p)
+{
+    return Vec{{p[0], p[1], p[2], p[3]}};
+}
+inline void store(float* p, Vec v)
+{
+    std::copy(v.v, v.v + kVectorWidth, p);
+}
+inline Vec broadcast(float v)
+{
+    return Vec{{v, v, v, v}};
+}
+inline Vec multiplyAdd(Vec a, Vec b, Vec c)
+{
+    for (uint32_t i = 0; i < kVectorWidth; ++i)
+        c.v[i] = a.v[i] * b.v[i] + c.v[i];
+    return c;
+}
+#endif
+
+/// Number of output channel vectors accumulated in registers by the direct kernel.
+const uint32_t kDirectBlockVectors = 8;
+/// Number of pixels and output channel vectors accumulated in registers by the GEMM kernel.
+const uint32_t kGemmBlockPixels = 4;
+const uint32_t kGemmBlockVectors = 2;
+
+/**
+ * Direct convolution of one pixel for N output channel vectors starting at channel c0.
+ */
+template<uint32_t N>
+void directKernel(
+    const ConvolutionInference::Layer& layer,
+    const float* pWeights,
+    const float* pBias,
+    uint32_t paddedChannelsOut,
+    const ConvolutionInference::Tensor& input,
+    int x,
+    int y,
+    uint32_t c0,
+    float* pDst
+)
+{
+    Vec acc[N];
+    for (uint32_t i = 0; i < N; ++i)
+        acc[i] = load(pBias + c0 + i * kVectorWidth);
+
+    const int halfWidth = int(layer.kernelWidth / 2);
+    const int halfHeight = int(layer.kernelHeight / 2);
+    for (uint32_t ky = 0; ky < layer.kernelHeight; ++ky)
+    {
+        const int iy = y + int(ky) - halfHeight;
+        if (iy < 0 || iy >= int(input.height))
+            continue;
+        for (uint32_t kx = 0; kx < layer.kernelWidth; ++kx)
+        {
+            const int ix = x + int(kx) - halfWidth;
+            if (ix < 0 || ix >= int(input.width))
+                continue;
+
+            const float* pIn = input.data.data() + ((size_t)iy * input.width + ix) * input.channels;
+            const float* pW = pWeights + (size_t)(ky * layer.kernelWidth + kx) * layer.channelsIn * paddedChannelsOut + c0;
+            for (uint32_t ci = 0; ci < layer.channelsIn; ++ci)
+            {
+                const Vec v = broadcast(pIn[ci]);
+                for (uint32_t i = 0; i < N; ++i)
+                    acc[i] = multiplyAdd(v, load(pW + i * kVectorWidth), acc[i]);
+                pW += paddedChannelsOut;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < N; ++i)
+        store(pDst + c0 + i * kVectorWidth, acc[i]);
+}
+
+/**
+ * GEMM micro kernel computing M pixels times N output channel vectors starting at channel c0.
+ * The columns hold K values per pixel, the weights K rows of paddedChannelsOut values.
+ */
+template<uint32_t M, uint32_t N>
+void gemmKernel(const float* pColumns, uint32_t K, const float* pWeights, const float* pBias, uint32_t paddedChannelsOut, uint32_t c0, float* pDst)
+{
+    Vec acc[M][N];
+    for (uint32_t m = 0; m < M; ++m)
+        for (uint32_t i = 0; i < N; ++i)
+            acc[m][i] = load(pBias + c0 + i * kVectorWidth);
+
+    const float* pW = pWeights + c0;
+    for (uint32_t k = 0; k < K; ++k)
+    {
+        Vec w[N];
+        for (uint32_t i = 0; i < N; ++i)
+            w[i] = load(pW + i * kVectorWidth);
+        for (uint32_t m = 0; m < M; ++m)
+        {
+            const Vec v = broadcast(pColumns[m * K + k]);
+            for (uint32_t i = 0; i < N; ++i)
+                acc[m][i] = multiplyAdd(v, w[i], acc[m][i]);
+        }
+        pW += paddedChannelsOut;
+    }
+
+    for (uint32_t m = 0; m < M; ++m)
+        for (uint32_t i = 0; i < N; ++i)
+            store(pDst + m * paddedChannelsOut + c0 + i * kVectorWidth, acc[m][i]);
+}
+
+/**
+ * Direct convolution of all output channels of one pixel.
+ */
+void directPixelDefault(
+    const ConvolutionInference::Layer& layer,
+    const float* pWeights,
+    const float* pBias,
+    uint32_t paddedChannelsOut,
+    const ConvolutionInference::Tensor& input,
+    int x,
+    int y,
+    float* pDst
+)
+{
+    const uint32_t vectorCount = paddedChannelsOut / kVectorWidth;
+    uint32_t v = 0;
+    for (; v + kDirectBlockVectors <= vectorCount; v += kDirectBlockVectors)
+        directKernel<kDirectBlockVectors>(layer, pWeights, pBias, paddedChannelsOut, input, x, y, v * kVectorWidth, pDst);
+
+    // Dispatch the remaining output channel vectors to a kernel of matching size.
+    const uint32_t c0 = v * kVectorWidth;
+    switch (vectorCount - v)
+    {
+#define CASE(n) \
+    case n:     \
+        directKernel<n>(layer, pWeights, pBias, paddedChannelsOut, input, x, y, c0, pDst); \
+        break;
+        CASE(1)
+        CASE(2)
+        CASE(3)
+        CASE(4)
+        CASE(5)
+        CASE(6)
+        CASE(7)
+#undef CASE
+    default:
+        break;
+    }
+}
+
+/**
+ * GEMM of M pixels with all output channels.
+ */
+template<uint32_t M>
+void gemmBlock(const float* pColumns, uint32_t K, const float* pWeights, const float* pBias, uint32_t paddedChannelsOut, float* pDst)
+{
+    uint32_t c0 = 0;
+    for (; c0 + kGemmBlockVectors * kVectorWidth <= paddedChannelsOut; c0 += kGemmBlockVectors * kVectorWidth)
+        gemmKernel<M, kGemmBlockVectors>(pColumns, K, pWeights, pBias, paddedChannelsOut, c0, pDst);
+    for (; c0 < paddedChannelsOut; c0 += kVectorWidth)
+        gemmKernel<M, 1>(pColumns, K, pWeights, pBias, paddedChannelsOut, c0, pDst);
+}
+
+#if CONVOLUTION_INFERENCE_AVX2
+// 8-wide variants of the kernels above. They also use a separate multiply and add and accumulate in the same order,
+// so the results match the 4-wide kernels exactly. The output channels are padded to a multiple of 4 only,
+// a remaining 4-wide vector is handled by the 4-wide kernels.
+const uint32_t kVectorWidthAVX2 = 8;
+
+template<uint32_t N>
+CONVOLUTION_INFERENCE_TARGET_AVX2 void directKernelAVX2(
+    const ConvolutionInference::Layer& layer,
+    const float* pWeights,
+    const float* pBias,
+    uint32_t paddedChannelsOut,
+    const ConvolutionInference::Tensor& input,
+    int x,
+    int y,
+    uint32_t c0,
+    float* pDst
+)
+{
+    __m256 acc[N];
+    for (uint32_t i = 0; i < N; ++i)
+        acc[i] = _mm256_loadu_ps(pBias + c0 + i * kVectorWidthAVX2);
+
+    const int halfWidth = int(layer.kernelWidth / 2);
+    const int halfHeight = int(layer.kernelHeight / 2);
+    for (uint32_t ky = 0; ky < layer.kernelHeight; ++ky)
+    {
+        const int iy = y + int(ky) - halfHeight;
+        if (iy < 0 || iy >= int(input.height))
+            continue;
+        for (uint32_t kx = 0; kx < layer.kernelWidth; ++kx)
+        {
+            const int ix = x + int(kx) - halfWidth;
+            if (ix < 0 || ix >= int(input.width))
+                continue;
+
+            const float* pIn = input.data.data() + ((size_t)iy * input.width + ix) * input.channels;
+            const float* pW = pWeights + (size_t)(ky * layer.kernelWidth + kx) * layer.channelsIn * paddedChannelsOut + c0;
+            for (uint32_t ci = 0; ci < layer.channelsIn; ++ci)
+            {
+                const __m256 v = _mm256_set1_ps(pIn[ci]);
+                for (uint32_t i = 0; i < N; ++i)
+                    acc[i] = _mm256_add_ps(_mm256_mul_ps(v, _mm256_loadu_ps(pW + i * kVectorWidthAVX2)), acc[i]);
+                pW += paddedChannelsOut;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < N; ++i)
+        _mm256_storeu_ps(pDst + c0 + i * kVectorWidthAVX2, acc[i]);
+}
+
+template<uint32_t M, uint32_t N>
+CONVOLUTION_INFERENCE_TARGET_AVX2 void gemmKernelAVX2(
+    const float* pColumns,
+    uint32_t K,
+    const float* pWeights,
+    const float* pBias,
+    uint32_t paddedChannelsOut,
+    uint32_t c0,
+    float* pDst
+)
+{
+    __m256 acc[M][N];
+    for (uint32_t m = 0; m < M; ++m)
+        for (uint32_t i = 0; i < N; ++i)
+            acc[m][i] = _mm256_loadu_ps(pBias + c0 + i * kVectorWidthAVX2);
+
+    const float* pW = pWeights + c0;
+    for (uint32_t k = 0; k < K; ++k)
+    {
+        __m256 w[N];
+        for (uint32_t i = 0; i < N; ++i)
+            w[i] = _mm256_loadu_ps(pW + i * kVectorWidthAVX2);
+        for (uint32_t m = 0; m < M; ++m)
+        {
+            const __m256 v = _mm256_set1_ps(pColumns[m * K + k]);
+            for (uint32_t i = 0; i < N; ++i)
+                acc[m][i] = _mm256_add_ps(_mm256_mul_ps(v, w[i]), acc[m][i]);
+        }
+        pW += paddedChannelsOut;
+    }
+
+    for (uint32_t m = 0; m < M; ++m)
+        for (uint32_t i = 0; i < N; ++i)
+            _mm256_storeu_ps(pDst + m * paddedChannelsOut + c0 + i * kVectorWidthAVX2, acc[m][i]);
+}
+
+CONVOLUTION_INFERENCE_TARGET_AVX2 void directPixelAVX2(
+    const ConvolutionInference::Layer& layer,
+    const float* pWeights,
+    const float* pBias,
+    uint32_t paddedChannelsOut,
+    const ConvolutionInference::Tensor& input,
+    int x,
+    int y,
+    float* pDst
+)
+{
+    const uint32_t vectorCount = paddedChannelsOut / kVectorWidthAVX2;
+    uint32_t v = 0;
+    for (; v + kDirectBlockVectors <= vectorCount; v += kDirectBlockVectors)
+        directKernelAVX2<kDirectBlockVectors>(layer, pWeights, pBias, paddedChannelsOut, input, x, y, v * kVectorWidthAVX2, pDst);
+
+    const uint32_t c0 = v * kVectorWidthAVX2;
+    switch (vectorCount - v)
+    {
+#define CASE(n) \
+    case n:     \
+        directKernelAVX2<n>(layer, pWeights, pBias, paddedChannelsOut, input, x, y, c0, pDst); \
+        break;
+        CASE(1)
+        CASE(2)
+        CASE(3)
+        CASE(4)
+        CASE(5)
+        CASE(6)
+        CASE(7)
+#undef CASE
+    default:
+        break;
+    }
+
+    if (paddedChannelsOut % kVectorWidthAVX2 != 0)
+        directKernel<1>(layer, pWeights, pBias, paddedChannelsOut, input, x, y, paddedChannelsOut - kVectorWidth, pDst);
+}
+
+template<uint32_t M>
+CONVOLUTION_INFERENCE_TARGET_AVX2 void gemmBlockAVX2(
+    const float* pColumns,
+    uint32_t K,
+    const float* pWeights,
+    const float* pBias,
+    uint32_t paddedChannelsOut,
+    float* pDst
+)
+{
+    uint32_t c0 = 0;
+    for (; c0 + kGemmBlockVectors * kVectorWidthAVX2 <= paddedChannelsOut; c0 += kGemmBlockVectors * kVectorWidthAVX2)
+        gemmKernelAVX2<M, kGemmBlockVectors>(pColumns, K, pWeights, pBias, paddedChannelsOut, c0, pDst);
+    for (; c0 + kVectorWidthAVX2 <= paddedChannelsOut; c0 += kVectorWidthAVX2)
+        gemmKernelAVX2<M, 1>(pColumns, K, pWeights, pBias, paddedChannelsOut, c0, pDst);
+    if (c0 < paddedChannelsOut)
+        gemmKernel<M, 1>(pColumns, K, pWeights, pBias, paddedChannelsOut, c0, pDst);
+}
+#endif
+
+/**
+ * Convolution kernels, selected at runtime.
+ * The direct and GEMM kernels are always selected together so that both algorithms produce identical results.
+ */
+struct Kernels
+{
+    void (*directPixel)(
+        const ConvolutionInference::Layer& layer,
+        const float* pWeights,
+        const float* pBias,
+        uint32_t paddedChannelsOut,
+        const ConvolutionInference::Tensor& input,
+        int x,
+        int y,
+        float* pDst
+    ) = directPixelDefault;
+    void (*gemmBlockPixels)(const float* pColumns, uint32_t K, const float* pWeights, const float* pBias, uint32_t paddedChannelsOut, float* pDst) =
+        gemmBlock<kGemmBlockPixels>;
+    void (*gemmSinglePixel)(const float* pColumns, uint32_t K, const float* pWeights, const float* pBias, uint32_t paddedChannelsOut, float* pDst) =
+        gemmBlock<1>;
+};
+
+const Kernels& getKernels()
+{
+    static const Kernels kernels = []()
+    {
+        Kernels k;
+#if CONVOLUTION_INFERENCE_AVX2
+        if (getCpuFeatures().avx2)
+        {
+            k.directPixel = directPixelAVX2;
+            k.gemmBlockPixels = gemmBlockAVX2<kGemmBlockPixels>;
+            k.gemmSinglePixel = gemmBlockAVX2<1>;
+        }
+#endif
+        return k;
+    }();
+    return kernels;
+}
+
+uint32_t getPaddedChannelCount(uint32_t channels)
+{
+    return (channels + kVectorWidth - 1) / kVectorWidth * kVectorWidth;
+}
+} // namespace
+
+ConvolutionInference::Tensor ConvolutionInference::Tensor::loadNpy(const std::filesystem::path& path, uint32_t slice)
+{
+    // The file is memory mapped, only the requested slice is read.
+    NumpyArray array = NumpyArray::load(path).toCOrder();
+    if (array.getDType() != NumpyDType::Float32)
+        throw RuntimeError("Tensor file '{}' has element type '{}', expected float32.", path, getNumpyDTypeDescr(array.getDType()));
+
+    std::vector<size_t> shape = array.getShape();
+    if (shape.size() == 2)
+        shape.push_back(1);
+    if (shape.size() == 3)
+        shape.insert(shape.begin(), 1);
+    if (shape.size() != 4 || slice >= shape[0])
+        throw RuntimeError("Tensor file '{}' has an unsupported shape or does not contain slice {}.", path, slice);
+
+    Tensor tensor((uint32_t)shape[2], (uint32_t)shape[1], (uint32_t)shape[3]);
+    const float* pFirst = array.data<float>() + slice * tensor.data.size();
+    std::copy(pFirst, pFirst + tensor.data.size(), tensor.data.begin());
+    return tensor;
+}
+
+void ConvolutionInference::Tensor::saveNpy(const std::filesystem::path& path) const
+{
+    NumpyArray::fromData(data.data(), {height, width, channels}).save(path);
+}
+
+ConvolutionInference::Tensor ConvolutionInference::Tensor::concatChannels(const std::vector<Tensor>& tensors)
+{
+    checkArgument(!tensors.empty(), "'tensors' must not be empty.");
+    uint32_t channels = 0;
+    for (const auto& tensor : tensors)
+    {
+        checkArgument(
+            tensor.width == tensors[0].width && tensor.height == tensors[0].height, "All tensors must have the same dimensions."
+        );
+        channels += tensor.channels;
+    }
+
+    Tensor result(tensors[0].width, tensors[0].height, channels);
+    const size_t pixelCount = (size_t)result.width * result.height;
+    for (size_t p = 0; p < pixelCount; ++p)
+    {
+        float* pDst = result.data.data() + p * channels;
+        for (const auto& tensor : tensors)
+            pDst = std::copy_n(tensor.data.data() + p * tensor.channels, tensor.channels, pDst);
+    }
+    return result;
+}
+
+ConvolutionInference::ConvolutionInference(std::vector<Layer> layers) : mLayers(std::move(layers))
+{
+    checkArgument(!mLayers.empty(), "'layers' must not be empty.");
+
+    for (size_t l = 0; l < mLayers.size(); ++l)
+    {
+        const Layer& layer = mLayers[l];
+        checkArgument(
+            layer.kernelWidth > 0 && layer.kernelHeight > 0 && layer.channelsIn > 0 && layer.channelsOut > 0,
+            "Layer {} has an empty dimension.",
+            l
+        );
+        checkArgument(
+            layer.weights.size() == (size_t)layer.kernelWidth * layer.kernelHeight * layer.channelsIn * layer.channelsOut,
+            "Layer {} has {} weights, expected {}.",
+            l,
+            layer.weights.size(),
+            (size_t)layer.kernelWidth * layer.kernelHeight * layer.channelsIn * layer.channelsOut
+        );
+        checkArgument(layer.bias.size() == layer.channelsOut, "Layer {} has {} biases, expected {}.", l, layer.bias.size(), layer.channelsOut);
+        checkArgument(
+            l == 0 || layer.channelsIn == mLayers[l - 1].channelsOut,
+            "Layer {} expects {} input channels, but the previous layer has {} outputs.",
+            l,
+            layer.channelsIn,
+            mLayers[l - 1].channelsOut
+        );
+
+        PackedLayer packed;
+        packed.paddedChannelsOut = getPaddedChannelCount(layer.channelsOut);
+        const size_t rows = (size_t)layer.kernelWidth * layer.kernelHeight * layer.channelsIn;
+        packed.weights.resize(rows * packed.paddedChannelsOut, 0.f);
+        for (size_t row = 0; row < rows; ++row)
+            std::copy_n(layer.weights.data() + row * layer.channelsOut, layer.channelsOut, packed.weights.data() + row * packed.paddedChannelsOut);
+        packed.bias.resize(packed.paddedChannelsOut, 0.f);
+        std::copy(layer.bias.begin(), layer.bias.end(), packed.bias.begin());
+        mPackedLayers.push_back(std::move(packed));
+    }
+}
+
+ConvolutionInference::Tensor ConvolutionInference::run(
+    const Tensor& input,
+    Precision precision,
+    Algorithm algorithm,
+    const Tensor* pClampMin,
+    const Tensor* pClampMax
+) const
+{
+    Tensor current = runLayer(0, input, algorithm, pClampMin, pClampMax);
+    for (uint32_t l = 1; l < mLayers.size(); ++l)
+    {
+        // Intermediate outputs are stored in textures of the requested precision, the final output is always float.
+        quantize(current, precision);
+        current = runLayer(l, current, algorithm, pClampMin, pClampMax);
+    }
+    return current;
+}
+
+ConvolutionInference::Tensor ConvolutionInference::runLayer(
+    uint32_t layerIndex,
+    const Tensor& input,
+    Algorithm algorithm,
+    const Tensor* pClampMin,
+    const Tensor* pClampMax
+) const
+{
+    checkArgument(layerIndex < mLayers.size(), "'layer' ({}) is out of range.", layerIndex);
+    const Layer& layer = mLayers[layerIndex];
+    const PackedLayer& packed = mPackedLayers[layerIndex];
+    checkArgument(input.channels == layer.channelsIn, "Input has {} channels, layer {} expects {}.", input.channels, layerIndex, layer.channelsIn);
+    checkArgument(input.data.size() == (size_t)input.width * input.height * input.channels, "Input data size does not match its dimensions.");
+    if (layer.activation == Activation::Clamp)
+    {
+        for (const Tensor* pBound : {pClampMin, pClampMax})
+        {
+            checkArgument(
+                pBound && pBound->width == input.width && pBound->height == input.height && pBound->channels == 1,
+                "Layer {} uses the clamp activation and requires single channel clamp images matching the input.",
+                layerIndex
+            );
+        }
+    }
+
+    // Unfolding the patches pays off once there are enough output channels to amortize it.
+    if (algorithm == Algorithm::Auto)
+        algorithm = layer.channelsOut >= 8 ? Algorithm::Im2ColGemm : Algorithm::Direct;
+
+    Tensor output(input.width, input.height, layer.channelsOut);
+    auto rows = NumericRange<uint32_t>(0, input.height);
+    std::for_each(
+        std::execution::par,
+        rows.begin(),
+        rows.end(),
+        [&](uint32_t y)
+        {
+            std::vector<float> accumulators((size_t)input.width * packed.paddedChannelsOut);
+            if (algorithm == Algorithm::Direct)
+            {
+                convolveDirect(layerIndex, input, y, accumulators.data());
+            }
+            else
+            {
+                std::vector<float> columns;
+                convolveIm2ColGemm(layerIndex, input, y, columns, accumulators.data());
+            }
+
+            for (uint32_t x = 0; x < input.width; ++x)
+            {
+                const float* pAcc = accumulators.data() + (size_t)x * packed.paddedChannelsOut;
+                float* pDst = &output.at(x, y, 0);
+                for (uint32_t c = 0; c < layer.channelsOut; ++c)
+                {
+                    float value = pAcc[c];
+                    switch (layer.activation)
+                    {
+                    case Activation::ReLU:
+                        value = std::max(value, 0.f);
+                        break;
+                    case Activation::Clamp:
+                        value = std::clamp(value, pClampMin->at(x, y, 0), pClampMax->at(x, y, 0));
+                        break;
+                    default:
+                        break;
+                    }
+                    pDst[c] = value;
+                }
+            }
+        }
+    );
+
+    return output;
+}
+
+void ConvolutionInference::quantize(Tensor& tensor, Precision precision)
+{
+    switch (precision)
+    {
+    case Precision::Float:
+        break;
+    case Precision::Half:
+        std::for_each(
+            std::execution::par_unseq,
+            tensor.data.begin(),
+            tensor.data.end(),
+            [](float& v) { v = math::float16ToFloat32(math::float32ToFloat16(v)); }
+        );
+        break;
+    case Precision::UNorm:
+        std::for_each(
+            std::execution::par_unseq,
+            tensor.data.begin(),
+            tensor.data.end(),
+            [](float& v) { v = std::round(std::clamp(v, 0.f, 1.f) * 255.f) / 255.f; }
+        );
+        break;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+}
+
+void ConvolutionInference::convolveDirect(uint32_t layerIndex, const Tensor& input, uint32_t y, float* pAccumulators) const
+{
+    const Layer& layer = mLayers[layerIndex];
+    const PackedLayer& packed = mPackedLayers[layerIndex];
+    const Kernels& kernels = getKernels();
+
+    for (uint32_t x = 0; x < input.width; ++x)
+    {
+        kernels.directPixel(
+            layer, packed.weights.data(), packed.bias.data(), packed.paddedChannelsOut, input, x, y,
+            pAccumulators + (size_t)x * packed.paddedChannelsOut
+        );
+    }
+}
+
+void ConvolutionInference::convolveIm2ColGemm(uint32_t layerIndex, const Tensor& input, uint32_t y, std::vector<float>& columns, float* pAccumulators)
+    const
+{
+    const Layer& layer = mLayers[layerIndex];
+    const PackedLayer& packed = mPackedLayers[layerIndex];
+    const uint32_t K = layer.kernelWidth * layer.kernelHeight * layer.channelsIn;
+
+    // Unfold the patches of the row into a [width][K] matrix, with zeros outside of the image.
+    columns.assign((size_t)input.width * K, 0.f);
+    const int halfWidth = int(layer.kernelWidth / 2);
+    const int halfHeight = int(layer.kernelHeight / 2);
+    for (uint32_t ky = 0; ky < layer.kernelHeight; ++ky)
+    {
+        const int iy = int(y) + int(ky) - halfHeight;
+        if (iy < 0 || iy >= int(input.height))
+            continue;
+        for (uint32_t kx = 0; kx < layer.kernelWidth; ++kx)
+        {
+            const uint32_t xBegin = (uint32_t)std::max(halfWidth - int(kx), 0);
+            const uint32_t xEnd = (uint32_t)std::clamp(int(input.width) + halfWidth - int(kx), 0, int(input.width));
+            for (uint32_t x = xBegin; x < xEnd; ++x)
+            {
+                const int ix = int(x) + int(kx) - halfWidth;
+                const float* pIn = input.data.data() + ((size_t)iy * input.width + ix) * input.channels;
+                std::copy_n(pIn, layer.channelsIn, columns.data() + (size_t)x * K + (ky * layer.kernelWidth + kx) * layer.channelsIn);
+            }
+        }
+    }
+
+    const Kernels& kernels = getKernels();
+    uint32_t x = 0;
+    for (; x + kGemmBlockPixels <= input.width; x += kGemmBlockPixels)
+    {
+        kernels.gemmBlockPixels(
+            columns.data() + (size_t)x * K, K, packed.weights.data(), packed.bias.data(), packed.paddedChannelsOut,
+            pAccumulators + (size_t)x * packed.paddedChannelsOut
+        );
+    }
+    for (; x < input.width; ++x)
+    {
+        kernels.gemmSinglePixel(
+            columns.data() + (size_t)x * K, K, packed.weights.data(), packed.bias.data(), packed.paddedChannelsOut,
+            pAccumulators + (size_t)x * packed.paddedChannelsOut
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,180 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU inference for stacks of 2D convolution layers.
+ *
+ * This is a reference implementation of the networks evaluated by the ConvolutionalNet render pass.
+ * Each layer computes out[y][x][co] = activation(bias[co] + sum over ky, kx, ci of in[y + ky - kh/2][x + kx - kw/2][ci] * w[ky][kx][ci][co]),
+ * with zero padding outside the image, which matches out-of-bounds texture loads in the generated shaders.
+ * The outputs of all layers except the last one can be quantized to the precision of the intermediate textures.
+ *
+ * Two algorithms are provided, both vectorized with SSE2 or NEON where available, and with AVX2 when the CPU supports it at runtime:
+ * - Direct: accumulates all output channels of a pixel at once, broadcasting one input value at a time.
+ * - Im2ColGemm: unfolds the input patches of an image row into a matrix and multiplies it with the weights using a register-blocked kernel.
+ */
+class FALCOR_API ConvolutionInference
+{
+public:
+    enum class Activation
+    {
+        None,
+        ReLU,
+        Clamp, ///< Clamp to the per-pixel range given by the clampMin and clampMax images.
+    };
+
+    /// Storage precision of intermediate layer outputs, matching the texture formats used by the render pass.
+    enum class Precision
+    {
+        Float, ///< 32-bit float.
+        Half,  ///< 16-bit float.
+        UNorm, ///< 8-bit unorm, values are clamped to [0, 1].
+    };
+
+    enum class Algorithm
+    {
+        Auto,
+        Direct,
+        Im2ColGemm,
+    };
+
+    /// Image with interleaved channels, stored as [y][x][channel].
+    struct FALCOR_API Tensor
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t channels = 0;
+        std::vector<float> data;
+
+        Tensor() = default;
+        Tensor(uint32_t width, uint32_t height, uint32_t channels) : width(width), height(height), channels(channels), data((size_t)width * height * channels) {}
+
+        float& at(uint32_t x, uint32_t y, uint32_t c) { return data[((size_t)y * width + x) * channels + c]; }
+        float at(uint32_t x, uint32_t y, uint32_t c) const { return data[((size_t)y * width + x) * channels + c]; }
+
+        /**
+         * Load a float32 numpy file with shape [height, width], [height, width, channels] or [slices, height, width, channels].
+         * The latter is the layout written by Texture::captureToFile() for (array) textures.
+         * Throws if the file cannot be loaded.
+         * @param[in] path File path.
+         * @param[in] slice Slice to load from 4D arrays.
+         */
+        static Tensor loadNpy(const std::filesystem::path& path, uint32_t slice = 0);
+
+        /**
+         * Save as a float32 numpy file with shape [height, width, channels].
+         */
+        void saveNpy(const std::filesystem::path& path) const;
+
+        /**
+         * Concatenate the channels of images with the same dimensions.
+         */
+        static Tensor concatChannels(const std::vector<Tensor>& tensors);
+    };
+
+    struct Layer
+    {
+        uint32_t kernelWidth = 1;
+        uint32_t kernelHeight = 1;
+        uint32_t channelsIn = 0;
+        uint32_t channelsOut = 0;
+        std::vector<float> weights; ///< Weights stored as [ky][kx][channelIn][channelOut].
+        std::vector<float> bias;    ///< Bias per output channel.
+        Activation activation = Activation::ReLU;
+    };
+
+    /**
+     * Create an inference engine. Throws if the layers are inconsistent.
+     * @param[in] layers Layers, the input channel count of each layer must match the output channel count of the previous one.
+     */
+    ConvolutionInference(std::vector<Layer> layers);
+
+    const std::vector<Layer>& getLayers() const { return mLayers; }
+
+    /**
+     * Run all layers.
+     * @param[in] input Input image with the channel count of the first layer.
+     * @param[in] precision Storage precision of intermediate layer outputs.
+     * @param[in] algorithm Convolution algorithm.
+     * @param[in] pClampMin Single channel image with the lower bound for the clamp activation, or nullptr if no layer uses it.
+     * @param[in] pClampMax Single channel image with the upper bound for the clamp activation, or nullptr if no layer uses it.
+     * @return Output of the last layer.
+     */
+    Tensor run(
+        const Tensor& input,
+        Precision precision = Precision::Float,
+        Algorithm algorithm = Algorithm::Auto,
+        const Tensor* pClampMin = nullptr,
+        const Tensor* pClampMax = nullptr
+    ) const;
+
+    /**
+     * Run a single layer.
+     * @param[in] layer Layer index.
+     * @param[in] input Input image with the channel count of the layer.
+     * @param[in] algorithm Convolution algorithm.
+     * @param[in] pClampMin Lower bound for the clamp activation, see run().
+     * @param[in] pClampMax Upper bound for the clamp activation, see run().
+     * @return Layer output in full precision.
+     */
+    Tensor runLayer(
+        uint32_t layer,
+        const Tensor& input,
+        Algorithm algorithm = Algorithm::Auto,
+        const Tensor* pClampMin = nullptr,
+        const Tensor* pClampMax = nullptr
+    ) const;
+
+    /**
+     * Round values to a storage precision in place.
+     */
+    static void quantize(Tensor& tensor, Precision precision);
+
+private:
+    /// Layer weights repacked as [ky][kx][channelIn][paddedChannelsOut], with the output channels padded to the SIMD width.
+    struct PackedLayer
+    {
+        uint32_t paddedChannelsOut = 0;
+        std::vector<float> weights;
+        std::vector<float> bias;
+    };
+
+    void convolveDirect(uint32_t layer, const Tensor& input, uint32_t y, float* pAccumulators) const;
+    void convolveIm2ColGemm(uint32_t layer, const Tensor& input, uint32_t y, std::vector<float>& columns, float* pAccumulators) const;
+
+    std::vector<Layer> mLayers;
+    std::vector<PackedLayer> mPackedLayers;
+};
+} // namespace Falcor
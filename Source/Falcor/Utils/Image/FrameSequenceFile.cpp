@@ -0,0 +1,880 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FrameSequenceFile.h"
+#include "Bitmap.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/StringFormatters.h"
+#include "Utils/Scripting/ScriptBindings.h"
+#include <lz4.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <execution>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMagic = 0x51455346; // 'FSEQ'
+const uint32_t kVersion = 1;
+const uint32_t kMaxTileSize = 4096;
+
+enum class ChunkEncoding : uint8_t
+{
+    Raw = 0,       ///< Shuffled bytes.
+    LZ4 = 1,       ///< Shuffled bytes, LZ4 compressed.
+    DeltaRaw = 2,  ///< Shuffled XOR delta against the previous image.
+    DeltaLZ4 = 3,  ///< Shuffled XOR delta against the previous image, LZ4 compressed.
+    Unchanged = 4, ///< Identical to the previous image, no payload.
+};
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tileSize;
+    uint32_t outputCount;
+    uint32_t imageCount;
+    uint32_t chunkCount;
+    uint64_t indexOffset;
+};
+
+struct OutputHeader
+{
+    uint32_t nameLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+};
+
+static_assert(sizeof(FileHeader) == 32);
+static_assert(sizeof(FrameSequenceFile::ImageDesc) == 24);
+static_assert(sizeof(FrameSequenceFile::Chunk) == 16);
+
+bool isDelta(ChunkEncoding encoding)
+{
+    return encoding == ChunkEncoding::DeltaRaw || encoding == ChunkEncoding::DeltaLZ4 || encoding == ChunkEncoding::Unchanged;
+}
+
+/// Pixel rectangle covered by a tile.
+struct TileRect
+{
+    uint32_t x, y, width, height;
+};
+
+uint32_t getTileCount(uint32_t width, uint32_t height, uint32_t tileSize)
+{
+    return ((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+}
+
+TileRect getTileRect(uint32_t tile, uint32_t width, uint32_t height, uint32_t tileSize)
+{
+    uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    uint32_t x = (tile % tilesX) * tileSize;
+    uint32_t y = (tile / tilesX) * tileSize;
+    return {x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)};
+}
+
+/// Copy the pixels of a tile into a contiguous buffer, XOR'ed with the previous image if given.
+void gatherTile(const uint8_t* pImage, const uint8_t* pPrev, uint32_t imageWidth, uint32_t bytesPerPixel, const TileRect& rect, uint8_t* pDst)
+{
+    const size_t rowSize = size_t(rect.width) * bytesPerPixel;
+    for (uint32_t y = 0; y < rect.height; ++y)
+    {
+        size_t offset = (size_t(rect.y + y) * imageWidth + rect.x) * bytesPerPixel;
+        std::memcpy(pDst + y * rowSize, pImage + offset, rowSize);
+        if (pPrev)
+        {
+            for (size_t i = 0; i < rowSize; ++i)
+                pDst[y * rowSize + i] ^= pPrev[offset + i];
+        }
+    }
+}
+
+/// Transpose pixel bytes into planes, so that bytes of equal significance are adjacent.
+void shuffle(const uint8_t* pSrc, size_t pixelCount, uint32_t bytesPerPixel, uint8_t* pDst)
+{
+    for (size_t p = 0; p < pixelCount; ++p)
+        for (uint32_t b = 0; b < bytesPerPixel; ++b)
+            pDst[b * pixelCount + p] = pSrc[p * bytesPerPixel + b];
+}
+
+void unshuffle(const uint8_t* pSrc, size_t pixelCount, uint32_t bytesPerPixel, uint8_t* pDst)
+{
+    for (size_t p = 0; p < pixelCount; ++p)
+        for (uint32_t b = 0; b < bytesPerPixel; ++b)
+            pDst[p * bytesPerPixel + b] = pSrc[b * pixelCount + p];
+}
+
+/**
+ * Encode a tile.
+ * @param[in] pPrev Previous image of the output for delta encoding, or nullptr.
+ * @param[out] payload Encoded payload.
+ * @return Chunk encoding.
+ */
+ChunkEncoding encodeTile(
+    const uint8_t* pImage,
+    const uint8_t* pPrev,
+    uint32_t imageWidth,
+    uint32_t bytesPerPixel,
+    const TileRect& rect,
+    std::vector<uint8_t>& payload
+)
+{
+    const size_t pixelCount = size_t(rect.width) * rect.height;
+    const size_t byteSize = pixelCount * bytesPerPixel;
+
+    std::vector<uint8_t> tile(byteSize);
+    gatherTile(pImage, pPrev, imageWidth, bytesPerPixel, rect, tile.data());
+
+    if (pPrev && std::all_of(tile.begin(), tile.end(), [](uint8_t v) { return v == 0; }))
+    {
+        payload.clear();
+        return ChunkEncoding::Unchanged;
+    }
+
+    std::vector<uint8_t> shuffled(byteSize);
+    shuffle(tile.data(), pixelCount, bytesPerPixel, shuffled.data());
+
+    payload.resize(LZ4_compressBound((int)byteSize));
+    int compressedSize = LZ4_compress_default(
+        reinterpret_cast<const char*>(shuffled.data()), reinterpret_cast<char*>(payload.data()), (int)byteSize, (int)payload.size()
+    );
+    if (compressedSize > 0 && (size_t)compressedSize < byteSize)
+    {
+        payload.resize(compressedSize);
+        return pPrev ? ChunkEncoding::DeltaLZ4 : ChunkEncoding::LZ4;
+    }
+
+    payload = std::move(shuffled);
+    return pPrev ? ChunkEncoding::DeltaRaw : ChunkEncoding::Raw;
+}
+
+template<typename T>
+float normalize(T value, bool normalized)
+{
+    if (!normalized)
+        return float(value);
+    return std::max(float(value) / float(std::numeric_limits<T>::max()), -1.f);
+}
+
+template<typename T>
+void convertChannels(const uint8_t* pSrc, size_t pixelCount, uint32_t channelCount, bool normalized, float* pDst)
+{
+    const T* pValues = reinterpret_cast<const T*>(pSrc);
+    for (size_t p = 0; p < pixelCount; ++p)
+        for (uint32_t c = 0; c < channelCount; ++c)
+            pDst[p * 4 + c] = normalize(pValues[p * channelCount + c], normalized);
+}
+
+bool isBGRFormat(ResourceFormat format)
+{
+    return format == ResourceFormat::BGRA8Unorm || format == ResourceFormat::BGRA8UnormSrgb || format == ResourceFormat::BGRX8Unorm ||
+           format == ResourceFormat::BGRX8UnormSrgb;
+}
+
+/// Split a file stem of the form <prefix>.<output>.<frameID>[.<suffix>] into output name and frame.
+bool parseImageFileName(const std::filesystem::path& path, std::string& output, uint64_t& frameID)
+{
+    std::vector<std::string> parts;
+    std::string stem = path.stem().string();
+    size_t start = 0;
+    while (true)
+    {
+        size_t end = stem.find('.', start);
+        parts.push_back(stem.substr(start, end - start));
+        if (end == std::string::npos)
+            break;
+        start = end + 1;
+    }
+
+    // Use the last all-digit part after the output name as frame number.
+    for (size_t i = parts.size(); i-- > 2;)
+    {
+        const std::string& part = parts[i];
+        if (part.empty() || !std::all_of(part.begin(), part.end(), [](char c) { return std::isdigit((unsigned char)c) != 0; }))
+            continue;
+
+        frameID = std::stoull(part);
+        output.clear();
+        for (size_t j = 1; j < parts.size(); ++j)
+        {
+            if (j == i)
+                continue;
+            if (!output.empty())
+                output += ".";
+            output += parts[j];
+        }
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+// Writer
+
+FrameSequenceFile::Writer::Writer(const std::filesystem::path& path, const WriterOptions& options) : mOptions(options)
+{
+    checkArgument(options.tileSize > 0 && options.tileSize <= kMaxTileSize, "'tileSize' must be in [1, {}].", kMaxTileSize);
+
+    mStream.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mStream)
+        throw RuntimeError("Failed to create frame sequence file '{}'.", path);
+
+    // Reserve space for the header, which is written on finalize.
+    FileHeader header = {};
+    mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    mOffset = sizeof(header);
+}
+
+FrameSequenceFile::Writer::~Writer()
+{
+    if (!mFinalized && mStream.is_open())
+    {
+        // Exceptions must not escape the destructor.
+        try
+        {
+            finalize();
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to finalize frame sequence file: {}", e.what());
+        }
+    }
+}
+
+uint32_t FrameSequenceFile::Writer::addOutput(const std::string& name, uint32_t width, uint32_t height, ResourceFormat format)
+{
+    checkArgument(width > 0 && height > 0, "Output '{}' has an invalid size {}x{}.", name, width, height);
+    checkArgument(isFormatSupported(format), "Output '{}' has unsupported format {}.", name, to_string(format));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    FALCOR_ASSERT(!mFinalized);
+
+    for (uint32_t i = 0; i < mOutputs.size(); ++i)
+    {
+        const OutputDesc& desc = mOutputs[i].desc;
+        if (desc.name != name)
+            continue;
+        checkArgument(
+            desc.width == width && desc.height == height && desc.format == format,
+            "Output '{}' already exists with a different size or format.",
+            name
+        );
+        return i;
+    }
+
+    OutputState state;
+    state.desc = {name, width, height, format};
+    mOutputs.push_back(std::move(state));
+    return (uint32_t)mOutputs.size() - 1;
+}
+
+void FrameSequenceFile::Writer::writeImage(uint64_t frameID, uint32_t output, const void* pData)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    FALCOR_ASSERT(!mFinalized);
+    checkArgument(output < mOutputs.size(), "'output' ({}) is out of range.", output);
+
+    OutputState& state = mOutputs[output];
+    const OutputDesc& desc = state.desc;
+    const uint32_t bytesPerPixel = getFormatBytesPerBlock(desc.format);
+    const uint32_t tileCount = getTileCount(desc.width, desc.height, mOptions.tileSize);
+    const uint8_t* pImage = reinterpret_cast<const uint8_t*>(pData);
+
+    const bool delta = mOptions.deltaCompression && state.prevImageIndex != kInvalidIndex && state.deltaCount < mOptions.keyframeInterval;
+    const uint8_t* pPrev = delta ? state.prevImage.data() : nullptr;
+
+    // Encode tiles in parallel.
+    std::vector<std::vector<uint8_t>> payloads(tileCount);
+    std::vector<ChunkEncoding> encodings(tileCount);
+    auto range = NumericRange<uint32_t>(0, tileCount);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](uint32_t tile)
+        {
+            TileRect rect = getTileRect(tile, desc.width, desc.height, mOptions.tileSize);
+            encodings[tile] = encodeTile(pImage, pPrev, desc.width, bytesPerPixel, rect, payloads[tile]);
+        }
+    );
+
+    ImageDesc image;
+    image.frameID = frameID;
+    image.output = output;
+    image.firstChunk = (uint32_t)mChunks.size();
+    image.prevImage = delta ? state.prevImageIndex : kInvalidIndex;
+
+    for (uint32_t tile = 0; tile < tileCount; ++tile)
+    {
+        Chunk chunk;
+        chunk.offset = mOffset;
+        chunk.size = (uint32_t)payloads[tile].size();
+        chunk.encoding = (uint8_t)encodings[tile];
+        mStream.write(reinterpret_cast<const char*>(payloads[tile].data()), payloads[tile].size());
+        mOffset += chunk.size;
+        mChunks.push_back(chunk);
+    }
+    if (!mStream)
+        throw RuntimeError("Failed to write frame sequence file.");
+
+    mImages.push_back(image);
+
+    state.prevImage.assign(pImage, pImage + size_t(desc.width) * desc.height * bytesPerPixel);
+    state.prevImageIndex = (uint32_t)mImages.size() - 1;
+    state.deltaCount = delta ? state.deltaCount + 1 : 0;
+}
+
+void FrameSequenceFile::Writer::finalize()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    FALCOR_ASSERT(!mFinalized);
+
+    FileHeader header = {};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.tileSize = mOptions.tileSize;
+    header.outputCount = (uint32_t)mOutputs.size();
+    header.imageCount = (uint32_t)mImages.size();
+    header.chunkCount = (uint32_t)mChunks.size();
+    header.indexOffset = mOffset;
+
+    for (const auto& state : mOutputs)
+    {
+        OutputHeader outputHeader = {(uint32_t)state.desc.name.size(), state.desc.width, state.desc.height, (uint32_t)state.desc.format};
+        mStream.write(reinterpret_cast<const char*>(&outputHeader), sizeof(outputHeader));
+        mStream.write(state.desc.name.data(), state.desc.name.size());
+    }
+    mStream.write(reinterpret_cast<const char*>(mImages.data()), mImages.size() * sizeof(ImageDesc));
+    mStream.write(reinterpret_cast<const char*>(mChunks.data()), mChunks.size() * sizeof(Chunk));
+
+    mStream.seekp(0);
+    mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    mStream.close();
+    mFinalized = true;
+    mOutputs.clear();
+
+    if (mStream.fail())
+        throw RuntimeError("Failed to write frame sequence file.");
+}
+
+uint64_t FrameSequenceFile::Writer::getPayloadSize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOffset - sizeof(FileHeader);
+}
+
+// Reader
+
+FrameSequenceFile::FrameSequenceFile(const std::filesystem::path& path)
+{
+    if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        throw RuntimeError("Failed to open frame sequence file '{}'.", path);
+
+    const uint8_t* pData = reinterpret_cast<const uint8_t*>(mFile.getData());
+    const size_t fileSize = mFile.getMappedSize();
+
+    FileHeader header;
+    if (fileSize < sizeof(header))
+        throw RuntimeError("Frame sequence file '{}' is truncated.", path);
+    std::memcpy(&header, pData, sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion || header.tileSize == 0 || header.tileSize > kMaxTileSize ||
+        header.indexOffset < sizeof(header) || header.indexOffset > fileSize)
+        throw RuntimeError("Frame sequence file '{}' has an invalid header.", path);
+
+    mTileSize = header.tileSize;
+
+    // Read the index.
+    size_t offset = header.indexOffset;
+    auto read = [&](void* pDst, size_t size)
+    {
+        if (offset + size > fileSize)
+            throw RuntimeError("Frame sequence file '{}' has a truncated index.", path);
+        std::memcpy(pDst, pData + offset, size);
+        offset += size;
+    };
+
+    mOutputs.resize(header.outputCount);
+    for (auto& output : mOutputs)
+    {
+        OutputHeader outputHeader;
+        read(&outputHeader, sizeof(outputHeader));
+        output.name.resize(outputHeader.nameLength);
+        read(output.name.data(), outputHeader.nameLength);
+        output.width = outputHeader.width;
+        output.height = outputHeader.height;
+        output.format = (ResourceFormat)outputHeader.format;
+        if (outputHeader.format >= (uint32_t)ResourceFormat::Count || !isFormatSupported(output.format) || output.width == 0 ||
+            output.height == 0)
+            throw RuntimeError("Frame sequence file '{}' has an invalid output '{}'.", path, output.name);
+    }
+
+    mImages.resize(header.imageCount);
+    read(mImages.data(), mImages.size() * sizeof(ImageDesc));
+    mChunks.resize(header.chunkCount);
+    read(mChunks.data(), mChunks.size() * sizeof(Chunk));
+
+    for (const Chunk& chunk : mChunks)
+    {
+        if (chunk.offset < sizeof(header) || chunk.offset + chunk.size > header.indexOffset || chunk.encoding > (uint8_t)ChunkEncoding::Unchanged)
+            throw RuntimeError("Frame sequence file '{}' has an invalid chunk.", path);
+    }
+
+    for (uint32_t i = 0; i < mImages.size(); ++i)
+    {
+        const ImageDesc& image = mImages[i];
+        bool valid = image.output < mOutputs.size();
+        if (valid)
+        {
+            const OutputDesc& output = mOutputs[image.output];
+            const uint64_t tileCount = getTileCount(output.width, output.height, mTileSize);
+            valid = image.firstChunk + tileCount <= mChunks.size();
+            if (image.prevImage != kInvalidIndex)
+                valid = valid && image.prevImage < i && mImages[image.prevImage].output == image.output;
+            for (uint64_t tile = 0; valid && tile < tileCount; ++tile)
+            {
+                bool delta = isDelta((ChunkEncoding)mChunks[image.firstChunk + tile].encoding);
+                valid = !delta || image.prevImage != kInvalidIndex;
+            }
+        }
+        if (!valid)
+            throw RuntimeError("Frame sequence file '{}' has an invalid image {}.", path, i);
+
+        // The first image of a frame and output is used if there are duplicates.
+        mImageIndex.try_emplace({image.frameID, image.output}, i);
+    }
+}
+
+bool FrameSequenceFile::isSequenceFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    uint32_t magic = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    return file.good() && magic == kMagic;
+}
+
+bool FrameSequenceFile::isFormatSupported(ResourceFormat format)
+{
+    return format != ResourceFormat::Unknown && format < ResourceFormat::Count && !isCompressedFormat(format) &&
+           getFormatPixelsPerBlock(format) == 1 && getFormatBytesPerBlock(format) > 0;
+}
+
+uint32_t FrameSequenceFile::findOutput(const std::string& name) const
+{
+    for (uint32_t i = 0; i < mOutputs.size(); ++i)
+    {
+        if (mOutputs[i].name == name)
+            return i;
+    }
+    return kInvalidIndex;
+}
+
+uint32_t FrameSequenceFile::findImage(uint64_t frameID, uint32_t output) const
+{
+    auto it = mImageIndex.find({frameID, output});
+    return it != mImageIndex.end() ? it->second : kInvalidIndex;
+}
+
+std::vector<uint64_t> FrameSequenceFile::getFrameIDs() const
+{
+    std::vector<uint64_t> frameIDs;
+    for (const auto& [key, image] : mImageIndex)
+    {
+        if (frameIDs.empty() || frameIDs.back() != key.first)
+            frameIDs.push_back(key.first);
+    }
+    return frameIDs;
+}
+
+size_t FrameSequenceFile::getImageByteSize(uint32_t image) const
+{
+    const OutputDesc& output = mOutputs[mImages[image].output];
+    return size_t(output.width) * output.height * getFormatBytesPerBlock(output.format);
+}
+
+void FrameSequenceFile::readImage(uint32_t image, void* pDst, const void* pPrev) const
+{
+    checkArgument(image < mImages.size(), "'image' ({}) is out of range.", image);
+
+    uint32_t prevImage = mImages[image].prevImage;
+    if (prevImage == kInvalidIndex || pPrev)
+    {
+        decodeImage(image, reinterpret_cast<uint8_t*>(pDst), reinterpret_cast<const uint8_t*>(pPrev));
+        return;
+    }
+
+    // Restart from the closest keyframe.
+    std::vector<uint32_t> chain = {image};
+    while (prevImage != kInvalidIndex)
+    {
+        chain.push_back(prevImage);
+        prevImage = mImages[prevImage].prevImage;
+    }
+
+    const size_t byteSize = getImageByteSize(image);
+    std::vector<uint8_t> prev(byteSize);
+    std::vector<uint8_t> current(byteSize);
+    for (size_t i = chain.size(); i-- > 1;)
+    {
+        decodeImage(chain[i], current.data(), i + 1 < chain.size() ? prev.data() : nullptr);
+        std::swap(prev, current);
+    }
+    decodeImage(image, reinterpret_cast<uint8_t*>(pDst), prev.data());
+}
+
+std::vector<uint8_t> FrameSequenceFile::readImage(uint32_t image) const
+{
+    checkArgument(image < mImages.size(), "'image' ({}) is out of range.", image);
+    std::vector<uint8_t> data(getImageByteSize(image));
+    readImage(image, data.data());
+    return data;
+}
+
+void FrameSequenceFile::decodeImage(uint32_t image, uint8_t* pDst, const uint8_t* pPrev) const
+{
+    const ImageDesc& desc = mImages[image];
+    const OutputDesc& output = mOutputs[desc.output];
+    const uint32_t bytesPerPixel = getFormatBytesPerBlock(output.format);
+    const uint32_t tileCount = getTileCount(output.width, output.height, mTileSize);
+    const uint8_t* pFileData = reinterpret_cast<const uint8_t*>(mFile.getData());
+
+    // Exceptions must not escape the parallel loop. The first error is rethrown after it.
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+
+    auto range = NumericRange<uint32_t>(0, tileCount);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](uint32_t tile)
+        {
+            if (failed.load(std::memory_order_relaxed))
+                return;
+
+            try
+            {
+                const Chunk& chunk = mChunks[desc.firstChunk + tile];
+                const ChunkEncoding encoding = (ChunkEncoding)chunk.encoding;
+                const TileRect rect = getTileRect(tile, output.width, output.height, mTileSize);
+                const size_t pixelCount = size_t(rect.width) * rect.height;
+                const size_t byteSize = pixelCount * bytesPerPixel;
+                const size_t rowSize = size_t(rect.width) * bytesPerPixel;
+                FALCOR_ASSERT(!isDelta(encoding) || pPrev);
+
+                std::vector<uint8_t> tileData(byteSize);
+                if (encoding != ChunkEncoding::Unchanged)
+                {
+                    std::vector<uint8_t> shuffled(byteSize);
+                    const uint8_t* pPayload = pFileData + chunk.offset;
+                    if (encoding == ChunkEncoding::LZ4 || encoding == ChunkEncoding::DeltaLZ4)
+                    {
+                        int decodedSize = LZ4_decompress_safe(
+                            reinterpret_cast<const char*>(pPayload), reinterpret_cast<char*>(shuffled.data()), (int)chunk.size, (int)byteSize
+                        );
+                        if (decodedSize != (int)byteSize)
+                            throw RuntimeError("Failed to decompress frame sequence chunk {}.", desc.firstChunk + tile);
+                    }
+                    else
+                    {
+                        if (chunk.size != byteSize)
+                            throw RuntimeError("Frame sequence chunk {} has an invalid size.", desc.firstChunk + tile);
+                        std::memcpy(shuffled.data(), pPayload, byteSize);
+                    }
+                    unshuffle(shuffled.data(), pixelCount, bytesPerPixel, tileData.data());
+                }
+
+                for (uint32_t y = 0; y < rect.height; ++y)
+                {
+                    size_t offset = (size_t(rect.y + y) * output.width + rect.x) * bytesPerPixel;
+                    const uint8_t* pSrc = tileData.data() + y * rowSize;
+                    if (isDelta(encoding))
+                    {
+                        for (size_t i = 0; i < rowSize; ++i)
+                            pDst[offset + i] = pSrc[i] ^ pPrev[offset + i];
+                    }
+                    else
+                    {
+                        std::memcpy(pDst + offset, pSrc, rowSize);
+                    }
+                }
+            }
+            catch (...)
+            {
+                if (!failed.exchange(true))
+                    error = std::current_exception();
+            }
+        }
+    );
+
+    if (failed)
+        std::rethrow_exception(error);
+}
+
+std::vector<float> FrameSequenceFile::readImageRGBA32Float(uint32_t image) const
+{
+    checkArgument(image < mImages.size(), "'image' ({}) is out of range.", image);
+
+    const OutputDesc& output = mOutputs[mImages[image].output];
+    return convertToRGBA32Float(output.format, output.width, output.height, readImage(image).data());
+}
+
+void FrameSequenceFile::forEachImage(const std::function<void(uint32_t image, const std::vector<uint8_t>& data)>& func) const
+{
+    // Last decoded image per output.
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> lastDecoded(mOutputs.size(), {kInvalidIndex, {}});
+
+    std::vector<uint8_t> data;
+    for (uint32_t image = 0; image < mImages.size(); ++image)
+    {
+        auto& [lastImage, lastData] = lastDecoded[mImages[image].output];
+        const bool hasPrev = mImages[image].prevImage != kInvalidIndex && mImages[image].prevImage == lastImage;
+
+        data.resize(getImageByteSize(image));
+        readImage(image, data.data(), hasPrev ? lastData.data() : nullptr);
+        func(image, data);
+
+        lastImage = image;
+        std::swap(lastData, data);
+    }
+}
+
+std::vector<float> FrameSequenceFile::convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
+{
+    const FormatType type = getFormatType(format);
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const uint32_t channelBits = getNumChannelBits(format, 0);
+    const size_t pixelCount = size_t(width) * height;
+
+    // Only formats with channels of equal size are supported. BGRX formats are stored as 4 channels of 8 bits.
+    bool supported = channelBits == 8 || channelBits == 16 || channelBits == 32;
+    const uint32_t storedChannelCount = supported ? getFormatBytesPerBlock(format) * 8 / channelBits : 0;
+    for (uint32_t c = 1; c < channelCount; ++c)
+        supported = supported && getNumChannelBits(format, c) == channelBits;
+    supported = supported && storedChannelCount * channelBits == getFormatBytesPerBlock(format) * 8 && storedChannelCount <= 4;
+    if (!supported)
+        throw RuntimeError("Cannot convert format {} to RGBA32Float.", to_string(format));
+
+    std::vector<float> result(pixelCount * 4, 0.f);
+    const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(pData);
+    float* pDst = result.data();
+    const bool normalized = type == FormatType::Unorm || type == FormatType::UnormSrgb || type == FormatType::Snorm;
+    const bool isSigned = type == FormatType::Snorm || type == FormatType::Sint;
+
+    switch (type)
+    {
+    case FormatType::Float:
+        if (channelBits == 32)
+        {
+            convertChannels<float>(pSrc, pixelCount, storedChannelCount, false, pDst);
+        }
+        else if (channelBits == 16)
+        {
+            const uint16_t* pValues = reinterpret_cast<const uint16_t*>(pSrc);
+            for (size_t p = 0; p < pixelCount; ++p)
+                for (uint32_t c = 0; c < storedChannelCount; ++c)
+                    pDst[p * 4 + c] = math::float16ToFloat32(pValues[p * storedChannelCount + c]);
+        }
+        else
+        {
+            throw RuntimeError("Cannot convert format {} to RGBA32Float.", to_string(format));
+        }
+        break;
+    default:
+        if (channelBits == 8)
+            isSigned ? convertChannels<int8_t>(pSrc, pixelCount, storedChannelCount, normalized, pDst)
+                     : convertChannels<uint8_t>(pSrc, pixelCount, storedChannelCount, normalized, pDst);
+        else if (channelBits == 16)
+            isSigned ? convertChannels<int16_t>(pSrc, pixelCount, storedChannelCount, normalized, pDst)
+                     : convertChannels<uint16_t>(pSrc, pixelCount, storedChannelCount, normalized, pDst);
+        else
+            isSigned ? convertChannels<int32_t>(pSrc, pixelCount, storedChannelCount, normalized, pDst)
+                     : convertChannels<uint32_t>(pSrc, pixelCount, storedChannelCount, normalized, pDst);
+        break;
+    }
+
+    const bool bgr = isBGRFormat(format);
+    const bool hasAlpha = doesFormatHaveAlpha(format);
+    for (size_t p = 0; p < pixelCount; ++p)
+    {
+        if (bgr)
+            std::swap(pDst[p * 4 + 0], pDst[p * 4 + 2]);
+        if (!hasAlpha)
+            pDst[p * 4 + 3] = 1.f;
+    }
+
+    return result;
+}
+
+std::vector<std::filesystem::path> FrameSequenceFile::exportImages(
+    const std::filesystem::path& srcPath,
+    const std::filesystem::path& dstPrefix,
+    const std::string& extension
+)
+{
+    FrameSequenceFile file(srcPath);
+    const Bitmap::FileFormat fileFormat = Bitmap::getFormatFromFileExtension(extension);
+    const bool hdr = fileFormat == Bitmap::FileFormat::ExrFile || fileFormat == Bitmap::FileFormat::PfmFile;
+    checkArgument(
+        fileFormat != Bitmap::FileFormat::DdsFile && fileFormat != Bitmap::FileFormat::NumpyFile,
+        "Cannot export frame sequences as '{}' files.",
+        extension
+    );
+
+    std::vector<std::filesystem::path> paths;
+    file.forEachImage(
+        [&](uint32_t i, const std::vector<uint8_t>& data)
+        {
+            const ImageDesc& image = file.getImage(i);
+            const OutputDesc& output = file.getOutput(image.output);
+            std::filesystem::path path = dstPrefix.string() + "." + output.name + "." + std::to_string(image.frameID) + "." + extension;
+
+            Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None;
+            if (doesFormatHaveAlpha(output.format) && fileFormat != Bitmap::FileFormat::PfmFile)
+                exportFlags |= Bitmap::ExportFlags::ExportAlpha;
+
+            if (!hdr && (output.format == ResourceFormat::BGRA8Unorm || output.format == ResourceFormat::BGRA8UnormSrgb))
+            {
+                // 8-bit BGRA is the native layout of the LDR writers. Bitmap::saveImage() takes a non-const pointer.
+                std::vector<uint8_t> copy = data;
+                Bitmap::saveImage(path, output.width, output.height, fileFormat, exportFlags, output.format, true, copy.data());
+            }
+            else
+            {
+                auto rgba = convertToRGBA32Float(output.format, output.width, output.height, data.data());
+                if (hdr)
+                {
+                    Bitmap::saveImage(
+                        path, output.width, output.height, fileFormat, exportFlags, ResourceFormat::RGBA32Float, true, rgba.data()
+                    );
+                }
+                else
+                {
+                    const uint32_t order[4] = {2, 1, 0, 3};
+                    std::vector<uint8_t> ldr(size_t(output.width) * output.height * 4);
+                    for (size_t p = 0; p < ldr.size() / 4; ++p)
+                    {
+                        for (uint32_t c = 0; c < 4; ++c)
+                            ldr[p * 4 + c] = (uint8_t)std::clamp(rgba[p * 4 + order[c]] * 255.f + 0.5f, 0.f, 255.f);
+                    }
+                    Bitmap::saveImage(
+                        path, output.width, output.height, fileFormat, exportFlags, ResourceFormat::BGRA8Unorm, true, ldr.data()
+                    );
+                }
+            }
+            paths.push_back(path);
+        }
+    );
+    return paths;
+}
+
+void FrameSequenceFile::importImages(
+    const std::vector<std::filesystem::path>& srcPaths,
+    const std::filesystem::path& dstPath,
+    const WriterOptions& options
+)
+{
+    // Sort by frame, then by output name, so that delta encoding sees the images of each output in order.
+    std::vector<std::tuple<uint64_t, std::string, std::filesystem::path>> images;
+    for (const auto& path : srcPaths)
+    {
+        std::string output;
+        uint64_t frameID = 0;
+        if (!parseImageFileName(path, output, frameID))
+            throw RuntimeError("Cannot determine output name and frame from image file name '{}'.", path);
+        images.emplace_back(frameID, output, path);
+    }
+    std::sort(images.begin(), images.end());
+
+    Writer writer(dstPath, options);
+    for (const auto& [frameID, outputName, path] : images)
+    {
+        auto pBitmap = Bitmap::createFromFile(path, true);
+        if (!pBitmap)
+            throw RuntimeError("Failed to load image '{}'.", path);
+
+        const uint32_t output = writer.addOutput(outputName, pBitmap->getWidth(), pBitmap->getHeight(), pBitmap->getFormat());
+        const size_t rowSize = size_t(pBitmap->getWidth()) * getFormatBytesPerBlock(pBitmap->getFormat());
+        if (pBitmap->getRowPitch() == rowSize)
+        {
+            writer.writeImage(frameID, output, pBitmap->getData());
+        }
+        else
+        {
+            std::vector<uint8_t> data(rowSize * pBitmap->getHeight());
+            for (uint32_t y = 0; y < pBitmap->getHeight(); ++y)
+                std::memcpy(data.data() + y * rowSize, pBitmap->getData() + size_t(y) * pBitmap->getRowPitch(), rowSize);
+            writer.writeImage(frameID, output, data.data());
+        }
+    }
+    writer.finalize();
+}
+
+FALCOR_SCRIPT_BINDING(FrameSequenceFile)
+{
+    using namespace pybind11::literals;
+
+    pybind11::class_<FrameSequenceFile> frameSequenceFile(m, "FrameSequenceFile");
+    frameSequenceFile.def_static(
+        "export_images",
+        [](const std::filesystem::path& srcPath, const std::filesystem::path& dstPrefix, const std::string& extension)
+        {
+            pybind11::gil_scoped_release release;
+            return FrameSequenceFile::exportImages(srcPath, dstPrefix, extension);
+        },
+        "src_path"_a,
+        "dst_prefix"_a,
+        "extension"_a = "exr"
+    );
+    frameSequenceFile.def_static(
+        "import_images",
+        [](const std::vector<std::filesystem::path>& srcPaths, const std::filesystem::path& dstPath, uint32_t tileSize, bool deltaCompression)
+        {
+            pybind11::gil_scoped_release release;
+            FrameSequenceWriterOptions options;
+            options.tileSize = tileSize;
+            options.deltaCompression = deltaCompression;
+            FrameSequenceFile::importImages(srcPaths, dstPath, options);
+        },
+        "src_paths"_a,
+        "dst_path"_a,
+        "tile_size"_a = FrameSequenceWriterOptions().tileSize,
+        "delta_compression"_a = FrameSequenceWriterOptions().deltaCompression
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,278 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Falcor
+{
+struct FrameSequenceWriterOptions
+{
+    uint32_t tileSize = 64;         ///< Tile width and height in pixels.
+    bool deltaCompression = true;   ///< Encode images as delta against the previous image of the same output.
+    uint32_t keyframeInterval = 32; ///< Maximum number of consecutive delta encoded images per output.
+};
+
+/**
+ * Chunked, compressed container for captured frame sequences (.fseq).
+ *
+ * A sequence holds any number of named outputs, each with a fixed size and pixel format. Every image (one output
+ * of one frame) is split into square tiles, and each tile is stored as its own chunk. The bytes of a tile are
+ * shuffled into planes (byte 0 of all pixels, then byte 1, ...) and LZ4 compressed. Tiles can additionally be
+ * XOR delta encoded against the same tile of the previous image of the output, which compresses static regions
+ * to almost nothing. A keyframe without delta encoding is forced regularly to bound the cost of random access.
+ *
+ * The image and chunk index is stored at the end of the file. The file is read through a memory mapping,
+ * and the tiles of an image are decoded in parallel.
+ */
+class FALCOR_API FrameSequenceFile
+{
+public:
+    static constexpr uint32_t kInvalidIndex = uint32_t(-1);
+
+    struct OutputDesc
+    {
+        std::string name;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        ResourceFormat format = ResourceFormat::Unknown;
+    };
+
+    struct ImageDesc
+    {
+        uint64_t frameID = 0;
+        uint32_t output = 0;
+        uint32_t firstChunk = 0;           ///< Index of the chunk of the first tile.
+        uint32_t prevImage = kInvalidIndex; ///< Image this image is delta encoded against, or kInvalidIndex for keyframes.
+        uint32_t reserved = 0;
+    };
+
+    struct Chunk
+    {
+        uint64_t offset = 0;  ///< Byte offset of the payload in the file.
+        uint32_t size = 0;    ///< Payload size in bytes.
+        uint8_t encoding = 0; ///< Payload encoding, see ChunkEncoding in the implementation.
+        uint8_t reserved[3] = {};
+    };
+
+    using WriterOptions = FrameSequenceWriterOptions;
+
+    /**
+     * Writes a new sequence file.
+     * Images of an output must be written in frame order. Outputs can be interleaved and added at any time.
+     * The writer is thread safe, but images are encoded in the order the calls are made.
+     */
+    class FALCOR_API Writer
+    {
+    public:
+        /**
+         * Create a new sequence file. Throws a RuntimeError if the file cannot be created.
+         * @param[in] path File path.
+         * @param[in] options Writer options.
+         */
+        Writer(const std::filesystem::path& path, const WriterOptions& options = {});
+        ~Writer();
+
+        /**
+         * Add an output, or return the existing output of the same name.
+         * Throws an ArgumentError if the format is not supported, or if an output of the same name but a different size or
+         * format exists.
+         * @return Output index.
+         */
+        uint32_t addOutput(const std::string& name, uint32_t width, uint32_t height, ResourceFormat format);
+
+        /**
+         * Append an image.
+         * @param[in] frameID Frame the image belongs to.
+         * @param[in] output Output index.
+         * @param[in] pData Tightly packed pixel data, top row first.
+         */
+        void writeImage(uint64_t frameID, uint32_t output, const void* pData);
+
+        /**
+         * Write the index and close the file. Called by the destructor if not called explicitly.
+         */
+        void finalize();
+
+        /**
+         * Get the number of payload bytes written so far.
+         */
+        uint64_t getPayloadSize() const;
+
+    private:
+        struct OutputState
+        {
+            OutputDesc desc;
+            std::vector<uint8_t> prevImage;
+            uint32_t prevImageIndex = kInvalidIndex;
+            uint32_t deltaCount = 0;
+        };
+
+        mutable std::mutex mMutex;
+        std::ofstream mStream;
+        WriterOptions mOptions;
+        bool mFinalized = false;
+        uint64_t mOffset = 0;
+        std::vector<OutputState> mOutputs;
+        std::vector<ImageDesc> mImages;
+        std::vector<Chunk> mChunks;
+    };
+
+    /**
+     * Open a sequence file. Throws a RuntimeError if the file is invalid.
+     */
+    FrameSequenceFile(const std::filesystem::path& path);
+
+    /**
+     * Check if a file is a sequence file.
+     */
+    static bool isSequenceFile(const std::filesystem::path& path);
+
+    /**
+     * Check if images of a format can be stored in a sequence file. Compressed formats are not supported.
+     */
+    static bool isFormatSupported(ResourceFormat format);
+
+    uint32_t getTileSize() const { return mTileSize; }
+    uint32_t getOutputCount() const { return (uint32_t)mOutputs.size(); }
+    const OutputDesc& getOutput(uint32_t output) const { return mOutputs[output]; }
+    uint32_t getImageCount() const { return (uint32_t)mImages.size(); }
+    const ImageDesc& getImage(uint32_t image) const { return mImages[image]; }
+    uint32_t getChunkCount() const { return (uint32_t)mChunks.size(); }
+    const Chunk& getChunk(uint32_t chunk) const { return mChunks[chunk]; }
+
+    /**
+     * Get the size of the sequence file in bytes.
+     */
+    size_t getFileSize() const { return mFile.getMappedSize(); }
+
+    /**
+     * Find an output by name.
+     * @return Output index, or kInvalidIndex if not found.
+     */
+    uint32_t findOutput(const std::string& name) const;
+
+    /**
+     * Find the image of an output for a frame.
+     * @return Image index, or kInvalidIndex if not found.
+     */
+    uint32_t findImage(uint64_t frameID, uint32_t output) const;
+
+    /**
+     * Get the sorted list of frames that have at least one image.
+     */
+    std::vector<uint64_t> getFrameIDs() const;
+
+    /**
+     * Get the size in bytes of a decoded image.
+     */
+    size_t getImageByteSize(uint32_t image) const;
+
+    /**
+     * Decode an image.
+     * @param[in] image Image index.
+     * @param[out] pDst Destination of getImageByteSize() bytes. Pixels are tightly packed, top row first.
+     * @param[in] pPrev Decoded data of the image this image is delta encoded against if available, or nullptr.
+     * If the image is delta encoded and pPrev is nullptr, decoding restarts from the closest keyframe.
+     */
+    void readImage(uint32_t image, void* pDst, const void* pPrev = nullptr) const;
+
+    /**
+     * Decode an image.
+     */
+    std::vector<uint8_t> readImage(uint32_t image) const;
+
+    /**
+     * Decode an image and convert it to RGBA32Float. Missing channels are set to 0, missing alpha to 1.
+     * Normalized formats are converted to [0,1] or [-1,1] without sRGB decoding, which matches loading 8-bit image files.
+     * Throws a RuntimeError if the format cannot be converted.
+     */
+    std::vector<float> readImageRGBA32Float(uint32_t image) const;
+
+    /**
+     * Decode all images in file order. Delta encoded images are decoded from the previous image of their output, so this is
+     * much faster than reading each image individually.
+     * @param[in] func Function called with the image index and the decoded data.
+     */
+    void forEachImage(const std::function<void(uint32_t image, const std::vector<uint8_t>& data)>& func) const;
+
+    /**
+     * Convert pixel data to RGBA32Float. See readImageRGBA32Float() for the conversion rules.
+     * Throws a RuntimeError if the format cannot be converted.
+     */
+    static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData);
+
+    /**
+     * Convert a sequence file to one image file per image. Files are named <prefix>.<output>.<frameID>.<extension>.
+     * @param[in] srcPath Sequence file.
+     * @param[in] dstPrefix Path and file name prefix of the image files.
+     * @param[in] extension Image file extension, e.g., "exr" or "png".
+     * @return List of written image files.
+     */
+    static std::vector<std::filesystem::path> exportImages(
+        const std::filesystem::path& srcPath,
+        const std::filesystem::path& dstPrefix,
+        const std::string& extension
+    );
+
+    /**
+     * Convert per-frame image files to a sequence file.
+     * File names are parsed as <prefix>.<output>.<frameID>[.<suffix>].<extension>, which matches the files written by
+     * Mogwai frame capture. The output name includes the suffix, if any.
+     * Throws a RuntimeError if a file name cannot be parsed or an image cannot be loaded.
+     * @param[in] srcPaths Image files.
+     * @param[in] dstPath Sequence file.
+     * @param[in] options Writer options.
+     */
+    static void importImages(
+        const std::vector<std::filesystem::path>& srcPaths,
+        const std::filesystem::path& dstPath,
+        const WriterOptions& options = {}
+    );
+
+private:
+    void decodeImage(uint32_t image, uint8_t* pDst, const uint8_t* pPrev) const;
+
+    MemoryMappedFile mFile;
+    uint32_t mTileSize = 0;
+    std::vector<OutputDesc> mOutputs;
+    std::vector<ImageDesc> mImages;
+    std::vector<Chunk> mChunks;
+    std::map<std::pair<uint64_t, uint32_t>, uint32_t> mImageIndex; ///< Image index by frame ID and output.
+};
+} // namespace Falcor
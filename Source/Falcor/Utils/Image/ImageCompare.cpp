@@ -0,0 +1,562 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ImageCompare.h"
+#include "FrameSequenceFile.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Scripting/ScriptBindings.h"
+
+#include <FreeImage.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <execution>
+
+namespace Falcor
+{
+namespace
+{
+template<typename T>
+T sqr(T x)
+{
+    return x * x;
+}
+
+template<typename T>
+T lerp(T a, T b, T t)
+{
+    return a + t * (b - a);
+}
+
+template<typename T>
+T clamp(T x, T lo, T hi)
+{
+    return std::max(lo, std::min(hi, x));
+}
+
+struct MSE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += sqr(a[i] - b[i]);
+        return error / count;
+    }
+};
+
+struct RMSE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
+        return error / count;
+    }
+};
+
+struct MAE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += std::fabs(sqr(a[i] - b[i]));
+        return error / count;
+    }
+};
+
+struct MAPE
+{
+    double operator()(const float* a, const float* b, size_t count) const
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < count; ++i)
+            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
+        return 100.0 * error / count;
+    }
+};
+
+template<typename Metric>
+double compareImages(const ImageCompare::Image& imageA, const ImageCompare::Image& imageB, bool alpha, float* errorMap)
+{
+    Metric metric;
+    double sum = 0.0;
+    const float* a = imageA.getData();
+    const float* b = imageB.getData();
+    size_t count = imageA.getWidth() * imageA.getHeight();
+    for (size_t i = 0; i < count; ++i)
+    {
+        double error = metric(a, b, alpha ? 4 : 3);
+        if (errorMap)
+            *errorMap++ = float(error);
+        sum += error;
+        a += 4;
+        b += 4;
+    }
+    return sum / count;
+}
+} // namespace
+
+ImageCompare::Image::Image(uint32_t width, uint32_t height)
+    : mWidth(width), mHeight(height), mData(std::make_unique<float[]>(size_t(width) * height * 4))
+{}
+
+std::shared_ptr<ImageCompare::Image> ImageCompare::Image::loadFromFile(const std::filesystem::path& path)
+{
+    FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+    auto pathStr = path.string();
+
+    // Determine file format.
+    fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
+    if (fifFormat == FIF_UNKNOWN)
+        fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
+    if (fifFormat == FIF_UNKNOWN)
+        throw RuntimeError("Unknown image format");
+    if (!FreeImage_FIFSupportsReading(fifFormat))
+        throw RuntimeError("Unsupported image format");
+
+    // Read image.
+    FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, pathStr.c_str());
+    if (!srcBitmap)
+        throw RuntimeError("Cannot read image");
+
+    // Convert to RGBA32F.
+    FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
+    FreeImage_Unload(srcBitmap);
+    if (!floatBitmap)
+        throw RuntimeError("Cannot convert to RGBA float format");
+
+    // Create image.
+    auto image = create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
+    int bytesPerPixel = 4 * sizeof(float);
+    FreeImage_ConvertToRawBits(
+        reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK,
+        FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true
+    );
+    FreeImage_Unload(floatBitmap);
+
+    return image;
+}
+
+std::shared_ptr<ImageCompare::Image> ImageCompare::Image::loadFromSequence(
+    const FrameSequenceFile& file,
+    uint32_t image,
+    const std::vector<uint8_t>& data
+)
+{
+    const auto& output = file.getOutput(file.getImage(image).output);
+    auto rgba = FrameSequenceFile::convertToRGBA32Float(output.format, output.width, output.height, data.data());
+    auto pImage = create(output.width, output.height);
+    std::memcpy(pImage->getData(), rgba.data(), pImage->getByteSize());
+    return pImage;
+}
+
+void ImageCompare::Image::saveToFile(const std::filesystem::path& path, bool writeAlpha) const
+{
+    FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+    auto pathStr = path.string();
+
+    // Determine file format.
+    fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
+    if (fifFormat == FIF_UNKNOWN)
+        throw RuntimeError("Unknown image format");
+    if (!FreeImage_FIFSupportsWriting(fifFormat))
+        throw RuntimeError("Unsupported image format");
+
+    bool writeFloat = fifFormat == FIF_EXR || fifFormat == FIF_PFM || fifFormat == FIF_HDR;
+    if (fifFormat != FIF_EXR && fifFormat != FIF_PNG)
+        writeAlpha = false;
+
+    // Create bitmap.
+    FIBITMAP* bitmap;
+    const float* src = getData();
+    if (writeFloat)
+    {
+        bitmap = FreeImage_AllocateT(writeAlpha ? FIT_RGBAF : FIT_RGBF, mWidth, mHeight);
+        for (uint32_t y = 0; y < mHeight; y++)
+        {
+            float* dst = reinterpret_cast<float*>(FreeImage_GetScanLine(bitmap, mHeight - y - 1));
+            if (writeAlpha)
+            {
+                std::memcpy(dst, src, mWidth * 4 * sizeof(float));
+                src += mWidth * 4;
+            }
+            else
+            {
+                for (uint32_t x = 0; x < mWidth; ++x)
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst += 3;
+                    src += 4;
+                }
+            }
+        }
+    }
+    else
+    {
+        bitmap = FreeImage_Allocate(mWidth, mHeight, writeAlpha ? 32 : 24);
+        for (uint32_t y = 0; y < mHeight; y++)
+        {
+            uint8_t* dst = reinterpret_cast<uint8_t*>(FreeImage_GetScanLine(bitmap, mHeight - y - 1));
+            for (uint32_t x = 0; x < mWidth; ++x)
+            {
+                dst[2] = clamp(int(src[0] * 255.f), 0, 255);
+                dst[1] = clamp(int(src[1] * 255.f), 0, 255);
+                dst[0] = clamp(int(src[2] * 255.f), 0, 255);
+                if (writeAlpha)
+                    dst[3] = clamp(int(src[3] * 255.f), 0, 255);
+                dst += writeAlpha ? 4 : 3;
+                src += 4;
+            }
+        }
+    }
+
+    // Write image.
+    FreeImage_Save(fifFormat, bitmap, pathStr.c_str());
+    FreeImage_Unload(bitmap);
+}
+
+const char* ImageCompare::getMetricDescription(Metric metric)
+{
+    switch (metric)
+    {
+    case Metric::MSE:
+        return "Mean Squared Error";
+    case Metric::RMSE:
+        return "Relative Mean Squared Error";
+    case Metric::MAE:
+        return "Mean Absolute Error";
+    case Metric::MAPE:
+        return "Mean Absolute Percentage Error";
+    default:
+        FALCOR_UNREACHABLE();
+        return "";
+    }
+}
+
+double ImageCompare::compare(const Image& imageA, const Image& imageB, Metric metric, bool alpha, float* errorMap)
+{
+    checkArgument(
+        imageA.getWidth() == imageB.getWidth() && imageA.getHeight() == imageB.getHeight(), "Cannot compare images with different resolutions."
+    );
+
+    switch (metric)
+    {
+    case Metric::MSE:
+        return compareImages<MSE>(imageA, imageB, alpha, errorMap);
+    case Metric::RMSE:
+        return compareImages<RMSE>(imageA, imageB, alpha, errorMap);
+    case Metric::MAE:
+        return compareImages<MAE>(imageA, imageB, alpha, errorMap);
+    case Metric::MAPE:
+        return compareImages<MAPE>(imageA, imageB, alpha, errorMap);
+    default:
+        FALCOR_UNREACHABLE();
+        return 0.0;
+    }
+}
+
+std::shared_ptr<ImageCompare::Image> ImageCompare::generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
+{
+    auto writeColor = [](float t, float* dst)
+    {
+        static const float colors[5][3] = {
+            {0.f, 0.f, 1.f}, // blue
+            {0.f, 1.f, 1.f}, // teal
+            {0.f, 1.f, 0.f}, // green
+            {1.f, 1.f, 0.f}, // yellow
+            {1.f, 0.f, 0.f}, // red
+        };
+
+        int c = clamp(int(std::floor(t * 4.f)), 0, 3);
+        for (size_t i = 0; i < 3; ++i)
+            *dst++ = lerp(colors[c][i], colors[c + 1][i], t * 4.f - c);
+        *dst++ = 1.f;
+    };
+
+    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + width * height);
+    const float range = std::max(1e-5f, *maxValue - *minValue);
+    auto image = Image::create(width, height);
+    float* dst = image->getData();
+    for (size_t i = 0; i < width * height; ++i)
+    {
+        float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
+        writeColor(t, dst);
+        dst += 4;
+    }
+
+    return image;
+}
+
+ImageCompare::Result ImageCompare::compareFiles(const Job& job, Metric metric, float threshold, bool alpha)
+{
+    Result result;
+
+    // Load images.
+    std::shared_ptr<const Image> imageA;
+    std::shared_ptr<const Image> imageB;
+    try
+    {
+        imageA = Image::loadFromFile(job.reference);
+    }
+    catch (const std::exception& e)
+    {
+        result.message = fmt::format("Cannot load image from '{}' (Error: {}).", job.reference.string(), e.what());
+        return result;
+    }
+    try
+    {
+        imageB = Image::loadFromFile(job.result);
+    }
+    catch (const std::exception& e)
+    {
+        result.message = fmt::format("Cannot load image from '{}' (Error: {}).", job.result.string(), e.what());
+        return result;
+    }
+
+    // Check resolution.
+    if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
+    {
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
+    }
+
+    uint32_t width = imageA->getWidth();
+    uint32_t height = imageA->getHeight();
+
+    // Compare images.
+    std::unique_ptr<float[]> errorMap = job.heatMap.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.error = compare(*imageA, *imageB, metric, alpha, errorMap.get());
+    result.valid = true;
+
+    // Generate heat map.
+    if (errorMap)
+    {
+        try
+        {
+            generateHeatMap(width, height, errorMap.get())->saveToFile(job.heatMap);
+        }
+        catch (const std::exception& e)
+        {
+            result.message = fmt::format("Cannot save image to '{}' (Error: {}).", job.heatMap.string(), e.what());
+        }
+    }
+
+    // Treat nans and infs as errors.
+    result.success = std::isfinite(result.error) && result.error <= threshold;
+    return result;
+}
+
+std::vector<ImageCompare::Result> ImageCompare::compareFiles(const std::vector<Job>& jobs, Metric metric, float threshold, bool alpha)
+{
+    std::vector<Result> results(jobs.size());
+    NumericRange<size_t> range(0, jobs.size());
+    std::for_each(
+        std::execution::par, range.begin(), range.end(),
+        [&](size_t i) { results[i] = compareFiles(jobs[i], metric, threshold, alpha); }
+    );
+    return results;
+}
+
+std::vector<ImageCompare::SequenceResult> ImageCompare::compareSequences(
+    const std::filesystem::path& reference,
+    const std::filesystem::path& result,
+    Metric metric,
+    float threshold,
+    bool alpha
+)
+{
+    FrameSequenceFile referenceFile(reference);
+    FrameSequenceFile resultFile(result);
+
+    // Reference images are read in the order of the result file. Keep the last decoded image per output, so that
+    // sequences with the same frame order are decoded incrementally.
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> lastReference(referenceFile.getOutputCount(), {FrameSequenceFile::kInvalidIndex, {}});
+    std::vector<bool> visited(referenceFile.getImageCount(), false);
+
+    std::vector<SequenceResult> results;
+    resultFile.forEachImage(
+        [&](uint32_t image, const std::vector<uint8_t>& data)
+        {
+            const auto& desc = resultFile.getImage(image);
+            SequenceResult& sequenceResult = results.emplace_back();
+            sequenceResult.output = resultFile.getOutput(desc.output).name;
+            sequenceResult.frameID = desc.frameID;
+            Result& r = sequenceResult.result;
+
+            uint32_t referenceOutput = referenceFile.findOutput(sequenceResult.output);
+            uint32_t referenceImage = referenceOutput != FrameSequenceFile::kInvalidIndex
+                                          ? referenceFile.findImage(desc.frameID, referenceOutput)
+                                          : FrameSequenceFile::kInvalidIndex;
+            if (referenceImage == FrameSequenceFile::kInvalidIndex)
+            {
+                r.message = fmt::format("Output '{}' frame {} is missing in the reference.", sequenceResult.output, desc.frameID);
+                return;
+            }
+            visited[referenceImage] = true;
+
+            try
+            {
+                auto& [lastImage, lastData] = lastReference[referenceOutput];
+                const uint32_t prevImage = referenceFile.getImage(referenceImage).prevImage;
+                std::vector<uint8_t> referenceData(referenceFile.getImageByteSize(referenceImage));
+                referenceFile.readImage(
+                    referenceImage, referenceData.data(), prevImage != FrameSequenceFile::kInvalidIndex && prevImage == lastImage ? lastData.data() : nullptr
+                );
+
+                auto imageA = Image::loadFromSequence(referenceFile, referenceImage, referenceData);
+                auto imageB = Image::loadFromSequence(resultFile, image, data);
+                lastImage = referenceImage;
+                lastData = std::move(referenceData);
+
+                if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
+                {
+                    r.message = fmt::format("Output '{}' frame {} has a different size than the reference.", sequenceResult.output, desc.frameID);
+                    return;
+                }
+
+                r.error = compare(*imageA, *imageB, metric, alpha);
+                r.valid = true;
+                r.success = std::isfinite(r.error) && r.error <= threshold;
+            }
+            catch (const std::exception& e)
+            {
+                r.message = fmt::format("Cannot compare output '{}' frame {} (Error: {}).", sequenceResult.output, desc.frameID, e.what());
+            }
+        }
+    );
+
+    for (uint32_t image = 0; image < referenceFile.getImageCount(); ++image)
+    {
+        if (visited[image])
+            continue;
+        const auto& desc = referenceFile.getImage(image);
+        SequenceResult& sequenceResult = results.emplace_back();
+        sequenceResult.output = referenceFile.getOutput(desc.output).name;
+        sequenceResult.frameID = desc.frameID;
+        sequenceResult.result.message = fmt::format("Output '{}' frame {} is missing in the result.", sequenceResult.output, desc.frameID);
+    }
+
+    return results;
+}
+
+FALCOR_SCRIPT_BINDING(ImageCompare)
+{
+    using namespace pybind11::literals;
+
+    auto toPython = [](const ImageCompare::Result& result)
+    {
+        pybind11::dict d;
+        d["valid"] = result.valid;
+        d["success"] = result.success;
+        d["error"] = result.error;
+        d["message"] = result.message;
+        return d;
+    };
+
+    auto compareFile = [toPython](
+                           const std::filesystem::path& reference, const std::filesystem::path& result, const std::string& metric, float threshold,
+                           bool alpha, const std::filesystem::path& heatMap
+                       )
+    {
+        ImageCompare::Result r;
+        {
+            pybind11::gil_scoped_release release;
+            r = ImageCompare::compareFiles({reference, result, heatMap}, stringToEnum<ImageCompare::Metric>(metric), threshold, alpha);
+        }
+        return toPython(r);
+    };
+
+    auto compareFiles = [toPython](const pybind11::list& jobList, const std::string& metric, float threshold, bool alpha)
+    {
+        std::vector<ImageCompare::Job> jobs;
+        for (const auto& item : jobList)
+        {
+            auto t = item.cast<pybind11::tuple>();
+            ImageCompare::Job job;
+            job.reference = t[0].cast<std::filesystem::path>();
+            job.result = t[1].cast<std::filesystem::path>();
+            if (t.size() > 2 && !t[2].is_none())
+                job.heatMap = t[2].cast<std::filesystem::path>();
+            jobs.push_back(std::move(job));
+        }
+
+        std::vector<ImageCompare::Result> results;
+        {
+            pybind11::gil_scoped_release release;
+            results = ImageCompare::compareFiles(jobs, stringToEnum<ImageCompare::Metric>(metric), threshold, alpha);
+        }
+
+        pybind11::list pyResults;
+        for (const auto& r : results)
+            pyResults.append(toPython(r));
+        return pyResults;
+    };
+
+    pybind11::class_<ImageCompare> imageCompare(m, "ImageCompare");
+    imageCompare.def_static(
+        "compare_file", compareFile, "reference"_a, "result"_a, "metric"_a = "mse", "threshold"_a = 0.f, "alpha"_a = false,
+        "heat_map"_a = std::filesystem::path()
+    );
+    imageCompare.def_static("compare_files", compareFiles, "jobs"_a, "metric"_a = "mse", "threshold"_a = 0.f, "alpha"_a = false);
+    auto compareSequences = [toPython](
+                                const std::filesystem::path& reference, const std::filesystem::path& result, const std::string& metric,
+                                float threshold, bool alpha
+                            )
+    {
+        std::vector<ImageCompare::SequenceResult> results;
+        {
+            pybind11::gil_scoped_release release;
+            results = ImageCompare::compareSequences(reference, result, stringToEnum<ImageCompare::Metric>(metric), threshold, alpha);
+        }
+
+        pybind11::list pyResults;
+        for (const auto& r : results)
+        {
+            pybind11::dict d = toPython(r.result);
+            d["output"] = r.output;
+            d["frame"] = r.frameID;
+            pyResults.append(d);
+        }
+        return pyResults;
+    };
+
+    imageCompare.def_static(
+        "compare_sequences", compareSequences, "reference"_a, "result"_a, "metric"_a = "mse", "threshold"_a = 0.f, "alpha"_a = false
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,182 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Enum.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+class FrameSequenceFile;
+
+/**
+ * Image comparison with the error metrics used by the image tests.
+ *
+ * This is the implementation behind the ImageCompare tool. It is also exposed to Python, so the image test runner
+ * can compare whole directories in-process. Batches of comparisons run in parallel.
+ */
+class FALCOR_API ImageCompare
+{
+public:
+    enum class Metric
+    {
+        MSE,  ///< Mean Squared Error.
+        RMSE, ///< Relative Mean Squared Error.
+        MAE,  ///< Mean Absolute Error.
+        MAPE, ///< Mean Absolute Percentage Error.
+    };
+
+    FALCOR_ENUM_INFO(
+        Metric,
+        {
+            {Metric::MSE, "mse"},
+            {Metric::RMSE, "rmse"},
+            {Metric::MAE, "mae"},
+            {Metric::MAPE, "mape"},
+        }
+    );
+
+    /// RGBA32F image stored top-down.
+    class FALCOR_API Image
+    {
+    public:
+        Image(uint32_t width, uint32_t height);
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+        const float* getData() const { return mData.get(); }
+        float* getData() { return mData.get(); }
+
+        /// Get the size of the pixel data in bytes.
+        size_t getByteSize() const { return size_t(mWidth) * mHeight * 4 * sizeof(float); }
+
+        static std::shared_ptr<Image> create(uint32_t width, uint32_t height) { return std::make_shared<Image>(width, height); }
+
+        /**
+         * Load an image. Throws a RuntimeError if the image cannot be loaded.
+         */
+        static std::shared_ptr<Image> loadFromFile(const std::filesystem::path& path);
+
+        /**
+         * Create an image from decoded frame sequence data. Throws a RuntimeError if the format cannot be converted.
+         */
+        static std::shared_ptr<Image> loadFromSequence(const FrameSequenceFile& file, uint32_t image, const std::vector<uint8_t>& data);
+
+        /**
+         * Save an image. Alpha is only written to EXR and PNG files. Throws a RuntimeError if the image cannot be saved.
+         */
+        void saveToFile(const std::filesystem::path& path, bool writeAlpha = true) const;
+
+    private:
+        uint32_t mWidth;
+        uint32_t mHeight;
+        std::unique_ptr<float[]> mData;
+    };
+
+    struct Result
+    {
+        bool valid = false;   ///< True if the images were loaded and compared.
+        bool success = false; ///< True if the error is finite and within the threshold.
+        double error = 0.0;
+        std::string message; ///< Error message if loading the images or saving the heat map failed.
+    };
+
+    struct SequenceResult
+    {
+        std::string output;
+        uint64_t frameID = 0;
+        Result result;
+    };
+
+    struct Job
+    {
+        std::filesystem::path reference;
+        std::filesystem::path result;
+        std::filesystem::path heatMap; ///< Optional error heat map output.
+    };
+
+    /**
+     * Get a description of a metric.
+     */
+    static const char* getMetricDescription(Metric metric);
+
+    /**
+     * Compute the average per-pixel error between two images of the same size.
+     * @param[in] imageA First image.
+     * @param[in] imageB Second image.
+     * @param[in] metric Error metric.
+     * @param[in] alpha Include the alpha channel.
+     * @param[out] errorMap Optional per-pixel errors (width * height values).
+     * @return Average error.
+     */
+    static double compare(const Image& imageA, const Image& imageB, Metric metric, bool alpha, float* errorMap = nullptr);
+
+    /**
+     * Generate a heat map image from per-pixel errors, normalized to the error range.
+     */
+    static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap);
+
+    /**
+     * Compare two image files.
+     * @param[in] job Reference and result image paths, and optional heat map path.
+     * @param[in] metric Error metric.
+     * @param[in] threshold Maximum error for the comparison to succeed.
+     * @param[in] alpha Include the alpha channel.
+     */
+    static Result compareFiles(const Job& job, Metric metric, float threshold, bool alpha);
+
+    /**
+     * Compare a batch of image files in parallel.
+     */
+    static std::vector<Result> compareFiles(const std::vector<Job>& jobs, Metric metric, float threshold, bool alpha);
+
+    /**
+     * Compare all images of two frame sequence files, matched by output name and frame.
+     * Images that only exist in one of the files are reported as invalid results.
+     * @param[in] reference Reference sequence file.
+     * @param[in] result Result sequence file.
+     * @param[in] metric Error metric.
+     * @param[in] threshold Maximum error for a comparison to succeed.
+     * @param[in] alpha Include the alpha channel.
+     * @return Results in the order of the images in the result file, followed by images missing from the result file.
+     */
+    static std::vector<SequenceResult> compareSequences(
+        const std::filesystem::path& reference,
+        const std::filesystem::path& result,
+        Metric metric,
+        float threshold,
+        bool alpha
+    );
+};
+
+FALCOR_ENUM_REGISTER(ImageCompare::Metric);
+} // namespace Falcor
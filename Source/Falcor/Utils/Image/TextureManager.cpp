@@ -27,8 +27,10 @@
  **************************************************************************/
 #include "TextureManager.h"
 #include "Core/API/Device.h"
+#include "Utils/AsyncFileReader.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Timing/TraceRecorder.h"
 
 #include <execution>
 
@@ -361,6 +363,7 @@ void TextureManager::beginDeferredLoading()
 
 void TextureManager::endDeferredLoading()
 {
+    FALCOR_TRACE_SCOPE("TextureManager::endDeferredLoading");
     struct Job
     {
         TextureKey key;
@@ -381,6 +384,14 @@ void TextureManager::endDeferredLoading()
     if (jobs.empty())
         return;
 
+    // Issue read-ahead for all texture files so that disk I/O overlaps with decoding.
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& job : jobs)
+            paths.insert(paths.end(), job.key.fullPaths.begin(), job.key.fullPaths.end());
+        AsyncFileReader::prefetch(paths);
+    }
+
     // Load textures in parallel.
     std::atomic<size_t> texturesLoaded;
     NumericRange<size_t> jobRange(0, jobs.size());
@@ -388,6 +399,7 @@ void TextureManager::endDeferredLoading()
         std::execution::par_unseq, jobRange.begin(), jobRange.end(),
         [&](size_t i)
         {
+            FALCOR_TRACE_SCOPE("Load texture");
             const auto& job = jobs[i];
             auto& desc = getDesc(job.handle);
             if (job.key.fullPaths.size() == 1)
@@ -0,0 +1,1069 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "NumpyArray.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Logger.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/StringFormatters.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <numeric>
+
+namespace Falcor
+{
+namespace
+{
+const char kMagic[] = "\x93NUMPY";
+const size_t kMagicSize = 6;
+const size_t kHeaderAlignment = 64;
+
+// Falcor only runs on little-endian platforms.
+const char kNativeByteOrder = '<';
+
+struct DTypeInfo
+{
+    NumpyDType dtype;
+    char kind;
+    size_t size;
+};
+
+// clang-format off
+const DTypeInfo kDTypeInfo[] = {
+    { NumpyDType::Bool,       'b', 1  },
+    { NumpyDType::Int8,       'i', 1  },
+    { NumpyDType::UInt8,      'u', 1  },
+    { NumpyDType::Int16,      'i', 2  },
+    { NumpyDType::UInt16,     'u', 2  },
+    { NumpyDType::Int32,      'i', 4  },
+    { NumpyDType::UInt32,     'u', 4  },
+    { NumpyDType::Int64,      'i', 8  },
+    { NumpyDType::UInt64,     'u', 8  },
+    { NumpyDType::Float16,    'f', 2  },
+    { NumpyDType::Float32,    'f', 4  },
+    { NumpyDType::Float64,    'f', 8  },
+    { NumpyDType::Complex64,  'c', 8  },
+    { NumpyDType::Complex128, 'c', 16 },
+};
+// clang-format on
+
+const DTypeInfo& getDTypeInfo(NumpyDType dtype)
+{
+    FALCOR_ASSERT(kDTypeInfo[(size_t)dtype].dtype == dtype);
+    return kDTypeInfo[(size_t)dtype];
+}
+
+bool findDType(char kind, size_t size, NumpyDType& dtype)
+{
+    for (const auto& info : kDTypeInfo)
+    {
+        if (info.kind == kind && info.size == size)
+        {
+            dtype = info.dtype;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t getElementCount(const std::vector<size_t>& shape)
+{
+    return std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+}
+
+struct Header
+{
+    NumpyDType dtype = NumpyDType::Float32;
+    bool swapBytes = false;
+    bool fortranOrder = false;
+    std::vector<size_t> shape;
+};
+
+std::string formatShape(const std::vector<size_t>& shape)
+{
+    std::string s = "(";
+    for (size_t dim : shape)
+        s += std::to_string(dim) + ", ";
+    if (shape.size() > 1)
+        s.resize(s.size() - 2);
+    else if (shape.size() == 1)
+        s.pop_back();
+    return s + ")";
+}
+
+/**
+ * Build a complete header including magic and version. The size is a multiple of kHeaderAlignment and at least minSize.
+ */
+std::string buildHeader(NumpyDType dtype, bool fortranOrder, const std::vector<size_t>& shape, size_t minSize = 0)
+{
+    std::string dict = fmt::format(
+        "{{'descr': '{}', 'fortran_order': {}, 'shape': {}, }}", getNumpyDTypeDescr(dtype), fortranOrder ? "True" : "False",
+        formatShape(shape)
+    );
+
+    // Version 1.0 stores the header length in 16 bits, version 2.0 in 32 bits.
+    size_t prefixSize = kMagicSize + 2 + 2;
+    size_t size = prefixSize + dict.size() + 1;
+    if (size > std::numeric_limits<uint16_t>::max())
+    {
+        prefixSize += 2;
+        size += 2;
+    }
+    size = std::max((size + kHeaderAlignment - 1) / kHeaderAlignment * kHeaderAlignment, minSize);
+    dict.append(size - prefixSize - dict.size() - 1, ' ');
+    dict += '\n';
+
+    std::string header(kMagic, kMagicSize);
+    const uint32_t dictSize = (uint32_t)dict.size();
+    if (prefixSize == kMagicSize + 4)
+    {
+        header += '\x01';
+        header += '\x00';
+        header += char(dictSize & 0xff);
+        header += char(dictSize >> 8);
+    }
+    else
+    {
+        header += '\x02';
+        header += '\x00';
+        for (int i = 0; i < 4; ++i)
+            header += char((dictSize >> (8 * i)) & 0xff);
+    }
+    return header + dict;
+}
+
+/**
+ * Find the value of a key in the header dictionary.
+ */
+std::string_view findValue(std::string_view dict, std::string_view key)
+{
+    for (char quote : {'\'', '"'})
+    {
+        std::string quotedKey = quote + std::string(key) + quote;
+        size_t pos = dict.find(quotedKey);
+        if (pos == std::string_view::npos)
+            continue;
+        pos = dict.find(':', pos + quotedKey.size());
+        if (pos == std::string_view::npos)
+            break;
+        ++pos;
+        while (pos < dict.size() && std::isspace((unsigned char)dict[pos]))
+            ++pos;
+        if (pos >= dict.size())
+            break;
+
+        size_t end;
+        if (dict[pos] == '\'' || dict[pos] == '"')
+            end = dict.find(dict[pos], pos + 1) + 1;
+        else if (dict[pos] == '(')
+            end = dict.find(')', pos) + 1;
+        else
+            end = dict.find_first_of(",}", pos);
+        if (end == std::string_view::npos || end == 0)
+            break;
+        return dict.substr(pos, end - pos);
+    }
+    throw RuntimeError("Missing or malformed '{}' in header.", key);
+}
+
+/**
+ * Parse the header at the start of a .npy file.
+ * @return Size of the header in bytes, i.e., the offset of the array data.
+ */
+size_t parseHeader(const uint8_t* pData, size_t size, Header& header)
+{
+    if (size < kMagicSize + 4 || std::memcmp(pData, kMagic, kMagicSize) != 0)
+        throw RuntimeError("Not a NumPy file.");
+
+    const uint8_t major = pData[kMagicSize];
+    size_t dictOffset;
+    size_t dictSize;
+    if (major == 1)
+    {
+        dictOffset = kMagicSize + 4;
+        dictSize = pData[8] | (pData[9] << 8);
+    }
+    else if (major == 2 || major == 3)
+    {
+        if (size < kMagicSize + 6)
+            throw RuntimeError("Truncated header.");
+        dictOffset = kMagicSize + 6;
+        dictSize = pData[8] | (pData[9] << 8) | (pData[10] << 16) | (size_t(pData[11]) << 24);
+    }
+    else
+    {
+        throw RuntimeError("Unsupported format version {}.", major);
+    }
+    if (dictOffset + dictSize > size)
+        throw RuntimeError("Truncated header.");
+
+    std::string_view dict(reinterpret_cast<const char*>(pData + dictOffset), dictSize);
+
+    // Type descriptor, e.g. '<f4'.
+    std::string_view descr = findValue(dict, "descr");
+    if (descr.size() < 5)
+        throw RuntimeError("Unsupported type descriptor {}.", descr);
+    const char byteOrder = descr[1];
+    const char kind = descr[2];
+    const size_t itemSize = std::strtoul(std::string(descr.substr(3, descr.size() - 4)).c_str(), nullptr, 10);
+    if (!findDType(kind, itemSize, header.dtype))
+        throw RuntimeError("Unsupported type descriptor {}.", descr);
+    if (byteOrder == '>')
+        header.swapBytes = itemSize > 1;
+    else if (byteOrder != '<' && byteOrder != '|' && byteOrder != '=')
+        throw RuntimeError("Unsupported type descriptor {}.", descr);
+
+    std::string_view fortranOrder = findValue(dict, "fortran_order");
+    header.fortranOrder = fortranOrder.substr(0, 4) == "True";
+
+    // Shape tuple, e.g. (), (3,) or (2, 3).
+    std::string_view shape = findValue(dict, "shape");
+    header.shape.clear();
+    size_t pos = 1;
+    while (pos < shape.size())
+    {
+        while (pos < shape.size() && !std::isdigit((unsigned char)shape[pos]))
+            ++pos;
+        if (pos >= shape.size())
+            break;
+        size_t end = pos;
+        while (end < shape.size() && std::isdigit((unsigned char)shape[end]))
+            ++end;
+        header.shape.push_back(std::stoull(std::string(shape.substr(pos, end - pos))));
+        pos = end;
+    }
+
+    return dictOffset + dictSize;
+}
+
+void swapBytes(uint8_t* pData, size_t count, size_t wordSize)
+{
+    for (size_t i = 0; i < count; ++i, pData += wordSize)
+        std::reverse(pData, pData + wordSize);
+}
+
+/**
+ * File contents, either memory mapped or read into memory.
+ */
+struct FileData
+{
+    std::shared_ptr<MemoryMappedFile> pMappedFile;
+    std::vector<uint8_t> buffer;
+
+    FileData(const std::filesystem::path& path, bool memoryMap)
+    {
+        if (memoryMap)
+        {
+            pMappedFile = std::make_shared<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+            if (!pMappedFile->isOpen())
+                throw RuntimeError("Failed to open '{}'.", path);
+        }
+        else
+        {
+            std::ifstream stream(path, std::ios::binary | std::ios::ate);
+            if (!stream)
+                throw RuntimeError("Failed to open '{}'.", path);
+            buffer.resize((size_t)stream.tellg());
+            stream.seekg(0);
+            if (!stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+                throw RuntimeError("Failed to read '{}'.", path);
+        }
+    }
+
+    const uint8_t* data() const { return pMappedFile ? static_cast<const uint8_t*>(pMappedFile->getData()) : buffer.data(); }
+    size_t size() const { return pMappedFile ? pMappedFile->getSize() : buffer.size(); }
+};
+
+template<typename T>
+T readLE(const uint8_t* pData)
+{
+    T value;
+    std::memcpy(&value, pData, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void writeLE(std::ostream& stream, T value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Write the array data in storage order.
+ */
+void writeData(std::ostream& stream, const NumpyArray& array)
+{
+    stream.write(static_cast<const char*>(array.getData()), array.getByteSize());
+}
+
+void computeStrides(const std::vector<size_t>& shape, size_t itemSize, bool fortranOrder, std::vector<size_t>& strides)
+{
+    strides.resize(shape.size());
+    size_t stride = itemSize;
+    for (size_t i = 0; i < shape.size(); ++i)
+    {
+        size_t dim = fortranOrder ? i : shape.size() - 1 - i;
+        strides[dim] = stride;
+        stride *= shape[dim];
+    }
+}
+} // namespace
+
+size_t getNumpyDTypeSize(NumpyDType dtype)
+{
+    return getDTypeInfo(dtype).size;
+}
+
+std::string getNumpyDTypeDescr(NumpyDType dtype)
+{
+    const auto& info = getDTypeInfo(dtype);
+    return std::string(1, info.size == 1 ? '|' : kNativeByteOrder) + info.kind + std::to_string(info.size);
+}
+
+bool findNumpyDType(ResourceFormat format, NumpyDType& dtype)
+{
+    if (format == ResourceFormat::Unknown || isCompressedFormat(format))
+        return false;
+
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const uint32_t channelBits = getNumChannelBits(format, 0);
+    for (uint32_t i = 1; i < channelCount; ++i)
+    {
+        if (getNumChannelBits(format, i) != channelBits)
+            return false;
+    }
+    if (channelBits % 8 != 0 || getFormatBytesPerBlock(format) != channelCount * channelBits / 8)
+        return false;
+
+    char kind = 'u';
+    switch (getFormatType(format))
+    {
+    case FormatType::Float:
+        kind = 'f';
+        break;
+    case FormatType::Sint:
+    case FormatType::Snorm:
+        kind = 'i';
+        break;
+    default:
+        break;
+    }
+    return findDType(kind, channelBits / 8, dtype);
+}
+
+NumpyArray::NumpyArray(NumpyDType dtype, std::vector<size_t> shape, bool fortranOrder)
+    : mDType(dtype), mShape(std::move(shape)), mFortranOrder(fortranOrder)
+{
+    // Allocate at least one byte, so the data pointer of empty arrays is valid too.
+    auto pStorage = std::make_shared<std::vector<uint8_t>>(std::max(getByteSize(), size_t(1)));
+    mpData = pStorage->data();
+    mpStorage = std::move(pStorage);
+}
+
+NumpyArray::NumpyArray(
+    NumpyDType dtype,
+    std::vector<size_t> shape,
+    bool fortranOrder,
+    void* pData,
+    size_t byteSize,
+    std::shared_ptr<void> pStorage,
+    bool readOnly
+)
+    : mDType(dtype), mShape(std::move(shape)), mFortranOrder(fortranOrder), mReadOnly(readOnly), mpData(pData), mpStorage(std::move(pStorage))
+{
+    checkArgument(byteSize == getByteSize(), "Data size ({} bytes) does not match the array shape {} ({} bytes).", byteSize, formatShape(mShape), getByteSize());
+}
+
+size_t NumpyArray::getElementCount() const
+{
+    return Falcor::getElementCount(mShape);
+}
+
+void* NumpyArray::getMutableData()
+{
+    if (mReadOnly)
+        throw RuntimeError("Array is a read-only view into a memory mapped file.");
+    return mpData;
+}
+
+void NumpyArray::checkDType(NumpyDType dtype) const
+{
+    if (dtype != mDType)
+        throw RuntimeError("Array has element type '{}', expected '{}'.", getNumpyDTypeDescr(mDType), getNumpyDTypeDescr(dtype));
+}
+
+NumpyArray NumpyArray::toCOrder() const
+{
+    if (!mFortranOrder || mShape.size() <= 1)
+        return *this;
+
+    NumpyArray result(mDType, mShape, false);
+    const size_t itemSize = getItemSize();
+    const size_t count = getElementCount();
+    if (count == 0)
+        return result;
+
+    std::vector<size_t> strides;
+    computeStrides(mShape, itemSize, true, strides);
+
+    // Walk the destination in C order and keep the source offset up to date incrementally.
+    const uint8_t* pSrc = static_cast<const uint8_t*>(mpData);
+    uint8_t* pDst = static_cast<uint8_t*>(result.mpData);
+    const size_t lastDim = mShape.size() - 1;
+    const size_t rowLength = mShape[lastDim];
+    const size_t rowStride = strides[lastDim];
+    std::vector<size_t> index(mShape.size(), 0);
+    size_t srcOffset = 0;
+    for (size_t row = 0; row < count / rowLength; ++row)
+    {
+        const uint8_t* pRow = pSrc + srcOffset;
+        for (size_t i = 0; i < rowLength; ++i, pDst += itemSize)
+            std::memcpy(pDst, pRow + i * rowStride, itemSize);
+
+        for (size_t dim = lastDim; dim-- > 0;)
+        {
+            srcOffset += strides[dim];
+            if (++index[dim] < mShape[dim])
+                break;
+            srcOffset -= index[dim] * strides[dim];
+            index[dim] = 0;
+        }
+    }
+    return result;
+}
+
+NumpyArray NumpyArray::copy() const
+{
+    NumpyArray result(mDType, mShape, mFortranOrder);
+    if (mpData)
+        std::memcpy(result.mpData, mpData, getByteSize());
+    return result;
+}
+
+NumpyArray NumpyArray::load(const std::filesystem::path& path, bool memoryMap)
+{
+    try
+    {
+        auto pFile = std::make_shared<FileData>(path, memoryMap);
+
+        Header header;
+        const size_t dataOffset = parseHeader(pFile->data(), pFile->size(), header);
+        const size_t byteSize = Falcor::getElementCount(header.shape) * getNumpyDTypeSize(header.dtype);
+        if (dataOffset + byteSize > pFile->size())
+            throw RuntimeError("File is truncated.");
+
+        // Return a view into the mapped file if the data can be used as is.
+        const uint8_t* pData = pFile->data() + dataOffset;
+        if (memoryMap && !header.swapBytes && dataOffset % getNumpyDTypeSize(header.dtype) == 0)
+        {
+            return NumpyArray(header.dtype, header.shape, header.fortranOrder, const_cast<uint8_t*>(pData), byteSize, pFile, true);
+        }
+
+        NumpyArray array(header.dtype, header.shape, header.fortranOrder);
+        std::memcpy(array.mpData, pData, byteSize);
+        if (header.swapBytes)
+        {
+            const size_t wordSize = header.dtype == NumpyDType::Complex64 || header.dtype == NumpyDType::Complex128 ? array.getItemSize() / 2 : array.getItemSize();
+            swapBytes(static_cast<uint8_t*>(array.mpData), byteSize / wordSize, wordSize);
+        }
+        return array;
+    }
+    catch (const RuntimeError& e)
+    {
+        throw RuntimeError("Failed to load NumPy array from '{}': {}", path, e.what());
+    }
+}
+
+void NumpyArray::save(const std::filesystem::path& path) const
+{
+    checkArgument(isValid(), "Cannot save an invalid array.");
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        throw RuntimeError("Failed to create '{}'.", path);
+
+    const std::string header = buildHeader(mDType, mFortranOrder, mShape);
+    stream.write(header.data(), header.size());
+    writeData(stream, *this);
+    if (!stream)
+        throw RuntimeError("Failed to write NumPy array to '{}'.", path);
+}
+
+std::map<std::string, NumpyArray> NumpyArray::loadArchive(const std::filesystem::path& path, bool memoryMap)
+{
+    const uint32_t kLocalHeaderSignature = 0x04034b50;
+    const uint32_t kCentralHeaderSignature = 0x02014b50;
+    const uint32_t kEndOfCentralDirSignature = 0x06054b50;
+    const uint32_t kZip64Marker = 0xffffffff;
+
+    std::map<std::string, NumpyArray> arrays;
+    try
+    {
+        // Archives are always mapped, only uncompressed entries are returned as views though.
+        auto pFile = std::make_shared<FileData>(path, true);
+        const uint8_t* pBase = pFile->data();
+        const size_t size = pFile->size();
+
+        // Find the end of central directory record. It is followed by a comment of up to 64 kB.
+        const size_t kEndRecordSize = 22;
+        if (size < kEndRecordSize)
+            throw RuntimeError("Not a zip archive.");
+        size_t endRecord = size - kEndRecordSize;
+        const size_t searchEnd = size > kEndRecordSize + 0xffff ? size - kEndRecordSize - 0xffff : 0;
+        while (readLE<uint32_t>(pBase + endRecord) != kEndOfCentralDirSignature)
+        {
+            if (endRecord == searchEnd)
+                throw RuntimeError("Not a zip archive.");
+            --endRecord;
+        }
+
+        const uint16_t entryCount = readLE<uint16_t>(pBase + endRecord + 10);
+        const uint32_t centralDirOffset = readLE<uint32_t>(pBase + endRecord + 16);
+        if (centralDirOffset == kZip64Marker)
+            throw RuntimeError("Zip64 archives with more than 4 GB of entries are not supported.");
+
+        size_t offset = centralDirOffset;
+        for (uint16_t i = 0; i < entryCount; ++i)
+        {
+            if (offset + 46 > size || readLE<uint32_t>(pBase + offset) != kCentralHeaderSignature)
+                throw RuntimeError("Corrupt central directory.");
+
+            const uint16_t method = readLE<uint16_t>(pBase + offset + 10);
+            uint64_t compressedSize = readLE<uint32_t>(pBase + offset + 20);
+            uint64_t uncompressedSize = readLE<uint32_t>(pBase + offset + 24);
+            const uint16_t nameLength = readLE<uint16_t>(pBase + offset + 28);
+            const uint16_t extraLength = readLE<uint16_t>(pBase + offset + 30);
+            const uint16_t commentLength = readLE<uint16_t>(pBase + offset + 32);
+            uint64_t localHeaderOffset = readLE<uint32_t>(pBase + offset + 42);
+            std::string name(reinterpret_cast<const char*>(pBase + offset + 46), nameLength);
+
+            // Sizes and offsets that do not fit into 32 bits are stored in the zip64 extra field, in this order.
+            const uint8_t* pExtra = pBase + offset + 46 + nameLength;
+            const uint8_t* pExtraEnd = pExtra + extraLength;
+            while (pExtra + 4 <= pExtraEnd)
+            {
+                const uint16_t id = readLE<uint16_t>(pExtra);
+                const uint16_t fieldSize = readLE<uint16_t>(pExtra + 2);
+                const uint8_t* pField = pExtra + 4;
+                if (id == 0x0001)
+                {
+                    for (uint64_t* pValue : {&uncompressedSize, &compressedSize, &localHeaderOffset})
+                    {
+                        if (*pValue == kZip64Marker && pField + 8 <= pExtra + 4 + fieldSize)
+                        {
+                            *pValue = readLE<uint64_t>(pField);
+                            pField += 8;
+                        }
+                    }
+                }
+                pExtra += 4 + fieldSize;
+            }
+            offset += 46 + nameLength + extraLength + commentLength;
+
+            if (localHeaderOffset + 30 > size || readLE<uint32_t>(pBase + localHeaderOffset) != kLocalHeaderSignature)
+                throw RuntimeError("Corrupt local header of '{}'.", name);
+            const size_t dataOffset = localHeaderOffset + 30 + readLE<uint16_t>(pBase + localHeaderOffset + 26) +
+                                      readLE<uint16_t>(pBase + localHeaderOffset + 28);
+            if (dataOffset + compressedSize > size)
+                throw RuntimeError("Entry '{}' is truncated.", name);
+
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0)
+                name.resize(name.size() - 4);
+
+            const uint8_t* pEntry = pBase + dataOffset;
+            std::shared_ptr<std::vector<uint8_t>> pInflated;
+            if (method == 8)
+            {
+                pInflated = std::make_shared<std::vector<uint8_t>>(uncompressedSize);
+                z_stream zs = {};
+                if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+                    throw RuntimeError("Failed to initialize zlib.");
+                zs.next_in = const_cast<Bytef*>(pEntry);
+                zs.avail_in = (uInt)compressedSize;
+                zs.next_out = pInflated->data();
+                zs.avail_out = (uInt)uncompressedSize;
+                int result = inflate(&zs, Z_FINISH);
+                inflateEnd(&zs);
+                if (result != Z_STREAM_END || zs.total_out != uncompressedSize)
+                    throw RuntimeError("Failed to inflate entry '{}'.", name);
+                pEntry = pInflated->data();
+            }
+            else if (method != 0)
+            {
+                throw RuntimeError("Entry '{}' uses unsupported compression method {}.", name, method);
+            }
+
+            Header header;
+            const size_t headerSize = parseHeader(pEntry, uncompressedSize, header);
+            const size_t byteSize = Falcor::getElementCount(header.shape) * getNumpyDTypeSize(header.dtype);
+            if (headerSize + byteSize > uncompressedSize)
+                throw RuntimeError("Entry '{}' is truncated.", name);
+            uint8_t* pData = const_cast<uint8_t*>(pEntry + headerSize);
+
+            if (pInflated && !header.swapBytes)
+            {
+                arrays[name] = NumpyArray(header.dtype, header.shape, header.fortranOrder, pData, byteSize, pInflated, false);
+            }
+            else if (memoryMap && !header.swapBytes && (dataOffset + headerSize) % getNumpyDTypeSize(header.dtype) == 0)
+            {
+                arrays[name] = NumpyArray(header.dtype, header.shape, header.fortranOrder, pData, byteSize, pFile, true);
+            }
+            else
+            {
+                NumpyArray array(header.dtype, header.shape, header.fortranOrder);
+                std::memcpy(array.mpData, pData, byteSize);
+                if (header.swapBytes)
+                {
+                    const size_t wordSize = header.dtype == NumpyDType::Complex64 || header.dtype == NumpyDType::Complex128 ? array.getItemSize() / 2 : array.getItemSize();
+                    swapBytes(static_cast<uint8_t*>(array.mpData), byteSize / wordSize, wordSize);
+                }
+                arrays[name] = std::move(array);
+            }
+        }
+    }
+    catch (const RuntimeError& e)
+    {
+        throw RuntimeError("Failed to load NumPy archive from '{}': {}", path, e.what());
+    }
+    return arrays;
+}
+
+void NumpyArray::saveArchive(const std::filesystem::path& path, const std::map<std::string, NumpyArray>& arrays, bool compress)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        throw RuntimeError("Failed to create '{}'.", path);
+
+    struct Entry
+    {
+        std::string name;
+        uint16_t method;
+        uint32_t crc;
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+        uint32_t offset;
+    };
+    std::vector<Entry> entries;
+
+    const uint64_t kMaxSize = std::numeric_limits<uint32_t>::max();
+    auto checkSize = [&](uint64_t value)
+    {
+        if (value >= kMaxSize)
+            throw RuntimeError("Failed to save NumPy archive to '{}': Archives larger than 4 GB are not supported.", path);
+        return (uint32_t)value;
+    };
+
+    // DOS date and time of 1980-01-01 00:00, as written by numpy.
+    const uint16_t kDosTime = 0;
+    const uint16_t kDosDate = (1 << 5) | 1;
+
+    for (const auto& [name, array] : arrays)
+    {
+        checkArgument(array.isValid(), "Cannot save invalid array '{}'.", name);
+
+        Entry entry;
+        entry.name = name + ".npy";
+        entry.method = compress ? 8 : 0;
+        entry.offset = checkSize((uint64_t)stream.tellp());
+
+        const std::string header = buildHeader(array.getDType(), array.isFortranOrder(), array.getShape());
+        const uint8_t* pData = static_cast<const uint8_t*>(array.getData());
+        const size_t byteSize = array.getByteSize();
+        entry.uncompressedSize = checkSize(header.size() + byteSize);
+        entry.crc = crc32(0, reinterpret_cast<const Bytef*>(header.data()), (uInt)header.size());
+        entry.crc = crc32(entry.crc, pData, (uInt)byteSize);
+
+        std::vector<uint8_t> compressed;
+        if (compress)
+        {
+            z_stream zs = {};
+            if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                throw RuntimeError("Failed to initialize zlib.");
+            compressed.resize(deflateBound(&zs, entry.uncompressedSize));
+            zs.next_out = compressed.data();
+            zs.avail_out = (uInt)compressed.size();
+            zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(header.data()));
+            zs.avail_in = (uInt)header.size();
+            int result = deflate(&zs, Z_NO_FLUSH);
+            if (result == Z_OK)
+            {
+                zs.next_in = const_cast<Bytef*>(pData);
+                zs.avail_in = (uInt)byteSize;
+                result = deflate(&zs, Z_FINISH);
+            }
+            deflateEnd(&zs);
+            if (result != Z_STREAM_END)
+                throw RuntimeError("Failed to deflate array '{}'.", name);
+            compressed.resize(zs.total_out);
+            entry.compressedSize = checkSize(compressed.size());
+        }
+        else
+        {
+            entry.compressedSize = entry.uncompressedSize;
+        }
+
+        writeLE<uint32_t>(stream, 0x04034b50);
+        writeLE<uint16_t>(stream, 20); // Version needed to extract.
+        writeLE<uint16_t>(stream, 0);  // Flags.
+        writeLE<uint16_t>(stream, entry.method);
+        writeLE<uint16_t>(stream, kDosTime);
+        writeLE<uint16_t>(stream, kDosDate);
+        writeLE<uint32_t>(stream, entry.crc);
+        writeLE<uint32_t>(stream, entry.compressedSize);
+        writeLE<uint32_t>(stream, entry.uncompressedSize);
+        writeLE<uint16_t>(stream, (uint16_t)entry.name.size());
+        writeLE<uint16_t>(stream, 0); // Extra field length.
+        stream.write(entry.name.data(), entry.name.size());
+
+        if (compress)
+        {
+            stream.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+        }
+        else
+        {
+            stream.write(header.data(), header.size());
+            writeData(stream, array);
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    const uint32_t centralDirOffset = checkSize((uint64_t)stream.tellp());
+    for (const auto& entry : entries)
+    {
+        writeLE<uint32_t>(stream, 0x02014b50);
+        writeLE<uint16_t>(stream, 20); // Version made by.
+        writeLE<uint16_t>(stream, 20); // Version needed to extract.
+        writeLE<uint16_t>(stream, 0);  // Flags.
+        writeLE<uint16_t>(stream, entry.method);
+        writeLE<uint16_t>(stream, kDosTime);
+        writeLE<uint16_t>(stream, kDosDate);
+        writeLE<uint32_t>(stream, entry.crc);
+        writeLE<uint32_t>(stream, entry.compressedSize);
+        writeLE<uint32_t>(stream, entry.uncompressedSize);
+        writeLE<uint16_t>(stream, (uint16_t)entry.name.size());
+        writeLE<uint16_t>(stream, 0); // Extra field length.
+        writeLE<uint16_t>(stream, 0); // Comment length.
+        writeLE<uint16_t>(stream, 0); // Disk number.
+        writeLE<uint16_t>(stream, 0); // Internal attributes.
+        writeLE<uint32_t>(stream, 0); // External attributes.
+        writeLE<uint32_t>(stream, entry.offset);
+        stream.write(entry.name.data(), entry.name.size());
+    }
+    const uint32_t centralDirSize = checkSize((uint64_t)stream.tellp() - centralDirOffset);
+
+    writeLE<uint32_t>(stream, 0x06054b50);
+    writeLE<uint16_t>(stream, 0); // Disk number.
+    writeLE<uint16_t>(stream, 0); // Disk with central directory.
+    writeLE<uint16_t>(stream, (uint16_t)entries.size());
+    writeLE<uint16_t>(stream, (uint16_t)entries.size());
+    writeLE<uint32_t>(stream, centralDirSize);
+    writeLE<uint32_t>(stream, centralDirOffset);
+    writeLE<uint16_t>(stream, 0); // Comment length.
+
+    if (!stream)
+        throw RuntimeError("Failed to write NumPy archive to '{}'.", path);
+}
+
+NumpyArray NumpyArray::fromBitmap(const Bitmap& bitmap)
+{
+    const ResourceFormat format = bitmap.getFormat();
+    NumpyDType dtype;
+    checkArgument(findNumpyDType(format, dtype), "Bitmap format {} is not supported.", to_string(format));
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const uint32_t channelBits = getNumChannelBits(format, 0);
+
+    const uint32_t width = bitmap.getWidth();
+    const uint32_t height = bitmap.getHeight();
+    NumpyArray array(dtype, {height, width, channelCount});
+    const size_t rowSize = (size_t)width * channelCount * (channelBits / 8);
+    uint8_t* pDst = static_cast<uint8_t*>(array.mpData);
+    for (uint32_t y = 0; y < height; ++y)
+        std::memcpy(pDst + y * rowSize, bitmap.getData() + (size_t)y * bitmap.getRowPitch(), rowSize);
+
+    switch (format)
+    {
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+        for (size_t i = 0; i < (size_t)width * height; ++i)
+            std::swap(pDst[i * 4 + 0], pDst[i * 4 + 2]);
+        break;
+    default:
+        break;
+    }
+    return array;
+}
+
+std::unique_ptr<const Bitmap> NumpyArray::toBitmap() const
+{
+    checkArgument(
+        mShape.size() == 2 || (mShape.size() == 3 && mShape[2] >= 1 && mShape[2] <= 4),
+        "Array of shape {} is not an image. Expected (height, width) or (height, width, channels).", formatShape(mShape)
+    );
+
+    const uint32_t height = (uint32_t)mShape[0];
+    const uint32_t width = (uint32_t)mShape[1];
+    const uint32_t channelCount = mShape.size() == 3 ? (uint32_t)mShape[2] : 1;
+    const uint32_t channelBits = (uint32_t)getItemSize() * 8;
+
+    FormatType formatType = FormatType::Unknown;
+    switch (mDType)
+    {
+    case NumpyDType::UInt8:
+    case NumpyDType::UInt16:
+        formatType = FormatType::Unorm;
+        break;
+    case NumpyDType::UInt32:
+        formatType = FormatType::Uint;
+        break;
+    case NumpyDType::Int8:
+    case NumpyDType::Int16:
+        formatType = FormatType::Snorm;
+        break;
+    case NumpyDType::Int32:
+        formatType = FormatType::Sint;
+        break;
+    case NumpyDType::Float16:
+    case NumpyDType::Float32:
+        formatType = FormatType::Float;
+        break;
+    default:
+        break;
+    }
+
+    auto findFormat = [&](uint32_t channels)
+    {
+        for (uint32_t i = 0; i < (uint32_t)ResourceFormat::Count; ++i)
+        {
+            ResourceFormat format = ResourceFormat(i);
+            if (getFormatType(format) != formatType || getFormatChannelCount(format) != channels || isCompressedFormat(format) ||
+                isDepthStencilFormat(format) || getFormatBytesPerBlock(format) != channels * channelBits / 8)
+                continue;
+            bool uniform = true;
+            for (uint32_t c = 0; c < channels; ++c)
+                uniform &= getNumChannelBits(format, c) == channelBits;
+            // Skip BGR formats, channels are stored in RGB order.
+            if (uniform && format != ResourceFormat::BGRA8Unorm && format != ResourceFormat::BGRX8Unorm)
+                return format;
+        }
+        return ResourceFormat::Unknown;
+    };
+
+    const NumpyArray array = toCOrder();
+    ResourceFormat format = findFormat(channelCount);
+    if (format != ResourceFormat::Unknown)
+        return Bitmap::create(width, height, format, static_cast<const uint8_t*>(array.mpData));
+
+    // Pad three channel images with an opaque alpha channel.
+    format = channelCount == 3 ? findFormat(4) : ResourceFormat::Unknown;
+    checkArgument(
+        format != ResourceFormat::Unknown, "No resource format for {} channels of type '{}'.", channelCount, getNumpyDTypeDescr(mDType)
+    );
+
+    const size_t itemSize = getItemSize();
+    std::vector<uint8_t> alpha(itemSize);
+    switch (mDType)
+    {
+    case NumpyDType::Float16:
+    {
+        uint16_t one = math::float16_t(1.f).toBits();
+        std::memcpy(alpha.data(), &one, itemSize);
+        break;
+    }
+    case NumpyDType::Float32:
+    {
+        float one = 1.f;
+        std::memcpy(alpha.data(), &one, itemSize);
+        break;
+    }
+    case NumpyDType::Int8:
+    case NumpyDType::Int16:
+    case NumpyDType::Int32:
+        std::fill(alpha.begin(), alpha.end(), uint8_t(0xff));
+        alpha.back() = 0x7f;
+        break;
+    default:
+        std::fill(alpha.begin(), alpha.end(), uint8_t(0xff));
+        break;
+    }
+
+    std::vector<uint8_t> padded((size_t)width * height * 4 * itemSize);
+    const uint8_t* pSrc = static_cast<const uint8_t*>(array.mpData);
+    for (size_t i = 0; i < (size_t)width * height; ++i)
+    {
+        std::memcpy(padded.data() + i * 4 * itemSize, pSrc + i * 3 * itemSize, 3 * itemSize);
+        std::memcpy(padded.data() + (i * 4 + 3) * itemSize, alpha.data(), itemSize);
+    }
+    return Bitmap::create(width, height, format, padded.data());
+}
+
+NumpyArray NumpyArray::fromPython(const pybind11::array& pyArray)
+{
+    const pybind11::dtype pyDType = pyArray.dtype();
+    NumpyDType dtype;
+    checkArgument(findDType(pyDType.kind(), (size_t)pyDType.itemsize(), dtype), "Unsupported NumPy element type.");
+
+    auto contiguous = pybind11::array::ensure(pyArray, pybind11::array::c_style);
+    if (!contiguous)
+        throw RuntimeError("Failed to convert NumPy array to C order.");
+
+    std::vector<size_t> shape(contiguous.ndim());
+    for (size_t i = 0; i < shape.size(); ++i)
+        shape[i] = (size_t)contiguous.shape(i);
+
+    NumpyArray array(dtype, std::move(shape));
+    std::memcpy(array.mpData, contiguous.data(), array.getByteSize());
+    if (pyDType.attr("byteorder").cast<std::string>() == ">" && array.getItemSize() > 1)
+    {
+        const size_t wordSize = dtype == NumpyDType::Complex64 || dtype == NumpyDType::Complex128 ? array.getItemSize() / 2 : array.getItemSize();
+        swapBytes(static_cast<uint8_t*>(array.mpData), array.getByteSize() / wordSize, wordSize);
+    }
+    return array;
+}
+
+pybind11::array NumpyArray::toPython() const
+{
+    checkArgument(isValid(), "Cannot convert an invalid array.");
+
+    std::vector<size_t> strides;
+    computeStrides(mShape, getItemSize(), mFortranOrder, strides);
+
+    // The capsule keeps the storage alive for as long as the NumPy array exists.
+    auto pStorage = new std::shared_ptr<void>(mpStorage);
+    pybind11::capsule owner(pStorage, [](void* p) { delete static_cast<std::shared_ptr<void>*>(p); });
+
+    pybind11::array result(pybind11::dtype(getNumpyDTypeDescr(mDType)), mShape, strides, mpData, owner);
+    if (mReadOnly)
+        result.attr("setflags")(pybind11::arg("write") = false);
+    return result;
+}
+
+NumpyArrayWriter::NumpyArrayWriter(const std::filesystem::path& path, NumpyDType dtype, std::vector<size_t> rowShape, size_t bufferSize)
+    : mPath(path), mDType(dtype), mRowShape(std::move(rowShape)), mBufferSize(std::max(bufferSize, size_t(1)))
+{
+    mRowElementCount = getElementCount(mRowShape);
+
+    // Reserve enough header space for the largest possible row count, so the header can be rewritten in place.
+    std::vector<size_t> maxShape = mRowShape;
+    maxShape.insert(maxShape.begin(), std::numeric_limits<size_t>::max());
+    mHeaderSize = buildHeader(mDType, false, maxShape).size();
+
+    mStream.open(path, std::ios::binary | std::ios::trunc);
+    if (!mStream)
+        throw RuntimeError("Failed to create '{}'.", path);
+    writeHeader();
+    mBuffer.reserve(mBufferSize);
+}
+
+NumpyArrayWriter::~NumpyArrayWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& e)
+    {
+        logError("Failed to close NumPy file '{}': {}", mPath, e.what());
+    }
+}
+
+void NumpyArrayWriter::checkAppend(NumpyDType dtype, size_t elementCount) const
+{
+    checkArgument(
+        dtype == mDType, "Element type '{}' does not match the array type '{}'.", getNumpyDTypeDescr(dtype), getNumpyDTypeDescr(mDType)
+    );
+    checkArgument(
+        mRowElementCount > 0 && elementCount % mRowElementCount == 0, "Element count {} is not a multiple of the row size {}.", elementCount,
+        mRowElementCount
+    );
+}
+
+void NumpyArrayWriter::append(const void* pData, size_t rowCount)
+{
+    if (!mStream.is_open())
+        throw RuntimeError("NumPy file '{}' is closed.", mPath);
+
+    const size_t byteSize = rowCount * mRowElementCount * getNumpyDTypeSize(mDType);
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+    if (mBuffer.size() + byteSize > mBufferSize)
+    {
+        mStream.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+        mBuffer.clear();
+    }
+    if (byteSize >= mBufferSize)
+        mStream.write(reinterpret_cast<const char*>(pBytes), byteSize);
+    else
+        mBuffer.insert(mBuffer.end(), pBytes, pBytes + byteSize);
+
+    mRowCount += rowCount;
+    if (!mStream)
+        throw RuntimeError("Failed to write to '{}'.", mPath);
+}
+
+void NumpyArrayWriter::writeHeader()
+{
+    std::vector<size_t> shape = mRowShape;
+    shape.insert(shape.begin(), mRowCount);
+    const std::string header = buildHeader(mDType, false, shape, mHeaderSize);
+    FALCOR_ASSERT(header.size() == mHeaderSize);
+
+    const auto end = mStream.tellp();
+    mStream.seekp(0);
+    mStream.write(header.data(), header.size());
+    if (end > std::streampos(mHeaderSize))
+        mStream.seekp(end);
+}
+
+void NumpyArrayWriter::flush()
+{
+    if (!mStream.is_open())
+        return;
+
+    mStream.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size());
+    mBuffer.clear();
+    writeHeader();
+    mStream.flush();
+    if (!mStream)
+        throw RuntimeError("Failed to write to '{}'.", mPath);
+}
+
+void NumpyArrayWriter::close()
+{
+    if (!mStream.is_open())
+        return;
+
+    flush();
+    mStream.close();
+}
+} // namespace Falcor
@@ -0,0 +1,369 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Utils/Math/Float16.h"
+
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace pybind11
+{
+class array;
+}
+
+namespace Falcor
+{
+class Bitmap;
+
+/**
+ * Element types of NumPy arrays.
+ */
+enum class NumpyDType : uint8_t
+{
+    Bool,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float16,
+    Float32,
+    Float64,
+    Complex64,
+    Complex128,
+};
+
+/**
+ * Get the size of an element in bytes.
+ */
+FALCOR_API size_t getNumpyDTypeSize(NumpyDType dtype);
+
+/**
+ * Get the NumPy type string (e.g. "<f4") for an element type in native byte order.
+ */
+FALCOR_API std::string getNumpyDTypeDescr(NumpyDType dtype);
+
+/**
+ * Get the element type of the channels of a resource format.
+ * @return False for compressed formats and formats with mixed or non byte-sized channels.
+ */
+FALCOR_API bool findNumpyDType(ResourceFormat format, NumpyDType& dtype);
+
+/**
+ * Get the element type matching a C++ type.
+ */
+template<typename T>
+constexpr NumpyDType getNumpyDType()
+{
+    // clang-format off
+    if constexpr (std::is_same_v<T, bool>) return NumpyDType::Bool;
+    else if constexpr (std::is_same_v<T, math::float16_t>) return NumpyDType::Float16;
+    else if constexpr (std::is_same_v<T, float>) return NumpyDType::Float32;
+    else if constexpr (std::is_same_v<T, double>) return NumpyDType::Float64;
+    else if constexpr (std::is_same_v<T, std::complex<float>>) return NumpyDType::Complex64;
+    else if constexpr (std::is_same_v<T, std::complex<double>>) return NumpyDType::Complex128;
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 1) return NumpyDType::Int8;
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 2) return NumpyDType::Int16;
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 4) return NumpyDType::Int32;
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) == 8) return NumpyDType::Int64;
+    else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 1) return NumpyDType::UInt8;
+    else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 2) return NumpyDType::UInt16;
+    else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 4) return NumpyDType::UInt32;
+    else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T> && sizeof(T) == 8) return NumpyDType::UInt64;
+    else static_assert(sizeof(T) == 0, "Type has no NumPy equivalent.");
+    // clang-format on
+}
+
+/**
+ * A NumPy array stored in a .npy file, or an entry of a .npz archive.
+ *
+ * Arrays either own their data, or are read-only views into a memory mapped file. Loading a .npy file
+ * (or an uncompressed .npz entry) in native byte order is zero-copy: the data is paged in on first access.
+ * Arrays are cheap to copy, copies share the same data.
+ *
+ * All element types of the NumPy format except objects and structured types are supported,
+ * in both C (row-major) and Fortran (column-major) order. Data stored in non-native byte order is
+ * converted when loading.
+ */
+class FALCOR_API NumpyArray
+{
+public:
+    /// Create an empty array.
+    NumpyArray() = default;
+
+    /**
+     * Create a zero-initialized array.
+     * @param[in] dtype Element type.
+     * @param[in] shape Array shape.
+     * @param[in] fortranOrder Store the elements in Fortran (column-major) order instead of C (row-major) order.
+     */
+    NumpyArray(NumpyDType dtype, std::vector<size_t> shape, bool fortranOrder = false);
+
+    /**
+     * Create an array by copying data.
+     * @param[in] pData Elements in C order.
+     * @param[in] shape Array shape.
+     */
+    template<typename T>
+    static NumpyArray fromData(const T* pData, std::vector<size_t> shape)
+    {
+        NumpyArray array(getNumpyDType<T>(), std::move(shape));
+        std::memcpy(array.mpData, pData, array.getByteSize());
+        return array;
+    }
+
+    /**
+     * Create an array taking ownership of a vector without copying it.
+     * @param[in] data Elements in C order. The size must match the shape.
+     * @param[in] shape Array shape.
+     */
+    template<typename T>
+    static NumpyArray fromVector(std::vector<T>&& data, std::vector<size_t> shape)
+    {
+        auto pStorage = std::make_shared<std::vector<T>>(std::move(data));
+        return NumpyArray(getNumpyDType<T>(), std::move(shape), false, pStorage->data(), pStorage->size() * sizeof(T), pStorage, false);
+    }
+
+    /**
+     * Load an array from a .npy file. Throws a RuntimeError on failure.
+     * @param[in] path File path.
+     * @param[in] memoryMap Map the file into memory instead of reading it. The returned array is read-only in this case.
+     */
+    static NumpyArray load(const std::filesystem::path& path, bool memoryMap = true);
+
+    /**
+     * Save the array to a .npy file. Throws a RuntimeError on failure.
+     */
+    void save(const std::filesystem::path& path) const;
+
+    /**
+     * Load all arrays from a .npz archive. Throws a RuntimeError on failure.
+     * @param[in] path File path.
+     * @param[in] memoryMap Map uncompressed entries into memory instead of reading them. Compressed entries are always inflated.
+     * @return Arrays by name, without the .npy extension.
+     */
+    static std::map<std::string, NumpyArray> loadArchive(const std::filesystem::path& path, bool memoryMap = true);
+
+    /**
+     * Save arrays to a .npz archive, as written by numpy.savez() or numpy.savez_compressed(). Throws a RuntimeError on failure.
+     * @param[in] path File path.
+     * @param[in] arrays Arrays by name.
+     * @param[in] compress Deflate the entries.
+     */
+    static void saveArchive(const std::filesystem::path& path, const std::map<std::string, NumpyArray>& arrays, bool compress = false);
+
+    /**
+     * Create an array of shape (height, width, channels) from a bitmap.
+     * The channels of BGR formats are reordered to RGB. Throws an ArgumentError for compressed formats
+     * or formats with mixed channel sizes.
+     */
+    static NumpyArray fromBitmap(const Bitmap& bitmap);
+
+    /**
+     * Create a bitmap from an array of shape (height, width) or (height, width, channels).
+     * 8 and 16-bit unsigned integers are interpreted as normalized values. Three channel arrays without a matching
+     * resource format are padded with an opaque alpha channel. Throws an ArgumentError if there is no matching resource format.
+     */
+    std::unique_ptr<const Bitmap> toBitmap() const;
+
+    /**
+     * Create an array from a NumPy array. The data is copied and converted to C order.
+     * Throws an ArgumentError for unsupported element types.
+     */
+    static NumpyArray fromPython(const pybind11::array& array);
+
+    /**
+     * Create a NumPy array. The returned array references this array's data without copying it.
+     */
+    pybind11::array toPython() const;
+
+    /// Returns true if the array has been created or loaded.
+    bool isValid() const { return mpStorage != nullptr; }
+    NumpyDType getDType() const { return mDType; }
+    const std::vector<size_t>& getShape() const { return mShape; }
+    size_t getDimensionCount() const { return mShape.size(); }
+    size_t getElementCount() const;
+    size_t getItemSize() const { return getNumpyDTypeSize(mDType); }
+    size_t getByteSize() const { return getElementCount() * getItemSize(); }
+    bool isFortranOrder() const { return mFortranOrder; }
+
+    /// Returns true if the array is a read-only view into a memory mapped file.
+    bool isReadOnly() const { return mReadOnly; }
+
+    const void* getData() const { return mpData; }
+
+    /// Get writable data. Throws a RuntimeError if the array is read-only.
+    void* getMutableData();
+
+    /**
+     * Get typed data. Throws a RuntimeError if the element type does not match.
+     */
+    template<typename T>
+    const T* data() const
+    {
+        checkDType(getNumpyDType<T>());
+        return static_cast<const T*>(mpData);
+    }
+
+    template<typename T>
+    T* mutableData()
+    {
+        checkDType(getNumpyDType<T>());
+        return static_cast<T*>(getMutableData());
+    }
+
+    /**
+     * Copy the elements into a vector in C order. Throws a RuntimeError if the element type does not match.
+     */
+    template<typename T>
+    std::vector<T> toVector() const
+    {
+        checkDType(getNumpyDType<T>());
+        const NumpyArray array = mFortranOrder ? toCOrder() : *this;
+        const T* pData = static_cast<const T*>(array.mpData);
+        return std::vector<T>(pData, pData + getElementCount());
+    }
+
+    /**
+     * Return the array in C order. Returns the array itself if it already is in C order, otherwise a transposed copy.
+     */
+    NumpyArray toCOrder() const;
+
+    /**
+     * Return a copy of the array that owns its data.
+     */
+    NumpyArray copy() const;
+
+private:
+    NumpyArray(
+        NumpyDType dtype,
+        std::vector<size_t> shape,
+        bool fortranOrder,
+        void* pData,
+        size_t byteSize,
+        std::shared_ptr<void> pStorage,
+        bool readOnly
+    );
+
+    void checkDType(NumpyDType dtype) const;
+
+    NumpyDType mDType = NumpyDType::Float32;
+    std::vector<size_t> mShape;
+    bool mFortranOrder = false;
+    bool mReadOnly = false;
+    void* mpData = nullptr;
+    std::shared_ptr<void> mpStorage; ///< Owned storage or memory mapped file keeping mpData alive.
+};
+
+/**
+ * Writer appending rows to a .npy file, for datasets that are too large to be collected in memory first.
+ *
+ * The array grows along the first dimension. The header is padded so that it can be rewritten in place with
+ * the final row count when the writer is closed. Rows are buffered and written in large blocks.
+ */
+class FALCOR_API NumpyArrayWriter
+{
+public:
+    /**
+     * Create a writer. Throws a RuntimeError if the file cannot be created.
+     * @param[in] path File path.
+     * @param[in] dtype Element type.
+     * @param[in] rowShape Shape of a single row, i.e., the array shape without the first dimension.
+     * @param[in] bufferSize Size of the write buffer in bytes.
+     */
+    NumpyArrayWriter(
+        const std::filesystem::path& path,
+        NumpyDType dtype,
+        std::vector<size_t> rowShape = {},
+        size_t bufferSize = 1 << 20
+    );
+
+    /// Closes the writer.
+    ~NumpyArrayWriter();
+
+    NumpyArrayWriter(const NumpyArrayWriter&) = delete;
+    NumpyArrayWriter& operator=(const NumpyArrayWriter&) = delete;
+
+    /**
+     * Append rows.
+     * @param[in] pData Elements of the rows in C order.
+     * @param[in] rowCount Number of rows.
+     */
+    void append(const void* pData, size_t rowCount = 1);
+
+    /**
+     * Append rows. Throws an ArgumentError if the element type does not match or the number of elements is not
+     * a multiple of the row size.
+     */
+    template<typename T>
+    void append(const T* pData, size_t elementCount)
+    {
+        checkAppend(getNumpyDType<T>(), elementCount);
+        append(static_cast<const void*>(pData), mRowElementCount > 0 ? elementCount / mRowElementCount : 0);
+    }
+
+    /**
+     * Flush buffered rows and update the header, leaving a valid file on disk. The writer stays open.
+     */
+    void flush();
+
+    /**
+     * Flush and close the file. Called by the destructor.
+     */
+    void close();
+
+    size_t getRowCount() const { return mRowCount; }
+
+private:
+    void checkAppend(NumpyDType dtype, size_t elementCount) const;
+    void writeHeader();
+
+    std::filesystem::path mPath;
+    std::ofstream mStream;
+    NumpyDType mDType;
+    std::vector<size_t> mRowShape;
+    size_t mRowElementCount = 1;
+    size_t mRowCount = 0;
+    size_t mHeaderSize = 0;
+    std::vector<uint8_t> mBuffer;
+    size_t mBufferSize;
+};
+} // namespace Falcor
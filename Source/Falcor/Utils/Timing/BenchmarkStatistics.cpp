@@ -0,0 +1,304 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BenchmarkStatistics.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/StringFormatters.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Scale factor turning the MAD into a consistent estimator of the standard deviation for normally distributed data.
+const double kMadToStdDev = 1.4826;
+
+/// Compute the median, reordering the values.
+double computeMedianInPlace(std::vector<double>& values)
+{
+    if (values.empty())
+        return 0.0;
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double median = values[mid];
+    if (values.size() % 2 == 0)
+        median = 0.5 * (median + *std::max_element(values.begin(), values.begin() + mid));
+    return median;
+}
+
+double computePercentile(const std::vector<double>& sorted, double p)
+{
+    FALCOR_ASSERT(!sorted.empty());
+    double x = std::clamp(p, 0.0, 1.0) * (sorted.size() - 1);
+    size_t i = std::min((size_t)x, sorted.size() - 1);
+    size_t j = std::min(i + 1, sorted.size() - 1);
+    return sorted[i] + (x - i) * (sorted[j] - sorted[i]);
+}
+
+/// Median of values drawn with replacement. The scratch vector avoids allocations across iterations.
+double resampleMedian(const std::vector<double>& values, std::mt19937& rng, std::vector<double>& scratch)
+{
+    std::uniform_int_distribution<size_t> dist(0, values.size() - 1);
+    scratch.resize(values.size());
+    for (auto& v : scratch)
+        v = values[dist(rng)];
+    return computeMedianInPlace(scratch);
+}
+
+void checkOptions(const BenchmarkStatistics::Options& options)
+{
+    checkArgument(options.warmupWindow > 0, "'warmupWindow' must be positive.");
+    checkArgument(
+        options.confidenceLevel > 0.0 && options.confidenceLevel < 1.0, "'confidenceLevel' must be in (0, 1), got {}.", options.confidenceLevel
+    );
+}
+
+nlohmann::json toJson(const BenchmarkStatistics::Summary& summary)
+{
+    return {
+        {"sample_count", summary.sampleCount},
+        {"warmup_count", summary.warmupCount},
+        {"outlier_count", summary.outlierCount},
+        {"median", summary.median},
+        {"mad", summary.mad},
+        {"mean", summary.mean},
+        {"std_dev", summary.stdDev},
+        {"min", summary.min},
+        {"max", summary.max},
+        {"ci_lower", summary.ciLower},
+        {"ci_upper", summary.ciUpper},
+    };
+}
+} // namespace
+
+double BenchmarkStatistics::computeMedian(std::vector<double> values)
+{
+    return computeMedianInPlace(values);
+}
+
+double BenchmarkStatistics::computeMAD(const std::vector<double>& values, double median)
+{
+    std::vector<double> deviations(values.size());
+    std::transform(values.begin(), values.end(), deviations.begin(), [median](double v) { return std::abs(v - median); });
+    return computeMedianInPlace(deviations);
+}
+
+size_t BenchmarkStatistics::detectWarmup(const std::vector<float>& samples, const Options& options)
+{
+    checkOptions(options);
+
+    const size_t window = options.warmupWindow;
+    if (samples.size() < 2 * window)
+        return 0;
+
+    // Estimate the steady state from the second half of the sequence.
+    const size_t half = samples.size() / 2;
+    std::vector<double> steady(samples.begin() + half, samples.end());
+    const double median = computeMedian(steady);
+    const double sigma = kMadToStdDev * computeMAD(steady, median);
+    const double tolerance = options.warmupMadThreshold * sigma + options.warmupRelativeTolerance * std::abs(median);
+
+    std::vector<double> windowValues(window);
+    for (size_t start = 0; start < half; ++start)
+    {
+        std::copy(samples.begin() + start, samples.begin() + start + window, windowValues.begin());
+        if (std::abs(computeMedianInPlace(windowValues) - median) <= tolerance)
+            return start;
+    }
+    return half;
+}
+
+std::vector<double> BenchmarkStatistics::preprocess(
+    const std::vector<float>& samples,
+    const Options& options,
+    size_t* pWarmupCount,
+    size_t* pOutlierCount
+)
+{
+    const size_t warmupCount = detectWarmup(samples, options);
+    std::vector<double> values(samples.begin() + warmupCount, samples.end());
+
+    size_t outlierCount = 0;
+    if (options.outlierThreshold > 0.0 && !values.empty())
+    {
+        // Reject samples by their modified z-score. A zero MAD means most samples are identical, keep everything in that case.
+        const double median = computeMedian(values);
+        const double sigma = kMadToStdDev * computeMAD(values, median);
+        if (sigma > 0.0)
+        {
+            auto it = std::remove_if(
+                values.begin(), values.end(), [&](double v) { return std::abs(v - median) / sigma > options.outlierThreshold; }
+            );
+            outlierCount = std::distance(it, values.end());
+            values.erase(it, values.end());
+        }
+    }
+
+    if (pWarmupCount)
+        *pWarmupCount = warmupCount;
+    if (pOutlierCount)
+        *pOutlierCount = outlierCount;
+    return values;
+}
+
+BenchmarkStatistics::Summary BenchmarkStatistics::summarize(const std::vector<float>& samples, const Options& options)
+{
+    Summary summary;
+    summary.sampleCount = samples.size();
+    std::vector<double> values = preprocess(samples, options, &summary.warmupCount, &summary.outlierCount);
+    if (values.empty())
+        return summary;
+
+    double sum = 0.0;
+    double sum2 = 0.0;
+    for (double v : values)
+    {
+        sum += v;
+        sum2 += v * v;
+    }
+    summary.mean = sum / values.size();
+    summary.stdDev = std::sqrt(std::max(0.0, sum2 / values.size() - summary.mean * summary.mean));
+    summary.min = *std::min_element(values.begin(), values.end());
+    summary.max = *std::max_element(values.begin(), values.end());
+    summary.median = computeMedian(values);
+    summary.mad = computeMAD(values, summary.median);
+
+    // Percentile bootstrap of the median.
+    std::mt19937 rng(options.seed);
+    std::vector<double> medians(options.bootstrapIterations);
+    std::vector<double> scratch;
+    for (auto& median : medians)
+        median = resampleMedian(values, rng, scratch);
+    std::sort(medians.begin(), medians.end());
+
+    const double alpha = 1.0 - options.confidenceLevel;
+    summary.ciLower = medians.empty() ? summary.median : computePercentile(medians, 0.5 * alpha);
+    summary.ciUpper = medians.empty() ? summary.median : computePercentile(medians, 1.0 - 0.5 * alpha);
+    return summary;
+}
+
+BenchmarkStatistics::Comparison BenchmarkStatistics::compare(
+    const std::vector<float>& baseline,
+    const std::vector<float>& candidate,
+    const Options& options
+)
+{
+    Comparison comparison;
+    comparison.baseline = summarize(baseline, options);
+    comparison.candidate = summarize(candidate, options);
+
+    std::vector<double> baselineValues = preprocess(baseline, options);
+    std::vector<double> candidateValues = preprocess(candidate, options);
+    if (baselineValues.empty() || candidateValues.empty() || comparison.baseline.median <= 0.0)
+        return comparison;
+
+    comparison.relativeChange = comparison.candidate.median / comparison.baseline.median - 1.0;
+
+    // Percentile bootstrap of the relative change of the medians, resampling both sets independently.
+    std::mt19937 rng(options.seed);
+    std::vector<double> changes;
+    changes.reserve(options.bootstrapIterations);
+    std::vector<double> scratch;
+    for (uint32_t i = 0; i < options.bootstrapIterations; ++i)
+    {
+        double baselineMedian = resampleMedian(baselineValues, rng, scratch);
+        double candidateMedian = resampleMedian(candidateValues, rng, scratch);
+        if (baselineMedian > 0.0)
+            changes.push_back(candidateMedian / baselineMedian - 1.0);
+    }
+    std::sort(changes.begin(), changes.end());
+
+    const double alpha = 1.0 - options.confidenceLevel;
+    comparison.ciLower = changes.empty() ? comparison.relativeChange : computePercentile(changes, 0.5 * alpha);
+    comparison.ciUpper = changes.empty() ? comparison.relativeChange : computePercentile(changes, 1.0 - 0.5 * alpha);
+
+    if (comparison.ciLower > options.minRelativeChange)
+        comparison.verdict = Verdict::Regression;
+    else if (comparison.ciUpper < -options.minRelativeChange)
+        comparison.verdict = Verdict::Improvement;
+    return comparison;
+}
+
+std::vector<BenchmarkStatistics::Comparison> BenchmarkStatistics::compare(const Run& baseline, const Run& candidate, const Options& options)
+{
+    std::vector<Comparison> comparisons;
+    for (const auto& [name, baselineSamples] : baseline.samples)
+    {
+        auto it = candidate.samples.find(name);
+        if (it == candidate.samples.end())
+            continue;
+        Comparison comparison = compare(baselineSamples, it->second, options);
+        comparison.name = name;
+        comparisons.push_back(std::move(comparison));
+    }
+    return comparisons;
+}
+
+void BenchmarkStatistics::Run::writeToFile(const std::filesystem::path& path, const Options& options) const
+{
+    nlohmann::json json;
+    json["metadata"] = metadata;
+    json["events"] = nlohmann::json::object();
+    for (const auto& [name, eventSamples] : samples)
+        json["events"][name] = {{"samples", eventSamples}, {"summary", toJson(summarize(eventSamples, options))}};
+
+    std::ofstream ofs(path);
+    if (!ofs.is_open())
+        throw RuntimeError("Failed to open benchmark results file '{}' for writing.", path);
+    ofs << json.dump(2) << std::endl;
+}
+
+BenchmarkStatistics::Run BenchmarkStatistics::Run::readFromFile(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open())
+        throw RuntimeError("Failed to open benchmark results file '{}'.", path);
+
+    Run run;
+    try
+    {
+        nlohmann::json json = nlohmann::json::parse(ifs);
+        if (json.contains("metadata"))
+        {
+            for (const auto& [key, value] : json["metadata"].items())
+                run.metadata[key] = value.is_string() ? value.get<std::string>() : value.dump();
+        }
+        for (const auto& [name, event] : json.at("events").items())
+            run.samples[name] = event.at("samples").get<std::vector<float>>();
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        throw RuntimeError("Invalid benchmark results file '{}': {}", path, e.what());
+    }
+    return run;
+}
+} // namespace Falcor
@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Enum.h"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Options for BenchmarkStatistics.
+ */
+struct BenchmarkStatisticsOptions
+{
+    /// Number of samples in the sliding window used for warm-up detection.
+    size_t warmupWindow = 8;
+    /// A window is considered warmed up if its median is within this many (scaled) MADs of the steady state median.
+    double warmupMadThreshold = 3.0;
+    /// Relative tolerance added to the warm-up threshold, so perfectly stable sequences are not rejected for tiny deviations.
+    double warmupRelativeTolerance = 0.02;
+    /// Samples with a modified z-score above this threshold are rejected as outliers (0 disables rejection).
+    double outlierThreshold = 3.5;
+    /// Number of bootstrap resamples.
+    uint32_t bootstrapIterations = 2000;
+    /// Confidence level of the bootstrap intervals.
+    double confidenceLevel = 0.95;
+    /// Relative change of the median below which differences are not flagged, even if significant.
+    double minRelativeChange = 0.01;
+    /// Seed for the bootstrap random number generator.
+    uint32_t seed = 0;
+};
+
+/**
+ * Robust statistics for benchmark timings.
+ *
+ * Timing samples are preprocessed by discarding the warm-up phase at the start of the sequence and rejecting
+ * outliers based on the median absolute deviation (MAD). The remaining samples are summarized by their median
+ * with a bootstrap confidence interval, which is much less sensitive to sporadic hitches than the mean.
+ *
+ * Two sets of samples are compared by bootstrapping the relative difference of their medians. A change is only
+ * flagged when the whole confidence interval lies beyond the configured minimum relative change.
+ */
+class FALCOR_API BenchmarkStatistics
+{
+public:
+    using Options = BenchmarkStatisticsOptions;
+
+    struct Summary
+    {
+        size_t sampleCount = 0;  ///< Number of input samples.
+        size_t warmupCount = 0;  ///< Number of discarded warm-up samples.
+        size_t outlierCount = 0; ///< Number of rejected outliers.
+        double median = 0.0;
+        double mad = 0.0; ///< Median absolute deviation (unscaled).
+        double mean = 0.0;
+        double stdDev = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double ciLower = 0.0; ///< Lower bound of the confidence interval of the median.
+        double ciUpper = 0.0; ///< Upper bound of the confidence interval of the median.
+    };
+
+    enum class Verdict
+    {
+        Unchanged,
+        Improvement,
+        Regression,
+    };
+
+    FALCOR_ENUM_INFO(
+        Verdict,
+        {
+            {Verdict::Unchanged, "Unchanged"},
+            {Verdict::Improvement, "Improvement"},
+            {Verdict::Regression, "Regression"},
+        }
+    );
+
+    struct Comparison
+    {
+        std::string name;
+        Summary baseline;
+        Summary candidate;
+        double relativeChange = 0.0; ///< Relative change of the median (candidate / baseline - 1).
+        double ciLower = 0.0;        ///< Lower bound of the confidence interval of the relative change.
+        double ciUpper = 0.0;        ///< Upper bound of the confidence interval of the relative change.
+        Verdict verdict = Verdict::Unchanged;
+    };
+
+    /**
+     * Benchmark run: timing samples per event and metadata describing the run.
+     */
+    struct Run
+    {
+        std::map<std::string, std::string> metadata;       ///< E.g., scene, graph, resolution, build version.
+        std::map<std::string, std::vector<float>> samples; ///< Timing samples per event.
+
+        /**
+         * Write the run including the summary of each event to a JSON file.
+         * Throws a RuntimeError if the file cannot be written.
+         */
+        void writeToFile(const std::filesystem::path& path, const Options& options = {}) const;
+
+        /**
+         * Read a run from a JSON file written by writeToFile().
+         * Throws a RuntimeError if the file cannot be read or is invalid.
+         */
+        static Run readFromFile(const std::filesystem::path& path);
+    };
+
+    /**
+     * Compute the median of a set of samples. Returns 0 for an empty set.
+     */
+    static double computeMedian(std::vector<double> values);
+
+    /**
+     * Compute the (unscaled) median absolute deviation around a given median.
+     */
+    static double computeMAD(const std::vector<double>& values, double median);
+
+    /**
+     * Detect the end of the warm-up phase.
+     * The steady state is estimated from the second half of the samples. The warm-up ends at the first window of samples
+     * whose median is consistent with the steady state. At most half of the samples are classified as warm-up.
+     * @return Number of leading samples to discard.
+     */
+    static size_t detectWarmup(const std::vector<float>& samples, const Options& options = {});
+
+    /**
+     * Discard warm-up samples and reject outliers.
+     * @param[in] samples Timing samples in recording order.
+     * @param[in] options Options.
+     * @param[out] pWarmupCount Number of discarded warm-up samples (optional).
+     * @param[out] pOutlierCount Number of rejected outliers (optional).
+     * @return The remaining samples.
+     */
+    static std::vector<double> preprocess(
+        const std::vector<float>& samples,
+        const Options& options = {},
+        size_t* pWarmupCount = nullptr,
+        size_t* pOutlierCount = nullptr
+    );
+
+    /**
+     * Summarize a set of timing samples.
+     */
+    static Summary summarize(const std::vector<float>& samples, const Options& options = {});
+
+    /**
+     * Compare candidate samples against baseline samples. Lower values are considered better.
+     */
+    static Comparison compare(const std::vector<float>& baseline, const std::vector<float>& candidate, const Options& options = {});
+
+    /**
+     * Compare all events present in both runs.
+     */
+    static std::vector<Comparison> compare(const Run& baseline, const Run& candidate, const Options& options = {});
+};
+
+FALCOR_ENUM_REGISTER(BenchmarkStatistics::Verdict);
+} // namespace Falcor
@@ -131,7 +131,11 @@ Profiler::Stats Profiler::Stats::compute(const float* data, size_t len)
 
 // Profiler::Event
 
-Profiler::Event::Event(const std::string& name) : mName(name), mCpuTimeHistory(kMaxHistorySize, 0.f), mGpuTimeHistory(kMaxHistorySize, 0.f)
+Profiler::Event::Event(const std::string& name)
+    : mName(name)
+    , mTraceId(TraceRecorder::internName(name.substr(name.find_last_of('/') + 1)))
+    , mCpuTimeHistory(kMaxHistorySize, 0.f)
+    , mGpuTimeHistory(kMaxHistorySize, 0.f)
 {}
 
 Profiler::Stats Profiler::Event::computeCpuTimeStats() const
@@ -160,6 +164,7 @@ void Profiler::Event::start(Profiler& profiler, uint32_t frameIndex)
 
     // Update CPU time.
     frameData.cpuStartTime = CpuTimer::getCurrentTimePoint();
+    frameData.traceStart = TraceRecorder::isEnabled() ? TraceRecorder::now() : 0;
 
     // Update GPU time.
     FALCOR_ASSERT(frameData.pActiveTimer == nullptr);
@@ -169,7 +174,9 @@ void Profiler::Event::start(Profiler& profiler, uint32_t frameIndex)
         ref<GpuTimer> timer = GpuTimer::create(profiler.mpDevice);
         timer->breakStrongReferenceToDevice();
         frameData.pTimers.push_back(timer);
+        frameData.timerTraceStarts.push_back(0);
     }
+    frameData.timerTraceStarts[frameData.currentTimer] = frameData.traceStart;
     frameData.pActiveTimer = frameData.pTimers[frameData.currentTimer++].get();
     frameData.pActiveTimer->begin();
     frameData.valid = false;
@@ -184,6 +191,8 @@ void Profiler::Event::end(uint32_t frameIndex)
 
     // Update CPU time.
     frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, CpuTimer::getCurrentTimePoint());
+    if (frameData.traceStart != 0)
+        TraceRecorder::record(mTraceId, frameData.traceStart, TraceRecorder::now());
 
     // Update GPU time.
     FALCOR_ASSERT(frameData.pActiveTimer != nullptr);
@@ -214,7 +223,13 @@ void Profiler::Event::endFrame(uint32_t frameIndex)
     mCpuTime = frameData.cpuTotalTime;
     mGpuTime = 0.f;
     for (size_t i = 0; i < frameData.currentTimer; ++i)
-        mGpuTime += (float)frameData.pTimers[i]->getElapsedTime();
+    {
+        double elapsed = frameData.pTimers[i]->getElapsedTime();
+        mGpuTime += (float)elapsed;
+        // GPU times are placed on the trace at the CPU time the event was submitted.
+        if (frameData.timerTraceStarts[i] != 0)
+            TraceRecorder::recordGpu(mTraceId, frameData.timerTraceStarts[i], elapsed);
+    }
     frameData.cpuTotalTime = 0.f;
     frameData.currentTimer = 0;
 
@@ -466,5 +481,8 @@ FALCOR_SCRIPT_BINDING(Profiler)
     profiler.def_property_readonly("events", [](const Profiler& profiler) { return toPython(profiler.getEvents()); });
     profiler.def("start_capture", &Profiler::startCapture, "reserved_frames"_a = 1000);
     profiler.def("end_capture", endCapture);
+    profiler.def_property("trace_enabled", &Profiler::isTraceEnabled, &Profiler::setTraceEnabled);
+    profiler.def("write_trace", &Profiler::writeTrace, "path"_a);
+    profiler.def("clear_trace", [](Profiler&) { TraceRecorder::clear(); });
 }
 } // namespace Falcor
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "CpuTimer.h"
+#include "TraceRecorder.h"
 #include "Core/Macros.h"
 #include "Core/API/GpuTimer.h"
 #include <filesystem>
@@ -89,7 +90,8 @@ public:
         void end(uint32_t frameIndex);
         void endFrame(uint32_t frameIndex);
 
-        std::string mName; ///< Nested event name.
+        std::string mName;               ///< Nested event name.
+        TraceRecorder::EventId mTraceId; ///< Trace event ID (leaf name).
 
         float mCpuTime = 0.0; ///< CPU time (previous frame).
         float mGpuTime = 0.0; ///< GPU time (previous frame).
@@ -113,6 +115,9 @@ public:
             size_t currentTimer = 0;            ///< Next GPU timer to use from the pool.
             GpuTimer* pActiveTimer = nullptr;   ///< Currently active GPU timer.
 
+            uint64_t traceStart = 0;                ///< Trace start timestamp of the active event, 0 if not traced.
+            std::vector<uint64_t> timerTraceStarts; ///< Trace start timestamp per GPU timer, 0 if not traced.
+
             bool valid = false; ///< True when frame data is valid (after begin/end cycle).
         };
         FrameData mFrameData[2]; ///< Double-buffered frame data to avoid GPU flushes.
@@ -229,6 +234,24 @@ public:
      */
     Event* getEvent(const std::string& name);
 
+    /**
+     * Enable/disable recording profiler events to the trace recorder.
+     * CPU scopes are recorded on the calling thread lane, GPU times on the GPU lane.
+     * @param[in] enabled True to enable tracing.
+     */
+    void setTraceEnabled(bool enabled) { TraceRecorder::setEnabled(enabled); }
+
+    /**
+     * Check if tracing is enabled.
+     */
+    bool isTraceEnabled() const { return TraceRecorder::isEnabled(); }
+
+    /**
+     * Write all traced events (including FALCOR_TRACE_SCOPE scopes from other threads) as Chrome trace JSON.
+     * @param[in] path File path.
+     */
+    void writeTrace(const std::filesystem::path& path) const { TraceRecorder::writeChromeTrace(path); }
+
     /**
      * Get the profiler events (previous frame).
      */
@@ -0,0 +1,351 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TraceRecorder.h"
+#include "Core/Errors.h"
+#include "Utils/StringFormatters.h"
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define TRACE_RECORDER_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_RECORDER_TSC 1
+#else
+#define TRACE_RECORDER_TSC 0
+#endif
+
+namespace Falcor
+{
+namespace
+{
+/**
+ * Single-producer ring buffer of records. Only the owning thread writes, readers take snapshots and
+ * discard records that may have been overwritten while copying. The record fields are relaxed atomics,
+ * which compile to plain loads and stores.
+ */
+struct ThreadBuffer
+{
+    struct Slot
+    {
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+        std::atomic<uint32_t> id;
+    };
+
+    struct Record
+    {
+        uint64_t start;
+        uint64_t end;
+        TraceRecorder::EventId id;
+    };
+
+    uint32_t lane = 0;
+    std::string name;     ///< Protected by the registry mutex.
+    bool retired = false; ///< Set when the owning thread exits. Protected by the registry mutex.
+    std::unique_ptr<Slot[]> slots{new Slot[TraceRecorder::kThreadBufferCapacity]};
+    std::atomic<uint64_t> writeIndex{0};
+    std::atomic<uint64_t> clearIndex{0};
+
+    void push(TraceRecorder::EventId id, uint64_t start, uint64_t end)
+    {
+        const uint64_t index = writeIndex.load(std::memory_order_relaxed);
+        Slot& slot = slots[index & (TraceRecorder::kThreadBufferCapacity - 1)];
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.id.store(id, std::memory_order_relaxed);
+        writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    std::vector<Record> snapshot() const
+    {
+        const uint64_t end = writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = std::max(clearIndex.load(std::memory_order_relaxed), end > TraceRecorder::kThreadBufferCapacity ? end - TraceRecorder::kThreadBufferCapacity : 0);
+
+        std::vector<Record> records;
+        records.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const Slot& slot = slots[i & (TraceRecorder::kThreadBufferCapacity - 1)];
+            records.push_back({slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed), slot.id.load(std::memory_order_relaxed)});
+        }
+
+        // Drop records the producer may have overwritten while they were copied. Record endAfter may be in the
+        // middle of being written, so its slot (record endAfter - capacity) is dropped as well.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t endAfter = writeIndex.load(std::memory_order_relaxed);
+        if (endAfter + 1 > TraceRecorder::kThreadBufferCapacity + begin)
+        {
+            const size_t dropCount = std::min<size_t>(endAfter + 1 - TraceRecorder::kThreadBufferCapacity - begin, records.size());
+            records.erase(records.begin(), records.begin() + dropCount);
+        }
+        return records;
+    }
+};
+
+/// Maximum number of buffers of exited threads kept for export. Beyond that, new threads reuse the oldest one.
+const size_t kMaxRetiredThreadBuffers = 16;
+
+struct Registry
+{
+    std::atomic<bool> enabled{false};
+
+    std::mutex mutex;
+    std::unordered_map<std::string, TraceRecorder::EventId> nameToId;
+    std::vector<std::string> names;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers; ///< Kept alive after threads exit so their records can be exported.
+    std::deque<ThreadBuffer*> retiredBuffers;                 ///< Buffers of exited threads, oldest first.
+    uint32_t nextLane = 1;
+    std::shared_ptr<ThreadBuffer> gpuBuffer = std::make_shared<ThreadBuffer>();
+
+    // Reference points for converting ticks to time.
+    uint64_t startTicks = TraceRecorder::now();
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    /// Get the number of ticks per nanosecond, measured since the registry was created.
+    double getTicksPerNanosecond()
+    {
+#if TRACE_RECORDER_TSC
+        const uint64_t ticks = TraceRecorder::now() - startTicks;
+        const double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+        return elapsed > 0.0 && ticks > 0 ? ticks / elapsed : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+};
+
+Registry& getRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+thread_local ThreadBuffer* tlThreadBuffer = nullptr;
+
+/// Retires the buffer of a thread when the thread exits.
+struct ThreadBufferOwner
+{
+    ThreadBuffer* pBuffer = nullptr;
+
+    ~ThreadBufferOwner()
+    {
+        Registry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        pBuffer->retired = true;
+        registry.retiredBuffers.push_back(pBuffer);
+    }
+};
+
+ThreadBuffer& getThreadBuffer()
+{
+    if (!tlThreadBuffer)
+    {
+        Registry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        ThreadBuffer* pBuffer = nullptr;
+        if (registry.retiredBuffers.size() >= kMaxRetiredThreadBuffers)
+        {
+            // Reuse the oldest buffer of an exited thread and drop its records.
+            pBuffer = registry.retiredBuffers.front();
+            registry.retiredBuffers.pop_front();
+            pBuffer->retired = false;
+            pBuffer->clearIndex.store(pBuffer->writeIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        else
+        {
+            auto pNewBuffer = std::make_shared<ThreadBuffer>();
+            pNewBuffer->lane = registry.nextLane++;
+            registry.threadBuffers.push_back(pNewBuffer);
+            pBuffer = pNewBuffer.get();
+        }
+        pBuffer->name = fmt::format("Thread {}", pBuffer->lane);
+
+        // Registered on first use only, so recording does not pay for the destructor guard.
+        static thread_local ThreadBufferOwner owner;
+        owner.pBuffer = pBuffer;
+        tlThreadBuffer = pBuffer;
+    }
+    return *tlThreadBuffer;
+}
+} // namespace
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    getRegistry().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return getRegistry().enabled.load(std::memory_order_relaxed);
+}
+
+TraceRecorder::EventId TraceRecorder::internName(std::string_view name)
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto [it, inserted] = registry.nameToId.try_emplace(std::string(name), (EventId)registry.names.size());
+    if (inserted)
+        registry.names.emplace_back(name);
+    return it->second;
+}
+
+std::string TraceRecorder::getName(EventId id)
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    checkArgument(id < registry.names.size(), "Invalid trace event ID {}.", id);
+    return registry.names[id];
+}
+
+void TraceRecorder::setThreadName(std::string_view name)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(getRegistry().mutex);
+    buffer.name = name;
+}
+
+uint64_t TraceRecorder::now()
+{
+#if TRACE_RECORDER_TSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void TraceRecorder::record(EventId id, uint64_t start, uint64_t end)
+{
+    getThreadBuffer().push(id, start, end);
+}
+
+void TraceRecorder::recordGpu(EventId id, uint64_t start, double durationMs)
+{
+    Registry& registry = getRegistry();
+    const uint64_t durationTicks = (uint64_t)(durationMs * 1e6 * registry.getTicksPerNanosecond());
+    registry.gpuBuffer->push(id, start, start + durationTicks);
+}
+
+void TraceRecorder::clear()
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    // Buffers of exited threads hold no more records after clearing and are released.
+    registry.threadBuffers.erase(
+        std::remove_if(
+            registry.threadBuffers.begin(), registry.threadBuffers.end(), [](const auto& pBuffer) { return pBuffer->retired; }
+        ),
+        registry.threadBuffers.end()
+    );
+    registry.retiredBuffers.clear();
+    for (auto& pBuffer : registry.threadBuffers)
+        pBuffer->clearIndex.store(pBuffer->writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+    registry.gpuBuffer->clearIndex.store(registry.gpuBuffer->writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+size_t TraceRecorder::getRecordCount()
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    size_t count = registry.gpuBuffer->snapshot().size();
+    for (const auto& pBuffer : registry.threadBuffers)
+        count += pBuffer->snapshot().size();
+    return count;
+}
+
+std::string TraceRecorder::toChromeTraceJson()
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    const double nanosecondsPerTick = 1.0 / registry.getTicksPerNanosecond();
+    auto toMicroseconds = [&](uint64_t ticks) { return (double)(int64_t)(ticks - registry.startTicks) * nanosecondsPerTick * 1e-3; };
+
+    // Names are escaped once, not per record.
+    std::vector<std::string> escapedNames(registry.names.size());
+    for (size_t i = 0; i < registry.names.size(); ++i)
+        escapedNames[i] = nlohmann::json(registry.names[i]).dump();
+
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto append = [&](const std::string& event)
+    {
+        if (!first)
+            json += ",\n";
+        json += event;
+        first = false;
+    };
+
+    const uint32_t kCpuPid = 1;
+    const uint32_t kGpuPid = 2;
+    append(fmt::format(R"({{"name":"process_name","ph":"M","pid":{},"args":{{"name":"CPU"}}}})", kCpuPid));
+    append(fmt::format(R"({{"name":"process_name","ph":"M","pid":{},"args":{{"name":"GPU"}}}})", kGpuPid));
+    append(fmt::format(R"({{"name":"thread_name","ph":"M","pid":{},"tid":0,"args":{{"name":"GPU, at submission time"}}}})", kGpuPid));
+
+    auto appendRecords = [&](const ThreadBuffer& buffer, uint32_t pid)
+    {
+        for (const auto& record : buffer.snapshot())
+        {
+            if (record.id >= escapedNames.size())
+                continue;
+            const double start = toMicroseconds(record.start);
+            const double duration = (double)(record.end - record.start) * nanosecondsPerTick * 1e-3;
+            append(fmt::format(R"({{"name":{},"ph":"X","pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f}}})", escapedNames[record.id], pid, pid == kGpuPid ? 0 : buffer.lane, start, duration));
+        }
+    };
+
+    for (const auto& pBuffer : registry.threadBuffers)
+    {
+        append(fmt::format(R"({{"name":"thread_name","ph":"M","pid":{},"tid":{},"args":{{"name":{}}}}})", kCpuPid, pBuffer->lane, nlohmann::json(pBuffer->name).dump()));
+        appendRecords(*pBuffer, kCpuPid);
+    }
+    appendRecords(*registry.gpuBuffer, kGpuPid);
+
+    json += "\n]}\n";
+    return json;
+}
+
+void TraceRecorder::writeChromeTrace(const std::filesystem::path& path)
+{
+    std::string json = toChromeTraceJson();
+    std::ofstream ofs(path, std::ios::out | std::ios::binary);
+    if (!ofs.is_open())
+        throw RuntimeError("Failed to open '{}' for writing the trace.", path);
+    ofs.write(json.data(), json.size());
+}
+} // namespace Falcor
@@ -0,0 +1,161 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/FalcorConfig.h"
+#include "Core/Macros.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Falcor
+{
+/**
+ * Low-overhead CPU trace recorder.
+ *
+ * Scopes are recorded into per-thread ring buffers without locks, so instrumentation can be placed in hot loops
+ * and in code running on worker threads (e.g., std::execution::par during scene loading).
+ * Event names are interned once per call site, records only hold a numeric event ID and two timestamps.
+ * When a ring buffer wraps around, the oldest records of that thread are dropped. Buffers of exited threads are kept
+ * for export until clear() is called; once more than a few have accumulated, new threads reuse the oldest one.
+ *
+ * GPU timings measured by the Profiler are recorded on a separate lane, placed at the CPU time the
+ * event was submitted. The recording can be exported as Chrome trace / Perfetto JSON.
+ *
+ * Use the FALCOR_TRACE_SCOPE macro to instrument code. Recording is disabled by default; while disabled a scope costs a single relaxed load.
+ */
+class FALCOR_API TraceRecorder
+{
+public:
+    using EventId = uint32_t;
+
+    /// Number of records per thread ring buffer.
+    static constexpr size_t kThreadBufferCapacity = 1 << 16;
+
+    /**
+     * Enable/disable recording.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Check if recording is enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * Get the ID for an event name, creating it if needed. This takes a lock, call sites should cache the ID.
+     */
+    static EventId internName(std::string_view name);
+
+    /**
+     * Get the name of an event.
+     */
+    static std::string getName(EventId id);
+
+    /**
+     * Set the name of the calling thread as shown in the trace.
+     */
+    static void setThreadName(std::string_view name);
+
+    /**
+     * Get the current timestamp in ticks.
+     */
+    static uint64_t now();
+
+    /**
+     * Record a CPU scope on the calling thread.
+     * @param[in] id Event ID.
+     * @param[in] start Start timestamp in ticks.
+     * @param[in] end End timestamp in ticks.
+     */
+    static void record(EventId id, uint64_t start, uint64_t end);
+
+    /**
+     * Record a GPU event on the GPU lane. Must only be called from one thread at a time (the thread ending frames).
+     * @param[in] id Event ID.
+     * @param[in] start CPU timestamp in ticks when the event was submitted.
+     * @param[in] durationMs Measured GPU duration in milliseconds.
+     */
+    static void recordGpu(EventId id, uint64_t start, double durationMs);
+
+    /**
+     * Drop all records recorded so far. Buffers of threads that have exited are released.
+     */
+    static void clear();
+
+    /**
+     * Get the number of records currently held in all buffers.
+     */
+    static size_t getRecordCount();
+
+    /**
+     * Export all records as Chrome trace JSON (viewable in chrome://tracing or Perfetto).
+     */
+    static std::string toChromeTraceJson();
+
+    /**
+     * Write all records as Chrome trace JSON to a file.
+     */
+    static void writeChromeTrace(const std::filesystem::path& path);
+};
+
+/**
+ * Records a CPU scope using RAII. Use the FALCOR_TRACE_SCOPE macro instead of creating instances directly.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(TraceRecorder::EventId id) : mId(id), mActive(TraceRecorder::isEnabled())
+    {
+        if (mActive)
+            mStart = TraceRecorder::now();
+    }
+
+    ~TraceScope()
+    {
+        if (mActive)
+            TraceRecorder::record(mId, mStart, TraceRecorder::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceRecorder::EventId mId;
+    bool mActive;
+    uint64_t mStart = 0;
+};
+} // namespace Falcor
+
+#if FALCOR_ENABLE_PROFILER
+#define FALCOR_TRACE_SCOPE(_name)                                                                                                          \
+    static const ::Falcor::TraceRecorder::EventId FALCOR_CONCAT_STRINGS(_traceEventId, __LINE__) = ::Falcor::TraceRecorder::internName(_name); \
+    ::Falcor::TraceScope FALCOR_CONCAT_STRINGS(_traceScope, __LINE__)(FALCOR_CONCAT_STRINGS(_traceEventId, __LINE__))
+#else
+#define FALCOR_TRACE_SCOPE(_name)
+#endif
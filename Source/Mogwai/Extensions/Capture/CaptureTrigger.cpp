@@ -120,8 +120,10 @@ namespace Mogwai
 
     void CaptureTrigger::endFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
     {
-        if (!mCurrent.pGraph) return;
         uint64_t frameId = mpRenderer->getGlobalClock().getFrame();
+        postFrame(pRenderContext, frameId);
+
+        if (!mCurrent.pGraph) return;
         const auto& ranges = mGraphRanges.at(mCurrent.pGraph);
 
         triggerFrame(pRenderContext, mCurrent.pGraph, frameId);
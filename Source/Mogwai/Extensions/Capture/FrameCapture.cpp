@@ -41,6 +41,11 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kReadbackLatency = "readbackLatency";
+        const std::string kWriterThreadCount = "writerThreadCount";
+        const std::string kMaxQueuedImages = "maxQueuedImages";
+        const std::string kUseSequenceFile = "useSequenceFile";
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -63,6 +68,18 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
+        mpWriter = std::make_unique<AsyncImageWriter>(mWriterThreadCount, mMaxQueuedImages);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        // Readbacks are resolved in shutdown() while the device is still alive. Only wait for the writer here.
+        mpWriter.reset();
+    }
+
+    void FrameCapture::shutdown()
+    {
+        flush();
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -76,7 +93,30 @@ namespace Mogwai
             w.checkbox("Capture All Outputs", mCaptureAllOutputs);
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
+            bool useSequenceFile = mUseSequenceFile;
+            if (w.checkbox("Write Sequence File", useSequenceFile)) setUseSequenceFile(useSequenceFile);
+            w.tooltip("Write all captured images into a single compressed frame sequence file (.fseq) instead of one file per image.\n"
+                "The file is finalized when the capture is flushed. Use FrameSequenceConvert to export individual images.");
+            if (mpSequenceWriter) w.text(fmt::format("Sequence: {} ({:.1f} MB)", mSequencePath.filename().string(), mpSequenceWriter->getPayloadSize() / (1024.0 * 1024.0)));
+
             if (w.button("Capture Current Frame")) capture();
+
+            if (auto g = w.group("Writer"))
+            {
+                g.var("Readback latency", mReadbackLatency, 0u, 16u);
+                g.tooltip("Number of frames a GPU readback stays in flight before the image is handed to the writer threads.");
+
+                uint32_t threadCount = mWriterThreadCount;
+                uint32_t maxQueuedImages = mMaxQueuedImages;
+                bool changed = g.var("Threads", threadCount, 1u, 64u);
+                changed |= g.var("Max queued images", maxQueuedImages, 1u, 256u);
+                if (changed) setWriterConfig(threadCount, maxQueuedImages);
+
+                auto stats = mpWriter->getStats();
+                g.text(fmt::format("Written: {} images ({:.1f} images/s)", stats.imagesWritten, stats.getImagesPerSecond()));
+                g.text(fmt::format("Pending: {} readbacks, {} images", mPendingReadbacks.size(), mpWriter->getPendingCount()));
+                if (stats.imagesFailed > 0) g.text(fmt::format("Failed: {} images", stats.imagesFailed));
+            }
         }
     }
 
@@ -95,6 +135,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -111,6 +152,18 @@ namespace Mogwai
         frameCapture.def_property("captureAllOutputs",
             [](FrameCapture* pFC){ return pFC->mCaptureAllOutputs;},
             [](FrameCapture* pFC, bool all){ pFC->mCaptureAllOutputs = all; });
+        frameCapture.def_property(kReadbackLatency.c_str(),
+            [](FrameCapture* pFC){ return pFC->mReadbackLatency; },
+            [](FrameCapture* pFC, uint32_t latency){ pFC->mReadbackLatency = latency; });
+        frameCapture.def_property(kWriterThreadCount.c_str(),
+            [](FrameCapture* pFC){ return pFC->mWriterThreadCount; },
+            [](FrameCapture* pFC, uint32_t count){ pFC->setWriterConfig(count, pFC->mMaxQueuedImages); });
+        frameCapture.def_property(kMaxQueuedImages.c_str(),
+            [](FrameCapture* pFC){ return pFC->mMaxQueuedImages; },
+            [](FrameCapture* pFC, uint32_t count){ pFC->setWriterConfig(pFC->mWriterThreadCount, count); });
+        frameCapture.def_property(kUseSequenceFile.c_str(),
+            [](FrameCapture* pFC){ return pFC->mUseSequenceFile; },
+            [](FrameCapture* pFC, bool useSequenceFile){ pFC->setUseSequenceFile(useSequenceFile); });
     }
 
     std::string FrameCapture::getScriptVar() const
@@ -241,6 +294,21 @@ namespace Mogwai
                 mpImageProcessing->copyColorChannel(pRenderContext, pOutput->getSRV(0, 1, 0, 1), pTex->getUAV(), mask);
             }
 
+            // Sequence files store the raw texture data, the readback is resolved into the sequence writer.
+            if (mUseSequenceFile)
+            {
+                if (FrameSequenceFile::isFormatSupported(pTex->getFormat()))
+                {
+                    auto pTask = pRenderContext->asyncReadTextureSubresource(pTex.get(), 0);
+                    PendingReadback readback{ pTask, pTex, {}, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, mFrameCount };
+                    readback.sequenceOutput = outputName + suffix;
+                    readback.frameID = mpRenderer->getGlobalClock().getFrame();
+                    mPendingReadbacks.push_back(std::move(readback));
+                    continue;
+                }
+                logWarning("Graph output {} format {} cannot be stored in a sequence file. Writing an image file instead.", outputName, to_string(pTex->getFormat()));
+            }
+
             // Write output image.
             auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
             auto fileformat = Bitmap::getFormatFromFileExtension(ext);
@@ -248,8 +316,112 @@ namespace Mogwai
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            // DDS and numpy files are written directly from the texture.
+            if (fileformat == Bitmap::FileFormat::DdsFile || fileformat == Bitmap::FileFormat::NumpyFile)
+            {
+                pTex->captureToFile(0, 0, filename, fileformat, flags, false);
+                continue;
+            }
+
+            // Issue the readback now and hand the data to the writer threads once it has completed.
+            uint32_t subresource = 0;
+            ref<Texture> pSource = pTex->prepareCaptureSource(pRenderContext, 0, 0, fileformat, subresource);
+            auto pTask = pRenderContext->asyncReadTextureSubresource(pSource.get(), subresource);
+            mPendingReadbacks.push_back({ pTask, pSource, filename, fileformat, flags, mFrameCount });
+        }
+    }
+
+    void FrameCapture::postFrame(RenderContext* pRenderContext, uint64_t frameID)
+    {
+        // Count rendered frames locally, the global clock does not advance while paused.
+        mFrameCount++;
+        resolveReadbacks(false);
+    }
+
+    void FrameCapture::resolveReadbacks(bool all)
+    {
+        while (!mPendingReadbacks.empty())
+        {
+            PendingReadback& readback = mPendingReadbacks.front();
+            if (!all && readback.issueFrame + mReadbackLatency > mFrameCount) break;
+
+            // This waits on the readback fence, which has normally been signaled already. The writer blocks if its queue is full.
+            const ref<Texture>& pSource = readback.pSource;
+            if (readback.sequenceOutput.empty())
+            {
+                mpWriter->write(readback.path, pSource->getWidth(), pSource->getHeight(), readback.fileFormat, readback.exportFlags,
+                    pSource->getFormat(), true, readback.pTask->getData());
+            }
+            else
+            {
+                try
+                {
+                    if (!mpSequenceWriter)
+                    {
+                        mSequencePath = getOutputPath() / (mBaseFilename + "." + std::to_string(readback.frameID) + ".fseq");
+                        mpSequenceWriter = std::make_unique<FrameSequenceFile::Writer>(mSequencePath);
+                    }
+                    uint32_t output = mpSequenceWriter->addOutput(readback.sequenceOutput, pSource->getWidth(), pSource->getHeight(), pSource->getFormat());
+                    mpSequenceWriter->writeImage(readback.frameID, output, readback.pTask->getData().data());
+                }
+                catch (const std::exception& e)
+                {
+                    logError("Failed to write output {} frame {} to sequence file '{}'. Error: {}", readback.sequenceOutput, readback.frameID, mSequencePath, e.what());
+                }
+            }
+            mPendingReadbacks.pop_front();
+        }
+    }
+
+    void FrameCapture::flush()
+    {
+        resolveReadbacks(true);
+        mpWriter->flush();
+        closeSequenceFile();
+
+        auto stats = mpWriter->getStats();
+        if (stats.imagesWritten > 0 || stats.imagesFailed > 0)
+        {
+            logInfo("Frame capture wrote {} images in {:.2f} s ({:.1f} images/s, {:.2f} s encoding, {:.2f} s blocked on full queue).",
+                stats.imagesWritten, stats.wallSeconds, stats.getImagesPerSecond(), stats.encodeSeconds, stats.blockedSeconds);
+            if (stats.imagesFailed > 0) logWarning("Frame capture failed to write {} images.", stats.imagesFailed);
+        }
+        mpWriter->resetStats();
+    }
+
+    void FrameCapture::setWriterConfig(uint32_t threadCount, uint32_t maxQueuedImages)
+    {
+        checkArgument(threadCount > 0, "'writerThreadCount' must be at least 1.");
+        checkArgument(maxQueuedImages > 0, "'maxQueuedImages' must be at least 1.");
+        if (threadCount == mWriterThreadCount && maxQueuedImages == mMaxQueuedImages) return;
+
+        flush();
+        mWriterThreadCount = threadCount;
+        mMaxQueuedImages = maxQueuedImages;
+        mpWriter = std::make_unique<AsyncImageWriter>(mWriterThreadCount, mMaxQueuedImages);
+    }
+
+    void FrameCapture::setUseSequenceFile(bool useSequenceFile)
+    {
+        if (useSequenceFile == mUseSequenceFile) return;
+        flush();
+        mUseSequenceFile = useSequenceFile;
+    }
+
+    void FrameCapture::closeSequenceFile()
+    {
+        if (!mpSequenceWriter) return;
+
+        try
+        {
+            mpSequenceWriter->finalize();
+            logInfo("Frame capture wrote sequence file '{}' ({:.1f} MB).", mSequencePath, mpSequenceWriter->getPayloadSize() / (1024.0 * 1024.0));
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to finalize sequence file '{}'. Error: {}", mSequencePath, e.what());
         }
+        mpSequenceWriter.reset();
     }
 
     void FrameCapture::addFrames(const RenderGraph* pGraph, const uint64_vec& frames)
@@ -278,5 +450,6 @@ namespace Mogwai
         if (!pGraph) return;
         uint64_t frameID = mpRenderer->getGlobalClock().getFrame();
         triggerFrame(mpRenderer->getRenderContext(), pGraph, frameID);
+        flush();
     }
 }
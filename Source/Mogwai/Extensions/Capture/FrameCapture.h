@@ -29,6 +29,9 @@
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
 #include "Utils/Image/ImageProcessing.h"
+#include "Utils/Image/AsyncImageWriter.h"
+#include "Utils/Image/FrameSequenceFile.h"
+#include <deque>
 
 namespace Mogwai
 {
@@ -36,13 +39,21 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~FrameCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void registerScriptBindings(pybind11::module& m) override;
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
+        virtual void shutdown() override;
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
+        virtual void postFrame(RenderContext* pRenderContext, uint64_t frameID) override;
         void capture();
 
+        /** Resolve all pending readbacks and block until all images have been written.
+            Finalizes the current sequence file, if any.
+        */
+        void flush();
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -51,8 +62,37 @@ namespace Mogwai
         void addFrames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
         void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
+        void resolveReadbacks(bool all);
+        void setWriterConfig(uint32_t threadCount, uint32_t maxQueuedImages);
+        void setUseSequenceFile(bool useSequenceFile);
+        void closeSequenceFile();
+
+        /** GPU readback of a captured image that has been issued but not yet handed to the writer.
+        */
+        struct PendingReadback
+        {
+            CopyContext::ReadTextureTask::SharedPtr pTask;
+            ref<Texture> pSource;       ///< Texture the readback was issued from. Kept alive until the readback is resolved.
+            std::filesystem::path path;
+            Bitmap::FileFormat fileFormat;
+            Bitmap::ExportFlags exportFlags;
+            uint64_t issueFrame;        ///< Value of mFrameCount when the readback was issued.
+            std::string sequenceOutput; ///< Output name in the sequence file, or empty if the image is written to its own file.
+            uint64_t frameID = 0;       ///< Frame ID in the sequence file.
+        };
 
         bool mCaptureAllOutputs = false;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+
+        uint32_t mReadbackLatency = 2;  ///< Number of frames a readback stays in flight before it is resolved.
+        uint32_t mWriterThreadCount = 4;
+        uint32_t mMaxQueuedImages = 16;
+        uint64_t mFrameCount = 0;
+        std::deque<PendingReadback> mPendingReadbacks;
+        std::unique_ptr<AsyncImageWriter> mpWriter;
+
+        bool mUseSequenceFile = false;  ///< Write all captured images into a single frame sequence file instead of one file per image.
+        std::filesystem::path mSequencePath;
+        std::unique_ptr<FrameSequenceFile::Writer> mpSequenceWriter; ///< Created on the first captured image, finalized in flush().
     };
 }
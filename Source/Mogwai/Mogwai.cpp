@@ -85,6 +85,7 @@ namespace Mogwai
     void Renderer::onShutdown()
     {
         resetEditor();
+        for (auto& e : mpExtensions) e->shutdown();
         getDevice()->flushAndSync(); // Need to do that because clearing the graphs will try to release some state objects which might be in use
         mGraphs.clear();
         if (mPipedOutput)
@@ -99,9 +100,6 @@ namespace Mogwai
 
     void Renderer::onLoad(RenderContext* pRenderContext)
     {
-        // Load all plugins
-        PluginManager::instance().loadAllPlugins();
-
         mpExtensions.push_back(MogwaiSettings::create(this));
         if (gExtensions)
         {
@@ -879,6 +877,7 @@ int main(int argc, char** argv)
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag preciseProgramFlag(parser, "", "Force all slang programs to run in precise mode", { "precise" });
     args::Flag hdrFlag(parser, "", "Use 16 bit swapchain for HDR displays", { "hdr" });
+    args::ValueFlag<std::string> pluginLoadingFlag(parser, "eager|parallel|lazy", "Plugin loading mode (parallel prefetches the plugin files on worker threads, lazy defers loading plugins until they are used).", { "plugin-loading" });
 
     args::CompletionFlag completionFlag(parser, {"complete"});
 
@@ -959,6 +958,20 @@ int main(int argc, char** argv)
         config.shaderPreciseFloat = true;
     if (hdrFlag)
         config.colorFormat = ResourceFormat::RGBA16Float;
+    if (pluginLoadingFlag)
+    {
+        if (args::get(pluginLoadingFlag) == "eager")
+            config.pluginLoadMode = PluginManager::LoadMode::Eager;
+        else if (args::get(pluginLoadingFlag) == "parallel")
+            config.pluginLoadMode = PluginManager::LoadMode::Parallel;
+        else if (args::get(pluginLoadingFlag) == "lazy")
+            config.pluginLoadMode = PluginManager::LoadMode::Lazy;
+        else
+        {
+            std::cerr << "Invalid plugin loading mode, use 'eager', 'parallel' or 'lazy'" << std::endl;
+            return 1;
+        }
+    }
 
     config.windowDesc.title = "Mogwai";
     if (widthFlag)
@@ -68,6 +68,7 @@ namespace Mogwai
         virtual void removeGraph(RenderGraph* pGraph) {};
         virtual void activeGraphChanged(RenderGraph* pNewGraph, RenderGraph* pPrevGraph) {};
         virtual void onOptionsChange(const SettingsProperties& settings){}
+        virtual void shutdown() {};
 
     protected:
         Extension(Renderer* pRenderer, const std::string& name) : mpRenderer(pRenderer), mName(name) {}
@@ -1,7 +1,8 @@
 #pragma once
 #include "Falcor.h"
+#include "Utils/Image/ConvolutionInference.h"
 #include <sstream>
-#include "../Utils/npy.h"
+#include "Utils/NumpyArray.h"
 
 struct ConvolutionNet
 {
@@ -54,7 +55,6 @@ struct ConvolutionNet
         kernels.resize(0);
         biases.resize(0);
 
-        std::vector<unsigned long> shape;
         int l = 0; // layer
         while (true)
         {
@@ -72,21 +72,24 @@ struct ConvolutionNet
             kernels.resize(l + 1);
             biases.resize(l + 1);
 
-            npy::LoadArrayFromNumpy<float>(kernelFilename, shape, kernels[l].data);
+            auto kernel = Falcor::NumpyArray::load(kernelFilename);
+            const auto& shape = kernel.getShape();
             assert(shape.size() == 4);
-            kernels[l].kernelHeight = shape[0];
-            kernels[l].kernelWidth = shape[1];
-            kernels[l].channelsIn = shape[2];
-            kernels[l].channelsOut = shape[3];
+            kernels[l].data = kernel.toVector<float>();
+            kernels[l].kernelHeight = (int)shape[0];
+            kernels[l].kernelWidth = (int)shape[1];
+            kernels[l].channelsIn = (int)shape[2];
+            kernels[l].channelsOut = (int)shape[3];
             // load biases
 
             if(std::filesystem::exists(biasFilename))
             {
-                npy::LoadArrayFromNumpy<float>(biasFilename, shape, biases[l].data);
+                auto bias = Falcor::NumpyArray::load(biasFilename);
+                biases[l].data = bias.toVector<float>();
                 biases[l].kernelHeight = 1;
                 biases[l].kernelWidth = 1;
                 biases[l].channelsIn = 1;
-                biases[l].channelsOut = shape[0];
+                biases[l].channelsOut = (int)bias.getShape()[0];
             }
             else
             {
@@ -259,6 +262,47 @@ struct ConvolutionNet
         return res;
     }
 
+    /**
+     * \brief creates a CPU inference engine that evaluates the same layers as the generated shaders
+     * \param clampOutput true if the last layer uses the clamp activation (as ConvolutionalNet does), false for no activation. Hidden layers use ReLU.
+     * \return inference engine. Note that the generated shaders embed the weights with 6 significant digits, so results can differ slightly.
+     */
+    Falcor::ConvolutionInference createCPUInference(bool clampOutput) const
+    {
+        std::vector<Falcor::ConvolutionInference::Layer> layers(kernels.size());
+        for (size_t l = 0; l < kernels.size(); ++l)
+        {
+            const auto& k = kernels[l];
+            auto& layer = layers[l];
+            layer.kernelWidth = k.kernelWidth;
+            layer.kernelHeight = k.kernelHeight;
+            layer.channelsIn = k.channelsIn;
+            layer.channelsOut = k.channelsOut;
+
+            // use the same weight lookup as the shader code generation
+            layer.weights.resize(size_t(k.kernelWidth) * k.kernelHeight * k.channelsIn * k.channelsOut);
+            for (int ky = 0; ky < k.kernelHeight; ++ky)
+                for (int kx = 0; kx < k.kernelWidth; ++kx)
+                    for (int chIn = 0; chIn < k.channelsIn; ++chIn)
+                        for (int chOut = 0; chOut < k.channelsOut; ++chOut)
+                            layer.weights[((size_t(ky) * k.kernelWidth + kx) * k.channelsIn + chIn) * k.channelsOut + chOut] = k.get(kx, ky, chIn, chOut);
+
+            for (int chOut = 0; chOut < k.channelsOut; ++chOut)
+                layer.bias.push_back(biases[l].getBias(chOut));
+
+            if (l + 1 < kernels.size()) layer.activation = Falcor::ConvolutionInference::Activation::ReLU;
+            else layer.activation = clampOutput ? Falcor::ConvolutionInference::Activation::Clamp : Falcor::ConvolutionInference::Activation::None;
+        }
+        return Falcor::ConvolutionInference(std::move(layers));
+    }
+
+    static Falcor::ConvolutionInference::Precision getCPUInferencePrecision(Precision precision)
+    {
+        if (precision == Precision::Half) return Falcor::ConvolutionInference::Precision::Half;
+        if (precision == Precision::UNorm) return Falcor::ConvolutionInference::Precision::UNorm;
+        return Falcor::ConvolutionInference::Precision::Float;
+    }
+
     int getLayerCount() const { return int(kernels.size()); }
     int getOutputChannelCount(int layer) const { return kernels[layer].channelsOut; }
     int getInputChannelCount(int layer) const { return kernels[layer].channelsIn; }
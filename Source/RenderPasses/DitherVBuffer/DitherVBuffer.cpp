@@ -43,11 +43,31 @@ namespace
     const std::string kUseWhitelist = "useWhitelist";
     const std::string kWhitelist = "whitelist";
     const std::string kWhitelistBuffer = "whitelistBuffer"; // GPU Buffer for whitelist
+
+    // selects fully stochastic, fully baseline (alpha test) or hybrid visibility
+    void setVisibilityDefines(DefineList& defines, float minVisibility)
+    {
+        defines.remove("FULL_STOCHASTIC");
+        defines.remove("FULL_BASELINE");
+        if (minVisibility >= 1.0f)
+            defines.add("FULL_STOCHASTIC"); // ~5% faster than hybrid
+        else if (minVisibility <= 0.0f)
+            defines.add("FULL_BASELINE");
+    }
+}
+
+static void regDitherVBuffer(pybind11::module& m)
+{
+    pybind11::class_<DitherVBuffer, RenderPass, ref<DitherVBuffer>> pass(m, "DitherVBuffer");
+    pass.def("precompilePermutations", &DitherVBuffer::precompilePermutations);
+    pass.def_property_readonly("isPrecompiling", &DitherVBuffer::isPrecompiling);
+    pass.def_property_readonly("precompileProgress", [](const DitherVBuffer& self) { return self.getPrecompileProgress().getFraction(); });
 }
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
 {
     registry.registerClass<RenderPass, DitherVBuffer>();
+    ScriptBindings::registerBinding(regDitherVBuffer);
 }
 
 DitherVBuffer::DitherVBuffer(ref<Device> pDevice, const Properties& props)
@@ -182,20 +202,14 @@ void DitherVBuffer::execute(RenderContext* pRenderContext, const RenderData& ren
     mpProgram->addDefine("CULL_BACK_FACES", mCullBackFaces ? "1" : "0");
     mpProgram->addDefines(ShadowSettings::get().getShaderDefines(*mpScene, renderData.getDefaultTextureDims()));
 
-    if(mMinVisibility >= 1.0f)
-    {
-        mpProgram->addDefine("FULL_STOCHASTIC"); // ~5% faster than hybrid
-        mpProgram->removeDefine("FULL_BASELINE");
-    }
-    else if(mMinVisibility <= 0.0f)
-    {
-        mpProgram->removeDefine("FULL_STOCHASTIC");
-        mpProgram->addDefine("FULL_BASELINE");
-    }
-    else
+    DefineList defines = mpProgram->getDefineList();
+    setVisibilityDefines(defines, mMinVisibility);
+    mpProgram->setDefines(defines);
+
+    if (mPrecompileRequested)
     {
-        mpProgram->removeDefine("FULL_STOCHASTIC");
-        mpProgram->removeDefine("FULL_BASELINE");
+        mPrecompileRequested = false;
+        mPrecompiler.start(mpProgram, getProgramPermutations());
     }
 
     uint3 dispatch = uint3(1);
@@ -285,6 +299,19 @@ void DitherVBuffer::renderUI(Gui::Widgets& widget)
         }
     }
 
+    if (auto g = widget.group("Precompile"))
+    {
+        if (!isPrecompiling())
+        {
+            if (g.button("Precompile Permutations"))
+                precompilePermutations();
+            g.tooltip("Compiles all dither and visibility modes in the background, so switching between them doesn't stall.");
+        }
+        auto progress = getPrecompileProgress();
+        if (progress.total > 0)
+            g.text(fmt::format("Compiled {}/{} ({} failed)", progress.completed, progress.total, progress.failed));
+    }
+
     widget.dropdown("Correction", mCoverageCorrection);
     if (mCoverageCorrection != CoverageCorrection::Disabled)
     {
@@ -333,6 +360,8 @@ void DitherVBuffer::renderUI(Gui::Widgets& widget)
 
 void DitherVBuffer::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
 {
+    mPrecompiler.cancel();
+    mPrecompileRequested = false;
     mpScene = pScene;
     setupProgram();
     mUseTransparencyWhitelist = updateWhitelistBuffer();
@@ -395,6 +424,24 @@ bool DitherVBuffer::updateWhitelistBuffer()
     return updateWhitelist(mpDevice, mpScene, mTransparencyWhitelist, mpTransparencyWhitelist);
 }
 
+std::vector<DefineList> DitherVBuffer::getProgramPermutations() const
+{
+    // dither mode and visibility are the defines that are switched during comparisons.
+    // noise patterns and the other dither parameters are shader constants and don't need permutations.
+    std::vector<DefineList> permutations;
+    for (const auto& item : EnumInfo<DitherMode>::items())
+    {
+        for (float minVisibility : { 1.0f, 0.5f, 0.0f })
+        {
+            DefineList defines = mpProgram->getDefineList();
+            defines.add("DITHER_MODE", std::to_string(uint32_t(item.first)));
+            setVisibilityDefines(defines, minVisibility);
+            permutations.push_back(std::move(defines));
+        }
+    }
+    return permutations;
+}
+
 void DitherVBuffer::createNoisePattern()
 {
     std::string texname;
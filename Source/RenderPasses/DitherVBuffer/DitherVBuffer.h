@@ -28,6 +28,7 @@
 #pragma once
 #include "Falcor.h"
 #include "RenderGraph/RenderPass.h"
+#include "Core/Program/ProgramPrecompiler.h"
 #include "Utils/SampleGenerators/HaltonSamplePattern.h"
 #include "Utils/SampleGenerators/StratifiedSamplePattern.h"
 #include "TransparencyWhitelist.h"
@@ -233,6 +234,12 @@ public:
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override { return false; }
     virtual bool onKeyEvent(const KeyboardEvent& keyEvent) override { return false; }
 
+    // compiles all dither mode and visibility permutations of the program in the background.
+    // the permutations are derived from the program defines of the next executed frame.
+    void precompilePermutations() { mPrecompileRequested = true; }
+    bool isPrecompiling() const { return mPrecompileRequested || mPrecompiler.isRunning(); }
+    ProgramPrecompiler::Progress getPrecompileProgress() const { return mPrecompiler.getProgress(); }
+
     static uint2 getRenderSize(uint2 displaySize, RenderScale scale)
     {
         uint2 res = displaySize;
@@ -262,6 +269,7 @@ private:
     // returns true if at least one material was whitelisted (or scene was invalid)
     bool updateWhitelistBuffer();
     void createNoisePattern();
+    std::vector<DefineList> getProgramPermutations() const;
 
     ref<Scene> mpScene;
     
@@ -309,6 +317,9 @@ private:
     std::vector<int> mPermutations3x3Scores;
     std::vector<Gui::DropdownValue> mPermutations3x3Dropdown;
     uint32_t mPermutations3x3Score = 0; 
+
+    bool mPrecompileRequested = false;
+    ProgramPrecompiler mPrecompiler;
 };
 
 FALCOR_ENUM_REGISTER(DitherVBuffer::DitherMode);
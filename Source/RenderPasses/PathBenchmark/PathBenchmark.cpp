@@ -30,21 +30,46 @@
 #include <fstream>
 
 #include "RenderGraph/RenderPassStandardFlags.h"
+#include "Core/Version.h"
+
+namespace
+{
+    const char kRecordAll[] = "recordAll";
+
+    void registerBindings(pybind11::module& m)
+    {
+        using namespace pybind11::literals;
+
+        pybind11::class_<PathBenchmark, RenderPass, ref<PathBenchmark>> pass(m, "PathBenchmark");
+        pass.def("set_metadata", &PathBenchmark::setMetadata, "key"_a, "value"_a);
+        pass.def("write_results", &PathBenchmark::writeResults, "path"_a);
+        pass.def("reset", &PathBenchmark::reset);
+    }
+}
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
 {
     registry.registerClass<RenderPass, PathBenchmark>();
+    Falcor::ScriptBindings::registerBinding(registerBindings);
 }
 
 PathBenchmark::PathBenchmark(ref<Device> pDevice, const Properties& props)
     : RenderPass(pDevice)
 {
     mpProfiler = mpDevice->getProfiler();
+
+    for (const auto& [key, value] : props)
+    {
+        if (key == kRecordAll) mRecordAll = value;
+        else logWarning("Unknown property '{}' in PathBenchmark properties.", key);
+    }
 }
 
 Properties PathBenchmark::getProperties() const
 {
-    return {};
+    Properties props;
+    props[kRecordAll] = mRecordAll;
+    return props;
 }
 
 RenderPassReflection PathBenchmark::reflect(const CompileData& compileData)
@@ -80,7 +105,12 @@ void PathBenchmark::execute(RenderContext* pRenderContext, const RenderData& ren
     const auto& events = mpProfiler->getEvents();
     for (const auto& e : events)
     {
+        if (mRecordAll) mEnabled[e->getName()] = true;
         if (!mEnabled[e->getName()]) continue;
+
+        // Keep every frame's measurement for the statistics, including frames where the time is stopped.
+        mSamples[e->getName()].push_back(e->getGpuTime());
+
         auto& vec = mTimes[e->getName()];
         if(overwrite && !vec.empty()) vec.back() = e->getGpuTimeAverage();
         else vec.push_back(e->getGpuTimeAverage());
@@ -161,10 +191,22 @@ void PathBenchmark::renderUI(Gui::Widgets& widget)
                 auto& times = *(std::vector<float>*)user;
                 return times[index];
             }, &times, uint32_t(times.size()), 0, 0.0f, max_time, 0, 100);
+
+            if (auto it = mSummaries.find(name); it != mSummaries.end())
+            {
+                const auto& summary = it->second;
+                g.text(fmt::format(
+                    "median {:.4f} ms [{:.4f}, {:.4f}], MAD {:.4f}\n{} samples, {} warm-up, {} outliers",
+                    summary.median, summary.ciLower, summary.ciUpper, summary.mad, summary.sampleCount, summary.warmupCount, summary.outlierCount
+                ));
+            }
         }
     }
     g.release();
 
+    // The bootstrap is too expensive to run every frame, so statistics are only computed on demand.
+    if (widget.button("Compute statistics")) updateSummaries();
+
     if (reset) this->reset();
 
     if(widget.button("Export"))
@@ -174,10 +216,19 @@ void PathBenchmark::renderUI(Gui::Widgets& widget)
         if (saveFileDialog(filters, path))
             writeCsv(path.string());
     }
+
+    if(widget.button("Export results", true))
+    {
+        FileDialogFilterVec filters = { {"json"} };
+        std::filesystem::path path;
+        if (saveFileDialog(filters, path))
+            writeResults(path);
+    }
 }
 
 void PathBenchmark::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
 {
+    mScenePath = pScene ? pScene->getPath() : std::filesystem::path();
     if(pScene)
     {
         auto anim = pScene->getAnimationController();
@@ -193,6 +244,39 @@ void PathBenchmark::reset()
 {
     mTimestamps.resize(0);
     mTimes.clear();
+    mSamples.clear();
+    mSummaries.clear();
+}
+
+BenchmarkStatistics::Run PathBenchmark::getRun() const
+{
+    BenchmarkStatistics::Run run;
+    run.metadata = mMetadata;
+    run.metadata["scene"] = mScenePath.string();
+    run.metadata["resolution"] = fmt::format("{}x{}", mResolution.x, mResolution.y);
+    run.metadata["build"] = getLongVersionString();
+    run.metadata["device"] = mpDevice->getInfo().adapterName;
+
+    for (const auto& [name, samples] : mSamples)
+    {
+        auto it = mEnabled.find(name);
+        if (it != mEnabled.end() && it->second) run.samples[name] = samples;
+    }
+    return run;
+}
+
+void PathBenchmark::writeResults(const std::filesystem::path& path) const
+{
+    auto run = getRun();
+    run.writeToFile(path);
+    logInfo("PathBenchmark: Wrote results of {} events to '{}'.", run.samples.size(), path);
+}
+
+void PathBenchmark::updateSummaries()
+{
+    mSummaries.clear();
+    for (const auto& [name, samples] : getRun().samples)
+        mSummaries[name] = BenchmarkStatistics::summarize(samples);
 }
 
 void PathBenchmark::writeCsv(const std::string& filename) const
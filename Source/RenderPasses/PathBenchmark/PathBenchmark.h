@@ -28,6 +28,7 @@
 #pragma once
 #include "Falcor.h"
 #include "RenderGraph/RenderPass.h"
+#include "Utils/Timing/BenchmarkStatistics.h"
 
 using namespace Falcor;
 
@@ -42,20 +43,41 @@ public:
 
     virtual Properties getProperties() const override;
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
-    virtual void compile(RenderContext* pRenderContext, const CompileData& compileData) override {}
+    virtual void compile(RenderContext* pRenderContext, const CompileData& compileData) override { mResolution = compileData.defaultTexDims; }
     virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
     virtual void renderUI(Gui::Widgets& widget) override;
     virtual void setScene(RenderContext* pRenderContext, const ref<Scene>& pScene) override;
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override { return false; }
     virtual bool onKeyEvent(const KeyboardEvent& keyEvent) override { return false; }
 
-private:
+    /** Set a metadata entry stored with the benchmark results (e.g., graph name).
+    */
+    void setMetadata(const std::string& key, const std::string& value) { mMetadata[key] = value; }
+
+    /** Get the recorded per-frame GPU times of all enabled events, together with metadata describing the run.
+    */
+    BenchmarkStatistics::Run getRun() const;
+
+    /** Write the benchmark results as JSON. The file can be compared against another run with the BenchmarkCompare tool.
+    */
+    void writeResults(const std::filesystem::path& path) const;
+
     void reset();
+
+private:
     void writeCsv(const std::string& filename) const;
+    void updateSummaries();
 
     Profiler* mpProfiler = nullptr;
     std::unordered_map<std::string, bool> mEnabled;
     std::vector<float> mTimestamps; // timestamps corresponding to the values in mTimes
     std::unordered_map<std::string, std::vector<float>> mTimes;
     float mLastTime = 0.0;
+
+    bool mRecordAll = false; // record all events, not only the ones enabled in the UI
+    std::unordered_map<std::string, std::vector<float>> mSamples; // raw per-frame GPU times
+    std::unordered_map<std::string, BenchmarkStatistics::Summary> mSummaries;
+    std::map<std::string, std::string> mMetadata;
+    std::filesystem::path mScenePath;
+    uint2 mResolution = {};
 };
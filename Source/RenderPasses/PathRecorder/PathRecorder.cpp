@@ -26,7 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "PathRecorder.h"
-#include "Utils/Image/npy.h"
+#include "Utils/NumpyArray.h"
 #include <random>
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
@@ -115,9 +115,9 @@ void PathRecorder::renderUI(Gui::Widgets& widget)
     {
         // save as numpy file
         const float* floatData = reinterpret_cast<const float*>(mPoints.data());
-        const unsigned long floatCount = mPoints.size() * (sizeof(PathPoint)/sizeof(float));
+        const size_t floatCount = mPoints.size() * (sizeof(PathPoint)/sizeof(float));
 
-        npy::SaveArrayAsNumpy("path.npy", false, 1, &floatCount, floatData);
+        NumpyArray::fromData(floatData, {floatCount}).save("path.npy");
     }
 
     if(widget.button("Load Numpy"))
@@ -160,14 +160,21 @@ std::vector<PathPoint> PathRecorder::loadPathPoints()
 {
     std::vector<PathPoint> res;
 
-    std::vector<unsigned long> shape;
+    if (!std::filesystem::exists("path.npy")) return res;
+
     std::vector<float> data;
-    npy::LoadArrayFromNumpy("path.npy", shape, data);
-    if (shape.empty()) return res; // could not find?
+    try
+    {
+        data = NumpyArray::load("path.npy").toVector<float>();
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to load path points: {}", e.what());
+        return res;
+    }
 
-    assert(shape.size() == 1);
     PathPoint* pFirst = reinterpret_cast<PathPoint*>(data.data());
-    PathPoint* pLast = reinterpret_cast<PathPoint*>(data.data() + shape[0]);
+    PathPoint* pLast = reinterpret_cast<PathPoint*>(data.data() + data.size() - data.size() % (sizeof(PathPoint) / sizeof(float)));
     res.assign(pFirst, pLast);
     return res;
 }
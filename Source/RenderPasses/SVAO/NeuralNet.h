@@ -1,7 +1,7 @@
 #pragma once
 #include "Falcor.h"
 #include <sstream>
-#include "../Utils/npy.h"
+#include "Utils/NumpyArray.h"
 
 // helper class that loads a neural net from a file
 struct NeuralNet
@@ -18,7 +18,6 @@ struct NeuralNet
         kernels.resize(0);
         biases.resize(0);
 
-        std::vector<unsigned long> shape;
         int l = 0; // layer
         while(true)
         {
@@ -36,14 +35,16 @@ struct NeuralNet
             kernels.resize(l + 1);
             biases.resize(l + 1);
 
-            npy::LoadArrayFromNumpy<float>(kernelFilename, shape, kernels[l].data);
-            kernels[l].rows = shape[0];
-            kernels[l].columns = shape[1];
+            auto kernel = Falcor::NumpyArray::load(kernelFilename);
+            kernels[l].data = kernel.toVector<float>();
+            kernels[l].rows = (int)kernel.getShape()[0];
+            kernels[l].columns = (int)kernel.getShape()[1];
             // load biases
 
-            npy::LoadArrayFromNumpy<float>(biasFilename, shape, biases[l].data);
+            auto bias = Falcor::NumpyArray::load(biasFilename);
+            biases[l].data = bias.toVector<float>();
             biases[l].rows = 1;
-            biases[l].columns = shape[0];
+            biases[l].columns = (int)bias.getShape()[0];
 
             ++l;
         }
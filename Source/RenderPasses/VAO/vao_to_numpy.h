@@ -5,9 +5,10 @@
 #include <gli/gli.hpp>
 #pragma warning( pop )
 
-#include "npy.h"
+#include "Utils/NumpyArray.h"
 #include <iostream>
 #include <numeric>
+#include <optional>
 
 #define FORCE_RAY_OUT_OF_SCREEN 1
 #define FORCE_RAY_DOUBLE_SIDED 2
@@ -45,31 +46,31 @@ void vao_to_numpy(const std::vector<float> sphereStart,
     auto height = texRaster.extent().y;
     assert(texRaster.layers() == NUM_SAMPLES);
 
-    // prepare data in float vector
-    std::vector<float> rasterSamples;
-    std::vector<float> raySamples;
-    std::vector<int> pixelXY; // x,y coordinates of pixel
-    std::vector<uint8_t> required; // 1 if ray tracing is required, 0 if not (x8)
-    std::vector<uint8_t> requiredForced;
-    std::vector<uint8_t> asked; // 1 if we want to ask the neural net for a prediction
-    std::vector<float> sphereEndSamples;
-    std::vector<float> sphereStartSamples;
+    // stream the samples to numpy files, one row of NUM_SAMPLES values per pixel
+    using Falcor::NumpyArrayWriter;
+    using Falcor::NumpyDType;
+    const auto strIndex = std::to_string(index);
+    const std::string suffix = (IsTraining ? "_train_" : "_eval_") + strIndex + ".npy";
+    NumpyArrayWriter rasterSamples("raster" + suffix, NumpyDType::Float32, { NUM_SAMPLES });
+    NumpyArrayWriter raySamples("ray" + suffix, NumpyDType::Float32, { NUM_SAMPLES });
+    NumpyArrayWriter sphereStartSamples("sphere_start" + suffix, NumpyDType::Float32, { NUM_SAMPLES });
+    NumpyArrayWriter sphereEndSamples("sphere_end" + suffix, NumpyDType::Float32, { NUM_SAMPLES });
+    NumpyArrayWriter required("required" + suffix, NumpyDType::UInt8, { NUM_SAMPLES }); // 1 if ray tracing is required, 0 if not (x8)
+    NumpyArrayWriter asked("asked" + suffix, NumpyDType::UInt8, { NUM_SAMPLES }); // 1 if we want to ask the neural net for a prediction
+    // only exported for evaluation
+    std::optional<NumpyArrayWriter> requiredForced;
+    std::optional<NumpyArrayWriter> pixelXY; // x,y coordinates of pixel
+    if (!IsTraining)
+    {
+        requiredForced.emplace("required_forced" + suffix, NumpyDType::UInt8, std::vector<size_t>{ NUM_SAMPLES });
+        pixelXY.emplace("pixelXY_" + strIndex + ".npy", NumpyDType::Int32, std::vector<size_t>{ 2 });
+    }
+    size_t numAsked = 0;
+    size_t numRequired = 0;
 
     //std::vector<int> forcedPixels; // XYi coordinates of the pixel that was forced to be ray traced (or is invalid, in which case the saved ao is 1.0)
     //std::vector<int> numInvalid; // number of invalid samples
 
-    rasterSamples.reserve(width * height * NUM_SAMPLES);
-    raySamples.reserve(width * height * NUM_SAMPLES);
-    //sameInstance.reserve(width * height * nSamples);
-    //rasterInstanceDiffs.reserve(width * height * nSamples);
-    pixelXY.reserve(width * height * 2);
-    required.reserve(width * height * NUM_SAMPLES);
-    asked.reserve(width * height * NUM_SAMPLES);
-    sphereEndSamples.reserve(width * height * NUM_SAMPLES);
-    sphereStartSamples.reserve(width * height * NUM_SAMPLES);
-
-    //forcedPixels.reserve(width * height * 3 * NUM_SAMPLES);
-
     // local arrays
     std::array<float, NUM_SAMPLES> raster;
     std::array<float, NUM_SAMPLES> ray;
@@ -163,63 +164,34 @@ void vao_to_numpy(const std::vector<float> sphereStart,
         
 
         // use this sample
-        rasterSamples.insert(rasterSamples.end(), raster.begin(), raster.end());
-        raySamples.insert(raySamples.end(), ray.begin(), ray.end());
-
-        pixelXY.push_back(x);
-        pixelXY.push_back(y);
-        asked.insert(asked.end(), askRay.begin(), askRay.end());
-        required.insert(required.end(), requireRay.begin(), requireRay.end());
-        requiredForced.insert(requiredForced.end(), forceRay.begin(), forceRay.end());
-        sphereEndSamples.insert(sphereEndSamples.end(), sphereEnd.begin(), sphereEnd.end());
-        sphereStartSamples.insert(sphereStartSamples.end(), sphereStart.begin(), sphereStart.end());
+        rasterSamples.append(raster.data(), raster.size());
+        raySamples.append(ray.data(), ray.size());
+        sphereStartSamples.append(sphereStart.data(), sphereStart.size());
+        sphereEndSamples.append(sphereEnd.data(), sphereEnd.size());
+        required.append(requireRay.data(), requireRay.size());
+        asked.append(askRay.data(), askRay.size());
+        if (requiredForced)
+            requiredForced->append(forceRay.data(), forceRay.size());
+        if (pixelXY)
+        {
+            const int xy[2] = { x, y };
+            pixelXY->append(xy, 2);
+        }
+        numAsked += std::accumulate(askRay.begin(), askRay.end(), size_t(0));
+        numRequired += std::accumulate(requireRay.begin(), requireRay.end(), size_t(0));
     }
 
-    const auto strIndex = std::to_string(index);
-
     // print out number of all samples, empty samples and skipped samples
     std::cout << "Dubious samples (ray > raster): " << dubiousSamples << std::endl;
-    unsigned long remainingSamples = (unsigned long)(required.size() / NUM_SAMPLES);
+    size_t remainingSamples = required.getRowCount();
 
     std::cout << "Remaining samples: " << remainingSamples << std::endl;
 
-    auto numAsked = std::accumulate(asked.begin(), asked.end(), size_t(0));
-    auto numRequired = std::accumulate(required.begin(), required.end(), size_t(0));
     std::cout << "Num Asked: " << numAsked << std::endl;
     std::cout << "Num Required: " << numRequired << std::endl;
     std::cout << "Num Double Sided (forced): " << numDoubleSided << std::endl;
     std::cout << "Num Invalid (below hemisphere): " << numInvalid << std::endl;
     std::cout << "Num Excluded because of screen border: " << numOutOfScreen / NUM_SAMPLES << std::endl;
-
-
-    // write to numpy files
-    unsigned long shapeSamples[] = { remainingSamples, (unsigned long)NUM_SAMPLES }; // shape = rows, columns
-    unsigned long shapeRequired[] = { remainingSamples, (unsigned long)NUM_SAMPLES };
-    unsigned long shapeXY[] = { remainingSamples, 2ul };
-
-    if (IsTraining)
-    {
-        npy::SaveArrayAsNumpy("raster_train_" + strIndex + ".npy", false, 2, shapeSamples, rasterSamples);
-        npy::SaveArrayAsNumpy("ray_train_" + strIndex + ".npy", false, 2, shapeSamples, raySamples);
-        npy::SaveArrayAsNumpy("sphere_start_train_" + strIndex + ".npy", false, 2, shapeSamples, sphereStartSamples);
-        npy::SaveArrayAsNumpy("sphere_end_train_" + strIndex + ".npy", false, 2, shapeSamples, sphereEndSamples);
-        
-        npy::SaveArrayAsNumpy("required_train_" + strIndex + ".npy", false, 2, shapeRequired, required);
-        npy::SaveArrayAsNumpy("asked_train_" + strIndex + ".npy", false, 2, shapeRequired, asked);
-        //npy::SaveArrayAsNumpy("required_forced_train_" + strIndex + ".npy", false, 2, shapeRequired, requiredForced);
-    }
-    else
-    {
-        npy::SaveArrayAsNumpy("raster_eval_" + strIndex + ".npy", false, 2, shapeSamples, rasterSamples);
-        npy::SaveArrayAsNumpy("ray_eval_" + strIndex + ".npy", false, 2, shapeSamples, raySamples);
-        npy::SaveArrayAsNumpy("sphere_start_eval_" + strIndex + ".npy", false, 2, shapeSamples, sphereStartSamples);
-        npy::SaveArrayAsNumpy("sphere_end_eval_" + strIndex + ".npy", false, 2, shapeSamples, sphereEndSamples);
-
-        npy::SaveArrayAsNumpy("required_eval_" + strIndex + ".npy", false, 2, shapeRequired, required);
-        npy::SaveArrayAsNumpy("asked_eval_" + strIndex + ".npy", false, 2, shapeRequired, asked);
-        npy::SaveArrayAsNumpy("required_forced_eval_" + strIndex + ".npy", false, 2, shapeRequired, requiredForced);
-        npy::SaveArrayAsNumpy("pixelXY_" + strIndex + ".npy", false, 2, shapeXY, pixelXY);
-    }
 }
 
 void vao_importance_to_numpy(
@@ -315,14 +287,14 @@ void vao_importance_to_numpy(
     const auto strIndex = std::to_string(index);
 
     // print out number of all samples, empty samples and skipped samples
-    unsigned long remainingSamples = (unsigned long)(rasterAO.size());
+    size_t remainingSamples = rasterAO.size();
 
     std::cout << "Remaining samples: " << remainingSamples << std::endl;
     std::cout << "Num Double Sided (forced): " << numDoubleSided << std::endl;
     std::cout << "Num Excluded because of screen border: " << numOutOfScreen / NUM_SAMPLES << std::endl;
 
 
-    // shuffle all arrays with the same seed
+    // shuffle all arrays with the same seed (this needs all samples in memory, so they are not streamed)
     std::shuffle(rasterAO.begin(), rasterAO.end(), std::default_random_engine(0));
     std::shuffle(rayAO.begin(), rayAO.end(), std::default_random_engine(0));
     std::shuffle(radiusImportance.begin(), radiusImportance.end(), std::default_random_engine(0));
@@ -331,13 +303,13 @@ void vao_importance_to_numpy(
     std::shuffle(contributionImportance.begin(), contributionImportance.end(), std::default_random_engine(0));
 
     // write to numpy files
-    unsigned long* shape = &remainingSamples;
+    const std::vector<size_t> shape = { remainingSamples };
     
-    npy::SaveArrayAsNumpy("rasterao_" + strIndex + ".npy", false, 1, shape, rasterAO);
-    npy::SaveArrayAsNumpy("rayao_" + strIndex + ".npy", false, 1, shape, rayAO);
+    Falcor::NumpyArray::fromVector(std::move(rasterAO), shape).save("rasterao_" + strIndex + ".npy");
+    Falcor::NumpyArray::fromVector(std::move(rayAO), shape).save("rayao_" + strIndex + ".npy");
 
-    npy::SaveArrayAsNumpy("radius_importance_" + strIndex + ".npy", false, 1, shape, radiusImportance);
-    npy::SaveArrayAsNumpy("normal_importance_" + strIndex + ".npy", false, 1, shape, normalImportance);
-    npy::SaveArrayAsNumpy("distance_importance_" + strIndex + ".npy", false, 1, shape, distanceImportance);
-    npy::SaveArrayAsNumpy("contribution_importance_" + strIndex + ".npy", false, 1, shape, contributionImportance);
+    Falcor::NumpyArray::fromVector(std::move(radiusImportance), shape).save("radius_importance_" + strIndex + ".npy");
+    Falcor::NumpyArray::fromVector(std::move(normalImportance), shape).save("normal_importance_" + strIndex + ".npy");
+    Falcor::NumpyArray::fromVector(std::move(distanceImportance), shape).save("distance_importance_" + strIndex + ".npy");
+    Falcor::NumpyArray::fromVector(std::move(contributionImportance), shape).save("contribution_importance_" + strIndex + ".npy");
 }
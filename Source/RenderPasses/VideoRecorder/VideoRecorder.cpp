@@ -207,6 +207,8 @@ void VideoRecorder::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget
         }
         if (mOutputs.empty()) widget.tooltip("No outputs selected. Nothing will be saved to file!");
         widget.checkbox("Cut Guard Band", mCutGuardBand, true);
+        widget.checkbox("Write Sequence File", mWriteSequence);
+        widget.tooltip("Additionally store the rendered frames losslessly in a compressed frame sequence file (.fseq).");
     }
     widget.textbox("Folder Prefix", mOutputPrefixFolder);
     widget.tooltip("Leave empty if no folder is desired");
@@ -407,9 +409,50 @@ void VideoRecorder::saveFrame(RenderContext* pRenderContext)
 
         //tex->captureToFile(0, 0, filename.str(), Bitmap::FileFormat::BmpFile);
         mpBlitTexture->captureToFile(0, 0, filename.str(), Bitmap::FileFormat::BmpFile);
+
+        if (mWriteSequence)
+        {
+            try
+            {
+                if (!mpSequenceWriter) mpSequenceWriter = std::make_unique<FrameSequenceFile::Writer>(getOutputFilename("frames", "fseq"));
+                uint32_t sequenceOutput = mpSequenceWriter->addOutput(outputName, mpBlitTexture->getWidth(), mpBlitTexture->getHeight(), mpBlitTexture->getFormat());
+                auto data = pRenderContext->readTextureSubresource(mpBlitTexture.get(), 0);
+                mpSequenceWriter->writeImage(mRenderIndex, sequenceOutput, data.data());
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write frame to sequence file: {}", e.what());
+                mpSequenceWriter.reset();
+                mWriteSequence = false;
+            }
+        }
     }
 }
 
+std::string VideoRecorder::getOutputFilename(const std::string& name, const std::string& extension) const
+{
+    if (mOutputPrefixFolder.empty()) return mOutputPrefix + name + "." + extension;
+
+    if (!folderExists(mOutputPrefixFolder))
+        createFolder(mOutputPrefixFolder);
+    return mOutputPrefixFolder + "/" + mOutputPrefix + name + "." + extension;
+}
+
+void VideoRecorder::closeSequenceFile()
+{
+    if (!mpSequenceWriter) return;
+
+    try
+    {
+        mpSequenceWriter->finalize();
+    }
+    catch (const std::exception& e)
+    {
+        logError("Failed to finalize sequence file: {}", e.what());
+    }
+    mpSequenceWriter.reset();
+}
+
 void VideoRecorder::updateCamera()
 {
     if (!mpScene) return;
@@ -633,6 +676,8 @@ void VideoRecorder::stopRender()
 
     mpGlobalClock->setFramerate(0); //Reset framerate simulation
 
+    closeSequenceFile();
+
     // create video files for each output
     for (const auto& target : mOutputs)
     {
@@ -648,15 +693,7 @@ void VideoRecorder::stopRender()
         auto filenameBase = outputName + "/frame" + outputName;
         char buffer[2048];
 
-        std::string outputFilename;
-        if (!mOutputPrefixFolder.empty())
-        {
-            if (!folderExists(mOutputPrefixFolder))
-                createFolder(mOutputPrefixFolder);
-            outputFilename = mOutputPrefixFolder + "/" + mOutputPrefix + outputName + ".mp4";
-        }
-        else
-            outputFilename = mOutputPrefix + outputName + ".mp4";
+        std::string outputFilename = getOutputFilename(outputName, "mp4");
 
         deleteFile(outputFilename); // delete old file (otherwise ffmpeg will not write anything)
         sprintf_s(buffer, "ffmpeg -r %d -i %s%%04d.bmp -c:v libx264 -preset medium -crf 12 -vf \"fps=%d,format=yuv420p\" \"%s\" 2>&1", mFps, filenameBase.c_str(), mFps, outputFilename.c_str());
@@ -832,6 +869,7 @@ void VideoRecorder::forceIdle()
         //stopRender();
         //break;
     case State::Warmup:
+        closeSequenceFile();
         mState = State::Idle;
         break;
     }
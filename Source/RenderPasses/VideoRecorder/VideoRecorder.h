@@ -29,6 +29,7 @@
 #include "Falcor.h"
 #include "RenderGraph/RenderPass.h"
 #include "Utils/Timing/Clock.h"
+#include "Utils/Image/FrameSequenceFile.h"
 
 using namespace Falcor;
 
@@ -100,6 +101,9 @@ private:
 
     void refreshFileList();
 
+    std::string getOutputFilename(const std::string& name, const std::string& extension) const;
+    void closeSequenceFile();
+
     // forces to return to idle state
     void forceIdle();
 
@@ -129,4 +133,7 @@ private:
     int guardBand = 0;
     ref<Texture> mpBlitTexture;
     bool mCutGuardBand = true;
+
+    bool mWriteSequence = false; // additionally store the rendered frames losslessly in a frame sequence file
+    std::unique_ptr<FrameSequenceFile::Writer> mpSequenceWriter;
 };
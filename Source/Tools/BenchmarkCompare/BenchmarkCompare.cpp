@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Utils/Timing/BenchmarkStatistics.h"
+#include "Core/Errors.h"
+
+#include <args.hxx>
+#include <fmt/format.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Falcor;
+
+namespace
+{
+void printRun(const char* label, const BenchmarkStatistics::Run& run)
+{
+    std::cout << label << ":" << std::endl;
+    for (const auto& [key, value] : run.metadata)
+        std::cout << fmt::format("  {}: {}", key, value) << std::endl;
+}
+
+void printComparison(const BenchmarkStatistics::Comparison& c)
+{
+    std::cout << fmt::format(
+                     "{:<11} {:+7.2f}% [{:+7.2f}%, {:+7.2f}%]  {:.4f} -> {:.4f} ms  {}", enumToString(c.verdict), 100.0 * c.relativeChange,
+                     100.0 * c.ciLower, 100.0 * c.ciUpper, c.baseline.median, c.candidate.median, c.name
+                 )
+              << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Utility to compare benchmark results written by the PathBenchmark render pass.");
+    parser.helpParams.programName = "BenchmarkCompare";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<double> minChangeFlag(parser, "fraction", "Minimum relative change to flag (default 0.01).", {'t', "threshold"});
+    args::ValueFlag<double> confidenceFlag(parser, "level", "Confidence level (default 0.95).", {'c', "confidence"});
+    args::ValueFlag<uint32_t> iterationsFlag(parser, "count", "Number of bootstrap iterations (default 2000).", {'i', "iterations"});
+    args::ValueFlag<std::string> baselineEventFlag(
+        parser, "name", "Compare this baseline event against the candidate event given by -e, instead of matching events by name.", {'b', "baseline-event"}
+    );
+    args::ValueFlag<std::string> candidateEventFlag(parser, "name", "Candidate event to compare against the baseline event.", {'e', "candidate-event"});
+    args::Positional<std::string> baselineFile(parser, "baseline", "The baseline results file.", args::Options::Required);
+    args::Positional<std::string> candidateFile(parser, "candidate", "The candidate results file.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    if (bool(baselineEventFlag) != bool(candidateEventFlag))
+    {
+        std::cerr << "Both --baseline-event and --candidate-event must be given." << std::endl;
+        return 1;
+    }
+
+    BenchmarkStatistics::Options options;
+    if (minChangeFlag)
+        options.minRelativeChange = args::get(minChangeFlag);
+    if (confidenceFlag)
+        options.confidenceLevel = args::get(confidenceFlag);
+    if (iterationsFlag)
+        options.bootstrapIterations = args::get(iterationsFlag);
+
+    try
+    {
+        BenchmarkStatistics::Run baseline = BenchmarkStatistics::Run::readFromFile(args::get(baselineFile));
+        BenchmarkStatistics::Run candidate = BenchmarkStatistics::Run::readFromFile(args::get(candidateFile));
+        printRun("Baseline", baseline);
+        printRun("Candidate", candidate);
+        std::cout << std::endl;
+
+        std::vector<BenchmarkStatistics::Comparison> comparisons;
+        if (baselineEventFlag)
+        {
+            auto baselineIt = baseline.samples.find(args::get(baselineEventFlag));
+            auto candidateIt = candidate.samples.find(args::get(candidateEventFlag));
+            if (baselineIt == baseline.samples.end() || candidateIt == candidate.samples.end())
+            {
+                std::cerr << "Event not found in results." << std::endl;
+                return 1;
+            }
+            comparisons.push_back(BenchmarkStatistics::compare(baselineIt->second, candidateIt->second, options));
+            comparisons.back().name = baselineIt->first + " -> " + candidateIt->first;
+        }
+        else
+        {
+            comparisons = BenchmarkStatistics::compare(baseline, candidate, options);
+        }
+
+        if (comparisons.empty())
+        {
+            std::cerr << "No common events found." << std::endl;
+            return 1;
+        }
+
+        size_t regressionCount = 0;
+        for (const auto& comparison : comparisons)
+        {
+            printComparison(comparison);
+            if (comparison.verdict == BenchmarkStatistics::Verdict::Regression)
+                regressionCount++;
+        }
+
+        std::cout << std::endl << fmt::format("{} of {} events regressed.", regressionCount, comparisons.size()) << std::endl;
+        return regressionCount > 0 ? 1 : 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/API/MegaPagePool.h"
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+struct MockPage
+{
+    uint32_t id = 0;
+};
+
+/// Mimics a GPU fence: the CPU value is signaled at the end of each frame and the GPU completes it later.
+struct MockFence
+{
+    uint64_t cpuValue = 1;
+    uint64_t gpuValue = 0;
+
+    void endFrame() { cpuValue++; }
+    void gpuComplete() { gpuValue = cpuValue - 1; }
+};
+} // namespace
+
+CPU_TEST(MegaPagePool_PageSize)
+{
+    MegaPagePool<MockPage> pool(4096, 0);
+    EXPECT_EQ(pool.getPageSize(1), 4096);
+    EXPECT_EQ(pool.getPageSize(4096), 4096);
+    EXPECT_EQ(pool.getPageSize(4097), 8192);
+    EXPECT_EQ(pool.getPageSize(5 * 4096 + 1), 6 * 4096);
+    // Large allocations are not rounded up to the next power of two.
+    EXPECT_EQ(pool.getPageSize((1ull << 40) + 1), (1ull << 40) + 4096);
+}
+
+CPU_TEST(MegaPagePool_FenceReuse)
+{
+    const size_t kMB = 1024 * 1024;
+    MockFence fence;
+    std::vector<uint32_t> evicted;
+    MegaPagePool<MockPage> pool(kMB, 64 * kMB, [&](MockPage& page) { evicted.push_back(page.id); });
+
+    MockPage page;
+    EXPECT(!pool.acquire(4 * kMB, fence.gpuValue, page));
+
+    // A page released this frame can't be reused until the GPU has completed the frame.
+    pool.release(MockPage{1}, pool.getPageSize(4 * kMB - 1), fence.cpuValue);
+    EXPECT_EQ(pool.getStats().retainedBytes, 4 * kMB);
+    EXPECT_EQ(pool.getStats().retainedPageCount, 1);
+    EXPECT(!pool.acquire(4 * kMB, fence.gpuValue, page));
+
+    fence.endFrame();
+    fence.gpuComplete();
+
+    // Too small.
+    EXPECT(!pool.acquire(5 * kMB, fence.gpuValue, page));
+    // More than 25% larger than the request.
+    EXPECT(!pool.acquire(3 * kMB, fence.gpuValue, page));
+
+    // Slightly smaller request.
+    EXPECT(pool.acquire(3 * kMB + 1, fence.gpuValue, page));
+    EXPECT_EQ(page.id, 1);
+    EXPECT_EQ(pool.getStats().retainedBytes, 0);
+    EXPECT_EQ(pool.getStats().retainedPageCount, 0);
+
+    // The smallest fitting page is returned first, then the oldest completed page of that size.
+    pool.release(MockPage{2}, 5 * kMB, fence.cpuValue);
+    pool.release(MockPage{3}, 4 * kMB, fence.cpuValue);
+    fence.endFrame();
+    pool.release(MockPage{4}, 4 * kMB, fence.cpuValue);
+    fence.endFrame();
+    fence.gpuComplete();
+    EXPECT(pool.acquire(4 * kMB, fence.gpuValue, page));
+    EXPECT_EQ(page.id, 3);
+    EXPECT(pool.acquire(4 * kMB, fence.gpuValue, page));
+    EXPECT_EQ(page.id, 4);
+    EXPECT(pool.acquire(4 * kMB, fence.gpuValue, page));
+    EXPECT_EQ(page.id, 2);
+
+    EXPECT_EQ(pool.getStats().hitCount, 4);
+    EXPECT_EQ(pool.getStats().missCount, 4);
+    EXPECT_EQ(pool.getStats().getHitRate(), 0.5);
+    EXPECT(evicted.empty());
+}
+
+CPU_TEST(MegaPagePool_Eviction)
+{
+    const size_t kMB = 1024 * 1024;
+    MockFence fence;
+    std::vector<uint32_t> evicted;
+    MegaPagePool<MockPage> pool(kMB, 16 * kMB, [&](MockPage& page) { evicted.push_back(page.id); });
+
+    // Exceeding the cap evicts the oldest pages across all sizes.
+    pool.release(MockPage{1}, 4 * kMB, fence.cpuValue);
+    pool.release(MockPage{2}, 8 * kMB, fence.cpuValue);
+    pool.release(MockPage{3}, 4 * kMB, fence.cpuValue);
+    EXPECT(evicted.empty());
+    pool.release(MockPage{4}, 2 * kMB, fence.cpuValue);
+    EXPECT(evicted == std::vector<uint32_t>({1}));
+    EXPECT_EQ(pool.getStats().retainedBytes, 14 * kMB);
+
+    // Pages larger than the cap are evicted right away.
+    pool.release(MockPage{5}, 32 * kMB, fence.cpuValue);
+    EXPECT(evicted == std::vector<uint32_t>({1, 5}));
+
+    // Explicit trim.
+    pool.trim(6 * kMB);
+    EXPECT(evicted == std::vector<uint32_t>({1, 5, 2}));
+    EXPECT_EQ(pool.getStats().retainedBytes, 6 * kMB);
+
+    // Pages idle for too long are evicted.
+    for (uint32_t i = 0; i < 4; i++)
+        fence.endFrame();
+    pool.release(MockPage{6}, 4 * kMB, fence.cpuValue);
+    pool.trimIdle(fence.cpuValue, 2);
+    EXPECT(evicted == std::vector<uint32_t>({1, 5, 2, 4, 3}));
+    EXPECT_EQ(pool.getStats().retainedPageCount, 1);
+
+    // Lowering the cap trims the pool.
+    pool.setMaxRetainedBytes(0);
+    EXPECT(evicted == std::vector<uint32_t>({1, 5, 2, 4, 3, 6}));
+    EXPECT_EQ(pool.getStats().retainedBytes, 0);
+    EXPECT_EQ(pool.getStats().evictionCount, 6);
+}
+} // namespace Falcor
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Core/Plugin.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
 
 namespace Falcor
 {
@@ -221,4 +223,109 @@ CPU_TEST(Plugin)
     }
 }
 
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+/// Write a plugin manifest with an up-to-date entry for a single library.
+void writeManifest(
+    const std::filesystem::path& path,
+    const std::string& name,
+    const std::filesystem::path& libraryPath,
+    const std::vector<std::pair<std::string, std::string>>& classes
+)
+{
+    nlohmann::json jsonClasses = nlohmann::json::array();
+    for (const auto& [baseType, type] : classes)
+        jsonClasses.push_back({{"base", baseType}, {"type", type}});
+    nlohmann::json jsonEntry = {
+        {"size", std::filesystem::file_size(libraryPath)},
+        {"time", std::filesystem::last_write_time(libraryPath).time_since_epoch().count()},
+        {"classes", jsonClasses},
+    };
+    nlohmann::json json = {{"version", 1}, {"libraries", {{name, jsonEntry}}}};
+    std::ofstream(path) << json.dump(4);
+}
+
+template<typename F>
+bool throwsRuntimeError(F func)
+{
+    try
+    {
+        func();
+    }
+    catch (const RuntimeError&)
+    {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+CPU_TEST(PluginManager_LazyLoading)
+{
+    const std::filesystem::path directory = getRuntimeDirectory() / "PluginManager_LazyLoading";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // The plugin library is not a valid shared library, so any attempt to load it throws.
+    const std::string name = "FakePlugin";
+#if FALCOR_WINDOWS
+    const std::filesystem::path libraryPath = directory / (name + ".dll");
+#else
+    const std::filesystem::path libraryPath = directory / (name + ".so");
+#endif
+    const std::filesystem::path manifestPath = directory / "plugins_manifest.json";
+    writeFile(directory / "plugins.json", nlohmann::json::array({name}).dump());
+    writeFile(libraryPath, "not a shared library");
+    writeManifest(manifestPath, name, libraryPath, {{PluginBaseA::getPluginBaseType(), "PluginA1"}});
+
+    // Classes of an up-to-date manifest entry are available without loading the library.
+    {
+        PluginManager pm;
+        EXPECT(!throwsRuntimeError([&]() { pm.loadAllPlugins(PluginManager::LoadMode::Lazy, directory); }));
+        EXPECT(pm.hasClass<PluginBaseA>("PluginA1"));
+        EXPECT(!pm.hasClass<PluginBaseB>("PluginA1"));
+        EXPECT(!pm.hasClass<PluginBaseA>("PluginA2"));
+
+        // Lookups of other classes and base classes don't load the library.
+        EXPECT(pm.createClass<PluginBaseA>("PluginA2", "") == nullptr);
+        EXPECT(pm.getInfos<PluginBaseB>().empty());
+
+        // Requesting a deferred class, or all classes of its base class, loads the library it resolves to.
+        EXPECT(throwsRuntimeError([&]() { pm.createClass<PluginBaseA>("PluginA1", ""); }));
+        EXPECT(throwsRuntimeError([&]() { pm.getInfos<PluginBaseA>(); }));
+    }
+
+    // A changed library makes its manifest entry stale, so the library is loaded right away.
+    writeFile(libraryPath, "still not a shared library");
+    {
+        PluginManager pm;
+        EXPECT(throwsRuntimeError([&]() { pm.loadAllPlugins(PluginManager::LoadMode::Lazy, directory); }));
+        EXPECT(!pm.hasClass<PluginBaseA>("PluginA1"));
+    }
+
+    // A manifest entry for the changed library makes it deferred again.
+    writeManifest(manifestPath, name, libraryPath, {{PluginBaseA::getPluginBaseType(), "PluginA1"}});
+    {
+        PluginManager pm;
+        EXPECT(!throwsRuntimeError([&]() { pm.loadAllPlugins(PluginManager::LoadMode::Lazy, directory); }));
+        EXPECT(pm.hasClass<PluginBaseA>("PluginA1"));
+    }
+
+    // Libraries missing from the manifest are loaded right away.
+    std::filesystem::remove(manifestPath);
+    {
+        PluginManager pm;
+        EXPECT(throwsRuntimeError([&]() { pm.loadAllPlugins(PluginManager::LoadMode::Lazy, directory); }));
+        EXPECT(!pm.hasClass<PluginBaseA>("PluginA1"));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
 } // namespace Falcor
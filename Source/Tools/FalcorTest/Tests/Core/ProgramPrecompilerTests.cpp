@@ -0,0 +1,121 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramManager.h"
+#include "Core/Program/ProgramPrecompiler.h"
+#include <chrono>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Tests/Core/ProgramPrecompilerTests.cs.slang";
+
+std::vector<DefineList> getPermutations(const Program& program, uint32_t count)
+{
+    std::vector<DefineList> permutations;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        DefineList defines = program.getDefineList();
+        defines.add("VALUE", std::to_string(i));
+        permutations.push_back(defines);
+    }
+    return permutations;
+}
+
+void waitForPrecompiler(const ProgramPrecompiler& precompiler)
+{
+    while (precompiler.isRunning())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+/// Check that switching the program to each of the permutations doesn't compile a new program version.
+void testCacheHits(GPUUnitTestContext& ctx, const ref<Program>& pProgram, const std::vector<DefineList>& permutations)
+{
+    ProgramManager* pProgramManager = ctx.getDevice()->getProgramManager();
+    const size_t versionCount = pProgramManager->getCompilationStats().programVersionCount;
+    for (const auto& defines : permutations)
+    {
+        pProgram->setDefines(defines);
+        EXPECT(pProgram->getActiveVersion() != nullptr);
+    }
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, versionCount);
+}
+} // namespace
+
+GPU_TEST(ProgramPrecompiler_Precompile)
+{
+    ref<Program> pProgram = ComputeProgram::createFromFile(ctx.getDevice(), kShaderFile, "main", DefineList{{"VALUE", "0"}});
+    auto permutations = getPermutations(*pProgram, 4);
+
+    ProgramPrecompiler precompiler;
+    precompiler.start(pProgram, permutations);
+    waitForPrecompiler(precompiler);
+
+    auto progress = precompiler.getProgress();
+    EXPECT_EQ(progress.total, 4u);
+    EXPECT_EQ(progress.completed, 4u);
+    EXPECT_EQ(progress.failed, 0u);
+    EXPECT(progress.isDone());
+
+    testCacheHits(ctx, pProgram, permutations);
+}
+
+GPU_TEST(ProgramPrecompiler_Cancel)
+{
+    ref<Program> pProgram = ComputeProgram::createFromFile(ctx.getDevice(), kShaderFile, "main", DefineList{{"VALUE", "0"}});
+    auto permutations = getPermutations(*pProgram, 16);
+
+    {
+        // Cancelling returns without waiting for the worker, progress is kept.
+        ProgramPrecompiler precompiler;
+        precompiler.start(pProgram, permutations);
+        precompiler.cancel();
+        EXPECT(!precompiler.isRunning());
+        auto progress = precompiler.getProgress();
+        EXPECT_EQ(progress.total, 16u);
+        EXPECT_LE(progress.completed, 16u);
+
+        // Restarting skips the versions that are already cached.
+        precompiler.start(pProgram, permutations);
+        waitForPrecompiler(precompiler);
+        progress = precompiler.getProgress();
+        EXPECT_EQ(progress.completed, 16u);
+        EXPECT_EQ(progress.failed, 0u);
+
+        // Cancelling a finished precompilation is a no-op.
+        precompiler.cancel();
+        EXPECT(!precompiler.isRunning());
+        EXPECT_EQ(precompiler.getProgress().completed, 16u);
+    }
+
+    // The destructor has waited for the cancelled worker, so no compilation is still in flight.
+    testCacheHits(ctx, pProgram, permutations);
+}
+} // namespace Falcor
@@ -0,0 +1,273 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/AlphaCoverageMap.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <execution>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct TestTexture
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> alpha;
+};
+
+/// Texture with opaque discs on a transparent background and a soft edge, similar to a foliage atlas.
+TestTexture createDiscTexture(uint32_t size, uint32_t discCount, uint32_t seed)
+{
+    TestTexture tex{size, size, std::vector<uint8_t>((size_t)size * size, 0)};
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    for (uint32_t i = 0; i < discCount; i++)
+    {
+        float cx = u(rng) * size, cy = u(rng) * size, r = (0.05f + 0.1f * u(rng)) * size;
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                float d = std::hypot(x + 0.5f - cx, y + 0.5f - cy);
+                float a = std::clamp(r - d, 0.f, 1.f);
+                uint8_t& dst = tex.alpha[(size_t)y * size + x];
+                dst = std::max(dst, (uint8_t)std::lround(a * 255.f));
+            }
+        }
+    }
+    return tex;
+}
+
+/// Bilinearly sample a box-filtered mip of the texture with wrap addressing.
+float sampleAlpha(const TestTexture& tex, uint32_t mipLevel, float2 uv)
+{
+    const uint32_t blockSize = 1u << mipLevel;
+    const int w = (int)(tex.width >> mipLevel), h = (int)(tex.height >> mipLevel);
+    auto texel = [&](int x, int y)
+    {
+        x = ((x % w) + w) % w;
+        y = ((y % h) + h) % h;
+        float sum = 0.f;
+        for (uint32_t j = 0; j < blockSize; j++)
+            for (uint32_t i = 0; i < blockSize; i++)
+                sum += tex.alpha[(size_t)(y * blockSize + j) * tex.width + x * blockSize + i];
+        return sum / (255.f * blockSize * blockSize);
+    };
+    float px = uv.x * w - 0.5f, py = uv.y * h - 0.5f;
+    int x0 = (int)std::floor(px), y0 = (int)std::floor(py);
+    float fx = px - x0, fy = py - y0;
+    float a0 = texel(x0, y0) * (1.f - fx) + texel(x0 + 1, y0) * fx;
+    float a1 = texel(x0, y0 + 1) * (1.f - fx) + texel(x0 + 1, y0 + 1) * fx;
+    return a0 * (1.f - fy) + a1 * fy;
+}
+
+AlphaCoverageMap createMap(const TestTexture& tex, const AlphaCoverageMap::Desc& desc = {})
+{
+    return AlphaCoverageMap(tex.width, tex.height, tex.alpha.data(), 1, desc);
+}
+} // namespace
+
+CPU_TEST(AlphaCoverageMap_Classify)
+{
+    // Left half opaque, right half transparent.
+    TestTexture tex{64, 64, std::vector<uint8_t>(64 * 64, 0)};
+    for (uint32_t y = 0; y < 64; y++)
+        std::fill_n(tex.alpha.begin() + y * 64, 32, uint8_t(255));
+    AlphaCoverageMap map = createMap(tex);
+    EXPECT_EQ(map.getLevelCount(), 7);
+
+    EXPECT(map.classify({0.1f, 0.1f}, {0.4f, 0.1f}, {0.1f, 0.9f}, 0.5f) == AlphaCoverage::Opaque);
+    EXPECT(map.classify({0.6f, 0.1f}, {0.9f, 0.1f}, {0.6f, 0.9f}, 0.5f) == AlphaCoverage::Transparent);
+    EXPECT(map.classify({0.4f, 0.1f}, {0.6f, 0.1f}, {0.4f, 0.9f}, 0.5f) == AlphaCoverage::Unknown);
+
+    // Bilinear filtering blends in the transparent texels within half a texel of the edge at u = 0.5.
+    const float texel = 1.f / 64.f;
+    EXPECT(map.classify({0.4f, 0.1f}, {0.5f - 0.6f * texel, 0.1f}, {0.4f, 0.2f}, 0.5f) == AlphaCoverage::Opaque);
+    EXPECT(map.classify({0.4f, 0.1f}, {0.5f - 0.4f * texel, 0.1f}, {0.4f, 0.2f}, 0.5f) == AlphaCoverage::Unknown);
+
+    // Only the footprint is rasterized, not its bounds. The triangle hugs the edge without reaching it.
+    EXPECT(map.classify({0.05f, 0.05f}, {0.45f, 0.05f}, {0.05f, 0.95f}, 0.5f) == AlphaCoverage::Opaque);
+    EXPECT(map.classify({0.05f, 0.05f}, {0.95f, 0.05f}, {0.05f, 0.95f}, 0.5f) == AlphaCoverage::Unknown);
+
+    // A threshold of zero never discards.
+    EXPECT(map.classify({0.6f, 0.1f}, {0.9f, 0.1f}, {0.6f, 0.9f}, 0.f) == AlphaCoverage::Opaque);
+
+    // Degenerate footprints and invalid texture coordinates.
+    EXPECT(map.classify({0.2f, 0.2f}, {0.2f, 0.2f}, {0.2f, 0.2f}, 0.5f) == AlphaCoverage::Opaque);
+    EXPECT(map.classify({0.2f, 0.2f}, {NAN, 0.2f}, {0.2f, 0.3f}, 0.5f) == AlphaCoverage::Unknown);
+}
+
+CPU_TEST(AlphaCoverageMap_AddressModes)
+{
+    TestTexture tex{64, 64, std::vector<uint8_t>(64 * 64, 0)};
+    for (uint32_t y = 0; y < 64; y++)
+        std::fill_n(tex.alpha.begin() + y * 64, 32, uint8_t(255));
+
+    // The footprint u in [1.1, 1.2] wraps to the opaque half, mirrors to the transparent half and clamps to the last column.
+    const float2 uv0 = {1.1f, 0.2f}, uv1 = {1.2f, 0.2f}, uv2 = {1.1f, 0.4f};
+    auto classify = [&](Sampler::AddressMode mode)
+    {
+        AlphaCoverageMap::Desc desc;
+        desc.addressModeU = desc.addressModeV = mode;
+        return createMap(tex, desc).classify(uv0, uv1, uv2, 0.5f);
+    };
+    EXPECT(classify(Sampler::AddressMode::Wrap) == AlphaCoverage::Opaque);
+    EXPECT(classify(Sampler::AddressMode::Mirror) == AlphaCoverage::Transparent);
+    EXPECT(classify(Sampler::AddressMode::Clamp) == AlphaCoverage::Transparent);
+    EXPECT(classify(Sampler::AddressMode::Border) == AlphaCoverage::Unknown);
+
+    // Wrapping across the texture edge reaches both halves.
+    AlphaCoverageMap map = createMap(tex);
+    EXPECT(map.classify({0.9f, 0.2f}, {1.1f, 0.2f}, {0.9f, 0.4f}, 0.5f) == AlphaCoverage::Unknown);
+
+    // Footprints repeating the texture many times use the range of the whole texture.
+    TestTexture opaque{64, 64, std::vector<uint8_t>(64 * 64, 255)};
+    EXPECT(createMap(opaque).classify({-1000.f, -1000.f}, {1000.f, -1000.f}, {0.f, 1000.f}, 0.5f) == AlphaCoverage::Opaque);
+}
+
+CPU_TEST(AlphaCoverageMap_Conservative)
+{
+    // Classified triangles have to agree with densely sampled alpha, including coarser mips when requested.
+    TestTexture tex = createDiscTexture(128, 12, 1);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> u(-0.5f, 1.5f);
+    std::uniform_real_distribution<float> s(0.005f, 0.2f);
+
+    for (uint32_t maxMipLevel : {0u, 2u})
+    {
+        AlphaCoverageMap::Desc desc;
+        desc.maxMipLevel = maxMipLevel;
+        AlphaCoverageMap map = createMap(tex, desc);
+
+        uint32_t counts[3] = {};
+        uint32_t errors = 0;
+        for (uint32_t t = 0; t < 2000; t++)
+        {
+            float2 c = {u(rng), u(rng)};
+            float size = s(rng);
+            float2 uv[3] = {c, c + float2(size * u(rng), size * u(rng)), c + float2(size * u(rng), size * u(rng))};
+            AlphaCoverage coverage = map.classify(uv[0], uv[1], uv[2], 0.5f);
+            counts[(uint32_t)coverage]++;
+            if (coverage == AlphaCoverage::Unknown)
+                continue;
+
+            const uint32_t kSteps = 24;
+            for (uint32_t i = 0; i <= kSteps; i++)
+            {
+                for (uint32_t j = 0; i + j <= kSteps; j++)
+                {
+                    float b1 = (float)i / kSteps, b2 = (float)j / kSteps;
+                    float2 p = uv[0] * (1.f - b1 - b2) + uv[1] * b1 + uv[2] * b2;
+                    for (uint32_t mip = 0; mip <= maxMipLevel; mip++)
+                    {
+                        bool discarded = sampleAlpha(tex, mip, p) < 0.5f;
+                        if (discarded != (coverage == AlphaCoverage::Transparent))
+                            errors++;
+                    }
+                }
+            }
+        }
+
+        EXPECT_EQ(errors, 0);
+        EXPECT_GT(counts[(uint32_t)AlphaCoverage::Opaque], 0);
+        EXPECT_GT(counts[(uint32_t)AlphaCoverage::Transparent], 0);
+        logInfo(
+            "maxMipLevel {}: {} opaque, {} transparent, {} unknown",
+            maxMipLevel,
+            counts[(uint32_t)AlphaCoverage::Opaque],
+            counts[(uint32_t)AlphaCoverage::Transparent],
+            counts[(uint32_t)AlphaCoverage::Unknown]
+        );
+    }
+}
+
+CPU_TEST(AlphaCoverageMap_Benchmark, TAGS("benchmark"))
+{
+    // Classify the cards of a foliage-like mesh: small triangles tiling a 2048^2 atlas, as in SceneBuilder::classifyAlphaCoverage().
+    TestTexture tex = createDiscTexture(2048, 20, 3);
+    CpuTimer timer;
+    auto t0 = CpuTimer::getCurrentTimePoint();
+    AlphaCoverageMap map = createMap(tex);
+    double buildTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+    const uint32_t kTriangleCount = 1 << 20;
+    std::vector<float2> uvs(3 * kTriangleCount);
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    for (uint32_t t = 0; t < kTriangleCount; t++)
+    {
+        float2 c = {u(rng), u(rng)};
+        float size = 0.002f + 0.02f * u(rng);
+        uvs[3 * t] = c;
+        uvs[3 * t + 1] = c + float2(size, 0.f);
+        uvs[3 * t + 2] = c + float2(0.f, size);
+    }
+
+    std::vector<AlphaCoverage> results(kTriangleCount);
+    std::vector<AlphaCoverage> serialResults;
+    NumericRange<uint32_t> range(0, kTriangleCount);
+    for (bool parallel : {false, true})
+    {
+        auto classify = [&](uint32_t t) { results[t] = map.classify(uvs[3 * t], uvs[3 * t + 1], uvs[3 * t + 2], 0.5f); };
+        auto t1 = CpuTimer::getCurrentTimePoint();
+        if (parallel)
+            std::for_each(std::execution::par, range.begin(), range.end(), classify);
+        else
+            std::for_each(range.begin(), range.end(), classify);
+        double time = CpuTimer::calcDuration(t1, CpuTimer::getCurrentTimePoint());
+
+        if (parallel)
+            EXPECT(results == serialResults);
+        else
+            serialResults = results;
+
+        uint32_t counts[3] = {};
+        for (AlphaCoverage c : results)
+            counts[(uint32_t)c]++;
+        logInfo(
+            "{}: {} triangles in {:.1f} ms ({:.1f} M/s): {:.1f}% opaque, {:.1f}% transparent, {:.1f}% unknown",
+            parallel ? "parallel" : "serial",
+            kTriangleCount,
+            time,
+            kTriangleCount / (time * 1e3),
+            100.0 * counts[(uint32_t)AlphaCoverage::Opaque] / kTriangleCount,
+            100.0 * counts[(uint32_t)AlphaCoverage::Transparent] / kTriangleCount,
+            100.0 * counts[(uint32_t)AlphaCoverage::Unknown] / kTriangleCount
+        );
+    }
+    logInfo("Pyramid build: {:.1f} ms", buildTime);
+}
+} // namespace Falcor
@@ -0,0 +1,343 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshInstanceDetector.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/MatrixMath.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <limits>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct TestMesh
+{
+    std::vector<StaticVertexData> vertices;
+    std::vector<uint32_t> indices;
+
+    MeshInstanceDetector::MeshData getData() const
+    {
+        MeshInstanceDetector::MeshData data;
+        data.pVertices = vertices.data();
+        data.vertexCount = (uint32_t)vertices.size();
+        data.pIndexData = indices.data();
+        data.indexDataSize = (uint32_t)indices.size();
+        return data;
+    }
+};
+
+/// Unit sphere with latitude/longitude tessellation, normals, tangents and texture coordinates.
+TestMesh createSphere(uint32_t rings, uint32_t segments)
+{
+    TestMesh mesh;
+    for (uint32_t r = 0; r <= rings; r++)
+    {
+        for (uint32_t s = 0; s <= segments; s++)
+        {
+            float theta = (float)M_PI * (r + 0.5f) / (rings + 1);
+            float phi = 2.f * (float)M_PI * s / segments;
+            float3 p(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            StaticVertexData v = {};
+            v.position = p;
+            v.normal = p;
+            v.tangent = float4(-std::sin(phi), 0.f, std::cos(phi), 1.f);
+            v.texCrd = float2((float)s / segments, (float)r / rings);
+            mesh.vertices.push_back(v);
+        }
+    }
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            uint32_t i = r * (segments + 1) + s;
+            mesh.indices.insert(mesh.indices.end(), {i, i + 1, i + segments + 1, i + 1, i + segments + 2, i + segments + 1});
+        }
+    }
+    return mesh;
+}
+
+/// Flat grid of quads in the xz-plane facing +y.
+TestMesh createGrid(uint32_t size)
+{
+    TestMesh mesh;
+    for (uint32_t z = 0; z <= size; z++)
+    {
+        for (uint32_t x = 0; x <= size; x++)
+        {
+            StaticVertexData v = {};
+            v.position = float3((float)x, 0.f, (float)z);
+            v.normal = float3(0.f, 1.f, 0.f);
+            v.tangent = float4(1.f, 0.f, 0.f, 1.f);
+            v.texCrd = float2((float)x, (float)z) / (float)size;
+            mesh.vertices.push_back(v);
+        }
+    }
+    for (uint32_t z = 0; z < size; z++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i = z * (size + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2});
+        }
+    }
+    return mesh;
+}
+
+/// Bake a transform into the vertices of a mesh, as done by exporters that don't preserve instancing.
+TestMesh transformMesh(const TestMesh& mesh, const float4x4& transform)
+{
+    TestMesh result = mesh;
+    float3x3 transform3x3 = float3x3(transform);
+    float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
+    for (auto& v : result.vertices)
+    {
+        v.position = transformPoint(transform, v.position);
+        v.normal = normalize(transformVector(invTranspose3x3, v.normal));
+        v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
+    }
+    return result;
+}
+
+float maxPositionError(const TestMesh& base, const TestMesh& mesh, const float4x4& transform)
+{
+    float maxError = 0.f;
+    for (size_t i = 0; i < base.vertices.size(); i++)
+        maxError = std::max(maxError, length(transformPoint(transform, base.vertices[i].position) - mesh.vertices[i].position));
+    return maxError;
+}
+
+float getDiagonal(const TestMesh& mesh)
+{
+    float3 minPos(std::numeric_limits<float>::max()), maxPos(-std::numeric_limits<float>::max());
+    for (const auto& v : mesh.vertices)
+    {
+        minPos = min(minPos, v.position);
+        maxPos = max(maxPos, v.position);
+    }
+    return length(maxPos - minPos);
+}
+
+float4x4 createRigidTransform(float angle, float3 axis, float3 translation)
+{
+    return mul(math::matrixFromTranslation(translation), math::matrixFromRotation(angle, normalize(axis)));
+}
+
+float4x4 createAffineTransform()
+{
+    float4x4 shear = float4x4::identity();
+    shear[0][1] = 0.5f;
+    return mul(createRigidTransform(0.7f, float3(1.f, 2.f, 3.f), float3(10.f, -3.f, 2.f)), mul(shear, math::matrixFromScaling(float3(2.f, 0.5f, 3.f))));
+}
+} // namespace
+
+CPU_TEST(MeshInstanceDetector_Transforms)
+{
+    TestMesh base = createSphere(12, 24);
+
+    std::vector<std::pair<std::string, float4x4>> transforms = {
+        {"identity", float4x4::identity()},
+        {"rigid", createRigidTransform(1.3f, float3(0.2f, 1.f, -0.4f), float3(5.f, 0.f, -7.f))},
+        {"reflection", mul(createRigidTransform(0.4f, float3(1.f, 0.f, 1.f), float3(-2.f, 1.f, 3.f)), math::matrixFromScaling(float3(-1.f, 1.f, 1.f)))},
+        {"uniform scale", mul(createRigidTransform(2.1f, float3(0.f, 0.f, 1.f), float3(1.f)), math::matrixFromScaling(float3(100.f)))},
+        {"affine", createAffineTransform()},
+    };
+
+    for (const auto& [name, transform] : transforms)
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        EXPECT_EQ(MeshInstanceDetector::computeHash(base.getData()), MeshInstanceDetector::computeHash(mesh.getData())) << name;
+
+        MeshInstanceDetector::Options options;
+        auto result = MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options);
+        EXPECT(result.has_value()) << name;
+        if (result)
+            EXPECT_LE(maxPositionError(base, mesh, *result), options.positionTolerance * getDiagonal(mesh)) << name;
+
+        // Only the transforms without scaling are rigid.
+        options.rigidOnly = true;
+        bool isRigid = name == "identity" || name == "rigid" || name == "reflection";
+        EXPECT_EQ(MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options).has_value(), isRigid) << name;
+    }
+}
+
+CPU_TEST(MeshInstanceDetector_Planar)
+{
+    // The transform of the normal axis of a planar mesh is found from the vertex normals.
+    TestMesh base = createGrid(8);
+    for (float flip : {1.f, -1.f})
+    {
+        float4x4 transform = mul(createAffineTransform(), math::matrixFromScaling(float3(1.f, flip, 1.f)));
+        TestMesh mesh = transformMesh(base, transform);
+        EXPECT_EQ(MeshInstanceDetector::computeHash(base.getData()), MeshInstanceDetector::computeHash(mesh.getData()));
+
+        auto result = MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), {});
+        ASSERT(result.has_value());
+        EXPECT_LE(maxPositionError(base, mesh, *result), 1e-3f);
+        float3 normal = normalize(transformVector(float3x3(transpose(inverse(*result))), float3(0.f, 1.f, 0.f)));
+        EXPECT_LE(length(normal - mesh.vertices[0].normal), 1e-3f);
+    }
+}
+
+CPU_TEST(MeshInstanceDetector_Reject)
+{
+    TestMesh base = createSphere(12, 24);
+    float4x4 transform = createRigidTransform(0.5f, float3(1.f, 1.f, 0.f), float3(3.f, 2.f, 1.f));
+    MeshInstanceDetector::Options options;
+    const float diagonal = getDiagonal(transformMesh(base, transform));
+
+    // Position errors within the tolerance are accepted, larger ones rejected.
+    for (float error : {0.5f, 2.f})
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        mesh.vertices[100].position.x += error * options.positionTolerance * diagonal;
+        EXPECT_EQ(MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options).has_value(), error < 1.f) << error;
+    }
+
+    // Meshes with different texture coordinates, indices, normals, tangents or keys are not instances.
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        mesh.vertices[5].texCrd.x += 0.01f;
+        EXPECT(!MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options));
+    }
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        std::swap(mesh.indices[0], mesh.indices[1]);
+        EXPECT(!MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options));
+    }
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        mesh.vertices[7].normal = -mesh.vertices[7].normal;
+        EXPECT(!MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options));
+    }
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        mesh.vertices[9].tangent.w = -1.f;
+        EXPECT(!MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options));
+    }
+    {
+        TestMesh mesh = transformMesh(base, transform);
+        auto data = mesh.getData();
+        data.key = 1;
+        EXPECT(!MeshInstanceDetector::findTransform(base.getData(), data, options));
+    }
+
+    // A non-affine deformation is rejected.
+    {
+        TestMesh mesh = base;
+        for (auto& v : mesh.vertices)
+            v.position.y += v.position.x * v.position.x;
+        EXPECT(!MeshInstanceDetector::findTransform(base.getData(), mesh.getData(), options));
+    }
+}
+
+CPU_TEST(MeshInstanceDetector_Detect)
+{
+    TestMesh sphere = createSphere(12, 24);
+    TestMesh grid = createGrid(4);
+    TestMesh bumpy = sphere;
+    for (size_t i = 0; i < bumpy.vertices.size(); i++)
+        bumpy.vertices[i].position *= 1.f + 0.1f * (float)(i % 3);
+
+    std::vector<TestMesh> meshes = {
+        grid,
+        sphere,
+        transformMesh(sphere, createAffineTransform()),
+        bumpy,
+        transformMesh(grid, createRigidTransform(1.f, float3(0.f, 1.f, 0.f), float3(4.f, 0.f, 0.f))),
+        transformMesh(bumpy, createRigidTransform(2.f, float3(1.f, 0.f, 0.f), float3(0.f, 5.f, 0.f))),
+        transformMesh(sphere, createRigidTransform(3.f, float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 6.f))),
+    };
+    std::vector<MeshInstanceDetector::MeshData> data;
+    for (const auto& mesh : meshes)
+        data.push_back(mesh.getData());
+
+    auto matches = MeshInstanceDetector::detect(data, {});
+    ASSERT_EQ(matches.size(), 4);
+    const std::pair<uint32_t, uint32_t> expected[] = {{2, 1}, {4, 0}, {5, 3}, {6, 1}};
+    for (size_t i = 0; i < matches.size(); i++)
+    {
+        EXPECT_EQ(matches[i].meshIndex, expected[i].first);
+        EXPECT_EQ(matches[i].baseIndex, expected[i].second);
+        EXPECT_LE(maxPositionError(meshes[matches[i].baseIndex], meshes[matches[i].meshIndex], matches[i].transform), 1e-3f);
+    }
+}
+
+CPU_TEST(MeshInstanceDetector_Benchmark, TAGS("benchmark"))
+{
+    // Many copies of a few shapes with baked transforms, plus many unique quads that share their topology.
+    const uint32_t kShapeCount = 50;
+    const uint32_t kCopyCount = 40;
+    const uint32_t kQuadCount = 2000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+    std::vector<TestMesh> meshes;
+    for (uint32_t s = 0; s < kShapeCount; s++)
+    {
+        TestMesh shape = createSphere(16 + s % 8, 32);
+        for (size_t i = 0; i < shape.vertices.size(); i++)
+            shape.vertices[i].position *= 1.f + 0.05f * (float)((i * (s + 1)) % 5);
+        shape.vertices[0].position *= 1.f + 0.01f * (float)(s + 1);
+        for (uint32_t c = 0; c < kCopyCount; c++)
+        {
+            float3 scale = float3(1.f + 0.5f * u(rng));
+            meshes.push_back(transformMesh(
+                shape,
+                mul(createRigidTransform(3.f * u(rng), float3(u(rng), u(rng), 1.f), 100.f * float3(u(rng), u(rng), u(rng))),
+                    math::matrixFromScaling(scale))
+            ));
+        }
+    }
+    TestMesh quad = createGrid(1);
+    for (uint32_t q = 0; q < kQuadCount; q++)
+    {
+        TestMesh mesh = transformMesh(quad, createRigidTransform(u(rng), float3(0.f, 1.f, 0.f), 50.f * float3(u(rng), 0.f, u(rng))));
+        for (auto& v : mesh.vertices)
+            v.texCrd = v.texCrd * 0.5f + float2(u(rng), u(rng));
+        meshes.push_back(mesh);
+    }
+
+    std::vector<MeshInstanceDetector::MeshData> data;
+    size_t vertexCount = 0;
+    for (const auto& mesh : meshes)
+    {
+        data.push_back(mesh.getData());
+        vertexCount += mesh.vertices.size();
+    }
+
+    auto start = CpuTimer::getCurrentTimePoint();
+    auto matches = MeshInstanceDetector::detect(data, {});
+    double time = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    EXPECT_EQ(matches.size(), kShapeCount * (kCopyCount - 1));
+    logInfo("MeshInstanceDetector: {} meshes, {} vertices, {} matches in {:.1f} ms", meshes.size(), vertexCount, matches.size(), time);
+}
+} // namespace Falcor
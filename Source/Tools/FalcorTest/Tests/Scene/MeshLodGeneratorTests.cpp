@@ -0,0 +1,298 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshLodGenerator.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <execution>
+#include <map>
+#include <set>
+
+namespace Falcor
+{
+namespace
+{
+struct TestMesh
+{
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+};
+
+/// Unit sphere made by subdividing an octahedron and projecting the vertices onto the sphere. Counter-clockwise outward faces.
+TestMesh createSphere(uint32_t subdivisions)
+{
+    TestMesh mesh;
+    mesh.positions = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    mesh.indices = {0, 2, 4, 4, 2, 1, 1, 2, 5, 5, 2, 0, 4, 3, 0, 1, 3, 4, 5, 3, 1, 0, 3, 5};
+    for (uint32_t s = 0; s < subdivisions; s++)
+    {
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+        auto getMidpoint = [&](uint32_t a, uint32_t b)
+        {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end())
+                return it->second;
+            mesh.positions.push_back(normalize(mesh.positions[a] + mesh.positions[b]));
+            return midpoints[key] = (uint32_t)mesh.positions.size() - 1;
+        };
+        std::vector<uint32_t> indices;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            uint32_t a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+            uint32_t ab = getMidpoint(a, b), bc = getMidpoint(b, c), ca = getMidpoint(c, a);
+            indices.insert(indices.end(), {a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca});
+        }
+        mesh.indices = std::move(indices);
+    }
+    return mesh;
+}
+
+/// Flat grid of quads in the xz-plane.
+TestMesh createGrid(uint32_t size)
+{
+    TestMesh mesh;
+    for (uint32_t z = 0; z <= size; z++)
+        for (uint32_t x = 0; x <= size; x++)
+            mesh.positions.push_back(float3((float)x, 0.f, (float)z));
+    for (uint32_t z = 0; z < size; z++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i = z * (size + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2});
+        }
+    }
+    return mesh;
+}
+
+bool hasDegenerateTriangles(const TestMesh& mesh, const std::vector<uint32_t>& indices)
+{
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const float3 &p0 = mesh.positions[indices[i]], &p1 = mesh.positions[indices[i + 1]], &p2 = mesh.positions[indices[i + 2]];
+        if (all(p0 == p1) || all(p1 == p2) || all(p2 == p0))
+            return true;
+    }
+    return false;
+}
+} // namespace
+
+CPU_TEST(MeshLodGenerator_Sphere)
+{
+    TestMesh mesh = createSphere(5);
+    const uint32_t triangleCount = (uint32_t)mesh.indices.size() / 3;
+
+    MeshLodGenerator::Options options;
+    options.targetRatios = {0.5f, 0.25f, 0.125f, 0.0625f};
+    options.maxError = 0.02f;
+    auto lods = MeshLodGenerator::generate(mesh.positions.data(), (uint32_t)mesh.positions.size(), mesh.indices, options);
+    ASSERT_EQ(lods.size(), options.targetRatios.size());
+
+    const float maxError = options.maxError * length(float3(2.f));
+    uint32_t prevTriangleCount = triangleCount;
+    float prevError = 0.f;
+    for (size_t level = 0; level < lods.size(); level++)
+    {
+        const auto& lod = lods[level];
+        EXPECT_LE(lod.getTriangleCount(), options.targetRatios[level] * triangleCount) << "level " << level;
+        EXPECT_GE(lod.getTriangleCount(), options.targetRatios[level] * triangleCount * 0.9f) << "level " << level;
+        EXPECT_LT(lod.getTriangleCount(), prevTriangleCount);
+        EXPECT_GE(lod.error, prevError);
+        EXPECT_LE(lod.error, maxError);
+        EXPECT(!hasDegenerateTriangles(mesh, lod.indices));
+        prevTriangleCount = lod.getTriangleCount();
+        prevError = lod.error;
+
+        // The surface stays closed and outward facing, and close to the sphere.
+        std::map<std::pair<uint32_t, uint32_t>, int> edges;
+        float maxDeviation = 0.f;
+        for (size_t i = 0; i < lod.indices.size(); i += 3)
+        {
+            float3 p0 = mesh.positions[lod.indices[i]], p1 = mesh.positions[lod.indices[i + 1]], p2 = mesh.positions[lod.indices[i + 2]];
+            float3 centroid = (p0 + p1 + p2) / 3.f;
+            EXPECT_GT(dot(cross(p1 - p0, p2 - p0), centroid), 0.f);
+            maxDeviation = std::max(maxDeviation, 1.f - length(centroid));
+            for (size_t e = 0; e < 3; e++)
+                edges[{lod.indices[i + e], lod.indices[i + (e + 1) % 3]}]++;
+        }
+        bool closed = std::all_of(edges.begin(), edges.end(), [&](const auto& edge)
+                                  { return edge.second == 1 && edges.count({edge.first.second, edge.first.first}) == 1; });
+        EXPECT(closed) << "level " << level;
+        EXPECT_LE(maxDeviation, 4.f * lod.error + 1e-3f) << "level " << level;
+    }
+}
+
+CPU_TEST(MeshLodGenerator_ErrorBound)
+{
+    // A flat grid simplifies without error, while its border is preserved.
+    TestMesh grid = createGrid(32);
+    MeshLodGenerator::Options options;
+    options.targetRatios = {0.1f};
+    auto lods = MeshLodGenerator::generate(grid.positions.data(), (uint32_t)grid.positions.size(), grid.indices, options);
+    ASSERT_EQ(lods.size(), 1);
+    EXPECT_LE(lods[0].getTriangleCount(), 2 * 32 * 32 / 10);
+    EXPECT_LE(lods[0].error, 1e-5f);
+    std::set<uint32_t> used(lods[0].indices.begin(), lods[0].indices.end());
+    for (uint32_t i = 0; i <= 32; i++)
+    {
+        EXPECT(used.count(i) && used.count(32 * 33 + i) && used.count(i * 33) && used.count(i * 33 + 32)) << "border vertex " << i;
+    }
+
+    // A tight error bound ends the chain early.
+    TestMesh sphere = createSphere(4);
+    options.targetRatios = {0.5f, 0.25f, 0.125f};
+    options.maxError = 1e-4f;
+    lods = MeshLodGenerator::generate(sphere.positions.data(), (uint32_t)sphere.positions.size(), sphere.indices, options);
+    EXPECT(lods.empty());
+    options.maxError = 0.01f;
+    lods = MeshLodGenerator::generate(sphere.positions.data(), (uint32_t)sphere.positions.size(), sphere.indices, options);
+    EXPECT(!lods.empty());
+    for (const auto& lod : lods)
+        EXPECT_LE(lod.error, 0.01f * length(float3(2.f)));
+
+    // Small meshes get no levels.
+    options.minTriangleCount = 10000;
+    EXPECT(MeshLodGenerator::generate(sphere.positions.data(), (uint32_t)sphere.positions.size(), sphere.indices, options).empty());
+}
+
+CPU_TEST(MeshLodGenerator_Seams)
+{
+    // Split the sphere along the z = 0 plane for x > 0 with duplicated vertices, like a UV seam. Triangles with z > 0 use the copies.
+    TestMesh mesh = createSphere(4);
+    const uint32_t originalVertexCount = (uint32_t)mesh.positions.size();
+    std::vector<uint32_t> copies(originalVertexCount, uint32_t(-1));
+    for (uint32_t v = 0; v < originalVertexCount; v++)
+    {
+        if (mesh.positions[v].z == 0.f && mesh.positions[v].x > 0.f)
+        {
+            copies[v] = (uint32_t)mesh.positions.size();
+            mesh.positions.push_back(mesh.positions[v]);
+        }
+    }
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        float3 centroid = (mesh.positions[mesh.indices[i]] + mesh.positions[mesh.indices[i + 1]] + mesh.positions[mesh.indices[i + 2]]) / 3.f;
+        if (centroid.z <= 0.f)
+            continue;
+        for (size_t j = 0; j < 3; j++)
+        {
+            if (copies[mesh.indices[i + j]] != uint32_t(-1))
+                mesh.indices[i + j] = copies[mesh.indices[i + j]];
+        }
+    }
+
+    MeshLodGenerator::Options options;
+    options.targetRatios = {0.25f};
+    options.maxError = 0.05f;
+    auto lods = MeshLodGenerator::generate(mesh.positions.data(), (uint32_t)mesh.positions.size(), mesh.indices, options);
+    ASSERT_EQ(lods.size(), 1);
+
+    // All seam vertices are kept on both sides, and triangles only use the copies on their side.
+    std::set<uint32_t> used(lods[0].indices.begin(), lods[0].indices.end());
+    const auto& indices = lods[0].indices;
+    for (uint32_t v = 0; v < originalVertexCount; v++)
+    {
+        if (copies[v] != uint32_t(-1))
+            EXPECT(used.count(v) && used.count(copies[v])) << "seam vertex " << v;
+    }
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        float3 centroid = (mesh.positions[indices[i]] + mesh.positions[indices[i + 1]] + mesh.positions[indices[i + 2]]) / 3.f;
+        for (size_t j = 0; j < 3; j++)
+        {
+            if (centroid.x > 0.f && indices[i + j] < originalVertexCount && copies[indices[i + j]] != uint32_t(-1))
+                EXPECT_LE(centroid.z, 0.f);
+            if (indices[i + j] >= originalVertexCount)
+                EXPECT_GT(centroid.z, 0.f);
+        }
+    }
+}
+
+CPU_TEST(MeshLodGenerator_SelectLevel)
+{
+    std::vector<MeshLod> lods(3);
+    lods[0].error = 0.01f;
+    lods[1].error = 0.1f;
+    lods[2].error = 1.f;
+
+    // Error scale in pixels per unit, e.g. for an object close to or far from the camera.
+    EXPECT_EQ(MeshLodGenerator::selectLevel(lods, 1000.f, 1.f), 0);
+    EXPECT_EQ(MeshLodGenerator::selectLevel(lods, 100.f, 1.f), 1);
+    EXPECT_EQ(MeshLodGenerator::selectLevel(lods, 10.f, 1.f), 2);
+    EXPECT_EQ(MeshLodGenerator::selectLevel(lods, 0.5f, 1.f), 3);
+    EXPECT_EQ(MeshLodGenerator::selectLevel({}, 0.5f, 1.f), 0);
+}
+
+CPU_TEST(MeshLodGenerator_Benchmark, TAGS("benchmark"))
+{
+    // Build the chains of many meshes in parallel, as in SceneBuilder::generateMeshLods().
+    const uint32_t kMeshCount = 64;
+    std::vector<TestMesh> meshes(kMeshCount);
+    for (uint32_t i = 0; i < kMeshCount; i++)
+        meshes[i] = createSphere(5 + i % 2);
+
+    MeshLodGenerator::Options options;
+    std::vector<std::vector<MeshLod>> lods(kMeshCount);
+    NumericRange<uint32_t> range(0, kMeshCount);
+    auto generate = [&](uint32_t i)
+    { lods[i] = MeshLodGenerator::generate(meshes[i].positions.data(), (uint32_t)meshes[i].positions.size(), meshes[i].indices, options); };
+
+    auto start = CpuTimer::getCurrentTimePoint();
+    std::for_each(range.begin(), range.end(), generate);
+    double serialTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    const std::vector<std::vector<MeshLod>> serialLods = lods;
+    start = CpuTimer::getCurrentTimePoint();
+    std::for_each(std::execution::par, range.begin(), range.end(), generate);
+    double parallelTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    std::vector<uint64_t> triangleCounts(options.targetRatios.size() + 1, 0);
+    std::vector<float> maxErrors(options.targetRatios.size() + 1, 0.f);
+    for (uint32_t i = 0; i < kMeshCount; i++)
+    {
+        triangleCounts[0] += meshes[i].indices.size() / 3;
+        ASSERT_EQ(lods[i].size(), serialLods[i].size());
+        for (size_t level = 0; level < lods[i].size(); level++)
+        {
+            EXPECT(lods[i][level].indices == serialLods[i][level].indices) << "mesh " << i << " level " << level;
+            triangleCounts[level + 1] += lods[i][level].getTriangleCount();
+            maxErrors[level + 1] = std::max(maxErrors[level + 1], lods[i][level].error);
+        }
+    }
+    for (size_t level = 0; level < triangleCounts.size(); level++)
+    {
+        if (level > 0)
+            EXPECT_LT(triangleCounts[level], triangleCounts[level - 1]) << "level " << level;
+        logInfo("MeshLodGenerator: level {}: {} triangles, max error {:.5f}", level, triangleCounts[level], maxErrors[level]);
+    }
+    logInfo("MeshLodGenerator: {} meshes, serial {:.1f} ms, parallel {:.1f} ms", kMeshCount, serialTime, parallelTime);
+}
+} // namespace Falcor
@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MultiViewCulling.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstdlib>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const float4x4 kProj = math::perspective(math::radians(60.f), 1.5f, 0.1f, 200.f);
+
+float4x4 getViewProj(float3 eye, float3 target)
+{
+    return math::mul(kProj, math::matrixFromLookAt(eye, target, float3(0.f, 1.f, 0.f)));
+}
+
+std::vector<float4x4> createViews(uint32_t viewCount, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-50.f, 50.f);
+    std::vector<float4x4> viewProjs;
+    for (uint32_t i = 0; i < viewCount; i++)
+        viewProjs.push_back(getViewProj(float3(u(rng), u(rng) * 0.1f, u(rng)), float3(u(rng), 0.f, u(rng))));
+    return viewProjs;
+}
+
+std::vector<AABB> createBoxes(uint32_t count, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-100.f, 100.f);
+    std::uniform_real_distribution<float> size(0.1f, 4.f);
+    std::vector<AABB> boxes;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float3 center(u(rng), u(rng) * 0.1f, u(rng));
+        boxes.emplace_back(center - float3(size(rng)), center + float3(size(rng)));
+    }
+    return boxes;
+}
+
+/// Returns the clip-space margin of the box against the frustum: negative if all 8 corners are outside one clip plane.
+float getClipMargin(const float4x4& viewProj, const AABB& box)
+{
+    float margin = std::numeric_limits<float>::max();
+    for (uint32_t plane = 0; plane < 6; plane++)
+    {
+        float maxDist = -std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            float3 corner(i & 1 ? box.maxPoint.x : box.minPoint.x, i & 2 ? box.maxPoint.y : box.minPoint.y, i & 4 ? box.maxPoint.z : box.minPoint.z);
+            float4 p = math::mul(viewProj, float4(corner, 1.f));
+            float dist[6] = {p.w + p.x, p.w - p.x, p.w + p.y, p.w - p.y, p.z, p.w - p.z};
+            maxDist = std::max(maxDist, dist[plane]);
+        }
+        margin = std::min(margin, maxDist);
+    }
+    return margin;
+}
+} // namespace
+
+CPU_TEST(MultiViewCulling_Visibility)
+{
+    std::mt19937 rng(1);
+    const std::vector<AABB> boxes = createBoxes(10000, rng);
+    const std::vector<float4x4> viewProjs = createViews(6, rng);
+
+    MultiViewCulling culling;
+    culling.resize((uint32_t)boxes.size());
+    for (uint32_t i = 0; i < boxes.size(); i++)
+        culling.setBounds(i, boxes[i]);
+    // Bounds are stored as center and half extent.
+    EXPECT_LT(length(culling.getBounds(7).minPoint - boxes[7].minPoint), 1e-5f);
+    EXPECT_LT(length(culling.getBounds(7).maxPoint - boxes[7].maxPoint), 1e-5f);
+    culling.setViews(viewProjs);
+    culling.cull();
+
+    ASSERT_EQ(culling.getViewCount(), viewProjs.size());
+    for (uint32_t view = 0; view < viewProjs.size(); view++)
+    {
+        uint32_t visibleCount = 0;
+        uint32_t mismatchCount = 0;
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            // Skip boxes touching a plane, where rounding decides.
+            float margin = getClipMargin(viewProjs[view], boxes[i]);
+            if (std::abs(margin) < 1e-3f)
+                continue;
+            bool expected = margin > 0.f;
+            visibleCount += expected;
+            mismatchCount += culling.isVisible(view, i) != expected;
+        }
+        EXPECT_EQ(mismatchCount, 0) << "view " << view;
+        EXPECT_GT(visibleCount, 0);
+        EXPECT_LT(visibleCount, boxes.size());
+
+        // The compacted list holds exactly the set bits in increasing order.
+        const auto& visibleItems = culling.getVisibleItems(view);
+        uint32_t bitCount = 0;
+        for (uint32_t i = 0; i < boxes.size(); i++)
+            bitCount += culling.isVisible(view, i);
+        EXPECT_EQ(visibleItems.size(), bitCount);
+        EXPECT(std::is_sorted(visibleItems.begin(), visibleItems.end()));
+        EXPECT(std::all_of(visibleItems.begin(), visibleItems.end(), [&](uint32_t i) { return culling.isVisible(view, i); }));
+    }
+}
+
+CPU_TEST(MultiViewCulling_SpecialItems)
+{
+    const float4x4 viewProj = getViewProj(float3(0.f), float3(0.f, 0.f, -1.f));
+
+    // Item count not a multiple of 64, so the last bitset word has padding bits.
+    MultiViewCulling culling;
+    culling.resize(70);
+    culling.setBounds(0, AABB(float3(-1.f, -1.f, -11.f), float3(1.f, 1.f, -9.f)));
+    culling.setBounds(1, AABB(float3(-1.f, -1.f, 9.f), float3(1.f, 1.f, 11.f)));
+    culling.setBounds(2, AABB());
+    culling.setAlwaysVisible(3);
+    culling.setBounds(69, AABB(float3(-1.f, -1.f, -11.f), float3(1.f, 1.f, -9.f)));
+    culling.setViews({viewProj});
+    culling.cull();
+
+    EXPECT(culling.isVisible(0, 0));
+    EXPECT(!culling.isVisible(0, 1)); // Behind the camera.
+    EXPECT(!culling.isVisible(0, 2)); // Invalid bounds.
+    EXPECT(!culling.getBounds(2).valid());
+    EXPECT(culling.isVisible(0, 3)); // Always visible.
+    EXPECT(!culling.isVisible(0, 4)); // Bounds never set.
+    EXPECT(culling.isVisible(0, 69));
+    EXPECT_EQ(culling.getVisibility(0).size(), 2);
+    EXPECT_EQ(culling.getVisibility(0)[1], uint64_t(1) << 5);
+    EXPECT(culling.getVisibleItems(0) == std::vector<uint32_t>({0, 3, 69}));
+
+    // No views.
+    culling.setViews({});
+    culling.cull();
+    EXPECT_EQ(culling.getViewCount(), 0);
+}
+
+CPU_TEST(MultiViewCulling_Benchmark, TAGS("benchmark"))
+{
+    // Instances with object-space bounds and a world transform, as in Scene::rasterizeFrustumCulling().
+    const uint32_t kInstanceCount = 100000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-100.f, 100.f);
+    std::uniform_real_distribution<float> angle(0.f, 360.f);
+    const AABB meshBB(float3(-1.f), float3(1.f));
+    std::vector<float4x4> transforms;
+    for (uint32_t i = 0; i < kInstanceCount; i++)
+        transforms.push_back(math::mul(math::matrixFromTranslation(float3(u(rng), u(rng) * 0.1f, u(rng))), math::matrixFromRotationY(math::radians(angle(rng)))));
+
+    MultiViewCulling culling;
+    culling.resize(kInstanceCount);
+    for (uint32_t i = 0; i < kInstanceCount; i++)
+        culling.setBounds(i, meshBB.transform(transforms[i]));
+
+    const uint32_t kIterations = 10;
+    for (uint32_t viewCount : {1u, 2u, 6u, 16u})
+    {
+        const std::vector<float4x4> viewProjs = createViews(viewCount, rng);
+
+        // Baseline: transform the bounds and test them against each view separately.
+        std::vector<std::vector<uint32_t>> visibleItems(viewCount);
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t iteration = 0; iteration < kIterations; iteration++)
+        {
+            for (uint32_t view = 0; view < viewCount; view++)
+            {
+                const MultiViewCulling::Planes planes = MultiViewCulling::extractPlanes(viewProjs[view]);
+                visibleItems[view].clear();
+                for (uint32_t i = 0; i < kInstanceCount; i++)
+                {
+                    AABB bounds = meshBB.transform(transforms[i]);
+                    float3 center = bounds.center(), extent = bounds.extent() * 0.5f;
+                    bool inside = true;
+                    for (const float4& plane : planes)
+                        inside &= dot(plane.xyz(), center) + plane.w + dot(abs(plane.xyz()), extent) >= 0.f;
+                    if (inside)
+                        visibleItems[view].push_back(i);
+                }
+            }
+        }
+        double baselineTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kIterations;
+
+        culling.setViews(viewProjs);
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t iteration = 0; iteration < kIterations; iteration++)
+            culling.cull();
+        double batchedTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kIterations;
+
+        size_t visibleCount = 0;
+        for (uint32_t view = 0; view < viewCount; view++)
+        {
+            EXPECT_EQ(culling.getVisibleItems(view).size(), visibleItems[view].size());
+            visibleCount += culling.getVisibleItems(view).size();
+        }
+
+        logInfo(
+            "MultiViewCulling: {} views, {} instances, {} visible: per-view {:.3f} ms, batched {:.3f} ms ({:.1f}M instance-views/s, {:.1f}x)", viewCount,
+            kInstanceCount, visibleCount, baselineTime, batchedTime, kInstanceCount * viewCount / (batchedTime * 1e3), baselineTime / batchedTime
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,305 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/OcclusionCulling.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstdlib>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const float4x4 kProj = math::perspective(math::radians(60.f), 2.f, 0.1f, 1000.f);
+
+float4x4 getViewProj(float3 eye, float3 target)
+{
+    return math::mul(kProj, math::matrixFromLookAt(eye, target, float3(0.f, 1.f, 0.f)));
+}
+
+/// Quad in the xy-plane covering [-halfExtent, halfExtent]^2, as two triangles with unshared vertices.
+OcclusionCulling::Hull createQuad(float halfExtent)
+{
+    float h = halfExtent;
+    std::vector<float3> positions = {{-h, -h, 0.f}, {h, -h, 0.f}, {h, h, 0.f}, {-h, -h, 0.f}, {h, h, 0.f}, {-h, h, 0.f}};
+    std::vector<uint32_t> indices = {0, 1, 2, 3, 4, 5};
+    return OcclusionCulling::createHull(positions, indices, 2);
+}
+
+AABB createBox(float3 center, float halfExtent)
+{
+    return AABB(center - float3(halfExtent), center + float3(halfExtent));
+}
+
+/// Returns the ray parameter of the intersection with a triangle, or infinity.
+float intersectTriangle(float3 origin, float3 dir, float3 v0, float3 v1, float3 v2)
+{
+    float3 e1 = v1 - v0, e2 = v2 - v0;
+    float3 p = cross(dir, e2);
+    float det = dot(e1, p);
+    if (std::abs(det) < 1e-12f)
+        return std::numeric_limits<float>::infinity();
+    float3 s = origin - v0;
+    float u = dot(s, p) / det;
+    float3 q = cross(s, e1);
+    float v = dot(dir, q) / det;
+    float t = dot(e2, q) / det;
+    return u >= 0.f && v >= 0.f && u + v <= 1.f && t > 0.f ? t : std::numeric_limits<float>::infinity();
+}
+} // namespace
+
+CPU_TEST(OcclusionCulling_CreateHull)
+{
+    // Welding merges the shared vertices of the two triangles.
+    auto quad = createQuad(1.f);
+    EXPECT_EQ(quad.positions.size(), 4u);
+    EXPECT_EQ(quad.getTriangleCount(), 2u);
+    EXPECT(quad.bounds == AABB(float3(-1.f, -1.f, 0.f), float3(1.f, 1.f, 0.f)));
+
+    // Degenerate triangles are removed.
+    std::vector<float3> positions = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {2.f, 0.f, 0.f}, {1.f, 0.f, 0.f}};
+    auto hull = OcclusionCulling::createHull(positions, {0, 1, 2, 0, 1, 3, 1, 4, 2}, 16);
+    EXPECT_EQ(hull.getTriangleCount(), 1u);
+
+    // Meshes over the triangle budget are rejected.
+    EXPECT(OcclusionCulling::createHull(positions, {0, 1, 2, 0, 1, 3}, 1).empty());
+
+    OcclusionCulling culling;
+    EXPECT_EQ(culling.addHull({}), OcclusionCulling::kInvalidHullID);
+    EXPECT_EQ(culling.addHull(quad), 0u);
+}
+
+CPU_TEST(OcclusionCulling_Wall)
+{
+    OcclusionCulling culling;
+    uint32_t wallID = culling.addHull(createQuad(5.f));
+
+    // The wall at z = -10 covers the center of the screen.
+    culling.update(getViewProj(float3(0.f), float3(0.f, 0.f, -1.f)), {{wallID, math::matrixFromTranslation(float3(0.f, 0.f, -10.f))}});
+    EXPECT_EQ(culling.getStats().occluderCount, 1u);
+    EXPECT_EQ(culling.getStats().occluderTriangleCount, 2u);
+    EXPECT_LT(culling.getDepth(culling.getWidth() / 2, culling.getHeight() / 2), 1.f);
+    EXPECT_EQ(culling.getDepth(0, 0), 1.f);
+
+    EXPECT(!culling.isVisible(createBox(float3(0.f, 0.f, -20.f), 1.f)));      // Behind the wall.
+    EXPECT(!culling.isVisible(createBox(float3(2.f, -2.f, -40.f), 2.f)));     // Behind the wall.
+    EXPECT(culling.isVisible(createBox(float3(0.f, 0.f, -5.f), 1.f)));        // In front of the wall.
+    EXPECT(culling.isVisible(createBox(float3(0.f, 0.f, -10.5f), 1.f)));      // Intersecting the wall.
+    EXPECT(culling.isVisible(createBox(float3(10.f, 0.f, -20.f), 1.f)));      // Partially behind the wall.
+    EXPECT(culling.isVisible(createBox(float3(30.f, 0.f, -20.f), 1.f)));      // Next to the wall.
+    EXPECT(culling.isVisible(createBox(float3(0.f, 0.f, 0.f), 1.f)));         // Crossing the near plane.
+    EXPECT_EQ(culling.getStats().testedCount, 7u);
+    EXPECT_EQ(culling.getStats().culledCount, 2u);
+
+    // Clipping against the near plane: the wall passes through the camera and hides everything on its far side.
+    culling.update(
+        getViewProj(float3(0.f), float3(0.f, 0.f, -1.f)),
+        {{wallID, math::mul(math::matrixFromTranslation(float3(-1.f, 0.f, 0.f)), math::matrixFromRotationY(math::radians(90.f)))}}
+    );
+    EXPECT(!culling.isVisible(createBox(float3(-20.f, 0.f, -20.f), 1.f)));
+    EXPECT(culling.isVisible(createBox(float3(20.f, 0.f, -20.f), 1.f)));
+}
+
+CPU_TEST(OcclusionCulling_Selection)
+{
+    OcclusionCulling::Options options;
+    options.maxOccluders = 2;
+    options.minOccluderScreenArea = 0.01f;
+    OcclusionCulling culling(options);
+    uint32_t quadID = culling.addHull(createQuad(1.f));
+
+    // Five quads at different distances, the two nearest are selected. The last one is too small on screen.
+    std::vector<OcclusionCulling::Candidate> candidates;
+    for (float z : {-40.f, -5.f, -20.f, -3.f, -500.f})
+        candidates.push_back({quadID, math::matrixFromTranslation(float3(0.f, 0.f, z))});
+    culling.update(getViewProj(float3(0.f), float3(0.f, 0.f, -1.f)), candidates);
+    EXPECT_EQ(culling.getStats().occluderCount, 2u);
+
+    // Only the quad at z = -3 is rasterized at the center, the depth of the quad at z = -5 is larger.
+    float depth3 = math::mul(kProj, float4(0.f, 0.f, -3.f, 1.f)).z / 3.f;
+    float centerDepth = culling.getDepth(culling.getWidth() / 2, culling.getHeight() / 2);
+    EXPECT_GE(centerDepth, depth3);
+    EXPECT_LT(centerDepth, math::mul(kProj, float4(0.f, 0.f, -4.f, 1.f)).z / 4.f);
+
+    // Without candidates nothing is culled.
+    culling.update(getViewProj(float3(0.f), float3(0.f, 0.f, -1.f)), {});
+    EXPECT(culling.isVisible(createBox(float3(0.f, 0.f, -100.f), 1.f)));
+}
+
+CPU_TEST(OcclusionCulling_Conservative)
+{
+    // Random triangles as occluders. Every box reported as occluded is verified by casting rays from the eye
+    // to points on the box, none of which may be visible.
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+    const float3 eye(0.f);
+    const float4x4 viewProj = getViewProj(eye, float3(0.f, 0.f, -1.f));
+
+    uint32_t culledCount = 0;
+    for (uint32_t iteration = 0; iteration < 20; iteration++)
+    {
+        OcclusionCulling culling;
+        std::vector<float3> triangles;
+        std::vector<OcclusionCulling::Candidate> candidates;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float3 center(u(rng) * 8.f, u(rng) * 4.f, -10.f + u(rng) * 4.f);
+            std::vector<float3> positions;
+            for (uint32_t j = 0; j < 3; j++)
+                positions.push_back(center + float3(u(rng) * 6.f, u(rng) * 6.f, u(rng) * 2.f));
+            triangles.insert(triangles.end(), positions.begin(), positions.end());
+            uint32_t hullID = culling.addHull(OcclusionCulling::createHull(positions, {0, 1, 2}, 1));
+            candidates.push_back({hullID, float4x4::identity()});
+        }
+        culling.update(viewProj, candidates);
+
+        for (uint32_t i = 0; i < 200; i++)
+        {
+            float3 center(u(rng) * 12.f, u(rng) * 6.f, -20.f + u(rng) * 6.f);
+            float halfExtent = 0.1f + 0.5f * (u(rng) + 1.f);
+            AABB box = createBox(center, halfExtent);
+            if (culling.isVisible(box))
+                continue;
+            culledCount++;
+
+            for (uint32_t j = 0; j < 512; j++)
+            {
+                float3 target = center + float3(u(rng), u(rng), u(rng)) * halfExtent;
+                float3 dir = target - eye;
+                float tMin = std::numeric_limits<float>::infinity();
+                for (size_t k = 0; k < triangles.size(); k += 3)
+                    tMin = std::min(tMin, intersectTriangle(eye, dir, triangles[k], triangles[k + 1], triangles[k + 2]));
+                EXPECT_LT(tMin, 1.f) << "Point on a culled box is visible, iteration " << iteration << ", box " << i;
+            }
+        }
+    }
+    EXPECT_GT(culledCount, 0u);
+}
+
+CPU_TEST(OcclusionCulling_Benchmark, TAGS("benchmark"))
+{
+    // Indoor layout: a grid of rooms separated by walls with doorways, each room filled with small objects.
+    const uint32_t kRooms = 16;
+    const float kRoomSize = 10.f;
+    const uint32_t kObjectsPerRoom = 200;
+
+    OcclusionCulling culling;
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+    auto addQuad = [&](float3 a, float3 b, float3 c, float3 d)
+    {
+        uint32_t base = (uint32_t)positions.size();
+        positions.insert(positions.end(), {a, b, c, d});
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    };
+    // Wall segment along x with a doorway in the middle.
+    const float h = kRoomSize * 0.5f, door = 1.f, height = 3.f;
+    addQuad({-h, 0.f, 0.f}, {-door, 0.f, 0.f}, {-door, height, 0.f}, {-h, height, 0.f});
+    addQuad({door, 0.f, 0.f}, {h, 0.f, 0.f}, {h, height, 0.f}, {door, height, 0.f});
+    uint32_t wallID = culling.addHull(OcclusionCulling::createHull(positions, indices, 16));
+
+    std::vector<OcclusionCulling::Candidate> candidates;
+    std::vector<AABB> objects;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-0.45f, 0.45f);
+    for (uint32_t z = 0; z < kRooms; z++)
+    {
+        for (uint32_t x = 0; x < kRooms; x++)
+        {
+            float3 center((x - kRooms * 0.5f) * kRoomSize, 0.f, (z - kRooms * 0.5f) * kRoomSize);
+            for (float4x4 wall :
+                 {math::matrixFromTranslation(center + float3(0.f, 0.f, h)),
+                  math::mul(math::matrixFromTranslation(center + float3(h, 0.f, 0.f)), math::matrixFromRotationY(math::radians(90.f)))})
+                candidates.push_back({wallID, wall});
+            for (uint32_t i = 0; i < kObjectsPerRoom; i++)
+                objects.push_back(createBox(center + float3(u(rng) * kRoomSize, 0.5f, u(rng) * kRoomSize), 0.3f));
+        }
+    }
+
+    struct View
+    {
+        const char* name;
+        float3 eye;
+        float3 target;
+    };
+    const View views[] = {
+        {"room", {2.f, 1.7f, 3.f}, {-20.f, 1.7f, -30.f}},
+        {"doorway", {0.f, 1.7f, 8.f}, {0.f, 1.7f, -40.f}},
+        {"corner", {-h + 0.5f, 1.7f, -h + 0.5f}, {20.f, 1.5f, 20.f}},
+    };
+    for (const auto& view : views)
+    {
+        float4x4 viewProj = getViewProj(view.eye, view.target);
+
+        // Only objects passing frustum culling are tested, as in Scene::rasterizeFrustumCulling().
+        std::vector<AABB> visibleObjects;
+        for (const auto& object : objects)
+        {
+            uint32_t outside[6] = {};
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                float3 corner(i & 1 ? object.maxPoint.x : object.minPoint.x, i & 2 ? object.maxPoint.y : object.minPoint.y, i & 4 ? object.maxPoint.z : object.minPoint.z);
+                float4 p = math::mul(viewProj, float4(corner, 1.f));
+                outside[0] += p.x > p.w;
+                outside[1] += p.x < -p.w;
+                outside[2] += p.y > p.w;
+                outside[3] += p.y < -p.w;
+                outside[4] += p.z > p.w;
+                outside[5] += p.z < 0.f;
+            }
+            if (std::all_of(std::begin(outside), std::end(outside), [](uint32_t count) { return count < 8; }))
+                visibleObjects.push_back(object);
+        }
+
+        double updateTime = 0.0;
+        double testTime = 0.0;
+        const uint32_t kIterations = 10;
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            culling.update(viewProj, candidates);
+            updateTime += culling.getStats().updateTimeMs;
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (const auto& object : visibleObjects)
+                culling.isVisible(object);
+            testTime += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        }
+        const auto& stats = culling.getStats();
+        EXPECT_GT(stats.occluderCount, 0u) << view.name;
+        EXPECT_EQ(stats.testedCount, (uint64_t)visibleObjects.size()) << view.name;
+        EXPECT_LE(stats.culledCount, stats.testedCount) << view.name;
+        logInfo(
+            "OcclusionCulling: view '{}': {} occluders, {} triangles, {:.2f}% of {} objects in the frustum culled, update {:.3f} ms, tests {:.3f} ms", view.name,
+            stats.occluderCount, stats.occluderTriangleCount, 100.f * stats.getCullRate(), visibleObjects.size(), updateTime / kIterations,
+            testTime / kIterations
+        );
+    }
+}
+} // namespace Falcor
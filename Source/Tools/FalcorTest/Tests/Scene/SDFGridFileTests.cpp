@@ -0,0 +1,203 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFGridFile.h"
+#include "Core/Platform/OS.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+// Removes the file when going out of scope, also when an assertion returns early.
+struct TempFile
+{
+    std::filesystem::path path;
+    ~TempFile()
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+// Sphere SDF in grid local space [-0.5, 0.5]^3, which leaves most chunks entirely clamped.
+std::vector<float> generateSphereValues(uint32_t gridWidth)
+{
+    const uint32_t n = gridWidth + 1;
+    std::vector<float> values((size_t)n * n * n);
+    for (uint32_t z = 0; z < n; ++z)
+        for (uint32_t y = 0; y < n; ++y)
+            for (uint32_t x = 0; x < n; ++x)
+                values[x + n * (y + n * z)] = length(float3(x, y, z) / float(gridWidth) - 0.5f) - 0.3f;
+    return values;
+}
+
+int8_t quantize(float value, uint32_t gridWidth)
+{
+    float scaled = std::clamp(value / SDFGridFile::getMaxDistance(gridWidth), -1.f, 1.f) * float(INT8_MAX);
+    return scaled >= 0.f ? int8_t(scaled + 0.5f) : int8_t(scaled - 0.5f);
+}
+
+void testRoundTrip(CPUUnitTestContext& ctx, uint32_t gridWidth, uint32_t chunkWidth)
+{
+    const TempFile tempFile{getRuntimeDirectory() / "SDFGridFile_roundtrip.sdfc"};
+    const std::filesystem::path& tempPath = tempFile.path;
+    const std::vector<float> values = generateSphereValues(gridWidth);
+
+    SDFGridFile::write(tempPath, values.data(), gridWidth, chunkWidth);
+    EXPECT(SDFGridFile::isChunkedFile(tempPath));
+
+    {
+        SDFGridFile file(tempPath);
+        EXPECT_EQ(file.getGridWidth(), gridWidth);
+        EXPECT_EQ(file.getChunkWidth(), chunkWidth);
+        EXPECT_EQ(file.getChunkCount(), file.getChunksPerAxis() * file.getChunksPerAxis() * file.getChunksPerAxis());
+        EXPECT_GT(file.getNonEmptyChunkCount(), 0u);
+        EXPECT_LT(file.getNonEmptyChunkCount(), file.getChunkCount());
+        EXPECT_LT(std::filesystem::file_size(tempPath), values.size());
+
+        std::vector<int8_t> quantizedValues = file.readQuantizedValues();
+        ASSERT_EQ(quantizedValues.size(), values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+            EXPECT_EQ(quantizedValues[i], quantize(values[i], gridWidth)) << "value " << i;
+
+        std::vector<float> dequantizedValues = file.readValues();
+        const float scale = SDFGridFile::getMaxDistance(gridWidth) / float(INT8_MAX);
+        for (size_t i = 0; i < values.size(); ++i)
+            EXPECT_EQ(dequantizedValues[i], quantizedValues[i] * scale) << "value " << i;
+
+        // Slabs cover all z-planes once and match the values decoded at once.
+        const size_t planeSize = (size_t)(gridWidth + 1) * (gridWidth + 1);
+        uint32_t planeCount = 0;
+        std::vector<int8_t> slab;
+        for (uint32_t slabIndex = 0; slabIndex < file.getChunksPerAxis(); ++slabIndex)
+        {
+            slab.resize(planeSize * file.getSlabPlaneCount(slabIndex));
+            file.readQuantizedSlab(slabIndex, slab.data());
+            EXPECT(std::equal(slab.begin(), slab.end(), quantizedValues.begin() + planeSize * planeCount)) << "slab " << slabIndex;
+            planeCount += file.getSlabPlaneCount(slabIndex);
+        }
+        EXPECT_EQ(planeCount, gridWidth + 1);
+    }
+}
+} // namespace
+
+CPU_TEST(SDFGridFile_RoundTrip)
+{
+    testRoundTrip(ctx, 64, 16);
+    testRoundTrip(ctx, 64, 7);
+    testRoundTrip(ctx, 100, 16);
+}
+
+CPU_TEST(SDFGridFile_CorruptChunk)
+{
+    const TempFile tempFile{getRuntimeDirectory() / "SDFGridFile_corrupt.sdfc"};
+    const std::filesystem::path& tempPath = tempFile.path;
+    const uint32_t gridWidth = 64;
+    const std::vector<float> values = generateSphereValues(gridWidth);
+    SDFGridFile::write(tempPath, values.data(), gridWidth);
+
+    // Overwrite the payload of a compressed chunk. Decoding must fail with an exception instead of terminating in the parallel loop.
+    uint64_t offset = 0;
+    uint32_t size = 0;
+    {
+        SDFGridFile file(tempPath);
+        for (uint32_t chunkIndex = 0; chunkIndex < file.getChunkCount() && size == 0; ++chunkIndex)
+        {
+            // Compressed chunks are smaller than their values.
+            const SDFGridFile::Chunk& chunk = file.getChunk(chunkIndex);
+            const uint3 valueCount = file.getChunkValueCount(chunkIndex);
+            if (chunk.size > 0 && chunk.size < valueCount.x * valueCount.y * valueCount.z)
+            {
+                offset = chunk.offset;
+                size = chunk.size;
+            }
+        }
+    }
+    ASSERT_GT(size, 0u);
+    {
+        std::fstream file(tempPath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        const std::vector<char> garbage(size, char(0xff));
+        file.write(garbage.data(), garbage.size());
+    }
+
+    {
+        SDFGridFile file(tempPath);
+        bool thrown = false;
+        try
+        {
+            file.readQuantizedValues();
+        }
+        catch (const RuntimeError&)
+        {
+            thrown = true;
+        }
+        EXPECT(thrown);
+    }
+}
+
+CPU_TEST(SDFGridFile_LegacyConversion)
+{
+    const TempFile legacyFile{getRuntimeDirectory() / "SDFGridFile_legacy.sdfg"};
+    const TempFile chunkedFile{getRuntimeDirectory() / "SDFGridFile_converted.sdfc"};
+    const TempFile roundTripFile{getRuntimeDirectory() / "SDFGridFile_roundtrip.sdfg"};
+    const std::filesystem::path& legacyPath = legacyFile.path;
+    const std::filesystem::path& chunkedPath = chunkedFile.path;
+    const std::filesystem::path& roundTripPath = roundTripFile.path;
+    const uint32_t gridWidth = 32;
+    const std::vector<float> values = generateSphereValues(gridWidth);
+
+    {
+        std::ofstream file(legacyPath, std::ios::out | std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&gridWidth), sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    }
+    EXPECT(!SDFGridFile::isChunkedFile(legacyPath));
+
+    SDFGridFile::convertFromLegacy(legacyPath, chunkedPath);
+    SDFGridFile::convertToLegacy(chunkedPath, roundTripPath);
+
+    {
+        std::ifstream file(roundTripPath, std::ios::in | std::ios::binary);
+        uint32_t roundTripGridWidth = 0;
+        file.read(reinterpret_cast<char*>(&roundTripGridWidth), sizeof(uint32_t));
+        ASSERT_EQ(roundTripGridWidth, gridWidth);
+
+        std::vector<float> roundTripValues(values.size());
+        file.read(reinterpret_cast<char*>(roundTripValues.data()), roundTripValues.size() * sizeof(float));
+        ASSERT(file.good());
+
+        // Converting is lossy once, converting the result again must not change the quantized values.
+        for (size_t i = 0; i < values.size(); ++i)
+            EXPECT_EQ(quantize(roundTripValues[i], gridWidth), quantize(values[i], gridWidth)) << "value " << i;
+    }
+}
+} // namespace Falcor
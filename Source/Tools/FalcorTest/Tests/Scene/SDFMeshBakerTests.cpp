@@ -0,0 +1,133 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFMeshBaker.h"
+#include "Scene/TriangleMesh.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+float boxDistance(float3 p, float3 halfExtent)
+{
+    float3 d = abs(p) - halfExtent;
+    return length(max(d, float3(0.f))) + std::min(std::max(std::max(d.x, d.y), d.z), 0.f);
+}
+
+void testCube(CPUUnitTestContext& ctx, SDFMeshBaker::SignMode signMode, float narrowBandWidth)
+{
+    ref<TriangleMesh> pMesh = TriangleMesh::createCube(float3(1.f));
+    SDFMeshBaker baker(*pMesh);
+
+    SDFMeshBaker::Options options;
+    options.gridWidth = 32;
+    options.signMode = signMode;
+    options.narrowBandWidth = narrowBandWidth;
+    SDFMeshBaker::Result result = baker.bake(options);
+
+    const uint32_t n = options.gridWidth + 1;
+    ASSERT_EQ(result.values.size(), (size_t)n * n * n);
+
+    // Grid values are stored in grid local space, the analytic reference is evaluated in mesh space.
+    const float scale = result.meshToGrid[0][0];
+    const float band = narrowBandWidth > 0.f ? narrowBandWidth / options.gridWidth : std::numeric_limits<float>::infinity();
+    for (uint32_t z = 0; z < n; ++z)
+    {
+        for (uint32_t y = 0; y < n; ++y)
+        {
+            for (uint32_t x = 0; x < n; ++x)
+            {
+                float3 p = (float3(x, y, z) / float(options.gridWidth) - 0.5f) / scale;
+                float expected = std::clamp(boxDistance(p, float3(0.5f)) * scale, -band, band);
+                float value = result.values[x + n * (y + n * z)];
+                EXPECT_LE(std::abs(value - expected), 1e-5f) << "corner (" << x << ", " << y << ", " << z << ")";
+            }
+        }
+    }
+}
+} // namespace
+
+CPU_TEST(SDFMeshBaker_Cube)
+{
+    testCube(ctx, SDFMeshBaker::SignMode::WindingNumber, 0.f);
+    testCube(ctx, SDFMeshBaker::SignMode::WindingNumber, 4.f);
+    testCube(ctx, SDFMeshBaker::SignMode::RayParity, 0.f);
+    testCube(ctx, SDFMeshBaker::SignMode::RayParity, 4.f);
+}
+
+CPU_TEST(SDFMeshBaker_Queries)
+{
+    ref<TriangleMesh> pMesh = TriangleMesh::createSphere(0.5f, 64, 32);
+    SDFMeshBaker baker(*pMesh);
+
+    EXPECT_EQ(baker.getTriangleCount(), (uint32_t)(pMesh->getIndices().size() / 3));
+    EXPECT_GE(std::abs(baker.getWindingNumber(float3(0.f))), 0.99f);
+    EXPECT_GE(std::abs(baker.getWindingNumber(float3(0.4f, 0.f, 0.f))), 0.5f);
+    EXPECT_LE(std::abs(baker.getWindingNumber(float3(0.6f, 0.f, 0.f))), 0.5f);
+    EXPECT_LE(std::abs(baker.getWindingNumber(float3(10.f))), 0.01f);
+
+    EXPECT_LE(std::abs(baker.getDistance(float3(0.f)) - 0.5f), 0.01f);
+    EXPECT_LE(std::abs(baker.getDistance(float3(0.f, 2.f, 0.f)) - 1.5f), 0.01f);
+    EXPECT_EQ(baker.getDistance(float3(0.f, 2.f, 0.f), 1.f), 1.f);
+}
+
+CPU_TEST(SDFMeshBaker_Benchmark, TAGS("benchmark"))
+{
+    ref<TriangleMesh> pMesh = TriangleMesh::createSphere(0.5f, 512, 256);
+    SDFMeshBaker baker(*pMesh);
+
+    for (auto signMode : {SDFMeshBaker::SignMode::WindingNumber, SDFMeshBaker::SignMode::RayParity})
+    {
+        for (uint32_t gridWidth = 64; gridWidth <= 512; gridWidth *= 2)
+        {
+            SDFMeshBaker::Options options;
+            options.gridWidth = gridWidth;
+            options.signMode = signMode;
+
+            auto start = CpuTimer::getCurrentTimePoint();
+            SDFMeshBaker::Result result = baker.bake(options);
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            const uint32_t cornerWidth = gridWidth + 1;
+            ASSERT_EQ(result.values.size(), (size_t)cornerWidth * cornerWidth * cornerWidth);
+            const uint32_t center = gridWidth / 2;
+            EXPECT_LT(result.values[((size_t)center * cornerWidth + center) * cornerWidth + center], 0.f);
+            EXPECT_GT(result.values[0], 0.f);
+
+            logInfo(
+                "SDFMeshBaker: {} triangles, grid width {}, {}: {:.1f} ms", baker.getTriangleCount(), gridWidth,
+                signMode == SDFMeshBaker::SignMode::WindingNumber ? "winding number" : "ray parity", duration
+            );
+        }
+    }
+}
+} // namespace Falcor
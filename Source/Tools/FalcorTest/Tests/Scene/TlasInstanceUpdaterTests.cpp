@@ -0,0 +1,325 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/TlasInstanceUpdater.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Animation/Animation.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const AABB kUnitBox(float3(-0.5f), float3(0.5f));
+
+RtInstanceDesc createDesc(uint32_t instanceID, const float4x4& transform)
+{
+    RtInstanceDesc desc = {};
+    desc.instanceID = instanceID;
+    desc.instanceMask = 0xFF;
+    desc.accelerationStructure = 0x1000;
+    desc.setTransform(transform);
+    return desc;
+}
+
+/// Creates a row of unit boxes along x, one per desc.
+TlasInstanceUpdater createRow(uint32_t count, const TlasInstanceUpdater::Options& options = {})
+{
+    std::vector<RtInstanceDesc> descs;
+    std::vector<AABB> bounds;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float4x4 transform = math::matrixFromTranslation(float3(2.f * i, 0.f, 0.f));
+        descs.push_back(createDesc(i, transform));
+        bounds.push_back(kUnitBox.transform(transform));
+    }
+    TlasInstanceUpdater updater(options);
+    updater.reset(std::move(descs), std::move(bounds));
+    return updater;
+}
+
+void moveInstance(TlasInstanceUpdater& updater, uint32_t index, float3 offset)
+{
+    float4x4 transform = math::matrixFromTranslation(float3(2.f * index, 0.f, 0.f) + offset);
+    updater.setTransform(index, transform, kUnitBox.transform(transform));
+}
+
+const uint32_t kRayCount = 8;
+
+/// Creates a scene with a unit quad in the xz-plane that moves linearly from x = 0 at time 0 to x = 4 at time 1.
+ref<Scene> createAnimatedScene(ref<Device> pDevice)
+{
+    SceneBuilder builder(pDevice, Settings(), SceneBuilder::Flags::DontOptimizeGraph);
+    MeshID meshID = builder.addTriangleMesh(TriangleMesh::createQuad(), StandardMaterial::create(pDevice, "Quad"));
+    NodeID nodeID = builder.addNode(SceneBuilder::Node{"Quad", float4x4::identity()});
+    builder.addMeshInstance(nodeID, meshID);
+
+    ref<Animation> pAnimation = Animation::create("Move", nodeID, 1.0);
+    pAnimation->addKeyframe(Animation::Keyframe{0.0, float3(0.f)});
+    pAnimation->addKeyframe(Animation::Keyframe{1.0, float3(4.f, 0.f, 0.f)});
+    builder.addAnimation(pAnimation);
+
+    return builder.getScene();
+}
+
+/// Updates the scene to the given time and traces one ray down at each integer x coordinate.
+/// Checks that exactly the ray at the expected quad position hits.
+void traceAnimatedScene(GPUUnitTestContext& ctx, Scene* pScene, double time, uint32_t expectedHit)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    pScene->update(pRenderContext, time);
+    pScene->setRaytracingShaderData(pRenderContext, ctx.vars().getRootVar());
+    ctx.runProgram(kRayCount);
+
+    std::vector<float> result = ctx.readBuffer<float>("result");
+    for (uint32_t i = 0; i < kRayCount; i++)
+    {
+        if (i == expectedHit)
+            EXPECT_LE(std::abs(result[i] - 10.f), 1e-4f) << "time = " << time << ", i = " << i;
+        else
+            EXPECT_EQ(result[i], -1.f) << "time = " << time << ", i = " << i;
+    }
+}
+
+void testAnimatedTlas(GPUUnitTestContext& ctx, Scene::UpdateMode updateMode)
+{
+    ref<Scene> pScene = createAnimatedScene(ctx.getDevice());
+    pScene->setTlasUpdateMode(updateMode);
+    pScene->setIsLooped(false);
+
+    Program::Desc desc;
+    desc.addShaderModules(pScene->getShaderModules());
+    desc.addShaderLibrary("Tests/Scene/TlasInstanceUpdaterTests.cs.slang").csEntry("main").setShaderModel("6_5");
+    desc.addTypeConformances(pScene->getTypeConformances());
+    ctx.createProgram(desc, pScene->getSceneDefines());
+    ctx.allocateStructuredBuffer("result", kRayCount);
+    ctx["CB"]["rayCount"] = kRayCount;
+    ctx["CB"]["raySpacing"] = 1.f;
+
+    // The TLAS is built on the first frame and then updated in place on every frame the quad moves.
+    traceAnimatedScene(ctx, pScene.get(), 0.0, 0);
+    traceAnimatedScene(ctx, pScene.get(), 0.25, 1);
+    traceAnimatedScene(ctx, pScene.get(), 0.75, 3);
+    traceAnimatedScene(ctx, pScene.get(), 1.0, 4);
+    traceAnimatedScene(ctx, pScene.get(), 0.5, 2);
+}
+} // namespace
+
+CPU_TEST(TlasInstanceUpdater_DirtyTracking)
+{
+    TlasInstanceUpdater updater = createRow(100);
+
+    // After a reset all descs need to be uploaded.
+    EXPECT_EQ(updater.getDirtyCount(), 100);
+    auto ranges = updater.getDirtyRanges();
+    ASSERT_EQ(ranges.size(), 1);
+    EXPECT_EQ(ranges[0].first, 0);
+    EXPECT_EQ(ranges[0].count, 100);
+    updater.clearDirty();
+    EXPECT(!updater.isDirty());
+
+    // Setting the same transform does not dirty the desc.
+    float4x4 transform = math::matrixFromTranslation(float3(2.f * 7, 0.f, 0.f));
+    EXPECT(!updater.setTransform(7, transform, kUnitBox.transform(transform)));
+    EXPECT(!updater.isDirty());
+
+    // A new transform only changes the transform of the desc.
+    float4x4 moved = math::matrixFromTranslation(float3(2.f * 7, 1.f, 0.f));
+    EXPECT(updater.setTransform(7, moved, kUnitBox.transform(moved)));
+    EXPECT(updater.setTransform(7, transform, kUnitBox.transform(transform)));
+    EXPECT(updater.setTransform(7, moved, kUnitBox.transform(moved)));
+    EXPECT_EQ(updater.getDirtyCount(), 1);
+    const RtInstanceDesc& desc = updater.getDescs()[7];
+    EXPECT(std::memcmp(desc.transform, &moved, sizeof(desc.transform)) == 0);
+    EXPECT_EQ(desc.instanceID, 7);
+    EXPECT_EQ(desc.instanceMask, 0xFF);
+    EXPECT_EQ(desc.accelerationStructure, 0x1000);
+
+    updater.clearDirty();
+    EXPECT(!updater.isDirty());
+    EXPECT(updater.getDirtyRanges().empty());
+}
+
+CPU_TEST(TlasInstanceUpdater_Ranges)
+{
+    TlasInstanceUpdater::Options options;
+    options.maxRangeGap = 2;
+    TlasInstanceUpdater updater = createRow(100, options);
+    updater.clearDirty();
+
+    // Descs with at most two clean descs between them are merged.
+    for (uint32_t index : {20u, 12u, 5u, 10u, 99u, 96u})
+        moveInstance(updater, index, float3(0.f, 1.f, 0.f));
+    auto ranges = updater.getDirtyRanges();
+    ASSERT_EQ(ranges.size(), 4);
+    EXPECT(ranges[0].first == 5 && ranges[0].count == 1);
+    EXPECT(ranges[1].first == 10 && ranges[1].count == 3);
+    EXPECT(ranges[2].first == 20 && ranges[2].count == 1);
+    EXPECT(ranges[3].first == 96 && ranges[3].count == 4);
+
+    // Without gaps allowed only adjacent descs are merged.
+    options.maxRangeGap = 0;
+    updater.setOptions(options);
+    moveInstance(updater, 11, float3(0.f, 1.f, 0.f));
+    ranges = updater.getDirtyRanges();
+    ASSERT_EQ(ranges.size(), 5);
+    EXPECT(ranges[1].first == 10 && ranges[1].count == 3);
+    EXPECT(ranges[3].first == 96 && ranges[3].count == 1);
+    EXPECT(ranges[4].first == 99 && ranges[4].count == 1);
+}
+
+CPU_TEST(TlasInstanceUpdater_BoundGrowth)
+{
+    // Four unit boxes with a total surface area of 24.
+    TlasInstanceUpdater updater = createRow(4);
+    EXPECT_EQ(updater.getBoundGrowth(), 0.f);
+
+    // Moving a box by its size doubles the bounds a refit node has to cover, growing the area from 6 to 10.
+    moveInstance(updater, 1, float3(1.f, 0.f, 0.f));
+    EXPECT(std::abs(updater.getBoundGrowth() - 4.f / 24.f) < 1e-6f) << updater.getBoundGrowth();
+    EXPECT(!updater.isRebuildRecommended());
+
+    // Moving back to where it was at the last rebuild.
+    moveInstance(updater, 1, float3(0.f));
+    EXPECT_EQ(updater.getBoundGrowth(), 0.f);
+
+    // Moving far away.
+    moveInstance(updater, 1, float3(10.f, 0.f, 0.f));
+    EXPECT(std::abs(updater.getBoundGrowth() - 40.f / 24.f) < 1e-6f) << updater.getBoundGrowth();
+    EXPECT(updater.isRebuildRecommended());
+
+    // A rebuild makes the current bounds the new reference.
+    updater.markRebuilt();
+    EXPECT_EQ(updater.getBoundGrowth(), 0.f);
+    EXPECT(!updater.isRebuildRecommended());
+
+    // Unbounded instances are ignored.
+    float4x4 transform = math::matrixFromTranslation(float3(100.f, 0.f, 0.f));
+    updater.setTransform(2, transform, AABB(float3(-std::numeric_limits<float>::max()), float3(std::numeric_limits<float>::max())));
+    EXPECT_EQ(updater.getBoundGrowth(), 0.f);
+}
+
+CPU_TEST(TlasInstanceUpdater_Benchmark, TAGS("benchmark"))
+{
+    // Instances with one global matrix each, as filled by Scene::fillInstanceDesc().
+    const uint32_t kInstanceCount = 100000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-500.f, 500.f);
+    std::vector<float4x4> matrices(kInstanceCount);
+    std::vector<RtInstanceDesc> descs;
+    std::vector<AABB> bounds;
+    for (uint32_t i = 0; i < kInstanceCount; i++)
+    {
+        matrices[i] = math::matrixFromTranslation(float3(u(rng), 0.f, u(rng)));
+        descs.push_back(createDesc(i, matrices[i]));
+        bounds.push_back(kUnitBox.transform(matrices[i]));
+    }
+    // Stands in for the GPU instance desc buffer.
+    std::vector<RtInstanceDesc> uploaded = descs;
+
+    TlasInstanceUpdater updater;
+    updater.reset(descs, bounds);
+    updater.clearDirty();
+
+    const uint32_t kFrames = 20;
+    for (uint32_t movedCount : {10u, 100u, 1000u, 10000u})
+    {
+        std::vector<uint32_t> moved(movedCount);
+        std::vector<bool> changed(kInstanceCount, false);
+        for (auto& index : moved)
+        {
+            index = rng() % kInstanceCount;
+            changed[index] = true;
+        }
+
+        // Baseline: fill all descs and upload the whole buffer every frame.
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < kFrames; frame++)
+        {
+            for (uint32_t index : moved)
+                matrices[index][1][3] += 0.01f;
+            descs.clear();
+            for (uint32_t i = 0; i < kInstanceCount; i++)
+                descs.push_back(createDesc(i, matrices[i]));
+            std::memcpy(uploaded.data(), descs.data(), descs.size() * sizeof(RtInstanceDesc));
+        }
+        double fullTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kFrames;
+
+        // Patch the moved descs and upload the dirty ranges.
+        size_t uploadBytes = 0;
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < kFrames; frame++)
+        {
+            for (uint32_t index : moved)
+                matrices[index][1][3] += 0.01f;
+            for (uint32_t i = 0; i < kInstanceCount; i++)
+            {
+                if (changed[i])
+                    updater.setTransform(i, matrices[i], kUnitBox.transform(matrices[i]));
+            }
+            for (const auto& range : updater.getDirtyRanges())
+            {
+                std::memcpy(uploaded.data() + range.first, updater.getDescs().data() + range.first, range.count * sizeof(RtInstanceDesc));
+                uploadBytes += range.count * sizeof(RtInstanceDesc);
+            }
+            updater.clearDirty();
+        }
+        double patchTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kFrames;
+
+        // The patched buffer matches a full fill.
+        descs.clear();
+        for (uint32_t i = 0; i < kInstanceCount; i++)
+            descs.push_back(createDesc(i, matrices[i]));
+        EXPECT(std::memcmp(uploaded.data(), descs.data(), kInstanceCount * sizeof(RtInstanceDesc)) == 0);
+
+        logInfo(
+            "TlasInstanceUpdater: {} of {} instances moved: full fill {:.3f} ms ({:.1f} KB), patch {:.3f} ms ({:.1f} KB), {:.1f}x, bound growth {:.3f}",
+            movedCount, kInstanceCount, fullTime, kInstanceCount * sizeof(RtInstanceDesc) / 1024.0, patchTime, uploadBytes / (kFrames * 1024.0),
+            fullTime / patchTime, updater.getBoundGrowth()
+        );
+    }
+}
+
+GPU_TEST(Scene_TlasRebuildAnimated)
+{
+    // In rebuild mode the existing TLAS is rebuilt into its buffer on every frame without a source.
+    testAnimatedTlas(ctx, Scene::UpdateMode::Rebuild);
+}
+
+GPU_TEST(Scene_TlasRefitAnimated)
+{
+    testAnimatedTlas(ctx, Scene::UpdateMode::Refit);
+}
+} // namespace Falcor
@@ -0,0 +1,158 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/VertexCacheStore.h"
+#include "Core/Platform/OS.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWordCount = 1000;
+const uint32_t kKeyframeCount = 50;
+
+// Generate keyframes where only a few words change between consecutive frames, similar to a simulation cache.
+std::vector<std::vector<uint32_t>> generateKeyframes(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<std::vector<uint32_t>> keyframes;
+    std::vector<uint32_t> frame(kWordCount);
+    for (auto& v : frame)
+        v = rng();
+    for (uint32_t k = 0; k < kKeyframeCount; ++k)
+    {
+        for (uint32_t i = 0; i < 20; ++i)
+            frame[rng() % kWordCount] = rng();
+        keyframes.push_back(frame);
+    }
+    return keyframes;
+}
+
+// Removes the file when going out of scope, also when an assertion returns early.
+struct TempFile
+{
+    std::filesystem::path path;
+    ~TempFile()
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+void testStore(CPUUnitTestContext& ctx, bool deltaCompression)
+{
+    const TempFile tempFile{getRuntimeDirectory() / "VertexCacheStore.bin"};
+    const std::filesystem::path& tempPath = tempFile.path;
+    const auto keyframesA = generateKeyframes(1);
+    const auto keyframesB = generateKeyframes(2);
+    const size_t frameByteSize = kWordCount * sizeof(uint32_t);
+
+    {
+        VertexCacheStore::Writer writer(tempPath, deltaCompression);
+        uint32_t streamA = writer.addStream(frameByteSize);
+        uint32_t streamB = writer.addStream(frameByteSize);
+        for (uint32_t k = 0; k < kKeyframeCount; ++k)
+        {
+            writer.addKeyframe(streamA, keyframesA[k].data());
+            writer.addKeyframe(streamB, keyframesB[k].data());
+        }
+        writer.finalize();
+    }
+
+    {
+        VertexCacheStore store(tempPath);
+        ASSERT_EQ(store.getStreamCount(), 2);
+        EXPECT_EQ(store.getKeyframeCount(0), kKeyframeCount);
+        EXPECT_EQ(store.getFrameByteSize(1), frameByteSize);
+        if (deltaCompression)
+            EXPECT_LT(store.getFileSize(), 2 * kKeyframeCount * frameByteSize / 4);
+
+        // Random access in reverse order.
+        std::vector<uint32_t> data(kWordCount);
+        for (uint32_t k = kKeyframeCount; k-- > 0;)
+        {
+            store.readKeyframe(0, k, data.data());
+            EXPECT(data == keyframesA[k]) << "keyframe " << k;
+            store.readKeyframe(1, k, data.data());
+            EXPECT(data == keyframesB[k]) << "keyframe " << k;
+        }
+
+        // Sequential decoding from the previous keyframe.
+        std::vector<uint32_t> prev(kWordCount);
+        store.readKeyframe(0, 0, prev.data());
+        for (uint32_t k = 1; k < kKeyframeCount; ++k)
+        {
+            store.readKeyframe(0, k, data.data(), prev.data());
+            EXPECT(data == keyframesA[k]) << "keyframe " << k;
+            std::swap(data, prev);
+        }
+
+        // Prefetched keyframes must match synchronously decoded ones.
+        VertexCachePrefetcher prefetcher(store);
+        std::vector<VertexCachePrefetcher::Key> requests;
+        for (uint32_t k = 0; k < kKeyframeCount; ++k)
+            requests.push_back({1, k});
+        prefetcher.setRequests(requests);
+
+        std::vector<uint8_t> bytes;
+        for (uint32_t k = 0; k < kKeyframeCount; ++k)
+        {
+            prefetcher.fetch({1, k}, bytes, true);
+            ASSERT_EQ(bytes.size(), frameByteSize);
+            EXPECT(std::memcmp(bytes.data(), keyframesB[k].data(), frameByteSize) == 0) << "keyframe " << k;
+        }
+
+        // Dropping all requests releases the decoded keyframes.
+        prefetcher.setRequests({});
+        EXPECT_EQ(prefetcher.getResidentBytes(), 0);
+    }
+
+    // Temporary stores delete their file when closed.
+    {
+        VertexCacheStore store(tempPath, true);
+        EXPECT_EQ(store.getKeyframeCount(1), kKeyframeCount);
+    }
+    EXPECT(!std::filesystem::exists(tempPath));
+}
+} // namespace
+
+CPU_TEST(VertexCacheStore_Raw)
+{
+    testStore(ctx, false);
+}
+
+CPU_TEST(VertexCacheStore_Delta)
+{
+    testStore(ctx, true);
+}
+
+} // namespace Falcor
@@ -0,0 +1,233 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/AsyncFileReader.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Core/Platform/OS.h"
+#include <atomic>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+const AsyncFileReader::Backend kBackends[] = {AsyncFileReader::Backend::ThreadPool, AsyncFileReader::Backend::IoUring};
+
+std::vector<uint8_t> createData(size_t size, uint32_t seed)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = (uint8_t)((i * 31 + seed * 17 + (i >> 11)) & 0xff);
+    return data;
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+bool equals(const AsyncFileReader::Result& result, const std::vector<uint8_t>& data, size_t offset, size_t size)
+{
+    return result.success && result.size == size && std::memcmp(result.pData, data.data() + offset, size) == 0;
+}
+} // namespace
+
+CPU_TEST(AsyncFileReader_Read)
+{
+    // The large file spans several chunks of the io_uring backend.
+    const auto smallPath = getRuntimeDirectory() / "AsyncFileReader_small.bin";
+    const auto largePath = getRuntimeDirectory() / "AsyncFileReader_large.bin";
+    const auto smallData = createData(1000, 1);
+    const auto largeData = createData((5 << 20) + 123, 2);
+    writeFile(smallPath, smallData);
+    writeFile(largePath, largeData);
+
+    for (auto backend : kBackends)
+    {
+        AsyncFileReader reader(backend, 8, 2);
+        EXPECT(reader.getBackend() != AsyncFileReader::Backend::Auto);
+
+        // Whole files into pooled buffers.
+        {
+            auto result = reader.read({smallPath}).get();
+            EXPECT(equals(result, smallData, 0, smallData.size()));
+            EXPECT(result.pBuffer != nullptr);
+            EXPECT(equals(reader.read({largePath}).get(), largeData, 0, largeData.size()));
+        }
+
+        // Ranges, including a range extending past the end of the file.
+        {
+            EXPECT(equals(reader.read({largePath, 4096, 3 << 20}).get(), largeData, 4096, 3 << 20));
+            EXPECT(equals(reader.read({smallPath, 900, 500}).get(), smallData, 900, 100));
+            auto result = reader.read({smallPath, 2000, 10}).get();
+            EXPECT(result.success);
+            EXPECT_EQ(result.size, 0u);
+        }
+
+        // Caller-provided buffer.
+        {
+            std::vector<uint8_t> buffer(500);
+            auto result = reader.read({largePath, 100, buffer.size(), buffer.data()}).get();
+            EXPECT(equals(result, largeData, 100, buffer.size()));
+            EXPECT(result.pData == buffer.data());
+            EXPECT(result.pBuffer == nullptr);
+
+            // An explicit size is required.
+            EXPECT(!reader.read({largePath, 0, AsyncFileReader::kWholeFile, buffer.data()}).get().success);
+        }
+
+        // Missing file.
+        {
+            auto result = reader.read({getRuntimeDirectory() / "AsyncFileReader_missing.bin"}).get();
+            EXPECT(!result.success);
+            EXPECT(!result.error.empty());
+        }
+
+        // Batch with callbacks.
+        {
+            std::atomic<uint32_t> callbackCount{0};
+            auto callback = [&](const AsyncFileReader::Result& result)
+            {
+                if (result.success)
+                    callbackCount++;
+            };
+            std::vector<AsyncFileReader::Request> requests;
+            for (uint32_t i = 0; i < 32; i++)
+                requests.push_back({i % 2 ? largePath : smallPath, i * 10ull, 200, nullptr, callback});
+            auto futures = reader.readBatch(std::move(requests));
+            ASSERT_EQ(futures.size(), 32u);
+            for (uint32_t i = 0; i < 32; i++)
+                EXPECT(equals(futures[i].get(), i % 2 ? largeData : smallData, i * 10, 200)) << "i = " << i;
+            EXPECT_EQ(callbackCount.load(), 32u);
+        }
+
+        auto stats = reader.getStats();
+        EXPECT_EQ(stats.readCount, 40u);
+        EXPECT_EQ(stats.failedCount, 2u);
+    }
+
+    std::filesystem::remove(smallPath);
+    std::filesystem::remove(largePath);
+}
+
+CPU_TEST(AsyncFileReader_StreamBuf)
+{
+    const auto path = getRuntimeDirectory() / "AsyncFileReader_stream.bin";
+    const auto data = createData((3 << 20) + 321, 3);
+    writeFile(path, data);
+
+    for (auto backend : kBackends)
+    {
+        AsyncFileReader reader(backend, 8, 2);
+
+        // Read through an istream in odd sized pieces, with chunks that don't divide the file size.
+        {
+            AsyncFileStreamBuf buf(reader, path, (1 << 20) + 7, 2);
+            std::istream stream(&buf);
+            std::vector<uint8_t> result;
+            std::vector<char> piece(12345);
+            while (stream.read(piece.data(), piece.size()) || stream.gcount() > 0)
+                result.insert(result.end(), piece.begin(), piece.begin() + stream.gcount());
+            EXPECT(!buf.hasError());
+            EXPECT(result == data);
+        }
+
+        // The file was read in four chunks.
+        auto stats = reader.getStats();
+        EXPECT_EQ(stats.readCount, 4u);
+        EXPECT_EQ(stats.bytesRead, data.size());
+
+        // Missing file.
+        {
+            AsyncFileStreamBuf buf(reader, getRuntimeDirectory() / "AsyncFileReader_missing.bin");
+            std::istream stream(&buf);
+            EXPECT(buf.hasError());
+            EXPECT(stream.get() == std::istream::traits_type::eof());
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(AsyncFileReader_Throughput, TAGS("benchmark"))
+{
+    // Note: Files are read from the page cache unless caches are dropped between runs.
+    struct FileSet
+    {
+        const char* name;
+        size_t fileSize;
+        uint32_t fileCount;
+    };
+    const FileSet fileSets[] = {{"small", 16 << 10, 2048}, {"large", 32 << 20, 16}};
+
+    for (const auto& fileSet : fileSets)
+    {
+        std::vector<std::filesystem::path> paths;
+        const auto data = createData(fileSet.fileSize, 0);
+        for (uint32_t i = 0; i < fileSet.fileCount; i++)
+        {
+            paths.push_back(getRuntimeDirectory() / fmt::format("AsyncFileReader_bench_{}_{}.bin", fileSet.name, i));
+            writeFile(paths.back(), data);
+        }
+        const double totalMB = fileSet.fileSize * (double)fileSet.fileCount / (1 << 20);
+
+        // Baseline: blocking reads into a new buffer per file, one file after the other.
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (const auto& path : paths)
+            {
+                std::ifstream ifs(path, std::ios::binary);
+                std::vector<uint8_t> buffer(std::filesystem::file_size(path));
+                ifs.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+            }
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            logInfo("AsyncFileReader: {} x {} KB, sequential: {:.1f} MB/s", fileSet.fileCount, fileSet.fileSize >> 10, totalMB * 1000.0 / duration);
+        }
+
+        for (auto backend : kBackends)
+        {
+            AsyncFileReader reader(backend, 64, 8);
+            auto start = CpuTimer::getCurrentTimePoint();
+            std::vector<AsyncFileReader::Request> requests;
+            for (const auto& path : paths)
+                requests.push_back({path});
+            for (auto& future : reader.readBatch(std::move(requests)))
+                EXPECT(equals(future.get(), data, 0, data.size()));
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            logInfo(
+                "AsyncFileReader: {} x {} KB, {}: {:.1f} MB/s", fileSet.fileCount, fileSet.fileSize >> 10,
+                reader.getBackend() == AsyncFileReader::Backend::IoUring ? "io_uring" : "thread pool", totalMB * 1000.0 / duration
+            );
+        }
+
+        for (const auto& path : paths)
+            std::filesystem::remove(path);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,163 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/BenchmarkStatistics.h"
+#include "Core/Platform/OS.h"
+
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<float> generateSamples(std::mt19937& rng, size_t count, float mean, float stdDev)
+{
+    std::normal_distribution<float> dist(mean, stdDev);
+    std::vector<float> samples(count);
+    for (auto& s : samples)
+        s = dist(rng);
+    return samples;
+}
+} // namespace
+
+CPU_TEST(BenchmarkStatistics_MedianMAD)
+{
+    EXPECT_EQ(BenchmarkStatistics::computeMedian({}), 0.0);
+    EXPECT_EQ(BenchmarkStatistics::computeMedian({3.0, 1.0, 2.0}), 2.0);
+    EXPECT_EQ(BenchmarkStatistics::computeMedian({4.0, 1.0, 3.0, 2.0}), 2.5);
+    EXPECT_EQ(BenchmarkStatistics::computeMAD({1.0, 1.0, 2.0, 2.0, 4.0, 6.0, 9.0}, 2.0), 1.0);
+}
+
+CPU_TEST(BenchmarkStatistics_Warmup)
+{
+    std::mt19937 rng(1);
+
+    // Stable sequence has no warm-up.
+    std::vector<float> samples = generateSamples(rng, 200, 1.f, 0.01f);
+    EXPECT_EQ(BenchmarkStatistics::detectWarmup(samples), 0u);
+
+    // Slow first frames decaying to the steady state.
+    for (size_t i = 0; i < 30; ++i)
+        samples[i] = 1.f + 5.f * std::exp(-0.15f * i);
+    size_t warmup = BenchmarkStatistics::detectWarmup(samples);
+    EXPECT_GE(warmup, 15u);
+    EXPECT_LE(warmup, 30u);
+
+    // Too few samples to detect anything.
+    EXPECT_EQ(BenchmarkStatistics::detectWarmup(std::vector<float>(10, 1.f)), 0u);
+}
+
+CPU_TEST(BenchmarkStatistics_Outliers)
+{
+    std::mt19937 rng(2);
+    std::vector<float> samples = generateSamples(rng, 500, 2.f, 0.05f);
+    samples[100] = 20.f;
+    samples[200] = 15.f;
+    samples[300] = 0.01f;
+
+    size_t outlierCount = 0;
+    std::vector<double> values = BenchmarkStatistics::preprocess(samples, {}, nullptr, &outlierCount);
+    EXPECT_GE(outlierCount, 3u);
+    EXPECT_LE(outlierCount, 10u);
+    for (double v : values)
+        EXPECT(v > 1.5 && v < 2.5) << v;
+
+    // Identical samples are never outliers.
+    BenchmarkStatistics::Summary summary = BenchmarkStatistics::summarize(std::vector<float>(100, 1.f));
+    EXPECT_EQ(summary.outlierCount, 0u);
+    EXPECT_EQ(summary.median, 1.0);
+    EXPECT_EQ(summary.ciLower, 1.0);
+    EXPECT_EQ(summary.ciUpper, 1.0);
+}
+
+CPU_TEST(BenchmarkStatistics_ConfidenceInterval)
+{
+    // The 95% interval of the median should contain the true median in most trials.
+    std::mt19937 rng(3);
+    BenchmarkStatistics::Options options;
+    options.bootstrapIterations = 500;
+    uint32_t covered = 0;
+    const uint32_t trialCount = 50;
+    for (uint32_t trial = 0; trial < trialCount; ++trial)
+    {
+        options.seed = trial;
+        BenchmarkStatistics::Summary summary = BenchmarkStatistics::summarize(generateSamples(rng, 200, 5.f, 0.5f), options);
+        EXPECT_LE(summary.ciLower, summary.median);
+        EXPECT_GE(summary.ciUpper, summary.median);
+        if (summary.ciLower <= 5.0 && summary.ciUpper >= 5.0)
+            covered++;
+    }
+    EXPECT_GE(covered, 40u);
+}
+
+CPU_TEST(BenchmarkStatistics_Compare)
+{
+    std::mt19937 rng(4);
+    std::vector<float> baseline = generateSamples(rng, 300, 4.f, 0.2f);
+
+    auto same = BenchmarkStatistics::compare(baseline, generateSamples(rng, 300, 4.f, 0.2f));
+    EXPECT(same.verdict == BenchmarkStatistics::Verdict::Unchanged);
+    EXPECT_LE(same.ciLower, 0.0);
+    EXPECT_GE(same.ciUpper, 0.0);
+
+    auto slower = BenchmarkStatistics::compare(baseline, generateSamples(rng, 300, 4.4f, 0.2f));
+    EXPECT(slower.verdict == BenchmarkStatistics::Verdict::Regression);
+    EXPECT(std::abs(slower.relativeChange - 0.1) < 0.02) << slower.relativeChange;
+
+    auto faster = BenchmarkStatistics::compare(baseline, generateSamples(rng, 300, 3.6f, 0.2f));
+    EXPECT(faster.verdict == BenchmarkStatistics::Verdict::Improvement);
+
+    // Significant but below the minimum relative change.
+    BenchmarkStatistics::Options options;
+    options.minRelativeChange = 0.2;
+    EXPECT(BenchmarkStatistics::compare(baseline, generateSamples(rng, 300, 4.4f, 0.2f), options).verdict == BenchmarkStatistics::Verdict::Unchanged);
+}
+
+CPU_TEST(BenchmarkStatistics_Run)
+{
+    std::mt19937 rng(5);
+    BenchmarkStatistics::Run run;
+    run.metadata["scene"] = "test.pyscene";
+    run.metadata["resolution"] = "1920x1080";
+    run.samples["/onFrameRender/RenderGraphExe::execute()/VBufferRT"] = generateSamples(rng, 100, 1.f, 0.1f);
+    run.samples["/onFrameRender/RenderGraphExe::execute()/DitherVBuffer"] = generateSamples(rng, 100, 0.8f, 0.1f);
+
+    std::filesystem::path path = getRuntimeDirectory() / "BenchmarkStatistics_Run.json";
+    run.writeToFile(path);
+    BenchmarkStatistics::Run loaded = BenchmarkStatistics::Run::readFromFile(path);
+    std::filesystem::remove(path);
+
+    EXPECT(loaded.metadata == run.metadata);
+    EXPECT(loaded.samples == run.samples);
+
+    auto comparisons = BenchmarkStatistics::compare(run, loaded);
+    ASSERT_EQ(comparisons.size(), 2u);
+    for (const auto& comparison : comparisons)
+        EXPECT(comparison.verdict == BenchmarkStatistics::Verdict::Unchanged) << comparison.name;
+}
+} // namespace Falcor
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/BufferAllocator.h"
+#include <random>
+#include <vector>
 
 namespace Falcor
 {
@@ -317,4 +319,143 @@ GPU_TEST(BufferAllocatorStructAlign)
     }
 }
 
+CPU_TEST(BufferAllocatorDirtyRanges)
+{
+    using Range = BufferAllocator::DirtyRanges::Range;
+
+    // Without threshold only overlapping and adjacent ranges are merged.
+    {
+        BufferAllocator::DirtyRanges ranges;
+        EXPECT(ranges.empty());
+
+        ranges.add(8, 12);
+        ranges.add(20, 24);
+        ranges.add(0, 4);
+        ranges.add(30, 30); // Empty ranges are ignored.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 4}, {8, 12}, {20, 24}}));
+        EXPECT_EQ(ranges.getByteCount(), 12);
+
+        ranges.add(4, 8); // Adjacent on both sides.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 12}, {20, 24}}));
+
+        ranges.add(10, 21); // Overlapping on both sides.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 24}}));
+
+        ranges.add(2, 6); // Contained.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 24}}));
+
+        ranges.clear();
+        EXPECT(ranges.empty());
+        EXPECT_EQ(ranges.getByteCount(), 0);
+    }
+
+    // Ranges separated by at most the threshold are merged.
+    {
+        BufferAllocator::DirtyRanges ranges(16);
+        ranges.add(0, 4);
+        ranges.add(20, 24); // Gap of 16 bytes.
+        ranges.add(41, 48); // Gap of 17 bytes.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 24}, {41, 48}}));
+
+        ranges.add(100, 104);
+        ranges.add(64, 80); // Merges with the range before but not the one after.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 24}, {41, 80}, {100, 104}}));
+
+        ranges.add(30, 90); // Bridges all but the first range.
+        EXPECT(ranges.getRanges() == std::vector<Range>({{0, 104}}));
+    }
+}
+
+CPU_TEST(BufferAllocatorDirtyRangesRandom)
+{
+    // Compare against a reference that marks individual bytes and merges the runs of marked bytes afterwards.
+    const size_t kSize = 4096;
+    std::mt19937 rng(1);
+
+    for (size_t threshold : {0, 1, 7, 64})
+    {
+        for (uint32_t iteration = 0; iteration < 50; ++iteration)
+        {
+            BufferAllocator::DirtyRanges ranges(threshold);
+            std::vector<bool> marked(kSize, false);
+
+            uint32_t count = std::uniform_int_distribution<uint32_t>(1, 40)(rng);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                size_t start = std::uniform_int_distribution<size_t>(0, kSize - 1)(rng);
+                size_t end = std::min(kSize, start + std::uniform_int_distribution<size_t>(1, 64)(rng));
+                ranges.add(start, end);
+                std::fill(marked.begin() + start, marked.begin() + end, true);
+            }
+
+            std::vector<BufferAllocator::DirtyRanges::Range> expected;
+            for (size_t i = 0; i < kSize;)
+            {
+                if (!marked[i])
+                {
+                    i++;
+                    continue;
+                }
+                size_t start = i;
+                while (i < kSize && marked[i])
+                    i++;
+                if (!expected.empty() && start - expected.back().end <= threshold)
+                    expected.back().end = i;
+                else
+                    expected.push_back({start, i});
+            }
+
+            EXPECT(ranges.getRanges() == expected) << "threshold=" << threshold << " iteration=" << iteration;
+        }
+    }
+}
+
+GPU_TEST(BufferAllocatorSparseUpload)
+{
+    // Scattered modifications should only upload the modified ranges.
+    const size_t kCount = 256 * 1024;
+    BufferAllocator buf(0, sizeof(float), 0);
+    size_t offset = buf.allocate<float>(kCount);
+    EXPECT_EQ(offset, 0);
+
+    std::vector<float> data(kCount);
+    for (size_t i = 0; i < kCount; i++)
+        data[i] = (float)i;
+    buf.setBlob(data.data(), 0, kCount * sizeof(float));
+
+    ref<Buffer> pBuffer = buf.getGPUBuffer(ctx.getDevice());
+    EXPECT_EQ(buf.getUploadStats().uploadCount, 1);
+    EXPECT_EQ(buf.getUploadStats().uploadedBytes, kCount * sizeof(float));
+    EXPECT(buf.getDirtyRanges().empty());
+
+    buf.resetUploadStats();
+    buf.set<float>(0, -1.f);
+    buf.set<float>(4, -2.f);
+    buf.set<float>((kCount - 1) * sizeof(float), -3.f);
+    pBuffer = buf.getGPUBuffer(ctx.getDevice());
+    EXPECT_EQ(buf.getUploadStats().uploadCount, 2);
+    EXPECT_EQ(buf.getUploadStats().uploadedBytes, 3 * sizeof(float));
+
+    // Disable merging of ranges with gaps.
+    buf.resetUploadStats();
+    buf.setMergeThreshold(0);
+    buf.set<float>(100 * sizeof(float), -4.f);
+    buf.set<float>(102 * sizeof(float), -5.f);
+    pBuffer = buf.getGPUBuffer(ctx.getDevice());
+    EXPECT_EQ(buf.getUploadStats().uploadCount, 2);
+    EXPECT_EQ(buf.getUploadStats().uploadedBytes, 2 * sizeof(float));
+
+    const float* ref = reinterpret_cast<const float*>(buf.getStartPointer());
+    const float* ptr = reinterpret_cast<const float*>(pBuffer->map(Buffer::MapType::Read));
+    for (size_t i = 0; i < kCount; i++)
+    {
+        if (ptr[i] != ref[i])
+        {
+            EXPECT_EQ(ptr[i], ref[i]) << "i=" << i;
+            break;
+        }
+    }
+    pBuffer->unmap();
+}
+
 } // namespace Falcor
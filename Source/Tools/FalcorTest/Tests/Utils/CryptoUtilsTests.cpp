@@ -27,7 +27,10 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/CryptoUtils.h"
+#include <algorithm>
 #include <random>
+#include <string>
+#include <vector>
 
 namespace Falcor
 {
@@ -59,4 +62,52 @@ CPU_TEST(SHA1)
         EXPECT(SHA1::compute(str.data(), str.size()) == md);
     }
 }
+
+CPU_TEST(SHA1_TestVectors)
+{
+    // FIPS 180-2 test vectors.
+    EXPECT_EQ(SHA1::toString(SHA1::compute("", 0)), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    EXPECT_EQ(SHA1::toString(SHA1::compute("abc", 3)), "a9993e364706816aba3e25717850c26c9cd0d89d");
+
+    std::string str{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+    EXPECT_EQ(SHA1::toString(SHA1::compute(str.data(), str.size())), "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+
+    std::string million(1000000, 'a');
+    EXPECT_EQ(SHA1::toString(SHA1::compute(million.data(), million.size())), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+    // Padding boundaries: the length field fits into the last block for 55 bytes but not for 56 bytes.
+    std::string str55(55, 'a');
+    std::string str56(56, 'a');
+    std::string str64(64, 'a');
+    EXPECT_EQ(SHA1::toString(SHA1::compute(str55.data(), str55.size())), "c1c8bbdc22796e28c0e15163d20899b65621d65a");
+    EXPECT_EQ(SHA1::toString(SHA1::compute(str56.data(), str56.size())), "c2db330f6083854c99d4b5bfb6e8f29f201be699");
+    EXPECT_EQ(SHA1::toString(SHA1::compute(str64.data(), str64.size())), "0098ba824b5c16427bd7a1122a5a442a25ec644d");
+}
+
+CPU_TEST(SHA1_Streaming)
+{
+    std::mt19937 rng(1);
+    std::vector<uint8_t> data(10000);
+    for (auto& v : data)
+        v = (uint8_t)rng();
+
+    // Hashing in pieces of any size must give the same digest as hashing in one go.
+    for (size_t len : {0, 1, 63, 64, 65, 127, 128, 1000, 10000})
+    {
+        const SHA1::MD expected = SHA1::compute(data.data(), len);
+        for (size_t chunkSize : {1, 3, 17, 64, 100})
+        {
+            SHA1 sha1;
+            for (size_t offset = 0; offset < len; offset += chunkSize)
+            {
+                size_t count = std::min(chunkSize, len - offset);
+                if (count == 1)
+                    sha1.update(data[offset]);
+                else
+                    sha1.update(data.data() + offset, count);
+            }
+            EXPECT(sha1.finalize() == expected) << "len=" << len << " chunkSize=" << chunkSize;
+        }
+    }
+}
 } // namespace Falcor
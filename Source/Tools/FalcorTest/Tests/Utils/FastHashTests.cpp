@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/FastHash.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<uint8_t> createTestData(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = (uint8_t)(i * 31 + (i >> 8));
+    return data;
+}
+
+// Reference values computed with XXH3_64bits_withSeed / XXH3_128bits_withSeed from xxHash 0.8.
+struct TestVector
+{
+    size_t len;
+    uint64_t seed;
+    uint64_t hash64;
+    Hash128 hash128;
+};
+
+// clang-format off
+const TestVector kTestVectors[] = {
+    {0, 0x0ull, 0x2d06800538d394c2ull, {0x6001c324468d497full, 0x99aa06d3014798d8ull}},
+    {1, 0x0ull, 0xc44bdff4074eecdbull, {0xc44bdff4074eecdbull, 0xa6cd5e9392000f6aull}},
+    {3, 0x0ull, 0x3698b80191e625f9ull, {0x3698b80191e625f9ull, 0x4af3603b5bd30dfeull}},
+    {4, 0x0ull, 0x2e4ac2f1c52157fcull, {0xeecdfa5a3b083ba8ull, 0x11527735d62fce43ull}},
+    {8, 0x0ull, 0x60e1baa91347a1f2ull, {0x073a25812fe4f600ull, 0x791e22cdc30880baull}},
+    {9, 0x0ull, 0x9c88fc32c37b56cbull, {0x4557529981ebbef0ull, 0x22775b5e55c2ace9ull}},
+    {16, 0x0ull, 0xf9fbd0260ba978dfull, {0x843f49fff931d541ull, 0x8d0b1cd2088b9620ull}},
+    {17, 0x0ull, 0xc56f339d36cc73d7ull, {0xa378e80882221151ull, 0x340f6f9202ad1131ull}},
+    {128, 0x0ull, 0x31ccf8dec850d035ull, {0xffb5b9abed8b314dull, 0x9ac3a2d505dc8bbaull}},
+    {129, 0x0ull, 0xc72af4c6ac4dea94ull, {0xc83022477e6bf25aull, 0x4f3f783d604d0184ull}},
+    {240, 0x0ull, 0xe315d53d5129eedeull, {0xc018ce69a32b5a7cull, 0x550b8ce07c44bc98ull}},
+    {241, 0x0ull, 0x18773c512b008a63ull, {0x18773c512b008a63ull, 0x8e7e1f2fe4156df9ull}},
+    {1024, 0x0ull, 0x5a1893edffa2577cull, {0x5a1893edffa2577cull, 0xea65234127f4dd7bull}},
+    {1025, 0x0ull, 0x550abe5d45dd663bull, {0x550abe5d45dd663bull, 0x0fabde917fb0af22ull}},
+    {4096, 0x0ull, 0xbe855965eae8486bull, {0xbe855965eae8486bull, 0xd993a1ab1ec875a6ull}},
+    {100000, 0x0ull, 0x99dbd27fc89c5372ull, {0x99dbd27fc89c5372ull, 0x1ceab015e15e2ba1ull}},
+    {0, 0x123456789abcdef0ull, 0x8aa56c2c3d8317f6ull, {0xb950a1d9e9a4a947ull, 0xe7da00845366b2f3ull}},
+    {1, 0x123456789abcdef0ull, 0x6610ea1e2f5010b7ull, {0x6610ea1e2f5010b7ull, 0xd872f0c45e73d139ull}},
+    {3, 0x123456789abcdef0ull, 0xf4a991f03e8a44d8ull, {0xf4a991f03e8a44d8ull, 0xe13614573eeb10a9ull}},
+    {4, 0x123456789abcdef0ull, 0x337033bbcefc1034ull, {0x77bec860024f7c1cull, 0x3200f11d5a653a80ull}},
+    {8, 0x123456789abcdef0ull, 0xc5707ca003370001ull, {0xf6048e9639820289ull, 0x2241a99c7a867434ull}},
+    {9, 0x123456789abcdef0ull, 0xfba73309e01778b3ull, {0xed7670a25908cfdbull, 0xcd2005b232457cbdull}},
+    {16, 0x123456789abcdef0ull, 0xafeb18ffd05ec86cull, {0x752b1cdb55922d42ull, 0x97648996bce2caa6ull}},
+    {17, 0x123456789abcdef0ull, 0x6606e2ad60c1f492ull, {0x45404a8d14582b4aull, 0x989a013bfced6ca2ull}},
+    {128, 0x123456789abcdef0ull, 0x21e952caa713fb6dull, {0x44928025f9749696ull, 0x0b104a4a94c4888full}},
+    {129, 0x123456789abcdef0ull, 0x1db8b46915ad6bf8ull, {0xd3f4977c9c8b09ddull, 0x6fdb4d1022681488ull}},
+    {240, 0x123456789abcdef0ull, 0x2f47e0600088426full, {0x7daf7b618f5682e6ull, 0xb3fcaccebc7b5313ull}},
+    {241, 0x123456789abcdef0ull, 0x839e5430443727daull, {0x839e5430443727daull, 0x9585cb7dbac72745ull}},
+    {1024, 0x123456789abcdef0ull, 0xdc5c258b04d6a425ull, {0xdc5c258b04d6a425ull, 0x5054b5d8920f4cf7ull}},
+    {1025, 0x123456789abcdef0ull, 0x7b7c8296ee0685c1ull, {0x7b7c8296ee0685c1ull, 0x974b8a1ff67544ffull}},
+    {4096, 0x123456789abcdef0ull, 0x919d1c4dc26cd04dull, {0x919d1c4dc26cd04dull, 0x21c885395650b45bull}},
+    {100000, 0x123456789abcdef0ull, 0x572cfa0f12c68f17ull, {0x572cfa0f12c68f17ull, 0xae48390c2c0ad358ull}},
+};
+// clang-format on
+} // namespace
+
+CPU_TEST(FastHash_TestVectors)
+{
+    const std::vector<uint8_t> data = createTestData(100000);
+
+    for (const auto& v : kTestVectors)
+    {
+        EXPECT_EQ(FastHash::hash64(data.data(), v.len, v.seed), v.hash64) << "len=" << v.len << " seed=" << v.seed;
+        EXPECT(FastHash::hash128(data.data(), v.len, v.seed) == v.hash128) << "len=" << v.len << " seed=" << v.seed;
+    }
+
+    EXPECT_EQ(FastHash::toString(kTestVectors[0].hash128), "99aa06d3014798d86001c324468d497f");
+}
+
+CPU_TEST(FastHash_Streaming)
+{
+    const std::vector<uint8_t> data = createTestData(100000);
+    std::mt19937 rng(1);
+
+    // Random chunk sizes exercise the internal buffering, block boundaries and the last stripe handling.
+    for (const auto& v : kTestVectors)
+    {
+        for (size_t maxChunkSize : {1, 7, 64, 300, 5000})
+        {
+            FastHash hash(v.seed);
+            for (size_t offset = 0; offset < v.len;)
+            {
+                size_t count = std::min<size_t>(v.len - offset, 1 + rng() % maxChunkSize);
+                hash.update(data.data() + offset, count);
+                offset += count;
+            }
+            EXPECT_EQ(hash.digest64(), v.hash64) << "len=" << v.len << " maxChunkSize=" << maxChunkSize;
+            EXPECT(hash.digest128() == v.hash128) << "len=" << v.len << " maxChunkSize=" << maxChunkSize;
+        }
+    }
+
+    // Digest does not modify the state.
+    FastHash hash;
+    hash.update(data.data(), 1000);
+    uint64_t first = hash.digest64();
+    EXPECT_EQ(hash.digest64(), first);
+    hash.update(data.data() + 1000, 3096);
+    EXPECT_EQ(hash.digest64(), kTestVectors[14].hash64);
+
+    hash.reset();
+    EXPECT_EQ(hash.digest64(), kTestVectors[0].hash64);
+}
+
+CPU_TEST(FastHash_Benchmark, TAGS("benchmark"))
+{
+    // Hash a cache-resident buffer repeatedly and a large buffer once.
+    for (size_t size : {size_t(64) << 10, size_t(256) << 20})
+    {
+        const std::vector<uint8_t> data = createTestData(size);
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 30) / size);
+
+        auto measure = [&](const char* name, auto func)
+        {
+            const uint64_t expected = func();
+            uint64_t result = 0;
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (size_t i = 0; i < iterations; i++)
+                result += func();
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            EXPECT_EQ(result, expected * iterations) << name;
+            double gbPerSecond = double(size) * iterations / (duration * 1e-3) / 1e9;
+            logInfo("{}: {} kB buffer, {:.2f} GB/s (result {:x})", name, size >> 10, gbPerSecond, result);
+        };
+
+        measure("SHA1", [&]() { return (uint64_t)SHA1::compute(data.data(), data.size())[0]; });
+        measure("FastHash 64-bit", [&]() { return FastHash::hash64(data.data(), data.size()); });
+        measure("FastHash 128-bit", [&]() { return FastHash::hash128(data.data(), data.size()).low; });
+    }
+}
+} // namespace Falcor
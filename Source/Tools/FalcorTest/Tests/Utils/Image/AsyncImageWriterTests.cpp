@@ -0,0 +1,194 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncImageWriter.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Core/Platform/OS.h"
+
+namespace Falcor
+{
+namespace
+{
+std::vector<uint8_t> createRgba8(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::vector<uint8_t> data(width * height * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)((i * 7 + seed * 13) & 0xff);
+    return data;
+}
+
+std::vector<uint8_t> createRgba32Float(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::vector<uint8_t> data(width * height * 4 * sizeof(float));
+    float* pData = reinterpret_cast<float*>(data.data());
+    for (size_t i = 0; i < width * height * 4; i++)
+        pData[i] = (float)((i + seed) % 97) / 16.f;
+    return data;
+}
+} // namespace
+
+CPU_TEST(AsyncImageWriter_WriteAndFlush)
+{
+    const uint32_t width = 32;
+    const uint32_t height = 16;
+    const uint32_t imageCount = 12;
+
+    std::vector<std::filesystem::path> paths;
+    {
+        AsyncImageWriter writer(3, 2);
+        EXPECT_EQ(writer.getWorkerCount(), 3u);
+        EXPECT_EQ(writer.getMaxQueuedImages(), 2u);
+
+        for (uint32_t i = 0; i < imageCount; i++)
+        {
+            bool exr = (i % 2) == 1;
+            auto path = getRuntimeDirectory() / fmt::format("AsyncImageWriter_{}.{}", i, exr ? "exr" : "png");
+            auto data = exr ? createRgba32Float(width, height, i) : createRgba8(width, height, i);
+            writer.write(
+                path, width, height, exr ? Bitmap::FileFormat::ExrFile : Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha,
+                exr ? ResourceFormat::RGBA32Float : ResourceFormat::RGBA8Unorm, true, std::move(data)
+            );
+            // The queue is bounded, so at most one image per worker plus the queued ones can be pending.
+            EXPECT_LE(writer.getPendingCount(), 3u + 2u);
+            paths.push_back(path);
+        }
+
+        writer.flush();
+        EXPECT_EQ(writer.getPendingCount(), 0u);
+
+        auto stats = writer.getStats();
+        EXPECT_EQ(stats.imagesWritten, (uint64_t)imageCount);
+        EXPECT_EQ(stats.imagesFailed, 0u);
+        EXPECT_GT(stats.getImagesPerSecond(), 0.0);
+    }
+
+    // Read back the images and compare against the source data.
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        auto bmp = Bitmap::createFromFile(paths[i], true);
+        ASSERT(bmp != nullptr);
+        EXPECT_EQ(bmp->getWidth(), width);
+        EXPECT_EQ(bmp->getHeight(), height);
+
+        if ((i % 2) == 1)
+        {
+            ASSERT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::RGBA32Float);
+            auto expected = createRgba32Float(width, height, i);
+            EXPECT(std::memcmp(bmp->getData(), expected.data(), expected.size()) == 0) << paths[i];
+        }
+        else
+        {
+            // PNG files are loaded as BGRA.
+            ASSERT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::BGRA8Unorm);
+            auto expected = createRgba8(width, height, i);
+            const uint8_t* pData = bmp->getData();
+            bool match = true;
+            for (uint32_t p = 0; p < width * height; p++)
+            {
+                match &= pData[4 * p + 0] == expected[4 * p + 2];
+                match &= pData[4 * p + 1] == expected[4 * p + 1];
+                match &= pData[4 * p + 2] == expected[4 * p + 0];
+                match &= pData[4 * p + 3] == expected[4 * p + 3];
+            }
+            EXPECT(match) << paths[i];
+        }
+
+        std::filesystem::remove(paths[i]);
+    }
+}
+
+CPU_TEST(AsyncImageWriter_FlushOnDestruction)
+{
+    const auto path = getRuntimeDirectory() / "AsyncImageWriter_destruction.png";
+    {
+        AsyncImageWriter writer(1, 1);
+        writer.write(
+            path, 64, 64, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, true, createRgba8(64, 64, 0)
+        );
+    }
+    EXPECT(std::filesystem::exists(path));
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(AsyncImageWriter_Failure)
+{
+    AsyncImageWriter writer(1, 1);
+    writer.write(
+        getRuntimeDirectory() / "does_not_exist" / "AsyncImageWriter.png", 4, 4, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None,
+        ResourceFormat::RGBA8Unorm, true, createRgba8(4, 4, 0)
+    );
+    writer.flush();
+
+    auto stats = writer.getStats();
+    EXPECT_EQ(stats.imagesWritten, 0u);
+    EXPECT_EQ(stats.imagesFailed, 1u);
+}
+
+CPU_TEST(AsyncImageWriter_Throughput, TAGS("benchmark"))
+{
+    const uint32_t width = 1920;
+    const uint32_t height = 1080;
+    const uint32_t imageCount = 32;
+
+    for (bool exr : {true, false})
+    {
+        for (uint32_t threadCount : {1u, 4u, 8u})
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            {
+                AsyncImageWriter writer(threadCount, 2 * threadCount);
+                for (uint32_t i = 0; i < imageCount; i++)
+                {
+                    auto path = getRuntimeDirectory() / fmt::format("AsyncImageWriter_bench_{}.{}", i, exr ? "exr" : "png");
+                    auto data = exr ? createRgba32Float(width, height, i) : createRgba8(width, height, i);
+                    writer.write(
+                        path, width, height, exr ? Bitmap::FileFormat::ExrFile : Bitmap::FileFormat::PngFile,
+                        Bitmap::ExportFlags::ExportAlpha, exr ? ResourceFormat::RGBA32Float : ResourceFormat::RGBA8Unorm, true,
+                        std::move(data)
+                    );
+                }
+                writer.flush();
+                EXPECT_EQ(writer.getStats().imagesWritten, (uint64_t)imageCount);
+                for (uint32_t i = 0; i < imageCount; i++)
+                    EXPECT(std::filesystem::exists(getRuntimeDirectory() / fmt::format("AsyncImageWriter_bench_{}.{}", i, exr ? "exr" : "png")));
+            }
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            logInfo(
+                "AsyncImageWriter: {} {}x{}, {} threads: {:.1f} images/s", exr ? "EXR" : "PNG", width, height, threadCount,
+                imageCount * 1000.0 / duration
+            );
+        }
+    }
+
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        std::filesystem::remove(getRuntimeDirectory() / fmt::format("AsyncImageWriter_bench_{}.exr", i));
+        std::filesystem::remove(getRuntimeDirectory() / fmt::format("AsyncImageWriter_bench_{}.png", i));
+    }
+}
+} // namespace Falcor
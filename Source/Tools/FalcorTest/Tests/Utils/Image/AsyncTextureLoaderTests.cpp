@@ -0,0 +1,229 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncTextureLoader.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path getTexturePath()
+{
+    return getRuntimeDirectory() / "data/tests/tiny_mip0.png";
+}
+
+/// Helper to hold the worker thread of a single-threaded loader inside a load callback.
+struct WorkerBlocker
+{
+    std::promise<void> entered;
+    std::promise<void> release;
+
+    AsyncTextureLoader::LoadCallback getCallback()
+    {
+        return [this, released = release.get_future().share()](ref<Texture>)
+        {
+            entered.set_value();
+            released.wait();
+        };
+    }
+};
+} // namespace
+
+GPU_TEST(AsyncTextureLoader_Priority)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const std::filesystem::path texturePath = getTexturePath();
+    AsyncTextureLoader loader(pDevice, 1);
+
+    // Occupy the worker with a request until all other requests are queued.
+    WorkerBlocker blocker;
+    auto blockerRequest = loader.loadFromFile(texturePath, false, false, ResourceBindFlags::ShaderResource, blocker.getCallback());
+    blocker.entered.get_future().wait();
+
+    // Queue requests with shuffled priorities and record the order in which they complete.
+    const uint32_t kRequestCount = 32;
+    std::vector<uint32_t> priorities(kRequestCount);
+    for (uint32_t i = 0; i < kRequestCount; ++i)
+        priorities[i] = i;
+    std::shuffle(priorities.begin(), priorities.end(), std::mt19937(1));
+
+    std::mutex orderMutex;
+    std::vector<uint32_t> order;
+    std::vector<AsyncTextureLoader::Request> requests;
+    for (uint32_t i = 0; i < kRequestCount; ++i)
+    {
+        AsyncTextureLoader::LoadOptions options;
+        options.priority = (float)priorities[i];
+        auto callback = [&, i](ref<Texture>)
+        {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(i);
+        };
+        requests.push_back(loader.loadFromFile(texturePath, false, false, ResourceBindFlags::ShaderResource, callback, options));
+    }
+
+    // Move the lowest priority request to the front and the highest priority request to the back.
+    const uint32_t lowest = (uint32_t)std::distance(priorities.begin(), std::find(priorities.begin(), priorities.end(), 0));
+    const uint32_t highest = (uint32_t)std::distance(priorities.begin(), std::find(priorities.begin(), priorities.end(), kRequestCount - 1));
+    EXPECT(loader.setPriority(requests[lowest].id, 1000.f));
+    EXPECT(loader.setPriority(requests[highest].id, -1.f));
+    priorities[lowest] = 1000;
+    EXPECT(!loader.setPriority(AsyncTextureLoader::kInvalidRequestID, 0.f));
+
+    EXPECT_EQ(loader.getStats().queuedCount, kRequestCount);
+
+    blocker.release.set_value();
+    EXPECT(blockerRequest.future.get() != nullptr);
+    for (auto& request : requests)
+        EXPECT(request.future.get() != nullptr);
+
+    // Requests complete in order of descending priority.
+    ASSERT_EQ(order.size(), kRequestCount);
+    EXPECT_EQ(order.front(), lowest);
+    EXPECT_EQ(order.back(), highest);
+    for (uint32_t i = 1; i + 1 < kRequestCount; ++i)
+        EXPECT_GT(priorities[order[i - 1]], priorities[order[i]]) << "i = " << i;
+
+    auto stats = loader.getStats();
+    EXPECT_EQ(stats.completedCount, kRequestCount + 1);
+    EXPECT_EQ(stats.cancelledCount, 0u);
+    EXPECT_EQ(stats.queuedCount, 0u);
+}
+
+GPU_TEST(AsyncTextureLoader_Cancel)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const std::filesystem::path texturePath = getTexturePath();
+    AsyncTextureLoader loader(pDevice, 1);
+
+    WorkerBlocker blocker;
+    auto blockerRequest = loader.loadFromFile(texturePath, false, false, ResourceBindFlags::ShaderResource, blocker.getCallback());
+    blocker.entered.get_future().wait();
+
+    // Even requests share a cancellation token, request 1 is cancelled individually.
+    const uint32_t kRequestCount = 20;
+    auto pToken = std::make_shared<AsyncTextureLoader::CancellationToken>();
+    std::atomic<uint32_t> callbackCount{0};
+    std::atomic<uint32_t> nullCallbackCount{0};
+    std::vector<AsyncTextureLoader::Request> requests;
+    for (uint32_t i = 0; i < kRequestCount; ++i)
+    {
+        AsyncTextureLoader::LoadOptions options;
+        if (i % 2 == 0)
+            options.pCancellationToken = pToken;
+        auto callback = [&](ref<Texture> pTexture)
+        {
+            callbackCount++;
+            if (!pTexture)
+                nullCallbackCount++;
+        };
+        requests.push_back(loader.loadFromFile(texturePath, false, false, ResourceBindFlags::ShaderResource, callback, options));
+    }
+
+    pToken->cancel();
+    EXPECT(loader.cancel(requests[1].id));
+
+    // Individually cancelled requests are resolved right away.
+    EXPECT(requests[1].future.get() == nullptr);
+    EXPECT(!loader.cancel(requests[1].id));
+    EXPECT(!loader.setPriority(requests[1].id, 1.f));
+
+    blocker.release.set_value();
+    EXPECT(blockerRequest.future.get() != nullptr);
+    for (uint32_t i = 0; i < kRequestCount; ++i)
+    {
+        bool cancelled = i % 2 == 0 || i == 1;
+        if (i == 1)
+            continue;
+        EXPECT_EQ(requests[i].future.get() == nullptr, cancelled) << "i = " << i;
+    }
+
+    EXPECT_EQ(callbackCount.load(), kRequestCount);
+    EXPECT_EQ(nullCallbackCount.load(), kRequestCount / 2 + 1);
+
+    auto stats = loader.getStats();
+    EXPECT_EQ(stats.cancelledCount, kRequestCount / 2 + 1);
+    EXPECT_EQ(stats.completedCount, kRequestCount / 2);
+}
+
+GPU_TEST(AsyncTextureLoader_Stress)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const std::filesystem::path texturePath = getTexturePath();
+    AsyncTextureLoader loader(pDevice, 4);
+
+    const uint64_t kRequestCost = 1000;
+    loader.setMaxInFlightBytes(2 * kRequestCost);
+    EXPECT_EQ(loader.getMaxInFlightBytes(), 2 * kRequestCost);
+
+    // Issue requests while randomly reprioritizing and cancelling outstanding ones.
+    const uint32_t kRequestCount = 256;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> priorityDist(-100.f, 100.f);
+    auto pToken = std::make_shared<AsyncTextureLoader::CancellationToken>();
+    std::atomic<uint32_t> callbackCount{0};
+    std::vector<AsyncTextureLoader::Request> requests;
+    for (uint32_t i = 0; i < kRequestCount; ++i)
+    {
+        AsyncTextureLoader::LoadOptions options;
+        options.priority = priorityDist(rng);
+        options.memoryCost = kRequestCost;
+        if (i % 7 == 0)
+            options.pCancellationToken = pToken;
+        requests.push_back(loader.loadFromFile(
+            texturePath, false, false, ResourceBindFlags::ShaderResource, [&](ref<Texture>) { callbackCount++; }, options
+        ));
+
+        const auto& other = requests[rng() % requests.size()];
+        if (i % 3 == 0)
+            loader.setPriority(other.id, priorityDist(rng));
+        if (i % 11 == 0)
+            loader.cancel(other.id);
+        if (i == kRequestCount / 2)
+            pToken->cancel();
+    }
+
+    uint32_t loadedCount = 0;
+    for (auto& request : requests)
+        if (request.future.get() != nullptr)
+            loadedCount++;
+
+    EXPECT_EQ(callbackCount.load(), kRequestCount);
+
+    auto stats = loader.getStats();
+    EXPECT_EQ(stats.completedCount + stats.cancelledCount, kRequestCount);
+    EXPECT_EQ(stats.completedCount, loadedCount);
+    EXPECT_GT(stats.cancelledCount, 0u);
+    EXPECT_EQ(stats.queuedCount, 0u);
+    EXPECT_EQ(stats.inFlightCount, 0u);
+    EXPECT_EQ(stats.inFlightBytes, 0u);
+    EXPECT_LE(stats.peakInFlightBytes, 2 * kRequestCost);
+}
+} // namespace Falcor
@@ -0,0 +1,246 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ConvolutionInference.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstdlib>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using Tensor = ConvolutionInference::Tensor;
+using Layer = ConvolutionInference::Layer;
+
+Layer createLayer(std::mt19937& rng, uint32_t kernelSize, uint32_t channelsIn, uint32_t channelsOut, ConvolutionInference::Activation activation)
+{
+    std::uniform_real_distribution<float> dist(-0.2f, 0.2f);
+    Layer layer;
+    layer.kernelWidth = kernelSize;
+    layer.kernelHeight = kernelSize;
+    layer.channelsIn = channelsIn;
+    layer.channelsOut = channelsOut;
+    layer.activation = activation;
+    layer.weights.resize(kernelSize * kernelSize * channelsIn * channelsOut);
+    for (auto& w : layer.weights)
+        w = dist(rng);
+    layer.bias.resize(channelsOut);
+    for (auto& b : layer.bias)
+        b = dist(rng);
+    return layer;
+}
+
+Tensor createInput(std::mt19937& rng, uint32_t width, uint32_t height, uint32_t channels)
+{
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    Tensor tensor(width, height, channels);
+    for (auto& v : tensor.data)
+        v = dist(rng);
+    return tensor;
+}
+
+// Straightforward evaluation of a layer in double precision.
+Tensor convolveReference(const Layer& layer, const Tensor& input, const Tensor* pClampMin, const Tensor* pClampMax)
+{
+    Tensor output(input.width, input.height, layer.channelsOut);
+    for (int y = 0; y < (int)input.height; ++y)
+    {
+        for (int x = 0; x < (int)input.width; ++x)
+        {
+            for (uint32_t co = 0; co < layer.channelsOut; ++co)
+            {
+                double sum = layer.bias[co];
+                for (int ky = 0; ky < (int)layer.kernelHeight; ++ky)
+                {
+                    for (int kx = 0; kx < (int)layer.kernelWidth; ++kx)
+                    {
+                        int ix = x + kx - (int)layer.kernelWidth / 2;
+                        int iy = y + ky - (int)layer.kernelHeight / 2;
+                        if (ix < 0 || iy < 0 || ix >= (int)input.width || iy >= (int)input.height)
+                            continue;
+                        for (uint32_t ci = 0; ci < layer.channelsIn; ++ci)
+                            sum += input.at(ix, iy, ci) * layer.weights[((ky * layer.kernelWidth + kx) * layer.channelsIn + ci) * layer.channelsOut + co];
+                    }
+                }
+                float value = (float)sum;
+                if (layer.activation == ConvolutionInference::Activation::ReLU)
+                    value = std::max(value, 0.f);
+                else if (layer.activation == ConvolutionInference::Activation::Clamp)
+                    value = std::clamp(value, pClampMin->at(x, y, 0), pClampMax->at(x, y, 0));
+                output.at(x, y, co) = value;
+            }
+        }
+    }
+    return output;
+}
+} // namespace
+
+CPU_TEST(ConvolutionInference_MatchesReference)
+{
+    std::mt19937 rng(1);
+    const struct
+    {
+        uint32_t kernelSize, channelsIn, channelsOut;
+    } configs[] = {{1, 3, 1}, {3, 4, 16}, {3, 16, 33}, {5, 16, 13}, {1, 8, 76}};
+
+    for (const auto& config : configs)
+    {
+        ConvolutionInference net({createLayer(rng, config.kernelSize, config.channelsIn, config.channelsOut, ConvolutionInference::Activation::ReLU)});
+        Tensor input = createInput(rng, 37, 23, config.channelsIn);
+        Tensor reference = convolveReference(net.getLayers()[0], input, nullptr, nullptr);
+        Tensor direct = net.runLayer(0, input, ConvolutionInference::Algorithm::Direct);
+        Tensor gemm = net.runLayer(0, input, ConvolutionInference::Algorithm::Im2ColGemm);
+
+        ASSERT_EQ(direct.data.size(), reference.data.size());
+        ASSERT_EQ(gemm.data.size(), reference.data.size());
+        for (size_t i = 0; i < reference.data.size(); ++i)
+        {
+            EXPECT_LE(std::abs(direct.data[i] - reference.data[i]), 1e-5f) << "value " << i;
+            // Both algorithms accumulate in the same order.
+            EXPECT_EQ(direct.data[i], gemm.data[i]) << "value " << i;
+        }
+    }
+}
+
+CPU_TEST(ConvolutionInference_Network)
+{
+    std::mt19937 rng(2);
+    ConvolutionInference net({
+        createLayer(rng, 3, 4, 8, ConvolutionInference::Activation::ReLU),
+        createLayer(rng, 3, 8, 8, ConvolutionInference::Activation::ReLU),
+        createLayer(rng, 3, 8, 1, ConvolutionInference::Activation::Clamp),
+    });
+    Tensor input = createInput(rng, 32, 16, 4);
+    Tensor clampMin(32, 16, 1);
+    Tensor clampMax(32, 16, 1);
+    for (size_t i = 0; i < clampMin.data.size(); ++i)
+    {
+        clampMin.data[i] = 0.1f;
+        clampMax.data[i] = i % 2 ? 0.5f : 1.f;
+    }
+
+    for (auto precision : {ConvolutionInference::Precision::Float, ConvolutionInference::Precision::Half, ConvolutionInference::Precision::UNorm})
+    {
+        Tensor reference = input;
+        for (uint32_t l = 0; l < net.getLayers().size(); ++l)
+        {
+            if (l > 0)
+                ConvolutionInference::quantize(reference, precision);
+            reference = convolveReference(net.getLayers()[l], reference, &clampMin, &clampMax);
+        }
+
+        Tensor output = net.run(input, precision, ConvolutionInference::Algorithm::Auto, &clampMin, &clampMax);
+        ASSERT_EQ(output.channels, 1u);
+        for (size_t i = 0; i < reference.data.size(); ++i)
+            EXPECT_LE(std::abs(output.data[i] - reference.data[i]), 1e-5f) << "value " << i;
+    }
+
+    // The clamp activation requires the clamp images.
+    try
+    {
+        net.run(input);
+        EXPECT(false);
+    }
+    catch (const ArgumentError&)
+    {
+        EXPECT(true);
+    }
+}
+
+CPU_TEST(ConvolutionInference_Quantize)
+{
+    Tensor tensor(4, 1, 1);
+    tensor.data = {-0.5f, 0.3333333f, 1.f / 3.f + 1e-4f, 2.f};
+
+    Tensor half = tensor;
+    ConvolutionInference::quantize(half, ConvolutionInference::Precision::Half);
+    EXPECT_EQ(half.data[0], -0.5f);
+    EXPECT_EQ(half.data[3], 2.f);
+    EXPECT_LE(std::abs(half.data[1] - tensor.data[1]), 1e-3f);
+
+    Tensor unorm = tensor;
+    ConvolutionInference::quantize(unorm, ConvolutionInference::Precision::UNorm);
+    EXPECT_EQ(unorm.data[0], 0.f);
+    EXPECT_EQ(unorm.data[1], 85.f / 255.f);
+    EXPECT_EQ(unorm.data[3], 1.f);
+}
+
+CPU_TEST(ConvolutionInference_Npy)
+{
+    const auto path = getRuntimeDirectory() / "test_convolution_inference.npy";
+    std::mt19937 rng(3);
+    Tensor tensor = createInput(rng, 7, 5, 3);
+    tensor.saveNpy(path);
+
+    Tensor loaded = Tensor::loadNpy(path);
+    EXPECT_EQ(loaded.width, 7u);
+    EXPECT_EQ(loaded.height, 5u);
+    EXPECT_EQ(loaded.channels, 3u);
+    EXPECT(loaded.data == tensor.data);
+
+    Tensor concat = Tensor::concatChannels({tensor, loaded});
+    EXPECT_EQ(concat.channels, 6u);
+    EXPECT_EQ(concat.at(6, 4, 5), tensor.at(6, 4, 2));
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ConvolutionInference_Benchmark, TAGS("benchmark"))
+{
+    std::mt19937 rng(4);
+    const struct
+    {
+        uint32_t kernelSize, channelsIn, channelsOut;
+    } configs[] = {{3, 4, 16}, {3, 16, 16}, {5, 16, 16}, {3, 16, 4}, {3, 16, 1}, {7, 32, 32}};
+
+    for (const auto& config : configs)
+    {
+        ConvolutionInference net({createLayer(rng, config.kernelSize, config.channelsIn, config.channelsOut, ConvolutionInference::Activation::ReLU)});
+        Tensor input = createInput(rng, 512, 512, config.channelsIn);
+
+        std::vector<Tensor> outputs;
+        for (auto algorithm : {ConvolutionInference::Algorithm::Direct, ConvolutionInference::Algorithm::Im2ColGemm})
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            outputs.push_back(net.runLayer(0, input, algorithm));
+            double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            logInfo(
+                "ConvolutionInference: 512x512, {}x{} kernel, {} -> {} channels, {}: {:.1f} ms", config.kernelSize, config.kernelSize,
+                config.channelsIn, config.channelsOut, algorithm == ConvolutionInference::Algorithm::Direct ? "direct" : "im2col+GEMM", duration
+            );
+        }
+
+        // Both algorithms accumulate in the same order.
+        EXPECT(outputs[0].data == outputs[1].data);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,297 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/FrameSequenceFile.h"
+#include "Core/Platform/OS.h"
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Create an image with a gradient and a moving square, so consecutive frames differ in a small region only.
+std::vector<uint8_t> createImage(uint32_t width, uint32_t height, ResourceFormat format, uint32_t frame)
+{
+    const uint32_t bytesPerPixel = getFormatBytesPerBlock(format);
+    std::vector<uint8_t> data(size_t(width) * height * bytesPerPixel);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            bool inSquare = x >= frame * 3 && x < frame * 3 + 8 && y >= 10 && y < 18;
+            uint8_t* pPixel = data.data() + (size_t(y) * width + x) * bytesPerPixel;
+            if (getFormatType(format) == FormatType::Float && bytesPerPixel % 4 == 0)
+            {
+                float* pValues = reinterpret_cast<float*>(pPixel);
+                for (uint32_t c = 0; c < bytesPerPixel / 4; ++c)
+                    pValues[c] = inSquare ? 10.f : (x + y * c) / 64.f;
+            }
+            else
+            {
+                for (uint32_t c = 0; c < bytesPerPixel; ++c)
+                    pPixel[c] = inSquare ? 255 : uint8_t(x * 2 + y + c);
+            }
+        }
+    }
+    return data;
+}
+
+template<typename E, typename F>
+bool throws(F&& func)
+{
+    try
+    {
+        func();
+    }
+    catch (const E&)
+    {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+CPU_TEST(FrameSequenceFile_RoundTrip)
+{
+    const auto path = getRuntimeDirectory() / "FrameSequenceFile_roundtrip.fseq";
+    const uint32_t frameCount = 12;
+
+    struct Output
+    {
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        ResourceFormat format;
+    };
+    // Sizes are not multiples of the tile size to cover partial tiles.
+    const std::vector<Output> outputs = {
+        {"color", 70, 37, ResourceFormat::RGBA32Float},
+        {"albedo", 45, 33, ResourceFormat::BGRA8UnormSrgb},
+        {"depth", 33, 20, ResourceFormat::R32Float},
+    };
+
+    for (bool delta : {false, true})
+    {
+        {
+            FrameSequenceFile::WriterOptions options;
+            options.tileSize = 16;
+            options.deltaCompression = delta;
+            options.keyframeInterval = 4;
+            FrameSequenceFile::Writer writer(path, options);
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                for (const auto& output : outputs)
+                {
+                    uint32_t index = writer.addOutput(output.name, output.width, output.height, output.format);
+                    writer.writeImage(100 + frame, index, createImage(output.width, output.height, output.format, frame).data());
+                }
+            }
+        }
+
+        FrameSequenceFile file(path);
+        EXPECT_EQ(file.getTileSize(), 16u);
+        ASSERT_EQ(file.getOutputCount(), (uint32_t)outputs.size());
+        EXPECT_EQ(file.getImageCount(), frameCount * (uint32_t)outputs.size());
+        EXPECT_EQ(file.getFrameIDs().size(), (size_t)frameCount);
+        EXPECT_EQ(file.findOutput("missing"), FrameSequenceFile::kInvalidIndex);
+        EXPECT_EQ(file.findImage(100 + frameCount, 0), FrameSequenceFile::kInvalidIndex);
+
+        // Read images in random order, which restarts delta decoding from the closest keyframe.
+        std::vector<std::pair<uint32_t, uint32_t>> order;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+            for (uint32_t o = 0; o < outputs.size(); ++o)
+                order.emplace_back(frame, o);
+        std::shuffle(order.begin(), order.end(), std::mt19937(1));
+
+        for (auto [frame, o] : order)
+        {
+            const auto& output = outputs[o];
+            uint32_t outputIndex = file.findOutput(output.name);
+            ASSERT(outputIndex != FrameSequenceFile::kInvalidIndex);
+            EXPECT_EQ(file.getOutput(outputIndex).width, output.width);
+            EXPECT_EQ(file.getOutput(outputIndex).height, output.height);
+            EXPECT(file.getOutput(outputIndex).format == output.format);
+
+            uint32_t image = file.findImage(100 + frame, outputIndex);
+            ASSERT(image != FrameSequenceFile::kInvalidIndex);
+            EXPECT_EQ(file.getImage(image).prevImage != FrameSequenceFile::kInvalidIndex, delta && (frame % 5) != 0);
+            EXPECT(file.readImage(image) == createImage(output.width, output.height, output.format, frame)) << output.name << " " << frame;
+        }
+
+        // Sequential decoding with the previous image.
+        uint32_t colorIndex = file.findOutput("color");
+        std::vector<uint8_t> prev;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            uint32_t image = file.findImage(100 + frame, colorIndex);
+            std::vector<uint8_t> data(file.getImageByteSize(image));
+            file.readImage(image, data.data(), file.getImage(image).prevImage != FrameSequenceFile::kInvalidIndex ? prev.data() : nullptr);
+            EXPECT(data == createImage(70, 37, ResourceFormat::RGBA32Float, frame)) << frame;
+            prev = std::move(data);
+        }
+
+        // Decode all images in file order.
+        uint32_t visited = 0;
+        file.forEachImage(
+            [&](uint32_t image, const std::vector<uint8_t>& data)
+            {
+                const auto& desc = file.getImage(image);
+                const auto& output = file.getOutput(desc.output);
+                EXPECT(data == createImage(output.width, output.height, output.format, uint32_t(desc.frameID - 100))) << image;
+                visited++;
+            }
+        );
+        EXPECT_EQ(visited, file.getImageCount());
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(FrameSequenceFile_DeltaCompression)
+{
+    const auto pathKeyframes = getRuntimeDirectory() / "FrameSequenceFile_keyframes.fseq";
+    const auto pathDelta = getRuntimeDirectory() / "FrameSequenceFile_delta.fseq";
+
+    for (bool delta : {false, true})
+    {
+        FrameSequenceFile::WriterOptions options;
+        options.deltaCompression = delta;
+        FrameSequenceFile::Writer writer(delta ? pathDelta : pathKeyframes, options);
+        uint32_t output = writer.addOutput("color", 256, 128, ResourceFormat::RGBA32Float);
+        for (uint32_t frame = 0; frame < 16; ++frame)
+            writer.writeImage(frame, output, createImage(256, 128, ResourceFormat::RGBA32Float, frame).data());
+    }
+
+    // Only a small square changes between frames, so delta encoding must be much smaller.
+    auto keyframeSize = std::filesystem::file_size(pathKeyframes);
+    auto deltaSize = std::filesystem::file_size(pathDelta);
+    EXPECT_LT(deltaSize * 4, keyframeSize) << "keyframes " << keyframeSize << " delta " << deltaSize;
+    EXPECT_LT(keyframeSize, 16u * 256u * 128u * 16u);
+
+    std::filesystem::remove(pathKeyframes);
+    std::filesystem::remove(pathDelta);
+}
+
+CPU_TEST(FrameSequenceFile_ConvertRGBA32Float)
+{
+    const auto path = getRuntimeDirectory() / "FrameSequenceFile_convert.fseq";
+    {
+        FrameSequenceFile::Writer writer(path);
+        const uint8_t bgra[] = {10, 20, 30, 40, 255, 0, 128, 255};
+        writer.writeImage(0, writer.addOutput("bgra", 2, 1, ResourceFormat::BGRA8Unorm), bgra);
+        const uint16_t half[] = {0x3c00, 0xc000}; // 1.0, -2.0
+        writer.writeImage(0, writer.addOutput("half", 1, 1, ResourceFormat::RG16Float), half);
+        const float depth[] = {0.25f, 0.5f};
+        writer.writeImage(0, writer.addOutput("depth", 2, 1, ResourceFormat::R32Float), depth);
+    }
+
+    FrameSequenceFile file(path);
+
+    auto bgra = file.readImageRGBA32Float(file.findImage(0, file.findOutput("bgra")));
+    ASSERT_EQ(bgra.size(), (size_t)8);
+    EXPECT_EQ(bgra[0], 30.f / 255.f);
+    EXPECT_EQ(bgra[1], 20.f / 255.f);
+    EXPECT_EQ(bgra[2], 10.f / 255.f);
+    EXPECT_EQ(bgra[3], 40.f / 255.f);
+    EXPECT_EQ(bgra[4], 128.f / 255.f);
+    EXPECT_EQ(bgra[6], 1.f);
+
+    auto half = file.readImageRGBA32Float(file.findImage(0, file.findOutput("half")));
+    ASSERT_EQ(half.size(), (size_t)4);
+    EXPECT_EQ(half[0], 1.f);
+    EXPECT_EQ(half[1], -2.f);
+    EXPECT_EQ(half[2], 0.f);
+    EXPECT_EQ(half[3], 1.f);
+
+    auto depth = file.readImageRGBA32Float(file.findImage(0, file.findOutput("depth")));
+    ASSERT_EQ(depth.size(), (size_t)8);
+    EXPECT_EQ(depth[0], 0.25f);
+    EXPECT_EQ(depth[4], 0.5f);
+    EXPECT_EQ(depth[7], 1.f);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(FrameSequenceFile_Invalid)
+{
+    const auto path = getRuntimeDirectory() / "FrameSequenceFile_invalid.fseq";
+    {
+        FrameSequenceFile::Writer writer(path);
+        EXPECT(throws<ArgumentError>([&] { writer.addOutput("bc1", 4, 4, ResourceFormat::BC1Unorm); }));
+        uint32_t output = writer.addOutput("color", 4, 4, ResourceFormat::RGBA8Unorm);
+        EXPECT_EQ(writer.addOutput("color", 4, 4, ResourceFormat::RGBA8Unorm), output);
+        EXPECT(throws<ArgumentError>([&] { writer.addOutput("color", 8, 4, ResourceFormat::RGBA8Unorm); }));
+        writer.writeImage(0, output, createImage(4, 4, ResourceFormat::RGBA8Unorm, 0).data());
+    }
+    EXPECT(FrameSequenceFile::isSequenceFile(path));
+
+    // Truncate the index.
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT(throws<RuntimeError>([&] { FrameSequenceFile file(path); }));
+
+    std::filesystem::remove(path);
+    EXPECT(!FrameSequenceFile::isSequenceFile(path));
+}
+
+CPU_TEST(FrameSequenceFile_CorruptChunk)
+{
+    const auto path = getRuntimeDirectory() / "FrameSequenceFile_corrupt.fseq";
+    {
+        FrameSequenceFile::WriterOptions options;
+        options.tileSize = 16;
+        FrameSequenceFile::Writer writer(path, options);
+        uint32_t output = writer.addOutput("color", 64, 64, ResourceFormat::RGBA8Unorm);
+        writer.writeImage(0, output, createImage(64, 64, ResourceFormat::RGBA8Unorm, 0).data());
+    }
+
+    // Overwrite the compressed payloads. Decoding the tiles in parallel must report the error to the caller.
+    std::vector<FrameSequenceFile::Chunk> chunks;
+    {
+        FrameSequenceFile file(path);
+        for (uint32_t i = 0; i < file.getChunkCount(); ++i)
+            chunks.push_back(file.getChunk(i));
+    }
+    {
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        for (const auto& chunk : chunks)
+        {
+            const std::vector<char> garbage(chunk.size, char(0xff));
+            stream.seekp(chunk.offset);
+            stream.write(garbage.data(), garbage.size());
+        }
+    }
+
+    {
+        FrameSequenceFile file(path);
+        EXPECT(throws<RuntimeError>([&] { file.readImage(0); }));
+    }
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
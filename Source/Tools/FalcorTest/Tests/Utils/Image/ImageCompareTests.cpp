@@ -0,0 +1,108 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ImageCompare.h"
+#include "Core/Platform/OS.h"
+
+namespace Falcor
+{
+namespace
+{
+std::shared_ptr<ImageCompare::Image> createImage(uint32_t width, uint32_t height, float value)
+{
+    auto image = ImageCompare::Image::create(width, height);
+    std::fill(image->getData(), image->getData() + width * height * 4, value);
+    return image;
+}
+} // namespace
+
+CPU_TEST(ImageCompare_Metrics)
+{
+    auto a = createImage(4, 4, 0.5f);
+    auto b = createImage(4, 4, 0.5f);
+    for (auto metric : {ImageCompare::Metric::MSE, ImageCompare::Metric::RMSE, ImageCompare::Metric::MAE, ImageCompare::Metric::MAPE})
+        EXPECT_EQ(ImageCompare::compare(*a, *b, metric, true), 0.0);
+
+    // Change the red channel of a single pixel.
+    b->getData()[0] = 1.5f;
+    std::vector<float> errorMap(16);
+    double mse = ImageCompare::compare(*a, *b, ImageCompare::Metric::MSE, false, errorMap.data());
+    EXPECT(std::abs(mse - 1.0 / 3.0 / 16.0) < 1e-9) << mse;
+    EXPECT(std::abs(errorMap[0] - 1.f / 3.f) < 1e-6f);
+    EXPECT_EQ(errorMap[1], 0.f);
+
+    // Alpha is only included on request.
+    b->getData()[0] = 0.5f;
+    b->getData()[3] = 1.5f;
+    EXPECT_EQ(ImageCompare::compare(*a, *b, ImageCompare::Metric::MSE, false), 0.0);
+    EXPECT_GT(ImageCompare::compare(*a, *b, ImageCompare::Metric::MSE, true), 0.0);
+
+    // Heat map spans blue to red.
+    auto heatMap = ImageCompare::generateHeatMap(4, 4, errorMap.data());
+    EXPECT_EQ(heatMap->getData()[0], 1.f);
+    EXPECT_EQ(heatMap->getData()[2], 0.f);
+    EXPECT_EQ(heatMap->getData()[4], 0.f);
+    EXPECT_EQ(heatMap->getData()[6], 1.f);
+}
+
+CPU_TEST(ImageCompare_Files)
+{
+    const std::filesystem::path refPath = getRuntimeDirectory() / "ImageCompare_ref.exr";
+    const std::filesystem::path resultPath = getRuntimeDirectory() / "ImageCompare_result.exr";
+    const std::filesystem::path heatMapPath = getRuntimeDirectory() / "ImageCompare_heatmap.png";
+
+    createImage(16, 8, 0.25f)->saveToFile(refPath);
+    auto result = createImage(16, 8, 0.25f);
+    result->getData()[5] = 0.75f;
+    result->saveToFile(resultPath);
+
+    ImageCompare::Result single = ImageCompare::compareFiles({refPath, resultPath, heatMapPath}, ImageCompare::Metric::MSE, 1e-3f, false);
+    EXPECT(single.valid);
+    EXPECT(single.success);
+    EXPECT_GT(single.error, 0.0);
+    EXPECT(std::filesystem::exists(heatMapPath));
+
+    // Batch comparison gives identical results.
+    std::vector<ImageCompare::Job> jobs(8, ImageCompare::Job{refPath, resultPath, {}});
+    jobs.push_back({refPath, getRuntimeDirectory() / "ImageCompare_missing.exr", {}});
+    std::vector<ImageCompare::Result> results = ImageCompare::compareFiles(jobs, ImageCompare::Metric::MSE, 1e-3f, false);
+    ASSERT_EQ(results.size(), jobs.size());
+    for (size_t i = 0; i + 1 < results.size(); ++i)
+    {
+        EXPECT(results[i].valid);
+        EXPECT_EQ(results[i].error, single.error);
+    }
+    EXPECT(!results.back().valid);
+    EXPECT(!results.back().message.empty());
+
+
+    std::filesystem::remove(refPath);
+    std::filesystem::remove(resultPath);
+    std::filesystem::remove(heatMapPath);
+}
+} // namespace Falcor
@@ -0,0 +1,240 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/NumpyArray.h"
+#include "Core/Platform/OS.h"
+#include <fstream>
+#include <numeric>
+
+namespace Falcor
+{
+namespace
+{
+template<typename E, typename F>
+bool throws(F&& func)
+{
+    try
+    {
+        func();
+    }
+    catch (const E&)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+NumpyArray createArray(std::vector<size_t> shape)
+{
+    size_t count = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    std::vector<T> data(count);
+    for (size_t i = 0; i < count; ++i)
+        data[i] = T(i * 3 + 1);
+    return NumpyArray::fromVector(std::move(data), std::move(shape));
+}
+
+template<typename T>
+bool equalData(const NumpyArray& a, const NumpyArray& b)
+{
+    return a.getShape() == b.getShape() && a.toVector<T>() == b.toVector<T>();
+}
+} // namespace
+
+CPU_TEST(NumpyArray_RoundTrip)
+{
+    const auto path = getRuntimeDirectory() / "NumpyArray_roundtrip.npy";
+
+    auto test = [&](const NumpyArray& array, auto type)
+    {
+        using T = decltype(type);
+        array.save(path);
+        for (bool memoryMap : {false, true})
+        {
+            NumpyArray loaded = NumpyArray::load(path, memoryMap);
+            EXPECT(loaded.getDType() == getNumpyDType<T>());
+            EXPECT_EQ(loaded.isReadOnly(), memoryMap);
+            EXPECT(equalData<T>(array, loaded));
+        }
+    };
+
+    test(createArray<float>({4, 5, 3}), float());
+    test(createArray<double>({7}), double());
+    test(createArray<int8_t>({3, 3}), int8_t());
+    test(createArray<uint16_t>({2, 2, 2, 2}), uint16_t());
+    test(createArray<int64_t>({17, 1}), int64_t());
+    test(createArray<math::float16_t>({8, 8}), math::float16_t());
+    test(createArray<std::complex<double>>({3}), std::complex<double>());
+    test(createArray<float>({}), float());
+    test(createArray<float>({0, 4}), float());
+
+    // Memory mapped arrays are read-only views.
+    createArray<float>({4}).save(path);
+    NumpyArray mapped = NumpyArray::load(path);
+    EXPECT(throws<RuntimeError>([&]() { mapped.mutableData<float>(); }));
+    EXPECT(throws<RuntimeError>([&]() { mapped.data<int32_t>(); }));
+    NumpyArray copy = mapped.copy();
+    EXPECT(!copy.isReadOnly());
+    copy.mutableData<float>()[0] = 5.f;
+    EXPECT_EQ(mapped.data<float>()[0], 1.f);
+    mapped = {};
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(NumpyArray_ByteOrderAndFortranOrder)
+{
+    // A big-endian 2x3 int16 array in Fortran order, as written by numpy.
+    const auto path = getRuntimeDirectory() / "NumpyArray_fortran.npy";
+    {
+        std::string dict = "{'descr': '>i2', 'fortran_order': True, 'shape': (2, 3), }";
+        dict.append(128 - 10 - dict.size() - 1, ' ');
+        dict += '\n';
+        std::ofstream stream(path, std::ios::binary);
+        stream.write("\x93NUMPY\x01\x00", 8);
+        stream.put(char(dict.size()));
+        stream.put(0);
+        stream.write(dict.data(), dict.size());
+        // Column-major elements 0, 3, 1, 4, 2, 5.
+        for (int16_t value : {0, 3, 1, 4, 2, 5})
+        {
+            stream.put(char(value >> 8));
+            stream.put(char(value & 0xff));
+        }
+    }
+
+    NumpyArray array = NumpyArray::load(path);
+    EXPECT(array.getDType() == NumpyDType::Int16);
+    EXPECT(array.isFortranOrder());
+    EXPECT(!array.isReadOnly()); // Swapped bytes are copied.
+    EXPECT(array.getShape() == std::vector<size_t>({2, 3}));
+    EXPECT(array.toVector<int16_t>() == std::vector<int16_t>({0, 1, 2, 3, 4, 5}));
+
+    NumpyArray cOrder = array.toCOrder();
+    EXPECT(!cOrder.isFortranOrder());
+    EXPECT(cOrder.toVector<int16_t>() == std::vector<int16_t>({0, 1, 2, 3, 4, 5}));
+
+    // Fortran order is preserved when saving.
+    array.save(path);
+    NumpyArray loaded = NumpyArray::load(path);
+    EXPECT(loaded.isFortranOrder());
+    EXPECT(equalData<int16_t>(array, loaded));
+
+    // Higher dimensional transpose.
+    NumpyArray fortran(NumpyDType::Int32, {2, 3, 4}, true);
+    int32_t* pData = fortran.mutableData<int32_t>();
+    for (int32_t k = 0; k < 4; ++k)
+        for (int32_t j = 0; j < 3; ++j)
+            for (int32_t i = 0; i < 2; ++i)
+                *pData++ = i * 100 + j * 10 + k;
+    auto values = fortran.toVector<int32_t>();
+    bool ordered = true;
+    for (int32_t i = 0, n = 0; i < 2; ++i)
+        for (int32_t j = 0; j < 3; ++j)
+            for (int32_t k = 0; k < 4; ++k)
+                ordered &= values[n++] == i * 100 + j * 10 + k;
+    EXPECT(ordered);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(NumpyArray_Archive)
+{
+    const auto path = getRuntimeDirectory() / "NumpyArray_archive.npz";
+
+    std::map<std::string, NumpyArray> arrays;
+    arrays["weights"] = createArray<float>({3, 3, 16, 8});
+    arrays["bias"] = createArray<float>({8});
+    arrays["labels"] = createArray<uint8_t>({100});
+
+    for (bool compress : {false, true})
+    {
+        NumpyArray::saveArchive(path, arrays, compress);
+        for (bool memoryMap : {false, true})
+        {
+            auto loaded = NumpyArray::loadArchive(path, memoryMap);
+            ASSERT_EQ(loaded.size(), arrays.size());
+            EXPECT(equalData<float>(loaded["weights"], arrays["weights"]));
+            EXPECT(equalData<float>(loaded["bias"], arrays["bias"]));
+            EXPECT(equalData<uint8_t>(loaded["labels"], arrays["labels"]));
+        }
+    }
+
+    EXPECT(throws<RuntimeError>([&]() { NumpyArray::load(path); }));
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(NumpyArray_Writer)
+{
+    const auto path = getRuntimeDirectory() / "NumpyArray_writer.npy";
+
+    std::vector<float> expected;
+    {
+        // Use a small buffer to exercise both buffered and direct writes.
+        NumpyArrayWriter writer(path, NumpyDType::Float32, {8}, 100);
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            std::vector<float> rows((i % 3 + 1) * 8);
+            for (auto& v : rows)
+                v = float(expected.size() + (&v - rows.data()));
+            writer.append(rows.data(), rows.size());
+            expected.insert(expected.end(), rows.begin(), rows.end());
+
+            if (i == 20)
+            {
+                // Flushing leaves a valid file.
+                writer.flush();
+                NumpyArray partial = NumpyArray::load(path, false);
+                EXPECT_EQ(partial.getShape()[0], writer.getRowCount());
+            }
+        }
+        EXPECT(throws<ArgumentError>([&]() { writer.append(expected.data(), 7); }));
+        EXPECT(throws<ArgumentError>([&]() { writer.append(std::vector<int32_t>(8).data(), 8); }));
+    }
+
+    NumpyArray array = NumpyArray::load(path);
+    EXPECT(array.getShape() == std::vector<size_t>({expected.size() / 8, 8}));
+    EXPECT(array.toVector<float>() == expected);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(NumpyArray_Invalid)
+{
+    const auto path = getRuntimeDirectory() / "NumpyArray_invalid.npy";
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream << "not a numpy file";
+    }
+    EXPECT(throws<RuntimeError>([&]() { NumpyArray::load(path); }));
+    EXPECT(throws<RuntimeError>([&]() { NumpyArray::load(getRuntimeDirectory() / "NumpyArray_missing.npy"); }));
+    EXPECT(throws<ArgumentError>([&]() { NumpyArray::fromVector(std::vector<float>(5), {2, 3}); }));
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,248 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/TraceRecorder.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <nlohmann/json.hpp>
+
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Enables the recorder for the lifetime of the object and restores the previous state afterwards.
+struct ScopedTracing
+{
+    bool wasEnabled = TraceRecorder::isEnabled();
+    ScopedTracing()
+    {
+        TraceRecorder::clear();
+        TraceRecorder::setEnabled(true);
+    }
+    ~ScopedTracing()
+    {
+        TraceRecorder::setEnabled(wasEnabled);
+        TraceRecorder::clear();
+    }
+};
+} // namespace
+
+CPU_TEST(TraceRecorder_InternName)
+{
+    TraceRecorder::EventId a = TraceRecorder::internName("TraceRecorder_InternName_A");
+    TraceRecorder::EventId b = TraceRecorder::internName("TraceRecorder_InternName_B");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(TraceRecorder::internName("TraceRecorder_InternName_A"), a);
+    EXPECT_EQ(TraceRecorder::getName(b), "TraceRecorder_InternName_B");
+}
+
+CPU_TEST(TraceRecorder_Disabled)
+{
+    ScopedTracing tracing;
+    TraceRecorder::setEnabled(false);
+
+    TraceRecorder::EventId id = TraceRecorder::internName("TraceRecorder_Disabled");
+    for (int i = 0; i < 100; ++i)
+        TraceScope scope(id);
+    EXPECT_EQ(TraceRecorder::getRecordCount(), 0u);
+}
+
+CPU_TEST(TraceRecorder_MultiThreaded)
+{
+    ScopedTracing tracing;
+
+    const uint32_t threadCount = 4;
+    const uint32_t scopeCount = 1000;
+    TraceRecorder::EventId outer = TraceRecorder::internName("TraceRecorder_Outer");
+    TraceRecorder::EventId inner = TraceRecorder::internName("TraceRecorder_Inner \"quoted\"");
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                TraceRecorder::setThreadName(fmt::format("TraceRecorder worker {}", t));
+                for (uint32_t i = 0; i < scopeCount; ++i)
+                {
+                    TraceScope outerScope(outer);
+                    TraceScope innerScope(inner);
+                }
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(TraceRecorder::getRecordCount(), threadCount * scopeCount * 2);
+
+    // Parse the exported trace and check that each worker has its own lane with properly nested scopes.
+    nlohmann::json trace = nlohmann::json::parse(TraceRecorder::toChromeTraceJson());
+    ASSERT(trace.contains("traceEvents"));
+
+    std::map<uint32_t, std::string> laneNames;
+    std::map<uint32_t, uint32_t> outerCounts;
+    std::map<uint32_t, uint32_t> innerCounts;
+    for (const auto& event : trace["traceEvents"])
+    {
+        if (event["ph"] == "M" && event["name"] == "thread_name" && event["pid"] == 1)
+            laneNames[event["tid"].get<uint32_t>()] = event["args"]["name"].get<std::string>();
+        if (event["ph"] == "X")
+        {
+            EXPECT_GE(event["dur"].get<double>(), 0.0);
+            if (event["name"] == "TraceRecorder_Outer")
+                outerCounts[event["tid"].get<uint32_t>()]++;
+            if (event["name"] == "TraceRecorder_Inner \"quoted\"")
+                innerCounts[event["tid"].get<uint32_t>()]++;
+        }
+    }
+
+    EXPECT_EQ(outerCounts.size(), threadCount);
+    for (const auto& [tid, count] : outerCounts)
+    {
+        EXPECT_EQ(count, scopeCount);
+        EXPECT_EQ(innerCounts[tid], scopeCount);
+        EXPECT(laneNames[tid].find("TraceRecorder worker") == 0) << laneNames[tid];
+    }
+}
+
+CPU_TEST(TraceRecorder_Wraparound)
+{
+    ScopedTracing tracing;
+
+    // Record on a fresh thread, so the buffer only holds records from this test.
+    const size_t recordCount = TraceRecorder::kThreadBufferCapacity + 1000;
+    TraceRecorder::EventId id = TraceRecorder::internName("TraceRecorder_Wraparound");
+    std::thread thread(
+        [&]()
+        {
+            for (size_t i = 0; i < recordCount; ++i)
+                TraceRecorder::record(id, i + 1, i + 2);
+        }
+    );
+    thread.join();
+
+    // Only the most recent records are kept. The oldest slot is not reported since it is the next one overwritten.
+    EXPECT_EQ(TraceRecorder::getRecordCount(), TraceRecorder::kThreadBufferCapacity - 1);
+
+    TraceRecorder::clear();
+    EXPECT_EQ(TraceRecorder::getRecordCount(), 0u);
+}
+
+CPU_TEST(TraceRecorder_ExitedThreads)
+{
+    ScopedTracing tracing;
+
+    // Threads started one after the other only keep a bounded number of buffers alive.
+    const uint32_t threadCount = 100;
+    TraceRecorder::EventId id = TraceRecorder::internName("TraceRecorder_ExitedThreads");
+    for (uint32_t t = 0; t < threadCount; ++t)
+        std::thread([&]() { TraceScope scope(id); }).join();
+
+    auto getLaneCount = []()
+    {
+        nlohmann::json trace = nlohmann::json::parse(TraceRecorder::toChromeTraceJson());
+        std::set<uint32_t> lanes;
+        for (const auto& event : trace["traceEvents"])
+        {
+            if (event["ph"] == "M" && event["name"] == "thread_name" && event["pid"] == 1)
+                lanes.insert(event["tid"].get<uint32_t>());
+        }
+        return lanes.size();
+    };
+
+    // Records of the most recently exited threads are still exported.
+    const size_t recordCount = TraceRecorder::getRecordCount();
+    EXPECT_GT(recordCount, 0u);
+    EXPECT_LT(recordCount, threadCount);
+    const size_t laneCount = getLaneCount();
+    EXPECT_LT(laneCount, threadCount);
+
+    // Clearing releases the buffers of exited threads.
+    TraceRecorder::clear();
+    EXPECT_LT(getLaneCount(), laneCount);
+    std::thread([&]() { TraceScope scope(id); }).join();
+    EXPECT_EQ(TraceRecorder::getRecordCount(), 1u);
+}
+
+CPU_TEST(TraceRecorder_Gpu)
+{
+    ScopedTracing tracing;
+
+    TraceRecorder::EventId id = TraceRecorder::internName("TraceRecorder_Gpu");
+    TraceRecorder::recordGpu(id, TraceRecorder::now(), 2.0);
+
+    nlohmann::json trace = nlohmann::json::parse(TraceRecorder::toChromeTraceJson());
+    uint32_t gpuEventCount = 0;
+    for (const auto& event : trace["traceEvents"])
+    {
+        if (event["ph"] == "X" && event["name"] == "TraceRecorder_Gpu")
+        {
+            EXPECT_EQ(event["pid"].get<uint32_t>(), 2u);
+            EXPECT_GE(event["dur"].get<double>(), 1000.0);
+            EXPECT_LE(event["dur"].get<double>(), 3000.0);
+            gpuEventCount++;
+        }
+    }
+    EXPECT_EQ(gpuEventCount, 1u);
+}
+
+CPU_TEST(TraceRecorder_Overhead, TAGS("benchmark"))
+{
+    ScopedTracing tracing;
+
+    const size_t scopeCount = 1000000;
+    TraceRecorder::EventId id = TraceRecorder::internName("TraceRecorder_Overhead");
+
+    for (bool enabled : {true, false})
+    {
+        TraceRecorder::clear();
+        TraceRecorder::setEnabled(enabled);
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (size_t i = 0; i < scopeCount; ++i)
+            TraceScope scope(id);
+        double duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        double nsPerScope = duration * 1e6 / scopeCount;
+        logInfo("TraceRecorder: {:.1f} ns per scope ({})", nsPerScope, enabled ? "enabled" : "disabled");
+        EXPECT_LT(nsPerScope, 50.0) << (enabled ? "enabled" : "disabled");
+
+        // The ring buffer keeps the most recent records when enabled and nothing is recorded when disabled.
+        if (enabled)
+            EXPECT_EQ(TraceRecorder::getRecordCount(), TraceRecorder::kThreadBufferCapacity - 1);
+        else
+            EXPECT_EQ(TraceRecorder::getRecordCount(), 0u);
+    }
+}
+} // namespace Falcor
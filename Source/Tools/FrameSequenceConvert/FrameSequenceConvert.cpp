@@ -0,0 +1,163 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Utils/Image/FrameSequenceFile.h"
+
+#include <args.hxx>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Falcor;
+
+namespace
+{
+int printInfo(const std::filesystem::path& path)
+{
+    FrameSequenceFile file(path);
+    std::cout << path.string() << ": " << file.getOutputCount() << " outputs, " << file.getImageCount() << " images, tile size "
+              << file.getTileSize() << std::endl;
+    for (uint32_t output = 0; output < file.getOutputCount(); ++output)
+    {
+        const auto& desc = file.getOutput(output);
+        size_t imageCount = 0;
+        for (uint32_t image = 0; image < file.getImageCount(); ++image)
+            imageCount += file.getImage(image).output == output ? 1 : 0;
+        std::cout << "  " << desc.name << ": " << desc.width << "x" << desc.height << " " << to_string(desc.format) << ", " << imageCount
+                  << " images" << std::endl;
+    }
+    return 0;
+}
+
+std::vector<std::filesystem::path> collectImages(const std::vector<std::string>& inputs)
+{
+    std::vector<std::filesystem::path> paths;
+    for (const auto& input : inputs)
+    {
+        if (std::filesystem::is_directory(input))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(input))
+            {
+                if (entry.is_regular_file() && !FrameSequenceFile::isSequenceFile(entry.path()))
+                    paths.push_back(entry.path());
+            }
+        }
+        else
+        {
+            paths.push_back(input);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Utility to convert between frame sequence files and per-frame image files.");
+    parser.helpParams.programName = "FrameSequenceConvert";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+
+    args::Group commands(parser, "Commands:", args::Group::Validators::AtMostOne);
+    args::Flag infoFlag(commands, "info", "Print the outputs and images of a sequence file.", {"info"});
+    args::ValueFlag<std::string> exportFlag(
+        commands, "prefix", "Export all images of a sequence file to <prefix>.<output>.<frame>.<ext>.", {'x', "export"}
+    );
+    args::ValueFlag<std::string> importFlag(
+        commands, "file", "Import image files or directories of image files into a sequence file.", {'i', "import"}
+    );
+
+    args::ValueFlag<std::string> extensionFlag(parser, "ext", "Image file extension used for export (default: exr).", {'e', "ext"});
+    args::ValueFlag<uint32_t> tileSizeFlag(parser, "size", "Tile size used for import (default: 64).", {"tile-size"});
+    args::ValueFlag<uint32_t> keyframeFlag(parser, "frames", "Keyframe interval used for import (default: 32).", {"keyframe-interval"});
+    args::Flag noDeltaFlag(parser, "", "Disable delta compression between frames on import.", {"no-delta"});
+    args::PositionalList<std::string> inputs(parser, "inputs", "Sequence file, or image files and directories to import.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::Error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    try
+    {
+        if (importFlag)
+        {
+            FrameSequenceWriterOptions options;
+            if (tileSizeFlag)
+                options.tileSize = args::get(tileSizeFlag);
+            if (keyframeFlag)
+                options.keyframeInterval = args::get(keyframeFlag);
+            options.deltaCompression = !noDeltaFlag;
+
+            auto paths = collectImages(args::get(inputs));
+            FrameSequenceFile::importImages(paths, args::get(importFlag), options);
+            std::cout << "Imported " << paths.size() << " images into '" << args::get(importFlag) << "'." << std::endl;
+            return 0;
+        }
+
+        if (args::get(inputs).size() != 1)
+        {
+            std::cerr << "Expected a single sequence file." << std::endl;
+            return 1;
+        }
+        const std::filesystem::path path = args::get(inputs).front();
+
+        if (exportFlag)
+        {
+            auto written = FrameSequenceFile::exportImages(path, args::get(exportFlag), extensionFlag ? args::get(extensionFlag) : "exr");
+            std::cout << "Exported " << written.size() << " images from '" << path.string() << "'." << std::endl;
+            return 0;
+        }
+
+        return printInfo(path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
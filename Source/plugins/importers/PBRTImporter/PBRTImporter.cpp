@@ -71,7 +71,7 @@
 #include "Utils/Logger.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/FalcorMath.h"
-#include "Utils/Math/FNVHash.h"
+#include "Utils/FastHash.h"
 #include "Scene/Importer.h"
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
@@ -186,7 +186,7 @@ struct CurveAggregate
     using Key = std::tuple<float4x4, const Falcor::Material*>;
     struct KeyHash
     {
-        std::size_t operator()(const Key& key) const { return fnvHashArray64(&key, sizeof(key)); }
+        std::size_t operator()(const Key& key) const { return FastHash::hash64(&key, sizeof(key)); }
     };
 
     float4x4 transform = float4x4::identity();
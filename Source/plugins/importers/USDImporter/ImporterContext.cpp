@@ -28,6 +28,7 @@
 #include "ImporterContext.h"
 #include "USDHelpers.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
 #include "Utils/NumericRange.h"
 #include "Scene/Importer.h"
 #include "Scene/Curves/CurveConfig.h"
@@ -40,6 +41,8 @@
 
 #include <tbb/parallel_for.h>
 
+#include <algorithm>
+
 #include <opensubdiv/far/topologyDescriptor.h>
 #include <opensubdiv/far/primvarRefiner.h>
 
@@ -965,6 +968,84 @@ namespace Falcor
             return true;
         }
 
+        /** Process the time-sampled mesh keyframes and write them to an on-disk VertexCacheStore as they are decoded.
+            Keyframes are decoded in parallel in batches that fit in the streaming memory budget, so only one batch is held in host memory.
+        */
+        void processMeshKeyframesToStore(ImporterContext& ctx, const VertexCacheStreamingDesc& streaming)
+        {
+            // The keyframes of a stream must be written in order, so process the tasks in order of their time sample.
+            std::vector<MeshProcessingTask> tasks = ctx.meshKeyframeTasks;
+            std::stable_sort(tasks.begin(), tasks.end(), [](const MeshProcessingTask& a, const MeshProcessingTask& b) { return a.sampleIdx < b.sampleIdx; });
+
+            auto getTaskByteSize = [&](const MeshProcessingTask& task)
+            {
+                uint64_t byteSize = 0;
+                for (const auto& indices : ctx.meshes[task.meshId].attributeIndices) byteSize += indices.size() * sizeof(PackedStaticVertexData);
+                return byteSize;
+            };
+
+            const std::filesystem::path storePath = getTempFilePath();
+            {
+                VertexCacheStore::Writer writer(storePath, streaming.deltaCompression);
+                for (auto& m : ctx.meshes)
+                {
+                    for (size_t i = 0; i < m.cachedMeshes.size(); i++)
+                    {
+                        m.cachedMeshes[i].keyframeStream = writer.addStream(m.attributeIndices[i].size() * sizeof(PackedStaticVertexData));
+                    }
+                }
+
+                size_t batchStart = 0;
+                while (batchStart < tasks.size())
+                {
+                    // Take at least one task, and as many more as fit in the budget.
+                    size_t batchEnd = batchStart + 1;
+                    uint64_t batchByteSize = getTaskByteSize(tasks[batchStart]);
+                    while (batchEnd < tasks.size() && batchByteSize + getTaskByteSize(tasks[batchEnd]) <= streaming.memoryBudget)
+                    {
+                        batchByteSize += getTaskByteSize(tasks[batchEnd++]);
+                    }
+
+                    tbb::parallel_for<size_t>(batchStart, batchEnd,
+                        [&](size_t i)
+                        {
+                            processMeshKeyframe(ctx.meshes[tasks[i].meshId], tasks[i].meshId, tasks[i].sampleIdx, ctx);
+                        }
+                    );
+
+                    // Write the batch and release the decoded keyframes.
+                    for (size_t t = batchStart; t < batchEnd; t++)
+                    {
+                        auto& mesh = ctx.meshes[tasks[t].meshId];
+                        for (size_t i = 0; i < mesh.cachedMeshes.size(); i++)
+                        {
+                            auto& keyframeData = mesh.cachedMeshes[i].vertexData[tasks[t].sampleIdx];
+                            if (keyframeData.size() != mesh.attributeIndices[i].size())
+                            {
+                                throw ImporterError(ctx.stagePath, "Keyframe {} for mesh '{}' could not be converted.", tasks[t].sampleIdx, mesh.prim.GetName().GetString());
+                            }
+                            writer.addKeyframe(mesh.cachedMeshes[i].keyframeStream, keyframeData.data());
+                            keyframeData = {};
+                        }
+                    }
+
+                    batchStart = batchEnd;
+                }
+
+                writer.finalize();
+            }
+
+            auto pStore = std::make_shared<const VertexCacheStore>(storePath, true);
+            for (auto& m : ctx.meshes)
+            {
+                for (auto& c : m.cachedMeshes)
+                {
+                    c.vertexData.clear();
+                    c.pKeyframeStore = pStore;
+                }
+            }
+        }
+
         bool processCurve(Curve& curve, ImporterContext& ctx)
         {
             UsdGeomBasisCurves geomCurve(curve.curvePrim);
@@ -1119,14 +1200,23 @@ namespace Falcor
                     }
                 }
 
-                // Process time-sampled mesh keyframes
-                tbb::parallel_for<size_t>(0, ctx.meshKeyframeTasks.size(),
-                    [&](size_t i)
-                    {
-                        auto& task = ctx.meshKeyframeTasks[i];
-                        processMeshKeyframe(ctx.meshes[task.meshId], task.meshId, task.sampleIdx, ctx);
-                    }
-                );
+                // Process time-sampled mesh keyframes.
+                // When streaming, they are written to disk as they are decoded instead of being held in host memory.
+                const VertexCacheStreamingDesc streaming = ctx.builder.getVertexCacheStreaming();
+                if (streaming.enabled && !ctx.meshKeyframeTasks.empty())
+                {
+                    processMeshKeyframesToStore(ctx, streaming);
+                }
+                else
+                {
+                    tbb::parallel_for<size_t>(0, ctx.meshKeyframeTasks.size(),
+                        [&](size_t i)
+                        {
+                            auto& task = ctx.meshKeyframeTasks[i];
+                            processMeshKeyframe(ctx.meshes[task.meshId], task.meshId, task.sampleIdx, ctx);
+                        }
+                    );
+                }
 
                 // Gather keyframe data from all meshes
                 size_t totalMeshes = 0;
@@ -28,7 +28,7 @@
 #include "Tessellation.h"
 #include "Core/Assert.h"
 #include "Utils/Logger.h"
-#include "Utils/Math/FNVHash.h"
+#include "Utils/FastHash.h"
 #include "IndexedVector.h"
 
 #include <opensubdiv/far/topologyDescriptor.h>
@@ -53,9 +53,7 @@ struct GfVec2fHash
 {
     size_t operator()(const GfVec2f& v) const
     {
-        FNVHash64 hash;
-        hash.insert(&v, sizeof(v));
-        return hash.get();
+        return FastHash::hash64(&v, sizeof(v));
     }
 };
 
@@ -63,9 +61,7 @@ struct GfVec3fHash
 {
     size_t operator()(const GfVec3f& v) const
     {
-        FNVHash64 hash;
-        hash.insert(&v, sizeof(v));
-        return hash.get();
+        return FastHash::hash64(&v, sizeof(v));
     }
 };
 
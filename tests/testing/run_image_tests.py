@@ -226,10 +226,49 @@ class Test:
 
         return Test.Result.PASSED, [], rerun_env
 
-    def compare_images(self, ref_dir, result_dir, image_compare_exe):
+    def compare_images_with_exe(self, ref_dir, result_dir, images, image_compare_exe):
+        '''
+        Compare images by running the ImageCompare executable once per image.
+        Returns a dictionary mapping images to (success, error) tuples, or None if the processes were killed.
+        '''
+        processes = {}
+        for image in images:
+            ref_file = ref_dir / image
+            result_file = result_dir / image
+            error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
+
+            args = [str(image_compare_exe), '-m', 'mse', '-t', str(self.tolerance), str(ref_file), str(result_file)]
+            if error_file:
+                args += ['-e', str(error_file)]
+            processes[image] = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+            if not self.process_controller.add_process(self.name + ":image:" + str(image), processes[image]):
+                return None
+
+        results = {}
+        for image, process in processes.items():
+            output = process.communicate()[0]
+            results[image] = (process.returncode == 0, float(output.strip()))
+        return results
+
+    def compare_images_in_process(self, ref_dir, result_dir, images, image_compare):
+        '''
+        Compare images in parallel using the ImageCompare Python binding.
+        Returns a dictionary mapping images to (success, error) tuples.
+        '''
+        jobs = [(ref_dir / image, result_dir / image, result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)) for image in images]
+        results = {}
+        for image, r in zip(images, image_compare.compare_files(jobs, 'mse', self.tolerance)):
+            if r['message']:
+                with print_mutex:
+                    print(r['message'])
+            results[image] = (r['success'], r['error'] if r['valid'] else float('nan'))
+        return results
+
+    def compare_images(self, ref_dir, result_dir, image_compare_exe, image_compare=None):
         '''
         Run ImageCompare on a set of images in ref_dir and result_dir.
         Checks if error between reference and result image is within a given tolerance.
+        Images are compared in-process if the ImageCompare Python binding is given, otherwise by spawning image_compare_exe.
         Returns a tuple containing the result code, a list of messages and a list of image reports.
         '''
         # Bail out if test is skipped.
@@ -259,30 +298,22 @@ class Test:
         image_reports = []
 
         # Compare every result image with the corresponding reference image and report missing references.
-        processes = {}
+        images_to_compare = []
         for image in result_images:
             if not image in ref_images:
                 result = Test.Result.FAILED
                 messages.append(f'Test has generated image "{image}" with no corresponding reference image.')
                 continue
+            images_to_compare.append(image)
 
-            ref_file = ref_dir / image
-            result_file = result_dir / image
-            error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
-
-            args = [str(image_compare_exe), '-m', 'mse', '-t', str(self.tolerance), str(ref_file), str(result_file)]
-            if error_file:
-                args += ['-e', str(error_file)]
-            processes[image] = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-            if not self.process_controller.add_process(self.name + ":image:" + str(image), processes[image]):
-                return Test.Result.FAILED, ['Process killed due to global exit']
-
-        for image, process in processes.items():
-
-            output = process.communicate()[0]
-            compare_success =  process.returncode == 0
-            compare_error = float(output.strip())
+        if image_compare:
+            compare_results = self.compare_images_in_process(ref_dir, result_dir, images_to_compare, image_compare)
+        else:
+            compare_results = self.compare_images_with_exe(ref_dir, result_dir, images_to_compare, image_compare_exe)
+            if compare_results is None:
+                return Test.Result.FAILED, ['Process killed due to global exit'], []
 
+        for image, (compare_success, compare_error) in compare_results.items():
             if not compare_success:
                 result = Test.Result.FAILED
                 messages.append(f'Test image "{image}" failed with error {compare_error}.')
@@ -302,7 +333,7 @@ class Test:
 
         return result, messages, image_reports
 
-    def run(self, compare_only, ref_dir, result_dir, mogwai_exe, image_compare_exe):
+    def run(self, compare_only, ref_dir, result_dir, mogwai_exe, image_compare_exe, image_compare=None):
         '''
         Run the image test.
         First, result images are generated (unless compare_only is True).
@@ -328,7 +359,7 @@ class Test:
 
         # Compare to references.
         if result == Test.Result.PASSED:
-            result, messages, report['images'] = self.compare_images(ref_dir, result_dir, image_compare_exe)
+            result, messages, report['images'] = self.compare_images(ref_dir, result_dir, image_compare_exe, image_compare)
 
         # Finish report.
         report['result'] = Test.RESULT_STRING[result]
@@ -408,6 +439,21 @@ def generate_refs(env, tests, ref_dir, process_controller):
 
     return success
 
+def load_image_compare(env):
+    '''
+    Load the ImageCompare Python binding from the falcor module of the build.
+    Returns None if the module cannot be loaded.
+    '''
+    try:
+        sys.path.insert(0, str(env.build_dir / 'python'))
+        if os.name == 'nt':
+            os.add_dll_directory(str(env.build_dir))
+        import falcor
+        return falcor.ImageCompare
+    except (ImportError, AttributeError, OSError) as e:
+        print(colored(f'Cannot load falcor Python module ({e}), falling back to the ImageCompare executable.', 'yellow'))
+        return None
+
 def run_test(env, test, compare_only, ref_dir, result_dir, min_tolerance, process_controller):
     if process_controller.is_interrupted():
         return
@@ -416,7 +462,7 @@ def run_test(env, test, compare_only, ref_dir, result_dir, min_tolerance, proces
     test.tolerance = max(test.tolerance, min_tolerance)
     test.process_controller = process_controller
     start_time = time.time()
-    result, messages = test.run(compare_only, ref_dir, result_dir, env.mogwai_exe, env.image_compare_exe)
+    result, messages = test.run(compare_only, ref_dir, result_dir, env.mogwai_exe, env.image_compare_exe, getattr(env, 'image_compare', None))
     elapsed_time = time.time() - start_time
     return {"name": test.name, "elapsed_time": elapsed_time, "result": result, "messages": messages}
 
@@ -587,6 +633,7 @@ def main():
     parser.add_argument('--tolerance', type=float, action='store', help='Override tolerance to be at least this value.', default=config.DEFAULT_TOLERANCE)
     parser.add_argument('--parallel', type=int, action='store', help='Set the number of Mogwai processes to be used in parallel', default=default_processes_count)
     parser.add_argument('--gen-refs', action='store_true', help='Generate reference images instead of running tests')
+    parser.add_argument('--spawn-image-compare', action='store_true', help='Compare images by spawning the ImageCompare executable instead of in-process')
 
     additional_group = parser.add_argument_group('extended arguments ', 'Additional options used for testing pipelines on TeamCity.')
     additional_group.add_argument('--pull-refs', action='store_true', help='Pull reference images from remote before running tests')
@@ -668,6 +715,7 @@ def main():
             sys.exit(1)
 
         # Run tests.
+        env.image_compare = None if args.spawn_image_compare else load_image_compare(env)
         if not run_tests(env, tests, args.compare_only, ref_dir, result_dir, args.tolerance, args.xml_report, process_controller):
             sys.exit(1)
 
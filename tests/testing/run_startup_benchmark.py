@@ -0,0 +1,110 @@
+'''
+Frontend for running the Mogwai startup benchmark.
+
+This script measures the time it takes to start and exit Mogwai in headless mode
+using the different plugin loading modes.
+'''
+
+import sys
+import argparse
+import statistics
+import subprocess
+import tempfile
+import time
+from pathlib import Path
+
+from core import Environment, config
+from core.environment import find_most_recent_build_config
+
+PLUGIN_LOADING_MODES = ['eager', 'parallel', 'lazy']
+
+def run_mogwai(env: Environment, script_file: Path, mode: str, args):
+    '''
+    Run Mogwai once and return the wall clock time in seconds.
+    '''
+    args = [str(env.mogwai_exe), '--headless', '--plugin-loading', mode, '--script', str(script_file)] + args
+
+    start = time.perf_counter()
+    p = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    try:
+        _, errs = p.communicate(timeout=600)
+    except subprocess.TimeoutExpired:
+        p.kill()
+        print('\n\nProcess killed due to timeout')
+        return None
+    elapsed = time.perf_counter() - start
+
+    if p.returncode != 0:
+        print(errs.decode('utf-8'))
+        print(f'{env.mogwai_exe} exited with return code {p.returncode}')
+        return None
+
+    return elapsed
+
+def run_startup_benchmark(env: Environment, modes, runs, args):
+    '''
+    Run the startup benchmark for the given plugin loading modes.
+    '''
+    with tempfile.TemporaryDirectory() as temp_dir:
+        script_file = Path(temp_dir) / 'exit.py'
+        script_file.write_text('exit()\n')
+
+        results = {}
+        for mode in modes:
+            # The first run warms up the file cache and, in lazy mode, writes the plugin manifest.
+            times = []
+            for i in range(runs + 1):
+                elapsed = run_mogwai(env, script_file, mode, args)
+                if elapsed == None:
+                    return False
+                if i > 0:
+                    times.append(elapsed)
+            results[mode] = times
+
+    print(f'{"mode":<10} {"median (s)":>12} {"min (s)":>10} {"max (s)":>10}')
+    for mode, times in results.items():
+        print(f'{mode:<10} {statistics.median(times):>12.3f} {min(times):>10.3f} {max(times):>10.3f}')
+
+    return True
+
+def main():
+    default_config = find_most_recent_build_config()
+
+    parser = argparse.ArgumentParser(description=__doc__, add_help=False)
+    parser.add_argument('-h', '--help', action='store_true', help='Show this help message and exit')
+    parser.add_argument('--environment', type=str, action='store', help=f'Environment (default: {config.DEFAULT_ENVIRONMENT})', default=config.DEFAULT_ENVIRONMENT)
+    parser.add_argument('--config', type=str, action='store', help=f'Build configuration (default: {default_config})', default=default_config)
+    parser.add_argument('--list-configs', action='store_true', help='List available build configurations')
+    parser.add_argument('--modes', type=str, nargs='+', choices=PLUGIN_LOADING_MODES, help='Plugin loading modes to benchmark (default: all)', default=PLUGIN_LOADING_MODES)
+    parser.add_argument('--runs', type=int, action='store', help='Number of measured runs per mode (default: 5)', default=5)
+    args, passthrough_args = parser.parse_known_args()
+
+    # Try to load environment.
+    env = None
+    try:
+        env = Environment(args.environment, args.config)
+    except Exception as e:
+        env_error = e
+
+    # Print help.
+    if args.help:
+        parser.print_help()
+        sys.exit(0)
+
+    # List build configurations.
+    if args.list_configs:
+        print('Available build configurations:\n' + '\n'.join(config.BUILD_CONFIGS.keys()))
+        sys.exit(0)
+
+    # Abort if environment is missing.
+    if env == None:
+        print(f"\nFailed to load environment: {env_error}")
+        sys.exit(1)
+
+    # Run benchmark.
+    success = run_startup_benchmark(env, args.modes, args.runs, passthrough_args)
+
+    sys.exit(0 if success else 1)
+
+if __name__ == '__main__':
+    main()